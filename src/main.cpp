@@ -1,5 +1,7 @@
 #include "ymery/app.hpp"
 #include "ymery/log_buffer.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
 #include <ytrace/ytrace.hpp>
@@ -17,6 +19,10 @@ int main(int argc, char* argv[]) {
     std::vector<std::filesystem::path> layout_paths;
     std::vector<std::filesystem::path> plugin_paths;
     std::filesystem::path main_file;  // Now a file path, not a module name
+    bool hot_reload = false;
+    int prepare_threads = -1;
+    ymery::IoThreadConfig io_threads;
+    ymery::AsyncTreeConfig async_trees;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -28,6 +34,54 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) {
                 main_file = argv[++i];
             }
+        } else if (arg == "-r" || arg == "--hot-reload") {
+            hot_reload = true;
+        } else if (arg == "--prepare-threads") {
+            if (i + 1 < argc) {
+                prepare_threads = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--rt-policy") {
+            if (i + 1 < argc) {
+                auto policy = ymery::io_sched_policy_from_string(argv[++i]);
+                if (!policy) {
+                    std::cerr << "Error: " << ymery::error_msg(policy) << std::endl;
+                    return 1;
+                }
+                io_threads.policy = *policy;
+            }
+        } else if (arg == "--rt-priority") {
+            if (i + 1 < argc) {
+                io_threads.priority = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--rt-cpus") {
+            if (i + 1 < argc) {
+                std::string list = argv[++i];
+                for (size_t pos = 0; pos <= list.size();) {
+                    size_t comma = std::min(list.find(',', pos), list.size());
+                    if (comma > pos) io_threads.cpus.push_back(std::atoi(list.substr(pos, comma - pos).c_str()));
+                    pos = comma + 1;
+                }
+            }
+        } else if (arg == "--mlock") {
+            io_threads.lock_memory = true;
+        } else if (arg == "--async-providers") {
+            if (i + 1 < argc) {
+                std::string list = argv[++i];
+                async_trees.providers.clear();
+                for (size_t pos = 0; pos <= list.size();) {
+                    size_t comma = std::min(list.find(',', pos), list.size());
+                    if (comma > pos) async_trees.providers.push_back(list.substr(pos, comma - pos));
+                    pos = comma + 1;
+                }
+            }
+        } else if (arg == "--async-max-age") {
+            if (i + 1 < argc) {
+                async_trees.max_age = std::atof(argv[++i]);
+            }
+        } else if (arg == "--async-threads") {
+            if (i + 1 < argc) {
+                async_trees.threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+            }
         } else if (arg == "--plugins-path") {
             if (i + 1 < argc) {
                 plugin_paths.push_back(argv[++i]);
@@ -38,6 +92,16 @@ int main(int argc, char* argv[]) {
                       << "  -p, --layouts-path <path>  Add layout search path (for imports)\n"
                       << "  -m, --main <file>          Main layout file\n"
                       << "  --plugins-path <path>      Add plugin search path\n"
+                      << "  -r, --hot-reload           Apply layout file edits without restarting\n"
+                      << "  --prepare-threads <n>      Worker threads for widget data (default: cores - 1)\n"
+                      << "  --rt-policy <policy>       Audio I/O thread scheduling: other, fifo or rr (default: other)\n"
+                      << "  --rt-priority <n>          Real-time priority for fifo/rr (default: 70)\n"
+                      << "  --rt-cpus <list>           Pin audio I/O threads to CPUs, e.g. 2,3\n"
+                      << "  --mlock                    Lock process memory to avoid page faults in audio threads\n"
+                      << "  --async-providers <list>   Providers read in the background, e.g. jack,filesystem\n"
+                      << "                             (default: none)\n"
+                      << "  --async-max-age <seconds>  Age after which a cached provider answer is refreshed (default: 1)\n"
+                      << "  --async-threads <n>        Workers for background provider access (default: 2)\n"
                       << "  -h, --help                 Show this help\n"
                       << "\nExamples:\n"
                       << "  ymery                                   # Opens builtin file browser\n"
@@ -152,6 +216,10 @@ int main(int argc, char* argv[]) {
     config.layout_paths = layout_paths;
     config.plugin_paths = plugin_paths;
     config.main_module = main_module;
+    config.hot_reload = hot_reload;
+    config.prepare_threads = prepare_threads;
+    config.io_threads = io_threads;
+    config.async_trees = async_trees;
     config.window_title = "Ymery";
     ydebug("App config created, calling App::create");
 
@@ -4,6 +4,7 @@
 
 #include "app.hpp"
 #include <ytrace/ytrace.hpp>
+#include <thread>
 
 namespace ymery {
 
@@ -18,6 +19,14 @@ Result<void> App::_init_core() {
     }
     _dispatcher = *disp_res;
 
+    // Before any device opens: audio I/O threads pick up the policy when they start
+    if (auto res = IoThreadService::instance().configure(_config.io_threads); !res) {
+        ywarn("App::_init_core: I/O thread configuration ignored: {}", error_msg(res));
+    }
+    if (auto res = AsyncTreeService::instance().configure(_config.async_trees); !res) {
+        ywarn("App::_init_core: async provider configuration ignored: {}", error_msg(res));
+    }
+
     // Build colon-separated plugin path string
     std::string plugins_path;
     for (const auto& p : _config.plugin_paths) {
@@ -82,10 +91,77 @@ Result<void> App::_init_core() {
     _root_widget = *root_res;
     ydebug("Root widget created successfully");
 
+    // Workers for the frame prepare phase
+    size_t prepare_threads = 0;
+#ifndef YMERY_WEB
+    if (_config.prepare_threads >= 0) {
+        prepare_threads = static_cast<size_t>(_config.prepare_threads);
+    } else if (unsigned cores = std::thread::hardware_concurrency(); cores > 1) {
+        prepare_threads = cores - 1;
+    }
+#endif
+    _preparer = std::make_unique<FramePreparer>(prepare_threads);
+    ydebug("Frame preparer: {} worker thread(s)", prepare_threads);
+
     return Ok();
 }
 
+Result<size_t> App::reload_layouts() {
+    if (!_lang || !_widget_factory) {
+        return Err<size_t>("App::reload_layouts: app not initialized");
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    auto changes_res = _lang->reload_changed();
+    if (!changes_res) {
+        return Err<size_t>("App::reload_layouts: reload failed", changes_res);
+    }
+    const auto& changes = *changes_res;
+    for (const auto& error : changes.errors) {
+        ywarn("Hot reload: keeping previous definitions of {}", error);
+    }
+    if (changes.empty()) {
+        return size_t{0};
+    }
+    if (changes.data) {
+        ywarn("Hot reload: data: section changed - restart to apply it");
+    }
+
+    size_t rebuilt = 0;
+    if (changes.app || !_root_widget || changes.widgets.count(_root_widget->definition())) {
+        auto root_res = _widget_factory->create_root_widget();
+        if (!root_res) {
+            return Err<size_t>("App::reload_layouts: root widget create failed", root_res);
+        }
+        if (_root_widget) _root_widget->dispose();
+        _root_widget = *root_res;
+        rebuilt = 1;
+    } else {
+        rebuilt = _root_widget->reload_definitions(changes.widgets);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    yinfo("Hot reload: {} module(s), {} definition(s) changed, {} widget(s) rebuilt in {:.2f} ms",
+          changes.modules.size(), changes.widgets.size(), rebuilt, ms);
+    return rebuilt;
+}
+
+void App::_poll_layout_changes() {
+    // A stat() per module file - cheap, but no need to do it every frame
+    static constexpr auto RELOAD_CHECK_INTERVAL = std::chrono::milliseconds(250);
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < _next_reload_check) return;
+    _next_reload_check = now + RELOAD_CHECK_INTERVAL;
+
+    if (auto res = reload_layouts(); !res) {
+        ywarn("Hot reload failed: {}", error_msg(res));
+    }
+}
+
 void App::_dispose_core() {
+    _preparer.reset();
+
     if (_root_widget) {
         _root_widget->dispose();
         _root_widget.reset();
@@ -95,6 +171,8 @@ void App::_dispose_core() {
         _plugin_manager->dispose();
         _plugin_manager.reset();
     }
+
+    IoThreadService::instance().shutdown();
 }
 
 } // namespace ymery
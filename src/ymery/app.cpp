@@ -213,7 +213,19 @@ Result<void> App::frame() {
     }
 #endif
 
-    // Render root widget
+    // Scratch memory handed out during the previous frame is no longer referenced
+    frame_arena().reset();
+
+    if (_config.hot_reload) {
+        _poll_layout_changes();
+    }
+
+    // Prepare phase - widgets fetch and convert their data in parallel
+    if (_root_widget && _preparer) {
+        _preparer->run(*_root_widget);
+    }
+
+    // Submit phase - render root widget
     if (_root_widget) {
 #ifdef YMERY_WEB
         if (_em_frame_count < 5) {
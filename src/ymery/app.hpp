@@ -7,6 +7,10 @@
 #include "plugin_manager.hpp"
 #include "frontend/widget.hpp"
 #include "frontend/widget_factory.hpp"
+#include "frontend/frame_prepare.hpp"
+#include "backend/async_tree.hpp"
+#include "backend/io_thread.hpp"
+#include <chrono>
 #include <filesystem>
 #include <memory>
 
@@ -24,6 +28,10 @@ struct AppConfig {
     int window_width = 1280;
     int window_height = 720;
     std::string window_title = "Ymery App";
+    bool hot_reload = false;  // watch loaded layout files and apply edits live
+    int prepare_threads = -1; // widget prepare workers (-1: one per core besides the UI thread)
+    IoThreadConfig io_threads; // scheduling of audio I/O threads
+    AsyncTreeConfig async_trees; // background access to slow providers
 };
 
 // App - main application class
@@ -47,6 +55,10 @@ public:
     // Single frame
     Result<void> frame();
 
+    // Re-read changed layout files and rebuild only the widgets whose
+    // definitions changed. Returns the number of widgets rebuilt.
+    Result<size_t> reload_layouts();
+
     // Access components
     std::shared_ptr<Lang> lang() const { return _lang; }
     std::shared_ptr<Dispatcher> dispatcher() const { return _dispatcher; }
@@ -73,6 +85,9 @@ private:
     Result<void> _init_core();
     void _dispose_core();
 
+    // Hot reload check, rate limited (app-core.cpp)
+    void _poll_layout_changes();
+
     AppConfig _config;
 
     std::shared_ptr<Lang> _lang;
@@ -82,7 +97,9 @@ private:
     std::shared_ptr<TreeLike> _data_tree;
 
     WidgetPtr _root_widget;
+    std::unique_ptr<FramePreparer> _preparer;
     bool _should_close = false;
+    std::chrono::steady_clock::time_point _next_reload_check;
 
     // Graphics state (platform-specific)
     void* _window = nullptr;
@@ -0,0 +1,540 @@
+// Async tree implementation
+#include "async_tree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+// ============================================================================
+// AsyncTreeService
+// ============================================================================
+
+AsyncTreeService& AsyncTreeService::instance() {
+    static AsyncTreeService service;
+    return service;
+}
+
+AsyncTreeService::~AsyncTreeService() {
+    _stop();
+}
+
+Result<void> AsyncTreeService::configure(const AsyncTreeConfig& config) {
+    if (config.threads == 0) {
+        return Err<void>("AsyncTreeService::configure: at least one thread is needed");
+    }
+    if (config.max_in_flight == 0) {
+        return Err<void>("AsyncTreeService::configure: max in flight must be at least 1");
+    }
+    if (config.max_age < 0.0) {
+        return Err<void>("AsyncTreeService::configure: max age must not be negative");
+    }
+    _stop();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config = config;
+    }
+    ydebug("AsyncTreeService: threads={} max-in-flight={} max-age={}s providers={}",
+           config.threads, config.max_in_flight, config.max_age, config.providers.size());
+    return Ok();
+}
+
+AsyncTreeConfig AsyncTreeService::config() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _config;
+}
+
+bool AsyncTreeService::is_async(const std::string& provider) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::find(_config.providers.begin(), _config.providers.end(), provider) != _config.providers.end();
+}
+
+void AsyncTreeService::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // While stopping, the exiting workers still drain the queue
+        if (_workers.empty() && !_stopping) _start_locked();
+        _jobs.push_back(std::move(job));
+    }
+    _wake.notify_one();
+}
+
+size_t AsyncTreeService::threads() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _workers.size();
+}
+
+void AsyncTreeService::shutdown() {
+    _stop();
+}
+
+void AsyncTreeService::_start_locked() {
+    for (size_t i = 0; i < _config.threads; ++i) {
+        _workers.emplace_back(&AsyncTreeService::_worker, this);
+    }
+}
+
+void AsyncTreeService::_stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        workers.swap(_workers);
+    }
+    _wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = false;
+}
+
+void AsyncTreeService::_worker() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty()) return;
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+    }
+}
+
+// ============================================================================
+// AsyncTree
+// ============================================================================
+
+using Clock = std::chrono::steady_clock;
+
+struct AsyncTree::State {
+    // One cached answer; fetched is the epoch until the first answer and
+    // after a write, which makes it due for a refresh
+    template<typename T>
+    struct Slot {
+        std::optional<T> value;
+        Clock::time_point fetched{};
+        Clock::time_point used{};  // last read, for eviction
+        bool fetching = false;
+        std::optional<std::string> error;  // why the last fetch failed
+        std::vector<std::shared_ptr<std::promise<Result<T>>>> waiters;
+    };
+    template<typename T>
+    using Slots = std::unordered_map<std::string, Slot<T>>;
+
+    TreeLikePtr inner;
+    std::string name;
+    Clock::duration max_age{};
+    size_t max_in_flight = 1;
+
+    std::mutex mutex;
+    std::deque<std::function<void()>> queue;  // jobs waiting for a worker
+    size_t running = 0;                       // jobs handed to the service
+    bool disposed = false;
+    std::optional<std::string> write_error;  // reported by the next read
+
+    std::atomic<uint64_t> calls{0};
+    std::atomic<size_t> in_flight{0};
+    std::atomic<size_t> peak{0};
+
+    Slots<std::vector<std::string>> children;
+    Slots<Dict> metadata;
+    Slots<Value> values;
+    Slots<ChildrenMetadata> children_metadata;  // by path and key list
+};
+
+namespace {
+
+using State = AsyncTree::State;
+using StatePtr = std::shared_ptr<State>;
+
+template<typename T>
+using Fetch = std::function<Result<T>(TreeLike&)>;
+
+template<typename T>
+using SlotsMember = State::Slots<T> State::*;
+
+void pump_locked(const StatePtr& state);
+
+void enqueue_locked(const StatePtr& state, std::function<void()> job) {
+    state->queue.push_back(std::move(job));
+    pump_locked(state);
+}
+
+// Hand queued jobs to the service, at most max_in_flight at a time; each
+// finished job pulls the next, so providers take turns on the workers
+void pump_locked(const StatePtr& state) {
+    while (state->running < state->max_in_flight && !state->queue.empty()) {
+        auto job = std::move(state->queue.front());
+        state->queue.pop_front();
+        ++state->running;
+        AsyncTreeService::instance().post([state, job = std::move(job)] {
+            job();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            --state->running;
+            pump_locked(state);
+        });
+    }
+}
+
+template<typename R, typename Fn>
+R call_provider(State& state, const Fn& fn) {
+    size_t now = state.in_flight.fetch_add(1) + 1;
+    size_t peak = state.peak.load();
+    while (now > peak && !state.peak.compare_exchange_weak(peak, now)) {}
+    state.calls.fetch_add(1, std::memory_order_relaxed);
+
+    R res = [&] {
+        std::scoped_lock lock(state.inner->access_mutex());
+        return fn(*state.inner);
+    }();
+    state.in_flight.fetch_sub(1);
+    return res;
+}
+
+// Queue a fetch of key unless one is running; waiter (if any) gets its answer
+template<typename T>
+void fetch_locked(const StatePtr& state, SlotsMember<T> slots, const std::string& key, Fetch<T> call,
+                  std::shared_ptr<std::promise<Result<T>>> waiter) {
+    if (state->disposed) {
+        if (waiter) waiter->set_value(Err<T>("AsyncTree '" + state->name + "': disposed"));
+        return;
+    }
+    auto& slot = ((*state).*slots)[key];
+    slot.used = Clock::now();
+    if (waiter) slot.waiters.push_back(std::move(waiter));
+    if (slot.fetching) return;
+    slot.fetching = true;
+
+    enqueue_locked(state, [state, slots, key, call = std::move(call)] {
+        Result<T> res = call_provider<Result<T>>(*state, call);
+        std::vector<std::shared_ptr<std::promise<Result<T>>>> waiters;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            auto& slot = ((*state).*slots)[key];
+            slot.fetching = false;
+            slot.fetched = Clock::now();
+            if (res) {
+                slot.value = *res;
+                slot.error.reset();
+            } else {
+                slot.error = error_msg(res);
+                ydebug("AsyncTree '{}': fetching '{}' failed: {}", state->name, key, *slot.error);
+            }
+            waiters.swap(slot.waiters);
+        }
+        for (auto& waiter : waiters) {
+            waiter->set_value(res);
+        }
+    });
+}
+
+// Drop the least recently read settled entries down to EVICT_TO; entries
+// being fetched or waited for stay
+template<typename T>
+void evict_locked(State::Slots<T>& slots) {
+    using Iterator = typename State::Slots<T>::iterator;
+    std::vector<Iterator> settled;
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        if (!it->second.fetching && it->second.waiters.empty()) settled.push_back(it);
+    }
+    size_t count = std::min(slots.size() - AsyncTree::EVICT_TO, settled.size());
+    std::nth_element(settled.begin(), settled.begin() + static_cast<std::ptrdiff_t>(count), settled.end(),
+                     [](const Iterator& a, const Iterator& b) { return a->second.used < b->second.used; });
+    for (size_t i = 0; i < count; ++i) {
+        slots.erase(settled[i]);
+    }
+}
+
+// Cached answer for key, queueing a refresh when it is due. A key that
+// has no answer yet, or whose last fetch failed, is an error.
+template<typename T>
+Result<T> serve(const StatePtr& state, SlotsMember<T> slots, const std::string& key, Fetch<T> call,
+                bool& stale) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    auto& map = (*state).*slots;
+    auto& slot = map[key];
+    const auto now = Clock::now();
+    slot.used = now;
+    const auto age = now - slot.fetched;
+    if (!slot.fetching && age >= state->max_age) {
+        fetch_locked<T>(state, slots, key, std::move(call), nullptr);
+    }
+    stale = !slot.value || slot.error || age > state->max_age;
+    Result<T> result = slot.error
+        ? Result<T>(Err<T>("AsyncTree '" + state->name + "': '" + key + "': " + *slot.error))
+        : slot.value ? Result<T>(*slot.value)
+                     : Result<T>(Err<T>("AsyncTree '" + state->name + "': '" + key + "' is pending"));
+
+    // The entry just read is the most recent, so it survives
+    if (map.size() > AsyncTree::MAX_CACHED) evict_locked(map);
+    return result;
+}
+
+// The failure of a write acknowledged earlier, once
+Result<void> take_write_error(const StatePtr& state) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->write_error) return Ok();
+    auto message = std::move(*state->write_error);
+    state->write_error.reset();
+    return Err<void>(message);
+}
+
+template<typename T>
+std::future<Result<T>> fetch_async(const StatePtr& state, SlotsMember<T> slots, const std::string& key, Fetch<T> call) {
+    auto waiter = std::make_shared<std::promise<Result<T>>>();
+    auto future = waiter->get_future();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    fetch_locked<T>(state, slots, key, std::move(call), std::move(waiter));
+    return future;
+}
+
+// Queue a write; when it is done every cached answer is due again. A
+// write nobody waits for (report) leaves its failure for the next read.
+std::future<Result<void>> write(const StatePtr& state, Fetch<void> call, std::string what, bool report) {
+    auto done = std::make_shared<std::promise<Result<void>>>();
+    auto future = done->get_future();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->disposed) {
+        done->set_value(Err<void>("AsyncTree '" + state->name + "': disposed"));
+        return future;
+    }
+    enqueue_locked(state, [state, call = std::move(call), what = std::move(what), report, done] {
+        Result<void> res = call_provider<Result<void>>(*state, call);
+        if (!res) {
+            ywarn("AsyncTree '{}': {} failed: {}", state->name, what, error_msg(res));
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!res && report) state->write_error = "AsyncTree '" + state->name + "': " + what + " failed: " + error_msg(res);
+            for (auto& [_, slot] : state->children) slot.fetched = {};
+            for (auto& [_, slot] : state->metadata) slot.fetched = {};
+            for (auto& [_, slot] : state->values) slot.fetched = {};
+            for (auto& [_, slot] : state->children_metadata) slot.fetched = {};
+        }
+        done->set_value(res);
+    });
+    return future;
+}
+
+template<typename T>
+void fail_waiters(State::Slots<T>& slots, const std::string& message,
+                  std::vector<std::function<void()>>& failures) {
+    for (auto& [_, slot] : slots) {
+        for (auto& waiter : slot.waiters) {
+            failures.push_back([waiter, message] { waiter->set_value(Err<T>(message)); });
+        }
+    }
+    slots.clear();
+}
+
+// Cache key of a children-metadata listing: the path, then each key
+std::string listing_key(const DataPath& path, const std::vector<std::string>& keys) {
+    std::string key = path.to_string();
+    for (const auto& k : keys) {
+        key += '\n';
+        key += k;
+    }
+    return key;
+}
+
+} // namespace
+
+Result<std::shared_ptr<AsyncTree>> AsyncTree::create(TreeLikePtr inner, std::string name) {
+    auto config = AsyncTreeService::instance().config();
+    return create(std::move(inner), std::move(name), config.max_age, config.max_in_flight);
+}
+
+Result<std::shared_ptr<AsyncTree>> AsyncTree::create(TreeLikePtr inner, std::string name,
+                                                     double max_age, size_t max_in_flight) {
+    if (!inner) {
+        return Err<std::shared_ptr<AsyncTree>>("AsyncTree::create: no provider to wrap");
+    }
+    if (max_age < 0.0 || max_in_flight == 0) {
+        return Err<std::shared_ptr<AsyncTree>>("AsyncTree::create: max age must not be negative "
+                                               "and max in flight at least 1");
+    }
+    auto state = std::make_shared<State>();
+    state->inner = std::move(inner);
+    state->name = std::move(name);
+    state->max_age = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(max_age));
+    state->max_in_flight = max_in_flight;
+
+    auto tree = std::shared_ptr<AsyncTree>(new AsyncTree(std::move(state)));
+    if (auto res = tree->init(); !res) {
+        return Err<std::shared_ptr<AsyncTree>>("AsyncTree::create failed", res);
+    }
+    return tree;
+}
+
+AsyncTree::~AsyncTree() {
+    dispose();
+}
+
+Result<std::vector<std::string>> AsyncTree::get_children_names(const DataPath& path) {
+    if (auto res = take_write_error(_state); !res) {
+        return Err<std::vector<std::string>>("AsyncTree::get_children_names failed", res);
+    }
+    bool stale = true;
+    return serve<std::vector<std::string>>(_state, &State::children, path.to_string(),
+        [path](TreeLike& tree) { return tree.get_children_names(path); }, stale);
+}
+
+Result<Dict> AsyncTree::get_metadata(const DataPath& path) {
+    if (auto res = take_write_error(_state); !res) {
+        return Err<Dict>("AsyncTree::get_metadata failed", res);
+    }
+    bool stale = true;
+    auto meta = serve<Dict>(_state, &State::metadata, path.to_string(),
+        [path](TreeLike& tree) { return tree.get_metadata(path); }, stale);
+    if (!meta) return meta;
+    (*meta)["stale"] = Value(stale);
+    return meta;
+}
+
+Result<std::vector<std::string>> AsyncTree::get_metadata_keys(const DataPath& path) {
+    auto res = get_metadata(path);
+    if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+    std::vector<std::string> keys;
+    for (const auto& [k, _] : *res) keys.push_back(k);
+    return Ok(keys);
+}
+
+Result<ChildrenMetadata> AsyncTree::get_children_metadata(const DataPath& path,
+                                                         const std::vector<std::string>& keys) {
+    if (auto res = take_write_error(_state); !res) {
+        return Err<ChildrenMetadata>("AsyncTree::get_children_metadata failed", res);
+    }
+    bool stale = true;
+    auto listing = serve<ChildrenMetadata>(_state, &State::children_metadata, listing_key(path, keys),
+        [path, keys](TreeLike& tree) { return tree.get_children_metadata(path, keys); }, stale);
+    if (!listing) return listing;
+    for (size_t k = 0; k < listing->keys.size(); ++k) {
+        if (listing->keys[k] == "stale") {
+            listing->columns[k].assign(listing->size(), Value(stale));
+        }
+    }
+    return listing;
+}
+
+Result<Value> AsyncTree::get(const DataPath& path) {
+    if (path.filename() == "stale") {
+        // True while the node's metadata is pending or failed too
+        const auto node = path.dirname();
+        bool stale = true;
+        (void)serve<Dict>(_state, &State::metadata, node.to_string(),
+            [node](TreeLike& tree) { return tree.get_metadata(node); }, stale);
+        return Ok(Value(stale));
+    }
+    if (auto res = take_write_error(_state); !res) {
+        return Err<Value>("AsyncTree::get failed", res);
+    }
+    bool stale = true;
+    return serve<Value>(_state, &State::values, path.to_string(),
+        [path](TreeLike& tree) { return tree.get(path); }, stale);
+}
+
+Result<void> AsyncTree::set(const DataPath& path, const Value& value) {
+    auto done = write(_state, [path, value](TreeLike& tree) { return tree.set(path, value); },
+                      "set '" + path.to_string() + "'", true);
+    // Only a disposed tree answers at once
+    if (done.wait_for(std::chrono::seconds(0)) == std::future_status::ready) return done.get();
+    return Ok();
+}
+
+Result<void> AsyncTree::add_child(const DataPath& path, const std::string& name, const Dict& data) {
+    auto done = write(_state, [path, name, data](TreeLike& tree) { return tree.add_child(path, name, data); },
+                      "add_child '" + name + "' at '" + path.to_string() + "'", true);
+    if (done.wait_for(std::chrono::seconds(0)) == std::future_status::ready) return done.get();
+    return Ok();
+}
+
+Result<std::string> AsyncTree::as_tree(const DataPath& path, int depth) {
+    std::scoped_lock lock(_state->inner->access_mutex());
+    return _state->inner->as_tree(path, depth);
+}
+
+Result<void> AsyncTree::dispose() {
+    std::vector<std::function<void()>> failures;
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        if (_state->disposed) return Ok();
+        _state->disposed = true;
+        _state->queue.clear();
+        const std::string message = "AsyncTree '" + _state->name + "': disposed";
+        fail_waiters(_state->children, message, failures);
+        fail_waiters(_state->metadata, message, failures);
+        fail_waiters(_state->values, message, failures);
+        fail_waiters(_state->children_metadata, message, failures);
+    }
+    for (auto& fail : failures) fail();
+
+    // A call already running finishes first
+    std::scoped_lock lock(_state->inner->access_mutex());
+    return _state->inner->dispose();
+}
+
+std::future<Result<std::vector<std::string>>> AsyncTree::get_children_names_async(const DataPath& path) {
+    return fetch_async<std::vector<std::string>>(_state, &State::children, path.to_string(),
+        [path](TreeLike& tree) { return tree.get_children_names(path); });
+}
+
+std::future<Result<Dict>> AsyncTree::get_metadata_async(const DataPath& path) {
+    return fetch_async<Dict>(_state, &State::metadata, path.to_string(),
+        [path](TreeLike& tree) { return tree.get_metadata(path); });
+}
+
+std::future<Result<ChildrenMetadata>> AsyncTree::get_children_metadata_async(const DataPath& path,
+                                                                             const std::vector<std::string>& keys) {
+    return fetch_async<ChildrenMetadata>(_state, &State::children_metadata, listing_key(path, keys),
+        [path, keys](TreeLike& tree) { return tree.get_children_metadata(path, keys); });
+}
+
+std::future<Result<Value>> AsyncTree::get_async(const DataPath& path) {
+    return fetch_async<Value>(_state, &State::values, path.to_string(),
+        [path](TreeLike& tree) { return tree.get(path); });
+}
+
+std::future<Result<void>> AsyncTree::set_async(const DataPath& path, const Value& value) {
+    return write(_state, [path, value](TreeLike& tree) { return tree.set(path, value); },
+                 "set '" + path.to_string() + "'", false);
+}
+
+std::future<Result<void>> AsyncTree::add_child_async(const DataPath& path, const std::string& name, const Dict& data) {
+    return write(_state, [path, name, data](TreeLike& tree) { return tree.add_child(path, name, data); },
+                 "add_child '" + name + "' at '" + path.to_string() + "'", false);
+}
+
+TreeLikePtr AsyncTree::inner() const {
+    return _state->inner;
+}
+
+const std::string& AsyncTree::name() const {
+    return _state->name;
+}
+
+size_t AsyncTree::pending() const {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->queue.size() + _state->running;
+}
+
+uint64_t AsyncTree::provider_calls() const {
+    return _state->calls.load(std::memory_order_relaxed);
+}
+
+size_t AsyncTree::peak_in_flight() const {
+    return _state->peak.load();
+}
+
+size_t AsyncTree::cached() const {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->children.size() + _state->metadata.size() + _state->values.size() +
+           _state->children_metadata.size();
+}
+
+} // namespace ymery
@@ -0,0 +1,146 @@
+// Async tree - cached, non-blocking access to slow TreeLike providers
+#pragma once
+
+#include "../types.hpp"
+#include "../result.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ymery {
+
+struct AsyncTreeConfig {
+    size_t threads = 2;        // workers shared by all async providers
+    size_t max_in_flight = 1;  // workers one provider may occupy at once
+    double max_age = 1.0;      // seconds an answer is served before it is refreshed
+    // Kernel providers wrapped in an AsyncTree when they load (none by default)
+    std::vector<std::string> providers;
+};
+
+/**
+ * AsyncTreeService - the worker pool behind every AsyncTree
+ *
+ * Configured once at startup, like IoThreadService. Jobs from all async
+ * providers share the pool; each AsyncTree keeps its own queue and hands
+ * the pool at most max_in_flight jobs at a time, so one slow provider
+ * cannot occupy every worker.
+ */
+class AsyncTreeService {
+public:
+    static AsyncTreeService& instance();
+
+    // Restarts the workers with the new thread count
+    Result<void> configure(const AsyncTreeConfig& config);
+    AsyncTreeConfig config() const;
+
+    bool is_async(const std::string& provider) const;
+
+    // Run job on a worker; the workers start on first use
+    void post(std::function<void()> job);
+    size_t threads() const;
+
+    // Run the queued jobs, then stop the workers
+    void shutdown();
+
+    ~AsyncTreeService();
+
+private:
+    AsyncTreeService() = default;
+    void _start_locked();
+    void _stop();
+    void _worker();
+
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    AsyncTreeConfig _config;
+    std::deque<std::function<void()>> _jobs;
+    std::vector<std::thread> _workers;
+    bool _stopping = false;
+};
+
+/**
+ * AsyncTree - wraps a slow provider so reads never wait for it
+ *
+ * The TreeLike calls answer from a cache at once. A path that was never
+ * read is an error ("... is pending") until its first answer arrives, and
+ * a path whose last fetch failed is that error, so DataBag defaults apply
+ * meanwhile. An answer older than max_age, or made before a write, is
+ * served as is while a refresh is queued. get_metadata adds "stale" (true
+ * until a fresh answer arrives), and get(<node>/stale) reads the same
+ * flag, pending or failed nodes included, so widgets can show that data
+ * is catching up. get_children_metadata is cached per path and key list;
+ * a "stale" key in the list gets the flag of the whole listing.
+ *
+ * set and add_child are queued and acknowledged before the provider has
+ * applied them. A failure is logged and returned by the next read of any
+ * path; use set_async / add_child_async to wait for the outcome.
+ *
+ * The *_async calls always ask the provider and complete with its answer,
+ * refreshing the cache on the way. Requests for a path that is already
+ * being fetched join that fetch.
+ *
+ * Only the service workers call into the wrapped provider, under its
+ * access_mutex, in queue order.
+ */
+class AsyncTree : public TreeLike {
+public:
+    // Max age and concurrency limit come from the service configuration
+    static Result<std::shared_ptr<AsyncTree>> create(TreeLikePtr inner, std::string name = {});
+    static Result<std::shared_ptr<AsyncTree>> create(TreeLikePtr inner, std::string name,
+                                                     double max_age, size_t max_in_flight);
+
+    ~AsyncTree() override;
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override;
+    Result<Dict> get_metadata(const DataPath& path) override;
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override;
+    Result<ChildrenMetadata> get_children_metadata(const DataPath& path,
+                                                   const std::vector<std::string>& keys) override;
+    Result<Value> get(const DataPath& path) override;
+    Result<void> set(const DataPath& path, const Value& value) override;
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override;
+    // Debug only: asks the provider directly
+    Result<std::string> as_tree(const DataPath& path, int depth) override;
+    Result<void> dispose() override;
+
+    std::future<Result<std::vector<std::string>>> get_children_names_async(const DataPath& path);
+    std::future<Result<Dict>> get_metadata_async(const DataPath& path);
+    std::future<Result<ChildrenMetadata>> get_children_metadata_async(const DataPath& path,
+                                                                      const std::vector<std::string>& keys);
+    std::future<Result<Value>> get_async(const DataPath& path);
+    std::future<Result<void>> set_async(const DataPath& path, const Value& value);
+    std::future<Result<void>> add_child_async(const DataPath& path, const std::string& name, const Dict& data);
+
+    TreeLikePtr inner() const;
+    const std::string& name() const;
+    // Jobs queued or running
+    size_t pending() const;
+    // Calls made into the wrapped provider
+    uint64_t provider_calls() const;
+    // Most provider calls under way at once, waiting for its access_mutex included
+    size_t peak_in_flight() const;
+    // Cached answers of all kinds
+    size_t cached() const;
+
+    // Cached answers per kind; above this, the least recently read settled
+    // entries are dropped until EVICT_TO remain
+    static constexpr size_t MAX_CACHED = 4096;
+    static constexpr size_t EVICT_TO = MAX_CACHED * 3 / 4;
+
+    struct State;
+
+private:
+    explicit AsyncTree(std::shared_ptr<State> state) : _state(std::move(state)) {}
+
+    std::shared_ptr<State> _state;
+};
+
+using AsyncTreePtr = std::shared_ptr<AsyncTree>;
+
+} // namespace ymery
@@ -1,95 +1,336 @@
 // Audio buffer implementation
 #include "audio_buffer.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 
 namespace ymery {
 
+namespace {
+
+// Samples are stored and, by lock-free readers (read_from), loaded as
+// relaxed atomics: the seqlock there discards a copy that raced a write,
+// and this keeps the race itself defined
+inline void store_sample(float& dst, float value) {
+    std::atomic_ref<float>(dst).store(value, std::memory_order_relaxed);
+}
+
+inline float load_sample(const float& src) {
+    return std::atomic_ref<float>(const_cast<float&>(src)).load(std::memory_order_relaxed);
+}
+
+void store_samples(float* dst, const float* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        store_sample(dst[i], src[i]);
+    }
+}
+
+} // namespace
+
 // ============== AudioRingBuffer ==============
 
 Result<AudioRingBufferPtr> AudioRingBuffer::create(
     int sample_rate,
     size_t buffer_size,
-    size_t period_size
+    size_t period_size,
+    size_t channels
 ) {
+    if (channels == 0) {
+        return Err<AudioRingBufferPtr>("AudioRingBuffer::create: channels must be greater than zero");
+    }
     auto buffer = std::shared_ptr<AudioRingBuffer>(new AudioRingBuffer());
     buffer->_sample_rate = sample_rate;
     buffer->_buffer_size = buffer_size;
     buffer->_period_size = period_size;
-    buffer->_buffer.resize(buffer_size, 0.0f);
-    buffer->_write_pos = 0;
-    buffer->_available = 0;
+    buffer->_num_channels = channels;
+    buffer->_buffer.resize(buffer_size * channels, 0.0f);
+    buffer->_channels = std::make_unique<Channel[]>(channels);
     return buffer;
 }
 
-void AudioRingBuffer::write(const float* data, size_t count) {
-    if (count == 0 || _buffer_size == 0) return;
+template <typename Fill>
+void AudioRingBuffer::_write_block(size_t frames, Fill&& fill) {
+    if (frames == 0 || _buffer_size == 0) return;
 
-    std::lock_guard<std::mutex> lock(_mutex);
+    int64_t start_ns = audio_now_ns();
+    std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+    const bool contended = !lock.owns_lock();
+    if (contended) {
+        lock.lock();
+    }
 
-    for (size_t i = 0; i < count; ++i) {
-        _buffer[_write_pos] = data[i];
-        _write_pos = (_write_pos + 1) % _buffer_size;
+    // Only the newest buffer_size frames of an oversized block are kept
+    size_t skip = frames > _buffer_size ? frames - _buffer_size : 0;
+    size_t count = frames - skip;
+    uint64_t end = _frames_written.load(std::memory_order_relaxed) + frames;
+    size_t pos = static_cast<size_t>((end - count) % _buffer_size);
+    size_t head = std::min(count, _buffer_size - pos);
+
+    // Announce the frames about to be overwritten to lock-free readers
+    // (read_from): the fence orders this store before the sample stores
+    _frames_writing.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    fill(skip, pos, head);
+    if (head < count) {
+        fill(skip + head, 0, count - head);
+    }
+    _frames_written.store(end, std::memory_order_release);
+
+    for (size_t ch = 0; ch < _num_channels; ++ch) {
+        auto& channel = _channels[ch];
+        const float* plane = _buffer.data() + ch * _buffer_size;
+        for (const auto& tap : channel.taps) {
+            tap->on_write_at(plane + pos, head, end - count);
+            if (head < count) tap->on_write_at(plane, count - head, end - count + head);
+        }
+        auto& stats = channel.stats;
+        if (contended) stats.lock_contention.fetch_add(1, std::memory_order_relaxed);
+        stats.blocks_written.fetch_add(1, std::memory_order_relaxed);
+        stats.samples_written.fetch_add(frames, std::memory_order_relaxed);
+        stats.last_write_ns.store(start_ns, std::memory_order_relaxed);
     }
 
-    // Update available count (capped at buffer size)
-    size_t new_available = _available + count;
-    if (new_available > _buffer_size) {
-        new_available = _buffer_size;
+    int64_t duration = audio_now_ns() - start_ns;
+    for (size_t ch = 0; ch < _num_channels; ++ch) {
+        _channels[ch].stats.write_duration.record(duration);
     }
-    _available = new_available;
+}
+
+void AudioRingBuffer::write(const float* data, size_t count) {
+    write_interleaved(data, count / _num_channels);
 }
 
 void AudioRingBuffer::write(const std::vector<float>& data) {
     write(data.data(), data.size());
 }
 
+void AudioRingBuffer::write_interleaved(const float* data, size_t frames) {
+    const size_t stride = _num_channels;
+    _write_block(frames, [&](size_t offset, size_t pos, size_t n) {
+        if (stride == 1) {
+            store_samples(_buffer.data() + pos, data + offset, n);
+            return;
+        }
+        for (size_t ch = 0; ch < stride; ++ch) {
+            float* dst = _buffer.data() + ch * _buffer_size + pos;
+            const float* src = data + offset * stride + ch;
+            for (size_t i = 0; i < n; ++i) {
+                store_sample(dst[i], src[i * stride]);
+            }
+        }
+    });
+}
+
+void AudioRingBuffer::write_interleaved(const int16_t* data, size_t frames) {
+    constexpr float scale = 1.0f / 32768.0f;
+    const size_t stride = _num_channels;
+    _write_block(frames, [&](size_t offset, size_t pos, size_t n) {
+        for (size_t ch = 0; ch < stride; ++ch) {
+            float* dst = _buffer.data() + ch * _buffer_size + pos;
+            const int16_t* src = data + offset * stride + ch;
+            for (size_t i = 0; i < n; ++i) {
+                store_sample(dst[i], src[i * stride] * scale);
+            }
+        }
+    });
+}
+
+void AudioRingBuffer::write_planar(const float* const* data, size_t frames) {
+    _write_block(frames, [&](size_t offset, size_t pos, size_t n) {
+        for (size_t ch = 0; ch < _num_channels; ++ch) {
+            float* dst = _buffer.data() + ch * _buffer_size + pos;
+            if (data[ch]) {
+                store_samples(dst, data[ch] + offset, n);
+            } else {
+                for (size_t i = 0; i < n; ++i) store_sample(dst[i], 0.0f);
+            }
+        }
+    });
+}
+
+void AudioRingBuffer::write_strided(const float* const* data, const size_t* stride, size_t frames) {
+    _write_block(frames, [&](size_t offset, size_t pos, size_t n) {
+        for (size_t ch = 0; ch < _num_channels; ++ch) {
+            float* dst = _buffer.data() + ch * _buffer_size + pos;
+            const size_t step = stride[ch];
+            if (step == 1) {
+                store_samples(dst, data[ch] + offset, n);
+                continue;
+            }
+            const float* src = data[ch] + offset * step;
+            for (size_t i = 0; i < n; ++i) {
+                store_sample(dst[i], src[i * step]);
+            }
+        }
+    });
+}
+
+void AudioRingBuffer::write_strided(const int16_t* const* data, const size_t* stride, size_t frames) {
+    constexpr float scale = 1.0f / 32768.0f;
+    _write_block(frames, [&](size_t offset, size_t pos, size_t n) {
+        for (size_t ch = 0; ch < _num_channels; ++ch) {
+            float* dst = _buffer.data() + ch * _buffer_size + pos;
+            const size_t step = stride[ch];
+            const int16_t* src = data[ch] + offset * step;
+            for (size_t i = 0; i < n; ++i) {
+                store_sample(dst[i], src[i * step] * scale);
+            }
+        }
+    });
+}
+
+void AudioRingBuffer::_copy_channel(size_t channel, uint64_t end, size_t frames, float* out) const {
+    const float* plane = _buffer.data() + channel * _buffer_size;
+    size_t pos = static_cast<size_t>((end - frames) % _buffer_size);
+    size_t head = std::min(frames, _buffer_size - pos);
+    std::memcpy(out, plane + pos, head * sizeof(float));
+    std::memcpy(out + head, plane, (frames - head) * sizeof(float));
+}
+
+void AudioRingBuffer::_load_channel(size_t channel, uint64_t end, size_t frames, float* out) const {
+    const float* plane = _buffer.data() + channel * _buffer_size;
+    size_t pos = static_cast<size_t>((end - frames) % _buffer_size);
+    size_t head = std::min(frames, _buffer_size - pos);
+    for (size_t i = 0; i < head; ++i) out[i] = load_sample(plane[pos + i]);
+    for (size_t i = head; i < frames; ++i) out[i] = load_sample(plane[i - head]);
+}
+
 std::vector<float> AudioRingBuffer::read_all() const {
+    return read_channel(0);
+}
+
+std::vector<float> AudioRingBuffer::read_channel(size_t channel) const {
+    if (channel >= _num_channels) return {};
     std::lock_guard<std::mutex> lock(_mutex);
 
-    size_t avail = _available;
+    uint64_t end = _frames_written.load(std::memory_order_relaxed);
+    size_t avail = static_cast<size_t>(std::min<uint64_t>(end, _buffer_size));
     if (avail == 0) return {};
 
     std::vector<float> result(avail);
+    _copy_channel(channel, end, avail, result.data());
+    return result;
+}
 
-    // Calculate read position (oldest data)
-    size_t read_pos = (_write_pos + _buffer_size - avail) % _buffer_size;
+uint64_t AudioRingBuffer::read_frames(
+    const std::vector<size_t>& channels,
+    size_t frames,
+    std::vector<std::vector<float>>& out
+) const {
+    out.resize(channels.size());
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    for (size_t i = 0; i < avail; ++i) {
-        result[i] = _buffer[(read_pos + i) % _buffer_size];
+    uint64_t end = _frames_written.load(std::memory_order_relaxed);
+    size_t avail = static_cast<size_t>(std::min<uint64_t>(end, _buffer_size));
+    size_t count = frames == 0 ? avail : std::min(frames, avail);
+    for (size_t i = 0; i < channels.size(); ++i) {
+        if (channels[i] >= _num_channels) {
+            out[i].clear();
+            continue;
+        }
+        out[i].resize(count);
+        _copy_channel(channels[i], end, count, out[i].data());
     }
+    return end;
+}
 
-    return result;
+size_t AudioRingBuffer::read_from(size_t channel, uint64_t& from, size_t frames, float* out) const {
+    if (channel >= _num_channels || _buffer_size == 0) return 0;
+
+    // Seqlock on the frame index instead of _mutex: copy what was published,
+    // then check whether a write started meanwhile reached the copied frames
+    uint64_t end = _frames_written.load(std::memory_order_acquire);
+    uint64_t oldest = end - std::min<uint64_t>(end, _buffer_size);
+    from = std::clamp(from, oldest, end);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(frames, end - from));
+    if (count == 0) return 0;
+    _load_channel(channel, from + count, count, out);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t writing = _frames_writing.load(std::memory_order_relaxed);
+    uint64_t valid = writing - std::min<uint64_t>(writing, _buffer_size);
+    if (valid > from) {
+        // The oldest copied frames may be torn: drop them, keep the rest
+        size_t lost = static_cast<size_t>(std::min<uint64_t>(valid - from, count));
+        std::memmove(out, out + lost, (count - lost) * sizeof(float));
+        count -= lost;
+        from += lost;
+    }
+    from += count;
+    return count;
 }
 
 size_t AudioRingBuffer::size() const {
-    return _available;
+    return static_cast<size_t>(std::min<uint64_t>(frames_written(), _buffer_size));
 }
 
-bool AudioRingBuffer::try_lock() {
+bool AudioRingBuffer::try_lock(size_t channel) {
+    if (channel >= _num_channels) return false;
+    auto& state = _channels[channel];
     bool expected = false;
-    return _locked.compare_exchange_strong(expected, true);
+    if (state.locked.compare_exchange_strong(expected, true)) {
+        return true;
+    }
+    state.stats.lock_contention.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
-void AudioRingBuffer::unlock() {
-    _locked = false;
+void AudioRingBuffer::unlock(size_t channel) {
+    if (channel < _num_channels) {
+        _channels[channel].locked = false;
+    }
+}
+
+void AudioRingBuffer::add_tap(AudioTapPtr tap, size_t channel) {
+    if (!tap || channel >= _num_channels) return;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _channels[channel].taps.push_back(std::move(tap));
+}
+
+void AudioRingBuffer::remove_tap(const AudioTapPtr& tap) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t ch = 0; ch < _num_channels; ++ch) {
+        auto& taps = _channels[ch].taps;
+        taps.erase(std::remove(taps.begin(), taps.end(), tap), taps.end());
+    }
 }
 
 // ============== MediatedAudioBuffer ==============
 
-Result<MediatedAudioBufferPtr> MediatedAudioBuffer::create(AudioRingBufferPtr ring_buffer) {
+Result<MediatedAudioBufferPtr> MediatedAudioBuffer::create(AudioRingBufferPtr ring_buffer, size_t channel) {
     if (!ring_buffer) {
         return Err<MediatedAudioBufferPtr>("MediatedAudioBuffer::create: null ring buffer");
     }
+    if (channel >= ring_buffer->channels()) {
+        return Err<MediatedAudioBufferPtr>("MediatedAudioBuffer::create: channel " + std::to_string(channel)
+            + " out of range (" + std::to_string(ring_buffer->channels()) + " channels)");
+    }
 
     auto buffer = std::shared_ptr<MediatedAudioBuffer>(new MediatedAudioBuffer());
     buffer->_ring_buffer = ring_buffer;
+    buffer->_channel = channel;
     return buffer;
 }
 
 std::vector<float> MediatedAudioBuffer::data() const {
     if (!_ring_buffer) return {};
-    return _ring_buffer->read_all();
+
+    auto& stats = _ring_buffer->stats(_channel);
+    uint64_t total = stats.samples_written.load(std::memory_order_relaxed);
+    stats.reads.fetch_add(1, std::memory_order_relaxed);
+    uint64_t previous = _last_read_total.exchange(total, std::memory_order_relaxed);
+    if (total == previous) {
+        stats.underruns.fetch_add(1, std::memory_order_relaxed);
+    } else if (total - previous > _ring_buffer->buffer_size() && previous != 0) {
+        stats.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (int64_t last = stats.last_write_ns.load(std::memory_order_relaxed)) {
+        stats.read_lag.record(audio_now_ns() - last);
+    }
+
+    return _ring_buffer->read_channel(_channel);
 }
 
 size_t MediatedAudioBuffer::size() const {
@@ -99,15 +340,32 @@ size_t MediatedAudioBuffer::size() const {
 
 bool MediatedAudioBuffer::try_lock() {
     if (!_ring_buffer) return false;
-    return _ring_buffer->try_lock();
+    return _ring_buffer->try_lock(_channel);
 }
 
 void MediatedAudioBuffer::unlock() {
     if (_ring_buffer) {
-        _ring_buffer->unlock();
+        _ring_buffer->unlock(_channel);
+    }
+}
+
+void MediatedAudioBuffer::add_tap(AudioTapPtr tap) {
+    if (_ring_buffer) {
+        _ring_buffer->add_tap(std::move(tap), _channel);
+    }
+}
+
+void MediatedAudioBuffer::remove_tap(const AudioTapPtr& tap) {
+    if (_ring_buffer) {
+        _ring_buffer->remove_tap(tap);
     }
 }
 
+const AudioBufferStats* MediatedAudioBuffer::stats() const {
+    if (!_ring_buffer) return nullptr;
+    return &_ring_buffer->stats(_channel);
+}
+
 int MediatedAudioBuffer::sample_rate() const {
     if (!_ring_buffer) return 0;
     return _ring_buffer->sample_rate();
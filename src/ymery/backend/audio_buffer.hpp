@@ -2,6 +2,7 @@
 #pragma once
 
 #include "../result.hpp"
+#include "audio_stats.hpp"
 #include <vector>
 #include <mutex>
 #include <atomic>
@@ -16,7 +17,9 @@ class MediatedAudioBuffer;
 class StaticAudioBuffer;
 class FileAudioBuffer;
 class StaticAudioBufferMediator;
+class AudioTap;
 
+using AudioTapPtr = std::shared_ptr<AudioTap>;
 using AudioRingBufferPtr = std::shared_ptr<AudioRingBuffer>;
 using MediatedAudioBufferPtr = std::shared_ptr<MediatedAudioBuffer>;
 using StaticAudioBufferPtr = std::shared_ptr<StaticAudioBuffer>;
@@ -24,57 +27,122 @@ using FileAudioBufferPtr = std::shared_ptr<FileAudioBuffer>;
 using StaticAudioBufferMediatorPtr = std::shared_ptr<StaticAudioBufferMediator>;
 
 /**
- * Lock-free audio ring buffer for single producer, multiple consumers
- * Stores float samples in a circular buffer
+ * Tap - observes every block written to a ring buffer
+ * Called on the producer thread, so implementations must not block or allocate
+ */
+class AudioTap {
+public:
+    virtual ~AudioTap() = default;
+    virtual void on_write(const float* data, size_t count) = 0;
+    // The same block with the ring's frame index of data[0]; taps that line
+    // up channels of one ring by frame override this
+    virtual void on_write_at(const float* data, size_t count, uint64_t /*frame*/) { on_write(data, count); }
+};
+
+/**
+ * Multichannel block ring buffer - one per device, single producer, multiple consumers
+ *
+ * Channels are stored planar (_buffer[channel * buffer_size + frame]) and
+ * share one frame index, so a period is published with one lock and one
+ * index update, and reads of several channels see the same frames.
+ * A ring created with one channel behaves as the former per-channel ring.
  */
 class AudioRingBuffer {
 public:
     static Result<AudioRingBufferPtr> create(
         int sample_rate,
-        size_t buffer_size,
-        size_t period_size
+        size_t buffer_size,      // frames per channel
+        size_t period_size,
+        size_t channels = 1
     );
 
-    // Producer interface
-    void write(const float* data, size_t count);
+    // Producer interface - one block of frames for all channels
+    void write(const float* data, size_t count);  // interleaved, count in samples
     void write(const std::vector<float>& data);
+    void write_interleaved(const float* data, size_t frames);
+    void write_interleaved(const int16_t* data, size_t frames);  // S16, scaled to [-1, 1)
+    void write_planar(const float* const* data, size_t frames);  // one pointer per channel
+    // Sample i of channel ch at data[ch][i * stride[ch]] - deinterleaves
+    // straight from a driver's DMA area (ALSA mmap channel areas)
+    void write_strided(const float* const* data, const size_t* stride, size_t frames);
+    void write_strided(const int16_t* const* data, const size_t* stride, size_t frames);
 
     // Consumer interface - returns copy of data
-    std::vector<float> read_all() const;
-    size_t size() const;
+    std::vector<float> read_all() const;  // channel 0
+    std::vector<float> read_channel(size_t channel) const;
+    // Newest `frames` frames (0: all available) of the given channels, taken
+    // under one lock so they are sample-aligned; returns the frame index
+    // just past the newest frame read
+    uint64_t read_frames(const std::vector<size_t>& channels, size_t frames,
+                         std::vector<std::vector<float>>& out) const;
+    // Frames [from, from + frames) of one channel without allocating or
+    // locking, for real-time readers that keep their own position. Frames
+    // already overwritten, or overwritten while copying, are skipped; returns
+    // how many were copied and advances from past the skipped and copied ones.
+    size_t read_from(size_t channel, uint64_t& from, size_t frames, float* out) const;
+    size_t size() const;  // frames available per channel
+    uint64_t frames_written() const { return _frames_written.load(std::memory_order_acquire); }
 
     // Properties
     int sample_rate() const { return _sample_rate; }
     size_t buffer_size() const { return _buffer_size; }
     size_t period_size() const { return _period_size; }
+    size_t channels() const { return _num_channels; }
 
     // Thread-safe access
-    bool try_lock();
-    void unlock();
+    bool try_lock(size_t channel = 0);
+    void unlock(size_t channel = 0);
+
+    // Taps (recorders, analyzers) - see every block written to their channel.
+    // Blocks longer than the ring only reach taps with their newest buffer_size frames.
+    void add_tap(AudioTapPtr tap, size_t channel = 0);
+    void remove_tap(const AudioTapPtr& tap);
+
+    // Instrumentation per channel - block timestamps, contention and consumer lag
+    AudioBufferStats& stats(size_t channel = 0) { return _channels[channel].stats; }
+    const AudioBufferStats& stats(size_t channel = 0) const { return _channels[channel].stats; }
 
 private:
     AudioRingBuffer() = default;
 
+    struct Channel {
+        std::vector<AudioTapPtr> taps;
+        std::atomic<bool> locked{false};
+        AudioBufferStats stats;
+    };
+
+    // Lock, let `fill(offset, pos, n)` copy n frames starting at block
+    // offset into ring position pos (at most twice per block, no wrap
+    // inside), then publish the block and run the taps
+    template <typename Fill>
+    void _write_block(size_t frames, Fill&& fill);
+    // Copy the `frames` frames before `end`: under _mutex (copy), or racing
+    // the producer with relaxed atomic loads that match its stores (load)
+    void _copy_channel(size_t channel, uint64_t end, size_t frames, float* out) const;
+    void _load_channel(size_t channel, uint64_t end, size_t frames, float* out) const;
+
     int _sample_rate = 48000;
     size_t _buffer_size = 0;
     size_t _period_size = 1024;
+    size_t _num_channels = 1;
 
     std::vector<float> _buffer;
-    std::atomic<size_t> _write_pos{0};
-    std::atomic<size_t> _available{0};
+    std::atomic<uint64_t> _frames_written{0};
+    std::atomic<uint64_t> _frames_writing{0};  // end of the block being written
     mutable std::mutex _mutex;
-    std::atomic<bool> _locked{false};
+    std::unique_ptr<Channel[]> _channels;
 };
 
 /**
- * Mediated buffer - provides read access to underlying ring buffer
- * Multiple consumers can have their own mediated buffer
+ * Mediated buffer - read view of one channel of a device ring buffer
+ * Multiple consumers can have their own mediated buffer; views of different
+ * channels of the same ring read frames from the same periods.
  */
 class MediatedAudioBuffer {
 public:
-    static Result<MediatedAudioBufferPtr> create(AudioRingBufferPtr ring_buffer);
+    static Result<MediatedAudioBufferPtr> create(AudioRingBufferPtr ring_buffer, size_t channel = 0);
 
-    // Consumer interface
+    // Consumer interface - each read updates the channel's lag/underrun stats
     std::vector<float> data() const;
     size_t size() const;
 
@@ -82,12 +150,25 @@ public:
     bool try_lock();
     void unlock();
 
+    // Taps delegate to the underlying ring buffer, on this view's channel
+    void add_tap(AudioTapPtr tap);
+    void remove_tap(const AudioTapPtr& tap);
+
     // Properties
     int sample_rate() const;
+    size_t channel() const { return _channel; }
+    // Device ring, for consumers that read several channels aligned
+    const AudioRingBufferPtr& ring() const { return _ring_buffer; }
+
+    // Instrumentation of this channel of the underlying ring buffer
+    const AudioBufferStats* stats() const;
 
 private:
     MediatedAudioBuffer() = default;
     AudioRingBufferPtr _ring_buffer;
+    size_t _channel = 0;
+    // samples_written at the previous read; data() may run on several threads at once
+    mutable std::atomic<uint64_t> _last_read_total{0};
 };
 
 /**
@@ -0,0 +1,646 @@
+// Audio engine implementation
+#include "audio_engine.hpp"
+#include "audio_recorder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <optional>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+namespace {
+
+constexpr uint64_t SLOT_MASK = 0xFFFFFFFFull;
+
+// Equal-power pan: both sides at -3 dB in the center
+void pan_gains(float gain, float pan, float& left, float& right) {
+    float angle = (std::clamp(pan, -1.0f, 1.0f) + 1.0f) * static_cast<float>(std::numbers::pi / 4.0);
+    left = gain * std::cos(angle);
+    right = gain * std::sin(angle);
+}
+
+std::optional<double> option_number(const Dict& options, const std::string& key) {
+    auto it = options.find(key);
+    if (it == options.end()) return std::nullopt;
+    if (auto d = get_as<double>(it->second)) return d;
+    if (auto i = get_as<int>(it->second)) return static_cast<double>(*i);
+    if (auto i = get_as<int64_t>(it->second)) return static_cast<double>(*i);
+    return std::nullopt;
+}
+
+std::optional<std::string> option_string(const Dict& options, const std::string& key) {
+    auto it = options.find(key);
+    if (it == options.end()) return std::nullopt;
+    return get_as<std::string>(it->second);
+}
+
+} // namespace
+
+// ============== Sources ==============
+
+OscillatorSource::OscillatorSource(WaveformKind kind, double frequency, int sample_rate)
+    : _oscillator(kind, frequency, sample_rate), _frequency(frequency) {}
+
+size_t OscillatorSource::render(float* out, size_t frames) {
+    double frequency = _frequency.load(std::memory_order_relaxed);
+    if (frequency != _oscillator.frequency()) {
+        _oscillator.set_frequency(frequency);
+    }
+    _oscillator.render(out, frames);
+    return frames;
+}
+
+BufferSource::BufferSource(StaticAudioBufferPtr buffer, bool loop)
+    : _buffer(std::move(buffer)), _loop(loop) {}
+
+size_t BufferSource::render(float* out, size_t frames) {
+    if (!_buffer) return 0;
+    const auto& data = _buffer->data();
+    const uint64_t size = data.size();
+    if (size == 0) return 0;
+
+    uint64_t pos = _position.load(std::memory_order_relaxed);
+    size_t done = 0;
+    while (done < frames) {
+        if (pos >= size) {
+            if (!_loop) break;
+            pos = 0;
+        }
+        size_t n = static_cast<size_t>(std::min<uint64_t>(frames - done, size - pos));
+        std::copy_n(data.data() + pos, n, out + done);
+        pos += n;
+        done += n;
+    }
+    _position.store(pos, std::memory_order_relaxed);
+    return done;
+}
+
+StreamSource::StreamSource(AudioRingBufferPtr ring, size_t channel, size_t latency_frames)
+    : _ring(std::move(ring)), _channel(channel), _latency(latency_frames) {}
+
+size_t StreamSource::render(float* out, size_t frames) {
+    if (!_ring) return 0;
+    if (!_started) {
+        uint64_t written = _ring->frames_written();
+        _cursor = written > _latency ? written - _latency : 0;
+        _started = true;
+    }
+    size_t n = _ring->read_from(_channel, _cursor, frames, out);
+    if (n < frames) {
+        std::fill(out + n, out + frames, 0.0f);
+        _underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return frames;
+}
+
+// ============== AudioEngineStats ==============
+
+Dict AudioEngineStats::to_dict() const {
+    return Dict{
+        {"blocks", Value(static_cast<int64_t>(blocks.load(std::memory_order_relaxed)))},
+        {"frames", Value(static_cast<int64_t>(frames.load(std::memory_order_relaxed)))},
+        {"active-voices", Value(static_cast<int64_t>(active_voices.load(std::memory_order_relaxed)))},
+        {"commands-dropped", Value(static_cast<int64_t>(commands_dropped.load(std::memory_order_relaxed)))},
+        {"voices-dropped", Value(static_cast<int64_t>(voices_dropped.load(std::memory_order_relaxed)))},
+        {"render-duration", Value(render_duration.to_dict())}
+    };
+}
+
+// ============== AudioEngine ==============
+
+Result<AudioEnginePtr> AudioEngine::create(const AudioEngineConfig& config) {
+    if (config.sample_rate <= 0) {
+        return Err<AudioEnginePtr>("AudioEngine: sample_rate must be positive");
+    }
+    if (config.channels == 0 || config.block_frames == 0 || config.queue_size == 0) {
+        return Err<AudioEnginePtr>("AudioEngine: channels, block_frames and queue_size must be greater than zero");
+    }
+    if (config.max_voices == 0 || config.max_voices > SLOT_MASK) {
+        return Err<AudioEnginePtr>("AudioEngine: max_voices out of range");
+    }
+
+    auto engine = std::shared_ptr<AudioEngine>(new AudioEngine());
+    engine->_config = config;
+    engine->_voices.resize(config.max_voices);
+    engine->_slots.resize(config.max_voices);
+    engine->_scratch.resize(config.block_frames);
+    engine->_commands = std::make_unique<SpscQueue<Command>>(config.queue_size);
+    // A slot is reused only after its retirement was collected, so
+    // max_voices entries always suffice
+    engine->_retired = std::make_unique<SpscQueue<Retired>>(config.max_voices);
+    return engine;
+}
+
+AudioEngine::~AudioEngine() {
+    if (_sink) {
+        _sink->stop();
+    }
+}
+
+Result<void> AudioEngine::start(AudioSinkPtr sink) {
+    if (!sink) {
+        return Err<void>("AudioEngine::start: null sink");
+    }
+    if (is_running()) {
+        return Err<void>("AudioEngine::start: already running on a '" + _sink->kind() + "' sink");
+    }
+    if (_sink) {
+        _sink->stop();  // previous sink ran out by itself; join it before replacing
+    }
+    if (auto res = sink->start(_config, [this](float* out, size_t frames) { render(out, frames); }); !res) {
+        return Err<void>("AudioEngine::start: sink '" + sink->kind() + "' failed to start", res);
+    }
+    _sink = std::move(sink);
+    ydebug("AudioEngine: started on '{}' sink ({} Hz, {} ch, {} frames per block)",
+           _sink->kind(), _config.sample_rate, _config.channels, _config.block_frames);
+    return Ok();
+}
+
+Result<void> AudioEngine::stop() {
+    if (!_sink) return Ok();
+    if (auto res = _sink->stop(); !res) {
+        return Err<void>("AudioEngine::stop: sink '" + _sink->kind() + "' failed", res);
+    }
+    return Ok();
+}
+
+Result<VoiceId> AudioEngine::play(AudioSourcePtr source, float gain, float pan) {
+    if (!source) {
+        return Err<VoiceId>("AudioEngine::play: null source");
+    }
+    collect();
+
+    auto it = std::find_if(_slots.begin(), _slots.end(), [](const Slot& s) { return !s.busy; });
+    if (it == _slots.end()) {
+        _stats.voices_dropped.fetch_add(1, std::memory_order_relaxed);
+        return Err<VoiceId>("AudioEngine::play: all " + std::to_string(_slots.size()) + " voices busy");
+    }
+    auto slot = static_cast<uint32_t>(it - _slots.begin());
+    if (++it->generation == 0) ++it->generation;
+
+    Command command;
+    command.op = Op::Start;
+    command.slot = slot;
+    command.generation = it->generation;
+    command.value = gain;
+    command.pan = pan;
+    command.source = std::move(source);
+    if (auto res = _send(std::move(command)); !res) {
+        return Err<VoiceId>("AudioEngine::play failed", res);
+    }
+    it->busy = true;
+    return Ok((static_cast<VoiceId>(it->generation) << 32) | slot);
+}
+
+Result<void> AudioEngine::release(VoiceId voice) {
+    collect();
+    Command command;
+    if (!_find(voice, command.slot, command.generation)) {
+        return Err<void>("AudioEngine::release: voice not playing");
+    }
+    command.op = Op::Release;
+    return _send(std::move(command));
+}
+
+Result<void> AudioEngine::set_gain(VoiceId voice, float gain) {
+    collect();
+    Command command;
+    if (!_find(voice, command.slot, command.generation)) {
+        return Err<void>("AudioEngine::set_gain: voice not playing");
+    }
+    command.op = Op::Gain;
+    command.value = gain;
+    return _send(std::move(command));
+}
+
+Result<void> AudioEngine::set_pan(VoiceId voice, float pan) {
+    collect();
+    Command command;
+    if (!_find(voice, command.slot, command.generation)) {
+        return Err<void>("AudioEngine::set_pan: voice not playing");
+    }
+    command.op = Op::Pan;
+    command.value = pan;
+    return _send(std::move(command));
+}
+
+bool AudioEngine::is_playing(VoiceId voice) {
+    collect();
+    uint32_t slot, generation;
+    return _find(voice, slot, generation);
+}
+
+void AudioEngine::collect() {
+    Retired retired;
+    while (_retired->try_pop(retired)) {
+        auto& slot = _slots[retired.slot];
+        if (slot.generation == retired.generation) {
+            slot.busy = false;
+        }
+        retired.source.reset();
+    }
+}
+
+Result<void> AudioEngine::_send(Command command) {
+    Command* slot = _commands->begin_push();
+    if (!slot) {
+        _stats.commands_dropped.fetch_add(1, std::memory_order_relaxed);
+        return Err<void>("AudioEngine: control queue full");
+    }
+    *slot = std::move(command);
+    _commands->commit_push();
+    return Ok();
+}
+
+bool AudioEngine::_find(VoiceId voice, uint32_t& slot, uint32_t& generation) const {
+    slot = static_cast<uint32_t>(voice & SLOT_MASK);
+    generation = static_cast<uint32_t>(voice >> 32);
+    return slot < _slots.size() && _slots[slot].busy && _slots[slot].generation == generation && generation != 0;
+}
+
+void AudioEngine::render(float* out, size_t frames) {
+    int64_t start_ns = audio_now_ns();
+    _apply_commands();
+
+    const size_t channels = _config.channels;
+    std::fill(out, out + frames * channels, 0.0f);
+    for (size_t done = 0; done < frames;) {
+        size_t n = std::min(frames - done, _config.block_frames);
+        _mix(out + done * channels, n);
+        done += n;
+        _stats.blocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _stats.frames.fetch_add(frames, std::memory_order_relaxed);
+    _stats.render_duration.record(audio_now_ns() - start_ns);
+}
+
+void AudioEngine::_apply_commands() {
+    while (Command* command = _commands->front()) {
+        auto& voice = _voices[command->slot];
+        const bool current = voice.source && voice.generation == command->generation;
+        switch (command->op) {
+            case Op::Start:
+                voice.source = std::move(command->source);
+                voice.generation = command->generation;
+                voice.gain = command->value;
+                voice.pan = command->pan;
+                voice.current[0] = voice.current[1] = 0.0f;
+                voice.releasing = false;
+                break;
+            case Op::Release:
+                if (current) voice.releasing = true;
+                break;
+            case Op::Gain:
+                if (current) voice.gain = command->value;
+                break;
+            case Op::Pan:
+                if (current) voice.pan = command->value;
+                break;
+        }
+        _commands->pop();
+    }
+}
+
+void AudioEngine::_mix(float* out, size_t frames) {
+    const size_t channels = _config.channels;
+    const float inv = 1.0f / static_cast<float>(frames);
+    float* scratch = _scratch.data();
+    uint64_t active = 0;
+
+    for (uint32_t i = 0; i < _voices.size(); ++i) {
+        auto& voice = _voices[i];
+        if (!voice.source) continue;
+
+        size_t produced = voice.source->render(scratch, frames);
+        if (produced < frames) {
+            std::fill(scratch + produced, scratch + frames, 0.0f);
+        }
+
+        // Ramp from the applied gains to the targets over the block
+        float target[2] = {0.0f, 0.0f};
+        if (!voice.releasing) {
+            if (channels == 1) {
+                target[0] = voice.gain;
+            } else {
+                pan_gains(voice.gain, voice.pan, target[0], target[1]);
+            }
+        }
+        const float step0 = (target[0] - voice.current[0]) * inv;
+        const float step1 = (target[1] - voice.current[1]) * inv;
+        float g0 = voice.current[0];
+        float g1 = voice.current[1];
+        if (channels == 1) {
+            for (size_t f = 0; f < frames; ++f) {
+                g0 += step0;
+                out[f] += scratch[f] * g0;
+            }
+        } else {
+            for (size_t f = 0; f < frames; ++f) {
+                g0 += step0;
+                g1 += step1;
+                out[f * channels] += scratch[f] * g0;
+                out[f * channels + 1] += scratch[f] * g1;
+            }
+        }
+        voice.current[0] = target[0];
+        voice.current[1] = target[1];
+
+        if (voice.releasing || produced < frames) {
+            _retire(i);
+        } else {
+            ++active;
+        }
+    }
+
+    const float master = _master_gain.load(std::memory_order_relaxed);
+    if (master != 1.0f || _current_master != 1.0f) {
+        const float step = (master - _current_master) * inv;
+        float g = _current_master;
+        for (size_t f = 0; f < frames; ++f) {
+            g += step;
+            for (size_t c = 0; c < channels; ++c) out[f * channels + c] *= g;
+        }
+        _current_master = master;
+    }
+    _stats.active_voices.store(active, std::memory_order_relaxed);
+}
+
+void AudioEngine::_retire(uint32_t slot) {
+    auto& voice = _voices[slot];
+    Retired* retired = _retired->begin_push();
+    if (!retired) return;  // not reached: see create()
+    retired->slot = slot;
+    retired->generation = voice.generation;
+    retired->source = std::move(voice.source);
+    _retired->commit_push();
+    voice.releasing = false;
+}
+
+// ============== ClockedAudioSink ==============
+
+ClockedAudioSink::ClockedAudioSink(double speed, uint64_t max_frames)
+    : _speed(std::max(0.0, speed)), _max_frames(max_frames) {}
+
+ClockedAudioSink::~ClockedAudioSink() {
+    stop();
+}
+
+Result<void> ClockedAudioSink::start(const AudioEngineConfig& config, AudioRenderFn render) {
+    if (_thread.joinable()) {
+        return Err<void>("ClockedAudioSink::start: already started");
+    }
+    if (!render) {
+        return Err<void>("ClockedAudioSink::start: no render function");
+    }
+    _config = config;
+    _render = std::move(render);
+    _block.assign(config.block_frames * config.channels, 0.0f);
+    _frames_played = 0;
+    _consume_failed = false;
+
+    if (auto res = _open(config); !res) {
+        return Err<void>("ClockedAudioSink::start: open failed", res);
+    }
+    _stop = false;
+    _running = true;
+    // Free-running sinks have no period to miss
+    const int64_t period =
+        _speed > 0.0 ? static_cast<int64_t>(io_period_ns(config.block_frames, config.sample_rate) / _speed) : 0;
+    _thread.start("engine:" + kind(), period, [this] { _run(); });
+    return Ok();
+}
+
+Result<void> ClockedAudioSink::stop() {
+    if (!_thread.joinable()) return Ok();
+    _stop = true;
+    _thread.join();
+    _running = false;
+
+    auto close_res = _close();
+    if (_consume_failed) return Err<void>("ClockedAudioSink::stop: output failed while running");
+    if (!close_res) return Err<void>("ClockedAudioSink::stop: close failed", close_res);
+    return Ok();
+}
+
+double ClockedAudioSink::virtual_time() const {
+    if (_config.sample_rate <= 0) return 0.0;
+    return static_cast<double>(frames_played()) / _config.sample_rate;
+}
+
+void ClockedAudioSink::_run() {
+    using Clock = std::chrono::steady_clock;
+    // Cap the sleep so stop() is honoured promptly at low speeds
+    constexpr auto max_sleep = std::chrono::milliseconds(20);
+    const double frames_per_second = _config.sample_rate * _speed;
+    auto frames_duration = [&](uint64_t frames) {
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(frames) / frames_per_second));
+    };
+    const auto late_limit = _speed > 0.0 ? frames_duration(LATE_BLOCKS * _config.block_frames) : Clock::duration{};
+
+    // Deadlines derive from the anchor, so wakeup jitter never accumulates
+    auto anchor = Clock::now();
+    uint64_t anchor_frames = 0;
+    uint64_t played = 0;
+
+    while (!_stop.load(std::memory_order_acquire)) {
+        size_t frames = _config.block_frames;
+        if (_max_frames > 0) {
+            if (played >= _max_frames) break;
+            frames = static_cast<size_t>(std::min<uint64_t>(frames, _max_frames - played));
+        }
+
+        if (_speed > 0.0) {
+            auto due = anchor + frames_duration(played - anchor_frames);
+            auto now = Clock::now();
+            if (now - due > late_limit) {
+                _stats.record_xrun();
+                anchor = now;
+                anchor_frames = played;
+            }
+            while (due > now && !_stop.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_until(std::min(due, now + max_sleep));
+                now = Clock::now();
+            }
+            if (_stop.load(std::memory_order_relaxed)) break;
+        }
+        _thread.beat();
+
+        {
+            auto scope = _stats.time_callback();
+            _render(_block.data(), frames);
+        }
+        if (auto res = _consume(_block.data(), frames); !res) {
+            ywarn("ClockedAudioSink: '{}' output failed: {}", kind(), error_msg(res));
+            _consume_failed = true;
+            break;
+        }
+        played += frames;
+        _frames_played.store(played, std::memory_order_relaxed);
+    }
+    _running.store(false, std::memory_order_release);
+}
+
+// ============== NullAudioSink ==============
+
+Result<AudioSinkPtr> NullAudioSink::create(double speed, uint64_t max_frames) {
+    return AudioSinkPtr(new NullAudioSink(speed, max_frames));
+}
+
+Result<void> NullAudioSink::_consume(const float* interleaved, size_t frames) {
+    const size_t samples = frames * output_config().channels;
+    float peak = _peak.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < samples; ++i) {
+        peak = std::max(peak, std::abs(interleaved[i]));
+    }
+    _peak.store(peak, std::memory_order_relaxed);
+    return Ok();
+}
+
+// ============== FileAudioSink ==============
+
+Result<AudioSinkPtr> FileAudioSink::create(
+    const std::string& file_path,
+    const std::string& format,
+    double speed,
+    uint64_t max_frames
+) {
+    if (file_path.empty()) {
+        return Err<AudioSinkPtr>("FileAudioSink: file path required");
+    }
+    const auto& formats = AudioRecorder::supported_formats();
+    if (std::find(formats.begin(), formats.end(), format) == formats.end()) {
+        return Err<AudioSinkPtr>("FileAudioSink: unsupported format '" + format + "'");
+    }
+    auto sink = std::shared_ptr<FileAudioSink>(new FileAudioSink(speed, max_frames));
+    sink->_file_path = file_path;
+    sink->_format = format;
+    return AudioSinkPtr(sink);
+}
+
+FileAudioSink::~FileAudioSink() {
+    stop();
+}
+
+Result<void> FileAudioSink::_open(const AudioEngineConfig& config) {
+    _file = std::fopen(_file_path.c_str(), "wb");
+    if (!_file) {
+        return Err<void>("FileAudioSink: cannot open '" + _file_path + "' for writing");
+    }
+    std::setvbuf(_file, nullptr, _IOFBF, 1 << 20);
+    _frames = 0;
+    _bytes_written = 0;
+
+    if (_format == "wav") {
+        if (auto res = wav_write_float_header(_file, static_cast<int>(config.channels), config.sample_rate); !res) {
+            std::fclose(_file);
+            _file = nullptr;
+            return Err<void>("FileAudioSink: header write failed", res);
+        }
+        _bytes_written = WAV_FLOAT_HEADER_SIZE;
+    }
+    return Ok();
+}
+
+Result<void> FileAudioSink::_consume(const float* interleaved, size_t frames) {
+    const size_t samples = frames * output_config().channels;
+    size_t written = std::fwrite(interleaved, sizeof(float), samples, _file);
+    _bytes_written.fetch_add(written * sizeof(float), std::memory_order_relaxed);
+    if (written != samples) {
+        return Err<void>("FileAudioSink: short write to '" + _file_path + "'");
+    }
+    _frames += frames;
+    return Ok();
+}
+
+Result<void> FileAudioSink::_close() {
+    if (!_file) return Ok();
+    Result<void> res = Ok();
+    if (_format == "wav") {
+        std::fflush(_file);
+        res = wav_finalize_float_header(_file, static_cast<int>(output_config().channels), _frames);
+    }
+    if (std::fclose(_file) != 0 && res) {
+        res = Err<void>("FileAudioSink: close failed for '" + _file_path + "'");
+    }
+    _file = nullptr;
+    return res;
+}
+
+// ============== Sink registry ==============
+
+namespace {
+
+struct SinkRegistry {
+    std::mutex mutex;
+    std::map<std::string, AudioSinkFactory> factories;
+
+    SinkRegistry() {
+        factories["null"] = [](const Dict& options) {
+            return NullAudioSink::create(
+                option_number(options, "speed").value_or(0.0),
+                static_cast<uint64_t>(std::max(0.0, option_number(options, "max-frames").value_or(0.0))));
+        };
+        factories["file"] = [](const Dict& options) {
+            return FileAudioSink::create(
+                option_string(options, "file").value_or(""),
+                option_string(options, "format").value_or("wav"),
+                option_number(options, "speed").value_or(0.0),
+                static_cast<uint64_t>(std::max(0.0, option_number(options, "max-frames").value_or(0.0))));
+        };
+    }
+};
+
+SinkRegistry& sink_registry() {
+    static SinkRegistry registry;
+    return registry;
+}
+
+} // namespace
+
+void register_audio_sink(const std::string& kind, AudioSinkFactory factory) {
+    auto& registry = sink_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.factories[kind] = std::move(factory);
+}
+
+void unregister_audio_sink(const std::string& kind) {
+    auto& registry = sink_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.factories.erase(kind);
+}
+
+std::vector<std::string> audio_sink_kinds() {
+    auto& registry = sink_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<std::string> kinds;
+    for (const auto& [kind, _] : registry.factories) {
+        kinds.push_back(kind);
+    }
+    return kinds;
+}
+
+Result<AudioSinkPtr> create_audio_sink(const std::string& kind, const Dict& options) {
+    AudioSinkFactory factory;
+    {
+        auto& registry = sink_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto it = registry.factories.find(kind);
+        if (it == registry.factories.end()) {
+            return Err<AudioSinkPtr>("create_audio_sink: unknown sink '" + kind + "'");
+        }
+        factory = it->second;
+    }
+    auto res = factory(options);
+    if (!res) {
+        return Err<AudioSinkPtr>("create_audio_sink: '" + kind + "' failed", res);
+    }
+    return res;
+}
+
+} // namespace ymery
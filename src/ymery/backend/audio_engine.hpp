@@ -0,0 +1,377 @@
+// Audio engine - real-time playback mixer and output sinks
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include "audio_buffer.hpp"
+#include "audio_stats.hpp"
+#include "io_thread.hpp"
+#include "oscillator.hpp"
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ymery {
+
+class AudioSource;
+class AudioSink;
+class AudioEngine;
+
+using AudioSourcePtr = std::shared_ptr<AudioSource>;
+using AudioSinkPtr = std::shared_ptr<AudioSink>;
+using AudioEnginePtr = std::shared_ptr<AudioEngine>;
+
+// Voice handle returned by AudioEngine::play; 0 is never a valid voice
+using VoiceId = uint64_t;
+
+struct AudioEngineConfig {
+    int sample_rate = 48000;
+    size_t channels = 2;        // interleaved output channels
+    size_t block_frames = 256;  // frames mixed per block
+    size_t max_voices = 64;     // preallocated voice slots
+    size_t queue_size = 256;    // control commands in flight
+};
+
+/**
+ * AudioSource - mono signal played by a voice
+ * Created on the control thread, rendered on the audio thread: render()
+ * must not block or allocate. It returns the frames produced; fewer than
+ * asked ends the voice.
+ */
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+    virtual size_t render(float* out, size_t frames) = 0;
+};
+
+/**
+ * OscillatorSource - endless generator (sine, square, triangle)
+ * The frequency may be changed from the control thread at any time.
+ */
+class OscillatorSource : public AudioSource {
+public:
+    OscillatorSource(WaveformKind kind, double frequency, int sample_rate);
+
+    size_t render(float* out, size_t frames) override;
+
+    void set_frequency(double frequency) { _frequency.store(frequency, std::memory_order_relaxed); }
+    double frequency() const { return _frequency.load(std::memory_order_relaxed); }
+    WaveformKind kind() const { return _oscillator.kind(); }
+
+private:
+    Oscillator _oscillator;
+    std::atomic<double> _frequency;
+};
+
+/**
+ * BufferSource - plays a loaded (static) buffer once or looped
+ */
+class BufferSource : public AudioSource {
+public:
+    BufferSource(StaticAudioBufferPtr buffer, bool loop = false);
+
+    size_t render(float* out, size_t frames) override;
+
+    uint64_t position() const { return _position.load(std::memory_order_relaxed); }
+
+private:
+    StaticAudioBufferPtr _buffer;
+    bool _loop;
+    std::atomic<uint64_t> _position{0};
+};
+
+/**
+ * StreamSource - plays one channel of a capture or generator ring buffer
+ * Follows the ring's frame index a fixed latency behind the newest frame,
+ * reading through the lock-free read_from. Missing frames, and frames the
+ * producer overwrote during the copy, are played as silence and counted as
+ * underruns. No resampling: rings at another rate go through a
+ * ResampledStream first.
+ */
+class StreamSource : public AudioSource {
+public:
+    StreamSource(AudioRingBufferPtr ring, size_t channel, size_t latency_frames);
+
+    size_t render(float* out, size_t frames) override;
+
+    uint64_t underruns() const { return _underruns.load(std::memory_order_relaxed); }
+
+private:
+    AudioRingBufferPtr _ring;
+    size_t _channel;
+    size_t _latency;
+    uint64_t _cursor = 0;
+    bool _started = false;
+    std::atomic<uint64_t> _underruns{0};
+};
+
+/**
+ * AudioEngineStats - counters kept by the engine
+ * Written on the audio thread, read from any thread.
+ */
+struct AudioEngineStats {
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> active_voices{0};
+    std::atomic<uint64_t> commands_dropped{0};  // control queue was full
+    std::atomic<uint64_t> voices_dropped{0};    // play() found no free slot
+    LatencyHistogram render_duration;           // render() per call
+
+    Dict to_dict() const;
+};
+
+// Called by a sink for each block it needs: fill `frames` interleaved frames
+using AudioRenderFn = std::function<void(float* interleaved, size_t frames)>;
+
+/**
+ * AudioSink - output the engine renders into
+ * The sink owns the audio thread or callback and pulls blocks through the
+ * render function at its own pace (device clock or virtual clock).
+ */
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    virtual Result<void> start(const AudioEngineConfig& config, AudioRenderFn render) = 0;
+    virtual Result<void> stop() = 0;
+    virtual bool is_running() const = 0;
+
+    virtual std::string kind() const = 0;
+    // Frames handed to the output so far
+    virtual uint64_t frames_played() const = 0;
+    // Callback timing and xruns (late or missed blocks)
+    virtual const DeviceStats& stats() const = 0;
+};
+
+/**
+ * AudioEngine - mixes voices into fixed-size blocks for a sink
+ *
+ * Voice slots are preallocated. The control thread (UI, tree providers)
+ * never touches them: play/release/set_gain/set_pan push commands into a
+ * lock-free queue that the audio thread applies at the start of the next
+ * render(). Finished sources travel back through a second queue and are
+ * released by the control thread in collect(), so the audio thread never
+ * frees memory. Gain and pan changes are ramped over one block.
+ *
+ * All control methods must be called from one thread at a time.
+ */
+class AudioEngine {
+public:
+    static Result<AudioEnginePtr> create(const AudioEngineConfig& config = {});
+    ~AudioEngine();
+
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+    // Output
+    Result<void> start(AudioSinkPtr sink);
+    Result<void> stop();
+    bool is_running() const { return _sink && _sink->is_running(); }
+    const AudioSinkPtr& sink() const { return _sink; }
+
+    // Control thread - applied at the next block
+    Result<VoiceId> play(AudioSourcePtr source, float gain = 1.0f, float pan = 0.0f);
+    Result<void> release(VoiceId voice);  // fades out over one block
+    Result<void> set_gain(VoiceId voice, float gain);
+    Result<void> set_pan(VoiceId voice, float pan);  // -1 left .. 1 right
+    void set_master_gain(float gain) { _master_gain.store(gain, std::memory_order_relaxed); }
+    float master_gain() const { return _master_gain.load(std::memory_order_relaxed); }
+
+    // Control-side view: true until the audio thread has retired the voice
+    bool is_playing(VoiceId voice);
+    // Release the sources of retired voices
+    void collect();
+
+    // Audio thread - mix the next `frames` frames into `out` (interleaved)
+    void render(float* out, size_t frames);
+
+    const AudioEngineConfig& config() const { return _config; }
+    const AudioEngineStats& stats() const { return _stats; }
+
+private:
+    AudioEngine() = default;
+
+    enum class Op : uint8_t { Start, Release, Gain, Pan };
+
+    struct Command {
+        Op op = Op::Start;
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+        float value = 0.0f;     // gain or pan
+        float pan = 0.0f;       // Start only
+        AudioSourcePtr source;  // Start only
+    };
+
+    struct Retired {
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+        AudioSourcePtr source;
+    };
+
+    // Audio-thread voice state
+    struct Voice {
+        AudioSourcePtr source;
+        uint32_t generation = 0;
+        float gain = 1.0f;
+        float pan = 0.0f;
+        float current[2] = {0.0f, 0.0f};  // applied left/right gain
+        bool releasing = false;
+    };
+
+    // Control-thread view of a slot
+    struct Slot {
+        uint32_t generation = 0;
+        bool busy = false;
+    };
+
+    Result<void> _send(Command command);
+    bool _find(VoiceId voice, uint32_t& slot, uint32_t& generation) const;
+    void _apply_commands();
+    void _mix(float* out, size_t frames);
+    void _retire(uint32_t slot);
+
+    AudioEngineConfig _config;
+    AudioSinkPtr _sink;
+
+    // Audio thread
+    std::vector<Voice> _voices;
+    std::vector<float> _scratch;
+    float _current_master = 1.0f;
+
+    // Control thread
+    std::vector<Slot> _slots;
+
+    std::unique_ptr<SpscQueue<Command>> _commands;
+    std::unique_ptr<SpscQueue<Retired>> _retired;
+    std::atomic<float> _master_gain{1.0f};
+    AudioEngineStats _stats;
+};
+
+/**
+ * ClockedAudioSink - base for sinks without a device clock
+ * A thread renders block after block and hands each to _consume(). With
+ * speed > 0 blocks are paced by a virtual clock anchored at start (speed 1
+ * is real time, 2 twice as fast); a block more than LATE_BLOCKS blocks
+ * late is counted as an xrun and the clock re-anchored. With speed 0 the sink runs
+ * as fast as the engine renders, for throughput tests and benchmarks.
+ * max_frames > 0 stops the sink after that many frames.
+ */
+class ClockedAudioSink : public AudioSink {
+public:
+    ~ClockedAudioSink() override;
+
+    Result<void> start(const AudioEngineConfig& config, AudioRenderFn render) override;
+    Result<void> stop() override;
+    bool is_running() const override { return _running.load(std::memory_order_acquire); }
+
+    uint64_t frames_played() const override { return _frames_played.load(std::memory_order_relaxed); }
+    const DeviceStats& stats() const override { return _stats; }
+
+    double speed() const { return _speed; }
+    uint64_t max_frames() const { return _max_frames; }
+    const AudioEngineConfig& output_config() const { return _config; }
+
+    static constexpr size_t LATE_BLOCKS = 4;
+    // Seconds of audio played on the virtual clock
+    double virtual_time() const;
+
+protected:
+    ClockedAudioSink(double speed, uint64_t max_frames);
+
+    virtual Result<void> _open(const AudioEngineConfig& config) { return Ok(); }
+    virtual Result<void> _consume(const float* interleaved, size_t frames) = 0;
+    virtual Result<void> _close() { return Ok(); }
+
+private:
+    void _run();
+
+    double _speed;
+    uint64_t _max_frames;
+    AudioEngineConfig _config;
+    AudioRenderFn _render;
+    std::vector<float> _block;
+
+    std::atomic<uint64_t> _frames_played{0};
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _stop{false};
+    bool _consume_failed = false;
+    IoThread _thread;
+    DeviceStats _stats;
+};
+
+/**
+ * NullAudioSink - discards the output, keeping only its peak level
+ */
+class NullAudioSink : public ClockedAudioSink {
+public:
+    static Result<AudioSinkPtr> create(double speed = 0.0, uint64_t max_frames = 0);
+
+    ~NullAudioSink() override { stop(); }
+
+    std::string kind() const override { return "null"; }
+    float peak() const { return _peak.load(std::memory_order_relaxed); }
+
+protected:
+    Result<void> _consume(const float* interleaved, size_t frames) override;
+
+private:
+    NullAudioSink(double speed, uint64_t max_frames) : ClockedAudioSink(speed, max_frames) {}
+
+    std::atomic<float> _peak{0.0f};
+};
+
+/**
+ * FileAudioSink - writes the output to an interleaved float32 file
+ * Formats as for AudioRecorder: "wav" (RF64 above 4 GiB) or "raw".
+ */
+class FileAudioSink : public ClockedAudioSink {
+public:
+    static Result<AudioSinkPtr> create(
+        const std::string& file_path,
+        const std::string& format = "wav",
+        double speed = 0.0,
+        uint64_t max_frames = 0
+    );
+
+    ~FileAudioSink() override;
+
+    std::string kind() const override { return "file"; }
+    const std::string& file_path() const { return _file_path; }
+    uint64_t bytes_written() const { return _bytes_written.load(std::memory_order_relaxed); }
+
+protected:
+    Result<void> _open(const AudioEngineConfig& config) override;
+    Result<void> _consume(const float* interleaved, size_t frames) override;
+    Result<void> _close() override;
+
+private:
+    FileAudioSink(double speed, uint64_t max_frames) : ClockedAudioSink(speed, max_frames) {}
+
+    std::string _file_path;
+    std::string _format;
+    std::FILE* _file = nullptr;
+    uint64_t _frames = 0;
+    std::atomic<uint64_t> _bytes_written{0};
+};
+
+/**
+ * Sink registry - sink kinds by name
+ * "null" and "file" are built in; device plugins (alsa, jack, pipewire)
+ * register theirs while loaded. Options are sink specific, e.g.
+ *   null: speed, max-frames
+ *   file: file, format, speed, max-frames
+ */
+using AudioSinkFactory = std::function<Result<AudioSinkPtr>(const Dict& options)>;
+
+void register_audio_sink(const std::string& kind, AudioSinkFactory factory);
+void unregister_audio_sink(const std::string& kind);
+std::vector<std::string> audio_sink_kinds();
+Result<AudioSinkPtr> create_audio_sink(const std::string& kind, const Dict& options = {});
+
+} // namespace ymery
@@ -0,0 +1,154 @@
+// Audio envelope implementation
+#include "audio_envelope.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace ymery {
+
+namespace {
+
+constexpr float EMPTY_MIN = std::numeric_limits<float>::infinity();
+constexpr float EMPTY_MAX = -std::numeric_limits<float>::infinity();
+
+uint64_t pack(float min, float max) {
+    return (static_cast<uint64_t>(std::bit_cast<uint32_t>(min)) << 32) | std::bit_cast<uint32_t>(max);
+}
+
+EnvelopeBucket unpack(uint64_t word) {
+    return {std::bit_cast<float>(static_cast<uint32_t>(word >> 32)),
+            std::bit_cast<float>(static_cast<uint32_t>(word))};
+}
+
+void merge(EnvelopeBucket& into, const EnvelopeBucket& from) {
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+}
+
+} // namespace
+
+Result<AudioEnvelopePtr> AudioEnvelope::create(const EnvelopeConfig& config) {
+    if (config.samples_per_bucket == 0) {
+        return Err<AudioEnvelopePtr>("AudioEnvelope: samples_per_bucket must be greater than zero");
+    }
+    if (config.buckets == 0) {
+        return Err<AudioEnvelopePtr>("AudioEnvelope: buckets must be greater than zero");
+    }
+    auto envelope = std::shared_ptr<AudioEnvelope>(new AudioEnvelope());
+    envelope->_config = config;
+    envelope->_min = EMPTY_MIN;
+    envelope->_max = EMPTY_MAX;
+    envelope->_ring = std::make_unique<std::atomic<uint64_t>[]>(config.buckets);
+    for (size_t i = 0; i < config.buckets; ++i) {
+        envelope->_ring[i].store(pack(EMPTY_MIN, EMPTY_MAX), std::memory_order_relaxed);
+    }
+    return envelope;
+}
+
+void AudioEnvelope::on_write(const float* data, size_t count) {
+    const size_t bucket = _config.samples_per_bucket;
+    while (count > 0) {
+        size_t n = std::min(count, bucket - _fill);
+        float lo = _min;
+        float hi = _max;
+        for (size_t i = 0; i < n; ++i) {
+            // NaN compares false both ways and is skipped
+            lo = data[i] < lo ? data[i] : lo;
+            hi = data[i] > hi ? data[i] : hi;
+        }
+        _min = lo;
+        _max = hi;
+        _fill += n;
+        data += n;
+        count -= n;
+
+        if (_fill == bucket) {
+            uint64_t seq = _completed.load(std::memory_order_relaxed);
+            // Announce the slot before overwriting it (seqlock), so a reader
+            // that sees the new value also sees the bucket it replaced is gone
+            _writing.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            _ring[seq % _config.buckets].store(pack(_min, _max), std::memory_order_relaxed);
+            _completed.store(seq + 1, std::memory_order_release);
+            _min = EMPTY_MIN;
+            _max = EMPTY_MAX;
+            _fill = 0;
+        }
+    }
+}
+
+void AudioEnvelope::copy(uint64_t first, size_t count, EnvelopeBucket* out) const {
+    const size_t capacity = _config.buckets;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = unpack(_ring[(first + i) % capacity].load(std::memory_order_relaxed));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Bucket s lives in the slot of s + capacity, which may be in progress
+    uint64_t writing = _writing.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count && first + i + capacity < writing; ++i) {
+        out[i] = {EMPTY_MIN, EMPTY_MAX};
+    }
+}
+
+EnvelopeHistory::EnvelopeHistory(size_t capacity, size_t samples_per_bucket)
+    : _ring(std::max<size_t>(capacity, 1), EnvelopeBucket{EMPTY_MIN, EMPTY_MAX})
+    , _samples_per_bucket(std::max<size_t>(samples_per_bucket, 1)) {}
+
+size_t EnvelopeHistory::pull(const AudioEnvelope& envelope) {
+    uint64_t completed = envelope.completed();
+    if (completed <= _end) return 0;
+
+    const size_t capacity = _ring.size();
+    uint64_t fresh = completed - _end;
+    size_t count = static_cast<size_t>(std::min<uint64_t>(fresh, capacity));
+    uint64_t first = completed - count;
+
+    // At most two contiguous runs in the local ring
+    size_t slot = static_cast<size_t>(first % capacity);
+    size_t head = std::min(count, capacity - slot);
+    envelope.copy(first, head, _ring.data() + slot);
+    envelope.copy(first + head, count - head, _ring.data());
+
+    _end = completed;
+    _size = static_cast<size_t>(std::min<uint64_t>(_size + fresh, capacity));
+    return static_cast<size_t>(fresh);
+}
+
+const EnvelopeBucket& EnvelopeHistory::at_age(size_t age) const {
+    return _ring[(_end - 1 - age) % _ring.size()];
+}
+
+EnvelopeBucket EnvelopeHistory::value_range() const {
+    EnvelopeBucket range{EMPTY_MIN, EMPTY_MAX};
+    for (size_t age = 0; age < _size; ++age) {
+        merge(range, at_age(age));
+    }
+    return range;
+}
+
+void EnvelopeHistory::columns(double x0, double x1, size_t count, std::vector<EnvelopeBucket>& out) const {
+    out.assign(count, EnvelopeBucket{EMPTY_MIN, EMPTY_MAX});
+    if (_size == 0 || count == 0 || !(x1 > x0)) return;
+
+    const double spb = static_cast<double>(_samples_per_bucket);
+    const double width = (x1 - x0) / static_cast<double>(count);
+    const double last = static_cast<double>(count - 1);
+
+    // Ages whose bucket [-(age + 1) * spb, -age * spb) overlaps [x0, x1)
+    double age_lo = std::max(0.0, std::floor(-x1 / spb));
+    double age_hi = std::min(static_cast<double>(_size), std::ceil(-x0 / spb));
+    for (double a = age_lo; a < age_hi; a += 1.0) {
+        const auto& bucket = at_age(static_cast<size_t>(a));
+        if (bucket.min > bucket.max) continue;
+        double c0 = std::floor((-(a + 1.0) * spb - x0) / width);
+        double c1 = std::ceil((-a * spb - x0) / width) - 1.0;
+        c0 = std::clamp(c0, 0.0, last);
+        c1 = std::clamp(c1, 0.0, last);
+        for (auto c = static_cast<size_t>(c0); c <= static_cast<size_t>(c1); ++c) {
+            merge(out[c], bucket);
+        }
+    }
+}
+
+} // namespace ymery
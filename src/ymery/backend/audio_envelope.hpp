@@ -0,0 +1,102 @@
+// Audio envelope - producer-side min/max decimation for dense realtime plots
+#pragma once
+
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ymery {
+
+class AudioEnvelope;
+using AudioEnvelopePtr = std::shared_ptr<AudioEnvelope>;
+
+struct EnvelopeBucket {
+    float min;
+    float max;  // min > max marks a bucket with no samples
+};
+
+struct EnvelopeConfig {
+    size_t samples_per_bucket = 32;
+    size_t buckets = 16384;      // history kept by the producer
+};
+
+/**
+ * AudioEnvelope - folds every written block into fixed-size min/max buckets
+ *
+ * Attached to a ring buffer as a tap. Finished buckets go into a ring of
+ * atomics, so any number of consumers can copy them without locking the
+ * audio ring or copying raw samples. Bucket n covers samples
+ * [n * samples_per_bucket, (n + 1) * samples_per_bucket) written since the
+ * tap was attached.
+ */
+class AudioEnvelope : public AudioTap {
+public:
+    static Result<AudioEnvelopePtr> create(const EnvelopeConfig& config);
+
+    // Producer side (AudioTap)
+    void on_write(const float* data, size_t count) override;
+
+    // Consumer side - number of finished buckets so far
+    uint64_t completed() const { return _completed.load(std::memory_order_acquire); }
+    // Copy finished buckets [first, first + count); buckets the producer has
+    // already overwritten come back empty
+    void copy(uint64_t first, size_t count, EnvelopeBucket* out) const;
+
+    const EnvelopeConfig& config() const { return _config; }
+
+private:
+    AudioEnvelope() = default;
+
+    EnvelopeConfig _config;
+
+    // Producer state
+    float _min = 0.0f;
+    float _max = 0.0f;
+    size_t _fill = 0;
+
+    // min/max packed into one word, so a bucket is never read half-written
+    std::unique_ptr<std::atomic<uint64_t>[]> _ring;
+    std::atomic<uint64_t> _completed{0};
+    std::atomic<uint64_t> _writing{0};   // one past the bucket being stored
+};
+
+/**
+ * EnvelopeHistory - consumer-owned copy of the newest buckets of an
+ * AudioEnvelope. pull() copies only the buckets finished since the previous
+ * pull, so per-frame cost follows the audio rate divided by the bucket size,
+ * not the history length. Plots read it in sample units relative to the
+ * newest bucket: x = 0 is the end of the newest bucket, older data is
+ * negative.
+ */
+class EnvelopeHistory {
+public:
+    EnvelopeHistory(size_t capacity, size_t samples_per_bucket);
+
+    // Returns the number of new buckets
+    size_t pull(const AudioEnvelope& envelope);
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _ring.size(); }
+    size_t samples_per_bucket() const { return _samples_per_bucket; }
+    // age 0 is the newest bucket
+    const EnvelopeBucket& at_age(size_t age) const;
+
+    // Oldest sample offset held (<= 0) and the overall value range
+    double x_min() const { return -static_cast<double>(_size * _samples_per_bucket); }
+    EnvelopeBucket value_range() const;
+
+    // Reduce [x0, x1) to `count` equally wide columns; columns without data
+    // are empty (min > max)
+    void columns(double x0, double x1, size_t count, std::vector<EnvelopeBucket>& out) const;
+
+private:
+    std::vector<EnvelopeBucket> _ring;
+    size_t _samples_per_bucket;
+    size_t _size = 0;
+    uint64_t _end = 0;  // sequence after the newest bucket held
+};
+
+} // namespace ymery
@@ -0,0 +1,431 @@
+// Audio recorder implementation
+#include "audio_recorder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+namespace {
+
+constexpr std::align_val_t STAGING_ALIGNMENT{4096};
+
+// WAV layout: RIFF(12) + JUNK/ds64(8+28) + fmt(8+16) + data(8) = 80 bytes
+constexpr size_t WAV_HEADER_SIZE = WAV_FLOAT_HEADER_SIZE;
+constexpr size_t WAV_DS64_SIZE = 28;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+
+void put_tag(uint8_t* dst, const char* tag) {
+    std::memcpy(dst, tag, 4);
+}
+
+void put_u16(uint8_t* dst, uint16_t v) {
+    dst[0] = static_cast<uint8_t>(v);
+    dst[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put_u32(uint8_t* dst, uint32_t v) {
+    for (int i = 0; i < 4; ++i) dst[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void put_u64(uint8_t* dst, uint64_t v) {
+    for (int i = 0; i < 8; ++i) dst[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+} // namespace
+
+// ============== ChannelTap ==============
+
+AudioRecorder::ChannelTap::ChannelTap(size_t block_frames, size_t queue_blocks)
+    : queue(queue_blocks), _block_frames(block_frames) {
+    for (auto& block : queue.slots()) {
+        block.samples.resize(block_frames);
+    }
+}
+
+void AudioRecorder::ChannelTap::on_write(const float* data, size_t count) {
+    on_write_at(data, count, base + position.load(std::memory_order_relaxed));
+}
+
+void AudioRecorder::ChannelTap::on_write_at(const float* data, size_t count, uint64_t frame) {
+    if (!enabled.load(std::memory_order_acquire)) return;
+
+    // Frames from before start are not recorded
+    if (frame < base) {
+        size_t early = static_cast<size_t>(std::min<uint64_t>(base - frame, count));
+        data += early;
+        count -= early;
+        frame += early;
+    }
+
+    // A full queue drops the block; the writer sees the gap in positions
+    uint64_t pos = frame - base;
+    while (count > 0) {
+        size_t n = std::min(count, _block_frames);
+        if (Block* block = queue.begin_push()) {
+            std::memcpy(block->samples.data(), data, n * sizeof(float));
+            block->frames = n;
+            block->start = pos;
+            queue.commit_push();
+        }
+        pos += n;
+        data += n;
+        count -= n;
+    }
+    position.store(pos, std::memory_order_relaxed);
+}
+
+void AudioRecorder::StagingDeleter::operator()(float* p) const {
+    ::operator delete(p, STAGING_ALIGNMENT);
+}
+
+// ============== AudioRecorder ==============
+
+const std::vector<std::string>& AudioRecorder::supported_formats() {
+    static const std::vector<std::string> formats = {"wav", "raw"};
+    return formats;
+}
+
+Result<AudioRecorderPtr> AudioRecorder::create(
+    std::vector<MediatedAudioBufferPtr> sources,
+    const AudioRecorderConfig& config
+) {
+    if (sources.empty()) {
+        return Err<AudioRecorderPtr>("AudioRecorder::create: no sources");
+    }
+    if (config.file_path.empty()) {
+        return Err<AudioRecorderPtr>("AudioRecorder::create: empty file path");
+    }
+    const auto& formats = supported_formats();
+    if (std::find(formats.begin(), formats.end(), config.format) == formats.end()) {
+        return Err<AudioRecorderPtr>("AudioRecorder::create: unsupported format '" + config.format + "'");
+    }
+    if (config.block_frames == 0) {
+        return Err<AudioRecorderPtr>("AudioRecorder::create: block-frames must be > 0");
+    }
+
+    auto recorder = std::shared_ptr<AudioRecorder>(new AudioRecorder());
+    recorder->_config = config;
+
+    for (const auto& source : sources) {
+        if (!source) {
+            return Err<AudioRecorderPtr>("AudioRecorder::create: null source buffer");
+        }
+        if (recorder->_sample_rate == 0) {
+            recorder->_sample_rate = source->sample_rate();
+        } else if (source->sample_rate() != recorder->_sample_rate) {
+            return Err<AudioRecorderPtr>("AudioRecorder::create: sources have different sample rates");
+        }
+    }
+
+    // Preallocate per-channel queues so recording never grows memory
+    double queue_frames = std::max(config.queue_seconds, 0.0) * recorder->_sample_rate;
+    size_t queue_blocks = std::max<size_t>(
+        4, static_cast<size_t>(queue_frames / config.block_frames) + 1);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        recorder->_channels.push_back(std::make_shared<ChannelTap>(config.block_frames, queue_blocks));
+    }
+    recorder->_sources = std::move(sources);
+
+    // Staging holds a whole number of interleaved frames and at least one block
+    size_t nch = recorder->_channels.size();
+    size_t frames = std::max(config.write_chunk_bytes / (sizeof(float) * nch), config.block_frames);
+    recorder->_staging_capacity = frames * nch;
+    recorder->_staging.reset(static_cast<float*>(
+        ::operator new(recorder->_staging_capacity * sizeof(float), STAGING_ALIGNMENT)));
+
+    return recorder;
+}
+
+AudioRecorder::~AudioRecorder() {
+    stop();
+}
+
+Result<void> AudioRecorder::start() {
+    if (_running) return Ok();
+
+    _file = std::fopen(_config.file_path.c_str(), "wb");
+    if (!_file) {
+        return Err<void>("AudioRecorder::start: cannot open '" + _config.file_path + "'");
+    }
+    // Staging already batches writes - bypass stdio buffering
+    std::setvbuf(_file, nullptr, _IONBF, 0);
+
+    _frames_written = 0;
+    _bytes_written = 0;
+    _dropped_blocks = 0;
+    _position = 0;
+    _staging_used = 0;
+    _write_failed = false;
+
+    if (_config.format == "wav") {
+        if (auto res = _write_header(); !res) {
+            std::fclose(_file);
+            _file = nullptr;
+            return Err<void>("AudioRecorder::start: header write failed", res);
+        }
+    }
+
+    // Every channel of a ring counts from the ring's index before the first
+    // tap goes in, so blocks written between attachments line up by position
+    std::vector<std::pair<const AudioRingBuffer*, uint64_t>> bases;
+    for (size_t i = 0; i < _channels.size(); ++i) {
+        const AudioRingBuffer* ring = _sources[i]->ring().get();
+        auto it = std::find_if(bases.begin(), bases.end(), [&](const auto& b) { return b.first == ring; });
+        if (it == bases.end()) it = bases.insert(bases.end(), {ring, ring->frames_written()});
+
+        auto& channel = _channels[i];
+        channel->read_offset = 0;
+        channel->base = it->second;
+        channel->position = 0;
+        channel->enabled.store(true, std::memory_order_release);
+    }
+    for (size_t i = 0; i < _channels.size(); ++i) {
+        _sources[i]->add_tap(_channels[i]);
+    }
+
+    _running = true;
+    _thread = std::thread(&AudioRecorder::_run, this);
+
+    ydebug("AudioRecorder: recording {} channel(s) at {}Hz to {}",
+           _channels.size(), _sample_rate, _config.file_path);
+    return Ok();
+}
+
+Result<void> AudioRecorder::stop() {
+    if (!_running) return Ok();
+
+    // Stop feeding first so the writer can drain a finite backlog
+    for (size_t i = 0; i < _channels.size(); ++i) {
+        _channels[i]->enabled.store(false, std::memory_order_release);
+        _sources[i]->remove_tap(_channels[i]);
+    }
+
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+
+    // Frames some channel has and another lost at the end; they are
+    // positioned against this take's base, so the next start must not see them
+    uint64_t end = _position;
+    for (const auto& channel : _channels) {
+        end = std::max(end, channel->position.load(std::memory_order_relaxed));
+        while (channel->queue.front()) channel->queue.pop();
+        channel->read_offset = 0;
+    }
+    _count_dropped(end - _position);
+
+    auto flush_res = _flush();
+    Result<void> header_res = Ok();
+    if (_config.format == "wav") {
+        header_res = _finalize_header();
+    }
+    std::fclose(_file);
+    _file = nullptr;
+
+    ydebug("AudioRecorder: stopped {} ({} frames, {} dropped blocks)",
+           _config.file_path, _frames_written.load(), dropped_blocks());
+
+    if (!flush_res) return Err<void>("AudioRecorder::stop: flush failed", flush_res);
+    if (!header_res) return Err<void>("AudioRecorder::stop: header update failed", header_res);
+    if (_write_failed) return Err<void>("AudioRecorder::stop: write errors during recording");
+    return Ok();
+}
+
+uint64_t AudioRecorder::dropped_blocks() const {
+    return _dropped_blocks.load(std::memory_order_relaxed);
+}
+
+void AudioRecorder::_count_dropped(uint64_t frames) {
+    if (frames == 0) return;
+    _dropped_blocks.fetch_add((frames + _config.block_frames - 1) / _config.block_frames,
+                              std::memory_order_relaxed);
+}
+
+void AudioRecorder::_run() {
+    while (true) {
+        bool running = _running.load();
+        if (_drain() == 0) {
+            if (!running) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+// Bring every channel's front to the same stream position: frames a
+// channel lost are skipped on all of them. False while a channel has no data.
+bool AudioRecorder::_align() {
+    while (true) {
+        uint64_t target = _position;
+        for (auto& channel : _channels) {
+            Block* block = channel->queue.front();
+            if (!block) return false;
+            target = std::max(target, block->start + channel->read_offset);
+        }
+
+        bool aligned = true;
+        for (auto& channel : _channels) {
+            Block* block = channel->queue.front();
+            while (block && block->start + channel->read_offset < target) {
+                uint64_t behind = target - (block->start + channel->read_offset);
+                channel->read_offset += static_cast<size_t>(
+                    std::min<uint64_t>(behind, block->frames - channel->read_offset));
+                if (channel->read_offset == block->frames) {
+                    channel->queue.pop();
+                    channel->read_offset = 0;
+                    block = channel->queue.front();
+                }
+            }
+            if (!block) return false;
+            if (block->start + channel->read_offset != target) aligned = false;
+        }
+
+        // One period lost on any channel counts once
+        _count_dropped(target - _position);
+        _position = target;
+        if (aligned) return true;
+    }
+}
+
+size_t AudioRecorder::_drain() {
+    const size_t nch = _channels.size();
+    size_t total = 0;
+
+    while (_align()) {
+        // Interleave only frames present on every channel
+        size_t n = std::numeric_limits<size_t>::max();
+        for (auto& channel : _channels) {
+            n = std::min(n, channel->queue.front()->frames - channel->read_offset);
+        }
+
+        n = std::min(n, (_staging_capacity - _staging_used) / nch);
+        float* dst = _staging.get() + _staging_used;
+        for (size_t c = 0; c < nch; ++c) {
+            auto& channel = _channels[c];
+            const float* src = channel->queue.front()->samples.data() + channel->read_offset;
+            for (size_t i = 0; i < n; ++i) {
+                dst[i * nch + c] = src[i];
+            }
+            channel->read_offset += n;
+            if (channel->read_offset == channel->queue.front()->frames) {
+                channel->queue.pop();
+                channel->read_offset = 0;
+            }
+        }
+
+        _staging_used += n * nch;
+        _position += n;
+        _frames_written.fetch_add(n, std::memory_order_relaxed);
+        total += n;
+
+        if (_staging_capacity - _staging_used < nch) {
+            if (auto res = _flush(); !res) {
+                _write_failed = true;
+            }
+        }
+    }
+
+    return total;
+}
+
+Result<void> AudioRecorder::_flush() {
+    if (_staging_used == 0 || !_file) return Ok();
+
+    size_t bytes = _staging_used * sizeof(float);
+    size_t written = std::fwrite(_staging.get(), 1, bytes, _file);
+    _staging_used = 0;
+    _bytes_written.fetch_add(written, std::memory_order_relaxed);
+    if (written != bytes) {
+        return Err<void>("AudioRecorder::_flush: short write to '" + _config.file_path + "'");
+    }
+    return Ok();
+}
+
+Result<void> AudioRecorder::_write_header() {
+    if (auto res = wav_write_float_header(_file, static_cast<int>(_channels.size()), _sample_rate); !res) {
+        return Err<void>("AudioRecorder::_write_header failed", res);
+    }
+    _bytes_written += WAV_FLOAT_HEADER_SIZE;
+    return Ok();
+}
+
+Result<void> AudioRecorder::_finalize_header() {
+    if (auto res = wav_finalize_float_header(_file, static_cast<int>(_channels.size()), _frames_written.load()); !res) {
+        return Err<void>("AudioRecorder::_finalize_header failed", res);
+    }
+    return Ok();
+}
+
+// ============== WAV float32 header ==============
+
+Result<void> wav_write_float_header(std::FILE* file, int channels, int sample_rate) {
+    uint8_t header[WAV_HEADER_SIZE] = {};
+    const uint16_t nch = static_cast<uint16_t>(channels);
+    const uint32_t rate = static_cast<uint32_t>(sample_rate);
+
+    put_tag(header + 0, "RIFF");
+    put_u32(header + 4, 0);
+    put_tag(header + 8, "WAVE");
+    // JUNK chunk reserves room for ds64 in case the file outgrows RIFF
+    put_tag(header + 12, "JUNK");
+    put_u32(header + 16, WAV_DS64_SIZE);
+    put_tag(header + 48, "fmt ");
+    put_u32(header + 52, 16);
+    put_u16(header + 56, WAVE_FORMAT_IEEE_FLOAT);
+    put_u16(header + 58, nch);
+    put_u32(header + 60, rate);
+    put_u32(header + 64, rate * nch * sizeof(float));
+    put_u16(header + 68, static_cast<uint16_t>(nch * sizeof(float)));
+    put_u16(header + 70, 32);
+    put_tag(header + 72, "data");
+    put_u32(header + 76, 0);
+
+    if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        return Err<void>("wav_write_float_header: write failed");
+    }
+    return Ok();
+}
+
+Result<void> wav_finalize_float_header(std::FILE* file, int channels, uint64_t frames) {
+    uint64_t data_bytes = frames * static_cast<uint64_t>(channels) * sizeof(float);
+    uint64_t riff_bytes = WAV_HEADER_SIZE - 8 + data_bytes;
+
+    uint8_t chunk[4];
+    if (riff_bytes <= std::numeric_limits<uint32_t>::max()) {
+        put_u32(chunk, static_cast<uint32_t>(riff_bytes));
+        if (std::fseek(file, 4, SEEK_SET) != 0 || std::fwrite(chunk, 1, 4, file) != 4) {
+            return Err<void>("wav_finalize_float_header: RIFF size write failed");
+        }
+        put_u32(chunk, static_cast<uint32_t>(data_bytes));
+        if (std::fseek(file, 76, SEEK_SET) != 0 || std::fwrite(chunk, 1, 4, file) != 4) {
+            return Err<void>("wav_finalize_float_header: data size write failed");
+        }
+        return Ok();
+    }
+
+    // RF64: sizes move into the ds64 chunk that replaced JUNK
+    uint8_t rf64[48] = {};
+    put_tag(rf64 + 0, "RF64");
+    put_u32(rf64 + 4, 0xFFFFFFFFu);
+    put_tag(rf64 + 8, "WAVE");
+    put_tag(rf64 + 12, "ds64");
+    put_u32(rf64 + 16, WAV_DS64_SIZE);
+    put_u64(rf64 + 20, riff_bytes);
+    put_u64(rf64 + 28, data_bytes);
+    put_u64(rf64 + 36, frames);
+    put_u32(rf64 + 44, 0);
+    if (std::fseek(file, 0, SEEK_SET) != 0 || std::fwrite(rf64, 1, sizeof(rf64), file) != sizeof(rf64)) {
+        return Err<void>("wav_finalize_float_header: ds64 write failed");
+    }
+    put_u32(chunk, 0xFFFFFFFFu);
+    if (std::fseek(file, 76, SEEK_SET) != 0 || std::fwrite(chunk, 1, 4, file) != 4) {
+        return Err<void>("wav_finalize_float_header: data size write failed");
+    }
+    return Ok();
+}
+
+} // namespace ymery
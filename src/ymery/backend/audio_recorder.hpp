@@ -0,0 +1,132 @@
+// Audio recorder - streams tapped ring buffer blocks to disk
+#pragma once
+
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ymery {
+
+class AudioRecorder;
+using AudioRecorderPtr = std::shared_ptr<AudioRecorder>;
+
+// Interleaved float32 WAV files, also written by the playback file sink.
+// The header reserves room for a ds64 chunk; finalizing switches the file
+// to RF64 when the data outgrows 4 GiB.
+constexpr size_t WAV_FLOAT_HEADER_SIZE = 80;
+Result<void> wav_write_float_header(std::FILE* file, int channels, int sample_rate);
+Result<void> wav_finalize_float_header(std::FILE* file, int channels, uint64_t frames);
+
+struct AudioRecorderConfig {
+    std::string file_path;
+    std::string format = "wav";          // "wav" (float32, RF64 above 4 GiB) or "raw" (interleaved float32)
+    size_t block_frames = 1024;          // frames per queued block
+    double queue_seconds = 2.0;          // preallocated headroom per channel
+    size_t write_chunk_bytes = 1 << 20;  // staging size for each disk write
+};
+
+/**
+ * AudioRecorder - records one or more channels into a single interleaved file
+ *
+ * Each source gets a tap that copies written blocks into a preallocated
+ * SPSC queue; the producer never waits on disk. A writer thread interleaves
+ * the queues into an aligned staging buffer and flushes it in large chunks.
+ * When a queue is full the block is dropped. Blocks carry their stream
+ * position - the ring's frame index relative to the ring's index at start -
+ * so a block reaching one tap before the next tap is attached is skipped
+ * by position, and the writer drops the same frames from every channel and
+ * counts the period once; the channels stay in step. Channels of different
+ * rings each count from their own ring's index at start.
+ */
+class AudioRecorder {
+public:
+    static Result<AudioRecorderPtr> create(
+        std::vector<MediatedAudioBufferPtr> sources,
+        const AudioRecorderConfig& config
+    );
+
+    ~AudioRecorder();
+
+    Result<void> start();
+    Result<void> stop();
+
+    bool is_recording() const { return _running; }
+
+    // Counters (safe to read from any thread)
+    uint64_t frames_written() const { return _frames_written; }
+    uint64_t bytes_written() const { return _bytes_written; }
+    uint64_t dropped_blocks() const;
+
+    // Properties
+    const AudioRecorderConfig& config() const { return _config; }
+    int num_channels() const { return static_cast<int>(_channels.size()); }
+    int sample_rate() const { return _sample_rate; }
+
+    static const std::vector<std::string>& supported_formats();
+
+private:
+    AudioRecorder() = default;
+
+    struct Block {
+        std::vector<float> samples;
+        size_t frames = 0;
+        uint64_t start = 0;  // stream position of the first frame
+    };
+
+    class ChannelTap : public AudioTap {
+    public:
+        ChannelTap(size_t block_frames, size_t queue_blocks);
+        void on_write(const float* data, size_t count) override;
+        void on_write_at(const float* data, size_t count, uint64_t frame) override;
+
+        SpscQueue<Block> queue;
+        std::atomic<bool> enabled{false};
+        uint64_t base = 0;                  // ring frame index at start, set before attaching
+        std::atomic<uint64_t> position{0};  // end of the frames seen since start, dropped ones included
+        size_t read_offset = 0;             // writer-side offset into the front block
+
+    private:
+        size_t _block_frames;
+    };
+
+    struct StagingDeleter {
+        void operator()(float* p) const;
+    };
+
+    void _run();
+    bool _align();
+    size_t _drain();
+    void _count_dropped(uint64_t frames);
+    Result<void> _flush();
+    Result<void> _write_header();
+    Result<void> _finalize_header();
+
+    AudioRecorderConfig _config;
+    int _sample_rate = 0;
+
+    std::vector<MediatedAudioBufferPtr> _sources;
+    std::vector<std::shared_ptr<ChannelTap>> _channels;
+
+    std::FILE* _file = nullptr;
+    std::unique_ptr<float[], StagingDeleter> _staging;
+    size_t _staging_capacity = 0;  // in samples
+    size_t _staging_used = 0;      // in samples
+
+    std::atomic<uint64_t> _frames_written{0};
+    std::atomic<uint64_t> _bytes_written{0};
+    std::atomic<uint64_t> _dropped_blocks{0};
+    uint64_t _position = 0;  // stream position of the next frame to write
+    bool _write_failed = false;
+
+    std::atomic<bool> _running{false};
+    std::thread _thread;
+};
+
+} // namespace ymery
@@ -0,0 +1,364 @@
+// Audio resampler implementation
+#include "audio_resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace ymery {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr size_t LANES = 8;          // partial sums per dot product
+constexpr size_t MAX_PHASES = 4096;  // L for rates with a small common divisor
+
+struct QualitySpec {
+    size_t taps;
+    double attenuation_db;
+};
+
+QualitySpec quality_spec(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Low: return {16, 60.0};
+        case ResamplerQuality::Medium: return {48, 96.0};
+        case ResamplerQuality::High: return {128, 120.0};
+    }
+    return {48, 96.0};
+}
+
+// Zeroth-order modified Bessel function of the first kind
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double half = x / 2.0;
+    for (int k = 1; k < 64; ++k) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-17) break;
+    }
+    return sum;
+}
+
+double kaiser_beta(double attenuation_db) {
+    if (attenuation_db > 50.0) return 0.1102 * (attenuation_db - 8.7);
+    if (attenuation_db >= 21.0) {
+        return 0.5842 * std::pow(attenuation_db - 21.0, 0.4) + 0.07886 * (attenuation_db - 21.0);
+    }
+    return 0.0;
+}
+
+// Eight independent accumulators so the loop vectorizes under strict FP
+inline float dot(const float* h, const float* x, size_t n) {
+    float acc[LANES] = {};
+    for (size_t i = 0; i < n; i += LANES) {
+        for (size_t k = 0; k < LANES; ++k) {
+            acc[k] += h[i + k] * x[i + k];
+        }
+    }
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+} // namespace
+
+Result<ResamplerQuality> resampler_quality_from_string(const std::string& name) {
+    if (name == "low") return ResamplerQuality::Low;
+    if (name == "medium") return ResamplerQuality::Medium;
+    if (name == "high") return ResamplerQuality::High;
+    return Err<ResamplerQuality>("Unknown resampler quality: " + name);
+}
+
+const char* resampler_quality_name(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Low: return "low";
+        case ResamplerQuality::Medium: return "medium";
+        case ResamplerQuality::High: return "high";
+    }
+    return "medium";
+}
+
+std::vector<std::string> resampler_quality_names() {
+    return {"low", "medium", "high"};
+}
+
+// ============== PolyphaseResampler ==============
+
+Result<PolyphaseResamplerPtr> PolyphaseResampler::create(
+    int input_rate,
+    int output_rate,
+    ResamplerQuality quality,
+    size_t max_block
+) {
+    if (input_rate <= 0 || output_rate <= 0) {
+        return Err<PolyphaseResamplerPtr>("PolyphaseResampler::create: sample rates must be positive");
+    }
+    if (max_block == 0) {
+        return Err<PolyphaseResamplerPtr>("PolyphaseResampler::create: max_block must be greater than zero");
+    }
+    const int divisor = std::gcd(input_rate, output_rate);
+    const size_t phases = static_cast<size_t>(output_rate / divisor);
+    const size_t step = static_cast<size_t>(input_rate / divisor);
+    if (phases > MAX_PHASES) {
+        return Err<PolyphaseResamplerPtr>("PolyphaseResampler::create: " + std::to_string(input_rate) +
+                                          " -> " + std::to_string(output_rate) + " Hz needs " +
+                                          std::to_string(phases) + " phases (max " +
+                                          std::to_string(MAX_PHASES) + ")");
+    }
+
+    auto spec = quality_spec(quality);
+    // Keep the transition band the same fraction of the lower Nyquist
+    size_t taps = spec.taps;
+    if (step > phases) {
+        taps = static_cast<size_t>(std::ceil(static_cast<double>(taps) * step / phases));
+    }
+    taps = (taps + LANES - 1) / LANES * LANES;
+
+    auto r = std::shared_ptr<PolyphaseResampler>(new PolyphaseResampler());
+    r->_input_rate = input_rate;
+    r->_output_rate = output_rate;
+    r->_quality = quality;
+    r->_phases = phases;
+    r->_step = step;
+    r->_taps = taps;
+    r->_max_block = max_block;
+
+    // Prototype at the upsampled rate input_rate * L. Kaiser design: the
+    // transition width (as a fraction of the lower Nyquist) that `taps`
+    // buys at this attenuation puts the stopband edge right at Nyquist.
+    const size_t length = taps * phases;
+    const double transition = 2.0 * (spec.attenuation_db - 8.0) / (2.285 * 2.0 * PI * spec.taps);
+    const double cutoff = std::max(0.1, 1.0 - transition / 2.0);  // fraction of the lower Nyquist
+    const double fc = cutoff * 0.5 / static_cast<double>(std::max(phases, step));  // cycles per upsampled sample
+    const double beta = kaiser_beta(spec.attenuation_db);
+    const double i0_beta = bessel_i0(beta);
+    const double center = (static_cast<double>(length) - 1.0) / 2.0;
+
+    r->_coefs.assign(length, 0.0f);
+    for (size_t m = 0; m < length; ++m) {
+        double t = static_cast<double>(m) - center;
+        double x = 2.0 * fc * t;
+        double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(PI * x) / (PI * x);
+        double w = t / center;
+        double window = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - w * w))) / i0_beta;
+        // Gain L restores the level lost to zero-stuffing
+        double h = static_cast<double>(phases) * 2.0 * fc * sinc * window;
+
+        // Tap j of phase p is h[j * L + p]; rows are reversed so the newest
+        // input sample meets tap 0
+        size_t phase = m % phases;
+        size_t j = m / phases;
+        r->_coefs[phase * taps + (taps - 1 - j)] = static_cast<float>(h);
+    }
+
+    r->_history.assign(taps - 1 + max_block, 0.0f);
+    r->reset();
+    return r;
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(_history.begin(), _history.end(), 0.0f);
+    _fill = _taps - 1;
+    _phase = 0;
+}
+
+size_t PolyphaseResampler::max_output(size_t input_frames) const {
+    return static_cast<size_t>((static_cast<uint64_t>(input_frames) * _phases + _phase) / _step) + 1;
+}
+
+double PolyphaseResampler::delay_frames() const {
+    return (static_cast<double>(_taps * _phases) - 1.0) / 2.0 / static_cast<double>(_step);
+}
+
+size_t PolyphaseResampler::process(const float* in, size_t frames, float* out) {
+    size_t produced = 0;
+    while (frames > 0) {
+        size_t chunk = std::min(frames, _max_block);
+        std::memcpy(_history.data() + _fill, in, chunk * sizeof(float));
+        _fill += chunk;
+        in += chunk;
+        frames -= chunk;
+
+        // Output k sits at upsampled time k*M = n*L + p; its window ends at
+        // input n, i.e. starts at history index `base`
+        size_t base = 0;
+        size_t phase = _phase;
+        const float* coefs = _coefs.data();
+        while (base + _taps <= _fill) {
+            out[produced++] = dot(coefs + phase * _taps, _history.data() + base, _taps);
+            phase += _step;
+            base += phase / _phases;
+            phase %= _phases;
+        }
+        _phase = phase;
+
+        // Keep the last taps - 1 samples (and any not yet reached) as history
+        size_t keep_from = std::min(base, _fill);
+        std::memmove(_history.data(), _history.data() + keep_from, (_fill - keep_from) * sizeof(float));
+        _fill -= keep_from;
+    }
+    return produced;
+}
+
+Result<FileAudioBufferPtr> resample_buffer(
+    const StaticAudioBuffer& buffer,
+    int output_rate,
+    ResamplerQuality quality
+) {
+    const auto& input = buffer.data();
+    auto r_res = PolyphaseResampler::create(buffer.sample_rate(), output_rate, quality);
+    if (!r_res) {
+        return Err<FileAudioBufferPtr>("resample_buffer failed", r_res);
+    }
+    auto& r = *r_res;
+
+    const size_t expected = static_cast<size_t>(
+        static_cast<uint64_t>(input.size()) * r->phases() / r->step());
+    const size_t delay = static_cast<size_t>(std::lround(r->delay_frames()));
+
+    std::vector<float> out(r->max_output(input.size()));
+    size_t n = r->process(input.data(), input.size(), out.data());
+    // Flush the filter with silence until the delayed tail is out
+    std::vector<float> silence(r->taps() * 2, 0.0f);
+    while (n < expected + delay) {
+        out.resize(n + r->max_output(silence.size()));
+        n += r->process(silence.data(), silence.size(), out.data() + n);
+    }
+
+    std::vector<float> aligned(out.begin() + static_cast<std::ptrdiff_t>(delay),
+                               out.begin() + static_cast<std::ptrdiff_t>(delay + expected));
+    std::string path;
+    if (auto file = dynamic_cast<const FileAudioBuffer*>(&buffer)) {
+        path = file->file_path();
+    }
+    return FileAudioBuffer::create(path, std::move(aligned), output_rate);
+}
+
+// ============== ResampledStream ==============
+
+class ResampledStream::ChannelTap : public AudioTap {
+public:
+    ChannelTap(ResampledStream* stream, size_t index) : _stream(stream), _index(index) {}
+    void on_write(const float* data, size_t count) override {
+        _stream->_on_write(_index, data, count);
+    }
+private:
+    ResampledStream* _stream;
+    size_t _index;
+};
+
+Result<ResampledStreamPtr> ResampledStream::create(
+    std::vector<MediatedAudioBufferPtr> sources,
+    int output_rate,
+    ResamplerQuality quality
+) {
+    if (sources.empty()) {
+        return Err<ResampledStreamPtr>("ResampledStream::create: no source channels");
+    }
+    AudioRingBufferPtr source_ring;
+    std::vector<size_t> channels;
+    for (const auto& source : sources) {
+        if (!source || !source->ring()) {
+            return Err<ResampledStreamPtr>("ResampledStream::create: source has no ring buffer");
+        }
+        if (source_ring && source->ring() != source_ring) {
+            return Err<ResampledStreamPtr>("ResampledStream::create: sources must be channels of one device");
+        }
+        if (std::find(channels.begin(), channels.end(), source->channel()) != channels.end()) {
+            return Err<ResampledStreamPtr>("ResampledStream::create: channel " +
+                                           std::to_string(source->channel()) + " listed twice");
+        }
+        source_ring = source->ring();
+        channels.push_back(source->channel());
+    }
+    if (source_ring->buffer_size() == 0) {
+        return Err<ResampledStreamPtr>("ResampledStream::create: source ring is empty");
+    }
+
+    auto stream = std::shared_ptr<ResampledStream>(new ResampledStream());
+    stream->_sources = std::move(sources);
+
+    // A tap sees at most one source ring of frames per call
+    const size_t max_block = source_ring->buffer_size();
+    for (size_t i = 0; i < channels.size(); ++i) {
+        auto r_res = PolyphaseResampler::create(source_ring->sample_rate(), output_rate, quality, max_block);
+        if (!r_res) {
+            return Err<ResampledStreamPtr>("ResampledStream::create failed", r_res);
+        }
+        stream->_resamplers.push_back(*r_res);
+    }
+
+    const double ratio = static_cast<double>(output_rate) / source_ring->sample_rate();
+    const size_t ring_frames = static_cast<size_t>(std::ceil(source_ring->buffer_size() * ratio));
+    const size_t period = std::max<size_t>(1, static_cast<size_t>(std::ceil(source_ring->period_size() * ratio)));
+    auto ring_res = AudioRingBuffer::create(output_rate, ring_frames, period, channels.size());
+    if (!ring_res) {
+        return Err<ResampledStreamPtr>("ResampledStream::create failed", ring_res);
+    }
+    stream->_ring = *ring_res;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        auto view_res = MediatedAudioBuffer::create(stream->_ring, i);
+        if (!view_res) {
+            return Err<ResampledStreamPtr>("ResampledStream::create failed", view_res);
+        }
+        stream->_outputs.push_back(*view_res);
+    }
+
+    // Channels published by the last tap may lag the others by one call
+    const size_t staging = 2 * stream->_resamplers.front()->max_output(max_block);
+    stream->_staging.assign(channels.size(), std::vector<float>(staging, 0.0f));
+    stream->_staged.assign(channels.size(), 0);
+    stream->_planes.assign(channels.size(), nullptr);
+    stream->_publish_index = static_cast<size_t>(
+        std::max_element(channels.begin(), channels.end()) - channels.begin());
+
+    for (size_t i = 0; i < channels.size(); ++i) {
+        auto tap = std::make_shared<ChannelTap>(stream.get(), i);
+        stream->_taps.push_back(tap);
+        stream->_sources[i]->add_tap(tap);
+    }
+    return stream;
+}
+
+ResampledStream::~ResampledStream() {
+    detach();
+}
+
+void ResampledStream::detach() {
+    // remove_tap takes the source ring lock, so no on_write is in flight after it
+    for (size_t i = 0; i < _taps.size(); ++i) {
+        _sources[i]->remove_tap(_taps[i]);
+    }
+    _taps.clear();
+}
+
+MediatedAudioBufferPtr ResampledStream::buffer(size_t channel) const {
+    return channel < _outputs.size() ? _outputs[channel] : nullptr;
+}
+
+void ResampledStream::_on_write(size_t index, const float* data, size_t count) {
+    auto scope = _stats.time_callback();
+    auto& staging = _staging[index];
+    auto& staged = _staged[index];
+    auto& resampler = *_resamplers[index];
+    if (staged + resampler.max_output(count) > staging.size()) {
+        _stats.record_xrun();  // publishing channel stalled; cannot happen with one device ring
+        staged = 0;
+    }
+    staged += resampler.process(data, count, staging.data() + staged);
+    if (index != _publish_index) return;
+
+    _frames_in.fetch_add(count, std::memory_order_relaxed);
+    size_t frames = *std::min_element(_staged.begin(), _staged.end());
+    if (frames == 0) return;
+    for (size_t i = 0; i < _staging.size(); ++i) {
+        _planes[i] = _staging[i].data();
+    }
+    _ring->write_planar(_planes.data(), frames);
+    for (size_t i = 0; i < _staging.size(); ++i) {
+        auto& buf = _staging[i];
+        std::memmove(buf.data(), buf.data() + frames, (_staged[i] - frames) * sizeof(float));
+        _staged[i] -= frames;
+    }
+}
+
+} // namespace ymery
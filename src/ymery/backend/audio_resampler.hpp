@@ -0,0 +1,161 @@
+// Audio resampler - streaming polyphase sample-rate conversion
+#pragma once
+
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "audio_stats.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ymery {
+
+class PolyphaseResampler;
+class ResampledStream;
+
+using PolyphaseResamplerPtr = std::shared_ptr<PolyphaseResampler>;
+using ResampledStreamPtr = std::shared_ptr<ResampledStream>;
+
+// Filter length and stopband attenuation; the passband extends as far
+// towards the lower Nyquist as the transition band allows
+enum class ResamplerQuality {
+    Low,     // 16 taps per phase, 60 dB
+    Medium,  // 48 taps per phase, 96 dB
+    High     // 128 taps per phase, 120 dB
+};
+
+Result<ResamplerQuality> resampler_quality_from_string(const std::string& name);
+const char* resampler_quality_name(ResamplerQuality quality);
+std::vector<std::string> resampler_quality_names();
+
+/**
+ * PolyphaseResampler - one channel, rational ratio out/in = L/M
+ *
+ * A Kaiser-windowed sinc prototype is split into L phases, each stored
+ * reversed and contiguous so an output sample is one dot product over
+ * the input history. The dot product keeps eight independent partial
+ * sums, which the compiler turns into packed multiply-adds without
+ * -ffast-math. When downsampling, taps per phase grow by M/L so the
+ * filter keeps its quality relative to the output Nyquist.
+ *
+ * process() never allocates: input is consumed in chunks of at most
+ * `max_block` frames through a preallocated history.
+ */
+class PolyphaseResampler {
+public:
+    static Result<PolyphaseResamplerPtr> create(
+        int input_rate,
+        int output_rate,
+        ResamplerQuality quality = ResamplerQuality::Medium,
+        size_t max_block = 4096
+    );
+
+    // Consume `frames` input samples, write the outputs to `out` and return
+    // how many; `out` must hold max_output(frames) samples
+    size_t process(const float* in, size_t frames, float* out);
+    size_t max_output(size_t input_frames) const;
+
+    // Back to silent history and phase 0
+    void reset();
+
+    int input_rate() const { return _input_rate; }
+    int output_rate() const { return _output_rate; }
+    ResamplerQuality quality() const { return _quality; }
+    size_t phases() const { return _phases; }        // L
+    size_t step() const { return _step; }            // M
+    size_t taps() const { return _taps; }            // per phase
+    // Group delay of the filter, in output frames
+    double delay_frames() const;
+
+private:
+    PolyphaseResampler() = default;
+
+    int _input_rate = 0;
+    int _output_rate = 0;
+    ResamplerQuality _quality = ResamplerQuality::Medium;
+    size_t _phases = 1;
+    size_t _step = 1;
+    size_t _taps = 0;
+    size_t _max_block = 0;
+
+    std::vector<float> _coefs;    // _phases rows of _taps, each reversed
+    std::vector<float> _history;  // _taps - 1 + _max_block samples
+    size_t _fill = 0;             // valid samples in _history
+    size_t _phase = 0;            // phase of the next output, in [0, L)
+};
+
+// Whole-buffer conversion of a loaded file channel, delay-compensated so
+// sample 0 stays at time 0
+Result<FileAudioBufferPtr> resample_buffer(
+    const StaticAudioBuffer& buffer,
+    int output_rate,
+    ResamplerQuality quality = ResamplerQuality::High
+);
+
+/**
+ * ResampledStream - channels of a device ring, converted to another rate
+ *
+ * Taps the source channels and resamples each written block on the
+ * producer thread into a ring of its own at the target rate, one channel
+ * per source, so plots and the mixer can combine devices running at
+ * different rates. The source channels must share one device ring; the
+ * tap of the highest source channel publishes what every channel has
+ * produced, keeping the output channels sample-aligned.
+ */
+class ResampledStream {
+public:
+    static Result<ResampledStreamPtr> create(
+        std::vector<MediatedAudioBufferPtr> sources,
+        int output_rate,
+        ResamplerQuality quality = ResamplerQuality::Medium
+    );
+
+    ~ResampledStream();
+
+    // Stop converting; the output ring keeps what was written
+    void detach();
+    bool is_attached() const { return !_taps.empty(); }
+
+    const AudioRingBufferPtr& ring() const { return _ring; }
+    // Read view of output channel `channel` (nullptr if out of range)
+    MediatedAudioBufferPtr buffer(size_t channel) const;
+
+    size_t num_channels() const { return _sources.size(); }
+    int input_rate() const { return _resamplers.front()->input_rate(); }
+    int output_rate() const { return _resamplers.front()->output_rate(); }
+    ResamplerQuality quality() const { return _resamplers.front()->quality(); }
+    double delay_frames() const { return _resamplers.front()->delay_frames(); }
+    size_t taps() const { return _resamplers.front()->taps(); }
+    size_t phases() const { return _resamplers.front()->phases(); }
+
+    uint64_t frames_in() const { return _frames_in.load(std::memory_order_relaxed); }
+    uint64_t frames_out() const { return _ring->frames_written(); }
+    // Per-block conversion time on the producer thread
+    const DeviceStats& stats() const { return _stats; }
+
+private:
+    class ChannelTap;
+
+    ResampledStream() = default;
+    void _on_write(size_t index, const float* data, size_t count);
+
+    std::vector<MediatedAudioBufferPtr> _sources;
+    std::vector<PolyphaseResamplerPtr> _resamplers;
+    std::vector<AudioTapPtr> _taps;
+    AudioRingBufferPtr _ring;
+    std::vector<MediatedAudioBufferPtr> _outputs;
+
+    // Per channel: converted frames not yet published
+    std::vector<std::vector<float>> _staging;
+    std::vector<size_t> _staged;
+    std::vector<const float*> _planes;
+    size_t _publish_index = 0;  // source whose tap runs last for a block
+
+    std::atomic<uint64_t> _frames_in{0};
+    DeviceStats _stats;
+};
+
+} // namespace ymery
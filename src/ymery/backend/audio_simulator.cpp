@@ -0,0 +1,319 @@
+// Audio simulator implementation
+#include "audio_simulator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <dr_wav.h>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+Result<SimSignal> sim_signal_from_string(const std::string& name) {
+    if (name == "sine") return SimSignal::Sine;
+    if (name == "square") return SimSignal::Square;
+    if (name == "triangle") return SimSignal::Triangle;
+    if (name == "noise") return SimSignal::Noise;
+    if (name == "file") return SimSignal::File;
+    return Err<SimSignal>("Unknown simulator signal: " + name);
+}
+
+const char* sim_signal_name(SimSignal signal) {
+    switch (signal) {
+        case SimSignal::Sine: return "sine";
+        case SimSignal::Square: return "square";
+        case SimSignal::Triangle: return "triangle";
+        case SimSignal::Noise: return "noise";
+        case SimSignal::File: return "file";
+    }
+    return "sine";
+}
+
+std::vector<std::string> sim_signal_names() {
+    return {"sine", "square", "triangle", "noise", "file"};
+}
+
+Result<std::shared_ptr<SimulatedDevice>> SimulatedDevice::create(
+    const SimulatedDeviceConfig& config,
+    const std::string& name
+) {
+    auto device = std::shared_ptr<SimulatedDevice>(new SimulatedDevice());
+    device->_name = name;
+    device->_config = config;
+    auto& cfg = device->_config;
+
+    if (cfg.signal == SimSignal::File) {
+        if (auto res = device->_load_file(); !res) {
+            return Err<std::shared_ptr<SimulatedDevice>>("SimulatedDevice: cannot replay '" + cfg.file + "'", res);
+        }
+    }
+    if (cfg.num_channels == 0 || cfg.sample_rate <= 0 || cfg.period_size == 0) {
+        return Err<std::shared_ptr<SimulatedDevice>>(
+            "SimulatedDevice: channels, sample rate and period size must be positive");
+    }
+    if (cfg.speed < 0.0 || cfg.jitter_ms < 0.0 || cfg.xrun_probability < 0.0 || cfg.xrun_probability > 1.0) {
+        return Err<std::shared_ptr<SimulatedDevice>>(
+            "SimulatedDevice: speed and jitter must not be negative, xrun probability must be in [0, 1]");
+    }
+
+    switch (cfg.signal) {
+        case SimSignal::Sine:
+        case SimSignal::Square:
+        case SimSignal::Triangle: {
+            auto kind = *waveform_kind_from_string(sim_signal_name(cfg.signal));
+            for (size_t ch = 0; ch < cfg.num_channels; ++ch) {
+                device->_oscillators.emplace_back(kind, cfg.frequency * static_cast<double>(ch + 1), cfg.sample_rate);
+            }
+            break;
+        }
+        case SimSignal::Noise:
+        case SimSignal::File:
+            break;
+    }
+
+    const size_t buffer_size = cfg.buffer_size > 0
+        ? cfg.buffer_size
+        : std::max(static_cast<size_t>(cfg.sample_rate), cfg.period_size);
+    auto ring_res = AudioRingBuffer::create(cfg.sample_rate, buffer_size, cfg.period_size, cfg.num_channels);
+    if (!ring_res) {
+        return Err<std::shared_ptr<SimulatedDevice>>("SimulatedDevice: failed to create ring buffer", ring_res);
+    }
+    device->_ring_buffer = *ring_res;
+
+    for (size_t ch = 0; ch < cfg.num_channels; ++ch) {
+        auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffer, ch);
+        if (!mediated_res) {
+            return Err<std::shared_ptr<SimulatedDevice>>("SimulatedDevice: failed to create mediated buffer", mediated_res);
+        }
+        device->_mediated_buffers.push_back(*mediated_res);
+    }
+
+    device->_planes.assign(cfg.num_channels, std::vector<float>(cfg.period_size));
+    for (const auto& plane : device->_planes) {
+        device->_plane_ptrs.push_back(plane.data());
+    }
+    device->_rng.seed(cfg.seed);
+    device->_jitter_rng.seed(cfg.seed + 1);
+    device->_noise_state = (cfg.seed * 0x9E3779B97F4A7C15ull) | 1;
+    return device;
+}
+
+SimulatedDevice::~SimulatedDevice() {
+    stop();
+}
+
+Result<void> SimulatedDevice::_load_file() {
+    unsigned int channels = 0;
+    unsigned int sample_rate = 0;
+    drwav_uint64 frames = 0;
+    float* samples = drwav_open_file_and_read_pcm_frames_f32(
+        _config.file.c_str(), &channels, &sample_rate, &frames, nullptr);
+    if (!samples) {
+        return Err<void>("SimulatedDevice: failed to open WAV file: " + _config.file);
+    }
+    _file_samples.assign(samples, samples + frames * channels);
+    drwav_free(samples, nullptr);
+
+    if (channels == 0 || frames == 0) {
+        return Err<void>("SimulatedDevice: WAV file has no audio: " + _config.file);
+    }
+    // Replaying at another rate would change the pitch; convert with the resampler instead
+    if (_config.sample_rate > 0 && _config.sample_rate != static_cast<int>(sample_rate)) {
+        return Err<void>("SimulatedDevice: file is " + std::to_string(sample_rate) + " Hz, not " +
+                         std::to_string(_config.sample_rate) + " Hz");
+    }
+    _config.sample_rate = static_cast<int>(sample_rate);
+    if (_config.num_channels == 0) _config.num_channels = channels;
+    _file_channels = channels;
+    _file_frames = static_cast<size_t>(frames);
+    _file_pos = 0;
+    return Ok();
+}
+
+MediatedAudioBufferPtr SimulatedDevice::get_buffer(size_t channel) const {
+    return channel < _mediated_buffers.size() ? _mediated_buffers[channel] : nullptr;
+}
+
+double SimulatedDevice::virtual_time() const {
+    return static_cast<double>(_clock_frames.load(std::memory_order_relaxed)) / _config.sample_rate;
+}
+
+Result<void> SimulatedDevice::start() {
+    if (_thread.joinable()) {
+        return Err<void>("SimulatedDevice::start: already started");
+    }
+    if (is_finished()) {
+        return Err<void>("SimulatedDevice::start: device has finished");
+    }
+    _stop = false;
+    _running = true;
+    // The virtual clock has no period to miss
+    const int64_t period = _config.speed > 0.0
+        ? static_cast<int64_t>(io_period_ns(_config.period_size, _config.sample_rate) / _config.speed)
+        : 0;
+    _thread.start("sim:" + _name, period, [this] { _run(); });
+    return Ok();
+}
+
+void SimulatedDevice::stop() {
+    if (!_thread.joinable()) return;
+    _stop = true;
+    _thread.join();
+    _running = false;
+}
+
+size_t SimulatedDevice::step(size_t periods) {
+    if (_thread.joinable()) return 0;
+    size_t produced = 0;
+    while (produced < periods && _produce_period()) {
+        ++produced;
+    }
+    return produced;
+}
+
+size_t SimulatedDevice::_render(size_t frames) {
+    const size_t channels = _config.num_channels;
+    switch (_config.signal) {
+        case SimSignal::Sine:
+        case SimSignal::Square:
+        case SimSignal::Triangle:
+            for (size_t ch = 0; ch < channels; ++ch) {
+                float* out = _planes[ch].data();
+                _oscillators[ch].render(out, frames);
+                for (size_t i = 0; i < frames; ++i) out[i] *= _config.amplitude;
+            }
+            return frames;
+
+        case SimSignal::Noise: {
+            // Uniform in [-amplitude, amplitude) from the top 24 bits
+            const float scale = 2.0f * _config.amplitude / 16777216.0f;
+            uint64_t x = _noise_state;
+            for (size_t ch = 0; ch < channels; ++ch) {
+                float* out = _planes[ch].data();
+                for (size_t i = 0; i < frames; ++i) {
+                    x ^= x >> 12;
+                    x ^= x << 25;
+                    x ^= x >> 27;
+                    out[i] = static_cast<float>((x * 0x2545F4914F6CDD1Dull) >> 40) * scale - _config.amplitude;
+                }
+            }
+            _noise_state = x;
+            return frames;
+        }
+
+        case SimSignal::File: {
+            // Device channel c replays file channel c modulo the file's channels
+            size_t done = 0;
+            while (done < frames) {
+                if (_file_pos >= _file_frames) {
+                    if (!_config.loop) break;
+                    _file_pos = 0;
+                }
+                const size_t run = std::min(frames - done, _file_frames - _file_pos);
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    const float* src = _file_samples.data() + _file_pos * _file_channels + ch % _file_channels;
+                    float* out = _planes[ch].data() + done;
+                    for (size_t i = 0; i < run; ++i) out[i] = src[i * _file_channels];
+                }
+                done += run;
+                _file_pos += run;
+            }
+            return done;
+        }
+    }
+    return 0;
+}
+
+bool SimulatedDevice::_produce_period() {
+    if (is_finished()) return false;
+
+    size_t frames = _config.period_size;
+    if (_config.max_frames > 0) {
+        frames = static_cast<size_t>(std::min<uint64_t>(frames, _config.max_frames - _device_frames));
+    }
+    // Drawn for every period, so the drop pattern depends only on the seed
+    const bool drop = _config.xrun_probability > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(_rng) < _config.xrun_probability;
+
+    size_t rendered = 0;
+    {
+        auto scope = _stats.time_callback();
+        rendered = _render(frames);
+        if (rendered > 0 && !drop) {
+            _ring_buffer->write_planar(_plane_ptrs.data(), rendered);
+        }
+    }
+
+    if (rendered > 0) {
+        if (drop) {
+            _stats.record_xrun();
+            _injected_xruns.fetch_add(1, std::memory_order_relaxed);
+            _frames_dropped.fetch_add(rendered, std::memory_order_relaxed);
+        } else {
+            _frames_generated.fetch_add(rendered, std::memory_order_relaxed);
+        }
+        _device_frames += rendered;
+        _clock_frames.store(_device_frames, std::memory_order_relaxed);
+    }
+
+    const bool file_ended = rendered < frames;
+    const bool limit_reached = _config.max_frames > 0 && _device_frames >= _config.max_frames;
+    if (file_ended || limit_reached) {
+        _finished.store(true, std::memory_order_release);
+    }
+    return rendered > 0;
+}
+
+void SimulatedDevice::_run() {
+    using Clock = std::chrono::steady_clock;
+    // Cap the sleep so stop() is honoured promptly at low speeds
+    constexpr auto max_sleep = std::chrono::milliseconds(20);
+    const bool paced = _config.speed > 0.0;
+    const double frames_per_second = _config.sample_rate * _config.speed;
+    auto frames_duration = [&](double frames) {
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(frames / frames_per_second));
+    };
+    // Falling behind by more than the ring loses data on real hardware too
+    const auto late_limit = paced ? frames_duration(static_cast<double>(_ring_buffer->buffer_size()))
+                                  : Clock::duration{};
+    const double jitter_frames = _config.jitter_ms * 1e-3 * _config.sample_rate;
+    std::uniform_real_distribution<double> jitter(0.0, jitter_frames);
+
+    // Deadlines derive from the anchor, so wakeup jitter never accumulates
+    auto anchor = Clock::now();
+    uint64_t anchor_frames = _device_frames;
+
+    while (!_stop.load(std::memory_order_acquire)) {
+        if (paced) {
+            // Period k completes at the end of its frames
+            const double due_frames = static_cast<double>(_device_frames + _config.period_size - anchor_frames);
+            auto due = anchor + frames_duration(due_frames);
+            auto now = Clock::now();
+            if (now - due > late_limit) {
+                _stats.record_xrun();
+                _thread.defer_log(IoLogLevel::Warn, "simulated device fell behind, re-anchored");
+                anchor = now;
+                anchor_frames = _device_frames;
+                due = now;
+            }
+            auto wake = jitter_frames > 0.0 ? due + frames_duration(jitter(_jitter_rng)) : due;
+            while (wake > now && !_stop.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_until(std::min(wake, now + max_sleep));
+                now = Clock::now();
+            }
+            if (_stop.load(std::memory_order_relaxed)) break;
+            if (now > due) {
+                auto late_us = std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+                if (late_us > _max_lateness_us.load(std::memory_order_relaxed)) {
+                    _max_lateness_us.store(late_us, std::memory_order_relaxed);
+                }
+            }
+        }
+        _thread.beat();
+        if (!_produce_period()) break;
+        if (is_finished()) break;
+    }
+    _running.store(false, std::memory_order_release);
+}
+
+} // namespace ymery
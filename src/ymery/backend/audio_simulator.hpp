@@ -0,0 +1,150 @@
+// Audio simulator - software capture devices for headless pipeline runs
+#pragma once
+
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "audio_stats.hpp"
+#include "io_thread.hpp"
+#include "oscillator.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ymery {
+
+enum class SimSignal {
+    Sine,
+    Square,
+    Triangle,
+    Noise,
+    File
+};
+
+Result<SimSignal> sim_signal_from_string(const std::string& name);
+const char* sim_signal_name(SimSignal signal);
+std::vector<std::string> sim_signal_names();
+
+struct SimulatedDeviceConfig {
+    SimSignal signal = SimSignal::Sine;
+    std::string file;               // WAV replayed by SimSignal::File
+    bool loop = true;               // restart the file at its end, otherwise finish
+    double frequency = 440.0;       // channel c plays frequency * (c + 1)
+    float amplitude = 0.5f;         // generated signals only
+    size_t num_channels = 1;        // 0 = the file's channel count
+    int sample_rate = 48000;        // 0 = the file's rate
+    size_t period_size = 1024;
+    size_t buffer_size = 0;         // ring frames, 0 = one second
+    double speed = 1.0;             // 1 = real time, 100 = 100x, 0 = virtual clock (as fast as possible)
+    double jitter_ms = 0.0;         // random extra wakeup delay per period, device time
+    double xrun_probability = 0.0;  // chance that a period is lost before the ring
+    uint64_t seed = 1;              // jitter, xrun and noise sequences
+    uint64_t max_frames = 0;        // finish after this many device frames, 0 = never
+};
+
+/**
+ * SimulatedDevice - a capture device without hardware
+ *
+ * Generates a signal or replays a WAV file into a multichannel ring, a
+ * period at a time, exactly like a capture driver. The device clock counts
+ * frames, so the same configuration and seed always produce the same
+ * samples, xruns and drops regardless of how fast the host runs.
+ *
+ * start() paces periods on an I/O thread: with speed > 0 against the wall
+ * clock scaled by speed, with speed 0 on a virtual clock that produces the
+ * next period as soon as the previous one is written. step() produces
+ * periods on the calling thread instead, for fully deterministic tests.
+ *
+ * Injected xruns drop a rendered period before it reaches the ring, the
+ * way an overrun loses captured audio; the signal keeps advancing. Jitter
+ * delays wakeups in paced mode; there is no wall clock to be late against
+ * in virtual mode, so it is ignored there.
+ */
+class SimulatedDevice {
+public:
+    static Result<std::shared_ptr<SimulatedDevice>> create(
+        const SimulatedDeviceConfig& config,
+        const std::string& name = "sim"
+    );
+
+    ~SimulatedDevice();
+
+    SimulatedDevice(const SimulatedDevice&) = delete;
+    SimulatedDevice& operator=(const SimulatedDevice&) = delete;
+
+    Result<void> start();
+    void stop();
+
+    // Produce up to `periods` periods on the calling thread, unpaced; only
+    // while stopped. Returns the periods produced, fewer once finished.
+    size_t step(size_t periods = 1);
+
+    bool is_running() const { return _running.load(std::memory_order_acquire); }
+    // max_frames reached, or the end of a file that does not loop
+    bool is_finished() const { return _finished.load(std::memory_order_acquire); }
+
+    MediatedAudioBufferPtr get_buffer(size_t channel) const;
+
+    const std::string& name() const { return _name; }
+    const SimulatedDeviceConfig& config() const { return _config; }
+    size_t num_channels() const { return _config.num_channels; }
+    int sample_rate() const { return _config.sample_rate; }
+    size_t period_size() const { return _config.period_size; }
+
+    // Frames written to the ring, and frames lost to injected xruns
+    uint64_t frames_generated() const { return _frames_generated.load(std::memory_order_relaxed); }
+    uint64_t frames_dropped() const { return _frames_dropped.load(std::memory_order_relaxed); }
+    uint64_t injected_xruns() const { return _injected_xruns.load(std::memory_order_relaxed); }
+    // Seconds of audio on the device clock, dropped periods included
+    double virtual_time() const;
+    int64_t max_lateness_us() const { return _max_lateness_us.load(std::memory_order_relaxed); }
+
+    const DeviceStats& stats() const { return _stats; }
+    const AudioRingBufferPtr& ring_buffer() const { return _ring_buffer; }
+    const IoThreadMonitorPtr& monitor() const { return _thread.monitor(); }
+
+private:
+    SimulatedDevice() = default;
+
+    Result<void> _load_file();
+    // Render, then write or drop, one period; false once finished
+    bool _produce_period();
+    size_t _render(size_t frames);
+    void _run();
+
+    std::string _name;
+    SimulatedDeviceConfig _config;
+
+    AudioRingBufferPtr _ring_buffer;
+    std::vector<MediatedAudioBufferPtr> _mediated_buffers;
+    std::vector<std::vector<float>> _planes;
+    std::vector<const float*> _plane_ptrs;
+
+    std::vector<Oscillator> _oscillators;
+    std::vector<float> _file_samples;  // interleaved
+    size_t _file_channels = 0;
+    size_t _file_frames = 0;
+    size_t _file_pos = 0;
+
+    std::mt19937_64 _rng;         // xrun draws
+    std::mt19937_64 _jitter_rng;  // kept apart so paced runs drop what step() drops
+    uint64_t _noise_state = 1;    // xorshift64*, cheap enough for benchmark sources
+    uint64_t _device_frames = 0;  // device clock, producer side
+
+    std::atomic<uint64_t> _frames_generated{0};
+    std::atomic<uint64_t> _frames_dropped{0};
+    std::atomic<uint64_t> _injected_xruns{0};
+    std::atomic<uint64_t> _clock_frames{0};
+    std::atomic<int64_t> _max_lateness_us{0};
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _stop{false};
+    std::atomic<bool> _finished{false};
+    IoThread _thread;
+    DeviceStats _stats;
+};
+
+using SimulatedDevicePtr = std::shared_ptr<SimulatedDevice>;
+
+} // namespace ymery
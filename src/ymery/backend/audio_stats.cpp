@@ -0,0 +1,291 @@
+// Audio stats implementation
+#include "audio_stats.hpp"
+#include "audio_buffer.hpp"
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace ymery {
+
+int64_t audio_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ============== LatencyHistogram ==============
+
+void LatencyHistogram::record(int64_t duration_ns) {
+    if (duration_ns < 0) duration_ns = 0;
+    auto us = static_cast<uint64_t>(duration_ns / 1000);
+    size_t bucket = std::min<size_t>(std::bit_width(us), NUM_BUCKETS - 1);
+
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+
+    int64_t prev = _max_ns.load(std::memory_order_relaxed);
+    while (duration_ns > prev &&
+           !_max_ns.compare_exchange_weak(prev, duration_ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : _buckets) b.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum_ns.store(0, std::memory_order_relaxed);
+    _max_ns.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean_us() const {
+    uint64_t n = count();
+    if (n == 0) return 0.0;
+    return _sum_ns.load(std::memory_order_relaxed) / 1000.0 / static_cast<double>(n);
+}
+
+double LatencyHistogram::percentile_us(double quantile) const {
+    uint64_t n = count();
+    if (n == 0) return 0.0;
+
+    auto target = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(n)));
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return static_cast<double>(uint64_t{1} << i);
+        }
+    }
+    return max_us();
+}
+
+Dict LatencyHistogram::to_dict() const {
+    List buckets;
+    size_t last = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        if (_buckets[i].load(std::memory_order_relaxed)) last = i + 1;
+    }
+    for (size_t i = 0; i < last; ++i) {
+        buckets.push_back(Value(static_cast<int64_t>(_buckets[i].load(std::memory_order_relaxed))));
+    }
+
+    return Dict{
+        {"count", Value(static_cast<int64_t>(count()))},
+        {"mean-us", Value(mean_us())},
+        {"p50-us", Value(percentile_us(0.50))},
+        {"p90-us", Value(percentile_us(0.90))},
+        {"p99-us", Value(percentile_us(0.99))},
+        {"max-us", Value(max_us())},
+        {"log2-us-buckets", Value(buckets)}
+    };
+}
+
+// ============== AudioBufferStats ==============
+
+Dict AudioBufferStats::to_dict() const {
+    int64_t last = last_write_ns.load(std::memory_order_relaxed);
+    double age_us = last ? (audio_now_ns() - last) / 1000.0 : 0.0;
+
+    return Dict{
+        {"blocks-written", Value(static_cast<int64_t>(blocks_written.load(std::memory_order_relaxed)))},
+        {"samples-written", Value(static_cast<int64_t>(samples_written.load(std::memory_order_relaxed)))},
+        {"last-write-age-us", Value(age_us)},
+        {"lock-contention", Value(static_cast<int64_t>(lock_contention.load(std::memory_order_relaxed)))},
+        {"reads", Value(static_cast<int64_t>(reads.load(std::memory_order_relaxed)))},
+        {"underruns", Value(static_cast<int64_t>(underruns.load(std::memory_order_relaxed)))},
+        {"overruns", Value(static_cast<int64_t>(overruns.load(std::memory_order_relaxed)))},
+        {"write-duration", Value(write_duration.to_dict())},
+        {"read-lag", Value(read_lag.to_dict())}
+    };
+}
+
+// ============== DeviceStats ==============
+
+DeviceStats::CallbackScope::CallbackScope(DeviceStats& stats)
+    : _stats(stats)
+    , _start_ns(audio_now_ns())
+{
+    int64_t prev = _stats._last_callback_ns.exchange(_start_ns, std::memory_order_relaxed);
+    if (prev) {
+        _stats._callback_interval.record(_start_ns - prev);
+    }
+}
+
+DeviceStats::CallbackScope::~CallbackScope() {
+    _stats._callback_duration.record(audio_now_ns() - _start_ns);
+}
+
+Dict DeviceStats::to_dict() const {
+    return Dict{
+        {"callbacks", Value(static_cast<int64_t>(callbacks()))},
+        {"xruns", Value(static_cast<int64_t>(xruns()))},
+        {"callback-duration", Value(_callback_duration.to_dict())},
+        {"callback-interval", Value(_callback_interval.to_dict())}
+    };
+}
+
+// ============== stats subtree ==============
+
+std::optional<std::vector<std::string>> audio_stats_rel(const DataPath& path) {
+    const auto& parts = path.as_list();
+    if (parts.size() < 3 || parts[0] != "opened" || parts[2] != "stats") return std::nullopt;
+    return std::vector<std::string>(parts.begin() + 3, parts.end());
+}
+
+std::vector<std::string> audio_stats_children_names(
+    const std::vector<std::string>& rel,
+    const AudioRingBufferPtr& ring
+) {
+    if (!rel.empty() || !ring) return {};
+    std::vector<std::string> names;
+    for (size_t i = 0; i < ring->channels(); ++i) {
+        names.push_back(std::to_string(i));
+    }
+    return names;
+}
+
+Dict audio_stats_metadata(
+    const std::vector<std::string>& rel,
+    const DeviceStats* device_stats,
+    const AudioRingBufferPtr& ring
+) {
+    const size_t channels = ring ? ring->channels() : 0;
+    if (rel.empty()) {
+        Dict meta = device_stats ? device_stats->to_dict() : Dict{};
+
+        uint64_t samples = 0, underruns = 0, overruns = 0, contention = 0;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            const auto& s = ring->stats(ch);
+            samples += s.samples_written.load(std::memory_order_relaxed);
+            underruns += s.underruns.load(std::memory_order_relaxed);
+            overruns += s.overruns.load(std::memory_order_relaxed);
+            contention += s.lock_contention.load(std::memory_order_relaxed);
+        }
+        meta["samples-written"] = Value(static_cast<int64_t>(samples));
+        meta["underruns"] = Value(static_cast<int64_t>(underruns));
+        meta["overruns"] = Value(static_cast<int64_t>(overruns));
+        meta["lock-contention"] = Value(static_cast<int64_t>(contention));
+
+        List per_channel;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            per_channel.push_back(Value(ring->stats(ch).to_dict()));
+        }
+        Dict dump = meta;
+        dump["channels"] = Value(per_channel);
+
+        meta["name"] = Value(std::string("stats"));
+        meta["label"] = Value(std::string("Stats"));
+        meta["type"] = Value(std::string("audio-stats"));
+        meta["category"] = Value(std::string("folder"));
+        meta["json"] = Value(value_to_json(Value(dump)));
+        return meta;
+    }
+
+    if (rel.size() == 1) {
+        size_t channel = 0;
+        try {
+            channel = std::stoul(rel[0]);
+        } catch (...) {
+            return Dict{};
+        }
+        if (channel >= channels) return Dict{};
+
+        Dict meta = ring->stats(channel).to_dict();
+        meta["name"] = Value(rel[0]);
+        meta["label"] = Value("Channel " + rel[0]);
+        meta["type"] = Value(std::string("audio-channel-stats"));
+        meta["category"] = Value(std::string("stats"));
+        return meta;
+    }
+
+    return Dict{};
+}
+
+// ============== JSON ==============
+
+namespace {
+
+void append_json_string(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void append_json_number(std::string& out, double d) {
+    if (!std::isfinite(d)) {
+        out += "null";
+        return;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.10g", d);
+    out += buf;
+}
+
+void append_json(std::string& out, const Value& value) {
+    if (!value.has_value()) {
+        out += "null";
+    } else if (auto d = get_as<Dict>(value)) {
+        out += '{';
+        bool first = true;
+        for (const auto& [k, v] : *d) {
+            if (!first) out += ',';
+            first = false;
+            append_json_string(out, k);
+            out += ':';
+            append_json(out, v);
+        }
+        out += '}';
+    } else if (auto l = get_as<List>(value)) {
+        out += '[';
+        for (size_t i = 0; i < l->size(); ++i) {
+            if (i) out += ',';
+            append_json(out, (*l)[i]);
+        }
+        out += ']';
+    } else if (auto s = get_as<std::string>(value)) {
+        append_json_string(out, *s);
+    } else if (auto cs = get_as<const char*>(value)) {
+        append_json_string(out, *cs ? *cs : "");
+    } else if (auto b = get_as<bool>(value)) {
+        out += *b ? "true" : "false";
+    } else if (auto i = get_as<int>(value)) {
+        out += std::to_string(*i);
+    } else if (auto i64 = get_as<int64_t>(value)) {
+        out += std::to_string(*i64);
+    } else if (auto u64 = get_as<uint64_t>(value)) {
+        out += std::to_string(*u64);
+    } else if (auto dbl = get_as<double>(value)) {
+        append_json_number(out, *dbl);
+    } else if (auto f = get_as<float>(value)) {
+        append_json_number(out, *f);
+    } else {
+        out += "null";
+    }
+}
+
+} // namespace
+
+std::string value_to_json(const Value& value) {
+    std::string out;
+    append_json(out, value);
+    return out;
+}
+
+} // namespace ymery
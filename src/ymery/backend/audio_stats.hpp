@@ -0,0 +1,135 @@
+// Audio stats - latency and throughput instrumentation for audio devices
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ymery {
+
+class AudioRingBuffer;
+using AudioRingBufferPtr = std::shared_ptr<AudioRingBuffer>;
+
+// Monotonic timestamp in nanoseconds (steady clock)
+int64_t audio_now_ns();
+
+/**
+ * LatencyHistogram - lock-free log2 histogram of durations
+ * Bucket 0 holds values under 1us, bucket k holds [2^(k-1), 2^k) us.
+ * Safe to record from a real-time thread and read from any other.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t NUM_BUCKETS = 32;
+
+    void record(int64_t duration_ns);
+    void reset();
+
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+    double mean_us() const;
+    double max_us() const { return _max_ns.load(std::memory_order_relaxed) / 1000.0; }
+    // Upper bound of the bucket holding the given quantile (0..1)
+    double percentile_us(double quantile) const;
+
+    Dict to_dict() const;
+
+private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> _buckets{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<int64_t> _sum_ns{0};
+    std::atomic<int64_t> _max_ns{0};
+};
+
+/**
+ * AudioBufferStats - counters kept by an AudioRingBuffer for each channel
+ * Written by the producer on every block and by consumers on every read.
+ */
+struct AudioBufferStats {
+    std::atomic<uint64_t> blocks_written{0};
+    std::atomic<uint64_t> samples_written{0};
+    std::atomic<int64_t> last_write_ns{0};   // timestamp of the newest block
+    std::atomic<uint64_t> lock_contention{0};  // writes/reads that found the buffer busy
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> underruns{0};      // reads that found no new samples
+    std::atomic<uint64_t> overruns{0};       // reads after unread samples were overwritten
+    LatencyHistogram write_duration;         // write() including taps
+    LatencyHistogram read_lag;               // age of the newest sample when read
+
+    Dict to_dict() const;
+};
+
+/**
+ * DeviceStats - per-device producer callback timing
+ * Devices wrap their capture callback with a CallbackScope.
+ */
+class DeviceStats {
+public:
+    class CallbackScope {
+    public:
+        explicit CallbackScope(DeviceStats& stats);
+        ~CallbackScope();
+    private:
+        DeviceStats& _stats;
+        int64_t _start_ns;
+    };
+
+    CallbackScope time_callback() { return CallbackScope(*this); }
+    void record_xrun() { _xruns.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t callbacks() const { return _callback_duration.count(); }
+    uint64_t xruns() const { return _xruns.load(std::memory_order_relaxed); }
+
+    Dict to_dict() const;
+
+private:
+    LatencyHistogram _callback_duration;
+    LatencyHistogram _callback_interval;
+    std::atomic<int64_t> _last_callback_ns{0};
+    std::atomic<uint64_t> _xruns{0};
+};
+
+/**
+ * Shared /opened/<device>/stats subtree for audio providers
+ * `rel` is the path below "stats"; `ring` is the device's multichannel ring.
+ *   /stats        - device callback stats, totals and a "json" dump
+ *   /stats/<ch>   - per-channel buffer stats
+ */
+std::vector<std::string> audio_stats_children_names(
+    const std::vector<std::string>& rel,
+    const AudioRingBufferPtr& ring
+);
+Dict audio_stats_metadata(
+    const std::vector<std::string>& rel,
+    const DeviceStats* device_stats,
+    const AudioRingBufferPtr& ring
+);
+
+// Path below "stats" when `path` is /opened/<device>/stats[/...]
+std::optional<std::vector<std::string>> audio_stats_rel(const DataPath& path);
+
+// Device of /opened/<device>/stats[/...] in a provider's map of device
+// pointers, or null; `rel` receives the path below "stats"
+template <typename Devices>
+typename Devices::mapped_type audio_stats_device(
+    const Devices& devices,
+    const DataPath& path,
+    std::vector<std::string>& rel
+) {
+    auto below = audio_stats_rel(path);
+    if (!below) return nullptr;
+    auto it = devices.find(path.as_list()[1]);
+    if (it == devices.end()) return nullptr;
+    rel = std::move(*below);
+    return it->second;
+}
+
+// Serialize a Value (Dict/List/scalars) as JSON
+std::string value_to_json(const Value& value);
+
+} // namespace ymery
@@ -0,0 +1,152 @@
+// Audio trigger implementation
+#include "audio_trigger.hpp"
+#include <optional>
+
+namespace ymery {
+
+namespace {
+
+// YAML scalars arrive as int or double depending on how they were written
+std::optional<double> as_number(const Value& v) {
+    if (auto d = get_as<double>(v)) return d;
+    if (auto i = get_as<int>(v)) return static_cast<double>(*i);
+    if (auto i = get_as<int64_t>(v)) return static_cast<double>(*i);
+    return std::nullopt;
+}
+
+} // namespace
+
+Result<TriggerConfig> TriggerConfig::from_dict(const Dict& dict) {
+    TriggerConfig config;
+
+    if (auto it = dict.find("edge"); it != dict.end()) {
+        auto edge = get_as<std::string>(it->second);
+        if (!edge) return Err<TriggerConfig>("trigger: 'edge' must be a string");
+        if (*edge == "rising") {
+            config.edge = TriggerEdge::Rising;
+        } else if (*edge == "falling") {
+            config.edge = TriggerEdge::Falling;
+        } else {
+            return Err<TriggerConfig>("trigger: unknown edge '" + *edge + "'");
+        }
+    }
+    if (auto it = dict.find("level"); it != dict.end()) {
+        if (auto v = as_number(it->second)) config.level = static_cast<float>(*v);
+    }
+    if (auto it = dict.find("hysteresis"); it != dict.end()) {
+        if (auto v = as_number(it->second)) config.hysteresis = static_cast<float>(*v);
+    }
+    if (auto it = dict.find("pre"); it != dict.end()) {
+        if (auto v = as_number(it->second)) config.pre_samples = static_cast<size_t>(*v);
+    }
+    if (auto it = dict.find("post"); it != dict.end()) {
+        if (auto v = as_number(it->second)) config.post_samples = static_cast<size_t>(*v);
+    }
+    if (auto it = dict.find("auto"); it != dict.end()) {
+        if (auto v = as_number(it->second)) config.auto_samples = static_cast<size_t>(*v);
+    }
+
+    if (config.post_samples == 0) {
+        return Err<TriggerConfig>("trigger: 'post' must be greater than zero");
+    }
+    if (config.hysteresis < 0.0f) {
+        return Err<TriggerConfig>("trigger: 'hysteresis' must not be negative");
+    }
+    return config;
+}
+
+Result<AudioTriggerPtr> AudioTrigger::create(const TriggerConfig& config) {
+    if (config.post_samples == 0) {
+        return Err<AudioTriggerPtr>("AudioTrigger: post_samples must be greater than zero");
+    }
+
+    auto trigger = std::shared_ptr<AudioTrigger>(new AudioTrigger());
+    trigger->_config = config;
+    trigger->_history.assign(config.pre_samples, 0.0f);
+    for (auto& frame : trigger->_frames) {
+        frame.samples.assign(config.frame_size(), 0.0f);
+    }
+    return trigger;
+}
+
+void AudioTrigger::on_write(const float* data, size_t count) {
+    const float level = _config.level;
+    const float arm_below = level - _config.hysteresis;
+    const float arm_above = level + _config.hysteresis;
+    const size_t pre = _config.pre_samples;
+    const size_t frame_size = _config.frame_size();
+
+    for (size_t i = 0; i < count; ++i) {
+        const float x = data[i];
+
+        if (_capturing) {
+            _frames[_back].samples[_fill++] = x;
+            if (_fill == frame_size) {
+                _publish();
+            }
+        } else if (_history_count >= pre) {
+            bool fire = false;
+            if (_config.edge == TriggerEdge::Rising) {
+                if (x < arm_below) _armed = true;
+                fire = _armed && x >= level;
+            } else {
+                if (x > arm_above) _armed = true;
+                fire = _armed && x <= level;
+            }
+
+            ++_since_trigger;
+            bool forced = !fire && _config.auto_samples > 0 && _since_trigger >= _config.auto_samples;
+
+            if (fire || forced) {
+                _begin_capture(forced);
+                _frames[_back].samples[_fill++] = x;
+                if (_fill == frame_size) {
+                    _publish();
+                }
+            }
+        }
+
+        if (pre > 0) {
+            _history[_history_pos] = x;
+            _history_pos = _history_pos + 1 == pre ? 0 : _history_pos + 1;
+            if (_history_count < pre) ++_history_count;
+        }
+    }
+}
+
+void AudioTrigger::_begin_capture(bool forced) {
+    auto& frame = _frames[_back];
+    const size_t pre = _config.pre_samples;
+
+    // History is circular with _history_pos at the oldest sample
+    for (size_t i = 0; i < pre; ++i) {
+        size_t idx = _history_pos + i;
+        if (idx >= pre) idx -= pre;
+        frame.samples[i] = _history[idx];
+    }
+    frame.forced = forced;
+    _fill = pre;
+    _capturing = true;
+    _armed = false;
+    _since_trigger = 0;
+}
+
+void AudioTrigger::_publish() {
+    _frames[_back].sequence = ++_sequence;
+    int previous = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+    _back = previous & ~FRESH;
+    _capturing = false;
+    _fill = 0;
+    _published.fetch_add(1, std::memory_order_relaxed);
+}
+
+const TriggerFrame* AudioTrigger::latest() {
+    if (_middle.load(std::memory_order_acquire) & FRESH) {
+        int previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & ~FRESH;
+        _has_front = true;
+    }
+    return _has_front ? &_frames[_front] : nullptr;
+}
+
+} // namespace ymery
@@ -0,0 +1,96 @@
+// Audio trigger - producer-side edge triggered capture (oscilloscope mode)
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include "audio_buffer.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ymery {
+
+class AudioTrigger;
+using AudioTriggerPtr = std::shared_ptr<AudioTrigger>;
+
+enum class TriggerEdge {
+    Rising,
+    Falling
+};
+
+struct TriggerConfig {
+    TriggerEdge edge = TriggerEdge::Rising;
+    float level = 0.0f;
+    float hysteresis = 0.01f;    // signal must cross level -/+ hysteresis to re-arm
+    size_t pre_samples = 256;    // samples kept before the trigger point
+    size_t post_samples = 768;   // samples captured from the trigger point on
+    size_t auto_samples = 0;     // publish an untriggered frame after this many samples (0 = normal mode)
+
+    size_t frame_size() const { return pre_samples + post_samples; }
+    bool operator==(const TriggerConfig&) const = default;
+
+    // Parse {edge, level, hysteresis, pre, post, auto} from widget/YAML data
+    static Result<TriggerConfig> from_dict(const Dict& dict);
+};
+
+struct TriggerFrame {
+    std::vector<float> samples;  // pre_samples before the trigger, then post_samples
+    uint64_t sequence = 0;       // increments per published frame
+    bool forced = false;         // published by auto mode without a trigger
+};
+
+/**
+ * AudioTrigger - finds trigger points as samples are written and publishes
+ * complete frames
+ *
+ * Attached to a ring buffer as a tap, it runs incrementally on the producer
+ * thread, keeping only pre_samples of history. Finished frames go into a
+ * triple buffer: the producer never waits and the consumer reads the
+ * latest frame in place, without locking or copying the ring.
+ * One consumer per trigger; the config is fixed at creation.
+ */
+class AudioTrigger : public AudioTap {
+public:
+    static Result<AudioTriggerPtr> create(const TriggerConfig& config);
+
+    // Producer side (AudioTap)
+    void on_write(const float* data, size_t count) override;
+
+    // Consumer side - most recent complete frame, or nullptr before the first one
+    const TriggerFrame* latest();
+
+    const TriggerConfig& config() const { return _config; }
+    uint64_t frames_published() const { return _published; }
+
+private:
+    AudioTrigger() = default;
+
+    void _begin_capture(bool forced);
+    void _publish();
+
+    static constexpr int FRESH = 4;
+
+    TriggerConfig _config;
+
+    // Producer state
+    std::vector<float> _history;  // circular, pre_samples long
+    size_t _history_pos = 0;
+    size_t _history_count = 0;
+    bool _armed = false;
+    bool _capturing = false;
+    size_t _fill = 0;
+    size_t _since_trigger = 0;
+    uint64_t _sequence = 0;
+
+    // Triple buffer: producer owns _back, consumer owns _front, _middle is exchanged
+    std::array<TriggerFrame, 3> _frames;
+    int _back = 0;
+    std::atomic<int> _middle{1};
+    int _front = 2;
+    bool _has_front = false;
+    std::atomic<uint64_t> _published{0};
+};
+
+} // namespace ymery
@@ -3,6 +3,7 @@
 // Wraps YAML::Node for native YAML serialization support
 #include "../types.hpp"
 #include "../result.hpp"
+#include "../yaml_numeric.hpp"
 #include <yaml-cpp/yaml.h>
 #include <ytrace/ytrace.hpp>
 
@@ -95,7 +96,10 @@ public:
             return Ok(Dict{});
         }
 
-        return Ok(_yaml_to_dict(metadata));
+        // Arrays set from code live in the cache, not in the YAML node
+        Dict result = _yaml_to_dict(metadata);
+        _arrays.overlay(path.to_string(), result);
+        return Ok(result);
     }
 
     Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
@@ -110,6 +114,68 @@ public:
         return Ok(keys);
     }
 
+    // One walk to the node, then only the asked-for keys of each child are
+    // converted, instead of a navigation and a full Dict per child
+    Result<ChildrenMetadata> get_children_metadata(const DataPath& path,
+                                                   const std::vector<std::string>& keys) override {
+        auto nav_res = _navigate(path);
+        if (!nav_res) {
+            return Ok(ChildrenMetadata(keys));
+        }
+
+        auto& [node, remaining] = *nav_res;
+
+        // Check if delegating to nested TreeLike
+        if (!remaining.is_root()) {
+            auto it = _nested_trees.find(path.to_string());
+            if (it != _nested_trees.end()) {
+                return it->second->get_children_metadata(remaining, keys);
+            }
+        }
+
+        ChildrenMetadata result(keys);
+        if (!node.IsMap()) {
+            return Ok(std::move(result));
+        }
+        auto children = node["children"];
+        if (!children.IsDefined() || !children.IsMap()) {
+            return Ok(std::move(result));
+        }
+
+        result.reserve(children.size());
+        for (auto it = children.begin(); it != children.end(); ++it) {
+            std::string name = it->first.as<std::string>();
+            const DataPath child_path = path / name;
+
+            // Nested trees and cached arrays answer through the usual calls
+            if (!_nested_trees.empty() && _nested_trees.count(child_path.to_string())) {
+                auto meta = get_metadata(child_path);
+                result.append(std::move(name), meta ? *meta : Dict{});
+                continue;
+            }
+
+            const YAML::Node child = it->second;
+            const YAML::Node metadata = child.IsMap() ? child["metadata"] : YAML::Node();
+            const bool has_metadata = metadata.IsDefined() && metadata.IsMap();
+            for (size_t k = 0; k < keys.size(); ++k) {
+                Value value;
+                if (!_arrays.empty()) {
+                    if (auto cached = _arrays.find((child_path / keys[k]).to_string())) {
+                        value = std::move(cached);
+                    }
+                }
+                if (!value.has_value() && has_metadata) {
+                    if (auto val = metadata[keys[k]]; val.IsDefined()) {
+                        value = _yaml_to_value(val);
+                    }
+                }
+                result.columns[k].push_back(std::move(value));
+            }
+            result.names.push_back(std::move(name));
+        }
+        return Ok(std::move(result));
+    }
+
     Result<Value> get(const DataPath& path) override {
         DataPath node_path = path.dirname();
         std::string key = path.filename();
@@ -118,6 +184,11 @@ public:
             return Err<Value>("DataTree::get: empty key");
         }
 
+        // Typed arrays are handed out by pointer, never re-converted
+        if (auto array = _arrays.find(path.to_string())) {
+            return Ok(Value(array));
+        }
+
         auto nav_res = _navigate(node_path);
         if (!nav_res) {
             return Ok(Value{});
@@ -148,6 +219,10 @@ public:
             return Ok(Value{});
         }
 
+        if (auto array = yaml_to_numeric_array(val)) {
+            _arrays.cache(path.to_string(), array);
+            return Ok(Value(array));
+        }
         return Ok(_yaml_to_value(val));
     }
 
@@ -183,6 +258,14 @@ public:
             node["metadata"] = YAML::Node(YAML::NodeType::Map);
         }
 
+        // Typed arrays stay in the cache until the tree is serialized, so
+        // setting a large array every frame costs a pointer copy
+        if (auto array = get_ptr<NumericArrayPtr>(value); array && *array) {
+            _arrays.store(path.to_string(), *array);
+            node["metadata"][key] = YAML::Node();
+            return Ok();
+        }
+        _arrays.erase(path.to_string());
         node["metadata"][key] = _value_to_yaml(value);
         return Ok();
     }
@@ -212,6 +295,9 @@ public:
             node["children"] = YAML::Node(YAML::NodeType::Map);
         }
 
+        // Arrays cached for a previous child of the same name are stale
+        _arrays.erase_under((path / name).to_string());
+
         // Create child node with metadata
         YAML::Node child(YAML::NodeType::Map);
         child["metadata"] = _dict_to_yaml(data);
@@ -221,6 +307,7 @@ public:
     }
 
     Result<std::string> as_tree(const DataPath& path, int depth) override {
+        _sync_arrays();
         return Ok(YAML::Dump(_root));
     }
 
@@ -228,7 +315,7 @@ public:
         _nested_trees[path.to_string()] = tree;
     }
 
-    YAML::Node& root() { return _root; }
+    YAML::Node& root() { _sync_arrays(); return _root; }
     const YAML::Node& root() const { return _root; }
 
 private:
@@ -267,12 +354,22 @@ private:
                     "DataTree::_navigate: child '" + part + "' not found");
             }
 
-            current = child;
+            current.reset(child);  // rebind - assignment would overwrite the parent node
         }
 
         return Ok(std::make_pair(current, DataPath::root()));
     }
 
+    // Write the arrays set from code into their YAML nodes
+    void _sync_arrays() {
+        if (_arrays.empty()) return;
+        _arrays.sync([this](const std::string& node_path) {
+            auto nav_res = _navigate(DataPath::parse(node_path));
+            if (!nav_res || !nav_res->second.is_root() || !nav_res->first.IsMap()) return YAML::Node();
+            return nav_res->first["metadata"];
+        });
+    }
+
     void _ensure_path(const DataPath& path) {
         if (path.is_root() || path.as_list().empty()) {
             return;
@@ -286,7 +383,7 @@ private:
             if (!current["children"][part].IsDefined()) {
                 current["children"][part] = YAML::Node(YAML::NodeType::Map);
             }
-            current = current["children"][part];
+            current.reset(current["children"][part]);
         }
     }
 
@@ -305,6 +402,9 @@ private:
         if (node.IsNull() || !node.IsDefined()) {
             return Value{};
         }
+        if (auto array = yaml_to_numeric_array(node)) {
+            return Value(array);
+        }
         if (node.IsScalar()) {
             std::string str = node.as<std::string>();
             if (str == "true" || str == "True" || str == "TRUE") return Value(true);
@@ -358,6 +458,9 @@ private:
         if (auto b = get_as<bool>(value)) {
             return YAML::Node(*b);
         }
+        if (auto array = get_ptr<NumericArrayPtr>(value); array && *array) {
+            return numeric_array_to_yaml(**array);
+        }
         if (auto list = get_as<List>(value)) {
             YAML::Node node(YAML::NodeType::Sequence);
             for (const auto& item : *list) {
@@ -373,6 +476,9 @@ private:
 
     YAML::Node _root;
     std::map<std::string, TreeLikePtr> _nested_trees;
+
+    // Typed arrays by full path ("/node/key"), converted once or set directly
+    NumericArrayCache _arrays;
 };
 
 namespace embedded {
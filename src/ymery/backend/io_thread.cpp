@@ -0,0 +1,360 @@
+// I/O thread service implementation
+#include "io_thread.hpp"
+#include "audio_stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ytrace/ytrace.hpp>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ymery {
+
+namespace {
+
+// Beats older than this many deadlines mark a thread as stalled
+constexpr double STALL_DEADLINES = 4.0;
+
+void update_max(std::atomic<int64_t>& max, int64_t value) {
+    int64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+Result<IoSchedPolicy> io_sched_policy_from_string(const std::string& name) {
+    if (name == "other" || name == "default") return IoSchedPolicy::Other;
+    if (name == "fifo") return IoSchedPolicy::Fifo;
+    if (name == "rr") return IoSchedPolicy::RoundRobin;
+    return Err<IoSchedPolicy>("Unknown scheduling policy: " + name + " (expected other, fifo or rr)");
+}
+
+const char* io_sched_policy_name(IoSchedPolicy policy) {
+    switch (policy) {
+        case IoSchedPolicy::Other: return "other";
+        case IoSchedPolicy::Fifo: return "fifo";
+        case IoSchedPolicy::RoundRobin: return "rr";
+    }
+    return "other";
+}
+
+// ============== IoThreadMonitor ==============
+
+IoThreadMonitor::IoThreadMonitor(std::string name, int64_t period_ns, double deadline_tolerance)
+    : _name(std::move(name)), _tolerance(deadline_tolerance), _period_ns(period_ns) {}
+
+void IoThreadMonitor::beat() {
+    const int64_t now = audio_now_ns();
+    const int64_t last = _last_beat_ns.exchange(now, std::memory_order_relaxed);
+    _cycles.fetch_add(1, std::memory_order_relaxed);
+    _stalled.store(false, std::memory_order_relaxed);
+
+    const int64_t period = _period_ns.load(std::memory_order_relaxed);
+    if (last == 0 || period <= 0) return;
+    const int64_t lateness = (now - last) - period;
+    update_max(_max_lateness_ns, lateness);
+    if (now - last > static_cast<int64_t>(period * _tolerance)) {
+        _missed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void IoThreadMonitor::beat(int64_t period_ns) {
+    _period_ns.store(period_ns, std::memory_order_relaxed);
+    beat();
+}
+
+void IoThreadMonitor::defer_log(IoLogLevel level, const char* message, int64_t value) {
+    LogEntry* slot = _log.begin_push();
+    if (!slot) {
+        _dropped_logs.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot->level = level;
+    slot->message = message;
+    slot->value = value;
+    _log.commit_push();
+}
+
+Dict IoThreadMonitor::to_dict() const {
+    const int64_t last = _last_beat_ns.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_info_mutex);
+    return Dict{
+        {"name", Value(_name)},
+        {"label", Value(_name)},
+        {"type", Value("io-thread")},
+        {"category", Value("io-thread")},
+        {"thread-id", Value(_thread_id)},
+        {"scheduling", Value(_scheduling)},
+        {"priority", Value(static_cast<int64_t>(_priority))},
+        {"affinity", Value(_affinity)},
+        {"period-us", Value(period_ns() / 1000.0)},
+        {"cycles", Value(static_cast<int64_t>(cycles()))},
+        {"missed-deadlines", Value(static_cast<int64_t>(missed_deadlines()))},
+        {"max-lateness-us", Value(std::max<int64_t>(0, max_lateness_ns()) / 1000.0)},
+        {"stalled", Value(stalled())},
+        {"stalls", Value(static_cast<int64_t>(stalls()))},
+        {"last-beat-age-us", Value(last ? (audio_now_ns() - last) / 1000.0 : 0.0)},
+        {"dropped-logs", Value(static_cast<int64_t>(dropped_logs()))}
+    };
+}
+
+// ============== IoThreadService ==============
+
+IoThreadService& IoThreadService::instance() {
+    static IoThreadService service;
+    return service;
+}
+
+IoThreadService::~IoThreadService() {
+    shutdown();
+}
+
+Result<void> IoThreadService::configure(const IoThreadConfig& config) {
+    if (config.deadline_tolerance < 1.0) {
+        return Err<void>("IoThreadService::configure: deadline tolerance must be at least 1");
+    }
+    shutdown();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config = config;
+    }
+
+    if (config.lock_memory && !_memory_locked) {
+#if defined(__linux__) || defined(__APPLE__)
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            _memory_locked = true;
+            _memory_lock_error.clear();
+        } else {
+            _memory_lock_error = std::strerror(errno);
+            ywarn("IoThreadService: mlockall failed ({}), audio memory may be paged out", _memory_lock_error);
+        }
+#else
+        _memory_lock_error = "not supported on this platform";
+#endif
+    }
+
+    if (config.watchdog_ms > 0) {
+        _watchdog_running = true;
+        _watchdog_thread = std::thread(&IoThreadService::_watchdog, this);
+    }
+    ydebug("IoThreadService: policy={} priority={} cpus={} mlock={} watchdog={}ms",
+           io_sched_policy_name(config.policy), config.priority, config.cpus.size(),
+           _memory_locked.load(), config.watchdog_ms);
+    return Ok();
+}
+
+IoThreadConfig IoThreadService::config() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _config;
+}
+
+void IoThreadService::shutdown() {
+    _watchdog_running = false;
+    if (_watchdog_thread.joinable()) {
+        _watchdog_thread.join();
+    }
+}
+
+IoThreadMonitorPtr IoThreadService::register_thread(const std::string& name, int64_t period_ns) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::string unique = name;
+    for (int n = 2; std::any_of(_threads.begin(), _threads.end(),
+                                [&](const auto& t) { return t->name() == unique; }); ++n) {
+        unique = name + "#" + std::to_string(n);
+    }
+    auto monitor = std::make_shared<IoThreadMonitor>(unique, period_ns, _config.deadline_tolerance);
+    _threads.push_back(monitor);
+    return monitor;
+}
+
+void IoThreadService::unregister_thread(const IoThreadMonitorPtr& monitor) {
+    if (!monitor) return;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _drain(*monitor);
+    _threads.erase(std::remove(_threads.begin(), _threads.end(), monitor), _threads.end());
+}
+
+std::vector<IoThreadMonitorPtr> IoThreadService::threads() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _threads;
+}
+
+IoThreadMonitorPtr IoThreadService::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& thread : _threads) {
+        if (thread->name() == name) return thread;
+    }
+    return nullptr;
+}
+
+void IoThreadService::apply_scheduling(IoThreadMonitor& monitor) {
+    const IoThreadConfig config = this->config();
+    int64_t thread_id = 0;
+    std::string scheduling = "other";
+    int priority = 0;
+    std::string affinity;
+
+#if defined(__linux__)
+    thread_id = static_cast<int64_t>(syscall(SYS_gettid));
+    // Kernel thread names are limited to 15 characters
+    pthread_setname_np(pthread_self(), monitor.name().substr(0, 15).c_str());
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+    if (config.policy != IoSchedPolicy::Other) {
+        int policy = config.policy == IoSchedPolicy::Fifo ? SCHED_FIFO : SCHED_RR;
+        sched_param param{};
+        param.sched_priority = std::clamp(config.priority,
+                                          sched_get_priority_min(policy), sched_get_priority_max(policy));
+        int err = pthread_setschedparam(pthread_self(), policy, &param);
+        if (err == 0) {
+            scheduling = io_sched_policy_name(config.policy);
+            priority = param.sched_priority;
+        } else {
+            // Typically EPERM without CAP_SYS_NICE / an rtprio limit: keep running
+            scheduling = std::string("other (") + io_sched_policy_name(config.policy) +
+                         " refused: " + std::strerror(err) + ")";
+            monitor.defer_log(IoLogLevel::Warn, "real-time scheduling refused, running at default priority", err);
+        }
+    }
+#else
+    if (config.policy != IoSchedPolicy::Other) {
+        scheduling = "other (real-time scheduling not supported on this platform)";
+    }
+#endif
+
+#if defined(__linux__)
+    if (!config.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        std::string cpus;
+        for (int cpu : config.cpus) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) continue;
+            CPU_SET(cpu, &set);
+            cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+        }
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err == 0) {
+            affinity = cpus;
+        } else {
+            affinity = std::string("any (") + std::strerror(err) + ")";
+            monitor.defer_log(IoLogLevel::Warn, "CPU pinning refused", err);
+        }
+    }
+#else
+    if (!config.cpus.empty()) {
+        affinity = "any (pinning not supported on this platform)";
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(monitor._info_mutex);
+    monitor._thread_id = thread_id;
+    monitor._scheduling = std::move(scheduling);
+    monitor._priority = priority;
+    monitor._affinity = std::move(affinity);
+}
+
+void IoThreadService::scan(int64_t now_ns) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& thread : _threads) {
+        _drain(*thread);
+
+        const int64_t last = thread->_last_beat_ns.load(std::memory_order_relaxed);
+        const int64_t period = thread->period_ns();
+        if (last == 0 || period <= 0) continue;
+        const auto limit = static_cast<int64_t>(period * _config.deadline_tolerance * STALL_DEADLINES);
+        if (now_ns - last > limit && !thread->_stalled.exchange(true, std::memory_order_relaxed)) {
+            thread->_stalls.fetch_add(1, std::memory_order_relaxed);
+            ywarn("IoThreadService: '{}' stalled, no cycle for {:.1f} ms (period {:.2f} ms)",
+                  thread->name(), (now_ns - last) / 1e6, period / 1e6);
+        }
+    }
+}
+
+void IoThreadService::_drain(IoThreadMonitor& monitor) {
+    IoThreadMonitor::LogEntry entry;
+    while (monitor._log.try_pop(entry)) {
+        switch (entry.level) {
+            case IoLogLevel::Debug:
+                ydebug("{}: {} ({})", monitor.name(), entry.message, entry.value);
+                break;
+            case IoLogLevel::Info:
+                yinfo("{}: {} ({})", monitor.name(), entry.message, entry.value);
+                break;
+            case IoLogLevel::Warn:
+                ywarn("{}: {} ({})", monitor.name(), entry.message, entry.value);
+                break;
+        }
+    }
+}
+
+void IoThreadService::_watchdog() {
+    const auto interval = std::chrono::milliseconds(config().watchdog_ms);
+    while (_watchdog_running) {
+        std::this_thread::sleep_for(interval);
+        scan(audio_now_ns());
+    }
+    scan(audio_now_ns());
+}
+
+Dict IoThreadService::to_dict() const {
+    auto config = this->config();
+    List cpus;
+    for (int cpu : config.cpus) cpus.push_back(Value(static_cast<int64_t>(cpu)));
+    uint64_t missed = 0;
+    uint64_t stalled = 0;
+    auto threads = this->threads();
+    for (const auto& thread : threads) {
+        missed += thread->missed_deadlines();
+        stalled += thread->stalled() ? 1 : 0;
+    }
+    return Dict{
+        {"name", Value("threads")},
+        {"label", Value("I/O Threads")},
+        {"type", Value("folder")},
+        {"category", Value("folder")},
+        {"policy", Value(std::string(io_sched_policy_name(config.policy)))},
+        {"priority", Value(static_cast<int64_t>(config.priority))},
+        {"cpus", Value(cpus)},
+        {"memory-locked", Value(memory_locked())},
+        {"memory-lock-error", Value(_memory_lock_error)},
+        {"watchdog-ms", Value(static_cast<int64_t>(config.watchdog_ms))},
+        {"watchdog-running", Value(_watchdog_running.load())},
+        {"num-threads", Value(static_cast<int64_t>(threads.size()))},
+        {"missed-deadlines", Value(static_cast<int64_t>(missed))},
+        {"stalled-threads", Value(static_cast<int64_t>(stalled))}
+    };
+}
+
+// ============== IoThread ==============
+
+void IoThread::start(const std::string& name, int64_t period_ns, std::function<void()> body) {
+    join();
+    auto& service = IoThreadService::instance();
+    _monitor = service.register_thread(name, period_ns);
+    _thread = std::thread([monitor = _monitor, body = std::move(body)] {
+        IoThreadService::instance().apply_scheduling(*monitor);
+        body();
+    });
+}
+
+void IoThread::join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    if (_monitor) {
+        IoThreadService::instance().unregister_thread(_monitor);
+    }
+}
+
+} // namespace ymery
@@ -0,0 +1,201 @@
+// I/O thread service - real-time scheduling, deferred logging and a watchdog
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ymery {
+
+class IoThreadMonitor;
+using IoThreadMonitorPtr = std::shared_ptr<IoThreadMonitor>;
+
+enum class IoSchedPolicy {
+    Other,      // default time-sharing scheduler
+    Fifo,       // SCHED_FIFO
+    RoundRobin  // SCHED_RR
+};
+
+Result<IoSchedPolicy> io_sched_policy_from_string(const std::string& name);
+const char* io_sched_policy_name(IoSchedPolicy policy);
+
+/**
+ * IoThreadConfig - how audio I/O threads are scheduled (from app config)
+ */
+struct IoThreadConfig {
+    IoSchedPolicy policy = IoSchedPolicy::Other;
+    int priority = 70;                // SCHED_FIFO/RR priority, clamped to the system range
+    std::vector<int> cpus;            // pin I/O threads to these CPUs (empty: no pinning)
+    bool lock_memory = false;         // mlockall(MCL_CURRENT | MCL_FUTURE)
+    int watchdog_ms = 100;            // watchdog scan interval (0: no watchdog thread)
+    double deadline_tolerance = 1.5;  // periods between beats before a cycle counts as missed
+};
+
+enum class IoLogLevel {
+    Debug,
+    Info,
+    Warn
+};
+
+/**
+ * IoThreadMonitor - heartbeat, deadline accounting and deferred log of one
+ * I/O thread or driver callback
+ *
+ * Everything the I/O side calls is lock-free and allocation-free: beat()
+ * updates atomics, defer_log() fills a preallocated SPSC slot. The
+ * watchdog drains the log on its own thread and flags threads whose beats
+ * stopped.
+ */
+class IoThreadMonitor {
+public:
+    IoThreadMonitor(std::string name, int64_t period_ns, double deadline_tolerance = 1.5);
+
+    // Once per cycle from the I/O thread; a beat more than tolerance x
+    // period after the previous one counts as a missed deadline. The
+    // overload also updates the expected period (driver-chosen buffer sizes).
+    void beat();
+    void beat(int64_t period_ns);
+
+    // `message` must outlive the watchdog (string literal, strerror table);
+    // a full log drops the entry and counts it
+    void defer_log(IoLogLevel level, const char* message, int64_t value = 0);
+
+    const std::string& name() const { return _name; }
+    int64_t period_ns() const { return _period_ns.load(std::memory_order_relaxed); }
+    uint64_t cycles() const { return _cycles.load(std::memory_order_relaxed); }
+    uint64_t missed_deadlines() const { return _missed.load(std::memory_order_relaxed); }
+    uint64_t stalls() const { return _stalls.load(std::memory_order_relaxed); }
+    bool stalled() const { return _stalled.load(std::memory_order_relaxed); }
+    int64_t max_lateness_ns() const { return _max_lateness_ns.load(std::memory_order_relaxed); }
+    uint64_t dropped_logs() const { return _dropped_logs.load(std::memory_order_relaxed); }
+
+    Dict to_dict() const;
+
+private:
+    friend class IoThreadService;
+
+    struct LogEntry {
+        IoLogLevel level = IoLogLevel::Debug;
+        const char* message = nullptr;
+        int64_t value = 0;
+    };
+
+    std::string _name;
+    const double _tolerance;
+    std::atomic<int64_t> _period_ns;
+    std::atomic<int64_t> _last_beat_ns{0};
+    std::atomic<uint64_t> _cycles{0};
+    std::atomic<uint64_t> _missed{0};
+    std::atomic<int64_t> _max_lateness_ns{0};
+    std::atomic<uint64_t> _stalls{0};
+    std::atomic<bool> _stalled{false};
+    std::atomic<uint64_t> _dropped_logs{0};
+    SpscQueue<LogEntry> _log{64};
+
+    // Written once by the service when the thread starts
+    mutable std::mutex _info_mutex;
+    std::string _scheduling = "other";  // applied policy, or why not
+    int _priority = 0;
+    std::string _affinity;
+    int64_t _thread_id = 0;
+};
+
+/**
+ * IoThreadService - process-wide registry of audio I/O threads
+ *
+ * Threads started through IoThread get the configured scheduling policy,
+ * priority and CPU affinity; when the process lacks the privilege the
+ * thread keeps the default policy and the reason is reported. Driver
+ * callbacks (JACK, PipeWire) register a monitor only. A watchdog thread
+ * drains the deferred logs into ytrace and flags threads that stopped
+ * beating. All of it is visible under the kernel's /threads.
+ */
+class IoThreadService {
+public:
+    static IoThreadService& instance();
+
+    // Apply a configuration: locks memory if asked, (re)starts the watchdog.
+    // Threads already running keep their scheduling.
+    Result<void> configure(const IoThreadConfig& config);
+    IoThreadConfig config() const;
+    // Stop the watchdog, draining what is left
+    void shutdown();
+
+    // Names are made unique with a "#n" suffix
+    IoThreadMonitorPtr register_thread(const std::string& name, int64_t period_ns);
+    void unregister_thread(const IoThreadMonitorPtr& monitor);
+    std::vector<IoThreadMonitorPtr> threads() const;
+    IoThreadMonitorPtr find(const std::string& name) const;
+
+    // Give the calling thread the configured policy and affinity, recording
+    // the outcome in `monitor`
+    void apply_scheduling(IoThreadMonitor& monitor);
+
+    // One watchdog pass at `now_ns`: stall detection and log draining
+    void scan(int64_t now_ns);
+
+    bool memory_locked() const { return _memory_locked.load(); }
+    const std::string& memory_lock_error() const { return _memory_lock_error; }
+
+    Dict to_dict() const;
+
+private:
+    IoThreadService() = default;
+    ~IoThreadService();
+
+    void _drain(IoThreadMonitor& monitor);
+    void _watchdog();
+
+    mutable std::mutex _mutex;
+    IoThreadConfig _config;
+    std::vector<IoThreadMonitorPtr> _threads;
+
+    std::atomic<bool> _memory_locked{false};
+    std::string _memory_lock_error;
+
+    std::atomic<bool> _watchdog_running{false};
+    std::thread _watchdog_thread;
+};
+
+/**
+ * IoThread - std::thread replacement for audio I/O loops
+ * The body runs with the service's scheduling and a registered monitor;
+ * loops call beat() once per period and defer_log() instead of ywarn.
+ */
+class IoThread {
+public:
+    IoThread() = default;
+    IoThread(const IoThread&) = delete;
+    IoThread& operator=(const IoThread&) = delete;
+    ~IoThread() { join(); }
+
+    void start(const std::string& name, int64_t period_ns, std::function<void()> body);
+    void join();
+    bool joinable() const { return _thread.joinable(); }
+
+    void beat() { _monitor->beat(); }
+    void beat(int64_t period_ns) { _monitor->beat(period_ns); }
+    void defer_log(IoLogLevel level, const char* message, int64_t value = 0) {
+        _monitor->defer_log(level, message, value);
+    }
+    const IoThreadMonitorPtr& monitor() const { return _monitor; }
+
+private:
+    IoThreadMonitorPtr _monitor;
+    std::thread _thread;
+};
+
+// Period of `frames` at `sample_rate`, in nanoseconds
+inline int64_t io_period_ns(size_t frames, int sample_rate) {
+    return sample_rate > 0 ? static_cast<int64_t>(frames * 1000000000.0 / sample_rate) : 0;
+}
+
+} // namespace ymery
@@ -3,6 +3,8 @@
 #include "../result.hpp"
 #include "../plugin_manager.hpp"
 #include "../dispatcher.hpp"
+#include "async_tree.hpp"
+#include "io_thread.hpp"
 #include <map>
 #include <vector>
 #include <string>
@@ -20,7 +22,10 @@ public:
     Result<std::vector<std::string>> get_children_names(const DataPath& path);
     Result<Dict> get_metadata(const DataPath& path);
     Result<std::vector<std::string>> get_metadata_keys(const DataPath& path);
+    Result<ChildrenMetadata> get_children_metadata(const DataPath& path, const std::vector<std::string>& keys);
     Result<Value> get(const DataPath& path);
+    Result<void> set(const DataPath& path, const Value& value);
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data);
     Result<void> open(const DataPath& path, const Dict& params);
 
 private:
@@ -132,6 +137,81 @@ public:
     }
 };
 
+/**
+ * ThreadsManager - read-only view of the I/O thread service
+ *   /threads - policy, memory lock, watchdog and totals
+ *   /threads/<name> - scheduling, deadlines and stalls of one I/O thread
+ */
+class ThreadsManager : public TreeLike {
+public:
+    static Result<std::shared_ptr<ThreadsManager>> create() {
+        return std::make_shared<ThreadsManager>();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        if (!path.as_list().empty()) return Ok(std::vector<std::string>{});
+        std::vector<std::string> names;
+        for (const auto& thread : IoThreadService::instance().threads()) {
+            names.push_back(thread->name());
+        }
+        return Ok(names);
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+        if (parts.empty()) {
+            return Ok(IoThreadService::instance().to_dict());
+        }
+        if (parts.size() == 1) {
+            if (auto thread = IoThreadService::instance().find(parts[0])) {
+                return Ok(thread->to_dict());
+            }
+        }
+        return Ok(Dict{});
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    // One pass over the threads instead of a lookup by name per child
+    Result<ChildrenMetadata> get_children_metadata(const DataPath& path,
+                                                   const std::vector<std::string>& keys) override {
+        ChildrenMetadata result(keys);
+        if (!path.as_list().empty()) return Ok(std::move(result));
+        for (const auto& thread : IoThreadService::instance().threads()) {
+            result.append(thread->name(), thread->to_dict());
+        }
+        return Ok(std::move(result));
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        auto parent = path.dirname();
+        auto key = path.filename();
+        auto meta_res = get_metadata(parent);
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(key);
+        if (it != meta_res->end()) return Ok(it->second);
+        return Ok(Value{});
+    }
+
+    Result<void> set(const DataPath& path, const Value& value) override {
+        return Err<void>("ThreadsManager: threads are configured at startup");
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
+        return Err<void>("ThreadsManager: add_child not implemented");
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int depth) override {
+        return Ok(path.to_string());
+    }
+};
+
 class Kernel : public TreeLike {
 public:
     static Result<TreeLikePtr> create(std::shared_ptr<Dispatcher> dispatcher, std::shared_ptr<PluginManager> plugin_manager) {
@@ -156,6 +236,10 @@ public:
         if (!windows_res) return Err<void>("Kernel: failed to create RegisteredObjectsManager", windows_res);
         _windows_manager = *windows_res;
 
+        auto threads_res = ThreadsManager::create();
+        if (!threads_res) return Err<void>("Kernel: failed to create ThreadsManager", threads_res);
+        _threads_manager = *threads_res;
+
         ydebug("Kernel: initialized (dispatcher={}, plugin_manager={})",
             _dispatcher ? "yes" : "no", _plugin_manager ? "yes" : "no");
 
@@ -170,6 +254,7 @@ public:
 
     Result<void> dispose() override {
         for (auto& [name, provider] : _providers) {
+            std::scoped_lock lock(provider->access_mutex());
             provider->dispose();
         }
         _providers.clear();
@@ -182,7 +267,7 @@ public:
 
         if (path_str == "/" || path_str.empty()) {
             ydebug("Kernel::get_children_names: returning root children");
-            return Ok(std::vector<std::string>{"providers", "settings", "windows"});
+            return Ok(std::vector<std::string>{"providers", "settings", "windows", "threads"});
         }
 
         auto parts = path.as_list();
@@ -198,11 +283,27 @@ public:
             return _settings_manager->get_children_names(remaining);
         } else if (branch == "windows") {
             return _windows_manager->get_children_names(remaining);
+        } else if (branch == "threads") {
+            return _threads_manager->get_children_names(remaining);
         }
 
         return Ok(std::vector<std::string>{});
     }
 
+    // Provider paths are answered by the provider, under its own lock
+    Result<std::pair<TreeLikePtr, DataPath>> forwarding_target(const DataPath& path) override {
+        auto parts = path.as_list();
+        if (parts.size() < 2 || parts[0] != "providers") {
+            return TreeLike::forwarding_target(path);
+        }
+        auto provider_res = get_provider(parts[1]);
+        if (!provider_res) {
+            return Err<std::pair<TreeLikePtr, DataPath>>("Kernel::forwarding_target failed", provider_res);
+        }
+        DataPath remaining(std::vector<std::string>(parts.begin() + 2, parts.end()));
+        return Ok(std::make_pair(*provider_res, remaining));
+    }
+
     Result<Dict> get_metadata(const DataPath& path) override {
         std::string path_str = path.to_string();
 
@@ -233,6 +334,8 @@ public:
                 return _settings_manager->get_metadata(DataPath("/"));
             } else if (branch == "windows") {
                 return _windows_manager->get_metadata(DataPath("/"));
+            } else if (branch == "threads") {
+                return _threads_manager->get_metadata(DataPath("/"));
             }
         }
 
@@ -242,6 +345,8 @@ public:
             return _settings_manager->get_metadata(remaining);
         } else if (branch == "windows") {
             return _windows_manager->get_metadata(remaining);
+        } else if (branch == "threads") {
+            return _threads_manager->get_metadata(remaining);
         }
 
         return Ok(Dict{});
@@ -255,6 +360,29 @@ public:
         return Ok(keys);
     }
 
+    // Below the root the whole batch goes to the branch, so a provider's own
+    // get_children_metadata answers it rather than a proxied call per child
+    Result<ChildrenMetadata> get_children_metadata(const DataPath& path,
+                                                   const std::vector<std::string>& keys) override {
+        const auto& parts = path.as_list();
+        if (parts.empty()) return TreeLike::get_children_metadata(path, keys);
+
+        const std::string& branch = parts[0];
+        DataPath remaining(std::vector<std::string>(parts.begin() + 1, parts.end()));
+
+        if (branch == "providers") {
+            return _providers_proxy->get_children_metadata(remaining, keys);
+        } else if (branch == "settings") {
+            return _settings_manager->get_children_metadata(remaining, keys);
+        } else if (branch == "windows") {
+            return _windows_manager->get_children_metadata(remaining, keys);
+        } else if (branch == "threads") {
+            return _threads_manager->get_children_metadata(remaining, keys);
+        }
+
+        return Ok(ChildrenMetadata(keys));
+    }
+
     Result<Value> get(const DataPath& path) override {
         std::string path_str = path.to_string();
 
@@ -277,6 +405,8 @@ public:
             return _settings_manager->get(remaining);
         } else if (branch == "windows") {
             return _windows_manager->get(remaining);
+        } else if (branch == "threads") {
+            return _threads_manager->get(remaining);
         }
 
         return Ok(Value{});
@@ -288,11 +418,20 @@ public:
             _root_metadata[parts[0]] = value;
             return Ok();
         }
-        return Err<void>("Kernel: set: only root-level metadata supported");
+        if (!parts.empty() && parts[0] == "providers") {
+            DataPath remaining(std::vector<std::string>(parts.begin() + 1, parts.end()));
+            return _providers_proxy->set(remaining, value);
+        }
+        return Err<void>("Kernel: set: only root-level metadata and providers supported");
     }
 
     Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
-        return Err<void>("Kernel: add_child not implemented");
+        auto parts = path.as_list();
+        if (!parts.empty() && parts[0] == "providers") {
+            DataPath remaining(std::vector<std::string>(parts.begin() + 1, parts.end()));
+            return _providers_proxy->add_child(remaining, name, data);
+        }
+        return Err<void>("Kernel: add_child only supported under /providers");
     }
 
     Result<std::string> as_tree(const DataPath& path, int depth) override {
@@ -360,9 +499,19 @@ public:
             return Err<TreeLikePtr>("Kernel: failed to create provider '" + provider_name + "'", tree_res);
         }
 
-        _providers[provider_name] = *tree_res;
-        ydebug("Kernel: loaded provider '{}'", provider_name);
-        return Ok(*tree_res);
+        TreeLikePtr provider = *tree_res;
+        // Slow providers answer from a cache and refresh in the background
+        if (AsyncTreeService::instance().is_async(provider_name)) {
+            auto async_res = AsyncTree::create(provider, provider_name);
+            if (!async_res) {
+                return Err<TreeLikePtr>("Kernel: failed to wrap provider '" + provider_name + "'", async_res);
+            }
+            provider = *async_res;
+        }
+
+        _providers[provider_name] = provider;
+        ydebug("Kernel: loaded provider '{}'{}", provider_name, provider == *tree_res ? "" : " (async)");
+        return Ok(provider);
     }
 
     std::vector<std::string> get_available_providers() {
@@ -380,6 +529,7 @@ private:
     std::unique_ptr<ProvidersProxy> _providers_proxy;
     std::shared_ptr<SettingsManager> _settings_manager;
     std::shared_ptr<RegisteredObjectsManager> _windows_manager;
+    std::shared_ptr<ThreadsManager> _threads_manager;
 
     std::map<std::string, TreeLikePtr> _providers;
     std::map<std::string, Value> _root_metadata;
@@ -417,6 +567,7 @@ Result<std::vector<std::string>> ProvidersProxy::get_children_names(const DataPa
     if (!res) {
         return Err<std::vector<std::string>>("ProvidersProxy: get_children_names failed", res);
     }
+    std::scoped_lock lock(res->provider->access_mutex());
     return res->provider->get_children_names(res->remaining);
 }
 
@@ -436,6 +587,7 @@ Result<Dict> ProvidersProxy::get_metadata(const DataPath& path) {
     if (!res) {
         return Err<Dict>("ProvidersProxy: get_metadata failed", res);
     }
+    std::scoped_lock lock(res->provider->access_mutex());
     return res->provider->get_metadata(res->remaining);
 }
 
@@ -447,20 +599,102 @@ Result<std::vector<std::string>> ProvidersProxy::get_metadata_keys(const DataPat
     return Ok(keys);
 }
 
+Result<ChildrenMetadata> ProvidersProxy::get_children_metadata(const DataPath& path,
+                                                               const std::vector<std::string>& keys) {
+    if (path.as_list().empty()) {
+        ChildrenMetadata result(keys);
+        for (auto& name : _kernel->get_available_providers()) {
+            auto meta = get_metadata(DataPath(std::vector<std::string>{name}));
+            result.append(std::move(name), meta ? *meta : Dict{});
+        }
+        return Ok(std::move(result));
+    }
+
+    auto res = _get_provider_and_path(path);
+    if (!res) {
+        return Err<ChildrenMetadata>("ProvidersProxy: get_children_metadata failed", res);
+    }
+    std::scoped_lock lock(res->provider->access_mutex());
+    return res->provider->get_children_metadata(res->remaining, keys);
+}
+
 Result<Value> ProvidersProxy::get(const DataPath& path) {
     auto res = _get_provider_and_path(path);
     if (!res) {
         return Err<Value>("ProvidersProxy: get failed", res);
     }
+    std::scoped_lock lock(res->provider->access_mutex());
     return res->provider->get(res->remaining);
 }
 
+Result<void> ProvidersProxy::set(const DataPath& path, const Value& value) {
+    auto res = _get_provider_and_path(path);
+    if (!res) {
+        return Err<void>("ProvidersProxy: set failed", res);
+    }
+    std::scoped_lock lock(res->provider->access_mutex());
+    return res->provider->set(res->remaining, value);
+}
+
+Result<void> ProvidersProxy::add_child(const DataPath& path, const std::string& name, const Dict& data) {
+    auto res = _get_provider_and_path(path);
+    if (!res) {
+        return Err<void>("ProvidersProxy: add_child failed", res);
+    }
+
+    // Resolve "source"/"sources" kernel paths into channel buffers so a provider
+    // (e.g. recorder) can consume channels opened by another provider; loaded
+    // audio-file channels resolve to their mediator
+    Dict resolved = data;
+    auto resolve_buffer = [this](const Value& source) -> Result<Value> {
+        auto source_path = get_as<std::string>(source);
+        if (!source_path) {
+            return Err<Value>("ProvidersProxy: source must be a path string");
+        }
+        auto buffer_res = _kernel->get(DataPath(*source_path) / "buffer");
+        if (!buffer_res) {
+            return Err<Value>("ProvidersProxy: cannot resolve source '" + *source_path + "'", buffer_res);
+        }
+        if (!buffer_res->has_value()) {
+            buffer_res = _kernel->get(DataPath(*source_path) / "mediator");
+            if (!buffer_res) {
+                return Err<Value>("ProvidersProxy: cannot resolve source '" + *source_path + "'", buffer_res);
+            }
+        }
+        if (!buffer_res->has_value()) {
+            return Err<Value>("ProvidersProxy: source '" + *source_path + "' has no buffer");
+        }
+        return buffer_res;
+    };
+
+    if (auto it = data.find("source"); it != data.end()) {
+        auto buffer_res = resolve_buffer(it->second);
+        if (!buffer_res) return Err<void>("ProvidersProxy: add_child failed", buffer_res);
+        resolved["buffer"] = *buffer_res;
+    }
+    if (auto it = data.find("sources"); it != data.end()) {
+        List buffers;
+        if (auto sources = get_as<List>(it->second)) {
+            for (const auto& source : *sources) {
+                auto buffer_res = resolve_buffer(source);
+                if (!buffer_res) return Err<void>("ProvidersProxy: add_child failed", buffer_res);
+                buffers.push_back(*buffer_res);
+            }
+        }
+        resolved["buffers"] = Value(buffers);
+    }
+
+    std::scoped_lock lock(res->provider->access_mutex());
+    return res->provider->add_child(res->remaining, name, resolved);
+}
+
 Result<void> ProvidersProxy::open(const DataPath& path, const Dict& params) {
     auto res = _get_provider_and_path(path);
     if (!res) {
         return Err<void>("ProvidersProxy: open failed - could not get provider", res);
     }
 
+    std::scoped_lock lock(res->provider->access_mutex());
     auto meta_res = res->provider->get_metadata(res->remaining);
     if (!meta_res) {
         return Err<void>("ProvidersProxy: open failed - could not get metadata", meta_res);
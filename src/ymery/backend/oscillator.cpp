@@ -0,0 +1,136 @@
+// Oscillator implementation
+#include "oscillator.hpp"
+#include <array>
+#include <cmath>
+
+namespace ymery {
+
+namespace {
+
+constexpr size_t SINE_TABLE_SIZE = 4096;
+
+// One cycle of sine plus a guard point so interpolation never wraps
+const std::array<float, SINE_TABLE_SIZE + 1>& sine_table() {
+    static const auto table = [] {
+        std::array<float, SINE_TABLE_SIZE + 1> t{};
+        for (size_t i = 0; i <= SINE_TABLE_SIZE; ++i) {
+            t[i] = static_cast<float>(std::sin(2.0 * 3.14159265358979323846 * i / SINE_TABLE_SIZE));
+        }
+        return t;
+    }();
+    return table;
+}
+
+inline double wrap(double p) {
+    return p - std::floor(p);
+}
+
+// Polynomial band-limited step residual around a discontinuity at t = 0
+inline double poly_blep(double t, double dt) {
+    if (t < dt) {
+        t /= dt;
+        return t + t - t * t - 1.0;
+    }
+    if (t > 1.0 - dt) {
+        t = (t - 1.0) / dt;
+        return t * t + t + t + 1.0;
+    }
+    return 0.0;
+}
+
+// Polynomial band-limited ramp residual around a slope change at t = 0
+inline double poly_blamp(double t, double dt) {
+    if (t < dt) {
+        t = t / dt - 1.0;
+        return -t * t * t / 3.0;
+    }
+    if (t > 1.0 - dt) {
+        t = (t - 1.0) / dt + 1.0;
+        return t * t * t / 3.0;
+    }
+    return 0.0;
+}
+
+} // namespace
+
+Result<WaveformKind> waveform_kind_from_string(const std::string& name) {
+    if (name == "sine") return WaveformKind::Sine;
+    if (name == "square") return WaveformKind::Square;
+    if (name == "triangle") return WaveformKind::Triangle;
+    return Err<WaveformKind>("Unknown waveform type: " + name);
+}
+
+const char* waveform_kind_name(WaveformKind kind) {
+    switch (kind) {
+        case WaveformKind::Sine: return "sine";
+        case WaveformKind::Square: return "square";
+        case WaveformKind::Triangle: return "triangle";
+    }
+    return "unknown";
+}
+
+Oscillator::Oscillator(WaveformKind kind, double frequency, int sample_rate)
+    : _kind(kind)
+    , _frequency(frequency)
+    , _sample_rate(sample_rate)
+    , _increment(frequency / sample_rate)
+{
+    sine_table();
+}
+
+void Oscillator::set_frequency(double frequency) {
+    _frequency = frequency;
+    _increment = frequency / _sample_rate;
+}
+
+void Oscillator::reset(double phase) {
+    _phase = wrap(phase);
+}
+
+void Oscillator::render(float* out, size_t frames) {
+    switch (_kind) {
+        case WaveformKind::Sine: _render_sine(out, frames); break;
+        case WaveformKind::Square: _render_square(out, frames); break;
+        case WaveformKind::Triangle: _render_triangle(out, frames); break;
+    }
+    _phase = wrap(_phase + static_cast<double>(frames) * _increment);
+}
+
+void Oscillator::_render_sine(float* out, size_t frames) const {
+    const float* table = sine_table().data();
+    const double phase = _phase;
+    const double inc = _increment;
+    for (size_t i = 0; i < frames; ++i) {
+        double x = wrap(phase + static_cast<double>(i) * inc) * SINE_TABLE_SIZE;
+        auto idx = static_cast<size_t>(x);
+        auto frac = static_cast<float>(x - static_cast<double>(idx));
+        out[i] = table[idx] + frac * (table[idx + 1] - table[idx]);
+    }
+}
+
+void Oscillator::_render_square(float* out, size_t frames) const {
+    const double phase = _phase;
+    const double dt = _increment;
+    for (size_t i = 0; i < frames; ++i) {
+        double t = wrap(phase + static_cast<double>(i) * dt);
+        double v = t < 0.5 ? 1.0 : -1.0;
+        v += poly_blep(t, dt);
+        v -= poly_blep(wrap(t + 0.5), dt);
+        out[i] = static_cast<float>(v);
+    }
+}
+
+void Oscillator::_render_triangle(float* out, size_t frames) const {
+    const double phase = _phase;
+    const double dt = _increment;
+    for (size_t i = 0; i < frames; ++i) {
+        double t = wrap(phase + static_cast<double>(i) * dt);
+        // Peak at t = 0, trough at t = 0.5; slope changes by 8 per cycle at each corner
+        double v = 2.0 * std::abs(2.0 * t - 1.0) - 1.0;
+        v -= 8.0 * dt * poly_blamp(t, dt);
+        v += 8.0 * dt * poly_blamp(wrap(t + 0.5), dt);
+        out[i] = static_cast<float>(v);
+    }
+}
+
+} // namespace ymery
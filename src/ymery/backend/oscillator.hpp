@@ -0,0 +1,56 @@
+// Oscillator - block-based band-limited waveform synthesis
+#pragma once
+
+#include "../result.hpp"
+#include <cstddef>
+#include <string>
+
+namespace ymery {
+
+enum class WaveformKind {
+    Sine,
+    Square,
+    Triangle
+};
+
+Result<WaveformKind> waveform_kind_from_string(const std::string& name);
+const char* waveform_kind_name(WaveformKind kind);
+
+/**
+ * Oscillator - renders a waveform a block at a time
+ *
+ * Phase is a double-precision cycle fraction in [0, 1), so long runs do not
+ * drift. Sine is read from a shared interpolated wavetable; square and
+ * triangle are band-limited with polyBLEP / polyBLAMP corrections. The
+ * waveform kind is resolved once per block, keeping the inner loops
+ * branch-free and vectorizable.
+ */
+class Oscillator {
+public:
+    explicit Oscillator(WaveformKind kind = WaveformKind::Sine,
+                        double frequency = 440.0,
+                        int sample_rate = 48000);
+
+    void render(float* out, size_t frames);
+
+    void set_frequency(double frequency);
+    void reset(double phase = 0.0);
+
+    WaveformKind kind() const { return _kind; }
+    double frequency() const { return _frequency; }
+    int sample_rate() const { return _sample_rate; }
+    double phase() const { return _phase; }
+
+private:
+    void _render_sine(float* out, size_t frames) const;
+    void _render_square(float* out, size_t frames) const;
+    void _render_triangle(float* out, size_t frames) const;
+
+    WaveformKind _kind;
+    double _frequency;
+    int _sample_rate;
+    double _increment;    // cycles per sample
+    double _phase = 0.0;  // cycles, in [0, 1)
+};
+
+} // namespace ymery
@@ -0,0 +1,575 @@
+// playback - audio output: mixes voices through the audio engine into a sink
+#include "../types.hpp"
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "audio_engine.hpp"
+#include "audio_resampler.hpp"
+#include "oscillator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+/**
+ * PlaybackManager - audio output, implements TreeLike
+ * Tree structure:
+ *   /engine          - engine settings, state and stats
+ *   /engine/running  - set true/false to start/stop the output
+ *   /engine/sink     - sink kind ("null", "file", or a device plugin's)
+ *   /sinks           - registered sink kinds
+ *   /voices/<name>   - a voice: gain, pan, frequency, playing
+ *   /keyboard        - note/velocity pairs (as set by the piano widget)
+ *                      play oscillator voices
+ *
+ * Voices are added with add_child("/voices", name, {...}) where the data
+ * carries either "buffer" (a capture channel, resolved by the kernel from
+ * "source", or a loaded file buffer), "mediator" (an audio-file channel),
+ * or oscillator settings ("waveform", "frequency"); plus optional "gain",
+ * "pan", "loop" and "playing". The engine starts on the first voice unless
+ * /engine/auto-start is false.
+ */
+class PlaybackManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<PlaybackManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("PlaybackManager::create failed", res);
+        }
+        return manager;
+    }
+
+    Result<void> init() override {
+        auto engine_res = AudioEngine::create(_config);
+        if (!engine_res) {
+            return Err<void>("PlaybackManager: failed to create engine", engine_res);
+        }
+        _engine = *engine_res;
+        _sink_kind = _default_sink_kind();
+        return Ok();
+    }
+
+    Result<void> dispose() override {
+        if (_engine) {
+            _engine->stop();
+        }
+        return Ok();
+    }
+
+    ~PlaybackManager() {
+        dispose();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(std::vector<std::string>{"engine", "sinks", "voices", "keyboard"});
+        }
+        if (parts.size() == 1 && parts[0] == "sinks") {
+            return Ok(audio_sink_kinds());
+        }
+        if (parts.size() == 1 && parts[0] == "voices") {
+            std::vector<std::string> names;
+            for (const auto& [name, _] : _voices) {
+                names.push_back(name);
+            }
+            return Ok(names);
+        }
+        return Ok(std::vector<std::string>{});
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(Dict{
+                {"name", Value(std::string("playback"))},
+                {"label", Value(std::string("Playback"))},
+                {"type", Value(std::string("playback-manager"))},
+                {"category", Value(std::string("audio-device-manager"))}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "engine") {
+            return Ok(_engine_metadata());
+        }
+
+        if (parts.size() == 1 && (parts[0] == "sinks" || parts[0] == "voices")) {
+            return Ok(Dict{
+                {"name", Value(parts[0])},
+                {"label", Value(std::string(parts[0] == "sinks" ? "Sinks" : "Voices"))},
+                {"type", Value(std::string("folder"))},
+                {"category", Value(std::string("folder"))}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "keyboard") {
+            List held;
+            for (const auto& [note, _] : _notes) {
+                held.push_back(Value(static_cast<int64_t>(note)));
+            }
+            return Ok(Dict{
+                {"name", Value(std::string("keyboard"))},
+                {"label", Value(std::string("Keyboard"))},
+                {"type", Value(std::string("playback-keyboard"))},
+                {"category", Value(std::string("audio-output"))},
+                {"waveform", Value(std::string(waveform_kind_name(_keyboard_kind)))},
+                {"gain", Value(static_cast<double>(_keyboard_gain))},
+                {"note", Value(static_cast<double>(_keyboard_note))},
+                {"notes", Value(held)}
+            });
+        }
+
+        if (parts.size() == 2 && parts[0] == "sinks") {
+            auto kinds = audio_sink_kinds();
+            if (std::find(kinds.begin(), kinds.end(), parts[1]) == kinds.end()) return Ok(Dict{});
+            return Ok(Dict{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1])},
+                {"type", Value(std::string("audio-sink"))},
+                {"category", Value(std::string("audio-sink"))},
+                {"selected", Value(parts[1] == _sink_kind)}
+            });
+        }
+
+        if (parts.size() == 2 && parts[0] == "voices") {
+            auto it = _voices.find(parts[1]);
+            if (it == _voices.end()) return Ok(Dict{});
+            return Ok(_voice_metadata(parts[1], it->second));
+        }
+
+        return Ok(Dict{});
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        auto parent = path.dirname();
+        auto key = path.filename();
+        auto meta_res = get_metadata(parent);
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(key);
+        if (it != meta_res->end()) return Ok(it->second);
+        return Ok(Value{});
+    }
+
+    Result<void> set(const DataPath& path, const Value& value) override {
+        const auto& parts = path.as_list();
+        if (parts.size() == 2 && parts[0] == "engine") {
+            return _set_engine(parts[1], value);
+        }
+        if (parts.size() == 2 && parts[0] == "keyboard") {
+            return _set_keyboard(parts[1], value);
+        }
+        if (parts.size() == 3 && parts[0] == "voices") {
+            return _set_voice(parts[1], parts[2], value);
+        }
+        return Err<void>("PlaybackManager: cannot set '" + path.to_string() + "'");
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "voices") {
+            return Err<void>("PlaybackManager: add_child only supported on /voices");
+        }
+        if (name.empty()) {
+            return Err<void>("PlaybackManager: voice name required");
+        }
+        if (_voices.count(name)) {
+            return Err<void>("PlaybackManager: voice '" + name + "' already exists");
+        }
+
+        VoiceEntry entry;
+        entry.spec = data;
+        entry.gain = static_cast<float>(_number(data, "gain").value_or(1.0));
+        entry.pan = static_cast<float>(_number(data, "pan").value_or(0.0));
+        if (auto res = _make_source(entry); !res) {
+            return Err<void>("PlaybackManager: cannot create voice '" + name + "'", res);
+        }
+        auto& voice = _voices[name] = std::move(entry);
+
+        bool playing = true;
+        if (auto it = data.find("playing"); it != data.end()) {
+            if (auto b = get_as<bool>(it->second)) playing = *b;
+        }
+        if (!playing) return Ok();
+        return _start_voice(voice);
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int depth) override {
+        return Ok(path.to_string());
+    }
+
+private:
+    struct VoiceEntry {
+        Dict spec;
+        std::string type;
+        AudioSourcePtr source;
+        ResampledStreamPtr resampled;          // stream not at the engine rate
+        StaticAudioBufferPtr converted;        // file buffer converted to the engine rate
+        VoiceId id = 0;
+        float gain = 1.0f;
+        float pan = 0.0f;
+    };
+
+    // ---------- engine ----------
+
+    Dict _engine_metadata() {
+        Dict stats = _engine->stats().to_dict();
+        int64_t frames_played = 0;
+        if (const auto& sink = _engine->sink()) {
+            stats["sink"] = Value(sink->stats().to_dict());
+            frames_played = static_cast<int64_t>(sink->frames_played());
+        }
+        const auto& config = _engine->config();
+        return Dict{
+            {"name", Value(std::string("engine"))},
+            {"label", Value("Engine (" + _sink_kind + ")")},
+            {"type", Value(std::string("playback-engine"))},
+            {"category", Value(std::string("audio-output"))},
+            {"running", Value(_engine->is_running())},
+            {"auto-start", Value(_auto_start)},
+            {"sink", Value(_sink_kind)},
+            {"sink-options", Value(_sink_options)},
+            {"sample-rate", Value(static_cast<int64_t>(config.sample_rate))},
+            {"channels", Value(static_cast<int64_t>(config.channels))},
+            {"block-frames", Value(static_cast<int64_t>(config.block_frames))},
+            {"max-voices", Value(static_cast<int64_t>(config.max_voices))},
+            {"master-gain", Value(static_cast<double>(_engine->master_gain()))},
+            {"frames-played", Value(frames_played)},
+            {"stats", Value(stats)}
+        };
+    }
+
+    Result<void> _set_engine(const std::string& key, const Value& value) {
+        if (key == "running") {
+            auto run = get_as<bool>(value);
+            if (!run) return Err<void>("PlaybackManager: 'running' must be a bool");
+            return *run ? _start_engine() : _engine->stop();
+        }
+        if (key == "auto-start") {
+            auto b = get_as<bool>(value);
+            if (!b) return Err<void>("PlaybackManager: 'auto-start' must be a bool");
+            _auto_start = *b;
+            return Ok();
+        }
+        if (key == "master-gain") {
+            auto gain = _as_number(value);
+            if (!gain) return Err<void>("PlaybackManager: 'master-gain' must be a number");
+            _engine->set_master_gain(static_cast<float>(*gain));
+            return Ok();
+        }
+        if (key == "sink" || key == "sink-options") {
+            if (_engine->is_running()) {
+                return Err<void>("PlaybackManager: stop the engine before changing '" + key + "'");
+            }
+            if (key == "sink") {
+                auto kind = get_as<std::string>(value);
+                if (!kind) return Err<void>("PlaybackManager: 'sink' must be a string");
+                _sink_kind = *kind;
+            } else {
+                auto options = get_as<Dict>(value);
+                if (!options) return Err<void>("PlaybackManager: 'sink-options' must be a dict");
+                _sink_options = *options;
+            }
+            return Ok();
+        }
+        if (key == "sample-rate" || key == "channels" || key == "block-frames" || key == "max-voices") {
+            return _reconfigure(key, value);
+        }
+        return Err<void>("PlaybackManager: unknown engine setting '" + key + "'");
+    }
+
+    Result<void> _start_engine() {
+        if (_engine->is_running()) return Ok();
+        Dict options = _sink_options;
+        if (_sink_kind == "null" && options.find("speed") == options.end()) {
+            options["speed"] = Value(1.0);  // real time unless asked otherwise
+        }
+        auto sink_res = create_audio_sink(_sink_kind, options);
+        if (!sink_res) {
+            return Err<void>("PlaybackManager: cannot create sink", sink_res);
+        }
+        return _engine->start(*sink_res);
+    }
+
+    // Engine geometry changes need a new engine; voices are restarted on it
+    Result<void> _reconfigure(const std::string& key, const Value& value) {
+        if (_engine->is_running()) {
+            return Err<void>("PlaybackManager: stop the engine before changing '" + key + "'");
+        }
+        auto number = _as_number(value);
+        if (!number || *number <= 0) {
+            return Err<void>("PlaybackManager: '" + key + "' must be a positive number");
+        }
+        AudioEngineConfig config = _config;
+        if (key == "sample-rate") config.sample_rate = static_cast<int>(*number);
+        if (key == "channels") config.channels = static_cast<size_t>(*number);
+        if (key == "block-frames") config.block_frames = static_cast<size_t>(*number);
+        if (key == "max-voices") config.max_voices = static_cast<size_t>(*number);
+
+        auto engine_res = AudioEngine::create(config);
+        if (!engine_res) {
+            return Err<void>("PlaybackManager: invalid engine settings", engine_res);
+        }
+        float master = _engine->master_gain();
+        _engine = *engine_res;
+        _engine->set_master_gain(master);
+        _config = config;
+        _notes.clear();
+        for (auto& [_, voice] : _voices) {
+            voice.id = 0;
+            _make_source(voice);
+        }
+        return Ok();
+    }
+
+    // First device sink a loaded plugin registered, else the silent null sink
+    static std::string _default_sink_kind() {
+        auto kinds = audio_sink_kinds();
+        for (const char* preferred : {"pipewire", "jack", "alsa"}) {
+            if (std::find(kinds.begin(), kinds.end(), preferred) != kinds.end()) return preferred;
+        }
+        return "null";
+    }
+
+    Result<void> _auto_start_engine() {
+        if (!_auto_start || _engine->is_running()) return Ok();
+        if (_sink_kind == "null") _sink_kind = _default_sink_kind();
+        return _start_engine();
+    }
+
+    // ---------- voices ----------
+
+    Dict _voice_metadata(const std::string& name, VoiceEntry& voice) {
+        Dict meta{
+            {"name", Value(name)},
+            {"label", Value(name + " (" + voice.type + ")")},
+            {"type", Value(std::string("playback-voice"))},
+            {"category", Value(std::string("audio-voice"))},
+            {"source-type", Value(voice.type)},
+            {"playing", Value(voice.id != 0 && _engine->is_playing(voice.id))},
+            {"gain", Value(static_cast<double>(voice.gain))},
+            {"pan", Value(static_cast<double>(voice.pan))}
+        };
+        if (auto osc = std::dynamic_pointer_cast<OscillatorSource>(voice.source)) {
+            meta["waveform"] = Value(std::string(waveform_kind_name(osc->kind())));
+            meta["frequency"] = Value(osc->frequency());
+        }
+        if (auto stream = std::dynamic_pointer_cast<StreamSource>(voice.source)) {
+            meta["underruns"] = Value(static_cast<int64_t>(stream->underruns()));
+        }
+        return meta;
+    }
+
+    Result<void> _make_source(VoiceEntry& voice) {
+        const Dict& spec = voice.spec;
+        const int rate = _engine->config().sample_rate;
+
+        StaticAudioBufferPtr static_buffer;
+        MediatedAudioBufferPtr stream;
+        for (const char* key : {"buffer", "mediator"}) {
+            auto it = spec.find(key);
+            if (it == spec.end()) continue;
+            if (auto b = get_as<MediatedAudioBufferPtr>(it->second)) stream = *b;
+            if (auto b = get_as<StaticAudioBufferPtr>(it->second)) static_buffer = *b;
+            if (auto b = get_as<FileAudioBufferPtr>(it->second)) static_buffer = *b;
+            if (auto m = get_as<StaticAudioBufferMediatorPtr>(it->second); m && *m) static_buffer = (*m)->backend();
+        }
+
+        if (stream) {
+            const auto& ring = stream->ring();
+            if (!ring) return Err<void>("PlaybackManager: stream buffer has no ring");
+            AudioRingBufferPtr play_ring = ring;
+            size_t channel = stream->channel();
+            voice.resampled.reset();
+            if (ring->sample_rate() != rate) {
+                auto resampled = ResampledStream::create({stream}, rate);
+                if (!resampled) return Err<void>("PlaybackManager: cannot resample stream", resampled);
+                voice.resampled = *resampled;
+                play_ring = voice.resampled->ring();
+                channel = 0;
+            }
+            size_t latency = play_ring->period_size() * 2 + _engine->config().block_frames;
+            voice.type = "stream";
+            voice.source = std::make_shared<StreamSource>(play_ring, channel, latency);
+            return Ok();
+        }
+
+        if (static_buffer) {
+            bool loop = false;
+            if (auto it = spec.find("loop"); it != spec.end()) {
+                if (auto b = get_as<bool>(it->second)) loop = *b;
+            }
+            if (static_buffer->sample_rate() != rate) {
+                if (!voice.converted || voice.converted->sample_rate() != rate) {
+                    auto converted = resample_buffer(*static_buffer, rate);
+                    if (!converted) return Err<void>("PlaybackManager: cannot resample buffer", converted);
+                    voice.converted = *converted;
+                }
+                static_buffer = voice.converted;
+            }
+            voice.type = "buffer";
+            voice.source = std::make_shared<BufferSource>(static_buffer, loop);
+            return Ok();
+        }
+
+        if (spec.count("buffer") || spec.count("mediator")) {
+            return Err<void>("PlaybackManager: unsupported buffer type");
+        }
+
+        WaveformKind kind = WaveformKind::Sine;
+        if (auto it = spec.find("waveform"); it != spec.end()) {
+            auto name = get_as<std::string>(it->second);
+            if (!name) return Err<void>("PlaybackManager: 'waveform' must be a string");
+            auto kind_res = waveform_kind_from_string(*name);
+            if (!kind_res) return Err<void>("PlaybackManager: invalid waveform", kind_res);
+            kind = *kind_res;
+        }
+        double frequency = _number(spec, "frequency").value_or(440.0);
+        voice.type = "oscillator";
+        voice.source = std::make_shared<OscillatorSource>(kind, frequency, rate);
+        return Ok();
+    }
+
+    Result<void> _start_voice(VoiceEntry& voice) {
+        auto id_res = _engine->play(voice.source, voice.gain, voice.pan);
+        if (!id_res) {
+            return Err<void>("PlaybackManager: cannot start voice", id_res);
+        }
+        voice.id = *id_res;
+        return _auto_start_engine();
+    }
+
+    Result<void> _set_voice(const std::string& name, const std::string& key, const Value& value) {
+        auto it = _voices.find(name);
+        if (it == _voices.end()) {
+            return Err<void>("PlaybackManager: no voice named '" + name + "'");
+        }
+        auto& voice = it->second;
+
+        if (key == "playing") {
+            auto play = get_as<bool>(value);
+            if (!play) return Err<void>("PlaybackManager: 'playing' must be a bool");
+            bool playing = voice.id != 0 && _engine->is_playing(voice.id);
+            if (*play == playing) return Ok();
+            if (!*play) return _engine->release(voice.id);
+            // Sources keep their position; restart from a fresh one
+            if (auto res = _make_source(voice); !res) return res;
+            return _start_voice(voice);
+        }
+
+        auto number = _as_number(value);
+        if (!number) return Err<void>("PlaybackManager: '" + key + "' must be a number");
+        const bool playing = voice.id != 0 && _engine->is_playing(voice.id);
+
+        if (key == "gain") {
+            voice.gain = static_cast<float>(*number);
+            return playing ? _engine->set_gain(voice.id, voice.gain) : Ok();
+        }
+        if (key == "pan") {
+            voice.pan = static_cast<float>(*number);
+            return playing ? _engine->set_pan(voice.id, voice.pan) : Ok();
+        }
+        if (key == "frequency") {
+            auto osc = std::dynamic_pointer_cast<OscillatorSource>(voice.source);
+            if (!osc) return Err<void>("PlaybackManager: voice '" + name + "' has no frequency");
+            osc->set_frequency(*number);
+            voice.spec["frequency"] = Value(*number);
+            return Ok();
+        }
+        return Err<void>("PlaybackManager: unknown voice setting '" + key + "'");
+    }
+
+    // ---------- keyboard ----------
+
+    Result<void> _set_keyboard(const std::string& key, const Value& value) {
+        if (key == "waveform") {
+            auto name = get_as<std::string>(value);
+            if (!name) return Err<void>("PlaybackManager: 'waveform' must be a string");
+            auto kind_res = waveform_kind_from_string(*name);
+            if (!kind_res) return Err<void>("PlaybackManager: invalid waveform", kind_res);
+            _keyboard_kind = *kind_res;
+            return Ok();
+        }
+
+        auto number = _as_number(value);
+        if (!number) return Err<void>("PlaybackManager: keyboard '" + key + "' must be a number");
+
+        if (key == "gain") {
+            _keyboard_gain = static_cast<float>(*number);
+            return Ok();
+        }
+        if (key == "note") {
+            _keyboard_note = static_cast<int>(std::lround(*number));
+            return Ok();
+        }
+        if (key != "velocity") {
+            return Err<void>("PlaybackManager: unknown keyboard setting '" + key + "'");
+        }
+
+        // Velocity completes a note event: > 0 is note on, 0 note off
+        const int note = _keyboard_note;
+        if (auto it = _notes.find(note); it != _notes.end()) {
+            _engine->release(it->second);
+            _notes.erase(it);
+        }
+        if (*number <= 0.0) return Ok();
+
+        double frequency = 440.0 * std::pow(2.0, (note - 69) / 12.0);
+        auto source = std::make_shared<OscillatorSource>(_keyboard_kind, frequency, _engine->config().sample_rate);
+        // Piano velocities are a key-press depth in [0, 1]; keep soft presses audible
+        float gain = _keyboard_gain * static_cast<float>(0.25 + 0.75 * std::clamp(*number, 0.0, 1.0));
+        auto id_res = _engine->play(source, gain);
+        if (!id_res) {
+            return Err<void>("PlaybackManager: note " + std::to_string(note) + " not played", id_res);
+        }
+        _notes[note] = *id_res;
+        return _auto_start_engine();
+    }
+
+    // ---------- helpers ----------
+
+    static std::optional<double> _as_number(const Value& v) {
+        if (auto d = get_as<double>(v)) return d;
+        if (auto i = get_as<int>(v)) return static_cast<double>(*i);
+        if (auto i = get_as<int64_t>(v)) return static_cast<double>(*i);
+        return std::nullopt;
+    }
+
+    static std::optional<double> _number(const Dict& data, const std::string& key) {
+        auto it = data.find(key);
+        if (it == data.end()) return std::nullopt;
+        return _as_number(it->second);
+    }
+
+    AudioEngineConfig _config;
+    AudioEnginePtr _engine;
+    std::string _sink_kind = "null";
+    Dict _sink_options;
+    bool _auto_start = true;
+
+    std::map<std::string, VoiceEntry> _voices;
+
+    WaveformKind _keyboard_kind = WaveformKind::Triangle;
+    float _keyboard_gain = 0.3f;
+    int _keyboard_note = 60;
+    std::map<int, VoiceId> _notes;
+};
+
+namespace embedded {
+    Result<TreeLikePtr> create_playback_manager() {
+        return PlaybackManager::create();
+    }
+}
+
+} // namespace ymery
@@ -0,0 +1,251 @@
+// recorder - capture-to-disk recordings of audio device channels
+#include "../types.hpp"
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "audio_recorder.hpp"
+#include <map>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+/**
+ * RecorderManager - manages recordings, implements TreeLike
+ * Tree structure:
+ *   /available - supported file formats
+ *   /opened - list recordings
+ *   /opened/<name> - recording status and counters
+ *   /opened/<name>/recording - set true/false to start/stop
+ *
+ * New recordings are added with add_child("/opened", name, {...}) where the
+ * data carries "buffer" or "buffers" (the kernel resolves "source"/"sources"
+ * provider paths into these), "file", and optionally "format",
+ * "block-frames", "queue-seconds" and "recording".
+ */
+class RecorderManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<RecorderManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("RecorderManager::create failed", res);
+        }
+        return manager;
+    }
+
+    Result<void> dispose() override {
+        for (auto& [_, recorder] : _recorders) {
+            recorder->stop();
+        }
+        _recorders.clear();
+        return Ok();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(std::vector<std::string>{"available", "opened"});
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(AudioRecorder::supported_formats());
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            std::vector<std::string> children;
+            for (const auto& [name, _] : _recorders) {
+                children.push_back(name);
+            }
+            return Ok(children);
+        }
+
+        return Ok(std::vector<std::string>{});
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(Dict{
+                {"name", Value("recorder")},
+                {"label", Value("Recorder")},
+                {"type", Value("recorder-manager")},
+                {"category", Value("audio-device-manager")}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value("available")},
+                {"label", Value("Formats")},
+                {"type", Value("folder")},
+                {"category", Value("folder")}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            return Ok(Dict{
+                {"name", Value("opened")},
+                {"label", Value("Recordings")},
+                {"type", Value("folder")},
+                {"category", Value("folder")}
+            });
+        }
+
+        if (parts.size() == 2 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1])},
+                {"type", Value("recorder-format")},
+                {"category", Value("format")}
+            });
+        }
+
+        if (parts.size() == 2 && parts[0] == "opened") {
+            auto it = _recorders.find(parts[1]);
+            if (it == _recorders.end()) return Ok(Dict{});
+            auto& recorder = it->second;
+            return Ok(Dict{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1] + " (" + recorder->config().file_path + ")")},
+                {"type", Value("recording")},
+                {"category", Value("recording")},
+                {"status", Value(std::string(recorder->is_recording() ? "recording" : "stopped"))},
+                {"recording", Value(recorder->is_recording())},
+                {"file", Value(recorder->config().file_path)},
+                {"format", Value(recorder->config().format)},
+                {"num-channels", Value(static_cast<int64_t>(recorder->num_channels()))},
+                {"sample-rate", Value(static_cast<int64_t>(recorder->sample_rate()))},
+                {"frames-written", Value(static_cast<int64_t>(recorder->frames_written()))},
+                {"bytes-written", Value(static_cast<int64_t>(recorder->bytes_written()))},
+                {"dropped-blocks", Value(static_cast<int64_t>(recorder->dropped_blocks()))}
+            });
+        }
+
+        return Ok(Dict{});
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        auto parent = path.dirname();
+        auto key = path.filename();
+        auto meta_res = get_metadata(parent);
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(key);
+        if (it != meta_res->end()) return Ok(it->second);
+        return Ok(Value{});
+    }
+
+    Result<void> set(const DataPath& path, const Value& value) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 3 || parts[0] != "opened" || parts[2] != "recording") {
+            return Err<void>("RecorderManager: set only supports /opened/<name>/recording");
+        }
+
+        auto it = _recorders.find(parts[1]);
+        if (it == _recorders.end()) {
+            return Err<void>("RecorderManager: no recording named '" + parts[1] + "'");
+        }
+
+        auto enable = get_as<bool>(value);
+        if (!enable) {
+            return Err<void>("RecorderManager: 'recording' must be a bool");
+        }
+
+        if (*enable) {
+            if (auto res = it->second->start(); !res) {
+                return Err<void>("RecorderManager: start failed", res);
+            }
+        } else {
+            if (auto res = it->second->stop(); !res) {
+                return Err<void>("RecorderManager: stop failed", res);
+            }
+        }
+        return Ok();
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "opened") {
+            return Err<void>("RecorderManager: add_child only supported on /opened");
+        }
+        if (name.empty()) {
+            return Err<void>("RecorderManager: recording name required");
+        }
+        if (_recorders.count(name)) {
+            return Err<void>("RecorderManager: recording '" + name + "' already exists");
+        }
+
+        std::vector<MediatedAudioBufferPtr> sources;
+        if (auto it = data.find("buffer"); it != data.end()) {
+            if (auto buffer = get_as<MediatedAudioBufferPtr>(it->second)) {
+                sources.push_back(*buffer);
+            }
+        }
+        if (auto it = data.find("buffers"); it != data.end()) {
+            if (auto list = get_as<List>(it->second)) {
+                for (const auto& item : *list) {
+                    if (auto buffer = get_as<MediatedAudioBufferPtr>(item)) {
+                        sources.push_back(*buffer);
+                    }
+                }
+            }
+        }
+        if (sources.empty()) {
+            return Err<void>("RecorderManager: add_child needs 'buffer' or 'buffers'");
+        }
+
+        AudioRecorderConfig config;
+        if (auto it = data.find("file"); it != data.end()) {
+            if (auto f = get_as<std::string>(it->second)) config.file_path = *f;
+        }
+        if (auto it = data.find("format"); it != data.end()) {
+            if (auto f = get_as<std::string>(it->second)) config.format = *f;
+        }
+        if (auto it = data.find("block-frames"); it != data.end()) {
+            if (auto v = get_as<int>(it->second)) config.block_frames = static_cast<size_t>(*v);
+            if (auto v = get_as<int64_t>(it->second)) config.block_frames = static_cast<size_t>(*v);
+        }
+        if (auto it = data.find("queue-seconds"); it != data.end()) {
+            if (auto v = get_as<double>(it->second)) config.queue_seconds = *v;
+        }
+
+        auto recorder_res = AudioRecorder::create(std::move(sources), config);
+        if (!recorder_res) {
+            return Err<void>("RecorderManager: failed to create recording '" + name + "'", recorder_res);
+        }
+        _recorders[name] = *recorder_res;
+
+        if (auto it = data.find("recording"); it != data.end()) {
+            if (auto b = get_as<bool>(it->second); b && *b) {
+                return set(DataPath("/opened") / name / "recording", Value(true));
+            }
+        }
+        return Ok();
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int depth) override {
+        return Ok(path.to_string());
+    }
+
+    ~RecorderManager() {
+        dispose();
+    }
+
+private:
+    std::map<std::string, AudioRecorderPtr> _recorders;
+};
+
+namespace embedded {
+    Result<TreeLikePtr> create_recorder_manager() {
+        return RecorderManager::create();
+    }
+}
+
+} // namespace ymery
@@ -0,0 +1,319 @@
+// resampler - audio channels converted to another sample rate
+#include "../types.hpp"
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "audio_resampler.hpp"
+#include "audio_stats.hpp"
+#include <map>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+/**
+ * ResamplerManager - manages rate conversions, implements TreeLike
+ * Tree structure:
+ *   /available - quality presets
+ *   /opened - list conversions
+ *   /opened/<name> - rates, quality, filter size and counters
+ *   /opened/<name>/<channel> - converted channel with buffer (streams) or
+ *                              mediator (loaded files)
+ *   /opened/<name>/stats - conversion time per block and output ring stats
+ *
+ * Conversions are added with add_child("/opened", name, {...}) where the
+ * data carries "buffer" or "buffers" (the kernel resolves "source"/"sources"
+ * provider paths into these), "sample-rate" and optionally "quality".
+ * Capture channels are converted block by block as they are written;
+ * audio-file channels are converted once, delay-compensated.
+ */
+class ResamplerManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<ResamplerManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("ResamplerManager::create failed", res);
+        }
+        return manager;
+    }
+
+    Result<void> dispose() override {
+        _conversions.clear();
+        return Ok();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(std::vector<std::string>{"available", "opened"});
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(resampler_quality_names());
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            std::vector<std::string> children;
+            for (const auto& [name, _] : _conversions) {
+                children.push_back(name);
+            }
+            return Ok(children);
+        }
+
+        if (parts.size() >= 2 && parts[0] == "opened") {
+            auto it = _conversions.find(parts[1]);
+            if (it == _conversions.end()) return Ok(std::vector<std::string>{});
+            auto& conversion = it->second;
+
+            if (parts.size() == 2) {
+                std::vector<std::string> children;
+                for (size_t ch = 0; ch < conversion.num_channels(); ++ch) {
+                    children.push_back(std::to_string(ch));
+                }
+                if (conversion.stream) children.push_back("stats");
+                return Ok(children);
+            }
+            auto rel = audio_stats_rel(path);
+            if (rel && conversion.stream) {
+                return Ok(audio_stats_children_names(*rel, conversion.stream->ring()));
+            }
+        }
+
+        return Ok(std::vector<std::string>{});
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(Dict{
+                {"name", Value("resampler")},
+                {"label", Value("Resampler")},
+                {"type", Value("resampler-manager")},
+                {"category", Value("audio-device-manager")}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value("available")},
+                {"label", Value("Qualities")},
+                {"type", Value("folder")},
+                {"category", Value("folder")}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            return Ok(Dict{
+                {"name", Value("opened")},
+                {"label", Value("Conversions")},
+                {"type", Value("folder")},
+                {"category", Value("folder")}
+            });
+        }
+
+        if (parts.size() == 2 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1])},
+                {"type", Value("resampler-quality")},
+                {"category", Value("quality")}
+            });
+        }
+
+        if (parts.size() < 2 || parts[0] != "opened") return Ok(Dict{});
+        auto it = _conversions.find(parts[1]);
+        if (it == _conversions.end()) return Ok(Dict{});
+        auto& conversion = it->second;
+
+        if (parts.size() == 2) {
+            Dict meta{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1] + " (" + std::to_string(conversion.input_rate) + " -> " +
+                                std::to_string(conversion.output_rate) + " Hz)")},
+                {"type", Value("resampled-device")},
+                {"category", Value("audio-device")},
+                {"status", Value(std::string(conversion.stream && conversion.stream->is_attached() ? "running" : "stopped"))},
+                {"source-rate", Value(static_cast<int64_t>(conversion.input_rate))},
+                {"sample-rate", Value(static_cast<int64_t>(conversion.output_rate))},
+                {"quality", Value(std::string(resampler_quality_name(conversion.quality)))},
+                {"num-channels", Value(static_cast<int64_t>(conversion.num_channels()))}
+            };
+            if (conversion.stream) {
+                auto& stream = *conversion.stream;
+                meta["taps"] = Value(static_cast<int64_t>(stream.taps()));
+                meta["phases"] = Value(static_cast<int64_t>(stream.phases()));
+                meta["delay-frames"] = Value(stream.delay_frames());
+                meta["frames-in"] = Value(static_cast<int64_t>(stream.frames_in()));
+                meta["frames-out"] = Value(static_cast<int64_t>(stream.frames_out()));
+            } else if (!conversion.files.empty()) {
+                meta["frames"] = Value(static_cast<int64_t>(conversion.files.front()->backend()->size()));
+            }
+            return Ok(meta);
+        }
+
+        auto rel = audio_stats_rel(path);
+        if (rel && conversion.stream) {
+            return Ok(audio_stats_metadata(*rel, &conversion.stream->stats(), conversion.stream->ring()));
+        }
+
+        if (parts.size() == 3) {
+            size_t ch = 0;
+            try {
+                ch = std::stoul(parts[2]);
+            } catch (...) {
+                return Ok(Dict{});
+            }
+            if (ch >= conversion.num_channels()) return Ok(Dict{});
+            Dict meta{
+                {"name", Value(parts[2])},
+                {"label", Value("Channel " + parts[2])},
+                {"type", Value("audio-channel")},
+                {"category", Value("audio-channel")},
+                {"sample-rate", Value(static_cast<int64_t>(conversion.output_rate))}
+            };
+            if (conversion.stream) {
+                meta["buffer"] = Value(conversion.stream->buffer(ch));
+            } else {
+                meta["mediator"] = Value(conversion.files[ch]);
+            }
+            return Ok(meta);
+        }
+
+        return Ok(Dict{});
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        auto parent = path.dirname();
+        auto key = path.filename();
+        auto meta_res = get_metadata(parent);
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(key);
+        if (it != meta_res->end()) return Ok(it->second);
+        return Ok(Value{});
+    }
+
+    Result<void> set(const DataPath& /*path*/, const Value& /*value*/) override {
+        return Err<void>("ResamplerManager: conversions are read-only; remove and add again to change them");
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "opened") {
+            return Err<void>("ResamplerManager: add_child only supported on /opened");
+        }
+        if (name.empty()) {
+            return Err<void>("ResamplerManager: conversion name required");
+        }
+        if (_conversions.count(name)) {
+            return Err<void>("ResamplerManager: conversion '" + name + "' already exists");
+        }
+
+        std::vector<MediatedAudioBufferPtr> streams;
+        std::vector<StaticAudioBufferPtr> files;
+        auto collect = [&](const Value& item) {
+            if (auto buffer = get_as<MediatedAudioBufferPtr>(item); buffer && *buffer) {
+                streams.push_back(*buffer);
+            } else if (auto mediator = get_as<StaticAudioBufferMediatorPtr>(item); mediator && *mediator) {
+                files.push_back((*mediator)->backend());
+            }
+        };
+        if (auto it = data.find("buffer"); it != data.end()) {
+            collect(it->second);
+        }
+        if (auto it = data.find("buffers"); it != data.end()) {
+            if (auto list = get_as<List>(it->second)) {
+                for (const auto& item : *list) collect(item);
+            }
+        }
+        if (streams.empty() && files.empty()) {
+            return Err<void>("ResamplerManager: add_child needs 'buffer' or 'buffers'");
+        }
+        if (!streams.empty() && !files.empty()) {
+            return Err<void>("ResamplerManager: cannot mix capture and file channels in one conversion");
+        }
+
+        int output_rate = 0;
+        if (auto it = data.find("sample-rate"); it != data.end()) {
+            if (auto v = get_as<int>(it->second)) output_rate = *v;
+            if (auto v = get_as<int64_t>(it->second)) output_rate = static_cast<int>(*v);
+        }
+        if (output_rate <= 0) {
+            return Err<void>("ResamplerManager: add_child needs a positive 'sample-rate'");
+        }
+        ResamplerQuality quality = streams.empty() ? ResamplerQuality::High : ResamplerQuality::Medium;
+        if (auto it = data.find("quality"); it != data.end()) {
+            auto q = get_as<std::string>(it->second);
+            if (!q) return Err<void>("ResamplerManager: 'quality' must be a string");
+            auto quality_res = resampler_quality_from_string(*q);
+            if (!quality_res) return Err<void>("ResamplerManager: invalid quality", quality_res);
+            quality = *quality_res;
+        }
+
+        Conversion conversion;
+        conversion.output_rate = output_rate;
+        conversion.quality = quality;
+        if (!streams.empty()) {
+            auto stream_res = ResampledStream::create(std::move(streams), output_rate, quality);
+            if (!stream_res) {
+                return Err<void>("ResamplerManager: failed to create conversion '" + name + "'", stream_res);
+            }
+            conversion.stream = *stream_res;
+            conversion.input_rate = conversion.stream->input_rate();
+        } else {
+            conversion.input_rate = files.front()->sample_rate();
+            for (const auto& file : files) {
+                auto converted = resample_buffer(*file, output_rate, quality);
+                if (!converted) {
+                    return Err<void>("ResamplerManager: failed to convert '" + name + "'", converted);
+                }
+                auto mediator = StaticAudioBufferMediator::create(*converted);
+                if (!mediator) {
+                    return Err<void>("ResamplerManager: failed to convert '" + name + "'", mediator);
+                }
+                conversion.files.push_back(*mediator);
+            }
+        }
+
+        ydebug("ResamplerManager: '{}' converts {} channels {} -> {} Hz ({})", name,
+               conversion.num_channels(), conversion.input_rate, output_rate, resampler_quality_name(quality));
+        _conversions[name] = std::move(conversion);
+        return Ok();
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int depth) override {
+        return Ok(path.to_string());
+    }
+
+    ~ResamplerManager() {
+        dispose();
+    }
+
+private:
+    struct Conversion {
+        ResampledStreamPtr stream;                        // capture channels
+        std::vector<StaticAudioBufferMediatorPtr> files;  // audio-file channels
+        int input_rate = 0;
+        int output_rate = 0;
+        ResamplerQuality quality = ResamplerQuality::Medium;
+
+        size_t num_channels() const { return stream ? stream->num_channels() : files.size(); }
+    };
+
+    std::map<std::string, Conversion> _conversions;
+};
+
+namespace embedded {
+    Result<TreeLikePtr> create_resampler_manager() {
+        return ResamplerManager::create();
+    }
+}
+
+} // namespace ymery
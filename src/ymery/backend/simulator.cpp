@@ -0,0 +1,337 @@
+// simulator - simulated capture devices (generated signals, WAV replay, virtual clock)
+#include "../types.hpp"
+#include "../result.hpp"
+#include "audio_buffer.hpp"
+#include "audio_simulator.hpp"
+#include "audio_stats.hpp"
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+/**
+ * SimulatorManager - manages simulated capture devices, implements TreeLike
+ * Tree structure:
+ *   /available - signals (sine, square, triangle, noise, file)
+ *   /opened - list devices
+ *   /opened/<name> - configuration, clock and injected-fault counters
+ *   /opened/<name>/<channel> - channel with buffer
+ *   /opened/<name>/stats - period timing, xruns and ring stats
+ *
+ * Devices are added with add_child("/opened", name, {...}) where the data
+ * carries "signal" (default sine) or "file" (a WAV, implies signal file),
+ * plus optional "frequency", "amplitude", "loop", "num-channels",
+ * "sample-rate", "period-size", "buffer-size", "speed" (0 = virtual clock),
+ * "jitter-ms", "xrun-probability", "seed", "max-frames" and "running".
+ * /opened/<name>/running starts and stops a device.
+ */
+class SimulatorManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<SimulatorManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("SimulatorManager::create failed", res);
+        }
+        return manager;
+    }
+
+    Result<void> dispose() override {
+        for (auto& [_, device] : _devices) {
+            device->stop();
+        }
+        _devices.clear();
+        return Ok();
+    }
+
+    ~SimulatorManager() {
+        dispose();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(std::vector<std::string>{"available", "opened"});
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(sim_signal_names());
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            std::vector<std::string> children;
+            for (const auto& [name, _] : _devices) {
+                children.push_back(name);
+            }
+            return Ok(children);
+        }
+
+        if (parts.size() >= 2 && parts[0] == "opened") {
+            auto it = _devices.find(parts[1]);
+            if (it == _devices.end()) return Ok(std::vector<std::string>{});
+            auto& device = it->second;
+
+            if (parts.size() == 2) {
+                std::vector<std::string> children;
+                for (size_t ch = 0; ch < device->num_channels(); ++ch) {
+                    children.push_back(std::to_string(ch));
+                }
+                children.push_back("stats");
+                return Ok(children);
+            }
+            if (auto rel = audio_stats_rel(path)) {
+                return Ok(audio_stats_children_names(*rel, device->ring_buffer()));
+            }
+        }
+
+        return Ok(std::vector<std::string>{});
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(Dict{
+                {"name", Value("simulator")},
+                {"label", Value("Simulated Devices")},
+                {"type", Value("simulator-manager")},
+                {"category", Value("audio-device-manager")}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value("available")},
+                {"label", Value("Signals")},
+                {"type", Value("folder")},
+                {"category", Value("folder")}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            return Ok(Dict{
+                {"name", Value("opened")},
+                {"label", Value("Devices")},
+                {"type", Value("folder")},
+                {"category", Value("folder")}
+            });
+        }
+
+        if (parts.size() == 2 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1])},
+                {"type", Value("simulated-signal")},
+                {"category", Value("signal")}
+            });
+        }
+
+        if (parts.size() < 2 || parts[0] != "opened") return Ok(Dict{});
+        auto it = _devices.find(parts[1]);
+        if (it == _devices.end()) return Ok(Dict{});
+        auto& device = it->second;
+
+        if (parts.size() == 2) {
+            const auto& config = device->config();
+            std::string status = device->is_running() ? "running" : (device->is_finished() ? "finished" : "stopped");
+            std::ostringstream clock;
+            if (config.speed > 0.0) clock << config.speed << "x";
+            else clock << "virtual clock";
+            Dict meta{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1] + " (" + sim_signal_name(config.signal) + ", " + clock.str() + ")")},
+                {"type", Value("simulated-device")},
+                {"category", Value("audio-device")},
+                {"status", Value(status)},
+                {"running", Value(device->is_running())},
+                {"signal", Value(std::string(sim_signal_name(config.signal)))},
+                {"num-channels", Value(static_cast<int64_t>(device->num_channels()))},
+                {"sample-rate", Value(static_cast<int64_t>(device->sample_rate()))},
+                {"period-size", Value(static_cast<int64_t>(device->period_size()))},
+                {"speed", Value(config.speed)},
+                {"jitter-ms", Value(config.jitter_ms)},
+                {"xrun-probability", Value(config.xrun_probability)},
+                {"seed", Value(static_cast<int64_t>(config.seed))},
+                {"frames-generated", Value(static_cast<int64_t>(device->frames_generated()))},
+                {"frames-dropped", Value(static_cast<int64_t>(device->frames_dropped()))},
+                {"injected-xruns", Value(static_cast<int64_t>(device->injected_xruns()))},
+                {"virtual-time", Value(device->virtual_time())},
+                {"max-lateness-us", Value(device->max_lateness_us())}
+            };
+            if (config.signal == SimSignal::File) {
+                meta["file"] = Value(config.file);
+            }
+            return Ok(meta);
+        }
+
+        if (auto rel = audio_stats_rel(path)) {
+            return Ok(audio_stats_metadata(*rel, &device->stats(), device->ring_buffer()));
+        }
+
+        if (parts.size() == 3) {
+            size_t ch = 0;
+            try {
+                ch = std::stoul(parts[2]);
+            } catch (...) {
+                return Ok(Dict{});
+            }
+            auto buffer = device->get_buffer(ch);
+            if (!buffer) return Ok(Dict{});
+            return Ok(Dict{
+                {"name", Value(parts[2])},
+                {"label", Value("Channel " + parts[2])},
+                {"type", Value("audio-channel")},
+                {"category", Value("audio-channel")},
+                {"sample-rate", Value(static_cast<int64_t>(device->sample_rate()))},
+                {"buffer", Value(buffer)}
+            });
+        }
+
+        return Ok(Dict{});
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        auto parent = path.dirname();
+        auto key = path.filename();
+        auto meta_res = get_metadata(parent);
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(key);
+        if (it != meta_res->end()) return Ok(it->second);
+        return Ok(Value{});
+    }
+
+    Result<void> set(const DataPath& path, const Value& value) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 3 || parts[0] != "opened" || parts[2] != "running") {
+            return Err<void>("SimulatorManager: cannot set '" + path.to_string() + "'");
+        }
+        auto it = _devices.find(parts[1]);
+        if (it == _devices.end()) {
+            return Err<void>("SimulatorManager: no device '" + parts[1] + "'");
+        }
+        auto running = get_as<bool>(value);
+        if (!running) return Err<void>("SimulatorManager: 'running' must be a bool");
+
+        auto& device = it->second;
+        if (!*running) {
+            device->stop();
+            return Ok();
+        }
+        // A device that stopped itself has to be joined before it can restart
+        if (!device->is_running()) device->stop();
+        return device->start();
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "opened") {
+            return Err<void>("SimulatorManager: add_child only supported on /opened");
+        }
+        if (name.empty()) {
+            return Err<void>("SimulatorManager: device name required");
+        }
+        if (_devices.count(name)) {
+            return Err<void>("SimulatorManager: device '" + name + "' already exists");
+        }
+
+        SimulatedDeviceConfig config;
+        if (auto file = _string(data, "file")) {
+            config.signal = SimSignal::File;
+            config.file = *file;
+            // A file brings its own layout unless one is asked for
+            config.num_channels = 0;
+            config.sample_rate = 0;
+        }
+        if (auto signal = _string(data, "signal")) {
+            auto signal_res = sim_signal_from_string(*signal);
+            if (!signal_res) return Err<void>("SimulatorManager: invalid signal", signal_res);
+            config.signal = *signal_res;
+        }
+        if (config.signal == SimSignal::File && config.file.empty()) {
+            return Err<void>("SimulatorManager: signal 'file' needs a 'file'");
+        }
+        if (auto it = data.find("loop"); it != data.end()) {
+            if (auto b = get_as<bool>(it->second)) config.loop = *b;
+        }
+        config.frequency = _number(data, "frequency").value_or(config.frequency);
+        config.amplitude = static_cast<float>(_number(data, "amplitude").value_or(config.amplitude));
+        config.speed = _number(data, "speed").value_or(config.speed);
+        config.jitter_ms = _number(data, "jitter-ms").value_or(config.jitter_ms);
+        config.xrun_probability = _number(data, "xrun-probability").value_or(config.xrun_probability);
+        if (auto n = _count(data, "num-channels")) config.num_channels = static_cast<size_t>(*n);
+        if (auto n = _count(data, "sample-rate")) config.sample_rate = static_cast<int>(*n);
+        if (auto n = _count(data, "period-size")) config.period_size = static_cast<size_t>(*n);
+        if (auto n = _count(data, "buffer-size")) config.buffer_size = static_cast<size_t>(*n);
+        if (auto n = _count(data, "seed")) config.seed = *n;
+        if (auto n = _count(data, "max-frames")) config.max_frames = *n;
+
+        auto device_res = SimulatedDevice::create(config, name);
+        if (!device_res) {
+            return Err<void>("SimulatorManager: cannot create device '" + name + "'", device_res);
+        }
+        auto device = *device_res;
+
+        bool running = true;
+        if (auto it = data.find("running"); it != data.end()) {
+            if (auto b = get_as<bool>(it->second)) running = *b;
+        }
+        if (running) {
+            if (auto res = device->start(); !res) {
+                return Err<void>("SimulatorManager: cannot start device '" + name + "'", res);
+            }
+        }
+
+        ydebug("SimulatorManager: '{}' {} x{} ch at {} Hz, speed {}", name, sim_signal_name(device->config().signal),
+               device->num_channels(), device->sample_rate(), device->config().speed);
+        _devices[name] = device;
+        return Ok();
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int depth) override {
+        return Ok(path.to_string());
+    }
+
+private:
+    static std::optional<double> _number(const Dict& data, const std::string& key) {
+        auto it = data.find(key);
+        if (it == data.end()) return std::nullopt;
+        if (auto d = get_as<double>(it->second)) return d;
+        if (auto i = get_as<int>(it->second)) return static_cast<double>(*i);
+        if (auto i = get_as<int64_t>(it->second)) return static_cast<double>(*i);
+        return std::nullopt;
+    }
+
+    // Integer settings; negative values are ignored
+    static std::optional<uint64_t> _count(const Dict& data, const std::string& key) {
+        auto number = _number(data, key);
+        if (!number || *number < 0.0) return std::nullopt;
+        return static_cast<uint64_t>(*number);
+    }
+
+    static std::optional<std::string> _string(const Dict& data, const std::string& key) {
+        auto it = data.find(key);
+        if (it == data.end()) return std::nullopt;
+        return get_as<std::string>(it->second);
+    }
+
+    std::map<std::string, SimulatedDevicePtr> _devices;
+};
+
+namespace embedded {
+    Result<TreeLikePtr> create_simulator_manager() {
+        return SimulatorManager::create();
+    }
+}
+
+} // namespace ymery
@@ -0,0 +1,86 @@
+// Lock-free single-producer / single-consumer queue
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ymery {
+
+/**
+ * Bounded SPSC queue with preallocated slots
+ * Slots are filled and drained in place so large payloads (audio blocks)
+ * never allocate or copy on the real-time side. A full queue rejects the
+ * push instead of blocking the producer.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity = 0) : _slots(capacity + 1) {}
+
+    // Access slots for preallocation before the queue is shared
+    std::vector<T>& slots() { return _slots; }
+
+    // Producer interface - reserve next slot, fill it, then commit
+    T* begin_push() {
+        size_t w = _write_pos.load(std::memory_order_relaxed);
+        size_t next = _next(w);
+        if (next == _read_pos.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &_slots[w];
+    }
+
+    void commit_push() {
+        size_t w = _write_pos.load(std::memory_order_relaxed);
+        _write_pos.store(_next(w), std::memory_order_release);
+    }
+
+    bool try_push(const T& value) {
+        T* slot = begin_push();
+        if (!slot) return false;
+        *slot = value;
+        commit_push();
+        return true;
+    }
+
+    // Consumer interface - peek at oldest slot, then release it
+    T* front() {
+        size_t r = _read_pos.load(std::memory_order_relaxed);
+        if (r == _write_pos.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &_slots[r];
+    }
+
+    void pop() {
+        size_t r = _read_pos.load(std::memory_order_relaxed);
+        _read_pos.store(_next(r), std::memory_order_release);
+    }
+
+    bool try_pop(T& out) {
+        T* slot = front();
+        if (!slot) return false;
+        out = std::move(*slot);
+        pop();
+        return true;
+    }
+
+    // Properties
+    size_t capacity() const { return _slots.size() - 1; }
+    size_t size() const {
+        size_t w = _write_pos.load(std::memory_order_acquire);
+        size_t r = _read_pos.load(std::memory_order_acquire);
+        return w >= r ? w - r : _slots.size() - r + w;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    size_t _next(size_t pos) const { return pos + 1 == _slots.size() ? 0 : pos + 1; }
+
+    alignas(64) std::atomic<size_t> _write_pos{0};
+    alignas(64) std::atomic<size_t> _read_pos{0};
+    std::vector<T> _slots;
+};
+
+} // namespace ymery
@@ -0,0 +1,621 @@
+// Table file implementation
+#include "table_file.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <thread>
+#include <ytrace/ytrace.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace ymery {
+
+namespace {
+
+constexpr size_t ROW_MARK = 1024;         // sparse row index stride
+constexpr size_t TYPE_SAMPLE_ROWS = 64;   // rows inspected to type columns
+constexpr char COLUMNAR_MAGIC[4] = {'Y', 'C', 'O', 'L'};
+constexpr uint32_t COLUMNAR_VERSION = 1;
+constexpr size_t COLUMNAR_HEADER_SIZE = 24;
+constexpr size_t COLUMNAR_ENTRY_SIZE = 16;
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// First occurrence of c in [p, end), or end. Eight bytes per step with the
+// classic has-zero-byte trick, so short fields skip the memchr call overhead.
+const char* find_char(const char* p, const char* end, char c) {
+    if constexpr (std::endian::native == std::endian::little) {
+        constexpr uint64_t ones = 0x0101010101010101ULL;
+        constexpr uint64_t highs = 0x8080808080808080ULL;
+        const uint64_t pattern = ones * static_cast<uint8_t>(c);
+        while (end - p >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, 8);
+            uint64_t x = word ^ pattern;
+            uint64_t hit = (x - ones) & ~x & highs;
+            if (hit) return p + (std::countr_zero(hit) >> 3);
+            p += 8;
+        }
+    }
+    while (p < end && *p != c) ++p;
+    return p;
+}
+
+// Next line break in [p, end), or end (memchr is vectorized by the C library)
+const char* find_line_end(const char* p, const char* end) {
+    auto nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    return nl ? nl : end;
+}
+
+// Start of the line after the one containing p, or end
+const char* next_line(const char* p, const char* end) {
+    const char* nl = find_line_end(p, end);
+    return nl < end ? nl + 1 : end;
+}
+
+std::string_view strip_cr(const char* begin, const char* end) {
+    if (end > begin && end[-1] == '\r') --end;
+    return {begin, static_cast<size_t>(end - begin)};
+}
+
+// Splits one line into fields; quoted fields may contain the delimiter
+class FieldReader {
+public:
+    FieldReader(std::string_view line, char delimiter)
+        : _p(line.data()), _end(line.data() + line.size()), _delimiter(delimiter) {}
+
+    bool next(std::string_view& field) {
+        if (_done) return false;
+        if (_p < _end && *_p == '"') {
+            const char* start = _p + 1;
+            const char* q = find_char(start, _end, '"');
+            while (q + 1 < _end && q[1] == '"') {
+                q = find_char(q + 2, _end, '"');
+            }
+            field = {start, static_cast<size_t>(q - start)};
+            _advance(find_char(std::min(q + 1, _end), _end, _delimiter));
+            return true;
+        }
+        const char* d = find_char(_p, _end, _delimiter);
+        field = {_p, static_cast<size_t>(d - _p)};
+        _advance(d);
+        return true;
+    }
+
+    bool skip(size_t count) {
+        std::string_view unused;
+        for (size_t i = 0; i < count; ++i) {
+            if (!next(unused)) return false;
+        }
+        return true;
+    }
+
+private:
+    void _advance(const char* delimiter) {
+        if (delimiter < _end) {
+            _p = delimiter + 1;
+        } else {
+            _done = true;
+        }
+    }
+
+    const char* _p;
+    const char* _end;
+    char _delimiter;
+    bool _done = false;
+};
+
+bool parse_number(std::string_view field, double& out) {
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t')) field.remove_suffix(1);
+    if (!field.empty() && field.front() == '+') field.remove_prefix(1);
+    if (field.empty()) return false;
+    auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), out);
+    return ec == std::errc{} && ptr == field.data() + field.size();
+}
+
+bool is_blank(std::string_view field) {
+    return field.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+template<typename T>
+T read_le(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+size_t element_size(NumericType type) {
+    switch (type) {
+        case NumericType::F32: return sizeof(float);
+        case NumericType::F64: return sizeof(double);
+        case NumericType::I32: return sizeof(int32_t);
+    }
+    return 0;
+}
+
+size_t pad8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+} // namespace
+
+// ============================================================================
+// Mapping - read-only memory map of the whole file
+// ============================================================================
+
+struct TableFile::Mapping {
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE map = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    static Result<std::unique_ptr<Mapping>> open(const std::string& path) {
+        auto m = std::make_unique<Mapping>();
+#ifdef _WIN32
+        m->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m->file == INVALID_HANDLE_VALUE) {
+            return Err<std::unique_ptr<Mapping>>("TableFile: cannot open '" + path + "'");
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m->file, &size)) {
+            return Err<std::unique_ptr<Mapping>>("TableFile: cannot stat '" + path + "'");
+        }
+        m->size = static_cast<size_t>(size.QuadPart);
+        if (m->size > 0) {
+            m->map = CreateFileMappingA(m->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m->map) {
+                return Err<std::unique_ptr<Mapping>>("TableFile: cannot map '" + path + "'");
+            }
+            m->data = static_cast<const char*>(MapViewOfFile(m->map, FILE_MAP_READ, 0, 0, 0));
+            if (!m->data) {
+                return Err<std::unique_ptr<Mapping>>("TableFile: cannot map '" + path + "'");
+            }
+        }
+#else
+        m->fd = ::open(path.c_str(), O_RDONLY);
+        if (m->fd < 0) {
+            return Err<std::unique_ptr<Mapping>>("TableFile: cannot open '" + path + "'");
+        }
+        struct stat st;
+        if (fstat(m->fd, &st) != 0) {
+            return Err<std::unique_ptr<Mapping>>("TableFile: cannot stat '" + path + "'");
+        }
+        m->size = static_cast<size_t>(st.st_size);
+        if (m->size > 0) {
+            void* p = mmap(nullptr, m->size, PROT_READ, MAP_PRIVATE, m->fd, 0);
+            if (p == MAP_FAILED) {
+                return Err<std::unique_ptr<Mapping>>("TableFile: cannot map '" + path + "'");
+            }
+            m->data = static_cast<const char*>(p);
+        }
+#endif
+        return m;
+    }
+
+    ~Mapping() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (map) CloseHandle(map);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<char*>(data), size);
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+};
+
+// ============================================================================
+// Opening and indexing
+// ============================================================================
+
+TableFile::~TableFile() = default;
+
+std::vector<std::string> TableFile::supported_extensions() {
+    return {"csv", "tsv", "tab", "txt", "ycol"};
+}
+
+Result<TableFilePtr> TableFile::open(const std::string& path, const TableFileOptions& options) {
+    auto file = TableFilePtr(new TableFile());
+    file->_path = path;
+    file->_options = options;
+
+    auto mapping = Mapping::open(path);
+    if (!mapping) {
+        return Err<TableFilePtr>("TableFile::open failed", mapping);
+    }
+    file->_mapping = std::move(*mapping);
+
+    const auto& m = *file->_mapping;
+    file->_columnar = m.size >= 4 && std::memcmp(m.data, COLUMNAR_MAGIC, 4) == 0;
+
+    auto res = file->_columnar ? file->_index_columnar() : file->_index_delimited();
+    if (!res) {
+        return Err<TableFilePtr>("TableFile::open: cannot read '" + path + "'", res);
+    }
+    file->_cache.resize(file->_columns.size());
+
+    ydebug("TableFile: '{}' has {} rows, {} columns ({} chunks)",
+           path, file->_rows, file->_columns.size(), file->_chunks.size());
+    return file;
+}
+
+Result<void> TableFile::_index_delimited() {
+    if (_options.delimiter) {
+        _delimiter = _options.delimiter;
+    } else {
+        auto ext = fs::path(_path).extension().string();
+        _delimiter = (ext == ".tsv" || ext == ".tab") ? '\t' : ',';
+    }
+
+    const char* data = _mapping->data;
+    const char* end = data + _mapping->size;
+    const char* begin = data;
+    if (end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) begin += 3;
+    if (begin == end) return Ok();
+
+    // The first line names the columns, or is already data
+    const char* first_end = find_line_end(begin, end);
+    std::vector<std::string_view> first;
+    {
+        FieldReader reader(strip_cr(begin, first_end), _delimiter);
+        std::string_view field;
+        while (reader.next(field)) first.push_back(field);
+    }
+    bool header = true;
+    if (_options.header) {
+        header = *_options.header;
+    } else {
+        double unused;
+        header = std::any_of(first.begin(), first.end(), [&](std::string_view f) {
+            return !is_blank(f) && !parse_number(f, unused);
+        });
+    }
+    for (size_t i = 0; i < first.size(); ++i) {
+        _columns.push_back({header ? std::string(first[i]) : "column-" + std::to_string(i), NumericType::F64});
+    }
+    const char* data_begin = header ? std::min(first_end + 1, end) : begin;
+
+    // Line-aligned chunks
+    const size_t chunk_bytes = std::max<size_t>(_options.chunk_bytes, 1);
+    for (const char* p = data_begin; p < end;) {
+        const char* stop = end;
+        if (static_cast<size_t>(end - p) > chunk_bytes) {
+            stop = next_line(p + chunk_bytes - 1, end);
+        }
+        Chunk chunk;
+        chunk.begin = static_cast<size_t>(p - data);
+        chunk.end = static_cast<size_t>(stop - data);
+        _chunks.push_back(std::move(chunk));
+        p = stop;
+    }
+
+    // Count rows per chunk in parallel, remembering every ROW_MARK-th line
+    _parallel_for(_chunks.size(), [&](size_t i) {
+        auto& chunk = _chunks[i];
+        const char* p = data + chunk.begin;
+        const char* stop = data + chunk.end;
+        while (p < stop) {
+            if (chunk.rows % ROW_MARK == 0) chunk.marks.push_back(static_cast<size_t>(p - data));
+            ++chunk.rows;
+            p = next_line(p, stop);
+        }
+    });
+    for (auto& chunk : _chunks) {
+        chunk.first_row = _rows;
+        _rows += chunk.rows;
+    }
+
+    // A column is numeric unless a sampled cell is text
+    size_t sample = std::min(_rows, TYPE_SAMPLE_ROWS);
+    for (size_t row = 0; row < sample; ++row) {
+        FieldReader reader(_line(row), _delimiter);
+        std::string_view field;
+        double unused;
+        for (size_t c = 0; c < _columns.size() && reader.next(field); ++c) {
+            if (!is_blank(field) && !parse_number(field, unused)) _columns[c].type.reset();
+        }
+    }
+    return Ok();
+}
+
+Result<void> TableFile::_index_columnar() {
+    if constexpr (std::endian::native != std::endian::little) {
+        return Err<void>("TableFile: columnar files need a little-endian host");
+    }
+    const char* data = _mapping->data;
+    const size_t size = _mapping->size;
+    if (size < COLUMNAR_HEADER_SIZE) {
+        return Err<void>("TableFile: truncated columnar header");
+    }
+    if (read_le<uint32_t>(data + 4) != COLUMNAR_VERSION) {
+        return Err<void>("TableFile: unsupported columnar version");
+    }
+    uint32_t columns = read_le<uint32_t>(data + 8);
+    _rows = static_cast<size_t>(read_le<uint64_t>(data + 16));
+
+    size_t pos = COLUMNAR_HEADER_SIZE;
+    for (uint32_t c = 0; c < columns; ++c) {
+        if (pos + COLUMNAR_ENTRY_SIZE > size) {
+            return Err<void>("TableFile: truncated columnar directory");
+        }
+        uint32_t type = read_le<uint32_t>(data + pos);
+        uint32_t name_len = read_le<uint32_t>(data + pos + 4);
+        uint64_t offset = read_le<uint64_t>(data + pos + 8);
+        pos += COLUMNAR_ENTRY_SIZE;
+        if (type > static_cast<uint32_t>(NumericType::I32) || pos + name_len > size) {
+            return Err<void>("TableFile: bad columnar column " + std::to_string(c));
+        }
+        auto numeric = static_cast<NumericType>(type);
+        if (offset % 8 != 0 || offset > size || (size - offset) / element_size(numeric) < _rows) {
+            return Err<void>("TableFile: columnar column " + std::to_string(c) + " is out of bounds");
+        }
+        _columns.push_back({std::string(data + pos, name_len), numeric});
+        _column_offsets.push_back(static_cast<size_t>(offset));
+        pos += pad8(name_len);
+    }
+    return Ok();
+}
+
+void TableFile::_parallel_for(size_t count, const std::function<void(size_t)>& fn) const {
+    size_t threads = _options.threads ? _options.threads : std::thread::hardware_concurrency();
+    threads = std::min(std::max<size_t>(threads, 1), count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i);
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+std::string TableFile::format_name() const {
+    if (_columnar) return "ycol";
+    return _delimiter == '\t' ? "tsv" : "csv";
+}
+
+size_t TableFile::size_bytes() const {
+    return _mapping ? _mapping->size : 0;
+}
+
+std::optional<size_t> TableFile::column_index(std::string_view name) const {
+    for (size_t i = 0; i < _columns.size(); ++i) {
+        if (_columns[i].name == name) return i;
+    }
+    return std::nullopt;
+}
+
+std::string_view TableFile::_line(size_t row) const {
+    auto it = std::upper_bound(_chunks.begin(), _chunks.end(), row,
+                               [](size_t r, const Chunk& c) { return r < c.first_row; });
+    const Chunk& chunk = *std::prev(it);
+    size_t local = row - chunk.first_row;
+
+    const char* data = _mapping->data;
+    const char* stop = data + chunk.end;
+    const char* p = data + chunk.marks[local / ROW_MARK];
+    for (size_t skip = local % ROW_MARK; skip > 0; --skip) {
+        p = next_line(p, stop);
+    }
+    return strip_cr(p, find_line_end(p, stop));
+}
+
+Result<NumericArrayPtr> TableFile::column(size_t index) const {
+    if (index >= _columns.size()) {
+        return Err<NumericArrayPtr>("TableFile::column: index out of range");
+    }
+    if (!_columns[index].type) {
+        return Err<NumericArrayPtr>("TableFile::column: '" + _columns[index].name + "' is a text column");
+    }
+
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    if (_cache[index]) return _cache[index];
+
+    auto res = _columnar ? _copy_column(index) : _parse_column(index);
+    if (!res) return Err<NumericArrayPtr>("TableFile::column failed", res);
+    _cache[index] = *res;
+    return *res;
+}
+
+Result<NumericArrayPtr> TableFile::_parse_column(size_t index) const {
+    std::vector<double> values(_rows, NaN);
+    const char* data = _mapping->data;
+
+    // Every chunk knows its first row, so workers write disjoint slices
+    _parallel_for(_chunks.size(), [&](size_t i) {
+        const auto& chunk = _chunks[i];
+        const char* p = data + chunk.begin;
+        const char* stop = data + chunk.end;
+        double* out = values.data() + chunk.first_row;
+        while (p < stop) {
+            const char* line_end = find_line_end(p, stop);
+            FieldReader reader(strip_cr(p, line_end), _delimiter);
+            std::string_view field;
+            if (reader.skip(index) && reader.next(field)) {
+                double v;
+                if (parse_number(field, v)) *out = v;
+            }
+            ++out;
+            p = line_end < stop ? line_end + 1 : stop;
+        }
+    });
+    return NumericArray::create(std::move(values));
+}
+
+Result<NumericArrayPtr> TableFile::_copy_column(size_t index) const {
+    const char* src = _mapping->data + _column_offsets[index];
+    auto copy = [&]<typename T>(T) -> Result<NumericArrayPtr> {
+        std::vector<T> values(_rows);
+        if (_rows > 0) std::memcpy(values.data(), src, _rows * sizeof(T));
+        return NumericArray::create(std::move(values));
+    };
+    switch (*_columns[index].type) {
+        case NumericType::F32: return copy(float{});
+        case NumericType::F64: return copy(double{});
+        case NumericType::I32: return copy(int32_t{});
+    }
+    return Err<NumericArrayPtr>("TableFile: unknown column type");
+}
+
+double TableFile::_columnar_at(size_t column, size_t row) const {
+    const char* src = _mapping->data + _column_offsets[column];
+    switch (*_columns[column].type) {
+        case NumericType::F32: return read_le<float>(src + row * sizeof(float));
+        case NumericType::F64: return read_le<double>(src + row * sizeof(double));
+        case NumericType::I32: return read_le<int32_t>(src + row * sizeof(int32_t));
+    }
+    return NaN;
+}
+
+Result<NumericArrayPtr> TableFile::read_rows(size_t begin, size_t count) const {
+    if (begin > _rows) {
+        return Err<NumericArrayPtr>("TableFile::read_rows: row " + std::to_string(begin) + " out of range");
+    }
+    count = std::min(count, _rows - begin);
+    const size_t width = _columns.size();
+    std::vector<double> values(count * width, NaN);
+
+    if (_columnar) {
+        for (size_t r = 0; r < count; ++r) {
+            for (size_t c = 0; c < width; ++c) {
+                values[r * width + c] = _columnar_at(c, begin + r);
+            }
+        }
+    } else if (count > 0) {
+        // Rows are contiguous, so only the first one needs the index
+        std::string_view line = _line(begin);
+        const char* file_end = _mapping->data + _mapping->size;
+        for (size_t r = 0; r < count; ++r) {
+            FieldReader reader(line, _delimiter);
+            std::string_view field;
+            for (size_t c = 0; c < width && reader.next(field); ++c) {
+                if (_columns[c].type) parse_number(field, values[r * width + c]);
+            }
+            if (r + 1 < count) {
+                const char* next = next_line(line.data() + line.size(), file_end);
+                line = strip_cr(next, find_line_end(next, file_end));
+            }
+        }
+    }
+    return NumericArray::create(std::move(values), {count, width});
+}
+
+Result<std::vector<std::string>> TableFile::row_text(size_t row) const {
+    if (row >= _rows) {
+        return Err<std::vector<std::string>>("TableFile::row_text: row " + std::to_string(row) + " out of range");
+    }
+    std::vector<std::string> cells;
+    cells.reserve(_columns.size());
+
+    if (_columnar) {
+        for (size_t c = 0; c < _columns.size(); ++c) {
+            char buf[32];
+            auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), _columnar_at(c, row));
+            cells.emplace_back(buf, ec == std::errc{} ? ptr : buf);
+        }
+        return cells;
+    }
+
+    FieldReader reader(_line(row), _delimiter);
+    std::string_view field;
+    while (cells.size() < _columns.size() && reader.next(field)) {
+        cells.emplace_back(field);
+    }
+    cells.resize(_columns.size());
+    return cells;
+}
+
+// ============================================================================
+// Columnar writer
+// ============================================================================
+
+Result<void> TableFile::write_columnar(const std::string& path,
+                                       const std::vector<std::string>& names,
+                                       const std::vector<NumericArrayPtr>& columns) {
+    if (names.size() != columns.size()) {
+        return Err<void>("TableFile::write_columnar: names and columns differ in count");
+    }
+    size_t rows = columns.empty() || !columns[0] ? 0 : columns[0]->size();
+    for (const auto& column : columns) {
+        if (!column || column->shape().size() != 1 || column->size() != rows) {
+            return Err<void>("TableFile::write_columnar: columns must be 1-D and equally sized");
+        }
+    }
+
+    // Header and directory first, then the data at 8-byte aligned offsets
+    std::vector<char> head(COLUMNAR_HEADER_SIZE, 0);
+    auto put = [&head](size_t at, auto v) { std::memcpy(head.data() + at, &v, sizeof(v)); };
+    std::memcpy(head.data(), COLUMNAR_MAGIC, 4);
+    put(4, COLUMNAR_VERSION);
+    put(8, static_cast<uint32_t>(columns.size()));
+    put(16, static_cast<uint64_t>(rows));
+
+    size_t offset = COLUMNAR_HEADER_SIZE;
+    for (const auto& name : names) offset += COLUMNAR_ENTRY_SIZE + pad8(name.size());
+
+    for (size_t c = 0; c < columns.size(); ++c) {
+        size_t at = head.size();
+        head.resize(at + COLUMNAR_ENTRY_SIZE + pad8(names[c].size()), 0);
+        put(at, static_cast<uint32_t>(columns[c]->type()));
+        put(at + 4, static_cast<uint32_t>(names[c].size()));
+        put(at + 8, static_cast<uint64_t>(offset));
+        std::memcpy(head.data() + at + COLUMNAR_ENTRY_SIZE, names[c].data(), names[c].size());
+        offset += pad8(rows * element_size(columns[c]->type()));
+    }
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return Err<void>("TableFile::write_columnar: cannot create '" + path + "'");
+    }
+    bool ok = std::fwrite(head.data(), 1, head.size(), f) == head.size();
+    static const char zeros[8] = {};
+    for (const auto& column : columns) {
+        size_t bytes = rows * element_size(column->type());
+        const void* src = nullptr;
+        switch (column->type()) {
+            case NumericType::F32: src = column->view<float>().data(); break;
+            case NumericType::F64: src = column->view<double>().data(); break;
+            case NumericType::I32: src = column->view<int32_t>().data(); break;
+        }
+        ok = ok && (bytes == 0 || std::fwrite(src, 1, bytes, f) == bytes);
+        ok = ok && std::fwrite(zeros, 1, pad8(bytes) - bytes, f) == pad8(bytes) - bytes;
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        return Err<void>("TableFile::write_columnar: write to '" + path + "' failed");
+    }
+    return Ok();
+}
+
+} // namespace ymery
@@ -0,0 +1,118 @@
+// Table file - memory-mapped CSV/TSV and columnar files with lazily parsed columns
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ymery {
+
+class TableFile;
+using TableFilePtr = std::shared_ptr<TableFile>;
+
+struct TableFileOptions {
+    char delimiter = 0;                 // 0: '\t' for .tsv/.tab, ',' otherwise
+    std::optional<bool> header;         // unset: header if the first line is not all numbers
+    size_t threads = 0;                 // 0: hardware concurrency
+    size_t chunk_bytes = size_t(4) << 20;
+};
+
+struct TableColumn {
+    std::string name;
+    std::optional<NumericType> type;    // nullopt for text columns
+};
+
+/**
+ * TableFile - read-only view of a tabular file that is never loaded whole.
+ *
+ * The file is memory-mapped. For delimited text, open() only splits the
+ * mapping into line-aligned chunks and counts their rows in parallel, keeping
+ * the byte offset of every 1024th row. A numeric column is parsed on first
+ * access - chunks in parallel, straight into one f64 array - and cached;
+ * row-range reads and text cells go through the sparse row index and only
+ * touch the lines they need. Quoted fields may contain delimiters but not
+ * line breaks.
+ *
+ * The columnar format ("ycol", little-endian):
+ *   "YCOL" u32 version=1 | u32 columns | u32 reserved | u64 rows
+ *   per column: u32 type (NumericType) | u32 name length | u64 data offset |
+ *               name padded to 8 bytes
+ *   column data: rows elements each, at 8-byte aligned offsets
+ * Columns are copied out of the mapping on first access.
+ */
+class TableFile {
+public:
+    static Result<TableFilePtr> open(const std::string& path, const TableFileOptions& options = {});
+    ~TableFile();
+
+    TableFile(const TableFile&) = delete;
+    TableFile& operator=(const TableFile&) = delete;
+
+    // Write equally sized 1-D arrays as a columnar file
+    static Result<void> write_columnar(const std::string& path,
+                                       const std::vector<std::string>& names,
+                                       const std::vector<NumericArrayPtr>& columns);
+
+    static std::vector<std::string> supported_extensions();
+
+    const std::string& path() const { return _path; }
+    std::string format_name() const;
+    size_t size_bytes() const;
+    size_t num_rows() const { return _rows; }
+    size_t num_chunks() const { return _chunks.size(); }
+    const std::vector<TableColumn>& columns() const { return _columns; }
+    std::optional<size_t> column_index(std::string_view name) const;
+
+    // Whole numeric column (parsed once, then shared); fails for text columns
+    Result<NumericArrayPtr> column(size_t index) const;
+    // Rows [begin, begin + count) as a [count, columns] f64 array; text cells are NaN
+    Result<NumericArrayPtr> read_rows(size_t begin, size_t count) const;
+    // Cells of one row as text
+    Result<std::vector<std::string>> row_text(size_t row) const;
+
+private:
+    struct Mapping;
+
+    // Line-aligned byte range of a delimited file
+    struct Chunk {
+        size_t begin = 0;
+        size_t end = 0;
+        size_t first_row = 0;
+        size_t rows = 0;
+        std::vector<size_t> marks;  // offsets of rows first_row + k * ROW_MARK
+    };
+
+    TableFile() = default;
+
+    Result<void> _index_delimited();
+    Result<void> _index_columnar();
+    void _parallel_for(size_t count, const std::function<void(size_t)>& fn) const;
+
+    // Line of a delimited row, without the line break
+    std::string_view _line(size_t row) const;
+    Result<NumericArrayPtr> _parse_column(size_t index) const;
+    Result<NumericArrayPtr> _copy_column(size_t index) const;
+    double _columnar_at(size_t column, size_t row) const;
+
+    std::string _path;
+    TableFileOptions _options;
+    std::unique_ptr<Mapping> _mapping;
+    bool _columnar = false;
+    char _delimiter = ',';
+
+    std::vector<TableColumn> _columns;
+    size_t _rows = 0;
+    std::vector<Chunk> _chunks;
+    std::vector<size_t> _column_offsets;  // columnar data offsets
+
+    mutable std::mutex _cache_mutex;
+    mutable std::vector<NumericArrayPtr> _cache;
+};
+
+} // namespace ymery
@@ -0,0 +1,295 @@
+// table-file - tabular files (CSV/TSV, columnar) exposed as typed columns
+#include "../types.hpp"
+#include "../result.hpp"
+#include "table_file.hpp"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <map>
+#include <ytrace/ytrace.hpp>
+
+namespace fs = std::filesystem;
+
+namespace ymery {
+
+namespace {
+
+// "<kind>:<a>[:<b>]" query keys with non-negative integer fields
+bool parse_index_query(const std::string& key, std::string_view kind, std::vector<size_t>& fields) {
+    if (key.size() <= kind.size() || key.compare(0, kind.size(), kind) != 0 || key[kind.size()] != ':') {
+        return false;
+    }
+    fields.clear();
+    const char* p = key.data() + kind.size() + 1;
+    const char* end = key.data() + key.size();
+    while (p <= end) {
+        const char* sep = std::find(p, end, ':');
+        size_t v = 0;
+        auto [ptr, ec] = std::from_chars(p, sep, v);
+        if (ec != std::errc{} || ptr != sep) return false;
+        fields.push_back(v);
+        p = sep + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * TableFileManager - opened table files, implements TreeLike
+ * Tree structure:
+ *   /available - supported file extensions
+ *   /opened - list opened files by id
+ *   /opened/<id> - file metadata (format, rows, column names)
+ *   /opened/<id>/rows:<begin>:<count> - rows as a [count, columns] f64 array
+ *   /opened/<id>/row:<n> - one row as a list of strings
+ *   /opened/<id>/<column> - column metadata (category "table-column")
+ *   /opened/<id>/<column>/data - the whole column as a typed array, parsed on
+ *                                first access and then shared
+ *
+ * Files are opened with add_child("/opened", name, {...}) where the data
+ * carries "filepath" and optionally "delimiter" and "header".
+ */
+class TableFileManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<TableFileManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("TableFileManager::create failed", res);
+        }
+        return manager;
+    }
+
+    Result<void> dispose() override {
+        _files.clear();
+        _file_ids.clear();
+        return Ok();
+    }
+
+    Result<TableFilePtr> open_file(const std::string& filepath, const TableFileOptions& options) {
+        auto it = _files.find(filepath);
+        if (it != _files.end()) {
+            return it->second;
+        }
+
+        auto res = TableFile::open(filepath, options);
+        if (!res) {
+            return Err<TableFilePtr>("TableFileManager::open_file failed", res);
+        }
+
+        _files[filepath] = *res;
+        _file_ids[_next_id] = filepath;
+        ++_next_id;
+        return *res;
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(std::vector<std::string>{"available", "opened"});
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(TableFile::supported_extensions());
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            std::vector<std::string> ids;
+            for (const auto& [id, _] : _file_ids) {
+                ids.push_back(std::to_string(id));
+            }
+            return Ok(ids);
+        }
+
+        if (parts.size() == 2 && parts[0] == "opened") {
+            std::vector<std::string> names;
+            if (auto file = _find(parts[1])) {
+                for (const auto& column : file->columns()) names.push_back(column.name);
+            }
+            return Ok(names);
+        }
+
+        return Ok(std::vector<std::string>{});
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(Dict{
+                {"name", Value(std::string("table-file"))},
+                {"label", Value(std::string("Table Files"))},
+                {"type", Value(std::string("table-file-manager"))},
+                {"category", Value(std::string("table-file-manager"))}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "available") {
+            return Ok(Dict{
+                {"name", Value(std::string("available"))},
+                {"label", Value(std::string("Supported Formats"))},
+                {"type", Value(std::string("folder"))},
+                {"category", Value(std::string("folder"))}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            return Ok(Dict{
+                {"name", Value(std::string("opened"))},
+                {"label", Value(std::string("Opened Tables"))},
+                {"type", Value(std::string("folder"))},
+                {"category", Value(std::string("folder"))}
+            });
+        }
+
+        if (parts.size() < 2 || parts.size() > 3 || parts[0] != "opened") {
+            return Ok(Dict{});
+        }
+
+        auto file = _find(parts[1]);
+        if (!file) return Ok(Dict{});
+
+        if (parts.size() == 2) {
+            List columns;
+            for (const auto& column : file->columns()) columns.push_back(Value(column.name));
+            return Ok(Dict{
+                {"name", Value(parts[1])},
+                {"label", Value(fs::path(file->path()).filename().string())},
+                {"type", Value(std::string("table-file"))},
+                {"category", Value(std::string("table"))},
+                {"filepath", Value(file->path())},
+                {"format", Value(file->format_name())},
+                {"bytes", Value(static_cast<int64_t>(file->size_bytes()))},
+                {"rows", Value(static_cast<int64_t>(file->num_rows()))},
+                {"chunks", Value(static_cast<int64_t>(file->num_chunks()))},
+                {"columns", Value(columns)}
+            });
+        }
+
+        auto index = file->column_index(parts[2]);
+        if (!index) return Ok(Dict{});
+        const auto& column = file->columns()[*index];
+        return Ok(Dict{
+            {"name", Value(column.name)},
+            {"label", Value(column.name)},
+            {"type", Value(std::string("table-column"))},
+            {"category", Value(std::string("table-column"))},
+            {"dtype", Value(std::string(column.type ? NumericArray::type_name(*column.type) : "text"))},
+            {"index", Value(static_cast<int64_t>(*index))},
+            {"rows", Value(static_cast<int64_t>(file->num_rows()))}
+        });
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.size() == 3 && parts[0] == "opened") {
+            if (auto file = _find(parts[1])) {
+                std::vector<size_t> f;
+                if (parse_index_query(parts[2], "rows", f)) {
+                    if (f.size() != 2) return Err<Value>("TableFileManager: expected rows:<begin>:<count>");
+                    auto res = file->read_rows(f[0], f[1]);
+                    if (!res) return Err<Value>("TableFileManager: rows query failed", res);
+                    return Ok(Value(*res));
+                }
+                if (parse_index_query(parts[2], "row", f)) {
+                    if (f.size() != 1) return Err<Value>("TableFileManager: expected row:<n>");
+                    auto res = file->row_text(f[0]);
+                    if (!res) return Err<Value>("TableFileManager: row query failed", res);
+                    List cells;
+                    cells.reserve(res->size());
+                    for (auto& cell : *res) cells.push_back(Value(std::move(cell)));
+                    return Ok(Value(cells));
+                }
+            }
+        }
+
+        if (parts.size() == 4 && parts[0] == "opened" && parts[3] == "data") {
+            if (auto file = _find(parts[1])) {
+                if (auto index = file->column_index(parts[2])) {
+                    auto res = file->column(*index);
+                    if (!res) return Err<Value>("TableFileManager: cannot read column", res);
+                    return Ok(Value(*res));
+                }
+            }
+        }
+
+        auto meta_res = get_metadata(path.dirname());
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(path.filename());
+        return Ok(it != meta_res->end() ? it->second : Value{});
+    }
+
+    Result<void> set(const DataPath&, const Value&) override {
+        return Err<void>("TableFileManager: set not implemented");
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string&, const Dict& data) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "opened") {
+            return Err<void>("TableFileManager: add_child only supported on /opened");
+        }
+
+        std::string filepath;
+        if (auto it = data.find("filepath"); it != data.end()) {
+            if (auto fp = get_as<std::string>(it->second)) filepath = *fp;
+        }
+        if (filepath.empty()) {
+            return Err<void>("TableFileManager: add_child needs 'filepath'");
+        }
+
+        TableFileOptions options;
+        if (auto it = data.find("delimiter"); it != data.end()) {
+            if (auto d = get_as<std::string>(it->second); d && !d->empty()) {
+                options.delimiter = *d == "\\t" ? '\t' : (*d)[0];
+            }
+        }
+        if (auto it = data.find("header"); it != data.end()) {
+            if (auto h = get_as<bool>(it->second)) options.header = *h;
+        }
+
+        auto res = open_file(filepath, options);
+        if (!res) return Err<void>("add_child failed", res);
+        return Ok();
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int) override {
+        return Ok(path.to_string());
+    }
+
+    ~TableFileManager() {
+        dispose();
+    }
+
+private:
+    TableFilePtr _find(const std::string& id) const {
+        int num = 0;
+        auto [ptr, ec] = std::from_chars(id.data(), id.data() + id.size(), num);
+        if (ec != std::errc{} || ptr != id.data() + id.size()) return nullptr;
+        auto it = _file_ids.find(num);
+        if (it == _file_ids.end()) return nullptr;
+        auto f = _files.find(it->second);
+        return f != _files.end() ? f->second : nullptr;
+    }
+
+    std::map<std::string, TableFilePtr> _files;
+    std::map<int, std::string> _file_ids;
+    int _next_id = 1;
+};
+
+namespace embedded {
+    Result<TreeLikePtr> create_table_file_manager() {
+        return TableFileManager::create();
+    }
+}
+
+} // namespace ymery
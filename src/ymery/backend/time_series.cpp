@@ -0,0 +1,285 @@
+// Time series store implementation
+#include "time_series.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ymery {
+
+TimeSeries::Chunk::Chunk(size_t rows, size_t columns)
+    : time(new double[rows])
+    , values(new double[rows * columns])
+    , ready(new std::atomic<uint8_t>[rows]())
+{
+}
+
+Result<TimeSeriesPtr> TimeSeries::create(const TimeSeriesConfig& config) {
+    if (config.columns.empty()) {
+        return Err<TimeSeriesPtr>("TimeSeries::create: at least one column required");
+    }
+    for (size_t i = 0; i < config.columns.size(); ++i) {
+        if (config.columns[i].empty() || config.columns[i] == "time") {
+            return Err<TimeSeriesPtr>("TimeSeries::create: invalid column name '" + config.columns[i] + "'");
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (config.columns[i] == config.columns[j]) {
+                return Err<TimeSeriesPtr>("TimeSeries::create: duplicate column '" + config.columns[i] + "'");
+            }
+        }
+    }
+    if (config.chunk_rows == 0 || config.max_rows == 0) {
+        return Err<TimeSeriesPtr>("TimeSeries::create: chunk-rows and max-rows must be positive");
+    }
+    return TimeSeriesPtr(new TimeSeries(config));
+}
+
+TimeSeries::TimeSeries(const TimeSeriesConfig& config)
+    : _config(config)
+    , _max_chunks((config.max_rows + config.chunk_rows - 1) / config.chunk_rows)
+    , _chunks(new std::atomic<Chunk*>[_max_chunks]())
+{
+}
+
+TimeSeries::~TimeSeries() {
+    for (size_t i = 0; i < _max_chunks; ++i) {
+        delete _chunks[i].load(std::memory_order_relaxed);
+    }
+}
+
+TimeSeries::Chunk* TimeSeries::_chunk_for_write(size_t chunk) {
+    Chunk* current = _chunks[chunk].load(std::memory_order_acquire);
+    if (current) return current;
+
+    // First writer into this chunk installs it; a losing racer frees its copy
+    auto* fresh = new Chunk(_config.chunk_rows, _config.columns.size());
+    if (_chunks[chunk].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+        return fresh;
+    }
+    delete fresh;
+    return current;
+}
+
+bool TimeSeries::append(double time, std::span<const double> values) {
+    if (values.size() != _config.columns.size()) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    size_t row = _reserved.fetch_add(1, std::memory_order_relaxed);
+    if (row >= capacity()) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const size_t rows = _config.chunk_rows;
+    Chunk* chunk = _chunk_for_write(row / rows);
+    size_t r = row % rows;
+    chunk->time[r] = time;
+    for (size_t c = 0; c < values.size(); ++c) {
+        chunk->values[c * rows + r] = values[c];
+    }
+    // seq_cst on both sides: a release store followed by the acquire loads
+    // in _publish() may be reordered, so this writer could read the old
+    // head while the head's owner misses this flag, and the row would stay
+    // unpublished until some later append
+    chunk->ready[r].store(1, std::memory_order_seq_cst);
+
+    _publish();
+    return true;
+}
+
+void TimeSeries::_publish() {
+    // Advance the published prefix over every completed row. Whoever completes
+    // the row at the head carries the rows finished out of order behind it.
+    const size_t rows = _config.chunk_rows;
+    size_t head = _published.load(std::memory_order_seq_cst);
+    while (head < capacity()) {
+        const Chunk* chunk = _chunk(head / rows);
+        if (!chunk || !chunk->ready[head % rows].load(std::memory_order_seq_cst)) break;
+        if (_published.compare_exchange_weak(head, head + 1, std::memory_order_seq_cst)) {
+            ++head;
+        }
+    }
+}
+
+size_t TimeSeries::num_chunks() const {
+    return (size() + _config.chunk_rows - 1) / _config.chunk_rows;
+}
+
+std::optional<size_t> TimeSeries::column_index(std::string_view name) const {
+    for (size_t i = 0; i < _config.columns.size(); ++i) {
+        if (_config.columns[i] == name) return i;
+    }
+    return std::nullopt;
+}
+
+double TimeSeries::_time_at(size_t row) const {
+    return _chunk(row / _config.chunk_rows)->time[row % _config.chunk_rows];
+}
+
+double TimeSeries::_value_at(size_t column, size_t row) const {
+    const size_t rows = _config.chunk_rows;
+    return _chunk(row / rows)->values[column * rows + row % rows];
+}
+
+size_t TimeSeries::_lower_row(double t, size_t published) const {
+    size_t lo = 0, hi = published;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_time_at(mid) < t) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+size_t TimeSeries::_upper_row(double t, size_t published) const {
+    size_t lo = 0, hi = published;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_time_at(mid) <= t) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+const std::vector<TimeSeries::Stat>& TimeSeries::_stats(const Chunk& chunk) const {
+    std::call_once(chunk.stats_once, [&] {
+        const size_t rows = _config.chunk_rows;
+        chunk.stats.resize(_config.columns.size());
+        for (size_t c = 0; c < _config.columns.size(); ++c) {
+            const double* v = chunk.values.get() + c * rows;
+            Stat s{v[0], v[0], 0, 0};
+            for (size_t r = 1; r < rows; ++r) {
+                if (v[r] < s.min) { s.min = v[r]; s.min_row = r; }
+                if (v[r] > s.max) { s.max = v[r]; s.max_row = r; }
+            }
+            chunk.stats[c] = s;
+        }
+    });
+    return chunk.stats;
+}
+
+TimeSeries::Stat TimeSeries::_scan(size_t column, size_t begin, size_t end) const {
+    const size_t rows = _config.chunk_rows;
+    Stat result{_value_at(column, begin), _value_at(column, begin), begin, begin};
+
+    size_t row = begin;
+    while (row < end) {
+        size_t index = row / rows;
+        size_t chunk_begin = index * rows;
+        size_t chunk_end = chunk_begin + rows;
+        const Chunk* chunk = _chunk(index);
+
+        if (row == chunk_begin && chunk_end <= end) {
+            // Whole published chunk inside the window - its index answers it
+            const Stat& s = _stats(*chunk)[column];
+            if (s.min < result.min) { result.min = s.min; result.min_row = chunk_begin + s.min_row; }
+            if (s.max > result.max) { result.max = s.max; result.max_row = chunk_begin + s.max_row; }
+            row = chunk_end;
+            continue;
+        }
+
+        size_t stop = std::min(end, chunk_end);
+        const double* v = chunk->values.get() + column * rows;
+        for (; row < stop; ++row) {
+            double x = v[row - chunk_begin];
+            if (x < result.min) { result.min = x; result.min_row = row; }
+            if (x > result.max) { result.max = x; result.max_row = row; }
+        }
+    }
+    return result;
+}
+
+std::optional<ValueRange> TimeSeries::time_range() const {
+    size_t published = size();
+    if (published == 0) return std::nullopt;
+    return ValueRange{_time_at(0), _time_at(published - 1)};
+}
+
+std::optional<ValueRange> TimeSeries::value_range(size_t column, double t0, double t1) const {
+    if (column >= num_columns()) return std::nullopt;
+    size_t published = size();
+    size_t begin = _lower_row(t0, published);
+    size_t end = _upper_row(t1, published);
+    if (begin >= end) return std::nullopt;
+    auto s = _scan(column, begin, end);
+    return ValueRange{s.min, s.max};
+}
+
+Result<NumericArrayPtr> TimeSeries::range(size_t column, double t0, double t1) const {
+    if (column >= num_columns()) {
+        return Err<NumericArrayPtr>("TimeSeries::range: column out of range");
+    }
+    size_t published = size();
+    size_t begin = _lower_row(t0, published);
+    return _rows(column, begin, std::max(begin, _upper_row(t1, published)));
+}
+
+Result<NumericArrayPtr> TimeSeries::_rows(size_t column, size_t begin, size_t end) const {
+    size_t n = end - begin;
+
+    // Copy chunk segments straight into the time and value rows
+    const size_t rows = _config.chunk_rows;
+    std::vector<double> out(2 * n);
+    size_t row = begin;
+    while (row < end) {
+        size_t index = row / rows;
+        size_t offset = row - index * rows;
+        size_t count = std::min(end - row, rows - offset);
+        const Chunk* chunk = _chunk(index);
+        std::memcpy(out.data() + (row - begin), chunk->time.get() + offset, count * sizeof(double));
+        std::memcpy(out.data() + n + (row - begin), chunk->values.get() + column * rows + offset,
+                    count * sizeof(double));
+        row += count;
+    }
+    return NumericArray::create(std::move(out), {2, n});
+}
+
+Result<NumericArrayPtr> TimeSeries::decimated(size_t column, double t0, double t1, size_t max_points) const {
+    if (column >= num_columns()) {
+        return Err<NumericArrayPtr>("TimeSeries::decimated: column out of range");
+    }
+    if (max_points < 2) {
+        // A bucket yields its min and max, so fewer than two points cannot hold one
+        return Err<NumericArrayPtr>("TimeSeries::decimated: max_points must be at least 2");
+    }
+    size_t published = size();
+    size_t begin = _lower_row(t0, published);
+    size_t end = std::max(begin, _upper_row(t1, published));
+    size_t n = end - begin;
+    if (n <= max_points) {
+        // The same snapshot as the bucket path - rows published since stay out
+        return _rows(column, begin, end);
+    }
+
+    size_t buckets = max_points / 2;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    xs.reserve(max_points);
+    ys.reserve(max_points);
+
+    auto emit = [&](size_t row, double value) {
+        xs.push_back(_time_at(row));
+        ys.push_back(value);
+    };
+
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t bucket_begin = begin + n * b / buckets;
+        size_t bucket_end = begin + n * (b + 1) / buckets;
+        if (bucket_begin >= bucket_end) continue;
+
+        auto s = _scan(column, bucket_begin, bucket_end);
+        if (s.min_row == s.max_row) {
+            emit(s.min_row, s.min);
+        } else if (s.min_row < s.max_row) {
+            emit(s.min_row, s.min);
+            emit(s.max_row, s.max);
+        } else {
+            emit(s.max_row, s.max);
+            emit(s.min_row, s.min);
+        }
+    }
+
+    size_t m = xs.size();
+    xs.insert(xs.end(), ys.begin(), ys.end());
+    return NumericArray::create(std::move(xs), {2, m});
+}
+
+} // namespace ymery
@@ -0,0 +1,129 @@
+// Time series store - columnar append-only chunks with per-chunk indexes
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ymery {
+
+class TimeSeries;
+using TimeSeriesPtr = std::shared_ptr<TimeSeries>;
+
+struct TimeSeriesConfig {
+    std::vector<std::string> columns;   // value columns; time is implicit
+    size_t chunk_rows = 4096;           // rows per chunk
+    size_t max_rows = size_t(1) << 24;  // capacity; appends beyond it are dropped
+};
+
+struct ValueRange {
+    double min = 0.0;
+    double max = 0.0;
+};
+
+/**
+ * TimeSeries - a time column plus N value columns stored in fixed-size
+ * chunks that are allocated on demand and never move or shrink.
+ *
+ * Producers append from any number of threads without locks: a row is
+ * reserved with one fetch_add, written in place and then published. Readers
+ * only see the contiguous prefix of completed rows (size()), so a query never
+ * observes a half-written row.
+ *
+ * Once a chunk is full its min/max per column is computed once and kept, so
+ * range bounds and decimation over long windows touch whole chunks instead of
+ * rows. Queries binary-search on time, which requires time to be
+ * non-decreasing in row order - with several producers the caller has to
+ * provide that ordering (e.g. one producer per series).
+ */
+class TimeSeries {
+public:
+    static Result<TimeSeriesPtr> create(const TimeSeriesConfig& config);
+    ~TimeSeries();
+
+    TimeSeries(const TimeSeries&) = delete;
+    TimeSeries& operator=(const TimeSeries&) = delete;
+
+    // Producer side - lock-free. `values` holds one value per column.
+    // Returns false (and counts a drop) when full or on a size mismatch.
+    bool append(double time, std::span<const double> values);
+
+    // Reader side
+    size_t size() const { return _published.load(std::memory_order_acquire); }
+    size_t capacity() const { return _max_chunks * _config.chunk_rows; }
+    size_t num_chunks() const;
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+    const TimeSeriesConfig& config() const { return _config; }
+    size_t num_columns() const { return _config.columns.size(); }
+    std::optional<size_t> column_index(std::string_view name) const;
+
+    // Time of the first and last published rows (nullopt when empty)
+    std::optional<ValueRange> time_range() const;
+    // Min/max of a column over t0 <= time <= t1 (nullopt when no rows match)
+    std::optional<ValueRange> value_range(size_t column, double t0, double t1) const;
+
+    // Rows with t0 <= time <= t1 as a [2, n] f64 array: time row, value row
+    Result<NumericArrayPtr> range(size_t column, double t0, double t1) const;
+    // The same window reduced to at most max_points points. Each bucket keeps
+    // its min and max in time order, so peaks survive decimation. max_points
+    // must be at least 2.
+    Result<NumericArrayPtr> decimated(size_t column, double t0, double t1, size_t max_points) const;
+
+private:
+    struct Stat {
+        double min;
+        double max;
+        size_t min_row;  // within the chunk for chunk stats, absolute for scans
+        size_t max_row;
+    };
+
+    struct Chunk {
+        Chunk(size_t rows, size_t columns);
+
+        std::unique_ptr<double[]> time;
+        std::unique_ptr<double[]> values;  // column-major: values[c * rows + r]
+        std::unique_ptr<std::atomic<uint8_t>[]> ready;
+
+        // Filled once, by the first reader that sees the chunk full
+        mutable std::once_flag stats_once;
+        mutable std::vector<Stat> stats;
+    };
+
+    explicit TimeSeries(const TimeSeriesConfig& config);
+
+    Chunk* _chunk_for_write(size_t chunk);
+    const Chunk* _chunk(size_t chunk) const {
+        return _chunks[chunk].load(std::memory_order_acquire);
+    }
+    double _time_at(size_t row) const;
+    double _value_at(size_t column, size_t row) const;
+    void _publish();
+
+    // First published row with time >= t (lower) or time > t (upper)
+    size_t _lower_row(double t, size_t published) const;
+    size_t _upper_row(double t, size_t published) const;
+
+    // Time and value rows [begin, end) of one column as a {2, n} array
+    Result<NumericArrayPtr> _rows(size_t column, size_t begin, size_t end) const;
+
+    const std::vector<Stat>& _stats(const Chunk& chunk) const;
+    // Min/max over rows [begin, end), using chunk stats for full chunks
+    Stat _scan(size_t column, size_t begin, size_t end) const;
+
+    TimeSeriesConfig _config;
+    size_t _max_chunks = 0;
+    std::unique_ptr<std::atomic<Chunk*>[]> _chunks;
+
+    std::atomic<size_t> _reserved{0};
+    std::atomic<size_t> _published{0};
+    std::atomic<uint64_t> _dropped{0};
+};
+
+} // namespace ymery
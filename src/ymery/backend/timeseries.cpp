@@ -0,0 +1,289 @@
+// timeseries - columnar time series with range and decimated queries
+#include "../types.hpp"
+#include "../result.hpp"
+#include "time_series.hpp"
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery {
+
+namespace {
+
+// Parse "<kind>:<a>:<b>[:<c>]" query keys into their numeric fields
+bool parse_query(const std::string& key, std::string_view kind, std::vector<double>& fields) {
+    if (key.size() <= kind.size() || key.compare(0, kind.size(), kind) != 0 || key[kind.size()] != ':') {
+        return false;
+    }
+    fields.clear();
+    const char* p = key.data() + kind.size() + 1;
+    const char* end = key.data() + key.size();
+    while (p <= end) {
+        const char* sep = std::find(p, end, ':');
+        double v = 0.0;
+        auto [ptr, ec] = std::from_chars(p, sep, v);
+        if (ec != std::errc{} || ptr != sep) return false;
+        fields.push_back(v);
+        p = sep + 1;
+    }
+    return true;
+}
+
+std::optional<size_t> get_size(const Dict& data, const std::string& key) {
+    auto it = data.find(key);
+    if (it == data.end()) return std::nullopt;
+    if (auto v = get_as<int>(it->second); v && *v > 0) return static_cast<size_t>(*v);
+    if (auto v = get_as<int64_t>(it->second); v && *v > 0) return static_cast<size_t>(*v);
+    return std::nullopt;
+}
+
+} // namespace
+
+/**
+ * TimeSeriesManager - named time series stores, implements TreeLike
+ * Tree structure:
+ *   /opened - list series
+ *   /opened/<series> - row/chunk counters and time bounds; "series" holds
+ *                      the TimeSeriesPtr for producer threads
+ *   /opened/<series>/<column> - column metadata (category "timeseries-column")
+ *   /opened/<series>/<column>/range:<t0>:<t1> - rows in [t0, t1] as a [2, n] array
+ *   /opened/<series>/<column>/decimated:<t0>:<t1>:<n> - at most n >= 2 points (min/max per bucket)
+ *   /opened/<series>/append - set a [time, v1, v2, ...] list to append one row
+ *
+ * New series are added with add_child("/opened", name, {...}) where the data
+ * carries "columns" (list of names) and optionally "chunk-rows" and "max-rows".
+ * The query arrays plot directly with implot.line.
+ */
+class TimeSeriesManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<TimeSeriesManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("TimeSeriesManager::create failed", res);
+        }
+        return manager;
+    }
+
+    Result<void> dispose() override {
+        _series.clear();
+        return Ok();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(std::vector<std::string>{"opened"});
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            std::vector<std::string> children;
+            for (const auto& [name, _] : _series) {
+                children.push_back(name);
+            }
+            return Ok(children);
+        }
+
+        if (parts.size() == 2 && parts[0] == "opened") {
+            auto it = _series.find(parts[1]);
+            if (it == _series.end()) return Ok(std::vector<std::string>{});
+            return Ok(it->second->config().columns);
+        }
+
+        return Ok(std::vector<std::string>{});
+    }
+
+    Result<Dict> get_metadata(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        if (parts.empty()) {
+            return Ok(Dict{
+                {"name", Value(std::string("timeseries"))},
+                {"label", Value(std::string("Time Series"))},
+                {"type", Value(std::string("timeseries-manager"))},
+                {"category", Value(std::string("timeseries-manager"))}
+            });
+        }
+
+        if (parts.size() == 1 && parts[0] == "opened") {
+            return Ok(Dict{
+                {"name", Value(std::string("opened"))},
+                {"label", Value(std::string("Series"))},
+                {"type", Value(std::string("folder"))},
+                {"category", Value(std::string("folder"))}
+            });
+        }
+
+        if (parts.size() < 2 || parts.size() > 3 || parts[0] != "opened") {
+            return Ok(Dict{});
+        }
+
+        auto it = _series.find(parts[1]);
+        if (it == _series.end()) return Ok(Dict{});
+        const auto& series = it->second;
+        auto times = series->time_range();
+
+        if (parts.size() == 2) {
+            List columns;
+            for (const auto& c : series->config().columns) columns.push_back(Value(c));
+            Dict meta{
+                {"name", Value(parts[1])},
+                {"label", Value(parts[1])},
+                {"type", Value(std::string("timeseries"))},
+                {"category", Value(std::string("timeseries"))},
+                {"series", Value(series)},
+                {"columns", Value(columns)},
+                {"rows", Value(static_cast<int64_t>(series->size()))},
+                {"chunks", Value(static_cast<int64_t>(series->num_chunks()))},
+                {"chunk-rows", Value(static_cast<int64_t>(series->config().chunk_rows))},
+                {"capacity", Value(static_cast<int64_t>(series->capacity()))},
+                {"dropped", Value(static_cast<int64_t>(series->dropped()))}
+            };
+            if (times) {
+                meta["t-min"] = Value(times->min);
+                meta["t-max"] = Value(times->max);
+            }
+            return Ok(meta);
+        }
+
+        auto column = series->column_index(parts[2]);
+        if (!column) return Ok(Dict{});
+        Dict meta{
+            {"name", Value(parts[2])},
+            {"label", Value(parts[1] + "/" + parts[2])},
+            {"type", Value(std::string("timeseries-column"))},
+            {"category", Value(std::string("timeseries-column"))},
+            {"rows", Value(static_cast<int64_t>(series->size()))}
+        };
+        if (times) {
+            meta["t-min"] = Value(times->min);
+            meta["t-max"] = Value(times->max);
+            if (auto values = series->value_range(*column, times->min, times->max)) {
+                meta["min"] = Value(values->min);
+                meta["max"] = Value(values->max);
+            }
+        }
+        return Ok(meta);
+    }
+
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
+        auto res = get_metadata(path);
+        if (!res) return Err<std::vector<std::string>>("get_metadata_keys failed", res);
+        std::vector<std::string> keys;
+        for (const auto& [k, _] : *res) keys.push_back(k);
+        return Ok(keys);
+    }
+
+    Result<Value> get(const DataPath& path) override {
+        const auto& parts = path.as_list();
+
+        // Queries on /opened/<series>/<column>/<query>
+        if (parts.size() == 4 && parts[0] == "opened") {
+            auto it = _series.find(parts[1]);
+            if (it != _series.end()) {
+                if (auto column = it->second->column_index(parts[2])) {
+                    std::vector<double> f;
+                    if (parse_query(parts[3], "range", f)) {
+                        if (f.size() != 2) {
+                            return Err<Value>("TimeSeriesManager: expected range:<t0>:<t1>");
+                        }
+                        auto res = it->second->range(*column, f[0], f[1]);
+                        if (!res) return Err<Value>("TimeSeriesManager: range query failed", res);
+                        return Ok(Value(*res));
+                    }
+                    if (parse_query(parts[3], "decimated", f)) {
+                        if (f.size() != 3 || f[2] < 2) {
+                            return Err<Value>("TimeSeriesManager: expected decimated:<t0>:<t1>:<points>");
+                        }
+                        auto res = it->second->decimated(*column, f[0], f[1], static_cast<size_t>(f[2]));
+                        if (!res) return Err<Value>("TimeSeriesManager: decimated query failed", res);
+                        return Ok(Value(*res));
+                    }
+                }
+            }
+        }
+
+        auto meta_res = get_metadata(path.dirname());
+        if (!meta_res) return Err<Value>("get failed", meta_res);
+        auto it = meta_res->find(path.filename());
+        if (it != meta_res->end()) return Ok(it->second);
+        return Ok(Value{});
+    }
+
+    Result<void> set(const DataPath& path, const Value& value) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 3 || parts[0] != "opened" || parts[2] != "append") {
+            return Err<void>("TimeSeriesManager: set only supports /opened/<name>/append");
+        }
+
+        auto it = _series.find(parts[1]);
+        if (it == _series.end()) {
+            return Err<void>("TimeSeriesManager: no series named '" + parts[1] + "'");
+        }
+
+        auto row = as_numeric_array(value);
+        if (!row || row->size() < 2) {
+            return Err<void>("TimeSeriesManager: append expects [time, value, ...]");
+        }
+        std::vector<double> values(row->size() - 1);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = row->at(i + 1);
+        }
+        if (!it->second->append(row->at(0), values)) {
+            return Err<void>("TimeSeriesManager: append to '" + parts[1] + "' dropped");
+        }
+        return Ok();
+    }
+
+    Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "opened") {
+            return Err<void>("TimeSeriesManager: add_child only supported on /opened");
+        }
+        if (name.empty()) {
+            return Err<void>("TimeSeriesManager: series name required");
+        }
+        if (_series.count(name)) {
+            return Err<void>("TimeSeriesManager: series '" + name + "' already exists");
+        }
+
+        TimeSeriesConfig config;
+        if (auto it = data.find("columns"); it != data.end()) {
+            if (auto list = get_as<List>(it->second)) {
+                for (const auto& item : *list) {
+                    if (auto c = get_as<std::string>(item)) config.columns.push_back(*c);
+                }
+            }
+        }
+        if (auto v = get_size(data, "chunk-rows")) config.chunk_rows = *v;
+        if (auto v = get_size(data, "max-rows")) config.max_rows = *v;
+
+        auto series_res = TimeSeries::create(config);
+        if (!series_res) {
+            return Err<void>("TimeSeriesManager: failed to create series '" + name + "'", series_res);
+        }
+        _series[name] = *series_res;
+        ydebug("TimeSeriesManager: created '{}' with {} columns", name, config.columns.size());
+        return Ok();
+    }
+
+    Result<std::string> as_tree(const DataPath& path, int depth) override {
+        return Ok(path.to_string());
+    }
+
+    ~TimeSeriesManager() {
+        dispose();
+    }
+
+private:
+    std::map<std::string, TimeSeriesPtr> _series;
+};
+
+namespace embedded {
+    Result<TreeLikePtr> create_timeseries_manager() {
+        return TimeSeriesManager::create();
+    }
+}
+
+} // namespace ymery
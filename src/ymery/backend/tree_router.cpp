@@ -0,0 +1,198 @@
+// Tree router implementation
+#include "tree_router.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace ymery {
+
+namespace {
+
+enum class SegmentKind { Literal, Capture, Index, Rest };
+
+struct Segment {
+    SegmentKind kind;
+    std::string_view text;  // literal text or capture name
+};
+
+Result<Segment> parse_segment(std::string_view segment) {
+    if (segment.empty()) {
+        return Err<Segment>("empty segment");
+    }
+    if (segment.front() != '{') {
+        if (segment.find_first_of("{}") != std::string_view::npos) {
+            return Err<Segment>("braces inside literal '" + std::string(segment) + "'");
+        }
+        return Segment{SegmentKind::Literal, segment};
+    }
+    if (segment.back() != '}' || segment.size() < 3) {
+        return Err<Segment>("malformed capture '" + std::string(segment) + "'");
+    }
+    std::string_view name = segment.substr(1, segment.size() - 2);
+    if (name.ends_with("...")) {
+        return Segment{SegmentKind::Rest, name.substr(0, name.size() - 3)};
+    }
+    if (auto colon = name.find(':'); colon != std::string_view::npos) {
+        if (name.substr(colon + 1) != "index") {
+            return Err<Segment>("unknown capture type in '" + std::string(segment) + "'");
+        }
+        return Segment{SegmentKind::Index, name.substr(0, colon)};
+    }
+    return Segment{SegmentKind::Capture, name};
+}
+
+bool parse_index(const std::string& segment, size_t& value) {
+    if (segment.empty()) return false;
+    auto [end, ec] = std::from_chars(segment.data(), segment.data() + segment.size(), value);
+    return ec == std::errc{} && end == segment.data() + segment.size();
+}
+
+} // namespace
+
+int32_t TreeRouter::_child(int32_t& slot) {
+    if (slot == NONE) {
+        slot = static_cast<int32_t>(_nodes.size());
+        // slot may live in _nodes: read it before the push can move it
+        int32_t created = slot;
+        _nodes.emplace_back();
+        return created;
+    }
+    return slot;
+}
+
+Result<void> TreeRouter::add(std::string_view pattern, Route route) {
+    if (!pattern.starts_with('/')) {
+        return Err<void>("TreeRouter: pattern '" + std::string(pattern) + "' must be absolute");
+    }
+
+    int32_t node = 0;
+    size_t captures = 0;
+    std::string_view remaining = pattern.substr(1);
+    while (!remaining.empty()) {
+        auto slash = remaining.find('/');
+        std::string_view text = remaining.substr(0, slash);
+        remaining = slash == std::string_view::npos ? std::string_view{} : remaining.substr(slash + 1);
+
+        auto segment_res = parse_segment(text);
+        if (!segment_res) {
+            return Err<void>("TreeRouter: bad pattern '" + std::string(pattern) + "'", segment_res);
+        }
+        const Segment segment = *segment_res;
+
+        switch (segment.kind) {
+            case SegmentKind::Literal: {
+                auto& literals = _nodes[node].literals;
+                auto it = std::lower_bound(literals.begin(), literals.end(), segment.text,
+                    [](const auto& entry, std::string_view text) { return entry.first < text; });
+                if (it != literals.end() && it->first == segment.text) {
+                    node = it->second;
+                } else {
+                    int32_t next = static_cast<int32_t>(_nodes.size());
+                    literals.insert(it, {std::string(segment.text), next});
+                    _nodes.emplace_back();
+                    node = next;
+                }
+                break;
+            }
+            case SegmentKind::Capture:
+            case SegmentKind::Index: {
+                if (++captures > RouteMatch::MAX_CAPTURES) {
+                    return Err<void>("TreeRouter: too many captures in '" + std::string(pattern) + "'");
+                }
+                auto& slot = segment.kind == SegmentKind::Index ? _nodes[node].index : _nodes[node].capture;
+                node = _child(slot);
+                break;
+            }
+            case SegmentKind::Rest:
+                if (!remaining.empty()) {
+                    return Err<void>("TreeRouter: '" + std::string(text) + "' must end pattern '" +
+                                     std::string(pattern) + "'");
+                }
+                node = _child(_nodes[node].rest);
+                break;
+        }
+    }
+
+    if (_nodes[node].route != NONE) {
+        return Err<void>("TreeRouter: pattern '" + std::string(pattern) + "' declared twice");
+    }
+    _nodes[node].route = static_cast<int32_t>(_routes.size());
+    _routes.push_back(std::move(route));
+    return Ok();
+}
+
+bool TreeRouter::_match(int32_t node_id, std::span<const std::string> parts, RouteMatch& match, int32_t& route) const {
+    const Node& node = _nodes[node_id];
+    if (parts.empty()) {
+        if (node.route != NONE) {
+            route = node.route;
+            match._rest = {};
+            return true;
+        }
+        // A rest capture also matches nothing
+        if (node.rest != NONE && _nodes[node.rest].route != NONE) {
+            route = _nodes[node.rest].route;
+            match._rest = {};
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& segment = parts.front();
+    const auto tail = parts.subspan(1);
+
+    if (!node.literals.empty()) {
+        auto it = std::lower_bound(node.literals.begin(), node.literals.end(), segment,
+            [](const auto& entry, const std::string& text) { return entry.first < text; });
+        if (it != node.literals.end() && it->first == segment && _match(it->second, tail, match, route)) {
+            return true;
+        }
+    }
+
+    const size_t count = match._count;
+    if (node.index != NONE && count < RouteMatch::MAX_CAPTURES) {
+        size_t value = 0;
+        if (parse_index(segment, value)) {
+            match._captures[count] = &segment;
+            match._indices[count] = value;
+            match._count = count + 1;
+            if (_match(node.index, tail, match, route)) return true;
+            match._count = count;
+        }
+    }
+    if (node.capture != NONE && count < RouteMatch::MAX_CAPTURES) {
+        match._captures[count] = &segment;
+        match._indices[count] = 0;
+        match._count = count + 1;
+        if (_match(node.capture, tail, match, route)) return true;
+        match._count = count;
+    }
+    if (node.rest != NONE && _nodes[node.rest].route != NONE) {
+        route = _nodes[node.rest].route;
+        match._rest = parts;
+        return true;
+    }
+    return false;
+}
+
+const TreeRouter::Route* TreeRouter::match(const DataPath& path, RouteMatch& match) const {
+    match = RouteMatch{};
+    int32_t route = NONE;
+    if (!_match(0, path.as_list(), match, route)) return nullptr;
+    return &_routes[route];
+}
+
+Result<std::vector<std::string>> TreeRouter::children(const DataPath& path) const {
+    RouteMatch m;
+    const Route* route = match(path, m);
+    if (!route || !route->children) return Ok(std::vector<std::string>{});
+    return route->children(m);
+}
+
+Result<Dict> TreeRouter::metadata(const DataPath& path) const {
+    RouteMatch m;
+    const Route* route = match(path, m);
+    if (!route || !route->metadata) return Ok(Dict{});
+    return route->metadata(m);
+}
+
+} // namespace ymery
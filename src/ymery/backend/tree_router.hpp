@@ -0,0 +1,99 @@
+// Tree router - declared path patterns for TreeLike providers
+#pragma once
+
+#include "../types.hpp"
+#include "../result.hpp"
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ymery {
+
+/**
+ * RouteMatch - what a route captured from a path
+ * Captures point into the matched DataPath, so nothing is copied and the
+ * match is only valid while that path lives. Captures are numbered in
+ * pattern order.
+ */
+class RouteMatch {
+public:
+    static constexpr size_t MAX_CAPTURES = 8;
+
+    size_t size() const { return _count; }
+    // Segment captured by the i-th {name} or {name:index}
+    const std::string& operator[](size_t i) const { return *_captures[i]; }
+    // Value of the i-th capture when declared {name:index}
+    size_t index(size_t i) const { return _indices[i]; }
+    // Segments captured by a trailing {name...}, possibly none
+    std::span<const std::string> rest() const { return _rest; }
+    std::vector<std::string> rest_list() const { return {_rest.begin(), _rest.end()}; }
+
+private:
+    friend class TreeRouter;
+
+    const std::string* _captures[MAX_CAPTURES] = {};
+    size_t _indices[MAX_CAPTURES] = {};
+    size_t _count = 0;
+    std::span<const std::string> _rest;
+};
+
+/**
+ * TreeRouter - dispatches TreeLike queries to handlers by path pattern
+ *
+ * Providers declare their tree once, usually in init():
+ *
+ *   _router.add("/opened/{device}/{channel:index}", {children, metadata});
+ *
+ * Patterns are compiled into a trie of segments. A segment is a literal,
+ * {name} (any one segment), {name:index} (a non-negative integer, parsed
+ * while matching) or, last, {name...} (all remaining segments, possibly
+ * none). Literals take precedence over captures, and captures over a rest
+ * capture, so "/opened/{device}/stats/{rest...}" and
+ * "/opened/{device}/{channel:index}" coexist. Matching walks one trie
+ * level per path component and does not allocate.
+ */
+class TreeRouter {
+public:
+    using ChildrenFn = std::function<Result<std::vector<std::string>>(const RouteMatch&)>;
+    using MetadataFn = std::function<Result<Dict>(const RouteMatch&)>;
+
+    // Either handler may be empty: no children, or no metadata
+    struct Route {
+        ChildrenFn children;
+        MetadataFn metadata;
+    };
+
+    // Fails on malformed patterns and on a pattern declared twice
+    Result<void> add(std::string_view pattern, Route route);
+
+    // The matching route, or nullptr; `match` holds its captures
+    const Route* match(const DataPath& path, RouteMatch& match) const;
+
+    // Dispatch helpers - unrouted paths have no children and no metadata
+    Result<std::vector<std::string>> children(const DataPath& path) const;
+    Result<Dict> metadata(const DataPath& path) const;
+
+    size_t num_routes() const { return _routes.size(); }
+
+private:
+    static constexpr int32_t NONE = -1;
+
+    struct Node {
+        std::vector<std::pair<std::string, int32_t>> literals;  // sorted by segment
+        int32_t capture = NONE;
+        int32_t index = NONE;
+        int32_t rest = NONE;
+        int32_t route = NONE;
+    };
+
+    bool _match(int32_t node, std::span<const std::string> parts, RouteMatch& match, int32_t& route) const;
+    int32_t _child(int32_t& slot);
+
+    std::vector<Node> _nodes{Node{}};
+    std::vector<Route> _routes;
+};
+
+} // namespace ymery
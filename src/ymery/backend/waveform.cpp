@@ -2,24 +2,26 @@
 #include "../types.hpp"
 #include "../result.hpp"
 #include "audio_buffer.hpp"
+#include "audio_stats.hpp"
+#include "io_thread.hpp"
+#include "oscillator.hpp"
+#include "tree_router.hpp"
+#include <algorithm>
 #include <map>
+#include <mutex>
 #include <thread>
 #include <atomic>
-#define _USE_MATH_DEFINES
-#include <cmath>
 #include <chrono>
 #include <ytrace/ytrace.hpp>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 namespace ymery {
 
 static const std::vector<std::string> WAVEFORM_TYPES = {"sine", "square", "triangle"};
 
 class WaveformDevice {
 public:
+    using Clock = std::chrono::steady_clock;
+
     static Result<std::shared_ptr<WaveformDevice>> create(
         const std::string& waveform_type,
         int sample_rate = 48000,
@@ -27,11 +29,18 @@ public:
         size_t period_size = 1024,
         size_t buffer_size = 48000
     ) {
+        auto kind_res = waveform_kind_from_string(waveform_type);
+        if (!kind_res) {
+            return Err<std::shared_ptr<WaveformDevice>>("WaveformDevice: invalid waveform", kind_res);
+        }
+
         auto device = std::make_shared<WaveformDevice>();
         device->_waveform_type = waveform_type;
         device->_sample_rate = sample_rate;
         device->_frequency = frequency;
         device->_period_size = period_size;
+        device->_buffer_size = buffer_size;
+        device->_oscillator = Oscillator(*kind_res, frequency, sample_rate);
 
         auto buffer_res = AudioRingBuffer::create(sample_rate, buffer_size, period_size);
         if (!buffer_res) {
@@ -50,233 +59,303 @@ public:
         return device;
     }
 
-    void start() {
-        if (_running) return;
+    // Anchor the device clock; period k is due at start + k * period_size / sample_rate
+    void start(Clock::time_point now) {
+        _start_time = now;
+        _periods_rendered = 0;
+        _next_deadline = now;
         _running = true;
-        _thread = std::thread(&WaveformDevice::_run, this);
     }
 
-    void stop() {
-        _running = false;
-        if (_thread.joinable()) {
-            _thread.join();
+    void stop() { _running = false; }
+
+    /**
+     * Render every period whose deadline has passed. Deadlines are derived
+     * from the absolute start time, so rounding and wakeup jitter never
+     * accumulate. If the device falls behind by more than its ring buffer
+     * the backlog is skipped and the clock re-anchored instead of bursting.
+     */
+    void tick(Clock::time_point now) {
+        if (!_running) return;
+
+        auto behind = now - _next_deadline;
+        if (behind > _period_duration(_buffer_size / std::max<size_t>(_period_size, 1))) {
+            ++_overruns;
+            _stats.record_xrun();
+            start(now);
+        }
+        if (now > _next_deadline) {
+            auto late_us = std::chrono::duration_cast<std::chrono::microseconds>(now - _next_deadline).count();
+            _max_lateness_us = std::max<int64_t>(_max_lateness_us, late_us);
+        }
+
+        while (_next_deadline <= now) {
+            auto scope = _stats.time_callback();
+            _oscillator.render(_sample_buffer.data(), _period_size);
+            _ring_buffer->write(_sample_buffer);
+            _frames_generated += _period_size;
+            ++_periods_rendered;
+            _next_deadline = _start_time + _period_duration(_periods_rendered);
         }
     }
 
+    Clock::time_point next_deadline() const { return _next_deadline; }
+
     bool is_running() const { return _running; }
     MediatedAudioBufferPtr get_buffer() const { return _mediated_buffer; }
     const std::string& waveform_type() const { return _waveform_type; }
     float frequency() const { return _frequency; }
     int sample_rate() const { return _sample_rate; }
 
-    ~WaveformDevice() {
-        stop();
-    }
+    uint64_t frames_generated() const { return _frames_generated; }
+    uint64_t overruns() const { return _overruns; }
+    int64_t max_lateness_us() const { return _max_lateness_us; }
 
-private:
-    void _run() {
-        while (_running) {
-            _generate_waveform();
-            _ring_buffer->write(_sample_buffer);
-
-            auto sleep_us = static_cast<int64_t>(_period_size * 1000000.0 / _sample_rate);
-            std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
-        }
-    }
+    const DeviceStats& stats() const { return _stats; }
+    const AudioRingBufferPtr& ring_buffer() const { return _ring_buffer; }
 
-    void _generate_waveform() {
-        float phase_increment = 2.0f * M_PI * _frequency / _sample_rate;
-
-        for (size_t i = 0; i < _period_size; ++i) {
-            float phase = _phase + i * phase_increment;
-
-            if (_waveform_type == "sine") {
-                _sample_buffer[i] = std::sin(phase);
-            } else if (_waveform_type == "square") {
-                _sample_buffer[i] = std::sin(phase) >= 0 ? 1.0f : -1.0f;
-            } else if (_waveform_type == "triangle") {
-                float t = std::fmod(phase / (2.0f * M_PI), 1.0f);
-                if (t < 0) t += 1.0f;
-                _sample_buffer[i] = 2.0f * std::abs(2.0f * t - 1.0f) - 1.0f;
-            }
-        }
-
-        _phase = std::fmod(_phase + _period_size * phase_increment, 2.0f * M_PI);
+private:
+    Clock::duration _period_duration(uint64_t periods) const {
+        auto ns = static_cast<int64_t>(
+            static_cast<double>(periods) * _period_size * 1e9 / _sample_rate);
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(ns));
     }
 
     std::string _waveform_type;
     int _sample_rate = 48000;
     float _frequency = 440.0f;
     size_t _period_size = 1024;
-    float _phase = 0.0f;
+    size_t _buffer_size = 48000;
+    Oscillator _oscillator;
 
     AudioRingBufferPtr _ring_buffer;
     MediatedAudioBufferPtr _mediated_buffer;
     std::vector<float> _sample_buffer;
 
+    Clock::time_point _start_time{};
+    Clock::time_point _next_deadline{};
+    uint64_t _periods_rendered = 0;
+
     std::atomic<bool> _running{false};
-    std::thread _thread;
+    std::atomic<uint64_t> _frames_generated{0};
+    std::atomic<uint64_t> _overruns{0};
+    std::atomic<int64_t> _max_lateness_us{0};
+    DeviceStats _stats;
 };
 
 using WaveformDevicePtr = std::shared_ptr<WaveformDevice>;
 
-class WaveformManager : public TreeLike {
+/**
+ * WaveformScheduler - drives any number of waveform devices from one thread
+ * Sleeps until the earliest device deadline, then ticks every device.
+ */
+class WaveformScheduler {
 public:
-    static Result<TreeLikePtr> create() {
-        auto manager = std::make_shared<WaveformManager>();
-        if (auto res = manager->init(); !res) {
-            return Err<TreeLikePtr>("WaveformManager::create failed", res);
-        }
-
-        // Auto-start all waveforms for demo
-        for (const auto& type : WAVEFORM_TYPES) {
-            auto device_res = WaveformDevice::create(type, 48000, 440.0f);
-            if (device_res) {
-                manager->_devices[type] = *device_res;
-                manager->_devices[type]->start();
-            }
-        }
-
-        return manager;
+    ~WaveformScheduler() {
+        stop();
     }
 
-    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
-        std::string path_str = path.to_string();
-        if (!path_str.empty() && path_str[0] != '/') {
-            path_str = "/" + path_str;
+    void add(const WaveformDevicePtr& device) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            device->start(WaveformDevice::Clock::now());
+            _devices.push_back(device);
         }
-
-        if (path_str == "/" || path_str.empty()) {
-            return Ok(std::vector<std::string>{"available", "opened"});
+        if (!_running) {
+            _running = true;
+            _thread.start("waveform-scheduler", std::chrono::nanoseconds(MAX_SLEEP).count(), [this] { _run(); });
         }
+    }
 
-        if (path_str == "/available") {
-            return Ok(WAVEFORM_TYPES);
+    void stop() {
+        _running = false;
+        _thread.join();
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& device : _devices) {
+            device->stop();
         }
+        _devices.clear();
+    }
 
-        for (const auto& type : WAVEFORM_TYPES) {
-            if (path_str == "/available/" + type) {
-                return Ok(std::vector<std::string>{"0"});
-            }
-        }
+private:
+    // Cap the sleep so stop() is honoured promptly; also the watchdog period
+    static constexpr auto MAX_SLEEP = std::chrono::milliseconds(20);
 
-        if (path_str == "/opened") {
-            std::vector<std::string> children;
-            for (const auto& [type, _] : _devices) {
-                children.push_back(type);
-            }
-            return Ok(children);
-        }
+    void _run() {
+        using Clock = WaveformDevice::Clock;
 
-        for (const auto& type : WAVEFORM_TYPES) {
-            if (path_str == "/opened/" + type) {
-                if (_devices.count(type)) {
-                    return Ok(std::vector<std::string>{"0"});
+        while (_running) {
+            _thread.beat();
+            auto now = Clock::now();
+            auto wake = now + MAX_SLEEP;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (auto& device : _devices) {
+                    device->tick(now);
+                    wake = std::min(wake, device->next_deadline());
                 }
             }
+            std::this_thread::sleep_until(wake);
         }
-
-        return Ok(std::vector<std::string>{});
     }
 
-    Result<Dict> get_metadata(const DataPath& path) override {
-        std::string path_str = path.to_string();
-        if (!path_str.empty() && path_str[0] != '/') {
-            path_str = "/" + path_str;
-        }
-
-        if (path_str == "/" || path_str.empty()) {
-            return Ok(Dict{
-                {"name", Value("waveform")},
-                {"label", Value("Waveform Generator")},
-                {"type", Value("waveform-manager")},
-                {"category", Value("audio-device-manager")}
-            });
-        }
-
-        if (path_str == "/available") {
-            return Ok(Dict{
-                {"name", Value("available")},
-                {"label", Value("Available")},
-                {"type", Value("folder")},
-                {"category", Value("folder")}
-            });
-        }
+    std::mutex _mutex;
+    std::vector<WaveformDevicePtr> _devices;
+    std::atomic<bool> _running{false};
+    IoThread _thread;
+};
 
-        if (path_str == "/opened") {
-            return Ok(Dict{
-                {"name", Value("opened")},
-                {"label", Value("Opened")},
-                {"type", Value("folder")},
-                {"category", Value("folder")}
-            });
+class WaveformManager : public TreeLike {
+public:
+    static Result<TreeLikePtr> create() {
+        auto manager = std::make_shared<WaveformManager>();
+        if (auto res = manager->init(); !res) {
+            return Err<TreeLikePtr>("WaveformManager::create failed", res);
         }
 
+        // Auto-start all waveforms for demo
         for (const auto& type : WAVEFORM_TYPES) {
-            if (path_str == "/available/" + type) {
-                return Ok(Dict{
-                    {"name", Value(type)},
-                    {"label", Value(type + " Wave")},
-                    {"type", Value("waveform-device")},
-                    {"category", Value("audio-device")},
-                    {"capabilities", Value(Dict{
-                        {"openable", Value(true)},
-                        {"readable", Value(true)},
-                        {"writable", Value(false)}
-                    })}
-                });
+            auto device_res = WaveformDevice::create(type, 48000, 440.0f);
+            if (device_res) {
+                manager->_devices[type] = *device_res;
+                manager->_scheduler.add(*device_res);
             }
         }
 
-        for (const auto& type : WAVEFORM_TYPES) {
-            if (path_str == "/available/" + type + "/0") {
-                return Ok(Dict{
-                    {"name", Value("0")},
-                    {"label", Value("Channel 0")},
-                    {"type", Value("audio-channel")},
-                    {"category", Value("audio-channel")},
-                    {"capabilities", Value(Dict{
-                        {"openable", Value(true)},
-                        {"readable", Value(true)},
-                        {"writable", Value(false)}
-                    })}
-                });
-            }
-        }
+        return manager;
+    }
 
-        for (const auto& type : WAVEFORM_TYPES) {
-            if (path_str == "/opened/" + type) {
-                auto it = _devices.find(type);
-                if (it != _devices.end()) {
-                    auto& device = it->second;
+    Result<void> init() override {
+        static const Dict ROOT{
+            {"name", Value("waveform")},
+            {"label", Value("Waveform Generator")},
+            {"type", Value("waveform-manager")},
+            {"category", Value("audio-device-manager")}
+        };
+        static const Dict AVAILABLE{
+            {"name", Value("available")},
+            {"label", Value("Available")},
+            {"type", Value("folder")},
+            {"category", Value("folder")}
+        };
+        static const Dict OPENED{
+            {"name", Value("opened")},
+            {"label", Value("Opened")},
+            {"type", Value("folder")},
+            {"category", Value("folder")}
+        };
+        auto none = [](const RouteMatch&) { return Ok(std::vector<std::string>{}); };
+
+        std::vector<std::pair<std::string_view, TreeRouter::Route>> routes = {
+            {"/", {
+                [](const RouteMatch&) { return Ok(std::vector<std::string>{"available", "opened"}); },
+                [](const RouteMatch&) { return Ok(ROOT); }
+            }},
+            {"/available", {
+                [](const RouteMatch&) { return Ok(WAVEFORM_TYPES); },
+                [](const RouteMatch&) { return Ok(AVAILABLE); }
+            }},
+            {"/available/{type}", {
+                [](const RouteMatch& m) {
+                    return Ok(_is_type(m[0]) ? std::vector<std::string>{"0"} : std::vector<std::string>{});
+                },
+                [](const RouteMatch& m) {
+                    if (!_is_type(m[0])) return Ok(Dict{});
                     return Ok(Dict{
-                        {"name", Value(type)},
-                        {"label", Value(type + " (" + std::to_string(static_cast<int>(device->frequency())) + "Hz)")},
+                        {"name", Value(m[0])},
+                        {"label", Value(m[0] + " Wave")},
                         {"type", Value("waveform-device")},
                         {"category", Value("audio-device")},
-                        {"status", Value(device->is_running() ? "running" : "stopped")}
+                        {"capabilities", Value(_capabilities())}
                     });
                 }
-            }
-        }
-
-        for (const auto& type : WAVEFORM_TYPES) {
-            if (path_str == "/opened/" + type + "/0") {
-                auto it = _devices.find(type);
-                if (it != _devices.end()) {
+            }},
+            {"/available/{type}/{channel:index}", {
+                none,
+                [](const RouteMatch& m) {
+                    if (!_is_type(m[0]) || m.index(1) != 0) return Ok(Dict{});
+                    return Ok(Dict{
+                        {"name", Value("0")},
+                        {"label", Value("Channel 0")},
+                        {"type", Value("audio-channel")},
+                        {"category", Value("audio-channel")},
+                        {"capabilities", Value(_capabilities())}
+                    });
+                }
+            }},
+            {"/opened", {
+                [this](const RouteMatch&) {
+                    std::vector<std::string> children;
+                    for (const auto& [type, _] : _devices) {
+                        children.push_back(type);
+                    }
+                    return Ok(children);
+                },
+                [](const RouteMatch&) { return Ok(OPENED); }
+            }},
+            {"/opened/{type}", {
+                [this](const RouteMatch& m) {
+                    return Ok(_devices.count(m[0]) ? std::vector<std::string>{"0"} : std::vector<std::string>{});
+                },
+                [this](const RouteMatch& m) {
+                    auto it = _devices.find(m[0]);
+                    if (it == _devices.end()) return Ok(Dict{});
                     auto& device = it->second;
+                    return Ok(Dict{
+                        {"name", Value(m[0])},
+                        {"label", Value(m[0] + " (" + std::to_string(static_cast<int>(device->frequency())) + "Hz)")},
+                        {"type", Value("waveform-device")},
+                        {"category", Value("audio-device")},
+                        {"status", Value(device->is_running() ? "running" : "stopped")},
+                        {"frames-generated", Value(static_cast<int64_t>(device->frames_generated()))},
+                        {"overruns", Value(static_cast<int64_t>(device->overruns()))},
+                        {"max-lateness-us", Value(device->max_lateness_us())}
+                    });
+                }
+            }},
+            {"/opened/{type}/{channel:index}", {
+                none,
+                [this](const RouteMatch& m) {
+                    auto it = _devices.find(m[0]);
+                    if (it == _devices.end() || m.index(1) != 0) return Ok(Dict{});
                     return Ok(Dict{
                         {"name", Value("0")},
                         {"label", Value("Channel 0")},
                         {"type", Value("audio-channel")},
                         {"category", Value("audio-channel")},
-                        {"buffer", Value(device->get_buffer())}
+                        {"buffer", Value(it->second->get_buffer())}
                     });
                 }
+            }},
+            // The stats node is not listed among the channels, so channel
+            // iteration is unaffected
+            {"/opened/{type}/stats/{rest...}", {
+                [this](const RouteMatch& m) {
+                    auto it = _devices.find(m[0]);
+                    if (it == _devices.end()) return Ok(std::vector<std::string>{});
+                    return Ok(audio_stats_children_names(m.rest_list(), it->second->ring_buffer()));
+                },
+                [this](const RouteMatch& m) {
+                    auto it = _devices.find(m[0]);
+                    if (it == _devices.end()) return Ok(Dict{});
+                    return Ok(audio_stats_metadata(m.rest_list(), &it->second->stats(), it->second->ring_buffer()));
+                }
+            }},
+        };
+        for (auto& [pattern, route] : routes) {
+            if (auto res = _router.add(pattern, std::move(route)); !res) {
+                return Err<void>("WaveformManager: bad route", res);
             }
         }
+        return Ok();
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        return _router.children(path);
+    }
 
-        return Ok(Dict{});
+    Result<Dict> get_metadata(const DataPath& path) override {
+        return _router.metadata(path);
     }
 
     Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
@@ -318,48 +397,55 @@ public:
     }
 
     Result<MediatedAudioBufferPtr> open(const DataPath& path, const Dict& config) {
-        std::string path_str = path.to_string();
-        if (!path_str.empty() && path_str[0] != '/') {
-            path_str = "/" + path_str;
+        // /available/<type>/0
+        const auto& parts = path.as_list();
+        if (parts.size() != 3 || parts[0] != "available" || !_is_type(parts[1]) || parts[2] != "0") {
+            return Err<MediatedAudioBufferPtr>("Invalid path for open: " + path.to_string());
         }
+        const std::string& type = parts[1];
 
-        for (const auto& type : WAVEFORM_TYPES) {
-            std::string expected = "/available/" + type + "/0";
-            if (path_str == expected) {
-                if (_devices.find(type) == _devices.end()) {
-                    float frequency = 440.0f;
-                    int sample_rate = 48000;
-
-                    if (auto it = config.find("frequency"); it != config.end()) {
-                        if (auto f = get_as<double>(it->second)) frequency = static_cast<float>(*f);
-                    }
-                    if (auto it = config.find("sample-rate"); it != config.end()) {
-                        if (auto sr = get_as<int64_t>(it->second)) sample_rate = static_cast<int>(*sr);
-                    }
+        if (_devices.find(type) == _devices.end()) {
+            float frequency = 440.0f;
+            int sample_rate = 48000;
 
-                    auto device_res = WaveformDevice::create(type, sample_rate, frequency);
-                    if (!device_res) {
-                        return Err<MediatedAudioBufferPtr>("Failed to create waveform device", device_res);
-                    }
-                    _devices[type] = *device_res;
-                    _devices[type]->start();
-                }
+            if (auto it = config.find("frequency"); it != config.end()) {
+                if (auto f = get_as<double>(it->second)) frequency = static_cast<float>(*f);
+            }
+            if (auto it = config.find("sample-rate"); it != config.end()) {
+                if (auto sr = get_as<int64_t>(it->second)) sample_rate = static_cast<int>(*sr);
+            }
 
-                return Ok(_devices[type]->get_buffer());
+            auto device_res = WaveformDevice::create(type, sample_rate, frequency);
+            if (!device_res) {
+                return Err<MediatedAudioBufferPtr>("Failed to create waveform device", device_res);
             }
+            _devices[type] = *device_res;
+            _scheduler.add(*device_res);
         }
 
-        return Err<MediatedAudioBufferPtr>("Invalid path for open: " + path_str);
+        return Ok(_devices[type]->get_buffer());
     }
 
     ~WaveformManager() {
-        for (auto& [_, device] : _devices) {
-            device->stop();
-        }
+        _scheduler.stop();
     }
 
 private:
+    static bool _is_type(const std::string& name) {
+        return std::find(WAVEFORM_TYPES.begin(), WAVEFORM_TYPES.end(), name) != WAVEFORM_TYPES.end();
+    }
+
+    static Dict _capabilities() {
+        return Dict{
+            {"openable", Value(true)},
+            {"readable", Value(true)},
+            {"writable", Value(false)}
+        };
+    }
+
+    TreeRouter _router;
     std::map<std::string, WaveformDevicePtr> _devices;
+    WaveformScheduler _scheduler;
 };
 
 namespace embedded {
@@ -1,4 +1,5 @@
 #include "data_bag.hpp"
+#include <mutex>
 #include <regex>
 #include <spdlog/spdlog.h>
 
@@ -123,6 +124,7 @@ Result<Value> DataBag::get(const std::string& key, const Value& default_value) {
     // Then try main data tree
     if (_main_data_tree) {
         DataPath path = _main_data_path / key;
+        std::scoped_lock lock(_main_data_tree->access_mutex());
         auto res = _main_data_tree->get(path);
         if (res) {
             return res;
@@ -148,6 +150,7 @@ Result<void> DataBag::set(const std::string& key, const Value& value) {
                     return Err<void>("DataBag::set: failed to parse reference", parsed);
                 }
                 auto& [tree, path] = *parsed;
+                std::scoped_lock lock(tree->access_mutex());
                 return tree->set(path, value);
             }
         }
@@ -156,6 +159,7 @@ Result<void> DataBag::set(const std::string& key, const Value& value) {
     // Default: set in main data tree
     if (_main_data_tree) {
         DataPath path = _main_data_path / key;
+        std::scoped_lock lock(_main_data_tree->access_mutex());
         return _main_data_tree->set(path, value);
     }
 
@@ -173,10 +177,61 @@ Result<Value> DataBag::get_static(const std::string& key, const Value& default_v
     return Err<Value>("DataBag::get_static: key '" + key + "' not found");
 }
 
+const Value* DataBag::find_static(const std::string& key) const {
+    auto it = _statics.find(key);
+    return it != _statics.end() ? &it->second : nullptr;
+}
+
+const Value* DataBag::_find_value(const std::string& key, Value& fetched) {
+    const std::string* reference = nullptr;
+    if (auto it = _statics.find(key); it != _statics.end()) {
+        const std::string* str = get_ptr<std::string>(it->second);
+        if (!str || !_has_interpolation(*str)) {
+            return &it->second;
+        }
+        if (!_is_reference(*str)) {
+            auto res = get(key);
+            if (!res) return nullptr;
+            fetched = std::move(*res);
+            return &fetched;
+        }
+        reference = str;
+    } else if (!_main_data_tree) {
+        return nullptr;
+    }
+
+    // Same lookup as get(), with the parse or path join done once per key
+    TreeLike* tree = nullptr;
+    const DataPath* path = nullptr;
+    {
+        std::scoped_lock lock(_read_targets_mutex);
+        auto it = _read_targets.find(key);
+        if (it == _read_targets.end()) {
+            std::pair<TreeLikePtr, DataPath> target{_main_data_tree, _main_data_path / key};
+            if (reference) {
+                auto parsed = _parse_data_path_spec(*reference);
+                if (!parsed) return nullptr;
+                target = std::move(*parsed);
+            }
+            it = _read_targets.emplace(key, std::move(target)).first;
+        }
+        tree = it->second.first.get();
+        path = &it->second.second;
+    }
+    if (!tree) return nullptr;
+
+    std::scoped_lock lock(tree->access_mutex());
+    auto res = tree->get(*path);
+    if (!res) return nullptr;
+    fetched = std::move(*res);
+    return &fetched;
+}
+
 Result<Dict> DataBag::get_metadata() {
     if (!_main_data_tree) {
         return Err<Dict>("DataBag::get_metadata: no main data tree");
     }
+    std::scoped_lock lock(_main_data_tree->access_mutex());
     return _main_data_tree->get_metadata(_main_data_path);
 }
 
@@ -185,6 +240,7 @@ Result<std::vector<std::string>> DataBag::get_metadata_keys() {
         return Err<std::vector<std::string>>(
             "DataBag::get_metadata_keys: no main data tree");
     }
+    std::scoped_lock lock(_main_data_tree->access_mutex());
     return _main_data_tree->get_metadata_keys(_main_data_path);
 }
 
@@ -193,9 +249,19 @@ Result<std::vector<std::string>> DataBag::get_children_names() {
         return Err<std::vector<std::string>>(
             "DataBag::get_children_names: no main data tree");
     }
+    std::scoped_lock lock(_main_data_tree->access_mutex());
     return _main_data_tree->get_children_names(_main_data_path);
 }
 
+Result<ChildrenMetadata> DataBag::get_children_metadata(const std::vector<std::string>& keys) {
+    if (!_main_data_tree) {
+        return Err<ChildrenMetadata>(
+            "DataBag::get_children_metadata: no main data tree");
+    }
+    std::scoped_lock lock(_main_data_tree->access_mutex());
+    return _main_data_tree->get_children_metadata(_main_data_path, keys);
+}
+
 Result<DataPath> DataBag::get_data_path() {
     return Ok(_main_data_path);
 }
@@ -204,6 +270,10 @@ Result<std::string> DataBag::get_data_path_str() {
     return Ok(_main_data_path.to_string());
 }
 
+Result<std::pair<TreeLikePtr, DataPath>> DataBag::resolve_data_path(const std::string& spec) {
+    return _parse_data_path_spec(spec);
+}
+
 Result<void> DataBag::add_child(const Dict& child_spec) {
     if (!_main_data_tree) {
         return Err<void>("DataBag::add_child: no main data tree");
@@ -227,6 +297,7 @@ Result<void> DataBag::add_child(const Dict& child_spec) {
         }
     }
 
+    std::scoped_lock lock(_main_data_tree->access_mutex());
     return _main_data_tree->add_child(_main_data_path, *name, data);
 }
 
@@ -245,6 +316,7 @@ Result<Value> DataBag::_resolve_reference(const std::string& ref_str) {
     }
 
     auto& [tree, path] = *parsed;
+    std::scoped_lock lock(tree->access_mutex());
     return tree->get(path);
 }
 
@@ -336,6 +408,7 @@ Result<std::vector<std::string>> DataBag::get_tree_children(const std::string& t
     if (it == _data_trees.end()) {
         return Err<std::vector<std::string>>("DataBag::get_tree_children: tree '" + tree_name + "' not found");
     }
+    std::scoped_lock lock(it->second->access_mutex());
     return it->second->get_children_names(path);
 }
 
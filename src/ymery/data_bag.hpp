@@ -5,6 +5,7 @@
 #include "object.hpp"
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 
 namespace ymery {
@@ -38,15 +39,35 @@ public:
     // Static config access (no reference resolution)
     Result<Value> get_static(const std::string& key, const Value& default_value = {});
 
+    // Render-loop access: no copy of static values and no error built on a miss.
+    // find_static returns the static in place, nullptr when absent. read
+    // stores the value of key in out when it is there and a T: plain statics
+    // are read in place, references and tree keys at a path resolved on the
+    // first read. Interpolated strings are still rebuilt by get().
+    const Value* find_static(const std::string& key) const;
+    template<typename T>
+    bool read(const std::string& key, T& out) {
+        Value fetched;
+        const Value* value = _find_value(key, fetched);
+        const T* typed = value ? get_ptr<T>(*value) : nullptr;
+        if (typed) out = *typed;
+        return typed != nullptr;
+    }
+
     // Metadata access
     Result<Dict> get_metadata();
     Result<std::vector<std::string>> get_metadata_keys();
     Result<std::vector<std::string>> get_children_names();
+    // Children with the given metadata keys, one locked call for the whole list
+    Result<ChildrenMetadata> get_children_metadata(const std::vector<std::string>& keys);
 
     // Path info
     Result<DataPath> get_data_path();
     Result<std::string> get_data_path_str();
     std::string main_data_key() const { return _main_data_key; }
+    TreeLikePtr main_data_tree() const { return _main_data_tree; }
+    // Tree and path a data-path spec names, without touching the tree
+    Result<std::pair<TreeLikePtr, DataPath>> resolve_data_path(const std::string& spec);
 
     // Tree browsing (for editor/inspector use)
     std::vector<std::string> get_tree_names() const;
@@ -67,6 +88,8 @@ private:
     bool _is_reference(const std::string& str);
     bool _has_interpolation(const std::string& str);
     Result<std::string> _interpolate(const std::string& str);
+    // Value of key for read(): a static in place, or fetched from a tree
+    const Value* _find_value(const std::string& key, Value& fetched);
 
     std::shared_ptr<Dispatcher> _dispatcher;
     std::shared_ptr<PluginManager> _plugin_manager;
@@ -75,6 +98,10 @@ private:
     std::string _main_data_key;
     DataPath _main_data_path;
     Dict _statics;
+
+    // Tree and path read() fetches each key from, resolved on its first read
+    std::map<std::string, std::pair<TreeLikePtr, DataPath>> _read_targets;
+    std::mutex _read_targets_mutex;
 };
 
 using DataBagPtr = std::shared_ptr<DataBag>;
@@ -60,6 +60,30 @@ Result<void> Dispatcher::dispatch_event(const Dict& event) {
         }
     }
 
+    // Subscriptions, copied first: a handler may subscribe or unsubscribe
+    std::vector<EventHandler> subscribed;
+    for (const auto& [_, subscription] : _subscriptions) {
+        if (subscription.first == key || subscription.first == "*/" + name) {
+            subscribed.push_back(subscription.second);
+        }
+    }
+    for (auto& handler : subscribed) {
+        handler(event);
+    }
+
+    return Ok();
+}
+
+Result<uint64_t> Dispatcher::subscribe_event(const std::string& key, EventHandler handler) {
+    uint64_t id = ++_next_subscription;
+    _subscriptions.emplace(id, std::make_pair(key, std::move(handler)));
+    return id;
+}
+
+Result<void> Dispatcher::unsubscribe_event(uint64_t id) {
+    if (_subscriptions.erase(id) == 0) {
+        return Err<void>("Dispatcher::unsubscribe_event: no subscription " + std::to_string(id));
+    }
     return Ok();
 }
 
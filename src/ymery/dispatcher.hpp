@@ -3,6 +3,7 @@
 #include "result.hpp"
 #include "types.hpp"
 #include "object.hpp"
+#include <cstdint>
 #include <map>
 #include <vector>
 #include <functional>
@@ -23,6 +24,10 @@ public:
     Result<void> unregister_event_handler(const std::string& key);
     Result<void> dispatch_event(const Dict& event);
 
+    // Event subscriptions: like event handlers, but removed one by one by id
+    Result<uint64_t> subscribe_event(const std::string& key, EventHandler handler);
+    Result<void> unsubscribe_event(uint64_t id);
+
     // Action handlers (require responder)
     using ActionHandler = std::function<Result<void>(const Dict&)>;
     Result<void> register_action_handler(ActionHandler handler);
@@ -32,6 +37,8 @@ private:
     Dispatcher() = default;
 
     std::map<std::string, std::vector<EventHandler>> _event_handlers;
+    std::map<uint64_t, std::pair<std::string, EventHandler>> _subscriptions;
+    uint64_t _next_subscription = 0;
     std::vector<ActionHandler> _action_handlers;
 };
 
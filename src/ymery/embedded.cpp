@@ -119,6 +119,9 @@ void EmbeddedApp::dispose() {
 }
 
 void EmbeddedApp::render_widgets() {
+    // Scratch memory handed out during the previous frame is no longer referenced
+    frame_arena().reset();
+
     if (_root_widget) {
         if (auto render_res = _root_widget->render(); !render_res) {
             ywarn("EmbeddedApp::render_widgets: {}", error_msg(render_res));
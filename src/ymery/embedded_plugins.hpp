@@ -20,6 +20,12 @@ Result<TreeLikePtr> create_data_tree();
 Result<TreeLikePtr> create_simple_data_tree();
 Result<TreeLikePtr> create_audio_file_manager();
 Result<TreeLikePtr> create_waveform_manager();
+Result<TreeLikePtr> create_recorder_manager();
+Result<TreeLikePtr> create_playback_manager();
+Result<TreeLikePtr> create_resampler_manager();
+Result<TreeLikePtr> create_simulator_manager();
+Result<TreeLikePtr> create_timeseries_manager();
+Result<TreeLikePtr> create_table_file_manager();
 Result<TreeLikePtr> create_kernel(std::shared_ptr<Dispatcher> dispatcher, std::shared_ptr<PluginManager> plugin_manager);
 
 } // namespace ymery::embedded
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "result.hpp"
+#include "log_buffer.hpp"
 #include <deque>
 #include <mutex>
 #include <string>
@@ -18,7 +19,9 @@ public:
     struct ErrorEntry {
         Error error;
         spdlog::level::level_enum level;
-        std::string timestamp;
+        int64_t time_ns;  // system clock; formatted on display
+
+        std::string timestamp() const { return format_log_timestamp(time_ns); }
     };
 
     explicit ErrorBuffer(size_t max_size = 1000) : _max_size(max_size) {}
@@ -50,26 +53,12 @@ public:
                 break;
         }
 
-        // Get timestamp
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
-
-        std::tm tm_buf;
-#ifdef _WIN32
-        localtime_s(&tm_buf, &time_t);
-#else
-        localtime_r(&time_t, &tm_buf);
-#endif
-
-        char timestamp[32];
-        std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &tm_buf);
-        std::string ts = std::string(timestamp) + "." +
-            std::to_string(ms.count()).insert(0, 3 - std::to_string(ms.count()).size(), '0');
+        auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
 
         // Add to ring buffer
-        _entries.push_back({std::move(error), level, ts});
+        _entries.push_back({std::move(error), level, time_ns});
+        ++_generation;
 
         // Trim if exceeds max size
         while (_entries.size() > _max_size) {
@@ -95,9 +84,15 @@ public:
         return _entries.size();
     }
 
+    // Changes whenever entries are added, trimmed or cleared
+    [[nodiscard]] uint64_t generation() const {
+        return _generation;
+    }
+
     // Clear all entries
     void clear() {
         _entries.clear();
+        ++_generation;
     }
 
     // Get max size
@@ -111,6 +106,7 @@ public:
         while (_entries.size() > _max_size) {
             _entries.pop_front();
         }
+        ++_generation;
     }
 
     // Level to string
@@ -142,6 +138,7 @@ public:
 private:
     std::deque<ErrorEntry> _entries;
     size_t _max_size;
+    uint64_t _generation = 0;
 };
 
 // Thread-local error buffer accessor
@@ -2,6 +2,7 @@
 #include "widget_factory.hpp"
 #include <imgui.h>
 #include <ytrace/ytrace.hpp>
+#include <algorithm>
 
 namespace ymery {
 
@@ -54,6 +55,7 @@ Result<void> Composite::dispose() {
         }
     }
     _children.clear();
+    _child_specs.clear();
     _children_initialized = false;
     _foreach_child_names.clear();
 
@@ -63,12 +65,18 @@ Result<void> Composite::dispose() {
 Result<void> Composite::render() {
     // Clear errors from previous render cycle
     _error_messages.clear();
+    _rendered = true;
 
     // Push styles - continue even on error
     if (auto res = _push_styles(); !res) {
         _handle_error(Err<void>("Composite::render: _push_styles failed", res));
     }
 
+    // Prepared data - continue even on error
+    if (auto res = _take_prepared(); !res) {
+        _handle_error(Err<void>("Composite::render: prepare failed", res));
+    }
+
     // Pre-render - continue even on error
     if (_error_messages.empty()) {
         if (auto res = _pre_render_head(); !res) {
@@ -122,6 +130,16 @@ Result<void> Composite::render() {
     return _render_errors();
 }
 
+void Composite::collect_prepare(std::vector<Widget*>& out) {
+    // Children of a closed container were not rendered and are skipped by their own flag
+    bool rendered = _rendered;
+    Widget::collect_prepare(out);
+    if (!rendered) return;
+    for (auto& child : _children) {
+        if (child) child->collect_prepare(out);
+    }
+}
+
 Result<void> Composite::_begin_container() {
     _container_open = true;
     return Ok();
@@ -134,6 +152,9 @@ Result<void> Composite::_end_container() {
 Result<void> Composite::_ensure_children() {
     // For foreach-child, we need to rebuild children each frame to handle dynamic data
     // For static children, only initialize once
+    if (_children_initialized && !_has_foreach_child) {
+        return Ok();
+    }
 
     // Get body spec from statics
     auto body_res = _data_bag->get_static("body");
@@ -172,18 +193,14 @@ Result<void> Composite::_ensure_children() {
     // Check if any body item is foreach-child
     bool has_foreach_child = false;
     for (const auto& item : *children_list) {
-        if (auto dict = get_as<Dict>(item)) {
+        if (auto dict = get_ptr<Dict>(item)) {
             if (dict->find("foreach-child") != dict->end()) {
                 has_foreach_child = true;
                 break;
             }
         }
     }
-
-    // If no foreach-child and already initialized, skip
-    if (!has_foreach_child && _children_initialized) {
-        return Ok();
-    }
+    _has_foreach_child = has_foreach_child;
 
     // For foreach-child, check if data has changed before rebuilding
     if (has_foreach_child && _children_initialized) {
@@ -295,13 +312,17 @@ Result<void> Composite::_ensure_children() {
             }
         }
 
-        // Regular widget creation
+        // Regular widget creation - a failed child keeps its slot so children
+        // stay aligned with the body entries
         auto widget_res = _widget_factory->create_widget(_data_bag, child_spec, _namespace);
         if (!widget_res) {
             _handle_error(Err<void>("Composite::_ensure_children: failed to create child widget", widget_res));
+            _children.push_back(nullptr);
+            _child_specs.push_back(child_spec);
             continue;
         }
         _children.push_back(*widget_res);
+        _child_specs.push_back(child_spec);
         ydebug("Composite::_ensure_children: created child widget");
     }
 
@@ -310,6 +331,114 @@ Result<void> Composite::_ensure_children() {
     return Ok();
 }
 
+WidgetPtr Composite::child(size_t index) const {
+    return index < _children.size() ? _children[index] : nullptr;
+}
+
+Result<void> Composite::insert_child(size_t index, const Value& spec) {
+    if (!_children_initialized || !_foreach_child_names.empty()) {
+        return Err<void>("Composite::insert_child: children not built from a static body");
+    }
+    if (index > _children.size()) {
+        return Err<void>("Composite::insert_child: index " + std::to_string(index) + " out of range");
+    }
+    auto widget_res = _widget_factory->create_widget(_data_bag, spec, _namespace);
+    if (!widget_res) {
+        return Err<void>("Composite::insert_child: failed to create widget", widget_res);
+    }
+    _children.insert(_children.begin() + index, *widget_res);
+    _child_specs.insert(_child_specs.begin() + index, spec);
+    return Ok();
+}
+
+Result<void> Composite::replace_child(size_t index, const Value& spec) {
+    if (!_children_initialized || !_foreach_child_names.empty()) {
+        return Err<void>("Composite::replace_child: children not built from a static body");
+    }
+    if (index >= _children.size()) {
+        return Err<void>("Composite::replace_child: index " + std::to_string(index) + " out of range");
+    }
+    auto widget_res = _widget_factory->create_widget(_data_bag, spec, _namespace);
+    if (!widget_res) {
+        return Err<void>("Composite::replace_child: failed to create widget", widget_res);
+    }
+    if (_children[index]) _children[index]->dispose();
+    _children[index] = *widget_res;
+    _child_specs[index] = spec;
+    return Ok();
+}
+
+Result<void> Composite::remove_child(size_t index) {
+    if (!_children_initialized || !_foreach_child_names.empty()) {
+        return Err<void>("Composite::remove_child: children not built from a static body");
+    }
+    if (index >= _children.size()) {
+        return Err<void>("Composite::remove_child: index " + std::to_string(index) + " out of range");
+    }
+    if (_children[index]) _children[index]->dispose();
+    _children.erase(_children.begin() + index);
+    _child_specs.erase(_child_specs.begin() + index);
+    return Ok();
+}
+
+Result<void> Composite::swap_children(size_t a, size_t b) {
+    if (!_children_initialized || !_foreach_child_names.empty()) {
+        return Err<void>("Composite::swap_children: children not built from a static body");
+    }
+    if (a >= _children.size() || b >= _children.size()) {
+        return Err<void>("Composite::swap_children: index out of range");
+    }
+    std::swap(_children[a], _children[b]);
+    std::swap(_child_specs[a], _child_specs[b]);
+    return Ok();
+}
+
+size_t Composite::reload_definitions(const std::set<std::string>& changed) {
+    size_t rebuilt = Widget::reload_definitions(changed);
+    if (!_children_initialized) return rebuilt;
+
+    auto is_stale = [&changed](const WidgetPtr& child) {
+        return !child || changed.count(child->definition()) > 0;
+    };
+
+    // foreach-child instances share one spec - rebuild them together on the next render
+    if (!_foreach_child_names.empty()) {
+        if (std::any_of(_children.begin(), _children.end(), is_stale)) {
+            for (auto& child : _children) {
+                if (child) child->dispose();
+            }
+            rebuilt += _children.size();
+            _children.clear();
+            _foreach_child_names.clear();
+            _children_initialized = false;
+            return rebuilt;
+        }
+        for (auto& child : _children) {
+            rebuilt += child->reload_definitions(changed);
+        }
+        return rebuilt;
+    }
+
+    // Each child is rebuilt from its own spec, which follows it through
+    // inserts, removals and swaps
+    for (size_t i = 0; i < _children.size() && i < _child_specs.size(); ++i) {
+        auto& child = _children[i];
+        if (!is_stale(child)) {
+            rebuilt += child->reload_definitions(changed);
+            continue;
+        }
+        // Failed children are retried as well - the edit may have fixed them
+        auto widget_res = _widget_factory->create_widget(_data_bag, _child_specs[i], _namespace);
+        if (child) child->dispose();
+        child = widget_res ? *widget_res : nullptr;
+        if (!widget_res) {
+            ywarn("Composite::reload_definitions: failed to rebuild child {}: {}", i, error_msg(widget_res));
+        }
+        ++rebuilt;
+    }
+    return rebuilt;
+}
+
 Result<void> Composite::_render_children() {
     for (auto& child : _children) {
         if (child) {
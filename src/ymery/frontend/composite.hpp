@@ -25,6 +25,21 @@ public:
 
     // Rendering
     Result<void> render() override;
+    void collect_prepare(std::vector<Widget*>& out) override;
+
+    // Structural patching (editor preview) - indices follow the body entries.
+    // Fails until the children have been built, since the body statics are
+    // not updated; each child keeps the spec it was built from, so a later
+    // hot reload rebuilds it from that spec.
+    size_t child_count() const { return _children.size(); }
+    WidgetPtr child(size_t index) const;
+    Result<void> insert_child(size_t index, const Value& spec);
+    Result<void> replace_child(size_t index, const Value& spec);
+    Result<void> remove_child(size_t index);
+    Result<void> swap_children(size_t a, size_t b);
+
+    // Hot reload
+    size_t reload_definitions(const std::set<std::string>& changed) override;
 
 protected:
     // Override to provide container behavior
@@ -36,7 +51,10 @@ protected:
     virtual Result<void> _render_children();
 
     std::vector<WidgetPtr> _children;
+    std::vector<Value> _child_specs;  // spec of each static-body child, parallel to _children
     bool _children_initialized = false;
+    // Set with the children: only a foreach-child body is rechecked each frame
+    bool _has_foreach_child = false;
     bool _container_open = true;
 
     // Cache for foreach-child to detect when data changes
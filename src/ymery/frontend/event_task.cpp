@@ -0,0 +1,166 @@
+#include "event_task.hpp"
+#include "../backend/async_tree.hpp"
+#include "../dispatcher.hpp"
+#include <algorithm>
+
+namespace ymery {
+
+// ============================================================================
+// EventTask
+// ============================================================================
+
+EventTask& EventTask::operator=(EventTask&& other) noexcept {
+    if (this != &other) {
+        if (_handle) _handle.destroy();
+        _handle = std::exchange(other._handle, {});
+    }
+    return *this;
+}
+
+EventTask::~EventTask() {
+    if (_handle) _handle.destroy();
+}
+
+bool EventTask::poll() {
+    if (done()) return true;
+    auto& ready = _handle.promise().ready;
+    if (ready && !ready()) return false;
+    ready = nullptr;
+    _handle.resume();
+    return _handle.done();
+}
+
+// ============================================================================
+// EventExecutor
+// ============================================================================
+
+bool EventExecutor::running(const std::string& name) const {
+    auto named = [&](const auto& entry) { return entry.first == name; };
+    return std::any_of(_tasks.begin(), _tasks.end(), named) ||
+           std::any_of(_spawned.begin(), _spawned.end(), named);
+}
+
+Result<void> EventExecutor::spawn(std::string name, EventTask task) {
+    if (task.done()) {
+        return task.valid() ? task.result() : Ok();
+    }
+    // Started from a step that tick() resumed: joins the others when it ends
+    (_ticking ? _spawned : _tasks).emplace_back(std::move(name), std::move(task));
+    return Ok();
+}
+
+std::vector<Result<void>> EventExecutor::tick() {
+    ++_frames;
+    std::vector<Result<void>> failures;
+    _ticking = true;
+    size_t kept = 0;
+    for (size_t i = 0; i < _tasks.size(); ++i) {
+        if (_tasks[i].second.poll()) {
+            if (const auto& res = _tasks[i].second.result(); !res) failures.push_back(res);
+            continue;
+        }
+        if (kept != i) _tasks[kept] = std::move(_tasks[i]);
+        ++kept;
+    }
+    _tasks.erase(_tasks.begin() + static_cast<std::ptrdiff_t>(kept), _tasks.end());
+    _ticking = false;
+    for (auto& entry : _spawned) _tasks.push_back(std::move(entry));
+    _spawned.clear();
+    return failures;
+}
+
+void EventExecutor::cancel() {
+    _tasks.clear();
+    _spawned.clear();
+}
+
+// ============================================================================
+// Awaitables
+// ============================================================================
+
+WaitUntil next_frames(int frames) {
+    return WaitUntil{[frames]() mutable { return frames-- <= 0; }};
+}
+
+WaitUntil sleep_for(double seconds) {
+    auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    return WaitUntil{[deadline] { return std::chrono::steady_clock::now() >= deadline; }};
+}
+
+WaitEvent::WaitEvent(std::shared_ptr<Dispatcher> dispatcher, std::string key)
+    : _dispatcher(std::move(dispatcher)), _key(std::move(key)) {}
+
+WaitEvent::WaitEvent(WaitEvent&& other) noexcept
+    : _dispatcher(std::move(other._dispatcher)), _key(std::move(other._key)),
+      _event(std::move(other._event)), _subscription(std::exchange(other._subscription, std::nullopt)) {}
+
+WaitEvent::~WaitEvent() {
+    if (_subscription && _dispatcher) _dispatcher->unsubscribe_event(*_subscription);
+}
+
+void WaitEvent::await_suspend(EventTask::Handle handle) {
+    if (_dispatcher) {
+        auto res = _dispatcher->subscribe_event(_key, [event = _event](const Dict& e) -> Result<void> {
+            if (!*event) *event = e;
+            return Ok();
+        });
+        if (res) _subscription = *res;
+    }
+    // Without a dispatcher there is nothing to wait for
+    handle.promise().ready = [this] { return !_subscription || _event->has_value(); };
+}
+
+Result<Dict> WaitEvent::await_resume() {
+    if (_subscription) {
+        _dispatcher->unsubscribe_event(*_subscription);
+        _subscription.reset();
+    }
+    if (!*_event) return Err<Dict>("WaitEvent: no dispatcher to wait for '" + _key + "' on");
+    return **_event;
+}
+
+WaitEvent wait_event(std::shared_ptr<Dispatcher> dispatcher, std::string key) {
+    return WaitEvent(std::move(dispatcher), std::move(key));
+}
+
+std::future<Result<std::vector<std::string>>> open_data_path(TreeLikePtr tree, DataPath path) {
+    using Names = Result<std::vector<std::string>>;
+    auto done = std::make_shared<std::promise<Names>>();
+    auto future = done->get_future();
+
+    // Follow the path down to the tree that answers it, so the listing
+    // locks that provider and not the kernel every widget reads through
+    while (tree) {
+        auto target = [&] {
+            std::scoped_lock lock(tree->access_mutex());
+            return tree->forwarding_target(path);
+        }();
+        if (!target) {
+            done->set_value(Err<std::vector<std::string>>("open_data_path: '" + path.to_string() + "' does not resolve", target));
+            return future;
+        }
+        if (!target->first) break;
+        tree = std::move(target->first);
+        path = std::move(target->second);
+    }
+    if (!tree) {
+        done->set_value(Err<std::vector<std::string>>("open_data_path: no tree"));
+        return future;
+    }
+
+    // An async provider opens on its own queue; its plain listing would only say "pending"
+    if (auto async_tree = std::dynamic_pointer_cast<AsyncTree>(tree)) {
+        return async_tree->get_children_names_async(path);
+    }
+
+    AsyncTreeService::instance().post([tree = std::move(tree), path = std::move(path), done] {
+        // Listing the node makes the provider open, if not open yet
+        std::scoped_lock lock(tree->access_mutex());
+        auto names = tree->get_children_names(path);
+        done->set_value(names ? names : Names(Err<std::vector<std::string>>("open_data_path: '" + path.to_string() + "' failed", names)));
+    });
+    return future;
+}
+
+} // namespace ymery
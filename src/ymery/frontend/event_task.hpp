@@ -0,0 +1,172 @@
+// Event tasks - widget event handlers as coroutines, resumed frame by frame
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ymery {
+
+class Dispatcher;
+
+/**
+ * EventTask - a coroutine running one event handler
+ *
+ * The task starts at once and runs until it awaits something that is not
+ * ready, so a handler that never waits finishes inside the call that
+ * triggered it. A suspended task keeps the condition it waits for in its
+ * promise; poll() checks it and resumes the task when it holds.
+ */
+class EventTask {
+public:
+    struct promise_type {
+        Result<void> result = Ok();
+        std::function<bool()> ready;  // set while suspended
+
+        EventTask get_return_object() {
+            return EventTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(Result<void> res) { result = std::move(res); }
+        void unhandled_exception() { result = Err<void>("EventTask: unhandled exception"); }
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    EventTask() = default;
+    EventTask(EventTask&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    EventTask& operator=(EventTask&& other) noexcept;
+    EventTask(const EventTask&) = delete;
+    EventTask& operator=(const EventTask&) = delete;
+    ~EventTask();
+
+    bool valid() const { return static_cast<bool>(_handle); }
+    bool done() const { return !_handle || _handle.done(); }
+
+    // Resume the task if what it waits for is ready; true once it has finished
+    bool poll();
+
+    // Outcome of a finished task
+    const Result<void>& result() const { return _handle.promise().result; }
+
+private:
+    explicit EventTask(Handle handle) : _handle(handle) {}
+
+    Handle _handle;
+};
+
+/**
+ * EventExecutor - the running event tasks of one widget
+ *
+ * The widget calls tick() once per render, so tasks advance with the
+ * frames and a resumed task runs its next steps inside the widget's
+ * render, where ImGui calls such as opening a popup apply to the widget.
+ * Tasks of a widget that is not rendered wait. One task per event name:
+ * a handler whose task is still waiting is not started again.
+ */
+class EventExecutor {
+public:
+    bool running(const std::string& name) const;
+    bool empty() const { return _tasks.empty() && _spawned.empty(); }
+    size_t size() const { return _tasks.size() + _spawned.size(); }
+    // Frames ticked so far
+    uint64_t frames() const { return _frames; }
+
+    // Keep a task that is still waiting; the result of one that finished at once
+    Result<void> spawn(std::string name, EventTask task);
+
+    // Resume the tasks that can go on; the failures of those that finished
+    std::vector<Result<void>> tick();
+
+    // Destroy the waiting tasks without resuming them
+    void cancel();
+
+private:
+    std::vector<std::pair<std::string, EventTask>> _tasks;
+    std::vector<std::pair<std::string, EventTask>> _spawned;  // started during tick()
+    bool _ticking = false;
+    uint64_t _frames = 0;
+};
+
+// ============================================================================
+// Awaitables
+// ============================================================================
+
+// Suspends until ready() holds; checked once per tick
+struct WaitUntil {
+    std::function<bool()> ready;
+
+    bool await_ready() { return ready(); }
+    void await_suspend(EventTask::Handle handle) { handle.promise().ready = std::move(ready); }
+    void await_resume() const noexcept {}
+};
+
+// Resume after `frames` ticks (0: go on at once)
+WaitUntil next_frames(int frames = 1);
+
+// Resume once `seconds` have passed, at the first tick after that
+WaitUntil sleep_for(double seconds);
+
+// Resume with the result of a future, e.g. from AsyncTree or open_data_path
+template<typename T>
+struct WaitFuture {
+    std::future<Result<T>> future;
+
+    bool await_ready() const {
+        return !future.valid() || future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+    void await_suspend(EventTask::Handle handle) {
+        handle.promise().ready = [this] { return await_ready(); };
+    }
+    Result<T> await_resume() {
+        if (!future.valid()) return Err<T>("WaitFuture: no future");
+        return future.get();
+    }
+};
+
+template<typename T>
+WaitFuture<T> wait_future(std::future<Result<T>> future) {
+    return WaitFuture<T>{std::move(future)};
+}
+
+// Resume with the next event dispatched for key ("source/name", or
+// "*/name" for any source); the subscription ends with the wait
+class WaitEvent {
+public:
+    WaitEvent(std::shared_ptr<Dispatcher> dispatcher, std::string key);
+    WaitEvent(WaitEvent&& other) noexcept;
+    WaitEvent(const WaitEvent&) = delete;
+    WaitEvent& operator=(const WaitEvent&) = delete;
+    ~WaitEvent();
+
+    bool await_ready() const { return false; }
+    void await_suspend(EventTask::Handle handle);
+    Result<Dict> await_resume();
+
+private:
+    std::shared_ptr<Dispatcher> _dispatcher;
+    std::string _key;
+    std::shared_ptr<std::optional<Dict>> _event = std::make_shared<std::optional<Dict>>();
+    std::optional<uint64_t> _subscription;
+};
+
+WaitEvent wait_event(std::shared_ptr<Dispatcher> dispatcher, std::string key);
+
+// List path, which opens the provider it goes through if not open yet,
+// without blocking the caller. The path is followed through forwarding
+// trees (TreeLike::forwarding_target) to the provider; an AsyncTree lists
+// it on its own queue, any other provider on an AsyncTreeService worker
+// under that provider's access_mutex only. Resolve the spec with
+// DataBag::resolve_data_path first, so the bag stays on its own thread.
+std::future<Result<std::vector<std::string>>> open_data_path(TreeLikePtr tree, DataPath path);
+
+} // namespace ymery
@@ -0,0 +1,60 @@
+#include "frame_arena.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace ymery {
+
+FrameArena::FrameArena(size_t capacity)
+    : _block(new std::byte[std::max<size_t>(capacity, 64)])
+    , _capacity(std::max<size_t>(capacity, 64))
+{
+}
+
+void* FrameArena::allocate(size_t bytes, size_t align) {
+    auto base = reinterpret_cast<uintptr_t>(_block.get());
+    uintptr_t aligned = (base + _used + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+    size_t offset = aligned - base;
+
+    if (offset + bytes <= _capacity) {
+        _used = offset + bytes;
+        return _block.get() + offset;
+    }
+
+    // Out of room this frame - hand out a dedicated block; reset() folds it in
+    size_t size = bytes + align;
+    _overflow.emplace_back(new std::byte[size]);
+    _overflow_bytes += size;
+    auto raw = reinterpret_cast<uintptr_t>(_overflow.back().get());
+    return reinterpret_cast<void*>((raw + align - 1) & ~(static_cast<uintptr_t>(align) - 1));
+}
+
+const char* FrameArena::copy_string(std::string_view str) {
+    return concat(str, {});
+}
+
+const char* FrameArena::concat(std::string_view label, std::string_view suffix) {
+    auto* out = static_cast<char*>(allocate(label.size() + suffix.size() + 1, 1));
+    if (!label.empty()) std::memcpy(out, label.data(), label.size());
+    if (!suffix.empty()) std::memcpy(out + label.size(), suffix.data(), suffix.size());
+    out[label.size() + suffix.size()] = '\0';
+    return out;
+}
+
+void FrameArena::reset() {
+    if (!_overflow.empty()) {
+        _capacity = std::bit_ceil(_capacity + _overflow_bytes);
+        _block.reset(new std::byte[_capacity]);
+        _overflow.clear();
+        _overflow_bytes = 0;
+    }
+    _used = 0;
+    ++_frame;
+}
+
+FrameArena& frame_arena() {
+    static FrameArena arena;
+    return arena;
+}
+
+} // namespace ymery
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ymery {
+
+/**
+ * FrameArena - bump allocator for per-frame scratch memory
+ *
+ * Widgets use it for ImGui labels and temporary arrays that only have to
+ * live until the frame is submitted. reset() rewinds the arena at the start
+ * of each frame; if a frame overflowed the main block, the block is grown
+ * to fit, so in steady state the arena itself makes no heap allocations.
+ * Widgets reach it through Widget::_arena() and read the values they build
+ * from with DataBag::read / find_static, which do not copy.
+ * Not thread-safe - use from the render thread only, not from a prepare
+ * phase that may run on a worker thread.
+ */
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Raw allocation, valid until the next reset()
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    // Uninitialized array of trivially destructible elements
+    template<typename T>
+    std::span<T> alloc_array(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+        if (count == 0) return {};
+        return {static_cast<T*>(allocate(count * sizeof(T), alignof(T))), count};
+    }
+
+    // NUL-terminated copy of a string
+    const char* copy_string(std::string_view str);
+
+    // NUL-terminated "<label><suffix>", e.g. an ImGui "label###uid" id
+    const char* concat(std::string_view label, std::string_view suffix);
+
+    // Rewind for a new frame
+    void reset();
+
+    size_t used() const { return _used + _overflow_bytes; }
+    size_t capacity() const { return _capacity; }
+    uint64_t frame() const { return _frame; }
+
+private:
+    std::unique_ptr<std::byte[]> _block;
+    size_t _capacity;
+    size_t _used = 0;
+
+    // Blocks allocated when the main block ran out during this frame
+    std::vector<std::unique_ptr<std::byte[]>> _overflow;
+    size_t _overflow_bytes = 0;
+
+    uint64_t _frame = 0;
+};
+
+// Arena shared by all widgets, reset by App at the start of each frame
+FrameArena& frame_arena();
+
+} // namespace ymery
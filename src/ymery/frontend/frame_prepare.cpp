@@ -0,0 +1,73 @@
+#include "frame_prepare.hpp"
+#include "widget.hpp"
+
+namespace ymery {
+
+FramePreparer::FramePreparer(size_t threads) {
+    _workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        _workers.emplace_back([this] { _worker(); });
+    }
+}
+
+FramePreparer::~FramePreparer() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+size_t FramePreparer::run(Widget& root) {
+    _tasks.clear();
+    root.collect_prepare(_tasks);
+    if (_tasks.empty()) return 0;
+
+    _next.store(0, std::memory_order_relaxed);
+    if (_workers.empty() || _tasks.size() < MIN_PARALLEL) {
+        _drain();
+        return _tasks.size();
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        ++_generation;
+        _busy = _workers.size();
+    }
+    _wake.notify_all();
+    _drain();
+
+    std::unique_lock lock(_mutex);
+    _idle.wait(lock, [this] { return _busy == 0; });
+    return _tasks.size();
+}
+
+void FramePreparer::_drain() {
+    for (size_t i = _next.fetch_add(1, std::memory_order_relaxed); i < _tasks.size();
+         i = _next.fetch_add(1, std::memory_order_relaxed)) {
+        _tasks[i]->prepare();
+    }
+}
+
+void FramePreparer::_worker() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock lock(_mutex);
+            _wake.wait(lock, [&] { return _stop || _generation != seen; });
+            if (_stop) return;
+            seen = _generation;
+        }
+        _drain();
+        {
+            std::lock_guard lock(_mutex);
+            --_busy;
+        }
+        _idle.notify_one();
+    }
+}
+
+} // namespace ymery
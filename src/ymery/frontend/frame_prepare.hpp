@@ -0,0 +1,63 @@
+// Frame prepare phase - widget data fetching in parallel, ahead of ImGui submission
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ymery {
+
+class Widget;
+
+/**
+ * FramePreparer - runs the prepare phase of a frame
+ *
+ * A frame has two phases. prepare: widgets resolve their bindings and
+ * fetch and convert data, without any ImGui call (Widget::prepare). Then
+ * submit: render() only issues ImGui/ImPlot calls from the prepared state.
+ *
+ * run() collects the widgets that were rendered in the previous frame and
+ * prepare data, on the UI thread, then prepares them on a fixed set of
+ * worker threads with the UI thread taking part, and returns when all are
+ * done. Data trees are not thread-safe, so DataBag serializes calls per
+ * tree (TreeLike::access_mutex); widgets bound to different trees, and the
+ * conversion work after a fetch, run concurrently.
+ */
+class FramePreparer {
+public:
+    // threads: worker threads besides the UI thread (0: prepare on the UI thread)
+    explicit FramePreparer(size_t threads);
+    ~FramePreparer();
+
+    FramePreparer(const FramePreparer&) = delete;
+    FramePreparer& operator=(const FramePreparer&) = delete;
+
+    // Prepare the widgets under root; returns how many were prepared
+    size_t run(Widget& root);
+
+    size_t threads() const { return _workers.size(); }
+
+    // Fewer widgets than this are prepared on the UI thread alone
+    static constexpr size_t MIN_PARALLEL = 4;
+
+private:
+    void _worker();
+    void _drain();
+
+    std::vector<std::thread> _workers;
+    std::vector<Widget*> _tasks;
+    std::atomic<size_t> _next{0};
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    uint64_t _generation = 0;
+    size_t _busy = 0;       // workers still draining the current generation
+    bool _stop = false;
+};
+
+} // namespace ymery
@@ -0,0 +1,273 @@
+#include "table_model.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <thread>
+
+namespace ymery {
+
+namespace {
+
+std::string format_cell(const Value& v) {
+    if (auto s = get_ptr<std::string>(v)) return *s;
+    if (auto s = get_ptr<const char*>(v)) return *s ? *s : "";
+    if (auto b = get_ptr<bool>(v)) return *b ? "true" : "false";
+    if (auto i = get_ptr<int>(v)) return std::to_string(*i);
+    if (auto i = get_ptr<int64_t>(v)) return std::to_string(*i);
+
+    char buf[32];
+    double d = 0.0;
+    if (auto p = get_ptr<double>(v)) {
+        d = *p;
+    } else if (auto f = get_ptr<float>(v)) {
+        d = *f;
+    } else if (auto array = get_ptr<NumericArrayPtr>(v); array && *array) {
+        return std::string(NumericArray::type_name((*array)->type())) + "[" + std::to_string((*array)->size()) + "]";
+    } else {
+        return "";
+    }
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), d);
+    return std::string(buf, ec == std::errc{} ? end : buf);
+}
+
+bool numeric_cell(const Value& v, double& out) {
+    if (auto d = get_ptr<double>(v)) { out = *d; return true; }
+    if (auto f = get_ptr<float>(v)) { out = *f; return true; }
+    if (auto i = get_ptr<int>(v)) { out = *i; return true; }
+    if (auto i = get_ptr<int64_t>(v)) { out = static_cast<double>(*i); return true; }
+    return false;
+}
+
+std::string lowercase(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+} // namespace
+
+TableModel::TableModel(TreeLikePtr tree, DataPath path, std::vector<TableModelColumn> columns,
+                       double refresh_seconds)
+    : _tree(std::move(tree))
+    , _path(std::move(path))
+    , _columns(std::move(columns))
+    , _derive_columns(_columns.empty())
+    , _refresh_seconds(refresh_seconds)
+    , _rows(std::make_shared<const std::vector<std::string>>())
+    , _view_rows(_rows)
+{
+}
+
+TableModel::~TableModel() {
+    _cancel_job();
+}
+
+void TableModel::update(double now) {
+    _now = now;
+    if (_cache.size() > MAX_CACHED_ROWS) {
+        _cache.clear();
+    }
+    if (now >= _next_reload) {
+        _reload_rows();
+        _next_reload = now + _refresh_seconds;
+    }
+    if (_collecting) {
+        _collect_keys();
+    }
+    if (_job && _job->done.load(std::memory_order_acquire)) {
+        _view_rows = _job->rows;
+        _view = std::move(_job->result);
+        _identity = false;
+        _job.reset();
+    }
+}
+
+void TableModel::invalidate() {
+    _cache.clear();
+    _rows = std::make_shared<const std::vector<std::string>>();
+    _next_reload = 0.0;
+}
+
+void TableModel::_reload_rows() {
+    auto names = _tree ? _tree->get_children_names(_path) : Err<std::vector<std::string>>("no tree");
+    if (!names) return;
+    if (*names == *_rows) return;
+
+    _rows = std::make_shared<const std::vector<std::string>>(std::move(*names));
+    if (_derive_columns && !_rows->empty()) {
+        if (auto keys = _tree->get_metadata_keys(_path / _rows->front()); keys && !keys->empty()) {
+            for (const auto& key : *keys) {
+                if (key != "version") _columns.push_back({key, key});
+            }
+            _derive_columns = false;
+        }
+    }
+    _restart_view();
+}
+
+size_t TableModel::row_count() const {
+    return _identity ? _view_rows->size() : _view.size();
+}
+
+const std::string& TableModel::row_name(size_t index) const {
+    return (*_view_rows)[_identity ? index : _view[index]];
+}
+
+Value TableModel::_read_value(const std::string& row, const std::string& key) const {
+    auto res = _tree->get(_path / row / key);
+    return res ? *res : Value{};
+}
+
+std::vector<std::string> TableModel::_read_cells(const std::string& row) const {
+    std::vector<std::string> cells;
+    cells.reserve(_columns.size());
+    for (const auto& column : _columns) {
+        cells.push_back(format_cell(_read_value(row, column.key)));
+    }
+    return cells;
+}
+
+std::optional<int64_t> TableModel::_read_version(const std::string& row) const {
+    Value v = _read_value(row, "version");
+    if (auto i = get_ptr<int64_t>(v)) return *i;
+    if (auto i = get_ptr<int>(v)) return *i;
+    return std::nullopt;
+}
+
+const std::vector<std::string>& TableModel::row_cells(size_t index) {
+    const std::string& name = row_name(index);
+    auto version = _read_version(name);
+
+    auto it = _cache.find(name);
+    if (it != _cache.end()) {
+        const auto& cached = it->second;
+        bool fresh = version
+            ? cached.version == version
+            : !cached.version && _now - cached.fetched_at < _refresh_seconds;
+        if (fresh) return cached.cells;
+    }
+
+    ++_rows_fetched;
+    auto& entry = _cache[name];
+    entry.cells = _read_cells(name);
+    entry.version = version;
+    entry.fetched_at = _now;
+    return entry.cells;
+}
+
+void TableModel::set_sort(int column, bool ascending) {
+    if (column >= static_cast<int>(_columns.size())) column = -1;
+    if (column == _sort_column && (column < 0 || ascending == _ascending)) return;
+    _sort_column = column;
+    _ascending = ascending;
+    _restart_view();
+}
+
+void TableModel::set_filter(const std::string& text) {
+    auto filter = lowercase(text);
+    if (filter == _filter) return;
+    _filter = std::move(filter);
+    _restart_view();
+}
+
+void TableModel::_cancel_job() {
+    if (_job) {
+        _job->cancel.store(true, std::memory_order_relaxed);
+        _job.reset();
+    }
+}
+
+void TableModel::_restart_view() {
+    _cancel_job();
+    _collecting = false;
+    _pending = Job{};
+
+    if (_sort_column < 0 && _filter.empty()) {
+        _view_rows = _rows;
+        _view.clear();
+        _identity = true;
+        return;
+    }
+
+    _pending.rows = _rows;
+    _pending.keys.resize(_rows->size());
+    _pending.sort_column = _sort_column;
+    _pending.ascending = _ascending;
+    _pending.filter = _filter;
+    _collected = 0;
+    _collecting = true;
+}
+
+void TableModel::_collect_keys() {
+    const auto& rows = *_pending.rows;
+    size_t end = std::min(rows.size(), _collected + COLLECT_BATCH);
+
+    for (size_t i = _collected; i < end; ++i) {
+        RowKey& key = _pending.keys[i];
+        if (!_pending.filter.empty()) {
+            // The filter needs every cell; the sort key comes along
+            auto cells = _read_cells(rows[i]);
+            for (const auto& cell : cells) {
+                key.haystack += lowercase(cell);
+                key.haystack += '\x1f';
+            }
+            if (_pending.sort_column >= 0) {
+                key.text = std::move(cells[_pending.sort_column]);
+                const char* text_end = key.text.data() + key.text.size();
+                auto [ptr, ec] = std::from_chars(key.text.data(), text_end, key.number);
+                key.numeric = ec == std::errc{} && ptr == text_end;
+            }
+        } else if (_pending.sort_column >= 0) {
+            Value v = _read_value(rows[i], _columns[_pending.sort_column].key);
+            key.numeric = numeric_cell(v, key.number);
+            if (!key.numeric) key.text = format_cell(v);
+        }
+    }
+    _collected = end;
+    if (_collected == rows.size()) {
+        _collecting = false;
+        _start_job();
+    }
+}
+
+void TableModel::_start_job() {
+    auto state = std::make_shared<JobState>();
+    state->rows = _pending.rows;
+    _job = state;
+
+    std::thread([state, job = std::move(_pending)] {
+        auto result = _run_job(job, state->cancel);
+        if (state->cancel.load(std::memory_order_relaxed)) return;
+        state->result = std::move(result);
+        state->done.store(true, std::memory_order_release);
+    }).detach();
+    _pending = Job{};
+}
+
+std::vector<uint32_t> TableModel::_run_job(const Job& job, const std::atomic<bool>& cancel) {
+    std::vector<uint32_t> order;
+    order.reserve(job.keys.size());
+    for (size_t i = 0; i < job.keys.size(); ++i) {
+        if (i % 65536 == 0 && cancel.load(std::memory_order_relaxed)) return {};
+        if (!job.filter.empty() && job.keys[i].haystack.find(job.filter) == std::string::npos) continue;
+        order.push_back(static_cast<uint32_t>(i));
+    }
+
+    if (job.sort_column >= 0) {
+        // Numbers before text; stable so equal keys keep tree order
+        auto less = [&](uint32_t a, uint32_t b) {
+            const RowKey& x = job.keys[a];
+            const RowKey& y = job.keys[b];
+            if (x.numeric != y.numeric) return x.numeric;
+            if (x.numeric) return x.number < y.number;
+            return x.text < y.text;
+        };
+        if (job.ascending) {
+            std::stable_sort(order.begin(), order.end(), less);
+        } else {
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return less(b, a); });
+        }
+    }
+    return order;
+}
+
+} // namespace ymery
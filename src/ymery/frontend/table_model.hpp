@@ -0,0 +1,144 @@
+// Table model - lazily fetched, sortable and filterable rows over tree children
+#pragma once
+
+#include "../result.hpp"
+#include "../types.hpp"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ymery {
+
+struct TableModelColumn {
+    std::string key;    // value read from each row node
+    std::string label;  // header text
+};
+
+/**
+ * TableModel - rows are the children of a tree node, cells are values under
+ * each row. Only rows that are asked for (the visible range) are read, and
+ * their cell text is cached. A row that publishes a "version" value is read
+ * again only when the version changes; other rows are re-read after the
+ * refresh interval.
+ *
+ * Sorting and filtering produce an index permutation. Tree implementations
+ * are not thread-safe, so the sort/filter keys are snapshotted on the UI
+ * thread in bounded batches per update(), then sorted and filtered on a
+ * worker thread. The previous permutation stays visible until the new one
+ * is ready.
+ *
+ * Everything except the worker runs on the UI thread.
+ */
+class TableModel {
+public:
+    TableModel(TreeLikePtr tree, DataPath path, std::vector<TableModelColumn> columns,
+               double refresh_seconds = 1.0);
+    ~TableModel();
+
+    TableModel(const TableModel&) = delete;
+    TableModel& operator=(const TableModel&) = delete;
+
+    // Once per frame: reloads the row list when due, advances the key
+    // snapshot and picks up finished sort/filter results
+    void update(double now);
+    // Drop cached rows and reload the row list on the next update
+    void invalidate();
+
+    // Columns; derived from the first row's metadata keys when none were given
+    const std::vector<TableModelColumn>& columns() const { return _columns; }
+
+    // Rows in display order, after filtering
+    size_t row_count() const;
+    const std::string& row_name(size_t index) const;
+    // Cell text, valid until the next update()
+    const std::vector<std::string>& row_cells(size_t index);
+
+    // column < 0 restores tree order
+    void set_sort(int column, bool ascending);
+    // Case-insensitive substring match over all cells; empty disables
+    void set_filter(const std::string& text);
+    int sort_column() const { return _sort_column; }
+    bool busy() const { return _collecting || _job != nullptr; }
+
+    // Rows read from the tree for display (cache misses)
+    size_t rows_fetched() const { return _rows_fetched; }
+
+    // Rows snapshotted per update() while collecting sort/filter keys
+    static constexpr size_t COLLECT_BATCH = 20000;
+    static constexpr size_t MAX_CACHED_ROWS = 4096;
+
+private:
+    using Rows = std::shared_ptr<const std::vector<std::string>>;
+
+    struct CachedRow {
+        std::vector<std::string> cells;
+        std::optional<int64_t> version;
+        double fetched_at = 0.0;
+    };
+
+    // Sort/filter input for one row
+    struct RowKey {
+        double number = 0.0;
+        bool numeric = false;
+        std::string text;      // sort column text
+        std::string haystack;  // lowercased cells for the filter
+    };
+
+    struct Job {
+        Rows rows;
+        std::vector<RowKey> keys;
+        int sort_column = -1;
+        bool ascending = true;
+        std::string filter;
+    };
+
+    // Shared with a detached worker, so an abandoned job never blocks the UI
+    struct JobState {
+        Rows rows;
+        std::atomic<bool> cancel{false};
+        std::atomic<bool> done{false};
+        std::vector<uint32_t> result;
+    };
+
+    void _reload_rows();
+    void _restart_view();
+    void _collect_keys();
+    void _start_job();
+    void _cancel_job();
+    Value _read_value(const std::string& row, const std::string& key) const;
+    std::vector<std::string> _read_cells(const std::string& row) const;
+    std::optional<int64_t> _read_version(const std::string& row) const;
+
+    static std::vector<uint32_t> _run_job(const Job& job, const std::atomic<bool>& cancel);
+
+    TreeLikePtr _tree;
+    DataPath _path;
+    std::vector<TableModelColumn> _columns;
+    bool _derive_columns = false;
+    double _refresh_seconds;
+    double _now = 0.0;
+    double _next_reload = 0.0;
+
+    Rows _rows;                      // latest children
+    Rows _view_rows;                 // rows the permutation refers to
+    std::vector<uint32_t> _view;     // display order
+    bool _identity = true;           // _view unused, display _view_rows as is
+
+    std::unordered_map<std::string, CachedRow> _cache;
+    size_t _rows_fetched = 0;
+
+    int _sort_column = -1;
+    bool _ascending = true;
+    std::string _filter;
+
+    bool _collecting = false;
+    Job _pending;
+    size_t _collected = 0;
+
+    std::shared_ptr<JobState> _job;
+};
+
+} // namespace ymery
@@ -1,6 +1,7 @@
 #include "widget.hpp"
 #include "widget_factory.hpp"
 #include <imgui.h>
+#include <imgui_internal.h>
 #include <ytrace/ytrace.hpp>
 
 namespace ymery {
@@ -24,22 +25,34 @@ Result<std::shared_ptr<Widget>> Widget::create(
 }
 
 Result<void> Widget::init() {
-    // Parse event handlers from statics
+    // Compile event handlers from statics
     if (auto res = _data_bag->get_static("event-handlers"); res) {
         if (auto handlers = get_as<Dict>(*res)) {
             for (const auto& [event_name, commands_val] : *handlers) {
-                if (auto commands = get_as<List>(commands_val)) {
-                    for (const auto& cmd : *commands) {
+                std::vector<Dict> commands;
+                if (auto list = get_as<List>(commands_val)) {
+                    for (const auto& cmd : *list) {
                         if (auto cmd_dict = get_as<Dict>(cmd)) {
-                            _event_handlers[event_name].push_back(*cmd_dict);
+                            commands.push_back(*cmd_dict);
+                        } else if (auto cmd_str = get_as<std::string>(cmd)) {
+                            commands.push_back(Dict{{*cmd_str, Value{}}});
                         }
                     }
                 } else if (auto cmd_dict = get_as<Dict>(commands_val)) {
-                    _event_handlers[event_name].push_back(*cmd_dict);
+                    commands.push_back(*cmd_dict);
                 } else if (auto cmd_str = get_as<std::string>(commands_val)) {
-                    Dict simple_cmd;
-                    simple_cmd[*cmd_str] = Value{};
-                    _event_handlers[event_name].push_back(simple_cmd);
+                    commands.push_back(Dict{{*cmd_str, Value{}}});
+                }
+
+                for (const auto& command : commands) {
+                    auto step = _compile_event_step(command);
+                    if (!step) {
+                        ywarn("Widget: skipping '{}' command: {}", event_name, step.error().to_string());
+                        continue;
+                    }
+                    auto& handler = _event_handlers[event_name];
+                    handler.waits = handler.waits || step->kind >= EventStep::Kind::Wait;
+                    handler.steps.push_back(std::move(*step));
                 }
             }
         }
@@ -48,6 +61,15 @@ Result<void> Widget::init() {
 }
 
 Result<void> Widget::dispose() {
+    _event_tasks.cancel();
+    for (auto& [_, handler] : _event_handlers) {
+        for (auto& step : handler.steps) {
+            if (step.widget) {
+                step.widget->dispose();
+                step.widget.reset();
+            }
+        }
+    }
     if (_body) {
         _body->dispose();
         _body.reset();
@@ -58,12 +80,18 @@ Result<void> Widget::dispose() {
 Result<void> Widget::render() {
     // Clear errors from previous render cycle
     _error_messages.clear();
+    _rendered = true;
 
     // Push styles - continue even on error
     if (auto res = _push_styles(); !res) {
         _handle_error(Err<void>("Widget::render: _push_styles failed", res));
     }
 
+    // Prepared data - continue even on error
+    if (auto res = _take_prepared(); !res) {
+        _handle_error(Err<void>("Widget::render: prepare failed", res));
+    }
+
     // Pre-render head - continue even on error
     if (_error_messages.empty()) {
         if (auto res = _pre_render_head(); !res) {
@@ -71,6 +99,9 @@ Result<void> Widget::render() {
         }
     }
 
+    // Advance waiting event tasks, in this widget's ImGui context
+    _resume_event_tasks();
+
     // Detect and execute events - continue even on error
     if (_error_messages.empty()) {
         if (auto res = _detect_and_execute_events(); !res) {
@@ -80,8 +111,8 @@ Result<void> Widget::render() {
 
     // Show tooltip if widget has tooltip property
     if (ImGui::IsItemHovered()) {
-        if (auto tooltip_res = _data_bag->get_static("tooltip"); tooltip_res) {
-            if (auto tooltip_text = get_as<std::string>(*tooltip_res)) {
+        if (const Value* tooltip = _data_bag->find_static("tooltip")) {
+            if (auto tooltip_text = get_ptr<std::string>(*tooltip)) {
                 ImGui::SetTooltip("%s", tooltip_text->c_str());
             }
         }
@@ -113,6 +144,47 @@ Result<void> Widget::render() {
     return _render_errors();
 }
 
+Result<void> Widget::prepare() {
+    _prepare_result = _prepare_head();
+    _prepared = true;
+    return _prepare_result;
+}
+
+void Widget::collect_prepare(std::vector<Widget*>& out) {
+    if (!_rendered) return;
+    _rendered = false;
+    if (_prepares_data()) out.push_back(this);
+    if (_body) _body->collect_prepare(out);
+    for (auto& [_, handler] : _event_handlers) {
+        for (auto& step : handler.steps) {
+            if (step.widget) step.widget->collect_prepare(out);
+        }
+    }
+}
+
+Result<void> Widget::_prepare_head() {
+    return Ok();
+}
+
+Result<void> Widget::_take_prepared() {
+    if (!_prepares_data()) return Ok();
+    if (!_prepared) prepare();
+    _prepared = false;
+    return _prepare_result;
+}
+
+void Widget::_push_imgui_id() {
+    // The parent ID stack is fixed for a widget, so the id only needs hashing once
+    if (_imgui_id == 0) {
+        _imgui_id = ImGui::GetID(_id_suffix.c_str());
+    }
+    ImGui::PushOverrideID(_imgui_id);
+}
+
+void Widget::_pop_imgui_id() {
+    ImGui::PopID();
+}
+
 void Widget::_handle_error(const Result<void>& result) {
     if (!result) {
         std::string err_str = result.error().to_string();
@@ -147,6 +219,32 @@ Result<void> Widget::_post_render_head() {
     return Ok();
 }
 
+size_t Widget::reload_definitions(const std::set<std::string>& changed) {
+    size_t rebuilt = 0;
+    // Widgets shown by event handlers are recreated on their next show
+    for (auto& [_, handler] : _event_handlers) {
+        for (auto& step : handler.steps) {
+            if (!step.widget) continue;
+            if (changed.count(step.widget->definition())) {
+                step.widget->dispose();
+                step.widget.reset();
+                ++rebuilt;
+            } else {
+                rebuilt += step.widget->reload_definitions(changed);
+            }
+        }
+    }
+
+    if (!_body) return rebuilt;
+    if (changed.count(_body->definition())) {
+        // Recreated from the new definition by _ensure_body() on the next render
+        _body->dispose();
+        _body.reset();
+        return rebuilt + 1;
+    }
+    return rebuilt + _body->reload_definitions(changed);
+}
+
 Result<void> Widget::_ensure_body() {
     if (_body) return Ok();
 
@@ -190,23 +288,22 @@ static int get_imgui_color_idx(const std::string& name) {
 }
 
 Result<void> Widget::_push_styles() {
-    auto style_res = _data_bag->get_static("style");
-    if (!style_res) return Ok();
-
-    auto style_dict = get_as<Dict>(*style_res);
+    // Read in place - runs for every widget on every frame
+    const Value* style = _data_bag->find_static("style");
+    auto style_dict = style ? get_ptr<Dict>(*style) : nullptr;
     if (!style_dict) return Ok();
 
     for (const auto& [name, val] : *style_dict) {
         int idx = get_imgui_color_idx(name);
         if (idx >= 0) {
-            if (auto color_list = get_as<List>(val)) {
+            if (auto color_list = get_ptr<List>(val)) {
                 if (color_list->size() >= 3) {
                     float r = 1.0f, g = 1.0f, b = 1.0f, a = 1.0f;
-                    if (auto rv = get_as<double>((*color_list)[0])) r = static_cast<float>(*rv);
-                    if (auto gv = get_as<double>((*color_list)[1])) g = static_cast<float>(*gv);
-                    if (auto bv = get_as<double>((*color_list)[2])) b = static_cast<float>(*bv);
+                    if (auto rv = get_ptr<double>((*color_list)[0])) r = static_cast<float>(*rv);
+                    if (auto gv = get_ptr<double>((*color_list)[1])) g = static_cast<float>(*gv);
+                    if (auto bv = get_ptr<double>((*color_list)[2])) b = static_cast<float>(*bv);
                     if (color_list->size() >= 4) {
-                        if (auto av = get_as<double>((*color_list)[3])) a = static_cast<float>(*av);
+                        if (auto av = get_ptr<double>((*color_list)[3])) a = static_cast<float>(*av);
                     }
                     ImGui::PushStyleColor(idx, ImVec4(r, g, b, a));
                     _pushed_colors.push_back({idx, 0.0f});
@@ -240,39 +337,164 @@ Result<void> Widget::_detect_and_execute_events() {
 Result<void> Widget::_execute_event_commands(const std::string& event_name) {
     auto it = _event_handlers.find(event_name);
     if (it == _event_handlers.end()) return Ok();
+    auto& handler = it->second;
+
+    // Failures are shown in the widget, like render errors
+    if (!handler.waits) {
+        for (auto& step : handler.steps) {
+            if (auto res = _execute_event_step(step); !res) {
+                _handle_error(Err<void>("Widget: '" + event_name + "' handler failed", res));
+                break;
+            }
+        }
+        return Ok();
+    }
 
-    for (const auto& command : it->second) {
-        _execute_event_command(command);
+    // Still waiting from an earlier trigger
+    if (_event_tasks.running(event_name)) return Ok();
+    if (auto res = _event_tasks.spawn(event_name, _run_event_steps(handler)); !res) {
+        _handle_error(Err<void>("Widget: '" + event_name + "' handler failed", res));
     }
     return Ok();
 }
 
-Result<void> Widget::_execute_event_command(const Dict& command) {
-    for (const auto& [cmd_type, cmd_data] : command) {
-        if (cmd_type == "show") {
-            // Create and render widget from spec
-            auto widget_res = _widget_factory->create_widget(_data_bag, cmd_data, _namespace);
-            if (widget_res) {
-                (*widget_res)->render();
+EventTask Widget::_run_event_steps(EventSteps& handler) {
+    for (auto& step : handler.steps) {
+        switch (step.kind) {
+        case EventStep::Kind::Wait:
+            co_await sleep_for(step.seconds);
+            break;
+        case EventStep::Kind::WaitFrames:
+            co_await next_frames(step.frames);
+            break;
+        case EventStep::Kind::WaitEvent:
+            if (auto event = co_await wait_event(_dispatcher, step.text); !event) {
+                co_return Err<void>("Widget: wait-event failed", event);
+            }
+            break;
+        case EventStep::Kind::Open: {
+            auto target = _data_bag->resolve_data_path(step.text);
+            if (!target) {
+                co_return Err<void>("Widget: open '" + step.text + "' does not resolve", target);
             }
-        } else if (cmd_type == "dispatch-event") {
-            Dict event;
-            if (auto name = get_as<std::string>(cmd_data)) {
-                event["name"] = cmd_data;
-            } else if (auto event_dict = get_as<Dict>(cmd_data)) {
-                event = *event_dict;
+            auto& [tree, path] = *target;
+            if (auto res = co_await wait_future(open_data_path(tree, path)); !res) {
+                co_return Err<void>("Widget: open failed", res);
             }
-            _dispatcher->dispatch_event(event);
-        } else if (cmd_type == "close") {
-            ImGui::CloseCurrentPopup();
-        } else if (cmd_type == "open-popup") {
-            if (auto popup_id = get_as<std::string>(cmd_data)) {
-                ImGui::OpenPopup(popup_id->c_str());
+            break;
+        }
+        default:
+            if (auto res = _execute_event_step(step); !res) {
+                co_return res;
             }
         }
-        break;
     }
-    return Ok();
+    co_return Ok();
+}
+
+void Widget::_resume_event_tasks() {
+    if (_event_tasks.empty()) return;
+    for (const auto& res : _event_tasks.tick()) {
+        _handle_error(Err<void>("Widget: event task failed", res));
+    }
+}
+
+Result<void> Widget::_execute_event_step(EventStep& step) {
+    switch (step.kind) {
+    case EventStep::Kind::Show:
+        // Created on the first show and reused while the widget lives
+        if (!step.widget) {
+            auto widget_res = _widget_factory->create_widget(_data_bag, step.spec, _namespace);
+            if (!widget_res) {
+                return Err<void>("Widget: show failed", widget_res);
+            }
+            step.widget = *widget_res;
+        }
+        return step.widget->render();
+    case EventStep::Kind::DispatchEvent:
+        if (!_dispatcher) return Err<void>("Widget: dispatch-event without a dispatcher");
+        return _dispatcher->dispatch_event(step.event);
+    case EventStep::Kind::Close:
+        ImGui::CloseCurrentPopup();
+        return Ok();
+    case EventStep::Kind::OpenPopup:
+        ImGui::OpenPopup(step.text.c_str());
+        return Ok();
+    default:
+        // Waiting steps only run in _run_event_steps
+        return Ok();
+    }
+}
+
+static std::optional<double> as_seconds(const Value& v) {
+    if (auto d = get_as<double>(v)) return *d;
+    if (auto i = get_as<int>(v)) return static_cast<double>(*i);
+    return std::nullopt;
+}
+
+Result<Widget::EventStep> Widget::_compile_event_step(const Dict& command) {
+    if (command.empty()) {
+        return Err<EventStep>("Widget::_compile_event_step: empty command");
+    }
+    const auto& [type, data] = *command.begin();
+    EventStep step;
+    if (type == "show") {
+        step.kind = EventStep::Kind::Show;
+        step.spec = data;
+    } else if (type == "dispatch-event") {
+        step.kind = EventStep::Kind::DispatchEvent;
+        if (auto name = get_as<std::string>(data)) {
+            step.event["name"] = data;
+        } else if (auto event_dict = get_as<Dict>(data)) {
+            step.event = *event_dict;
+        }
+    } else if (type == "close") {
+        step.kind = EventStep::Kind::Close;
+    } else if (type == "open-popup") {
+        step.kind = EventStep::Kind::OpenPopup;
+        auto popup_id = get_as<std::string>(data);
+        if (!popup_id) return Err<EventStep>("Widget::_compile_event_step: open-popup needs a popup id");
+        step.text = *popup_id;
+    } else if (type == "wait") {
+        // Seconds
+        step.kind = EventStep::Kind::Wait;
+        auto seconds = as_seconds(data);
+        if (!seconds || *seconds < 0.0) return Err<EventStep>("Widget::_compile_event_step: wait needs seconds");
+        step.seconds = *seconds;
+    } else if (type == "wait-frames") {
+        step.kind = EventStep::Kind::WaitFrames;
+        if (data.has_value()) {
+            auto frames = get_as<int>(data);
+            if (!frames || *frames < 0) return Err<EventStep>("Widget::_compile_event_step: wait-frames needs a count");
+            step.frames = *frames;
+        }
+    } else if (type == "wait-event") {
+        // An event name from any source, or {source, name}
+        step.kind = EventStep::Kind::WaitEvent;
+        if (auto name = get_as<std::string>(data)) {
+            step.text = "*/" + *name;
+        } else if (auto event_dict = get_as<Dict>(data)) {
+            std::string source, name;
+            if (auto it = event_dict->find("source"); it != event_dict->end()) {
+                source = get_as<std::string>(it->second).value_or("");
+            }
+            if (auto it = event_dict->find("name"); it != event_dict->end()) {
+                name = get_as<std::string>(it->second).value_or("");
+            }
+            step.text = (source.empty() ? std::string("*") : source) + "/" + name;
+        } else {
+            return Err<EventStep>("Widget::_compile_event_step: wait-event needs an event name");
+        }
+    } else if (type == "open") {
+        // Data-path spec, resolved on a background worker
+        step.kind = EventStep::Kind::Open;
+        auto spec = get_as<std::string>(data);
+        if (!spec) return Err<EventStep>("Widget::_compile_event_step: open needs a data path");
+        step.text = *spec;
+    } else {
+        return Err<EventStep>("Widget::_compile_event_step: unknown command '" + type + "'");
+    }
+    return step;
 }
 
 Result<void> Widget::handle_event(const Dict& event) {
@@ -4,10 +4,15 @@
 #include "../types.hpp"
 #include "../data_bag.hpp"
 #include "../dispatcher.hpp"
+#include "frame_arena.hpp"
+#include "event_task.hpp"
+#include <imgui.h>
 #include <map>
 #include <memory>
+#include <set>
 #include <vector>
 #include <functional>
+#include <string_view>
 #include <atomic>
 
 namespace ymery {
@@ -35,17 +40,41 @@ public:
     // Main render method
     virtual Result<void> render();
 
+    // Prepare phase (see FramePreparer): fetch and convert data for the next
+    // render() without calling ImGui. May run on a worker thread, concurrently
+    // with other widgets. A widget that was not prepared fetches inline.
+    Result<void> prepare();
+    // Append the widgets rendered since the last call that prepare data,
+    // in tree order
+    virtual void collect_prepare(std::vector<Widget*>& out);
+
     // Event handling
     virtual Result<void> handle_event(const Dict& event);
 
     // Accessors
     std::shared_ptr<DataBag> data_bag() const { return _data_bag; }
 
+    // YAML definition this widget was created from (empty for plain plugin widgets)
+    const std::string& definition() const { return _definition; }
+    void set_definition(const std::string& name) { _definition = name; }
+
+    // Hot reload: rebuild the descendants created from one of the `changed`
+    // definitions; the others keep their instance and state.
+    // Returns the number of widgets rebuilt.
+    virtual size_t reload_definitions(const std::set<std::string>& changed);
+
 protected:
     // Overridable rendering methods
     virtual Result<void> _pre_render_head();
     virtual Result<void> _post_render_head();
 
+    // Overridable prepare phase: widgets that return true from _prepares_data()
+    // do their data access in _prepare_head() and only submit in _pre_render_head()
+    virtual bool _prepares_data() const { return false; }
+    virtual Result<void> _prepare_head();
+    // Called by render(): the prepare result, preparing inline if needed
+    Result<void> _take_prepared();
+
     // Body management
     virtual Result<void> _ensure_body();
 
@@ -53,10 +82,47 @@ protected:
     virtual Result<void> _push_styles();
     virtual Result<void> _pop_styles();
 
-    // Event detection and execution
+    // One step of an `event-handlers` entry, compiled in init()
+    struct EventStep {
+        // Wait and the kinds after it may suspend
+        enum class Kind { Show, DispatchEvent, Close, OpenPopup, Wait, WaitFrames, WaitEvent, Open };
+        Kind kind = Kind::Show;
+        Value spec;                      // show: widget spec
+        Dict event;                      // dispatch-event
+        std::string text;                // open-popup id, wait-event key, open data-path
+        double seconds = 0.0;            // wait
+        int frames = 1;                  // wait-frames
+        std::shared_ptr<Widget> widget;  // show: created once, then reused
+    };
+    struct EventSteps {
+        std::vector<EventStep> steps;
+        bool waits = false;  // has a step that may suspend: runs as an EventTask
+    };
+
+    // Event detection and execution. A handler without waiting steps runs
+    // inline; one with wait, wait-frames, wait-event or open steps runs as an
+    // EventTask that _resume_event_tasks() advances once per render.
     virtual Result<void> _detect_and_execute_events();
     virtual Result<void> _execute_event_commands(const std::string& event_name);
-    virtual Result<void> _execute_event_command(const Dict& command);
+    virtual Result<void> _execute_event_step(EventStep& step);
+    Result<EventStep> _compile_event_step(const Dict& command);
+    EventTask _run_event_steps(EventSteps& handler);
+    void _resume_event_tasks();
+
+    // Scratch memory for this frame (labels, item lists, converted arrays),
+    // valid until the next frame starts. Render thread only: not for
+    // _prepare_head(), which may run on a worker.
+    static FrameArena& _arena() { return frame_arena(); }
+
+    // ImGui label "<label>###<uid>" built in the frame arena - no heap allocation,
+    // and the id stays stable when the label changes
+    const char* _imgui_label(std::string_view label) const {
+        return _arena().concat(label, _id_suffix);
+    }
+
+    // Push/pop an ID stack scope keyed by the precomputed widget id
+    void _push_imgui_id();
+    void _pop_imgui_id();
 
     // Error handling - accumulate errors and render at end
     void _handle_error(const Result<void>& result);
@@ -67,20 +133,32 @@ protected:
     std::shared_ptr<Dispatcher> _dispatcher;
     std::shared_ptr<DataBag> _data_bag;
     std::string _namespace;
+    std::string _definition;
 
     std::shared_ptr<Widget> _body;
     bool _is_body_activated = false;
 
-    std::map<std::string, std::vector<Dict>> _event_handlers;
+    std::map<std::string, EventSteps> _event_handlers;
+    // Declared after the handlers: waiting tasks refer to their steps
+    EventExecutor _event_tasks;
     std::vector<std::pair<int, float>> _pushed_colors;
     std::vector<std::pair<int, float>> _pushed_vars;
 
     // Error accumulator - error messages collected during render cycle
     std::vector<std::string> _error_messages;
 
+    // Prepare phase state
+    bool _rendered = false;
+    bool _prepared = false;
+    Result<void> _prepare_result;
+
     // Unique ID for ImGui
     std::string _uid = std::to_string(++_uid_counter);
     static inline std::atomic<int> _uid_counter{0};
+
+    // "###<uid>" suffix and the ImGuiID it hashes to (computed on first render)
+    std::string _id_suffix = "###" + _uid;
+    ImGuiID _imgui_id = 0;
 };
 
 using WidgetPtr = std::shared_ptr<Widget>;
@@ -150,7 +150,9 @@ Result<WidgetPtr> WidgetFactory::create_widget(
     // Handle built-in types first
     if (base_type == "composite") {
         ydebug("Creating built-in Composite widget with namespace '{}'", child_namespace);
-        return Composite::create(shared_from_this(), _dispatcher, child_namespace, data_bag);
+        auto res = Composite::create(shared_from_this(), _dispatcher, child_namespace, data_bag);
+        if (res && is_yaml_widget) (*res)->set_definition(widget_name);
+        return res;
     }
 
     // Create widget from plugin manager - let it fail if widget type unknown
@@ -165,6 +167,8 @@ Result<WidgetPtr> WidgetFactory::create_widget(
     if (!res) {
         return Err<WidgetPtr>("WidgetFactory::create_widget: unknown widget type '" + widget_type + "'", res);
     }
+    // Remembered so a hot reload can find the instances of a changed definition
+    if (is_yaml_widget) (*res)->set_definition(widget_name);
     return res;
 }
 
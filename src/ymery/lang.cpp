@@ -1,4 +1,5 @@
 #include "lang.hpp"
+#include "yaml_numeric.hpp"
 #include <fstream>
 #include <queue>
 #include <algorithm>
@@ -83,6 +84,16 @@ Result<void> Lang::init() {
     // Then load main module
     to_load.push({_main_module, _main_module});
 
+    if (auto res = _load_queue(to_load, nullptr); !res) {
+        return Err<void>("Lang::init: failed", res);
+    }
+    return Ok();
+}
+
+Result<void> Lang::_load_queue(
+    std::queue<std::pair<std::string, std::string>>& to_load,
+    LangChanges* changes
+) {
     while (!to_load.empty()) {
         auto [module_name, ns] = to_load.front();
         to_load.pop();
@@ -91,21 +102,58 @@ Result<void> Lang::init() {
             continue;
         }
 
-        auto res = _load_module(module_name, ns, to_load);
+        auto res = _load_module(module_name, ns, to_load, changes);
         if (!res) {
-            return Err<void>("Lang::init: failed to load module '" + module_name + "'", res);
+            return Err<void>("Lang::_load_queue: failed to load module '" + module_name + "'", res);
         }
 
         _loaded_modules.insert(module_name);
+        if (changes) changes->modules.push_back(module_name);
     }
-
     return Ok();
 }
 
+Result<LangChanges> Lang::reload_changed() {
+    LangChanges changes;
+    std::queue<std::pair<std::string, std::string>> to_load;
+
+    for (auto& [module_name, source] : _module_sources) {
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(source.path, ec);
+        if (ec || mtime == source.mtime) continue;
+        source.mtime = mtime;
+
+        YAML::Node root;
+        try {
+            root = YAML::LoadFile(source.path.string());
+        } catch (const YAML::Exception& e) {
+            changes.errors.push_back(module_name + ": " + e.what());
+            continue;
+        }
+        _apply_module(root, source.namespace_, true, to_load, &source, &changes);
+        changes.modules.push_back(module_name);
+    }
+
+    // Modules imported for the first time by the edits
+    if (auto res = _load_queue(to_load, &changes); !res) {
+        return Err<LangChanges>("Lang::reload_changed: failed", res);
+    }
+    return changes;
+}
+
+std::vector<std::filesystem::path> Lang::module_files() const {
+    std::vector<std::filesystem::path> files;
+    for (const auto& [_, source] : _module_sources) {
+        files.push_back(source.path);
+    }
+    return files;
+}
+
 Result<void> Lang::_load_module(
     const std::string& module_name,
     const std::string& namespace_,
-    std::queue<std::pair<std::string, std::string>>& to_load
+    std::queue<std::pair<std::string, std::string>>& to_load,
+    LangChanges* changes
 ) {
     auto path_res = _resolve_module_path(module_name);
     if (!path_res) {
@@ -114,6 +162,10 @@ Result<void> Lang::_load_module(
 
     auto path = *path_res;
 
+    // Stat before reading so a save during the parse is picked up by the next reload
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+
     // Load YAML file
     YAML::Node root;
     try {
@@ -122,37 +174,11 @@ Result<void> Lang::_load_module(
         return Err<void>("Lang::_load_module: YAML parse error: " + std::string(e.what()));
     }
 
-    // Process 'import' section - queue imported modules for loading
-    if (root["import"]) {
-        for (const auto& import_node : root["import"]) {
-            std::string import_name = import_node.as<std::string>();
-            // Queue with import name as both module name and namespace
-            to_load.push({import_name, import_name});
-        }
-    }
-
-    // Process 'widgets' section
-    if (root["widgets"]) {
-        for (const auto& kv : root["widgets"]) {
-            std::string widget_name = kv.first.as<std::string>();
-            std::string full_name = namespace_ + "." + widget_name;
-            _widget_definitions[full_name] = _yaml_to_dict(kv.second);
-        }
-    }
-
-    // Process 'data' section
-    if (root["data"]) {
-        for (const auto& kv : root["data"]) {
-            std::string data_name = kv.first.as<std::string>();
-            _data_definitions[data_name] = _yaml_to_dict(kv.second);
-        }
-    }
-
-    // Process 'app' section
-    if (root["app"]) {
-        _app_config = _yaml_to_dict(root["app"]);
-    }
-
+    auto& source = _module_sources[module_name];
+    source.path = path;
+    source.namespace_ = namespace_;
+    source.mtime = mtime;
+    _apply_module(root, namespace_, true, to_load, &source, changes);
     return Ok();
 }
 
@@ -169,37 +195,94 @@ Result<void> Lang::_load_module_from_string(
         return Err<void>("Lang::_load_module_from_string: YAML parse error: " + std::string(e.what()));
     }
 
+    // 'app' section only applies if not already set by main module
+    _apply_module(root, namespace_, false, to_load, nullptr, nullptr);
+    return Ok();
+}
+
+static std::string yaml_fingerprint(const YAML::Node& node) {
+    YAML::Emitter emitter;
+    emitter << node;
+    return emitter.c_str();
+}
+
+void Lang::_apply_module(
+    const YAML::Node& root,
+    const std::string& namespace_,
+    bool override_app,
+    std::queue<std::pair<std::string, std::string>>& to_load,
+    ModuleSource* source,
+    LangChanges* changes
+) {
     // Process 'import' section - queue imported modules for loading
     if (root["import"]) {
         for (const auto& import_node : root["import"]) {
             std::string import_name = import_node.as<std::string>();
+            // Queue with import name as both module name and namespace
             to_load.push({import_name, import_name});
         }
     }
 
     // Process 'widgets' section
+    std::set<std::string> widgets;
     if (root["widgets"]) {
         for (const auto& kv : root["widgets"]) {
             std::string widget_name = kv.first.as<std::string>();
             std::string full_name = namespace_ + "." + widget_name;
-            _widget_definitions[full_name] = _yaml_to_dict(kv.second);
+            std::string fingerprint = yaml_fingerprint(kv.second);
+            auto it = _widget_fingerprints.find(full_name);
+            if (it == _widget_fingerprints.end() || it->second != fingerprint) {
+                if (changes) changes->widgets.insert(full_name);
+                _widget_fingerprints[full_name] = std::move(fingerprint);
+                _widget_definitions[full_name] = _yaml_to_dict(kv.second);
+            }
+            widgets.insert(full_name);
         }
     }
 
     // Process 'data' section
+    std::set<std::string> data;
     if (root["data"]) {
         for (const auto& kv : root["data"]) {
             std::string data_name = kv.first.as<std::string>();
-            _data_definitions[data_name] = _yaml_to_dict(kv.second);
+            std::string fingerprint = yaml_fingerprint(kv.second);
+            auto it = _data_fingerprints.find(data_name);
+            if (it == _data_fingerprints.end() || it->second != fingerprint) {
+                if (changes) changes->data = true;
+                _data_fingerprints[data_name] = std::move(fingerprint);
+                _data_definitions[data_name] = _yaml_to_dict(kv.second);
+            }
+            data.insert(data_name);
         }
     }
 
-    // Process 'app' section - only if not already set by main module
-    if (root["app"] && _app_config.empty()) {
-        _app_config = _yaml_to_dict(root["app"]);
+    // Process 'app' section
+    if (root["app"] && (override_app || _app_config.empty())) {
+        std::string fingerprint = yaml_fingerprint(root["app"]);
+        if (fingerprint != _app_fingerprint) {
+            if (changes) changes->app = true;
+            _app_fingerprint = std::move(fingerprint);
+            _app_config = _yaml_to_dict(root["app"]);
+        }
     }
 
-    return Ok();
+    if (!source) return;
+
+    // Definitions the module no longer has
+    for (const auto& name : source->widgets) {
+        if (widgets.count(name)) continue;
+        _widget_definitions.erase(name);
+        _widget_fingerprints.erase(name);
+        if (changes) changes->widgets.insert(name);
+    }
+    for (const auto& name : source->data) {
+        if (data.count(name)) continue;
+        _data_definitions.erase(name);
+        _data_fingerprints.erase(name);
+        if (changes) changes->data = true;
+    }
+    source->widgets = std::move(widgets);
+    source->data = std::move(data);
 }
 
 Result<std::filesystem::path> Lang::_resolve_module_path(const std::string& module_name) {
@@ -239,6 +322,11 @@ Value Lang::_yaml_to_value(const YAML::Node& node) {
         return Value{};
     }
 
+    // !f32 / !f64 / !i32 tagged data becomes one contiguous array
+    if (auto array = yaml_to_numeric_array(node)) {
+        return Value(array);
+    }
+
     if (node.IsScalar()) {
         // Try to determine type
         std::string str = node.as<std::string>();
@@ -11,6 +11,17 @@
 
 namespace ymery {
 
+// What a Lang::reload_changed() pass touched
+struct LangChanges {
+    std::vector<std::string> modules;   // modules that were re-parsed or newly imported
+    std::vector<std::string> errors;    // modules that failed to parse
+    std::set<std::string> widgets;      // widget definitions added, removed or changed
+    bool data = false;                  // a data: section changed
+    bool app = false;                   // an app: section changed
+
+    bool empty() const { return widgets.empty() && !data && !app; }
+};
+
 // Lang - YAML loader and module resolver
 class Lang {
 public:
@@ -28,14 +39,32 @@ public:
     // Lifecycle
     Result<void> init();
 
+    // Re-parse the modules whose file changed since it was loaded and diff
+    // their definitions against the previous ones. A module that fails to
+    // parse keeps its old definitions until it is saved again.
+    Result<LangChanges> reload_changed();
+
+    // Files of all loaded modules (builtin excluded)
+    std::vector<std::filesystem::path> module_files() const;
+
 private:
     Lang() = default;
 
+    // Where a loaded module came from and what it defined
+    struct ModuleSource {
+        std::filesystem::path path;
+        std::string namespace_;
+        std::filesystem::file_time_type mtime;
+        std::set<std::string> widgets;  // full names
+        std::set<std::string> data;
+    };
+
     // Module loading
     Result<void> _load_module(
         const std::string& module_name,
         const std::string& namespace_,
-        std::queue<std::pair<std::string, std::string>>& to_load
+        std::queue<std::pair<std::string, std::string>>& to_load,
+        LangChanges* changes
     );
     Result<void> _load_module_from_string(
         const std::string& yaml_content,
@@ -44,6 +73,20 @@ private:
     );
     Result<std::filesystem::path> _resolve_module_path(const std::string& module_name);
 
+    // Register the sections of a parsed module, recording changes against
+    // the definitions it had before
+    void _apply_module(
+        const YAML::Node& root,
+        const std::string& namespace_,
+        bool override_app,
+        std::queue<std::pair<std::string, std::string>>& to_load,
+        ModuleSource* source,
+        LangChanges* changes
+    );
+
+    // Load queued modules breadth-first
+    Result<void> _load_queue(std::queue<std::pair<std::string, std::string>>& to_load, LangChanges* changes);
+
     // Builtin layouts
     static const char* _get_builtin_yaml();
 
@@ -59,6 +102,12 @@ private:
     Dict _app_config;
 
     std::set<std::string> _loaded_modules;
+    std::map<std::string, ModuleSource> _module_sources;
+
+    // Emitted YAML of each definition, to tell real edits from re-saves
+    std::map<std::string, std::string> _widget_fingerprints;
+    std::map<std::string, std::string> _data_fingerprints;
+    std::string _app_fingerprint;
 };
 
 using LangPtr = std::shared_ptr<Lang>;
@@ -1,9 +1,17 @@
 #pragma once
 
+#include "result.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <chrono>
+#include <vector>
 #include <ytrace/ytrace.hpp>
 #include <spdlog/sinks/base_sink.h>
 #include <imgui.h>
@@ -18,38 +26,158 @@ struct LogEntry {
     std::string timestamp;
     std::string source_file;
     int source_line;
+    int64_t time_ns = 0;     // system clock, nanoseconds since epoch
+    uint64_t sequence = 0;   // position in the log stream
 };
 
-// Thread-local ring buffer for spdlog messages
+// Format a system clock time as HH:MM:SS.mmm (local time)
+inline std::string format_log_timestamp(int64_t time_ns) {
+    auto tp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time_ns)));
+    auto time_t = std::chrono::system_clock::to_time_t(tp);
+    auto ms = (time_ns / 1000000) % 1000;
+
+    std::tm tm_buf;
+#ifdef _WIN32
+    localtime_s(&tm_buf, &time_t);
+#else
+    localtime_r(&time_t, &tm_buf);
+#endif
+
+    char timestamp[32];
+    size_t n = std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &tm_buf);
+    std::snprintf(timestamp + n, sizeof(timestamp) - n, ".%03d", static_cast<int>(ms));
+    return timestamp;
+}
+
+/**
+ * Lock-free multi-producer ring buffer for spdlog messages
+ *
+ * Producers claim a sequence number with one fetch_add and copy the raw
+ * message into preallocated storage; no mutex, allocation or timestamp
+ * formatting happens on the logging thread. Each slot carries a seqlock
+ * stamp: the payload is copied with relaxed atomic word stores and loads,
+ * and a reader keeps a copy only if the stamp is unchanged after it, so an
+ * entry overwritten while being copied is skipped rather than returned torn.
+ *
+ * A writer takes its slot with a CAS that only moves the stamp forward and
+ * only from a slot no other writer is copying into. Two writers a full
+ * ring apart meet in one slot only when more writers than slots are
+ * logging at once (capacity() is sized for far fewer); the later one then
+ * drops its entry, and the earlier one's entry is dropped with it.
+ * Readers pull entries incrementally by sequence number and watch
+ * generation() to know when anything changed.
+ */
 class LogBuffer {
 public:
-    explicit LogBuffer(size_t max_size = 1000) : _max_size(max_size) {}
-
-    // Add a log entry
-    void add(LogEntry entry) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _entries.push_back(std::move(entry));
-        while (_entries.size() > _max_size) {
-            _entries.pop_front();
+    static constexpr size_t MESSAGE_CAPACITY = 512;
+    static constexpr size_t LOGGER_CAPACITY = 32;
+    static constexpr size_t SOURCE_CAPACITY = 128;
+
+    explicit LogBuffer(size_t max_size = 1000)
+        : _capacity(std::bit_ceil(std::max<size_t>(max_size, 2)))
+        , _mask(_capacity - 1)
+        , _slots(new Slot[_capacity])
+        , _max_size(max_size) {}
+
+    // Add a log entry straight from spdlog (lock-free)
+    void add(const spdlog::details::log_msg& msg) {
+        auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            msg.time.time_since_epoch()).count();
+        _push(msg.payload.data(), msg.payload.size(),
+              msg.logger_name.data(), msg.logger_name.size(),
+              msg.level, time_ns, msg.source.filename, msg.source.line);
+    }
+
+    // Add a prebuilt entry (lock-free)
+    void add(const LogEntry& entry) {
+        _push(entry.message.data(), entry.message.size(),
+              entry.logger_name.data(), entry.logger_name.size(),
+              entry.level, entry.time_ns, entry.source_file.c_str(), entry.source_line);
+    }
+
+    /**
+     * Copy entries with sequence >= `from` into `out` (oldest first) and
+     * return the sequence to pass next time. Stops at a slot whose writer
+     * has claimed it but not finished, so entries are never delivered out
+     * of order; skips slots overwritten before or while being copied.
+     */
+    uint64_t read_since(uint64_t from, std::vector<LogEntry>& out) const {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t start = std::max(from, _cleared_at.load(std::memory_order_acquire));
+        size_t visible = std::min(_capacity, _max_size.load(std::memory_order_relaxed));
+        if (head > visible) start = std::max(start, head - visible);
+
+        for (uint64_t seq = start; seq < head; ++seq) {
+            const Slot& slot = _slots[seq & _mask];
+            uint64_t stamp = slot.stamp.load(std::memory_order_acquire);
+            // Stamps of a slot only grow: below done, this entry's writer
+            // has not started or not finished yet; above, it was
+            // overwritten or dropped
+            if (stamp < _done_stamp(seq)) {
+                return seq;
+            }
+            if (stamp != _done_stamp(seq)) {
+                continue;  // overwritten by a newer entry
+            }
+
+            Payload payload;
+            _load_payload(slot, payload);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.stamp.load(std::memory_order_relaxed) != stamp) {
+                continue;  // overwritten while copying - the copy may be torn
+            }
+
+            LogEntry entry;
+            entry.message.assign(payload.message, payload.message_len);
+            entry.logger_name.assign(payload.logger, payload.logger_len);
+            entry.source_file.assign(payload.source_file, payload.source_len);
+            entry.level = payload.level;
+            entry.time_ns = payload.time_ns;
+            entry.source_line = payload.source_line;
+            entry.sequence = seq;
+
+            // Deferred formatting - only entries that are actually read pay for it
+            entry.timestamp = format_log_timestamp(entry.time_ns);
+            out.push_back(std::move(entry));
         }
+        return head;
     }
 
-    // Get all entries (thread-safe copy)
+    // Get all entries (copy)
     [[nodiscard]] std::deque<LogEntry> entries() const {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _entries;
+        std::vector<LogEntry> out;
+        read_since(0, out);
+        return std::deque<LogEntry>(std::make_move_iterator(out.begin()), std::make_move_iterator(out.end()));
+    }
+
+    // Changes whenever entries are added or cleared
+    [[nodiscard]] uint64_t generation() const {
+        return _head.load(std::memory_order_acquire) + _clears.load(std::memory_order_acquire);
+    }
+
+    // Changes on clear/resize - readers should drop their cached entries
+    [[nodiscard]] uint64_t epoch() const {
+        return _clears.load(std::memory_order_acquire);
+    }
+
+    // Sequence number of the next entry to be written
+    [[nodiscard]] uint64_t head() const {
+        return _head.load(std::memory_order_acquire);
     }
 
     // Get entries count
     [[nodiscard]] size_t size() const {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _entries.size();
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t start = _cleared_at.load(std::memory_order_acquire);
+        return static_cast<size_t>(std::min<uint64_t>(head - std::min(head, start),
+                                                      std::min(_capacity, _max_size.load())));
     }
 
-    // Clear all entries
+    // Clear all entries (hides everything written so far)
     void clear() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _entries.clear();
+        _cleared_at.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+        _clears.fetch_add(1, std::memory_order_acq_rel);
     }
 
     // Get max size
@@ -57,13 +185,21 @@ public:
         return _max_size;
     }
 
-    // Set max size
-    void set_max_size(size_t max_size) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _max_size = max_size;
-        while (_entries.size() > _max_size) {
-            _entries.pop_front();
+    // Slots preallocated at construction - the largest max size
+    [[nodiscard]] size_t capacity() const {
+        return _capacity;
+    }
+
+    // Set max size; the slots are shared with lock-free producers and cannot
+    // be reallocated, so sizes above capacity() are rejected
+    Result<void> set_max_size(size_t max_size) {
+        if (max_size > _capacity) {
+            return Err<void>("LogBuffer::set_max_size: " + std::to_string(max_size) +
+                             " exceeds the capacity of " + std::to_string(_capacity) + " entries");
         }
+        _max_size = max_size;
+        _clears.fetch_add(1, std::memory_order_acq_rel);
+        return Ok();
     }
 
     // Level to string
@@ -93,12 +229,142 @@ public:
     }
 
 private:
-    mutable std::mutex _mutex;
-    std::deque<LogEntry> _entries;
-    size_t _max_size;
+    static constexpr size_t WORD = sizeof(uint64_t);
+
+    // Slot contents, stored as words so that they can be copied with atomic ops
+    struct Slot {
+        std::atomic<uint64_t> stamp{0};  // sequence << 3 | state, bit 0 set while a writer copies
+        uint64_t header[3] = {};         // level and line, time_ns, lengths
+        uint64_t message[MESSAGE_CAPACITY / WORD];
+        uint64_t logger[LOGGER_CAPACITY / WORD];
+        uint64_t source_file[SOURCE_CAPACITY / WORD];
+    };
+
+    // Reader's private copy of a slot
+    struct Payload {
+        spdlog::level::level_enum level = spdlog::level::info;
+        int64_t time_ns = 0;
+        int source_line = 0;
+        size_t message_len = 0;
+        size_t logger_len = 0;
+        size_t source_len = 0;
+        char message[MESSAGE_CAPACITY];
+        char logger[LOGGER_CAPACITY];
+        char source_file[SOURCE_CAPACITY];
+    };
+
+    // Slot states, in the order a slot's stamp goes through them for one
+    // sequence. Dropped: the entry was given up; busy while an older writer
+    // is still copying into the slot.
+    static constexpr uint64_t WRITING = 1;
+    static constexpr uint64_t DONE = 2;
+    static constexpr uint64_t DROPPED_BUSY = 5;
+    static constexpr uint64_t DROPPED = 6;
+    static constexpr uint64_t BUSY = 1;
+
+    static uint64_t _stamp(uint64_t seq, uint64_t state) { return (seq << 3) | state; }
+    static uint64_t _writing_stamp(uint64_t seq) { return _stamp(seq, WRITING); }
+    static uint64_t _done_stamp(uint64_t seq) { return _stamp(seq, DONE); }
+
+    // Take the slot for seq; false if the entry has to be dropped
+    static bool _claim(Slot& slot, uint64_t seq) {
+        uint64_t stamp = slot.stamp.load(std::memory_order_acquire);
+        while (stamp < _writing_stamp(seq)) {
+            uint64_t next = (stamp & BUSY) ? _stamp(seq, DROPPED_BUSY) : _writing_stamp(seq);
+            if (slot.stamp.compare_exchange_weak(stamp, next, std::memory_order_acq_rel)) {
+                return next == _writing_stamp(seq);
+            }
+        }
+        return false;  // a writer a lap ahead already has the slot
+    }
+
+    // Publish the entry, or, if a newer writer dropped its entry meanwhile,
+    // leave the slot free under that writer's stamp
+    static void _release(Slot& slot, uint64_t seq) {
+        uint64_t stamp = _writing_stamp(seq);
+        if (slot.stamp.compare_exchange_strong(stamp, _done_stamp(seq), std::memory_order_release)) {
+            return;
+        }
+        while (!slot.stamp.compare_exchange_weak(stamp, stamp - DROPPED_BUSY + DROPPED,
+                                                 std::memory_order_release)) {}
+    }
+
+    static void _store_word(uint64_t& word, uint64_t value) {
+        std::atomic_ref<uint64_t>(word).store(value, std::memory_order_relaxed);
+    }
+    static uint64_t _load_word(const uint64_t& word) {
+        return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(word)).load(std::memory_order_relaxed);
+    }
+
+    static void _store_bytes(uint64_t* words, const char* bytes, size_t len) {
+        for (size_t i = 0; i < len; i += WORD) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + i, std::min(WORD, len - i));
+            _store_word(words[i / WORD], word);
+        }
+    }
+    static void _load_bytes(const uint64_t* words, char* bytes, size_t len) {
+        for (size_t i = 0; i < len; i += WORD) {
+            uint64_t word = _load_word(words[i / WORD]);
+            std::memcpy(bytes + i, &word, std::min(WORD, len - i));
+        }
+    }
+
+    static void _load_payload(const Slot& slot, Payload& payload) {
+        uint64_t fields = _load_word(slot.header[0]);
+        uint64_t lengths = _load_word(slot.header[2]);
+        payload.level = static_cast<spdlog::level::level_enum>(fields & 0xff);
+        payload.source_line = static_cast<int>(static_cast<int64_t>(fields) >> 32);
+        payload.time_ns = static_cast<int64_t>(_load_word(slot.header[1]));
+        // A torn header can hold any lengths - clamp before copying
+        payload.message_len = std::min<size_t>(lengths & 0xffff, MESSAGE_CAPACITY);
+        payload.logger_len = std::min<size_t>((lengths >> 16) & 0xff, LOGGER_CAPACITY);
+        payload.source_len = std::min<size_t>((lengths >> 24) & 0xff, SOURCE_CAPACITY);
+        _load_bytes(slot.message, payload.message, payload.message_len);
+        _load_bytes(slot.logger, payload.logger, payload.logger_len);
+        _load_bytes(slot.source_file, payload.source_file, payload.source_len);
+    }
+
+    void _push(const char* message, size_t message_len,
+               const char* logger, size_t logger_len,
+               spdlog::level::level_enum level, int64_t time_ns,
+               const char* source_file, int source_line) {
+        uint64_t seq = _head.fetch_add(1, std::memory_order_acq_rel);
+        Slot& slot = _slots[seq & _mask];
+
+        if (!_claim(slot, seq)) return;
+        std::atomic_thread_fence(std::memory_order_release);
+
+        message_len = std::min(message_len, MESSAGE_CAPACITY);
+        logger_len = std::min(logger_len, LOGGER_CAPACITY);
+        // Keep the end of long paths, where the file name is
+        size_t source_len = source_file ? std::strlen(source_file) : 0;
+        if (source_len > SOURCE_CAPACITY) {
+            source_file += source_len - SOURCE_CAPACITY;
+            source_len = SOURCE_CAPACITY;
+        }
+        _store_bytes(slot.message, message, message_len);
+        _store_bytes(slot.logger, logger, logger_len);
+        _store_bytes(slot.source_file, source_file, source_len);
+        _store_word(slot.header[0], (static_cast<uint64_t>(static_cast<uint32_t>(source_line)) << 32) |
+                                    static_cast<uint8_t>(level));
+        _store_word(slot.header[1], static_cast<uint64_t>(time_ns));
+        _store_word(slot.header[2], message_len | (logger_len << 16) | (source_len << 24));
+
+        _release(slot, seq);
+    }
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<size_t> _max_size;
+
+    alignas(64) std::atomic<uint64_t> _head{0};
+    alignas(64) std::atomic<uint64_t> _cleared_at{0};
+    std::atomic<uint64_t> _clears{0};
 };
 
-// Global log buffer (shared across threads, mutex-protected)
+// Global log buffer (shared across threads, lock-free)
 inline LogBuffer& get_log_buffer() {
     static LogBuffer buffer;
     return buffer;
@@ -112,35 +378,7 @@ public:
 
 protected:
     void sink_it_(const spdlog::details::log_msg& msg) override {
-        // Format timestamp
-        auto time_t = std::chrono::system_clock::to_time_t(msg.time);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            msg.time.time_since_epoch()) % 1000;
-
-        std::tm tm_buf;
-#ifdef _WIN32
-        localtime_s(&tm_buf, &time_t);
-#else
-        localtime_r(&time_t, &tm_buf);
-#endif
-
-        char timestamp[32];
-        std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &tm_buf);
-
-        // Pad milliseconds
-        std::string ms_str = std::to_string(ms.count());
-        while (ms_str.size() < 3) ms_str = "0" + ms_str;
-        std::string ts = std::string(timestamp) + "." + ms_str;
-
-        LogEntry entry;
-        entry.message = std::string(msg.payload.data(), msg.payload.size());
-        entry.logger_name = std::string(msg.logger_name.data(), msg.logger_name.size());
-        entry.level = msg.level;
-        entry.timestamp = ts;
-        entry.source_file = msg.source.filename ? msg.source.filename : "";
-        entry.source_line = msg.source.line;
-
-        _buffer.add(std::move(entry));
+        _buffer.add(msg);
     }
 
     void flush_() override {}
@@ -153,8 +391,9 @@ using LogBufferSinkMt = LogBufferSink<std::mutex>;
 using LogBufferSinkSt = LogBufferSink<spdlog::details::null_mutex>;
 
 // Helper to add log buffer sink to default logger
+// LogBuffer is itself thread-safe, so the sink needs no mutex of its own
 inline void setup_log_buffer_sink() {
-    auto sink = std::make_shared<LogBufferSinkMt>(get_log_buffer());
+    auto sink = std::make_shared<LogBufferSinkSt>(get_log_buffer());
     spdlog::default_logger()->sinks().push_back(sink);
 }
 
@@ -247,6 +247,96 @@ Result<void> PluginManager::init() {
         yinfo("PluginManager: registered embedded device-manager plugin 'waveform'");
     }
 
+    // recorder (capture-to-disk)
+    {
+        PluginMeta meta;
+        meta.registered_name = "recorder";
+        meta.class_name = "recorder";
+        meta.create_fn = TreeLikeCreateFn([](
+            std::shared_ptr<Dispatcher> /*dispatcher*/,
+            std::shared_ptr<PluginManager> /*pm*/
+        ) -> Result<TreeLikePtr> {
+            return embedded::create_recorder_manager();
+        });
+        _plugins["device-manager"]["recorder"] = meta;
+        yinfo("PluginManager: registered embedded device-manager plugin 'recorder'");
+    }
+
+    // playback (audio output mixer)
+    {
+        PluginMeta meta;
+        meta.registered_name = "playback";
+        meta.class_name = "playback";
+        meta.create_fn = TreeLikeCreateFn([](
+            std::shared_ptr<Dispatcher> /*dispatcher*/,
+            std::shared_ptr<PluginManager> /*pm*/
+        ) -> Result<TreeLikePtr> {
+            return embedded::create_playback_manager();
+        });
+        _plugins["device-manager"]["playback"] = meta;
+        yinfo("PluginManager: registered embedded device-manager plugin 'playback'");
+    }
+
+    // resampler (sample-rate conversion)
+    {
+        PluginMeta meta;
+        meta.registered_name = "resampler";
+        meta.class_name = "resampler";
+        meta.create_fn = TreeLikeCreateFn([](
+            std::shared_ptr<Dispatcher> /*dispatcher*/,
+            std::shared_ptr<PluginManager> /*pm*/
+        ) -> Result<TreeLikePtr> {
+            return embedded::create_resampler_manager();
+        });
+        _plugins["device-manager"]["resampler"] = meta;
+        yinfo("PluginManager: registered embedded device-manager plugin 'resampler'");
+    }
+
+    // simulator (simulated capture devices, virtual clock)
+    {
+        PluginMeta meta;
+        meta.registered_name = "simulator";
+        meta.class_name = "simulator";
+        meta.create_fn = TreeLikeCreateFn([](
+            std::shared_ptr<Dispatcher> /*dispatcher*/,
+            std::shared_ptr<PluginManager> /*pm*/
+        ) -> Result<TreeLikePtr> {
+            return embedded::create_simulator_manager();
+        });
+        _plugins["device-manager"]["simulator"] = meta;
+        yinfo("PluginManager: registered embedded device-manager plugin 'simulator'");
+    }
+
+    // timeseries (columnar time series store)
+    {
+        PluginMeta meta;
+        meta.registered_name = "timeseries";
+        meta.class_name = "timeseries";
+        meta.create_fn = TreeLikeCreateFn([](
+            std::shared_ptr<Dispatcher> /*dispatcher*/,
+            std::shared_ptr<PluginManager> /*pm*/
+        ) -> Result<TreeLikePtr> {
+            return embedded::create_timeseries_manager();
+        });
+        _plugins["device-manager"]["timeseries"] = meta;
+        yinfo("PluginManager: registered embedded device-manager plugin 'timeseries'");
+    }
+
+    // table-file (CSV/TSV and columnar files)
+    {
+        PluginMeta meta;
+        meta.registered_name = "table-file";
+        meta.class_name = "table-file";
+        meta.create_fn = TreeLikeCreateFn([](
+            std::shared_ptr<Dispatcher> /*dispatcher*/,
+            std::shared_ptr<PluginManager> /*pm*/
+        ) -> Result<TreeLikePtr> {
+            return embedded::create_table_file_manager();
+        });
+        _plugins["device-manager"]["table-file"] = meta;
+        yinfo("PluginManager: registered embedded device-manager plugin 'table-file'");
+    }
+
     // kernel (central manager)
     {
         PluginMeta meta;
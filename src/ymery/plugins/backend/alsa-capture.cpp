@@ -0,0 +1,412 @@
+// ALSA capture implementation
+#include "alsa-capture.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <ytrace/ytrace.hpp>
+
+namespace ymery::plugins {
+
+// ============== AlsaDevice ==============
+
+Result<std::shared_ptr<AlsaDevice>> AlsaDevice::create(
+    const std::string& device_name,
+    int num_channels,
+    int sample_rate,
+    size_t period_size,
+    size_t buffer_size
+) {
+    using DeviceResult = Result<std::shared_ptr<AlsaDevice>>;
+    if (num_channels <= 0 || sample_rate <= 0 || period_size == 0) {
+        return Err<std::shared_ptr<AlsaDevice>>("AlsaDevice: channels, sample rate and period size must be positive");
+    }
+
+    auto device = std::shared_ptr<AlsaDevice>(new AlsaDevice());
+    device->_device_name = device_name;
+    device->_num_channels = num_channels;
+    device->_sample_rate = sample_rate;
+    device->_period_size = period_size;
+    device->_buffer_size = buffer_size > 0 ? buffer_size : sample_rate;  // Default 1 second
+
+    // Non-blocking: one thread services every device, none may block it
+    int err = snd_pcm_open(&device->_pcm, device_name.c_str(), SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK);
+    if (err < 0) {
+        device->_pcm = nullptr;
+        return Err<std::shared_ptr<AlsaDevice>>(
+            "AlsaDevice: failed to open device '" + device_name + "': " + snd_strerror(err));
+    }
+    // From here on the destructor closes the PCM
+    auto fail = [&](const std::string& what, int code) -> DeviceResult {
+        return Err<std::shared_ptr<AlsaDevice>>("AlsaDevice: " + what + ": " + snd_strerror(code));
+    };
+
+    snd_pcm_hw_params_t* hw_params;
+    snd_pcm_hw_params_alloca(&hw_params);
+    snd_pcm_hw_params_any(device->_pcm, hw_params);
+
+    // Prefer the DMA area itself; read/write access costs a staging copy
+    err = snd_pcm_hw_params_set_access(device->_pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    if (err < 0) {
+        err = snd_pcm_hw_params_set_access(device->_pcm, hw_params, SND_PCM_ACCESS_MMAP_NONINTERLEAVED);
+    }
+    if (err < 0) {
+        device->_mmap = false;
+        err = snd_pcm_hw_params_set_access(device->_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+    }
+    if (err < 0) return fail("failed to set access type", err);
+
+    err = snd_pcm_hw_params_set_format(device->_pcm, hw_params, SND_PCM_FORMAT_FLOAT_LE);
+    if (err < 0) {
+        // Try S16_LE as fallback
+        err = snd_pcm_hw_params_set_format(device->_pcm, hw_params, SND_PCM_FORMAT_S16_LE);
+        if (err < 0) return fail("failed to set format", err);
+        device->_format = SND_PCM_FORMAT_S16_LE;
+    }
+
+    err = snd_pcm_hw_params_set_channels(device->_pcm, hw_params, num_channels);
+    if (err < 0) return fail("failed to set channels", err);
+
+    unsigned int rate = sample_rate;
+    err = snd_pcm_hw_params_set_rate_near(device->_pcm, hw_params, &rate, nullptr);
+    if (err < 0) return fail("failed to set sample rate", err);
+    device->_sample_rate = rate;
+
+    snd_pcm_uframes_t frames = period_size;
+    err = snd_pcm_hw_params_set_period_size_near(device->_pcm, hw_params, &frames, nullptr);
+    if (err < 0) return fail("failed to set period size", err);
+    device->_period_size = frames;
+
+    // A few periods of slack for the shared thread; the driver may round
+    unsigned int periods = 4;
+    snd_pcm_hw_params_set_periods_near(device->_pcm, hw_params, &periods, nullptr);
+
+    err = snd_pcm_hw_params(device->_pcm, hw_params);
+    if (err < 0) return fail("failed to apply hw params", err);
+
+    snd_pcm_uframes_t hw_buffer = 0;
+    snd_pcm_uframes_t hw_period = 0;
+    if (snd_pcm_get_params(device->_pcm, &hw_buffer, &hw_period) == 0) {
+        device->_hw_buffer_size = hw_buffer;
+        device->_period_size = hw_period;
+    }
+
+    // Wake up once per period
+    snd_pcm_sw_params_t* sw_params;
+    snd_pcm_sw_params_alloca(&sw_params);
+    snd_pcm_sw_params_current(device->_pcm, sw_params);
+    snd_pcm_sw_params_set_avail_min(device->_pcm, sw_params, device->_period_size);
+    err = snd_pcm_sw_params(device->_pcm, sw_params);
+    if (err < 0) return fail("failed to apply sw params", err);
+
+    // One ring for all channels, one mediated buffer per channel
+    auto buffer_res = AudioRingBuffer::create(
+        device->_sample_rate, device->_buffer_size, device->_period_size, num_channels);
+    if (!buffer_res) {
+        return Err<std::shared_ptr<AlsaDevice>>("AlsaDevice: failed to create ring buffer", buffer_res);
+    }
+    device->_ring_buffer = *buffer_res;
+    for (int ch = 0; ch < num_channels; ++ch) {
+        auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffer, ch);
+        if (!mediated_res) {
+            return Err<std::shared_ptr<AlsaDevice>>("AlsaDevice: failed to create mediated buffer", mediated_res);
+        }
+        device->_mediated_buffers.push_back(*mediated_res);
+    }
+
+    // Everything the engine thread touches is allocated here
+    const size_t sample_bytes = device->_format == SND_PCM_FORMAT_FLOAT_LE ? 4 : 2;
+    if (device->_mmap) {
+        device->_float_areas.resize(num_channels);
+        device->_s16_areas.resize(num_channels);
+        device->_area_steps.resize(num_channels);
+    } else {
+        device->_interleaved_buffer.resize(device->_period_size * num_channels * sample_bytes);
+    }
+
+    ydebug("AlsaDevice: opened {} with {} channels at {}Hz, period={}, buffer={}, {} access",
+           device_name, num_channels, device->_sample_rate, device->_period_size,
+           device->_hw_buffer_size, device->_mmap ? "mmap" : "read/write");
+    return device;
+}
+
+AlsaDevice::~AlsaDevice() {
+    _stop();
+    if (_pcm) {
+        snd_pcm_close(_pcm);
+        _pcm = nullptr;
+    }
+}
+
+MediatedAudioBufferPtr AlsaDevice::get_buffer(int channel) const {
+    if (channel >= 0 && channel < static_cast<int>(_mediated_buffers.size())) {
+        return _mediated_buffers[channel];
+    }
+    return nullptr;
+}
+
+Result<void> AlsaDevice::_start() {
+    int err = snd_pcm_prepare(_pcm);
+    if (err < 0) {
+        return Err<void>("AlsaDevice: prepare failed on '" + _device_name + "': " + snd_strerror(err));
+    }
+    // Capture in mmap mode never starts by itself
+    err = snd_pcm_start(_pcm);
+    if (err < 0) {
+        return Err<void>("AlsaDevice: start failed on '" + _device_name + "': " + snd_strerror(err));
+    }
+    _running = true;
+    return Ok();
+}
+
+void AlsaDevice::_stop() {
+    if (!_running.exchange(false)) return;
+    if (_pcm) {
+        snd_pcm_drop(_pcm);
+    }
+}
+
+void AlsaDevice::_service(IoThread& thread) {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(_pcm);
+    if (avail < 0) {
+        _recover(static_cast<int>(avail), thread);
+        return;
+    }
+    // Whole periods only, so ring blocks line up with the hardware's
+    const auto frames = static_cast<snd_pcm_uframes_t>(avail) / _period_size * _period_size;
+    if (frames == 0) return;
+
+    auto scope = _stats.time_callback();
+    size_t captured = _mmap ? _service_mmap(frames, thread) : _service_rw(frames, thread);
+    _frames_captured.fetch_add(captured, std::memory_order_relaxed);
+}
+
+size_t AlsaDevice::_service_mmap(snd_pcm_uframes_t avail, IoThread& thread) {
+    const bool is_float = _format == SND_PCM_FORMAT_FLOAT_LE;
+    const unsigned int sample_bits = is_float ? 32 : 16;
+    size_t done = 0;
+    // At most what was available on entry: a PCM that never runs dry
+    // (the null plugin) cannot keep the thread here
+    while (done < avail) {
+        const snd_pcm_channel_area_t* areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = avail - done;
+        int err = snd_pcm_mmap_begin(_pcm, &areas, &offset, &frames);
+        if (err < 0) {
+            _recover(err, thread);
+            break;
+        }
+        if (frames == 0) break;
+
+        // Contiguous up to the end of the DMA buffer; the ring deinterleaves
+        for (int ch = 0; ch < _num_channels; ++ch) {
+            const auto* base = static_cast<const uint8_t*>(areas[ch].addr) +
+                               areas[ch].first / 8 + offset * (areas[ch].step / 8);
+            _area_steps[ch] = areas[ch].step / sample_bits;
+            if (is_float) {
+                _float_areas[ch] = reinterpret_cast<const float*>(base);
+            } else {
+                _s16_areas[ch] = reinterpret_cast<const int16_t*>(base);
+            }
+        }
+        if (is_float) {
+            _ring_buffer->write_strided(_float_areas.data(), _area_steps.data(), frames);
+        } else {
+            _ring_buffer->write_strided(_s16_areas.data(), _area_steps.data(), frames);
+        }
+
+        // A short commit means the hardware overran the area while we copied
+        snd_pcm_sframes_t committed = snd_pcm_mmap_commit(_pcm, offset, frames);
+        if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames) {
+            _recover(committed < 0 ? static_cast<int>(committed) : -EPIPE, thread);
+            break;
+        }
+        done += frames;
+    }
+    return done;
+}
+
+size_t AlsaDevice::_service_rw(snd_pcm_uframes_t avail, IoThread& thread) {
+    size_t done = 0;
+    while (done < avail) {
+        snd_pcm_sframes_t frames = snd_pcm_readi(_pcm, _interleaved_buffer.data(), _period_size);
+        if (frames == -EAGAIN) break;
+        if (frames < 0) {
+            _recover(static_cast<int>(frames), thread);
+            break;
+        }
+        if (frames == 0) break;
+
+        if (_format == SND_PCM_FORMAT_FLOAT_LE) {
+            _ring_buffer->write_interleaved(reinterpret_cast<const float*>(_interleaved_buffer.data()), frames);
+        } else {
+            _ring_buffer->write_interleaved(reinterpret_cast<const int16_t*>(_interleaved_buffer.data()), frames);
+        }
+        done += static_cast<size_t>(frames);
+    }
+    return done;
+}
+
+bool AlsaDevice::_recover(int err, IoThread& thread) {
+    if (err == -EPIPE) {
+        _stats.record_xrun();
+        thread.defer_log(IoLogLevel::Warn, "capture overrun, recovering");
+    } else {
+        thread.defer_log(IoLogLevel::Warn, snd_strerror(err), err);
+    }
+    int res = snd_pcm_recover(_pcm, err, 1);
+    if (res >= 0 && snd_pcm_state(_pcm) == SND_PCM_STATE_PREPARED) {
+        res = snd_pcm_start(_pcm);
+    }
+    if (res < 0) {
+        // Unplugged or otherwise gone: the engine drops it from the poll set
+        thread.defer_log(IoLogLevel::Warn, "capture device lost, stopped", res);
+        _running = false;
+        return false;
+    }
+    return true;
+}
+
+// ============== AlsaCaptureEngine ==============
+
+Result<std::shared_ptr<AlsaCaptureEngine>> AlsaCaptureEngine::create() {
+    auto engine = std::shared_ptr<AlsaCaptureEngine>(new AlsaCaptureEngine());
+    engine->_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (engine->_wake_fd < 0) {
+        return Err<std::shared_ptr<AlsaCaptureEngine>>(
+            std::string("AlsaCaptureEngine: eventfd failed: ") + std::strerror(errno));
+    }
+    engine->_running = true;
+    // The period follows the devices; none yet
+    engine->_thread.start("alsa-capture", 0, [raw = engine.get()] { raw->_run(); });
+    return engine;
+}
+
+AlsaCaptureEngine::~AlsaCaptureEngine() {
+    _running = false;
+    _wake();
+    _thread.join();
+    for (auto& device : _devices) {
+        device->_stop();
+    }
+    _devices.clear();
+    if (_wake_fd >= 0) {
+        close(_wake_fd);
+    }
+}
+
+Result<void> AlsaCaptureEngine::add(const AlsaDevicePtr& device) {
+    if (!device) return Err<void>("AlsaCaptureEngine::add: no device");
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (std::find(_devices.begin(), _devices.end(), device) != _devices.end()) return Ok();
+    }
+    if (auto res = device->_start(); !res) {
+        return Err<void>("AlsaCaptureEngine::add failed", res);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _devices.push_back(device);
+        _generation.fetch_add(1, std::memory_order_release);
+    }
+    _wake();
+    return Ok();
+}
+
+void AlsaCaptureEngine::remove(const AlsaDevicePtr& device) {
+    {
+        // Holding the lock means the thread is not servicing it
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find(_devices.begin(), _devices.end(), device);
+        if (it == _devices.end()) return;
+        _devices.erase(it);
+        _generation.fetch_add(1, std::memory_order_release);
+    }
+    _wake();
+    device->_stop();
+}
+
+size_t AlsaCaptureEngine::num_devices() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _devices.size();
+}
+
+void AlsaCaptureEngine::_wake() {
+    if (_wake_fd < 0) return;
+    uint64_t one = 1;
+    [[maybe_unused]] auto n = write(_wake_fd, &one, sizeof(one));
+}
+
+void AlsaCaptureEngine::_run() {
+    struct Slot {
+        AlsaDevice* device;
+        size_t first;  // into fds
+        unsigned int count;
+    };
+    std::vector<pollfd> fds;
+    std::vector<Slot> slots;
+    uint64_t built = std::numeric_limits<uint64_t>::max();
+    int64_t period = 0;
+
+    while (_running.load(std::memory_order_acquire)) {
+        // Descriptor set, rebuilt only when devices come or go
+        if (_generation.load(std::memory_order_acquire) != built) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            built = _generation.load(std::memory_order_relaxed);
+            fds.assign(1, pollfd{_wake_fd, POLLIN, 0});
+            slots.clear();
+            period = 0;
+            for (const auto& device : _devices) {
+                int count = snd_pcm_poll_descriptors_count(device->_pcm);
+                if (count <= 0) continue;
+                size_t first = fds.size();
+                fds.resize(first + count);
+                count = snd_pcm_poll_descriptors(device->_pcm, fds.data() + first, count);
+                fds.resize(first + std::max(count, 0));
+                slots.push_back({device.get(), first, static_cast<unsigned int>(std::max(count, 0))});
+                int64_t device_period = io_period_ns(device->_period_size, device->_sample_rate);
+                period = period == 0 ? device_period : std::min(period, device_period);
+            }
+        }
+
+        int ready = poll(fds.data(), fds.size(), -1);
+        if (ready < 0) {
+            if (errno != EINTR) _thread.defer_log(IoLogLevel::Warn, "poll failed", errno);
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t count = 0;
+            [[maybe_unused]] auto n = read(_wake_fd, &count, sizeof(count));
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_generation.load(std::memory_order_relaxed) != built) continue;
+        _thread.beat(period);
+
+        bool lost = false;
+        for (const auto& slot : slots) {
+            if (slot.count == 0) continue;
+            unsigned short revents = 0;
+            if (snd_pcm_poll_descriptors_revents(slot.device->_pcm, fds.data() + slot.first,
+                                                 slot.count, &revents) < 0) {
+                continue;
+            }
+            if (revents & (POLLIN | POLLERR)) {
+                slot.device->_service(_thread);
+                lost = lost || !slot.device->is_running();
+            }
+        }
+        if (lost) {
+            _devices.erase(std::remove_if(_devices.begin(), _devices.end(),
+                                          [](const auto& device) { return !device->is_running(); }),
+                           _devices.end());
+            _generation.fetch_add(1, std::memory_order_release);
+        }
+    }
+}
+
+} // namespace ymery::plugins
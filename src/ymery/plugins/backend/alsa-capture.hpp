@@ -0,0 +1,137 @@
+// ALSA capture - mmap devices serviced by one poll-driven thread
+#pragma once
+
+#include "../../types.hpp"
+#include "../../result.hpp"
+#include "../../backend/audio_buffer.hpp"
+#include "../../backend/audio_stats.hpp"
+#include "../../backend/io_thread.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <alsa/asoundlib.h>
+
+namespace ymery::plugins {
+
+class AlsaCaptureEngine;
+
+/**
+ * AlsaDevice - one ALSA capture PCM feeding a multichannel ring
+ *
+ * Opened non-blocking in mmap access where the PCM allows it: captured
+ * periods are deinterleaved straight from the DMA area into the ring, with
+ * no staging copy. PCMs without mmap support fall back to snd_pcm_readi
+ * into a staging buffer. The device has no thread of its own; an
+ * AlsaCaptureEngine services it when poll() reports a period.
+ */
+class AlsaDevice {
+public:
+    static Result<std::shared_ptr<AlsaDevice>> create(
+        const std::string& device_name,
+        int num_channels,
+        int sample_rate,
+        size_t period_size,
+        size_t buffer_size = 0  // ring frames, 0 = auto (1 second)
+    );
+
+    ~AlsaDevice();
+
+    bool is_running() const { return _running.load(std::memory_order_relaxed); }
+    bool is_mmap() const { return _mmap; }
+
+    MediatedAudioBufferPtr get_buffer(int channel) const;
+
+    int num_channels() const { return _num_channels; }
+    int sample_rate() const { return _sample_rate; }
+    size_t period_size() const { return _period_size; }
+    size_t hw_buffer_size() const { return _hw_buffer_size; }
+    const std::string& device_name() const { return _device_name; }
+    uint64_t frames_captured() const { return _frames_captured.load(std::memory_order_relaxed); }
+
+    const DeviceStats& stats() const { return _stats; }
+    const AudioRingBufferPtr& ring_buffer() const { return _ring_buffer; }
+
+private:
+    friend class AlsaCaptureEngine;
+
+    AlsaDevice() = default;
+
+    Result<void> _start();
+    void _stop();
+    // Capture what the hardware has, whole periods at a time; on the engine thread
+    void _service(IoThread& thread);
+    size_t _service_mmap(snd_pcm_uframes_t avail, IoThread& thread);
+    size_t _service_rw(snd_pcm_uframes_t avail, IoThread& thread);
+    // Restart after an xrun or suspend; false when the PCM is unusable
+    bool _recover(int err, IoThread& thread);
+
+    std::string _device_name;
+    int _num_channels = 2;
+    int _sample_rate = 48000;
+    size_t _period_size = 1024;
+    size_t _hw_buffer_size = 0;
+    size_t _buffer_size = 48000;
+    snd_pcm_format_t _format = SND_PCM_FORMAT_FLOAT_LE;
+    bool _mmap = true;
+
+    snd_pcm_t* _pcm = nullptr;
+    AudioRingBufferPtr _ring_buffer;
+    std::vector<MediatedAudioBufferPtr> _mediated_buffers;
+    std::vector<uint8_t> _interleaved_buffer;  // read/write access only
+    // Per-channel view of the mmap area, sized at create
+    std::vector<const float*> _float_areas;
+    std::vector<const int16_t*> _s16_areas;
+    std::vector<size_t> _area_steps;
+    DeviceStats _stats;
+
+    std::atomic<uint64_t> _frames_captured{0};
+    std::atomic<bool> _running{false};
+};
+
+using AlsaDevicePtr = std::shared_ptr<AlsaDevice>;
+
+/**
+ * AlsaCaptureEngine - services every started capture PCM from one thread
+ *
+ * The thread polls the descriptors of all PCMs plus a wake descriptor,
+ * so it sleeps until some device completes a period (avail_min is one
+ * period) and wakes aligned to the hardware. Adding or removing a device
+ * wakes the thread, which rebuilds its descriptor set before servicing
+ * again. Eight USB interfaces take one I/O thread instead of eight.
+ */
+class AlsaCaptureEngine {
+public:
+    static Result<std::shared_ptr<AlsaCaptureEngine>> create();
+    ~AlsaCaptureEngine();
+
+    AlsaCaptureEngine(const AlsaCaptureEngine&) = delete;
+    AlsaCaptureEngine& operator=(const AlsaCaptureEngine&) = delete;
+
+    // Prepare and start the PCM, then service it until removed
+    Result<void> add(const AlsaDevicePtr& device);
+    void remove(const AlsaDevicePtr& device);
+
+    size_t num_devices() const;
+    const IoThreadMonitorPtr& monitor() const { return _thread.monitor(); }
+
+private:
+    AlsaCaptureEngine() = default;
+
+    void _run();
+    void _wake();
+
+    mutable std::mutex _mutex;
+    std::vector<AlsaDevicePtr> _devices;
+    std::atomic<uint64_t> _generation{0};  // bumped on every membership change
+
+    int _wake_fd = -1;
+    std::atomic<bool> _running{false};
+    IoThread _thread;
+};
+
+using AlsaCaptureEnginePtr = std::shared_ptr<AlsaCaptureEngine>;
+
+} // namespace ymery::plugins
@@ -2,6 +2,11 @@
 #include "../../types.hpp"
 #include "../../result.hpp"
 #include "../../backend/audio_buffer.hpp"
+#include "../../backend/audio_engine.hpp"
+#include "../../backend/audio_stats.hpp"
+#include "../../backend/io_thread.hpp"
+#include "../../backend/tree_router.hpp"
+#include "alsa-capture.hpp"
 #include <map>
 #include <thread>
 #include <atomic>
@@ -16,226 +21,116 @@ namespace ymery { class Dispatcher; class PluginManager; }
 namespace ymery::plugins {
 
 /**
- * AlsaDevice - captures audio from an ALSA device in a background thread
+ * AlsaSink - playback sink for the audio engine
+ * A thread renders one block at a time and blocks in snd_pcm_writei, so
+ * the device clock paces the engine. Underruns are counted as xruns.
  */
-class AlsaDevice {
+class AlsaSink : public AudioSink {
 public:
-    static Result<std::shared_ptr<AlsaDevice>> create(
-        const std::string& device_name,
-        int num_channels,
-        int sample_rate,
-        size_t period_size,
-        size_t buffer_size = 0  // 0 = auto (1 second)
-    ) {
-        auto device = std::make_shared<AlsaDevice>();
-        device->_device_name = device_name;
-        device->_num_channels = num_channels;
-        device->_sample_rate = sample_rate;
-        device->_period_size = period_size;
-        device->_buffer_size = buffer_size > 0 ? buffer_size : sample_rate;  // Default 1 second
-
-        // Open ALSA device
-        int err = snd_pcm_open(&device->_pcm, device_name.c_str(), SND_PCM_STREAM_CAPTURE, 0);
-        if (err < 0) {
-            return Err<std::shared_ptr<AlsaDevice>>(
-                "AlsaDevice: failed to open device '" + device_name + "': " + snd_strerror(err));
-        }
-
-        // Configure hardware parameters
-        snd_pcm_hw_params_t* hw_params;
-        snd_pcm_hw_params_alloca(&hw_params);
-        snd_pcm_hw_params_any(device->_pcm, hw_params);
-
-        // Set access type (interleaved)
-        err = snd_pcm_hw_params_set_access(device->_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
-        if (err < 0) {
-            snd_pcm_close(device->_pcm);
-            return Err<std::shared_ptr<AlsaDevice>>(
-                "AlsaDevice: failed to set access type: " + std::string(snd_strerror(err)));
-        }
-
-        // Set format (float)
-        err = snd_pcm_hw_params_set_format(device->_pcm, hw_params, SND_PCM_FORMAT_FLOAT_LE);
-        if (err < 0) {
-            // Try S16_LE as fallback
-            err = snd_pcm_hw_params_set_format(device->_pcm, hw_params, SND_PCM_FORMAT_S16_LE);
-            if (err < 0) {
-                snd_pcm_close(device->_pcm);
-                return Err<std::shared_ptr<AlsaDevice>>(
-                    "AlsaDevice: failed to set format: " + std::string(snd_strerror(err)));
-            }
-            device->_format = SND_PCM_FORMAT_S16_LE;
-        } else {
-            device->_format = SND_PCM_FORMAT_FLOAT_LE;
-        }
+    static Result<AudioSinkPtr> create(const std::string& device_name) {
+        auto sink = std::shared_ptr<AlsaSink>(new AlsaSink());
+        sink->_device_name = device_name;
+        return Ok(AudioSinkPtr(sink));
+    }
 
-        // Set channels
-        err = snd_pcm_hw_params_set_channels(device->_pcm, hw_params, num_channels);
-        if (err < 0) {
-            snd_pcm_close(device->_pcm);
-            return Err<std::shared_ptr<AlsaDevice>>(
-                "AlsaDevice: failed to set channels: " + std::string(snd_strerror(err)));
-        }
+    ~AlsaSink() override {
+        stop();
+    }
 
-        // Set sample rate
-        unsigned int rate = sample_rate;
-        err = snd_pcm_hw_params_set_rate_near(device->_pcm, hw_params, &rate, nullptr);
-        if (err < 0) {
-            snd_pcm_close(device->_pcm);
-            return Err<std::shared_ptr<AlsaDevice>>(
-                "AlsaDevice: failed to set sample rate: " + std::string(snd_strerror(err)));
-        }
-        device->_sample_rate = rate;
+    Result<void> start(const AudioEngineConfig& config, AudioRenderFn render) override {
+        if (_running) return Ok();
 
-        // Set period size
-        snd_pcm_uframes_t frames = period_size;
-        err = snd_pcm_hw_params_set_period_size_near(device->_pcm, hw_params, &frames, nullptr);
+        int err = snd_pcm_open(&_pcm, _device_name.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
         if (err < 0) {
-            snd_pcm_close(device->_pcm);
-            return Err<std::shared_ptr<AlsaDevice>>(
-                "AlsaDevice: failed to set period size: " + std::string(snd_strerror(err)));
-        }
-        device->_period_size = frames;
-
-        // Apply hardware parameters
-        err = snd_pcm_hw_params(device->_pcm, hw_params);
-        if (err < 0) {
-            snd_pcm_close(device->_pcm);
-            return Err<std::shared_ptr<AlsaDevice>>(
-                "AlsaDevice: failed to apply hw params: " + std::string(snd_strerror(err)));
-        }
-
-        // Create ring buffer and mediated buffer per channel
-        for (int ch = 0; ch < num_channels; ++ch) {
-            auto buffer_res = AudioRingBuffer::create(device->_sample_rate, device->_buffer_size, device->_period_size);
-            if (!buffer_res) {
-                snd_pcm_close(device->_pcm);
-                return Err<std::shared_ptr<AlsaDevice>>("AlsaDevice: failed to create ring buffer", buffer_res);
-            }
-            device->_ring_buffers.push_back(*buffer_res);
-
-            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffers[ch]);
-            if (!mediated_res) {
-                snd_pcm_close(device->_pcm);
-                return Err<std::shared_ptr<AlsaDevice>>("AlsaDevice: failed to create mediated buffer", mediated_res);
-            }
-            device->_mediated_buffers.push_back(*mediated_res);
+            _pcm = nullptr;
+            return Err<void>("AlsaSink: failed to open device '" + _device_name + "': " + snd_strerror(err));
         }
 
-        // Allocate interleaved sample buffer
-        size_t sample_bytes = (device->_format == SND_PCM_FORMAT_FLOAT_LE) ? 4 : 2;
-        device->_interleaved_buffer.resize(period_size * num_channels * sample_bytes);
-        device->_channel_buffer.resize(period_size);
-
-        ydebug("AlsaDevice: opened {} with {} channels at {}Hz, period={}",
-                     device_name, num_channels, device->_sample_rate, device->_period_size);
-
-        return device;
-    }
-
-    void start() {
-        if (_running) return;
-
-        int err = snd_pcm_prepare(_pcm);
+        // Latency of a few engine blocks
+        err = snd_pcm_set_params(_pcm, SND_PCM_FORMAT_FLOAT_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                 static_cast<unsigned int>(config.channels),
+                                 static_cast<unsigned int>(config.sample_rate), 1,
+                                 static_cast<unsigned int>(config.block_frames * 4 * 1000000 / config.sample_rate));
         if (err < 0) {
-            ywarn("AlsaDevice: prepare failed: {}", snd_strerror(err));
-            return;
+            snd_pcm_close(_pcm);
+            _pcm = nullptr;
+            return Err<void>("AlsaSink: failed to configure '" + _device_name + "': " + snd_strerror(err));
         }
 
+        _config = config;
+        _render = std::move(render);
+        _block.assign(config.block_frames * config.channels, 0.0f);
         _running = true;
-        _thread = std::thread(&AlsaDevice::_run, this);
-    }
-
-    void stop() {
-        _running = false;
-        if (_thread.joinable()) {
-            _thread.join();
-        }
-    }
-
-    bool is_running() const { return _running; }
+        _thread.start("alsa-sink:" + _device_name, io_period_ns(config.block_frames, config.sample_rate),
+                      [this] { _run(); });
 
-    MediatedAudioBufferPtr get_buffer(int channel) const {
-        if (channel >= 0 && channel < static_cast<int>(_mediated_buffers.size())) {
-            return _mediated_buffers[channel];
-        }
-        return nullptr;
+        ydebug("AlsaSink: playing on {} with {} channels at {}Hz, block={}",
+               _device_name, config.channels, config.sample_rate, config.block_frames);
+        return Ok();
     }
 
-    int num_channels() const { return _num_channels; }
-    int sample_rate() const { return _sample_rate; }
-    size_t period_size() const { return _period_size; }
-    const std::string& device_name() const { return _device_name; }
-
-    ~AlsaDevice() {
-        stop();
+    Result<void> stop() override {
+        _running = false;
+        _thread.join();
         if (_pcm) {
+            snd_pcm_drop(_pcm);
             snd_pcm_close(_pcm);
             _pcm = nullptr;
         }
+        return Ok();
     }
 
+    bool is_running() const override { return _running; }
+    std::string kind() const override { return "alsa"; }
+    uint64_t frames_played() const override { return _frames_played.load(std::memory_order_relaxed); }
+    const DeviceStats& stats() const override { return _stats; }
+
 private:
+    AlsaSink() = default;
+
     void _run() {
+        const size_t frames = _config.block_frames;
         while (_running) {
-            snd_pcm_sframes_t frames = snd_pcm_readi(_pcm, _interleaved_buffer.data(), _period_size);
+            _thread.beat();
+            {
+                auto scope = _stats.time_callback();
+                _render(_block.data(), frames);
+            }
 
-            if (frames < 0) {
-                // Handle xrun (buffer overrun)
-                if (frames == -EPIPE) {
-                    ywarn("AlsaDevice: buffer overrun, recovering...");
-                    snd_pcm_prepare(_pcm);
+            size_t written = 0;
+            while (written < frames && _running) {
+                snd_pcm_sframes_t n = snd_pcm_writei(
+                    _pcm, _block.data() + written * _config.channels, frames - written);
+                if (n < 0) {
+                    // Handle xrun (buffer underrun)
+                    if (n == -EPIPE) {
+                        _stats.record_xrun();
+                        _thread.defer_log(IoLogLevel::Warn, "buffer underrun, recovering");
+                    }
+                    if (snd_pcm_recover(_pcm, static_cast<int>(n), 1) < 0) {
+                        _thread.defer_log(IoLogLevel::Warn, snd_strerror(static_cast<int>(n)), n);
+                        _running = false;
+                    }
                     continue;
                 }
-                ywarn("AlsaDevice: read error: {}", snd_strerror(frames));
-                continue;
-            }
-
-            if (frames == 0) continue;
-
-            // Deinterleave and write to per-channel ring buffers
-            for (int ch = 0; ch < _num_channels; ++ch) {
-                _deinterleave_channel(ch, frames);
-                _ring_buffers[ch]->write(_channel_buffer.data(), frames);
-            }
-        }
-    }
-
-    void _deinterleave_channel(int channel, snd_pcm_sframes_t frames) {
-        if (_format == SND_PCM_FORMAT_FLOAT_LE) {
-            const float* src = reinterpret_cast<const float*>(_interleaved_buffer.data());
-            for (snd_pcm_sframes_t i = 0; i < frames; ++i) {
-                _channel_buffer[i] = src[i * _num_channels + channel];
-            }
-        } else {
-            // SND_PCM_FORMAT_S16_LE - convert to float
-            const int16_t* src = reinterpret_cast<const int16_t*>(_interleaved_buffer.data());
-            constexpr float scale = 1.0f / 32768.0f;
-            for (snd_pcm_sframes_t i = 0; i < frames; ++i) {
-                _channel_buffer[i] = src[i * _num_channels + channel] * scale;
+                written += static_cast<size_t>(n);
             }
+            _frames_played.fetch_add(written, std::memory_order_relaxed);
         }
     }
 
     std::string _device_name;
-    int _num_channels = 2;
-    int _sample_rate = 48000;
-    size_t _period_size = 1024;
-    size_t _buffer_size = 48000;
-    snd_pcm_format_t _format = SND_PCM_FORMAT_FLOAT_LE;
+    AudioEngineConfig _config;
+    AudioRenderFn _render;
+    std::vector<float> _block;
 
     snd_pcm_t* _pcm = nullptr;
-    std::vector<AudioRingBufferPtr> _ring_buffers;
-    std::vector<MediatedAudioBufferPtr> _mediated_buffers;
-    std::vector<uint8_t> _interleaved_buffer;
-    std::vector<float> _channel_buffer;
-
+    DeviceStats _stats;
+    std::atomic<uint64_t> _frames_played{0};
     std::atomic<bool> _running{false};
-    std::thread _thread;
+    IoThread _thread;
 };
 
-using AlsaDevicePtr = std::shared_ptr<AlsaDevice>;
-
 /**
  * AlsaManager - manages ALSA devices, implements TreeLike
  * Tree structure:
@@ -243,6 +138,12 @@ using AlsaDevicePtr = std::shared_ptr<AlsaDevice>;
  *   /available/<card>/<device> - device info
  *   /opened - list opened devices
  *   /opened/<device_name>/<channel> - opened channel with buffer
+ *
+ * Any PCM can be opened with add_child("/opened", name, {...}) where the
+ * data carries "device" (a PCM name such as "hw:1,0", "null" or
+ * "file:'/tmp/x.raw',raw") and optionally "num-channels", "sample-rate"
+ * and "period-size". Every opened device is captured by one shared
+ * poll-driven thread (AlsaCaptureEngine).
  */
 class AlsaManager : public TreeLike {
 public:
@@ -255,175 +156,11 @@ public:
     }
 
     Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
-        std::string path_str = path.to_string();
-        // Normalize: ensure path starts with / for consistent matching
-        if (!path_str.empty() && path_str[0] != '/') {
-            path_str = "/" + path_str;
-        }
-
-        // Root
-        if (path_str == "/" || path_str.empty()) {
-            return Ok(std::vector<std::string>{"available", "opened"});
-        }
-
-        // /available - enumerate cards
-        if (path_str == "/available") {
-            return _get_available_cards();
-        }
-
-        // /available/<card> - enumerate devices
-        if (path.as_list().size() == 2 && path.as_list()[0] == "available") {
-            return _get_card_devices(path.as_list()[1]);
-        }
-
-        // /available/<card>/<device> - enumerate channels
-        if (path.as_list().size() == 3 && path.as_list()[0] == "available") {
-            return _get_device_channels(path.as_list()[1], path.as_list()[2]);
-        }
-
-        // /opened - list opened devices
-        if (path_str == "/opened") {
-            std::vector<std::string> children;
-            for (const auto& [name, _] : _devices) {
-                children.push_back(name);
-            }
-            return Ok(children);
-        }
-
-        // /opened/<device> - list channels
-        if (path.as_list().size() == 2 && path.as_list()[0] == "opened") {
-            auto it = _devices.find(path.as_list()[1]);
-            if (it != _devices.end()) {
-                std::vector<std::string> channels;
-                for (int i = 0; i < it->second->num_channels(); ++i) {
-                    channels.push_back(std::to_string(i));
-                }
-                return Ok(channels);
-            }
-        }
-
-        return Ok(std::vector<std::string>{});
+        return _router.children(path);
     }
 
     Result<Dict> get_metadata(const DataPath& path) override {
-        std::string path_str = path.to_string();
-        // Normalize: ensure path starts with / for consistent matching
-        if (!path_str.empty() && path_str[0] != '/') {
-            path_str = "/" + path_str;
-        }
-
-        // Root
-        if (path_str == "/" || path_str.empty()) {
-            return Ok(Dict{
-                {"name", Value("alsa")},
-                {"label", Value("ALSA Audio")},
-                {"type", Value("alsa-manager")},
-                {"category", Value("audio-device-manager")}
-            });
-        }
-
-        // /available
-        if (path_str == "/available") {
-            return Ok(Dict{
-                {"name", Value("available")},
-                {"label", Value("Available")},
-                {"type", Value("folder")},
-                {"category", Value("folder")}
-            });
-        }
-
-        // /opened
-        if (path_str == "/opened") {
-            return Ok(Dict{
-                {"name", Value("opened")},
-                {"label", Value("Opened")},
-                {"type", Value("folder")},
-                {"category", Value("folder")}
-            });
-        }
-
-        // /available/<card>
-        if (path.as_list().size() == 2 && path.as_list()[0] == "available") {
-            std::string card = path.as_list()[1];
-            return Ok(Dict{
-                {"name", Value(card)},
-                {"label", Value("Card " + card)},
-                {"type", Value("folder")},
-                {"category", Value("folder")}
-            });
-        }
-
-        // /available/<card>/<device>
-        if (path.as_list().size() == 3 && path.as_list()[0] == "available") {
-            std::string card = path.as_list()[1];
-            std::string device = path.as_list()[2];
-            std::string device_name = "hw:" + card + "," + device;
-            return Ok(Dict{
-                {"name", Value(device)},
-                {"label", Value("Device " + device)},
-                {"type", Value("alsa-device")},
-                {"category", Value("audio-device")},
-                {"device", Value(device_name)},
-                {"capabilities", Value(Dict{
-                    {"openable", Value(true)},
-                    {"readable", Value(true)},
-                    {"writable", Value(false)}
-                })}
-            });
-        }
-
-        // /available/<card>/<device>/<channel>
-        if (path.as_list().size() == 4 && path.as_list()[0] == "available") {
-            std::string channel = path.as_list()[3];
-            return Ok(Dict{
-                {"name", Value(channel)},
-                {"label", Value("Channel " + channel)},
-                {"type", Value("audio-channel")},
-                {"category", Value("audio-channel")},
-                {"capabilities", Value(Dict{
-                    {"openable", Value(true)},
-                    {"readable", Value(true)},
-                    {"writable", Value(false)}
-                })}
-            });
-        }
-
-        // /opened/<device>
-        if (path.as_list().size() == 2 && path.as_list()[0] == "opened") {
-            auto it = _devices.find(path.as_list()[1]);
-            if (it != _devices.end()) {
-                auto& device = it->second;
-                return Ok(Dict{
-                    {"name", Value(device->device_name())},
-                    {"label", Value(device->device_name())},
-                    {"type", Value("alsa-device")},
-                    {"category", Value("audio-device")},
-                    {"status", Value(device->is_running() ? "running" : "stopped")},
-                    {"sample-rate", Value(static_cast<int64_t>(device->sample_rate()))},
-                    {"num-channels", Value(static_cast<int64_t>(device->num_channels()))}
-                });
-            }
-        }
-
-        // /opened/<device>/<channel>
-        if (path.as_list().size() == 3 && path.as_list()[0] == "opened") {
-            auto it = _devices.find(path.as_list()[1]);
-            if (it != _devices.end()) {
-                int channel = std::stoi(path.as_list()[2]);
-                auto buffer = it->second->get_buffer(channel);
-                if (buffer) {
-                    return Ok(Dict{
-                        {"name", Value(path.as_list()[2])},
-                        {"label", Value("Channel " + path.as_list()[2])},
-                        {"type", Value("audio-channel")},
-                        {"category", Value("audio-channel")},
-                        {"buffer", Value(buffer)}
-                    });
-                }
-            }
-        }
-
-        return Ok(Dict{});
+        return _router.metadata(path);
     }
 
     Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override {
@@ -457,7 +194,27 @@ public:
     }
 
     Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override {
-        return Err<void>("AlsaManager: add_child not implemented");
+        const auto& parts = path.as_list();
+        if (parts.size() != 1 || parts[0] != "opened") {
+            return Err<void>("AlsaManager: add_child only supported on /opened");
+        }
+        std::string device_name;
+        if (auto it = data.find("device"); it != data.end()) {
+            if (auto v = get_as<std::string>(it->second)) device_name = *v;
+        }
+        if (device_name.empty()) {
+            return Err<void>("AlsaManager: add_child needs a 'device' PCM name");
+        }
+        std::string key = name.empty() ? device_name : name;
+        if (_devices.count(key)) {
+            return Err<void>("AlsaManager: device '" + key + "' already opened");
+        }
+        auto device_res = _open_device(device_name, data);
+        if (!device_res) {
+            return Err<void>("AlsaManager: failed to open '" + device_name + "'", device_res);
+        }
+        _devices[key] = *device_res;
+        return Ok();
     }
 
     Result<std::string> as_tree(const DataPath& path, int depth) override {
@@ -478,27 +235,11 @@ public:
         // Check if device already opened
         auto it = _devices.find(device_name);
         if (it == _devices.end()) {
-            // Extract config
-            int num_channels = 2;
-            int sample_rate = 48000;
-            size_t period_size = 1024;
-
-            if (auto c = config.find("num-channels"); c != config.end()) {
-                if (auto v = get_as<int64_t>(c->second)) num_channels = static_cast<int>(*v);
-            }
-            if (auto c = config.find("sample-rate"); c != config.end()) {
-                if (auto v = get_as<int64_t>(c->second)) sample_rate = static_cast<int>(*v);
-            }
-            if (auto c = config.find("period-size"); c != config.end()) {
-                if (auto v = get_as<int64_t>(c->second)) period_size = static_cast<size_t>(*v);
-            }
-
-            auto device_res = AlsaDevice::create(device_name, num_channels, sample_rate, period_size);
+            auto device_res = _open_device(device_name, config);
             if (!device_res) {
                 return Err<MediatedAudioBufferPtr>("AlsaManager::open: failed to create device", device_res);
             }
             _devices[device_name] = *device_res;
-            _devices[device_name]->start();
         }
 
         auto buffer = _devices[device_name]->get_buffer(channel);
@@ -509,13 +250,214 @@ public:
         return Ok(buffer);
     }
 
+    // The engine can play through ALSA while this plugin is loaded
+    Result<void> init() override {
+        auto engine_res = AlsaCaptureEngine::create();
+        if (!engine_res) {
+            return Err<void>("AlsaManager: failed to create capture engine", engine_res);
+        }
+        _engine = *engine_res;
+
+        register_audio_sink("alsa", [](const Dict& options) -> Result<AudioSinkPtr> {
+            std::string device_name = "default";
+            if (auto it = options.find("device"); it != options.end()) {
+                if (auto name = get_as<std::string>(it->second)) device_name = *name;
+            }
+            return AlsaSink::create(device_name);
+        });
+        return _add_routes();
+    }
+
+    Result<void> dispose() override {
+        unregister_audio_sink("alsa");
+        return Ok();
+    }
+
     ~AlsaManager() {
-        for (auto& [_, device] : _devices) {
-            device->stop();
+        dispose();
+        if (_engine) {
+            for (auto& [_, device] : _devices) {
+                _engine->remove(device);
+            }
         }
     }
 
 private:
+    Result<void> _add_routes() {
+        static const Dict CAPABILITIES{
+            {"openable", Value(true)},
+            {"readable", Value(true)},
+            {"writable", Value(false)}
+        };
+        auto none = [](const RouteMatch&) { return Ok(std::vector<std::string>{}); };
+        auto folder = [](const std::string& name, const std::string& label) {
+            return [name, label](const RouteMatch&) {
+                return Ok(Dict{
+                    {"name", Value(name)},
+                    {"label", Value(label)},
+                    {"type", Value("folder")},
+                    {"category", Value("folder")}
+                });
+            };
+        };
+
+        std::vector<std::pair<std::string_view, TreeRouter::Route>> routes = {
+            {"/", {
+                [](const RouteMatch&) { return Ok(std::vector<std::string>{"available", "opened"}); },
+                [](const RouteMatch&) {
+                    return Ok(Dict{
+                        {"name", Value("alsa")},
+                        {"label", Value("ALSA Audio")},
+                        {"type", Value("alsa-manager")},
+                        {"category", Value("audio-device-manager")}
+                    });
+                }
+            }},
+            {"/available", {
+                [this](const RouteMatch&) { return _get_available_cards(); },
+                folder("available", "Available")
+            }},
+            {"/available/{card:index}", {
+                [this](const RouteMatch& m) { return _get_card_devices(m[0]); },
+                [](const RouteMatch& m) {
+                    return Ok(Dict{
+                        {"name", Value(m[0])},
+                        {"label", Value("Card " + m[0])},
+                        {"type", Value("folder")},
+                        {"category", Value("folder")}
+                    });
+                }
+            }},
+            {"/available/{card:index}/{device:index}", {
+                [this](const RouteMatch& m) { return _get_device_channels(m[0], m[1]); },
+                [](const RouteMatch& m) {
+                    return Ok(Dict{
+                        {"name", Value(m[1])},
+                        {"label", Value("Device " + m[1])},
+                        {"type", Value("alsa-device")},
+                        {"category", Value("audio-device")},
+                        {"device", Value("hw:" + m[0] + "," + m[1])},
+                        {"capabilities", Value(CAPABILITIES)}
+                    });
+                }
+            }},
+            {"/available/{card:index}/{device:index}/{channel:index}", {
+                none,
+                [](const RouteMatch& m) {
+                    return Ok(Dict{
+                        {"name", Value(m[2])},
+                        {"label", Value("Channel " + m[2])},
+                        {"type", Value("audio-channel")},
+                        {"category", Value("audio-channel")},
+                        {"capabilities", Value(CAPABILITIES)}
+                    });
+                }
+            }},
+            {"/opened", {
+                [this](const RouteMatch&) {
+                    std::vector<std::string> children;
+                    for (const auto& [name, _] : _devices) {
+                        children.push_back(name);
+                    }
+                    return Ok(children);
+                },
+                folder("opened", "Opened")
+            }},
+            {"/opened/{device}", {
+                [this](const RouteMatch& m) {
+                    std::vector<std::string> channels;
+                    if (auto device = _device(m[0])) {
+                        for (int i = 0; i < device->num_channels(); ++i) {
+                            channels.push_back(std::to_string(i));
+                        }
+                    }
+                    return Ok(channels);
+                },
+                [this](const RouteMatch& m) {
+                    auto device = _device(m[0]);
+                    if (!device) return Ok(Dict{});
+                    return Ok(Dict{
+                        {"name", Value(device->device_name())},
+                        {"label", Value(device->device_name())},
+                        {"type", Value("alsa-device")},
+                        {"category", Value("audio-device")},
+                        {"status", Value(device->is_running() ? "running" : "stopped")},
+                        {"sample-rate", Value(static_cast<int64_t>(device->sample_rate()))},
+                        {"num-channels", Value(static_cast<int64_t>(device->num_channels()))},
+                        {"access", Value(std::string(device->is_mmap() ? "mmap" : "read/write"))},
+                        {"period-size", Value(static_cast<int64_t>(device->period_size()))},
+                        {"hw-buffer-size", Value(static_cast<int64_t>(device->hw_buffer_size()))},
+                        {"frames-captured", Value(static_cast<int64_t>(device->frames_captured()))}
+                    });
+                }
+            }},
+            {"/opened/{device}/{channel:index}", {
+                none,
+                [this](const RouteMatch& m) {
+                    auto device = _device(m[0]);
+                    auto buffer = device ? device->get_buffer(static_cast<int>(m.index(1))) : nullptr;
+                    if (!buffer) return Ok(Dict{});
+                    return Ok(Dict{
+                        {"name", Value(m[1])},
+                        {"label", Value("Channel " + m[1])},
+                        {"type", Value("audio-channel")},
+                        {"category", Value("audio-channel")},
+                        {"buffer", Value(buffer)}
+                    });
+                }
+            }},
+            {"/opened/{device}/stats/{rest...}", {
+                [this](const RouteMatch& m) {
+                    auto device = _device(m[0]);
+                    if (!device) return Ok(std::vector<std::string>{});
+                    return Ok(audio_stats_children_names(m.rest_list(), device->ring_buffer()));
+                },
+                [this](const RouteMatch& m) {
+                    auto device = _device(m[0]);
+                    if (!device) return Ok(Dict{});
+                    return Ok(audio_stats_metadata(m.rest_list(), &device->stats(), device->ring_buffer()));
+                }
+            }},
+        };
+        for (auto& [pattern, route] : routes) {
+            if (auto res = _router.add(pattern, std::move(route)); !res) {
+                return Err<void>("AlsaManager: bad route", res);
+            }
+        }
+        return Ok();
+    }
+
+    AlsaDevicePtr _device(const std::string& name) const {
+        auto it = _devices.find(name);
+        return it != _devices.end() ? it->second : nullptr;
+    }
+
+    // Open a capture PCM and hand it to the capture thread
+    Result<AlsaDevicePtr> _open_device(const std::string& device_name, const Dict& config) {
+        int num_channels = 2;
+        int sample_rate = 48000;
+        size_t period_size = 1024;
+
+        if (auto c = config.find("num-channels"); c != config.end()) {
+            if (auto v = get_as<int64_t>(c->second)) num_channels = static_cast<int>(*v);
+        }
+        if (auto c = config.find("sample-rate"); c != config.end()) {
+            if (auto v = get_as<int64_t>(c->second)) sample_rate = static_cast<int>(*v);
+        }
+        if (auto c = config.find("period-size"); c != config.end()) {
+            if (auto v = get_as<int64_t>(c->second)) period_size = static_cast<size_t>(*v);
+        }
+
+        auto device_res = AlsaDevice::create(device_name, num_channels, sample_rate, period_size);
+        if (!device_res) {
+            return Err<AlsaDevicePtr>("AlsaManager: failed to create device", device_res);
+        }
+        if (auto res = _engine->add(*device_res); !res) {
+            return Err<AlsaDevicePtr>("AlsaManager: failed to start capture", res);
+        }
+        return *device_res;
+    }
+
     Result<std::vector<std::string>> _get_available_cards() {
         std::vector<std::string> cards;
         int card = -1;
@@ -581,6 +523,8 @@ private:
         return Ok(channels);
     }
 
+    TreeRouter _router;
+    AlsaCaptureEnginePtr _engine;
     std::map<std::string, AlsaDevicePtr> _devices;
 };
 
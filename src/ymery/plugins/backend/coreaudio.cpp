@@ -2,6 +2,7 @@
 #include "../../types.hpp"
 #include "../../result.hpp"
 #include "../../backend/audio_buffer.hpp"
+#include "../../backend/audio_stats.hpp"
 #include <map>
 #include <vector>
 #include <string>
@@ -35,15 +36,14 @@ public:
         device->_sample_rate = sample_rate;
         device->_buffer_size = buffer_size > 0 ? buffer_size : sample_rate;
 
-        // Create ring buffers and mediated buffers per channel
+        // One ring for all channels, one mediated buffer per channel
+        auto buffer_res = AudioRingBuffer::create(sample_rate, device->_buffer_size, 1024, num_channels);
+        if (!buffer_res) {
+            return Err<std::shared_ptr<CoreAudioDevice>>("CoreAudioDevice: failed to create ring buffer", buffer_res);
+        }
+        device->_ring_buffer = *buffer_res;
         for (int ch = 0; ch < num_channels; ++ch) {
-            auto buffer_res = AudioRingBuffer::create(sample_rate, device->_buffer_size, 1024);
-            if (!buffer_res) {
-                return Err<std::shared_ptr<CoreAudioDevice>>("CoreAudioDevice: failed to create ring buffer", buffer_res);
-            }
-            device->_ring_buffers.push_back(*buffer_res);
-
-            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffers[ch]);
+            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffer, ch);
             if (!mediated_res) {
                 return Err<std::shared_ptr<CoreAudioDevice>>("CoreAudioDevice: failed to create mediated buffer", mediated_res);
             }
@@ -96,9 +96,6 @@ public:
             }
         }
 
-        // Allocate deinterleave buffer
-        device->_channel_buffer.resize(1024);
-
         ydebug("CoreAudioDevice: created '{}' with {} channels at {}Hz",
                      device_name, num_channels, sample_rate);
 
@@ -140,6 +137,9 @@ public:
     const std::string& device_name() const { return _device_name; }
     AudioDeviceID device_id() const { return _device_id; }
 
+    const DeviceStats& stats() const { return _stats; }
+    const AudioRingBufferPtr& ring_buffer() const { return _ring_buffer; }
+
     ~CoreAudioDevice() {
         stop();
         if (_queue) {
@@ -160,29 +160,18 @@ private:
         auto* device = static_cast<CoreAudioDevice*>(user_data);
         if (!device->_running) return;
 
+        auto scope = device->_stats.time_callback();
         // Get interleaved float samples
         const float* samples = static_cast<const float*>(buffer->mAudioData);
         UInt32 num_frames = buffer->mAudioDataByteSize / device->_format.mBytesPerFrame;
 
-        // Deinterleave and write to per-channel ring buffers
-        for (int ch = 0; ch < device->_num_channels; ++ch) {
-            device->_deinterleave_channel(samples, ch, num_frames);
-            device->_ring_buffers[ch]->write(device->_channel_buffer.data(), num_frames);
-        }
+        // One block for all channels; the ring deinterleaves
+        device->_ring_buffer->write_interleaved(samples, num_frames);
 
         // Re-enqueue the buffer
         AudioQueueEnqueueBuffer(queue, buffer, 0, nullptr);
     }
 
-    void _deinterleave_channel(const float* interleaved, int channel, UInt32 num_frames) {
-        if (num_frames > _channel_buffer.size()) {
-            _channel_buffer.resize(num_frames);
-        }
-        for (UInt32 i = 0; i < num_frames; ++i) {
-            _channel_buffer[i] = interleaved[i * _num_channels + channel];
-        }
-    }
-
     AudioDeviceID _device_id = 0;
     std::string _device_name;
     int _num_channels = 2;
@@ -193,9 +182,9 @@ private:
     AudioQueueRef _queue = nullptr;
     std::vector<AudioQueueBufferRef> _queue_buffers;
 
-    std::vector<AudioRingBufferPtr> _ring_buffers;
+    AudioRingBufferPtr _ring_buffer;
     std::vector<MediatedAudioBufferPtr> _mediated_buffers;
-    std::vector<float> _channel_buffer;
+    DeviceStats _stats;
 
     std::atomic<bool> _running{false};
 };
@@ -278,6 +267,12 @@ public:
             }
         }
 
+        // /opened/<device>/stats[/<channel>]
+        std::vector<std::string> rel;
+        if (auto device = audio_stats_device(_devices, path, rel)) {
+            return Ok(audio_stats_children_names(rel, device->ring_buffer()));
+        }
+
         return Ok(std::vector<std::string>{});
     }
 
@@ -369,6 +364,12 @@ public:
             }
         }
 
+        // /opened/<device>/stats[/<channel>]
+        std::vector<std::string> rel;
+        if (auto device = audio_stats_device(_devices, path, rel)) {
+            return Ok(audio_stats_metadata(rel, &device->stats(), device->ring_buffer()));
+        }
+
         // /opened/<device>/<channel>
         if (path.as_list().size() == 3 && path.as_list()[0] == "opened") {
             auto it = _devices.find(path.as_list()[1]);
@@ -623,6 +624,7 @@ private:
     }
 
     std::map<AudioDeviceID, DeviceInfo> _available_devices;
+
     std::map<std::string, CoreAudioDevicePtr> _devices;
 };
 
@@ -101,6 +101,56 @@ Result<std::vector<std::string>> FilesystemManager::get_metadata_keys(const Data
     return Ok(keys);
 }
 
+Result<ChildrenMetadata> FilesystemManager::get_children_metadata(const DataPath& path,
+                                                                   const std::vector<std::string>& keys) {
+    std::string dir = _available_directory(path);
+    if (dir.empty()) {
+        return TreeLike::get_children_metadata(path, keys);
+    }
+
+    // One directory pass: the entry type comes from readdir, so children are
+    // not stat'ed (only symlinks are followed)
+    struct Entry {
+        std::string name;
+        std::string fs_path;
+        std::string type;
+    };
+    std::vector<Entry> entries;
+    std::error_code ec;
+    try {
+        for (const auto& entry : fs::directory_iterator(dir, ec)) {
+            std::error_code entry_ec;
+            std::string type = !entry.exists(entry_ec) ? "error"
+                             : entry.is_directory(entry_ec) ? "folder" : "file";
+            entries.push_back({entry.path().filename().string(), entry.path().string(), std::move(type)});
+        }
+    } catch (const fs::filesystem_error& e) {
+        ydebug("FilesystemManager: cannot list {}: {}", dir, e.what());
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+    ChildrenMetadata result(keys);
+    result.reserve(entries.size());
+    for (auto& entry : entries) {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            const auto& key = keys[k];
+            Value value;
+            if (key == "name" || key == "label") {
+                value = Value(entry.name);
+            } else if (key == "type" || key == "category") {
+                value = Value(entry.type);
+            } else if (key == "details" && entry.type != "error") {
+                value = Value(Dict{{"fs-path", Value(entry.fs_path)}});
+            } else if (key == "description" && entry.type == "error") {
+                value = Value("Path does not exist");
+            }
+            result.columns[k].push_back(std::move(value));
+        }
+        result.names.push_back(std::move(entry.name));
+    }
+    return Ok(std::move(result));
+}
+
 Result<Value> FilesystemManager::get(const DataPath& path) {
     auto parent = path.dirname();
     auto key = path.filename();
@@ -223,23 +273,13 @@ Result<std::vector<std::string>> FilesystemManager::_get_available_children(cons
         return Ok(std::vector<std::string>{});
     }
 
-    // Check if under /mounts
-    std::string fs_path;
-    if (subpath.rfind("/mounts/", 0) == 0) {
-        // Extract real path: /mounts/boot/efi -> /boot/efi
-        fs_path = subpath.substr(7);  // Strip "/mounts"
-    } else {
-        // Map virtual path to real
-        fs_path = _map_virtual_to_real(subpath);
-    }
-
-    // Check if path exists and is directory
-    std::error_code ec;
-    if (!fs::exists(fs_path, ec) || !fs::is_directory(fs_path, ec)) {
+    std::string fs_path = _available_directory(path);
+    if (fs_path.empty()) {
         return Ok(std::vector<std::string>{});
     }
 
     // List directory contents
+    std::error_code ec;
     std::vector<std::string> children;
     try {
         for (const auto& entry : fs::directory_iterator(fs_path, ec)) {
@@ -256,6 +296,39 @@ Result<std::vector<std::string>> FilesystemManager::_get_available_children(cons
     return Ok(children);
 }
 
+std::string FilesystemManager::_available_directory(const DataPath& path) {
+    const auto& parts = path.as_list();
+    if (parts.size() < 2 || parts[0] != "available") {
+        return {};
+    }
+
+    // Build subpath (after "available")
+    std::string subpath = "/";
+    for (size_t i = 1; i < parts.size(); ++i) {
+        subpath += parts[i];
+        if (i < parts.size() - 1) subpath += "/";
+    }
+    if (subpath == "/mounts" || subpath == "/bookmarks") {
+        return {};
+    }
+
+    // Check if under /mounts
+    std::string fs_path;
+    if (subpath.rfind("/mounts/", 0) == 0) {
+        // Extract real path: /mounts/boot/efi -> /boot/efi
+        fs_path = subpath.substr(7);  // Strip "/mounts"
+    } else {
+        // Map virtual path to real
+        fs_path = _map_virtual_to_real(subpath);
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(fs_path, ec)) {
+        return {};
+    }
+    return fs_path;
+}
+
 Result<std::vector<std::string>> FilesystemManager::_get_opened_children(const DataPath& path) {
     // Placeholder - no opened devices yet
     return Ok(std::vector<std::string>{});
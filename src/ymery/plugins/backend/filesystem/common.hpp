@@ -28,6 +28,8 @@ public:
     Result<std::vector<std::string>> get_children_names(const DataPath& path) override;
     Result<Dict> get_metadata(const DataPath& path) override;
     Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) override;
+    Result<ChildrenMetadata> get_children_metadata(const DataPath& path,
+                                                   const std::vector<std::string>& keys) override;
     Result<Value> get(const DataPath& path) override;
     Result<void> set(const DataPath& path, const Value& value) override;
     Result<void> add_child(const DataPath& path, const std::string& name, const Dict& data) override;
@@ -40,6 +42,9 @@ private:
     // Map virtual path to real filesystem path
     std::string _map_virtual_to_real(const std::string& path_str);
 
+    // Real directory behind an /available path, empty for virtual folders
+    std::string _available_directory(const DataPath& path);
+
     // Parse /proc/self/mounts to get mounted filesystems
     std::map<std::string, Dict> _parse_mounts();
 
@@ -2,6 +2,10 @@
 #include "../../types.hpp"
 #include "../../result.hpp"
 #include "../../backend/audio_buffer.hpp"
+#include "../../backend/audio_engine.hpp"
+#include "../../backend/audio_stats.hpp"
+#include "../../backend/io_thread.hpp"
+#include <algorithm>
 #include <map>
 #include <set>
 #include <vector>
@@ -60,23 +64,24 @@ public:
             }
         }
 
-        // Create ring buffers and mediated buffers per channel
+        // One ring for all channels, one mediated buffer per channel
         size_t ring_size = device->_sample_rate;  // 1 second buffer
+        auto buffer_res = AudioRingBuffer::create(
+            device->_sample_rate, ring_size, device->_buffer_size, device->_num_channels);
+        if (!buffer_res) {
+            jack_client_close(device->_client);
+            return Err<std::shared_ptr<JackDevice>>("JackDevice: failed to create ring buffer", buffer_res);
+        }
+        device->_ring_buffer = *buffer_res;
         for (int ch = 0; ch < device->_num_channels; ++ch) {
-            auto buffer_res = AudioRingBuffer::create(device->_sample_rate, ring_size, device->_buffer_size);
-            if (!buffer_res) {
-                jack_client_close(device->_client);
-                return Err<std::shared_ptr<JackDevice>>("JackDevice: failed to create ring buffer", buffer_res);
-            }
-            device->_ring_buffers.push_back(*buffer_res);
-
-            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffers[ch]);
+            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffer, ch);
             if (!mediated_res) {
                 jack_client_close(device->_client);
                 return Err<std::shared_ptr<JackDevice>>("JackDevice: failed to create mediated buffer", mediated_res);
             }
             device->_mediated_buffers.push_back(*mediated_res);
         }
+        device->_port_buffers.resize(device->_num_channels, nullptr);
 
         // Register input ports
         for (int i = 0; i < device->_num_channels; ++i) {
@@ -97,6 +102,9 @@ public:
         // Set shutdown callback
         jack_on_shutdown(device->_client, _shutdown_callback, device.get());
 
+        // Count xruns reported by the server
+        jack_set_xrun_callback(device->_client, _xrun_callback, device.get());
+
         ydebug("JackDevice: created client '{}' with {} channels at {}Hz, buffer={}",
                      client_name, device->_num_channels, device->_sample_rate, device->_buffer_size);
 
@@ -106,8 +114,13 @@ public:
     Result<void> start() {
         if (_running) return Ok();
 
+        // The server owns the process thread and its scheduling; we only monitor it
+        _monitor = IoThreadService::instance().register_thread(
+            "jack:" + _client_name, io_period_ns(_buffer_size, _sample_rate));
+
         // Activate client
         if (jack_activate(_client) != 0) {
+            IoThreadService::instance().unregister_thread(_monitor);
             return Err<void>("JackDevice: failed to activate client");
         }
 
@@ -141,6 +154,7 @@ public:
             jack_deactivate(_client);
             ydebug("JackDevice: deactivated client '{}'", _client_name);
         }
+        IoThreadService::instance().unregister_thread(_monitor);
     }
 
     bool is_running() const { return _running; }
@@ -157,6 +171,9 @@ public:
     size_t buffer_size() const { return _buffer_size; }
     const std::string& client_name() const { return _client_name; }
 
+    const DeviceStats& stats() const { return _stats; }
+    const AudioRingBufferPtr& ring_buffer() const { return _ring_buffer; }
+
     std::vector<std::string> get_port_names() const {
         std::vector<std::string> names;
         for (int i = 0; i < _num_channels; ++i) {
@@ -178,16 +195,20 @@ private:
         auto* device = static_cast<JackDevice*>(arg);
         if (!device->_running) return 0;
 
+        device->_monitor->beat(io_period_ns(nframes, device->_sample_rate));
+        auto scope = device->_stats.time_callback();
+        // Port buffers are planar already; one block for all channels
         for (int ch = 0; ch < device->_num_channels; ++ch) {
-            jack_default_audio_sample_t* buffer =
-                static_cast<jack_default_audio_sample_t*>(
-                    jack_port_get_buffer(device->_input_ports[ch], nframes));
-
-            if (buffer) {
-                device->_ring_buffers[ch]->write(buffer, nframes);
-            }
+            device->_port_buffers[ch] = static_cast<const jack_default_audio_sample_t*>(
+                jack_port_get_buffer(device->_input_ports[ch], nframes));
         }
+        device->_ring_buffer->write_planar(device->_port_buffers.data(), nframes);
+
+        return 0;
+    }
 
+    static int _xrun_callback(void* arg) {
+        static_cast<JackDevice*>(arg)->_stats.record_xrun();
         return 0;
     }
 
@@ -206,14 +227,174 @@ private:
 
     jack_client_t* _client = nullptr;
     std::vector<jack_port_t*> _input_ports;
-    std::vector<AudioRingBufferPtr> _ring_buffers;
+    AudioRingBufferPtr _ring_buffer;
     std::vector<MediatedAudioBufferPtr> _mediated_buffers;
+    std::vector<const float*> _port_buffers;  // per-callback scratch, sized at create
+    DeviceStats _stats;
+    IoThreadMonitorPtr _monitor;  // JACK process thread
 
     std::atomic<bool> _running{false};
 };
 
 using JackDevicePtr = std::shared_ptr<JackDevice>;
 
+/**
+ * JackSink - playback sink for the audio engine
+ * Registers one output port per engine channel; the process callback
+ * renders into a preallocated interleaved block and splits it into the
+ * port buffers. The JACK server's sample rate must match the engine's.
+ */
+class JackSink : public AudioSink {
+public:
+    static Result<AudioSinkPtr> create(const std::string& client_name, bool auto_connect) {
+        auto sink = std::shared_ptr<JackSink>(new JackSink());
+        sink->_client_name = client_name;
+        sink->_auto_connect = auto_connect;
+        return Ok(AudioSinkPtr(sink));
+    }
+
+    ~JackSink() override {
+        stop();
+    }
+
+    Result<void> start(const AudioEngineConfig& config, AudioRenderFn render) override {
+        if (_running) return Ok();
+
+        jack_status_t status;
+        _client = jack_client_open(_client_name.c_str(), JackNoStartServer, &status);
+        if (!_client) {
+            return Err<void>("JackSink: failed to open client '" + _client_name + "', status=" + std::to_string(status));
+        }
+
+        auto server_rate = static_cast<int>(jack_get_sample_rate(_client));
+        if (server_rate != config.sample_rate) {
+            _close();
+            return Err<void>("JackSink: server runs at " + std::to_string(server_rate) +
+                             "Hz, engine at " + std::to_string(config.sample_rate) + "Hz");
+        }
+
+        for (size_t i = 0; i < config.channels; ++i) {
+            std::string port_name = "output_" + std::to_string(i);
+            jack_port_t* port = jack_port_register(_client, port_name.c_str(),
+                JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+            if (!port) {
+                _close();
+                return Err<void>("JackSink: failed to register port '" + port_name + "'");
+            }
+            _output_ports.push_back(port);
+        }
+
+        _channels = config.channels;
+        _render = std::move(render);
+        _max_frames = std::max<size_t>(jack_get_buffer_size(_client), config.block_frames);
+        _block.assign(_max_frames * _channels, 0.0f);
+
+        jack_set_process_callback(_client, _process_callback, this);
+        jack_set_xrun_callback(_client, _xrun_callback, this);
+        jack_on_shutdown(_client, _shutdown_callback, this);
+
+        _monitor = IoThreadService::instance().register_thread(
+            "jack-sink:" + _client_name, io_period_ns(jack_get_buffer_size(_client), config.sample_rate));
+        _sample_rate = config.sample_rate;
+        _running = true;
+        if (jack_activate(_client) != 0) {
+            _running = false;
+            IoThreadService::instance().unregister_thread(_monitor);
+            _close();
+            return Err<void>("JackSink: failed to activate client");
+        }
+
+        if (_auto_connect) {
+            const char** ports = jack_get_ports(_client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                                                JackPortIsPhysical | JackPortIsInput);
+            if (ports) {
+                for (size_t i = 0; ports[i] && i < _output_ports.size(); ++i) {
+                    jack_connect(_client, jack_port_name(_output_ports[i]), ports[i]);
+                }
+                jack_free(ports);
+            }
+        }
+        return Ok();
+    }
+
+    Result<void> stop() override {
+        if (_running) {
+            _running = false;
+            jack_deactivate(_client);
+            IoThreadService::instance().unregister_thread(_monitor);
+        }
+        _close();
+        return Ok();
+    }
+
+    bool is_running() const override { return _running; }
+    std::string kind() const override { return "jack"; }
+    uint64_t frames_played() const override { return _frames_played.load(std::memory_order_relaxed); }
+    const DeviceStats& stats() const override { return _stats; }
+
+private:
+    JackSink() = default;
+
+    void _close() {
+        if (_client) {
+            jack_client_close(_client);
+            _client = nullptr;
+        }
+        _output_ports.clear();
+    }
+
+    static int _process_callback(jack_nframes_t nframes, void* arg) {
+        auto* sink = static_cast<JackSink*>(arg);
+        const bool play = sink->_running && nframes <= sink->_max_frames;
+        if (sink->_running) {
+            sink->_monitor->beat(io_period_ns(nframes, sink->_sample_rate));
+        }
+        if (play) {
+            auto scope = sink->_stats.time_callback();
+            sink->_render(sink->_block.data(), nframes);
+        } else if (sink->_running) {
+            sink->_stats.record_xrun();  // period grew past the preallocated block
+            sink->_monitor->defer_log(IoLogLevel::Warn, "period exceeds the preallocated block", nframes);
+        }
+
+        for (size_t ch = 0; ch < sink->_output_ports.size(); ++ch) {
+            auto* out = static_cast<jack_default_audio_sample_t*>(
+                jack_port_get_buffer(sink->_output_ports[ch], nframes));
+            for (jack_nframes_t i = 0; i < nframes; ++i) {
+                out[i] = play ? sink->_block[i * sink->_channels + ch] : 0.0f;
+            }
+        }
+        if (play) sink->_frames_played.fetch_add(nframes, std::memory_order_relaxed);
+        return 0;
+    }
+
+    static int _xrun_callback(void* arg) {
+        static_cast<JackSink*>(arg)->_stats.record_xrun();
+        return 0;
+    }
+
+    static void _shutdown_callback(void* arg) {
+        ywarn("JackSink: JACK server shutdown");
+        static_cast<JackSink*>(arg)->_running = false;
+    }
+
+    std::string _client_name;
+    bool _auto_connect = true;
+
+    jack_client_t* _client = nullptr;
+    std::vector<jack_port_t*> _output_ports;
+    size_t _channels = 2;
+    size_t _max_frames = 0;
+    int _sample_rate = 48000;
+    AudioRenderFn _render;
+    std::vector<float> _block;  // interleaved, sized at start
+    DeviceStats _stats;
+    IoThreadMonitorPtr _monitor;  // JACK process thread
+
+    std::atomic<uint64_t> _frames_played{0};
+    std::atomic<bool> _running{false};
+};
+
 /**
  * JackManager - manages JACK clients, implements TreeLike
  * Tree structure:
@@ -243,10 +424,24 @@ public:
         if (!_query_client) {
             ywarn("JackManager: JACK server not running (status={})", static_cast<int>(status));
         }
+
+        // The engine can play through JACK while this plugin is loaded
+        register_audio_sink("jack", [](const Dict& options) -> Result<AudioSinkPtr> {
+            std::string client_name = "ymery_playback";
+            bool auto_connect = true;
+            if (auto it = options.find("client"); it != options.end()) {
+                if (auto name = get_as<std::string>(it->second)) client_name = *name;
+            }
+            if (auto it = options.find("auto-connect"); it != options.end()) {
+                if (auto b = get_as<bool>(it->second)) auto_connect = *b;
+            }
+            return JackSink::create(client_name, auto_connect);
+        });
         return Ok();
     }
 
     Result<void> dispose() override {
+        unregister_audio_sink("jack");
         for (auto& [_, device] : _devices) {
             device->stop();
         }
@@ -317,6 +512,12 @@ public:
             }
         }
 
+        // /opened/<device>/stats[/<channel>]
+        std::vector<std::string> rel;
+        if (auto device = audio_stats_device(_devices, path, rel)) {
+            return Ok(audio_stats_children_names(rel, device->ring_buffer()));
+        }
+
         return Ok(std::vector<std::string>{});
     }
 
@@ -449,6 +650,12 @@ public:
             }
         }
 
+        // /opened/<device>/stats[/<channel>]
+        std::vector<std::string> rel;
+        if (auto device = audio_stats_device(_devices, path, rel)) {
+            return Ok(audio_stats_metadata(rel, &device->stats(), device->ring_buffer()));
+        }
+
         // /opened/<device>/<channel>
         if (path.as_list().size() == 3 && path.as_list()[0] == "opened") {
             auto it = _devices.find(path.as_list()[1]);
@@ -653,6 +860,7 @@ private:
     }
 
     jack_client_t* _query_client = nullptr;
+
     std::map<std::string, JackDevicePtr> _devices;
     std::mutex _mutex;
 };
@@ -2,6 +2,10 @@
 #include "../../types.hpp"
 #include "../../result.hpp"
 #include "../../backend/audio_buffer.hpp"
+#include "../../backend/audio_engine.hpp"
+#include "../../backend/audio_stats.hpp"
+#include "../../backend/io_thread.hpp"
+#include <algorithm>
 #include <map>
 #include <set>
 #include <vector>
@@ -35,26 +39,22 @@ public:
         device->_num_channels = num_channels;
         device->_sample_rate = sample_rate;
 
-        // Create ring buffers and mediated buffers per channel
+        // One ring for all channels, one mediated buffer per channel
         size_t ring_size = sample_rate;  // 1 second buffer
         size_t period_size = 1024;
+        auto buffer_res = AudioRingBuffer::create(sample_rate, ring_size, period_size, num_channels);
+        if (!buffer_res) {
+            return Err<std::shared_ptr<PipeWireDevice>>("PipeWireDevice: failed to create ring buffer", buffer_res);
+        }
+        device->_ring_buffer = *buffer_res;
         for (int ch = 0; ch < num_channels; ++ch) {
-            auto buffer_res = AudioRingBuffer::create(sample_rate, ring_size, period_size);
-            if (!buffer_res) {
-                return Err<std::shared_ptr<PipeWireDevice>>("PipeWireDevice: failed to create ring buffer", buffer_res);
-            }
-            device->_ring_buffers.push_back(*buffer_res);
-
-            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffers[ch]);
+            auto mediated_res = MediatedAudioBuffer::create(device->_ring_buffer, ch);
             if (!mediated_res) {
                 return Err<std::shared_ptr<PipeWireDevice>>("PipeWireDevice: failed to create mediated buffer", mediated_res);
             }
             device->_mediated_buffers.push_back(*mediated_res);
         }
 
-        // Allocate deinterleave buffer
-        device->_channel_buffer.resize(period_size);
-
         ydebug("PipeWireDevice: created for '{}' with {} channels at {}Hz",
                      target_name, num_channels, sample_rate);
 
@@ -65,7 +65,8 @@ public:
         if (_running) return Ok();
 
         _running = true;
-        _thread = std::thread(&PipeWireDevice::_run, this);
+        _thread.start("pipewire:" + _target_name, io_period_ns(_ring_buffer->period_size(), _sample_rate),
+                      [this] { _run(); });
 
         ydebug("PipeWireDevice: started '{}'", _target_name);
         return Ok();
@@ -80,9 +81,7 @@ public:
             pw_loop_signal_event(_loop, _quit_signal);
         }
 
-        if (_thread.joinable()) {
-            _thread.join();
-        }
+        _thread.join();
 
         ydebug("PipeWireDevice: stopped '{}'", _target_name);
     }
@@ -100,6 +99,9 @@ public:
     int sample_rate() const { return _sample_rate; }
     const std::string& target_name() const { return _target_name; }
 
+    const DeviceStats& stats() const { return _stats; }
+    const AudioRingBufferPtr& ring_buffer() const { return _ring_buffer; }
+
     std::vector<std::string> get_port_names() const {
         std::vector<std::string> names;
         for (int i = 0; i < _num_channels; ++i) {
@@ -229,8 +231,14 @@ private:
         auto* device = static_cast<PipeWireDevice*>(userdata);
         if (!device->_running || !device->_stream) return;
 
+        auto scope = device->_stats.time_callback();
         struct pw_buffer* b = pw_stream_dequeue_buffer(device->_stream);
-        if (!b) return;
+        if (!b) {
+            // Out of buffers - the graph ran without us
+            device->_stats.record_xrun();
+            device->_thread.defer_log(IoLogLevel::Warn, "out of buffers");
+            return;
+        }
 
         struct spa_buffer* buf = b->buffer;
         if (!buf->datas[0].data) {
@@ -240,12 +248,10 @@ private:
 
         const float* samples = static_cast<const float*>(buf->datas[0].data);
         uint32_t n_frames = buf->datas[0].chunk->size / (sizeof(float) * device->_num_channels);
+        device->_thread.beat(io_period_ns(n_frames, device->_sample_rate));
 
-        // Deinterleave and write to per-channel ring buffers
-        for (int ch = 0; ch < device->_num_channels; ++ch) {
-            device->_deinterleave_channel(samples, ch, n_frames);
-            device->_ring_buffers[ch]->write(device->_channel_buffer.data(), n_frames);
-        }
+        // One block for all channels; the ring deinterleaves
+        device->_ring_buffer->write_interleaved(samples, n_frames);
 
         pw_stream_queue_buffer(device->_stream, b);
     }
@@ -255,15 +261,6 @@ private:
         device->_running = false;
     }
 
-    void _deinterleave_channel(const float* interleaved, int channel, uint32_t num_frames) {
-        if (num_frames > _channel_buffer.size()) {
-            _channel_buffer.resize(num_frames);
-        }
-        for (uint32_t i = 0; i < num_frames; ++i) {
-            _channel_buffer[i] = interleaved[i * _num_channels + channel];
-        }
-    }
-
     std::string _target_name;
     int _num_channels = 2;
     int _sample_rate = 48000;
@@ -273,16 +270,205 @@ private:
     struct spa_hook _stream_listener{};
     struct spa_source* _quit_signal = nullptr;
 
-    std::vector<AudioRingBufferPtr> _ring_buffers;
+    AudioRingBufferPtr _ring_buffer;
     std::vector<MediatedAudioBufferPtr> _mediated_buffers;
-    std::vector<float> _channel_buffer;
+    DeviceStats _stats;
 
     std::atomic<bool> _running{false};
-    std::thread _thread;
+    IoThread _thread;
 };
 
 using PipeWireDevicePtr = std::shared_ptr<PipeWireDevice>;
 
+/**
+ * PipeWireSink - playback sink for the audio engine
+ * Runs an output stream on its own loop thread; each process callback
+ * renders straight into the dequeued buffer, as many frames as the graph
+ * requested (one engine block if it did not say).
+ */
+class PipeWireSink : public AudioSink {
+public:
+    static Result<AudioSinkPtr> create(const std::string& target_name) {
+        auto sink = std::shared_ptr<PipeWireSink>(new PipeWireSink());
+        sink->_target_name = target_name;
+        return Ok(AudioSinkPtr(sink));
+    }
+
+    ~PipeWireSink() override {
+        stop();
+    }
+
+    Result<void> start(const AudioEngineConfig& config, AudioRenderFn render) override {
+        if (_running) return Ok();
+
+        _config = config;
+        _render = std::move(render);
+        _running = true;
+        _thread.start("pipewire-sink:" + _target_name, io_period_ns(config.block_frames, config.sample_rate),
+                      [this] { _run(); });
+
+        ydebug("PipeWireSink: started '{}' with {} channels at {}Hz",
+               _target_name, config.channels, config.sample_rate);
+        return Ok();
+    }
+
+    Result<void> stop() override {
+        if (_running) {
+            _running = false;
+            if (_loop) {
+                pw_loop_signal_event(_loop, _quit_signal);
+            }
+        }
+        _thread.join();
+        return Ok();
+    }
+
+    bool is_running() const override { return _running; }
+    std::string kind() const override { return "pipewire"; }
+    uint64_t frames_played() const override { return _frames_played.load(std::memory_order_relaxed); }
+    const DeviceStats& stats() const override { return _stats; }
+
+private:
+    PipeWireSink() = default;
+
+    void _run() {
+        pw_init(nullptr, nullptr);
+
+        _loop = pw_loop_new(nullptr);
+        if (!_loop) {
+            ywarn("PipeWireSink: failed to create loop");
+            _running = false;
+            return;
+        }
+        _quit_signal = pw_loop_add_signal(_loop, SIGINT, _on_quit_signal, this);
+
+        struct pw_context* context = pw_context_new(_loop, nullptr, 0);
+        struct pw_core* core = context ? pw_context_connect(context, nullptr, 0) : nullptr;
+        if (!core) {
+            ywarn("PipeWireSink: failed to connect to PipeWire");
+            if (context) pw_context_destroy(context);
+            pw_loop_destroy(_loop);
+            _loop = nullptr;
+            _running = false;
+            return;
+        }
+
+        uint8_t buffer[1024];
+        struct spa_pod_builder b = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+
+        struct spa_audio_info_raw audio_info = {};
+        audio_info.format = SPA_AUDIO_FORMAT_F32;
+        audio_info.rate = _config.sample_rate;
+        audio_info.channels = static_cast<uint32_t>(_config.channels);
+
+        const struct spa_pod* params[1];
+        params[0] = spa_format_audio_raw_build(&b, SPA_PARAM_EnumFormat, &audio_info);
+
+        static const struct pw_stream_events stream_events = {
+            .version = PW_VERSION_STREAM_EVENTS,
+            .process = _on_process,
+        };
+
+        std::string latency = std::to_string(_config.block_frames) + "/" + std::to_string(_config.sample_rate);
+        struct pw_properties* props = pw_properties_new(
+            PW_KEY_MEDIA_TYPE, "Audio",
+            PW_KEY_MEDIA_CATEGORY, "Playback",
+            PW_KEY_MEDIA_ROLE, "Music",
+            PW_KEY_NODE_LATENCY, latency.c_str(),
+            nullptr
+        );
+        if (!_target_name.empty() && _target_name != "default") {
+            pw_properties_set(props, PW_KEY_TARGET_OBJECT, _target_name.c_str());
+        }
+
+        _stream = pw_stream_new(core, "ymery-playback", props);
+        int res = _stream ? 0 : -ENOMEM;
+        if (_stream) {
+            pw_stream_add_listener(_stream, &_stream_listener, &stream_events, this);
+            res = pw_stream_connect(_stream,
+                PW_DIRECTION_OUTPUT,
+                PW_ID_ANY,
+                static_cast<pw_stream_flags>(
+                    PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS | PW_STREAM_FLAG_RT_PROCESS),
+                params, 1);
+        }
+
+        if (res < 0) {
+            ywarn("PipeWireSink: failed to connect stream: {}", spa_strerror(res));
+            _running = false;
+        }
+
+        while (_running) {
+            pw_loop_iterate(_loop, -1);
+        }
+
+        if (_stream) {
+            pw_stream_destroy(_stream);
+            _stream = nullptr;
+        }
+        pw_core_disconnect(core);
+        pw_context_destroy(context);
+        pw_loop_destroy(_loop);
+        _loop = nullptr;
+
+        pw_deinit();
+    }
+
+    static void _on_process(void* userdata) {
+        auto* sink = static_cast<PipeWireSink*>(userdata);
+        if (!sink->_running || !sink->_stream) return;
+
+        struct pw_buffer* b = pw_stream_dequeue_buffer(sink->_stream);
+        if (!b) {
+            sink->_stats.record_xrun();
+            sink->_thread.defer_log(IoLogLevel::Warn, "out of buffers");
+            return;
+        }
+
+        struct spa_buffer* buf = b->buffer;
+        auto* out = static_cast<float*>(buf->datas[0].data);
+        if (!out) {
+            pw_stream_queue_buffer(sink->_stream, b);
+            return;
+        }
+
+        const uint32_t stride = static_cast<uint32_t>(sizeof(float) * sink->_config.channels);
+        uint64_t frames = buf->datas[0].maxsize / stride;
+        uint64_t wanted = b->requested ? b->requested : sink->_config.block_frames;
+        frames = std::min(frames, wanted);
+        sink->_thread.beat(io_period_ns(frames, sink->_config.sample_rate));
+
+        {
+            auto scope = sink->_stats.time_callback();
+            sink->_render(out, static_cast<size_t>(frames));
+        }
+
+        buf->datas[0].chunk->offset = 0;
+        buf->datas[0].chunk->stride = static_cast<int32_t>(stride);
+        buf->datas[0].chunk->size = static_cast<uint32_t>(frames * stride);
+        pw_stream_queue_buffer(sink->_stream, b);
+        sink->_frames_played.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    static void _on_quit_signal(void* userdata, int signal_number) {
+        static_cast<PipeWireSink*>(userdata)->_running = false;
+    }
+
+    std::string _target_name;
+    AudioEngineConfig _config;
+    AudioRenderFn _render;
+
+    struct pw_loop* _loop = nullptr;
+    struct pw_stream* _stream = nullptr;
+    struct spa_hook _stream_listener{};
+    struct spa_source* _quit_signal = nullptr;
+
+    DeviceStats _stats;
+    std::atomic<uint64_t> _frames_played{0};
+    std::atomic<bool> _running{false};
+    IoThread _thread;
+};
+
 /**
  * PipeWireManager - manages PipeWire streams, implements TreeLike
  * Tree structure:
@@ -307,11 +493,21 @@ public:
     Result<void> init() override {
         pw_init(nullptr, nullptr);
         _initialized = true;
+
+        // The engine can play through PipeWire while this plugin is loaded
+        register_audio_sink("pipewire", [](const Dict& options) -> Result<AudioSinkPtr> {
+            std::string target_name = "default";
+            if (auto it = options.find("target"); it != options.end()) {
+                if (auto name = get_as<std::string>(it->second)) target_name = *name;
+            }
+            return PipeWireSink::create(target_name);
+        });
         ydebug("PipeWireManager: initialized");
         return Ok();
     }
 
     Result<void> dispose() override {
+        unregister_audio_sink("pipewire");
         for (auto& [_, device] : _devices) {
             device->stop();
         }
@@ -375,6 +571,12 @@ public:
             }
         }
 
+        // /opened/<device>/stats[/<channel>]
+        std::vector<std::string> rel;
+        if (auto device = audio_stats_device(_devices, path, rel)) {
+            return Ok(audio_stats_children_names(rel, device->ring_buffer()));
+        }
+
         return Ok(std::vector<std::string>{});
     }
 
@@ -487,6 +689,12 @@ public:
             }
         }
 
+        // /opened/<device>/stats[/<channel>]
+        std::vector<std::string> rel;
+        if (auto device = audio_stats_device(_devices, path, rel)) {
+            return Ok(audio_stats_metadata(rel, &device->stats(), device->ring_buffer()));
+        }
+
         // /opened/<device>/<channel>
         if (path.as_list().size() == 3 && path.as_list()[0] == "opened") {
             auto it = _devices.find(path.as_list()[1]);
@@ -605,6 +813,7 @@ private:
         return Ok(std::vector<std::string>{});
     }
 
+
     std::map<std::string, PipeWireDevicePtr> _devices;
     bool _initialized = false;
 };
@@ -2,6 +2,7 @@
 #include "../../types.hpp"
 #include "../../result.hpp"
 #include "../../backend/audio_buffer.hpp"
+#include "../../backend/io_thread.hpp"
 #include <map>
 #include <thread>
 #include <atomic>
@@ -62,14 +63,12 @@ public:
     void start() {
         if (_running) return;
         _running = true;
-        _thread = std::thread(&WaveformDevice::_run, this);
+        _thread.start("waveform:" + _waveform_type, io_period_ns(_period_size, _sample_rate), [this] { _run(); });
     }
 
     void stop() {
         _running = false;
-        if (_thread.joinable()) {
-            _thread.join();
-        }
+        _thread.join();
     }
 
     bool is_running() const { return _running; }
@@ -87,6 +86,7 @@ public:
 private:
     void _run() {
         while (_running) {
+            _thread.beat();
             _generate_waveform();
             _ring_buffer->write(_sample_buffer);
 
@@ -129,7 +129,7 @@ private:
     std::vector<float> _sample_buffer;
 
     std::atomic<bool> _running{false};
-    std::thread _thread;
+    IoThread _thread;
 };
 
 using WaveformDevicePtr = std::shared_ptr<WaveformDevice>;
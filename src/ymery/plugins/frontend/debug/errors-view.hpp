@@ -2,6 +2,7 @@
 #include "../../../frontend/widget.hpp"
 #include "../../../error_buffer.hpp"
 #include <imgui.h>
+#include <vector>
 
 namespace ymery::plugins::debug {
 
@@ -41,59 +42,62 @@ public:
 
     Result<void> render() override {
         auto& buffer = get_thread_error_buffer();
+        _push_imgui_id();
 
-        if (ImGui::Button(("Clear###clear_" + _uid).c_str())) {
+        if (ImGui::Button("Clear###clear")) {
             buffer.clear();
         }
         ImGui::SameLine();
-        ImGui::Checkbox(("Auto-scroll###autoscroll_" + _uid).c_str(), &_auto_scroll);
+        ImGui::Checkbox("Auto-scroll###autoscroll", &_auto_scroll);
         ImGui::SameLine();
-        ImGui::Checkbox(("Timestamps###timestamps_" + _uid).c_str(), &_show_timestamp);
+        ImGui::Checkbox("Timestamps###timestamps", &_show_timestamp);
         ImGui::SameLine();
-        ImGui::Checkbox(("Locations###locations_" + _uid).c_str(), &_show_location);
+        ImGui::Checkbox("Locations###locations", &_show_location);
         ImGui::SameLine();
         ImGui::Text("Errors: %zu/%zu", buffer.size(), buffer.max_size());
 
         ImGui::Separator();
 
-        ImGui::BeginChild(("ErrorEntries###errorentries_" + _uid).c_str(), ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
-
-        int entry_idx = 0;
-        for (const auto& entry : buffer.entries()) {
-            ImGui::PushID(entry_idx++);
-
-            ImVec4 color = ErrorBuffer::level_to_color(entry.level);
-
-            std::string label;
-            if (_show_timestamp) {
-                label = "[" + entry.timestamp + "] ";
-            }
-            label += entry.error.message();
-
-            ImGui::PushStyleColor(ImGuiCol_Text, color);
-
-            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen;
-            if (!entry.error.prev_error()) {
-                flags |= ImGuiTreeNodeFlags_Leaf;
-            }
-
-            if (ImGui::TreeNodeEx(label.c_str(), flags)) {
-                if (_show_location) {
-                    ImGui::TextDisabled("  @ %s:%u",
-                        entry.error.location().file_name(),
-                        entry.error.location().line());
+        _sync(buffer);
+
+        ImGui::BeginChild("ErrorEntries###errorentries", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
+
+        // Error chains are flattened into fixed-height rows so only the
+        // visible ones are drawn
+        const float indent = ImGui::GetStyle().IndentSpacing;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(_rows.size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const auto& row = _rows[i];
+                const auto& entry = buffer.entries()[row.entry];
+
+                std::string label;
+                if (row.depth == 0) {
+                    if (_show_timestamp) {
+                        label = "[" + entry.timestamp() + "] ";
+                    }
+                    label += row.error->message();
+                } else {
+                    label = "<- " + row.error->message();
                 }
 
-                if (entry.error.prev_error()) {
-                    _render_error_chain(entry.error.prev_error());
+                if (row.depth > 0) {
+                    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + indent * row.depth);
                 }
+                ImGui::PushStyleColor(ImGuiCol_Text, ErrorBuffer::level_to_color(entry.level));
+                ImGui::TextUnformatted(label.c_str());
+                ImGui::PopStyleColor();
 
-                ImGui::TreePop();
+                if (_show_location) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("@ %s:%u",
+                        row.error->location().file_name(),
+                        row.error->location().line());
+                }
             }
-
-            ImGui::PopStyleColor();
-            ImGui::PopID();
         }
+        clipper.End();
 
         if (_auto_scroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
             ImGui::SetScrollHereY(1.0f);
@@ -101,38 +105,38 @@ public:
 
         ImGui::EndChild();
 
+        _pop_imgui_id();
         return Ok();
     }
 
 private:
+    struct Row {
+        size_t entry;        // index into the buffer's entries
+        const Error* error;  // the error itself or one of its causes
+        int depth;           // 0 for the entry, 1+ along the prev_error chain
+    };
+
+    // Rebuild the flattened rows only when the buffer changed
+    void _sync(const ErrorBuffer& buffer) {
+        if (buffer.generation() == _seen_generation) return;
+        _seen_generation = buffer.generation();
+
+        _rows.clear();
+        const auto& entries = buffer.entries();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            int depth = 0;
+            for (const Error* e = &entries[i].error; e; e = e->prev_error()) {
+                _rows.push_back({i, e, depth++});
+            }
+        }
+    }
+
     bool _auto_scroll = true;
     bool _show_timestamp = true;
     bool _show_location = true;
 
-    void _render_error_chain(const Error* error) {
-        if (!error) return;
-
-        std::string label = "<- " + error->message();
-
-        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen;
-        if (!error->prev_error()) {
-            flags |= ImGuiTreeNodeFlags_Leaf;
-        }
-
-        if (ImGui::TreeNodeEx(label.c_str(), flags)) {
-            if (_show_location) {
-                ImGui::TextDisabled("  @ %s:%u",
-                    error->location().file_name(),
-                    error->location().line());
-            }
-
-            if (error->prev_error()) {
-                _render_error_chain(error->prev_error());
-            }
-
-            ImGui::TreePop();
-        }
-    }
+    std::vector<Row> _rows;
+    uint64_t _seen_generation = ~uint64_t{0};
 };
 
 } // namespace ymery::plugins::debug
@@ -2,6 +2,8 @@
 #include "../../../frontend/widget.hpp"
 #include "../../../log_buffer.hpp"
 #include <imgui.h>
+#include <deque>
+#include <vector>
 
 namespace ymery::plugins::debug {
 
@@ -44,56 +46,64 @@ public:
 
     Result<void> render() override {
         auto& buffer = get_log_buffer();
+        _push_imgui_id();
 
-        if (ImGui::Button(("Clear###clear_" + _uid).c_str())) {
+        if (ImGui::Button("Clear###clear")) {
             buffer.clear();
         }
         ImGui::SameLine();
-        ImGui::Checkbox(("Auto-scroll###autoscroll_" + _uid).c_str(), &_auto_scroll);
+        ImGui::Checkbox("Auto-scroll###autoscroll", &_auto_scroll);
         ImGui::SameLine();
-        ImGui::Checkbox(("Time###time_" + _uid).c_str(), &_show_timestamp);
+        ImGui::Checkbox("Time###time", &_show_timestamp);
         ImGui::SameLine();
-        ImGui::Checkbox(("Level###level_" + _uid).c_str(), &_show_level);
+        ImGui::Checkbox("Level###level", &_show_level);
         ImGui::SameLine();
-        ImGui::Checkbox(("Source###source_" + _uid).c_str(), &_show_source);
+        ImGui::Checkbox("Source###source", &_show_source);
         ImGui::SameLine();
-        ImGui::Text("Logs: %zu/%zu", buffer.size(), buffer.max_size());
+        ImGui::Text("Logs: %zu/%zu", _filtered.size(), buffer.max_size());
 
         ImGui::SameLine();
         ImGui::SetNextItemWidth(100);
         const char* level_names[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "CRITICAL" };
-        ImGui::Combo(("###minlevel_" + _uid).c_str(), &_min_level, level_names, IM_ARRAYSIZE(level_names));
+        bool refilter = ImGui::Combo("###minlevel", &_min_level, level_names, IM_ARRAYSIZE(level_names));
 
-        ImGui::Separator();
-
-        ImGui::BeginChild(("LogEntries###logentries_" + _uid).c_str(), ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
-
-        auto entries = buffer.entries();
-
-        for (const auto& entry : entries) {
-            if (static_cast<int>(entry.level) < _min_level) continue;
-
-            ImVec4 color = LogBuffer::level_to_color(entry.level);
+        ImGui::SameLine();
+        refilter |= _text_filter.Draw("Filter###filter", 160);
 
-            std::string line;
-            if (_show_timestamp) line += "[" + entry.timestamp + "] ";
-            if (_show_level) {
-                line += "[";
-                line += LogBuffer::level_to_string(entry.level);
-                line += "] ";
-            }
-            line += entry.message;
+        _sync(buffer, refilter);
 
-            ImGui::PushStyleColor(ImGuiCol_Text, color);
-            ImGui::TextUnformatted(line.c_str());
+        ImGui::Separator();
 
-            if (_show_source && !entry.source_file.empty()) {
-                ImGui::SameLine();
-                ImGui::TextDisabled("@ %s:%d", entry.source_file.c_str(), entry.source_line);
+        ImGui::BeginChild("LogEntries###logentries", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
+
+        // Only the visible rows are formatted and drawn
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(_filtered.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const auto& entry = _cache[_filtered[row] - _cache_base];
+
+                std::string line;
+                if (_show_timestamp) line += "[" + entry.timestamp + "] ";
+                if (_show_level) {
+                    line += "[";
+                    line += LogBuffer::level_to_string(entry.level);
+                    line += "] ";
+                }
+                line += entry.message;
+
+                ImGui::PushStyleColor(ImGuiCol_Text, LogBuffer::level_to_color(entry.level));
+                ImGui::TextUnformatted(line.c_str());
+
+                if (_show_source && !entry.source_file.empty()) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("@ %s:%d", entry.source_file.c_str(), entry.source_line);
+                }
+
+                ImGui::PopStyleColor();
             }
-
-            ImGui::PopStyleColor();
         }
+        clipper.End();
 
         if (_auto_scroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
             ImGui::SetScrollHereY(1.0f);
@@ -101,15 +111,80 @@ public:
 
         ImGui::EndChild();
 
+        _pop_imgui_id();
         return Ok();
     }
 
 private:
+    /**
+     * Pull new entries from the log ring and keep the filter index current.
+     * Nothing is copied or re-filtered unless the buffer generation or the
+     * filter settings changed, or the last read stopped at an entry whose
+     * writer had not finished; new entries are filtered incrementally.
+     */
+    void _sync(const LogBuffer& buffer, bool refilter) {
+        uint64_t generation = buffer.generation();
+        // The generation counts claimed slots, so an entry still being
+        // written at the last read does not change it when it completes
+        bool caught_up = _next_sequence >= buffer.head();
+        if (generation == _seen_generation && caught_up && !refilter) return;
+        _seen_generation = generation;
+
+        if (buffer.epoch() != _seen_epoch) {
+            _seen_epoch = buffer.epoch();
+            _cache.clear();
+            _filtered.clear();
+            _cache_base = 0;
+            _next_sequence = 0;
+        }
+
+        size_t first_new = _cache.size();
+        std::vector<LogEntry> fresh;
+        _next_sequence = buffer.read_since(_next_sequence, fresh);
+        for (auto& entry : fresh) {
+            _cache.push_back(std::move(entry));
+        }
+
+        // Trim to the buffer's window, dropping stale filter indices with it
+        while (_cache.size() > buffer.max_size()) {
+            _cache.pop_front();
+            ++_cache_base;
+            if (first_new > 0) --first_new;
+        }
+        while (!_filtered.empty() && _filtered.front() < _cache_base) {
+            _filtered.pop_front();
+        }
+
+        if (refilter) {
+            _filtered.clear();
+            first_new = 0;
+        }
+        for (size_t i = first_new; i < _cache.size(); ++i) {
+            if (_passes(_cache[i])) {
+                _filtered.push_back(_cache_base + i);
+            }
+        }
+    }
+
+    bool _passes(const LogEntry& entry) const {
+        if (static_cast<int>(entry.level) < _min_level) return false;
+        return _text_filter.PassFilter(entry.message.c_str(), entry.message.c_str() + entry.message.size());
+    }
+
     bool _auto_scroll = true;
     bool _show_timestamp = true;
     bool _show_level = true;
     bool _show_source = false;
     int _min_level = 0;
+    ImGuiTextFilter _text_filter;
+
+    // Local copy of the log window plus indices of rows that pass the filter
+    std::deque<LogEntry> _cache;
+    std::deque<uint64_t> _filtered;   // absolute cache positions
+    uint64_t _cache_base = 0;         // absolute position of _cache.front()
+    uint64_t _next_sequence = 0;
+    uint64_t _seen_generation = ~uint64_t{0};
+    uint64_t _seen_epoch = 0;
 };
 
 } // namespace ymery::plugins::debug
@@ -6,6 +6,7 @@
 #include <spdlog/spdlog.h>
 #include <sstream>
 #include <set>
+#include <unordered_map>
 
 namespace ymery::plugins::editor {
 
@@ -41,11 +42,20 @@ public:
 protected:
     Result<void> _pre_render_head() override {
         auto& model = SharedLayoutModel::instance();
-        std::string yaml = _generate_full_yaml(model);
 
-        if (yaml != _last_yaml) {
-            _last_yaml = yaml;
-            _editor.SetText(yaml);
+        // Only regenerate when the layout snapshot or the data entries changed;
+        // comparing the tree pointer is enough since the tree is persistent
+        if (!_yaml_valid || model.tree() != _yaml_tree || model.data_version() != _data_version) {
+            _data_dirty = !_yaml_valid || model.data_version() != _data_version;
+            std::string yaml = _generate_full_yaml(model);
+            _yaml_tree = model.tree();
+            _data_version = model.data_version();
+            _yaml_valid = true;
+
+            if (yaml != _last_yaml) {
+                _last_yaml = std::move(yaml);
+                _editor.SetText(_last_yaml);
+            }
         }
 
         std::string uid = "code_preview";
@@ -61,18 +71,40 @@ private:
     std::string _last_yaml;
     std::set<std::string> _used_types;
 
+    // YAML of body items by node; nodes are immutable, so an entry stays valid
+    // as long as the node is alive - the held pointer keeps it from being reused
+    struct CachedYaml {
+        LayoutTreePtr node;
+        int indent = 0;
+        std::string text;
+    };
+    std::unordered_map<const LayoutTreeNode*, CachedYaml> _node_yaml;
+    std::string _data_yaml;
+    bool _data_dirty = true;
+    LayoutTreePtr _yaml_tree;
+    uint64_t _data_version = 0;
+    bool _yaml_valid = false;
+
     std::string _generate_full_yaml(SharedLayoutModel& model) {
         std::string result;
         _used_types.clear();
 
-        if (!model.empty()) _collect_types(model.root());
+        size_t node_count = 0;
+        if (!model.empty()) _collect_types(model.tree(), node_count);
+        // Drop entries of nodes that are gone once they outnumber the live ones
+        if (_node_yaml.size() > 2 * node_count + 64) _node_yaml.clear();
 
         auto& entries = model.data_entries();
-        if (!entries.empty()) {
-            result += "data:\n";
+        if (_data_dirty) {
+            _data_yaml.clear();
             for (const auto& entry : entries) {
-                result += _data_entry_to_yaml(entry, 1);
+                _data_yaml += _data_entry_to_yaml(entry, 1);
             }
+            _data_dirty = false;
+        }
+        if (!entries.empty()) {
+            result += "data:\n";
+            result += _data_yaml;
             result += "\n";
         }
 
@@ -85,7 +117,7 @@ private:
         if (!model.empty()) {
             result += "\n  # Main widget\n";
             result += "  main-widget:\n";
-            result += _widget_to_yaml(model.root(), 2);
+            result += _widget_to_yaml(*model.tree(), 2);
         }
 
         result += "\napp:\n";
@@ -96,11 +128,10 @@ private:
         return result;
     }
 
-    void _collect_types(const Value& widget) {
-        std::string type = SharedLayoutModel::get_widget_type(widget);
-        if (!type.empty()) _used_types.insert(type);
-        List body = SharedLayoutModel::get_body(widget);
-        for (const auto& child : body) _collect_types(child);
+    void _collect_types(const LayoutTreePtr& node, size_t& count) {
+        ++count;
+        _used_types.insert(node->type());
+        for (const auto& child : node->body()) _collect_types(child, count);
     }
 
     std::string _data_entry_to_yaml(const DataEntry& entry, int indent) {
@@ -131,66 +162,42 @@ private:
         return result;
     }
 
-    std::string _widget_to_yaml(const Value& widget, int indent) {
+    std::string _widget_to_yaml(const LayoutTreeNode& node, int indent) {
         std::string prefix(indent * 2, ' ');
-        std::string result;
-
-        auto dict = get_as<Dict>(widget);
-        if (!dict || dict->empty()) return result;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-
-        result += prefix + "type: " + type + "\n";
-
-        if (props) {
-            for (const auto& [key, val] : *props) {
-                if (key == "uid") continue;
-                if (key == "body") {
-                    auto body = get_as<List>(val);
-                    if (body && !body->empty()) {
-                        result += prefix + "body:\n";
-                        for (const auto& child : *body) {
-                            result += _body_item_to_yaml(child, indent + 1);
-                        }
-                    }
-                } else {
-                    result += prefix + key + ": " + _value_to_string(val) + "\n";
-                }
-            }
-        }
+        std::string result = prefix + "type: " + node.type() + "\n";
+        _props_to_yaml(node, prefix, indent + 1, result);
         return result;
     }
 
-    std::string _body_item_to_yaml(const Value& widget, int indent) {
+    std::string _body_item_to_yaml(const LayoutTreePtr& node, int indent) {
+        auto it = _node_yaml.find(node.get());
+        if (it != _node_yaml.end() && it->second.indent == indent) {
+            return it->second.text;
+        }
+
         std::string prefix(indent * 2, ' ');
-        std::string result;
+        std::string result = prefix + "- " + node->type() + ":\n";
+        _props_to_yaml(*node, prefix + "    ", indent + 2, result);
+        _node_yaml[node.get()] = CachedYaml{node, indent, result};
+        return result;
+    }
 
-        auto dict = get_as<Dict>(widget);
-        if (!dict || dict->empty()) return result;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-
-        result += prefix + "- " + type + ":\n";
-
-        if (props) {
-            for (const auto& [key, val] : *props) {
-                if (key == "uid") continue;
-                if (key == "body") {
-                    auto body = get_as<List>(val);
-                    if (body && !body->empty()) {
-                        result += prefix + "    body:\n";
-                        for (const auto& child : *body) {
-                            result += _body_item_to_yaml(child, indent + 2);
-                        }
-                    }
-                } else {
-                    result += prefix + "    " + key + ": " + _value_to_string(val) + "\n";
-                }
+    // Props in key order with the body list in its "body" key position
+    void _props_to_yaml(const LayoutTreeNode& node, const std::string& prefix, int body_indent, std::string& result) {
+        bool body_done = node.body().empty();
+        auto emit_body = [&] {
+            result += prefix + "body:\n";
+            for (const auto& child : node.body()) {
+                result += _body_item_to_yaml(child, body_indent);
             }
+            body_done = true;
+        };
+        for (const auto& [key, val] : node.props()) {
+            if (key == "uid") continue;
+            if (!body_done && key > "body") emit_body();
+            result += prefix + key + ": " + _value_to_string(val) + "\n";
         }
-        return result;
+        if (!body_done) emit_body();
     }
 
     std::string _value_to_string(const Value& value) {
@@ -183,13 +183,13 @@ private:
                 for (const auto& vt : _value_types) {
                     if (ImGui::MenuItem(vt.name.c_str())) {
                         std::string name = _generate_default_name(vt.name);
-                        SharedLayoutModel::add_child_to_data_entry_recursive(child, vt.name, name);
+                        SharedLayoutModel::instance().add_child_to_data_entry_recursive(child, vt.name, name);
                     }
                 }
                 ImGui::EndMenu();
             }
             if (ImGui::MenuItem("Remove")) {
-                SharedLayoutModel::remove_child_from_data_entry(parent, idx);
+                SharedLayoutModel::instance().remove_child_from_data_entry(parent, idx);
                 ImGui::EndPopup();
                 if (is_open) ImGui::TreePop();
                 return;
@@ -239,21 +239,45 @@ private:
 
     void _render_layout() {
         auto& model = SharedLayoutModel::instance();
+        _render_history_buttons();
+        // Hold the snapshot: edits made from menus below replace the model's tree
+        LayoutTreePtr tree = model.tree();
         _current_path.clear();
-        _render_widget(model.root(), 0);
+        _render_widget(tree, 0);
     }
 
-    void _render_widget(const Value& widget, int depth) {
+    void _render_history_buttons() {
         auto& model = SharedLayoutModel::instance();
 
-        std::string type = SharedLayoutModel::get_widget_type(widget);
-        std::string label = SharedLayoutModel::get_label(widget);
-        std::string uid = SharedLayoutModel::get_uid(widget);
+        ImGui::BeginDisabled(!model.can_undo());
+        if (ImGui::Button("Undo")) model.undo();
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!model.can_redo());
+        if (ImGui::Button("Redo")) model.redo();
+        ImGui::EndDisabled();
+
+        if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && ImGui::GetIO().KeyCtrl) {
+            if (ImGui::IsKeyPressed(ImGuiKey_Z, false)) {
+                if (ImGui::GetIO().KeyShift) model.redo(); else model.undo();
+            } else if (ImGui::IsKeyPressed(ImGuiKey_Y, false)) {
+                model.redo();
+            }
+        }
+        ImGui::Separator();
+    }
+
+    void _render_widget(const LayoutTreePtr& node, int depth) {
+        auto& model = SharedLayoutModel::instance();
+
+        const std::string& type = node->type();
+        std::string label = node->label();
+        std::string uid = node->uid();
         if (label.empty()) label = type;
         if (uid.empty()) uid = "no-uid";
 
         bool is_container = SharedLayoutModel::is_container(type);
-        List body = SharedLayoutModel::get_body(widget);
+        const auto& body = node->body();
 
         ImGui::PushID(uid.c_str());
         if (depth > 0) ImGui::Indent(20.0f);
@@ -285,7 +309,7 @@ private:
         }
 
         if (ImGui::BeginPopup(popup_id.c_str())) {
-            _render_context_menu(widget, type, is_container);
+            _render_context_menu(type, is_container);
             ImGui::EndPopup();
         }
 
@@ -299,7 +323,7 @@ private:
         ImGui::PopID();
     }
 
-    void _render_context_menu(const Value& widget, const std::string& type, bool is_container) {
+    void _render_context_menu(const std::string& type, bool is_container) {
         auto& model = SharedLayoutModel::instance();
 
         ImGui::Text("%s", type.c_str());
@@ -0,0 +1,130 @@
+// Persistent layout tree - immutable widget nodes shared between snapshots
+#pragma once
+
+#include "../../../types.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ymery::plugins {
+
+// Selection path - tracks which node is selected in the tree
+using SelectionPath = std::vector<size_t>;  // indices into body lists
+
+class LayoutTreeNode;
+using LayoutTreePtr = std::shared_ptr<const LayoutTreeNode>;
+using LayoutPropsPtr = std::shared_ptr<const Dict>;
+
+/**
+ * LayoutTreeNode - immutable widget node, {type: {props..., body: [...]}}
+ *
+ * Nodes are never modified. An edit rebuilds only the nodes on the path from
+ * the root to the edited node and shares everything else, so it costs
+ * O(depth) memory and untouched subtrees keep their pointer identity - two
+ * snapshots can be diffed by comparing pointers. Props are shared the same
+ * way, so a node whose props pointer is unchanged has unchanged props.
+ * Nodes are safe to read from any thread.
+ */
+class LayoutTreeNode {
+public:
+    LayoutTreeNode(std::string type, LayoutPropsPtr props, std::vector<LayoutTreePtr> body)
+        : _type(std::move(type))
+        , _props(props ? std::move(props) : std::make_shared<const Dict>())
+        , _body(std::move(body)) {}
+
+    static LayoutTreePtr make(std::string type, Dict props, std::vector<LayoutTreePtr> body = {}) {
+        props.erase("body");
+        return std::make_shared<const LayoutTreeNode>(
+            std::move(type), std::make_shared<const Dict>(std::move(props)), std::move(body));
+    }
+
+    const std::string& type() const { return _type; }
+    const Dict& props() const { return *_props; }
+    const LayoutPropsPtr& props_ptr() const { return _props; }
+    const std::vector<LayoutTreePtr>& body() const { return _body; }
+
+    std::string prop_string(const std::string& key) const {
+        auto it = _props->find(key);
+        if (it == _props->end()) return "";
+        auto s = get_ptr<std::string>(it->second);
+        return s ? *s : "";
+    }
+    std::string uid() const { return prop_string("uid"); }
+    std::string label() const { return prop_string("label"); }
+
+    // Copies with one part replaced; the rest is shared
+    LayoutTreePtr with_type(std::string type) const {
+        return std::make_shared<const LayoutTreeNode>(std::move(type), _props, _body);
+    }
+    LayoutTreePtr with_prop(const std::string& key, const Value& value) const {
+        Dict props = *_props;
+        if (value.has_value()) {
+            props[key] = value;
+        } else {
+            props.erase(key);
+        }
+        return std::make_shared<const LayoutTreeNode>(_type, std::make_shared<const Dict>(std::move(props)), _body);
+    }
+    LayoutTreePtr with_body(std::vector<LayoutTreePtr> body) const {
+        return std::make_shared<const LayoutTreeNode>(_type, _props, std::move(body));
+    }
+
+    // YAML-equivalent Value, built on each call. A Value owns its whole
+    // subtree, so nodes do not keep one: history snapshots would each hold
+    // a full copy of the tree instead of sharing unchanged nodes.
+    Value to_value() const {
+        Dict props = *_props;
+        if (!_body.empty()) {
+            List body;
+            body.reserve(_body.size());
+            for (const auto& child : _body) body.push_back(child->to_value());
+            props["body"] = Value(std::move(body));
+        }
+        Dict widget;
+        widget[_type] = Value(std::move(props));
+        return Value(std::move(widget));
+    }
+
+private:
+    std::string _type;
+    LayoutPropsPtr _props;
+    std::vector<LayoutTreePtr> _body;
+};
+
+// Node at path, or nullptr
+inline LayoutTreePtr layout_tree_at(const LayoutTreePtr& root, const SelectionPath& path) {
+    LayoutTreePtr current = root;
+    for (size_t idx : path) {
+        if (!current || idx >= current->body().size()) return nullptr;
+        current = current->body()[idx];
+    }
+    return current;
+}
+
+/**
+ * Path-copying edit: returns a new root in which the node at `path` is
+ * replaced by edit(node). Siblings and untouched subtrees are shared.
+ * Returns `root` unchanged if the path does not exist.
+ */
+inline LayoutTreePtr layout_tree_update(
+    const LayoutTreePtr& root,
+    const SelectionPath& path,
+    const std::function<LayoutTreePtr(const LayoutTreePtr&)>& edit,
+    size_t depth = 0
+) {
+    if (!root) return root;
+    if (depth == path.size()) return edit(root);
+
+    size_t idx = path[depth];
+    if (idx >= root->body().size()) return root;
+
+    auto child = layout_tree_update(root->body()[idx], path, edit, depth + 1);
+    if (child == root->body()[idx]) return root;
+
+    std::vector<LayoutTreePtr> body = root->body();
+    body[idx] = child;
+    return root->with_body(std::move(body));
+}
+
+} // namespace ymery::plugins
@@ -1,5 +1,6 @@
 #pragma once
 #include "../../../frontend/widget.hpp"
+#include "../../../frontend/composite.hpp"
 #include "shared_model.hpp"
 #include <imgui.h>
 #include <ytrace/ytrace.hpp>
@@ -42,12 +43,9 @@ protected:
 
         uint64_t current_version = model.version();
         if (!_cached_widget || _cached_version != current_version) {
-            ydebug("Preview: model changed (v{} -> v{}), recreating widget", _cached_version, current_version);
-            auto res = _widget_factory->create_widget(_data_bag, model.root(), "app");
-            if (res) {
-                _cached_widget = *res;
+            if (_cached_widget && _apply_changes(model)) {
                 _cached_version = current_version;
-            } else {
+            } else if (auto res = _rebuild(model); !res) {
                 std::string err = error_msg(res);
                 ywarn("Preview: failed to create widget: {}", err);
                 ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Error: %s", err.c_str());
@@ -62,6 +60,65 @@ protected:
     }
 
 private:
+    Result<void> _rebuild(SharedLayoutModel& model) {
+        ydebug("Preview: rebuilding widget tree (v{} -> v{})", _cached_version, model.version());
+        if (_cached_widget) _cached_widget->dispose();
+        _cached_widget = nullptr;
+        auto res = _widget_factory->create_widget(_data_bag, model.root(), "app");
+        if (!res) {
+            return Err<void>("Preview::_rebuild: create_widget failed", res);
+        }
+        _cached_widget = *res;
+        _cached_version = model.version();
+        return Ok();
+    }
+
+    // Patch the live widget tree with the model's change records. Returns
+    // false when a full rebuild is needed (reset, data change, dropped log,
+    // root edit, or a container whose children are not built yet).
+    bool _apply_changes(SharedLayoutModel& model) {
+        auto changes = model.changes_since(_cached_version);
+        if (!changes) return false;
+
+        for (const auto& change : *changes) {
+            if (change.kind == LayoutChangeKind::Reset || change.kind == LayoutChangeKind::Data ||
+                change.path.empty()) {
+                return false;
+            }
+            auto parent = _composite_at(SelectionPath(change.path.begin(), change.path.end() - 1));
+            if (!parent) return false;
+
+            size_t index = change.path.back();
+            Result<void> res = Ok();
+            switch (change.kind) {
+                case LayoutChangeKind::Insert: res = parent->insert_child(index, change.node->to_value()); break;
+                case LayoutChangeKind::Remove: res = parent->remove_child(index); break;
+                case LayoutChangeKind::Update: res = parent->replace_child(index, change.node->to_value()); break;
+                case LayoutChangeKind::Swap:
+                    if (change.other.empty()) return false;
+                    res = parent->swap_children(index, change.other.back());
+                    break;
+                default: return false;
+            }
+            if (!res) {
+                ydebug("Preview: patch failed ({}), rebuilding", error_msg(res));
+                return false;
+            }
+            ydebug("Preview: patched '{}' (v{})", change.uid, change.version);
+        }
+        return true;
+    }
+
+    // Composite for the node at path in the live widget tree
+    std::shared_ptr<Composite> _composite_at(const SelectionPath& path) const {
+        auto composite = std::dynamic_pointer_cast<Composite>(_cached_widget);
+        for (size_t idx : path) {
+            if (!composite) return nullptr;
+            composite = std::dynamic_pointer_cast<Composite>(composite->child(idx));
+        }
+        return composite;
+    }
+
     WidgetPtr _cached_widget;
     uint64_t _cached_version = 0;
 };
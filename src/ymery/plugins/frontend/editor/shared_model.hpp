@@ -1,18 +1,19 @@
 // Shared layout model between editor-canvas and editor-preview
-// Uses YAML-equivalent Value/Dict structure directly
+// The layout is a persistent LayoutTree; root() exposes the YAML-equivalent Value
 #pragma once
 
 #include "../../../types.hpp"
+#include "layout_tree.hpp"
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <deque>
+#include <optional>
 
 namespace ymery::plugins {
 
-// Selection path - tracks which node is selected in the tree
-using SelectionPath = std::vector<size_t>;  // indices into body lists
-
 // Data entry in the data: section
 struct DataEntry {
     std::string name;       // Entry name (e.g., "demo-data", "kernel")
@@ -21,6 +22,33 @@ struct DataEntry {
     std::vector<DataEntry> children;  // Children (for data-tree types)
 };
 
+// Kind of structural change recorded by SharedLayoutModel
+enum class LayoutChangeKind {
+    Reset,   // whole layout replaced - rebuild everything
+    Data,    // data entries or live trees changed
+    Insert,  // node inserted at `path`
+    Remove,  // node at `path` removed
+    Update,  // node at `path` replaced (type, label or data-path changed)
+    Swap     // siblings at `path` and `other` exchanged
+};
+
+// One structural change, so views can patch the affected subtree instead of rebuilding
+struct LayoutChange {
+    LayoutChangeKind kind = LayoutChangeKind::Reset;
+    SelectionPath path;
+    SelectionPath other;   // Swap only
+    std::string uid;       // uid of the affected node (the removed one for Remove)
+    LayoutTreePtr node;    // new node for Insert/Update, shared with the tree
+    uint64_t version = 0;  // model version after the change
+    std::vector<std::string> ancestors;  // uids from the root down to the parent
+};
+
+// Immutable view of the layout at one version - safe to hand to another thread
+struct LayoutSnapshot {
+    LayoutTreePtr tree;
+    uint64_t version = 0;
+};
+
 // Fast PRNG for UID generation (xorshift32)
 inline uint32_t g_uid_state = 0x12345678;
 
@@ -52,154 +80,115 @@ public:
         return inst;
     }
 
-    // The YAML structure - this IS what gets rendered
-    Value& root() { return _root; }
-    const Value& root() const { return _root; }
+    // Current layout tree (nullptr when empty); unchanged subtrees keep their pointers
+    const LayoutTreePtr& tree() const { return _tree; }
 
-    bool empty() const {
-        // Empty if root is not a Dict or has no widget key
-        auto dict = get_as<Dict>(_root);
-        return !dict || dict->empty();
+    // The YAML structure - this IS what gets rendered. Built for the current
+    // tree only, when it is first asked for after a change.
+    const Value& root() const {
+        if (_root_value_tree != _tree) {
+            _root_value = _tree ? _tree->to_value() : Value{};
+            _root_value_tree = _tree;
+        }
+        return _root_value;
     }
 
+    bool empty() const { return !_tree; }
+
     // Version number - increments on each modification
     uint64_t version() const { return _version; }
 
+    // Increments when data entries or live trees change
+    uint64_t data_version() const { return _data_version; }
+
+    LayoutSnapshot snapshot() const { return LayoutSnapshot{_tree, _version}; }
+
+    // Changes made after version `since`, oldest first. Returns nullopt when
+    // some of them have already been dropped from the log - rebuild instead.
+    std::optional<std::vector<LayoutChange>> changes_since(uint64_t since) const {
+        if (since > _version || since < _log_floor) return std::nullopt;
+        std::vector<LayoutChange> changes;
+        for (const auto& change : _changes) {
+            if (change.version > since) changes.push_back(change);
+        }
+        return changes;
+    }
+
     // Selection tracking
     const SelectionPath& selection() const { return _selection; }
     void select(const SelectionPath& path) { _selection = path; }
     void clear_selection() { _selection.clear(); }
 
-    // Get the selected node (returns pointer to the Value, or nullptr)
-    Value* get_selected() {
-        return _navigate(_root, _selection);
+    // Get the selected node (nullptr if nothing valid is selected)
+    LayoutTreePtr get_selected() const {
+        return layout_tree_at(_tree, _selection);
+    }
+
+    // ========== Undo / Redo ==========
+    // History holds whole-tree snapshots; thanks to structural sharing each
+    // one only costs the nodes its edit copied. Data entries are not undone.
+
+    bool can_undo() const { return !_undo.empty(); }
+    bool can_redo() const { return !_redo.empty(); }
+
+    void undo() {
+        if (_undo.empty()) return;
+        _redo.push_back(HistoryEntry{_tree, _selection});
+        _restore(_undo.back());
+        _undo.pop_back();
     }
 
+    void redo() {
+        if (_redo.empty()) return;
+        _undo.push_back(HistoryEntry{_tree, _selection});
+        _restore(_redo.back());
+        _redo.pop_back();
+    }
+
+    // ========== Layout edits ==========
+
     // Set root widget: creates {widget_type: {uid: "type-xxx", label: "widget_type"}}
     void set_root(const std::string& widget_type) {
-        Dict props;
-        props["uid"] = generate_uid(widget_type);
-        props["label"] = widget_type;
-        Dict root;
-        root[widget_type] = Value(props);
-        _root = Value(root);
+        _commit(_make_widget(widget_type));
         _selection.clear();
-        _bump_version();
+        _record(LayoutChangeKind::Reset);
     }
 
     void clear() {
-        _root = Value();
+        _commit(nullptr);
         _selection.clear();
-        _bump_version();
+        _record(LayoutChangeKind::Reset);
     }
 
     // Add child to root widget's body list
     void add_child_to_root(const std::string& widget_type, bool same_line = false) {
-        auto root_dict = get_as<Dict>(_root);
-        if (!root_dict || root_dict->empty()) return;
-
-        // Get root widget type and props
-        std::string root_type = root_dict->begin()->first;
-        auto root_props = get_as<Dict>(root_dict->begin()->second);
-
-        Dict props;
-        if (root_props) {
-            props = *root_props;
-        }
-
-        // Get or create body list
-        List body;
-        auto body_it = props.find("body");
-        if (body_it != props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
-        }
-
-        // If same_line, insert a same-line widget first
-        if (same_line) {
-            Dict sl_props;
-            sl_props["uid"] = generate_uid("same-line");
-            Dict sl_widget;
-            sl_widget["same-line"] = Value(sl_props);
-            body.push_back(Value(sl_widget));
-        }
-
-        // Create new widget: {widget_type: {uid: "...", label: "widget_type"}}
-        Dict new_props;
-        new_props["uid"] = generate_uid(widget_type);
-        new_props["label"] = widget_type;
-        Dict new_widget;
-        new_widget[widget_type] = Value(new_props);
-        body.push_back(Value(new_widget));
-
-        // Rebuild root
-        props["body"] = Value(body);
-        Dict new_root;
-        new_root[root_type] = Value(props);
-        _root = Value(new_root);
-        _bump_version();
+        add_child({}, widget_type, same_line);
     }
 
-    // Add child at a specific path (rebuilds tree)
+    // Add child at a specific path
     void add_child(const SelectionPath& parent_path, const std::string& widget_type, bool same_line = false) {
-        if (parent_path.empty()) {
-            add_child_to_root(widget_type, same_line);
-            return;
-        }
-        // For nested paths, rebuild the whole tree
-        _root = _add_child_recursive(_root, parent_path, 0, widget_type, same_line);
-        _bump_version();
+        auto parent = layout_tree_at(_tree, parent_path);
+        if (!parent) return;
+        size_t pos = parent->body().size();
+        _commit(_insert_children(parent_path, pos, widget_type, same_line));
+        _record_inserted(parent_path, pos, same_line);
     }
 
     // Insert sibling before the node at path
     void insert_before(const SelectionPath& path, const std::string& widget_type, bool same_line = false) {
-        if (path.empty()) {
-            // Root node - wrap in column first
-            wrap_root_in_column();
-            SelectionPath child_path = {0};
-            _root = _insert_sibling_recursive(_root, child_path, 0, widget_type, false, same_line);
-            _bump_version();
-            return;
-        }
-        _root = _insert_sibling_recursive(_root, path, 0, widget_type, false, same_line);
-        _bump_version();
+        _insert_sibling(path, widget_type, false, same_line);
     }
 
     // Insert sibling after the node at path
     void insert_after(const SelectionPath& path, const std::string& widget_type, bool same_line = false) {
-        if (path.empty()) {
-            // Root node - wrap in column first
-            wrap_root_in_column();
-            SelectionPath child_path = {0};
-            _root = _insert_sibling_recursive(_root, child_path, 0, widget_type, true, same_line);
-            _bump_version();
-            return;
-        }
-        _root = _insert_sibling_recursive(_root, path, 0, widget_type, true, same_line);
-        _bump_version();
+        _insert_sibling(path, widget_type, true, same_line);
     }
 
     // Wrap root in a column container
     void wrap_root_in_column() {
         if (empty()) return;
-
-        // Current root becomes a child
-        Value old_root = _root;
-
-        // Create column with old root as child
-        List body;
-        body.push_back(old_root);
-
-        Dict props;
-        props["uid"] = generate_uid("column");
-        props["label"] = std::string("column");
-        props["body"] = Value(body);
-
-        Dict new_root;
-        new_root["column"] = Value(props);
-        _root = Value(new_root);
-        _bump_version();
+        _commit(_wrapped_in_column());
+        _record(LayoutChangeKind::Reset);
     }
 
     // Remove node at path
@@ -208,60 +197,60 @@ public:
             clear();  // Remove root = clear all
             return;
         }
-        _root = _remove_recursive(_root, path, 0);
+        auto removed = layout_tree_at(_tree, path);
+        if (!removed) return;
+        size_t idx = path.back();
+        _commit(layout_tree_update(_tree, _parent_of(path), [idx](const LayoutTreePtr& parent) {
+            auto body = parent->body();
+            body.erase(body.begin() + idx);
+            return parent->with_body(std::move(body));
+        }));
         _selection.clear();
-        _bump_version();
+        _record(LayoutChangeKind::Remove, path, removed->uid());
     }
 
     // Change widget type at path
     void change_type(const SelectionPath& path, const std::string& new_type) {
-        _root = _change_type_recursive(_root, path, 0, new_type);
-        _bump_version();
+        _edit_node(path, [&new_type](const LayoutTreePtr& node) { return node->with_type(new_type); });
     }
 
     // Set label at path
     void set_label_at(const SelectionPath& path, const std::string& label) {
-        _root = _set_label_recursive(_root, path, 0, label);
-        _bump_version();
+        _edit_node(path, [&label](const LayoutTreePtr& node) { return node->with_prop("label", Value(label)); });
     }
 
-    // Set data-path at path
+    // Set data-path at path (empty removes it)
     void set_data_path_at(const SelectionPath& path, const std::string& data_path) {
-        _root = _set_data_path_recursive(_root, path, 0, data_path);
-        _bump_version();
+        _edit_node(path, [&data_path](const LayoutTreePtr& node) {
+            return node->with_prop("data-path", data_path.empty() ? Value() : Value(data_path));
+        });
     }
 
     // Move node up (swap with previous sibling)
     bool can_move_up(const SelectionPath& path) const {
         if (path.empty()) return false;
-        return path.back() > 0;
+        return path.back() > 0 && layout_tree_at(_tree, path) != nullptr;
     }
 
     void move_up(const SelectionPath& path) {
         if (!can_move_up(path)) return;
-        _root = _swap_siblings_recursive(_root, path, 0, -1);
-        // Update selection
         SelectionPath new_sel = path;
         new_sel.back()--;
-        _selection = new_sel;
-        _bump_version();
+        _swap(path, new_sel);
     }
 
     // Move node down (swap with next sibling)
     bool can_move_down(const SelectionPath& path) const {
         if (path.empty()) return false;
-        // Need to check sibling count - use helper
-        return _can_move_down_check(_root, path, 0);
+        auto parent = layout_tree_at(_tree, _parent_of(path));
+        return parent && path.back() + 1 < parent->body().size();
     }
 
     void move_down(const SelectionPath& path) {
         if (!can_move_down(path)) return;
-        _root = _swap_siblings_recursive(_root, path, 0, 1);
-        // Update selection
         SelectionPath new_sel = path;
         new_sel.back()++;
-        _selection = new_sel;
-        _bump_version();
+        _swap(path, new_sel);
     }
 
     // Get widget type from a widget Value
@@ -364,7 +353,7 @@ public:
         entry.name = name;
         entry.type = type;
         _data_entries.push_back(entry);
-        _bump_version();
+        _data_changed();
     }
 
     void remove_data_entry(size_t idx) {
@@ -374,7 +363,7 @@ public:
                 _live_trees.erase(_data_entries[idx].name);
             }
             _data_entries.erase(_data_entries.begin() + idx);
-            _bump_version();
+            _data_changed();
         }
     }
 
@@ -382,7 +371,7 @@ public:
 
     void set_live_tree(const std::string& name, TreeLikePtr tree) {
         _live_trees[name] = tree;
-        _bump_version();
+        _data_changed();
     }
 
     TreeLikePtr get_live_tree(const std::string& name) const {
@@ -416,21 +405,23 @@ public:
             child.name = name;
             child.type = type;
             _data_entries[entry_idx].children.push_back(child);
-            _bump_version();
+            _data_changed();
         }
     }
 
     // Recursively add child to nested entry
-    static void add_child_to_data_entry_recursive(DataEntry& parent, const std::string& type, const std::string& name) {
+    void add_child_to_data_entry_recursive(DataEntry& parent, const std::string& type, const std::string& name) {
         DataEntry child;
         child.name = name;
         child.type = type;
         parent.children.push_back(child);
+        _data_changed();
     }
 
-    static void remove_child_from_data_entry(DataEntry& parent, size_t idx) {
+    void remove_child_from_data_entry(DataEntry& parent, size_t idx) {
         if (idx < parent.children.size()) {
             parent.children.erase(parent.children.begin() + idx);
+            _data_changed();
         }
     }
 
@@ -442,339 +433,218 @@ public:
 private:
     SharedLayoutModel() = default;
 
-    void _bump_version() { ++_version; }
+    static constexpr size_t MAX_CHANGES = 256;
+
+    struct HistoryEntry {
+        LayoutTreePtr tree;
+        SelectionPath selection;
+    };
 
-    Value _root;
+    LayoutTreePtr _tree;
+    mutable Value _root_value;               // root() of _root_value_tree
+    mutable LayoutTreePtr _root_value_tree;
     SelectionPath _selection;
+    std::vector<HistoryEntry> _undo;
+    std::vector<HistoryEntry> _redo;
     std::vector<DataEntry> _data_entries;
     std::map<std::string, TreeLikePtr> _live_trees;
     uint64_t _version = 0;
+    uint64_t _data_version = 0;
 
-    // Navigate to a node by path
-    Value* _navigate(Value& node, const SelectionPath& path) {
-        if (path.empty()) return &node;
-
-        Value* current = &node;
-        for (size_t idx : path) {
-            List body = get_body(*current);
-            if (idx >= body.size()) return nullptr;
-            // Need to navigate into the actual tree, not copies
-            // This is tricky with std::any...
-            // For now, return nullptr - we'll fix navigation later
-        }
-        return current;
-    }
-
-    // Recursively rebuild tree with new child added at path
-    Value _add_child_recursive(const Value& node, const SelectionPath& path, size_t depth, const std::string& widget_type, bool same_line = false) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
-
-        // Get current body
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
-        }
+    std::deque<LayoutChange> _changes;
+    uint64_t _log_floor = 0;  // changes at or below this version were dropped
 
-        if (depth >= path.size()) {
-            // We're at the target - add child here
-            // If same_line, insert a same-line widget first
-            if (same_line) {
-                Dict sl_props;
-                sl_props["uid"] = generate_uid("same-line");
-                Dict sl_widget;
-                sl_widget["same-line"] = Value(sl_props);
-                body.push_back(Value(sl_widget));
-            }
-            Dict child_props;
-            child_props["uid"] = generate_uid(widget_type);
-            child_props["label"] = widget_type;
-            Dict child_widget;
-            child_widget[widget_type] = Value(child_props);
-            body.push_back(Value(child_widget));
-        } else {
-            // Recurse into the child at path[depth]
-            size_t idx = path[depth];
-            if (idx < body.size()) {
-                body[idx] = _add_child_recursive(body[idx], path, depth + 1, widget_type, same_line);
-            }
-        }
+    void _bump_version() { ++_version; }
 
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
+    // Data entries are edited in place, outside the undo history
+    void _data_changed() {
+        ++_data_version;
+        _bump_version();
+        _record(LayoutChangeKind::Data);
     }
 
-    // Insert sibling at path (before or after)
-    Value _insert_sibling_recursive(const Value& node, const SelectionPath& path, size_t depth, const std::string& widget_type, bool after, bool same_line = false) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
+    static LayoutTreePtr _make_widget(const std::string& widget_type) {
+        Dict props;
+        props["uid"] = generate_uid(widget_type);
+        props["label"] = widget_type;
+        return LayoutTreeNode::make(widget_type, std::move(props));
+    }
 
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
+    static SelectionPath _parent_of(const SelectionPath& path) {
+        return SelectionPath(path.begin(), path.end() - 1);
+    }
 
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
-        }
+    // Install a new tree as the result of a user edit (undoable)
+    void _commit(LayoutTreePtr tree) {
+        _undo.push_back(HistoryEntry{_tree, _selection});
+        _redo.clear();
+        _tree = std::move(tree);
+        _bump_version();
+    }
 
-        if (depth == path.size() - 1) {
-            // Insert here
-            size_t idx = path[depth];
-            if (idx <= body.size()) {
-                size_t insert_pos = after ? idx + 1 : idx;
-                if (insert_pos > body.size()) insert_pos = body.size();
-
-                // If same_line, insert a same-line widget first
-                if (same_line) {
-                    Dict sl_props;
-                    sl_props["uid"] = generate_uid("same-line");
-                    Dict sl_widget;
-                    sl_widget["same-line"] = Value(sl_props);
-                    body.insert(body.begin() + insert_pos, Value(sl_widget));
-                    insert_pos++;  // Move insert position after same-line
-                }
+    // Switch to a history entry and describe the difference as change records
+    void _restore(const HistoryEntry& entry) {
+        LayoutTreePtr old_tree = _tree;
+        _tree = entry.tree;
+        _selection = entry.selection;
+        _bump_version();
 
-                Dict child_props;
-                child_props["uid"] = generate_uid(widget_type);
-                child_props["label"] = widget_type;
-                Dict child_widget;
-                child_widget[widget_type] = Value(child_props);
-                body.insert(body.begin() + insert_pos, Value(child_widget));
-            }
-        } else if (depth < path.size() - 1) {
-            size_t idx = path[depth];
-            if (idx < body.size()) {
-                body[idx] = _insert_sibling_recursive(body[idx], path, depth + 1, widget_type, after, same_line);
-            }
+        if (!old_tree || !_tree || old_tree->uid() != _tree->uid()) {
+            _record(LayoutChangeKind::Reset);
+            return;
         }
-
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
+        SelectionPath path;
+        _record_diff(old_tree, _tree, path);
     }
 
-    // Remove node at path
-    Value _remove_recursive(const Value& node, const SelectionPath& path, size_t depth) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
-
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
+    // Pointer-identity diff: shared subtrees are skipped without being visited
+    void _record_diff(const LayoutTreePtr& before, const LayoutTreePtr& after, SelectionPath& path) {
+        if (before == after) return;
+        if (before->type() != after->type() || before->props_ptr() != after->props_ptr()) {
+            _record_node(LayoutChangeKind::Update, path);
+            return;
         }
 
-        if (depth == path.size() - 1) {
-            // Remove here
-            size_t idx = path[depth];
-            if (idx < body.size()) {
-                body.erase(body.begin() + idx);
-            }
-        } else if (depth < path.size() - 1) {
-            size_t idx = path[depth];
-            if (idx < body.size()) {
-                body[idx] = _remove_recursive(body[idx], path, depth + 1);
+        const auto& a = before->body();
+        const auto& b = after->body();
+        if (a.size() == b.size()) {
+            for (size_t i = 0; i < a.size(); ++i) {
+                path.push_back(i);
+                if (a[i]->uid() == b[i]->uid()) {
+                    _record_diff(a[i], b[i], path);
+                } else if (a[i] != b[i]) {
+                    _record_node(LayoutChangeKind::Update, path);
+                }
+                path.pop_back();
             }
+            return;
         }
 
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
-    }
-
-    // Change type at path
-    Value _change_type_recursive(const Value& node, const SelectionPath& path, size_t depth, const std::string& new_type) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
-
-        if (path.empty() || depth >= path.size()) {
-            // Change this node's type
-            Dict new_node;
-            new_node[new_type] = Value(new_props);
-            return Value(new_node);
+        // One or two children added or removed with the rest shared
+        const auto& longer = a.size() > b.size() ? a : b;
+        const auto& shorter = a.size() > b.size() ? b : a;
+        size_t extra = longer.size() - shorter.size();
+        size_t first = 0;
+        while (first < shorter.size() && longer[first] == shorter[first]) ++first;
+        bool contiguous = extra <= 2 && std::equal(shorter.begin() + first, shorter.end(),
+                                                   longer.begin() + first + extra);
+        if (!contiguous) {
+            _record_node(LayoutChangeKind::Update, path);
+            return;
         }
-
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
+        for (size_t k = 0; k < extra; ++k) {
+            if (b.size() > a.size()) {
+                path.push_back(first + k);
+                _record_node(LayoutChangeKind::Insert, path);
+            } else {
+                path.push_back(first);
+                _record(LayoutChangeKind::Remove, path, a[first + k]->uid());
             }
+            path.pop_back();
         }
-
-        size_t idx = path[depth];
-        if (idx < body.size()) {
-            body[idx] = _change_type_recursive(body[idx], path, depth + 1, new_type);
-        }
-
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
     }
 
-    // Set label at path
-    Value _set_label_recursive(const Value& node, const SelectionPath& path, size_t depth, const std::string& label) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
+    LayoutTreePtr _wrapped_in_column() const {
+        Dict props;
+        props["uid"] = generate_uid("column");
+        props["label"] = std::string("column");
+        return LayoutTreeNode::make("column", std::move(props), {_tree});
+    }
 
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
+    LayoutTreePtr _insert_children(const SelectionPath& parent_path, size_t pos,
+                                   const std::string& widget_type, bool same_line) const {
+        return _with_inserted(_tree, parent_path, pos, widget_type, same_line);
+    }
 
-        if (path.empty() || depth >= path.size()) {
-            // Set label on this node
-            new_props["label"] = label;
-            Dict new_node;
-            new_node[type] = Value(new_props);
-            return Value(new_node);
-        }
+    static LayoutTreePtr _with_inserted(const LayoutTreePtr& root, const SelectionPath& parent_path, size_t pos,
+                                        const std::string& widget_type, bool same_line) {
+        return layout_tree_update(root, parent_path, [&](const LayoutTreePtr& parent) {
+            auto body = parent->body();
+            std::vector<LayoutTreePtr> added;
+            // If same_line, insert a same-line widget first
+            if (same_line) added.push_back(_make_widget_without_label("same-line"));
+            added.push_back(_make_widget(widget_type));
+            body.insert(body.begin() + std::min(pos, body.size()), added.begin(), added.end());
+            return parent->with_body(std::move(body));
+        });
+    }
 
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
-        }
+    static LayoutTreePtr _make_widget_without_label(const std::string& widget_type) {
+        Dict props;
+        props["uid"] = generate_uid(widget_type);
+        return LayoutTreeNode::make(widget_type, std::move(props));
+    }
 
-        size_t idx = path[depth];
-        if (idx < body.size()) {
-            body[idx] = _set_label_recursive(body[idx], path, depth + 1, label);
+    void _insert_sibling(const SelectionPath& path, const std::string& widget_type, bool after, bool same_line) {
+        if (path.empty()) {
+            // Root node - wrap in column first, then insert next to the old root
+            if (empty()) return;
+            _commit(_with_inserted(_wrapped_in_column(), {}, after ? 1 : 0, widget_type, same_line));
+            _record(LayoutChangeKind::Reset);
+            return;
         }
-
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
+        auto parent_path = _parent_of(path);
+        auto parent = layout_tree_at(_tree, parent_path);
+        if (!parent || path.back() > parent->body().size()) return;
+        size_t pos = std::min(after ? path.back() + 1 : path.back(), parent->body().size());
+        _commit(_insert_children(parent_path, pos, widget_type, same_line));
+        _record_inserted(parent_path, pos, same_line);
     }
 
-    // Set data-path at path
-    Value _set_data_path_recursive(const Value& node, const SelectionPath& path, size_t depth, const std::string& data_path) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
-
-        if (path.empty() || depth >= path.size()) {
-            // Set data-path on this node
-            if (data_path.empty()) {
-                new_props.erase("data-path");
-            } else {
-                new_props["data-path"] = data_path;
-            }
-            Dict new_node;
-            new_node[type] = Value(new_props);
-            return Value(new_node);
-        }
+    void _edit_node(const SelectionPath& path, const std::function<LayoutTreePtr(const LayoutTreePtr&)>& edit) {
+        if (!layout_tree_at(_tree, path)) return;
+        _commit(layout_tree_update(_tree, path, edit));
+        _record_node(LayoutChangeKind::Update, path);
+    }
 
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
-        }
+    void _swap(const SelectionPath& path, const SelectionPath& other) {
+        size_t a = path.back();
+        size_t b = other.back();
+        _commit(layout_tree_update(_tree, _parent_of(path), [a, b](const LayoutTreePtr& parent) {
+            auto body = parent->body();
+            std::swap(body[a], body[b]);
+            return parent->with_body(std::move(body));
+        }));
+        _selection = other;
+        _record(LayoutChangeKind::Swap, path, "", other);
+    }
 
-        size_t idx = path[depth];
-        if (idx < body.size()) {
-            body[idx] = _set_data_path_recursive(body[idx], path, depth + 1, data_path);
+    // Append a change for the current version, dropping the oldest past MAX_CHANGES
+    void _record(LayoutChangeKind kind, const SelectionPath& path = {}, const std::string& uid = "",
+                 const SelectionPath& other = {}, LayoutTreePtr node = nullptr) {
+        _changes.push_back(LayoutChange{kind, path, other, uid, std::move(node), _version, _ancestor_uids(path)});
+        while (_changes.size() > MAX_CHANGES) {
+            _log_floor = std::max(_log_floor, _changes.front().version);
+            _changes.pop_front();
         }
-
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
     }
 
-    // Swap siblings (direction: -1 = up, +1 = down)
-    Value _swap_siblings_recursive(const Value& node, const SelectionPath& path, size_t depth, int direction) {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return node;
-
-        std::string type = dict->begin()->first;
-        auto props = get_as<Dict>(dict->begin()->second);
-        Dict new_props = props ? *props : Dict{};
-
-        List body;
-        auto body_it = new_props.find("body");
-        if (body_it != new_props.end()) {
-            if (auto existing = get_as<List>(body_it->second)) {
-                body = *existing;
-            }
+    // Insert/Update record carrying the node now at path
+    void _record_node(LayoutChangeKind kind, const SelectionPath& path) {
+        if (auto node = layout_tree_at(_tree, path)) {
+            _record(kind, path, node->uid(), {}, node);
         }
+    }
 
-        if (depth == path.size() - 1) {
-            // Swap here
-            size_t idx = path[depth];
-            size_t other_idx = idx + direction;
-            if (idx < body.size() && other_idx < body.size()) {
-                std::swap(body[idx], body[other_idx]);
-            }
-        } else if (depth < path.size() - 1) {
-            size_t idx = path[depth];
-            if (idx < body.size()) {
-                body[idx] = _swap_siblings_recursive(body[idx], path, depth + 1, direction);
-            }
+    // Children inserted at pos under parent_path (same-line marker first)
+    void _record_inserted(const SelectionPath& parent_path, size_t pos, bool same_line) {
+        SelectionPath child_path = parent_path;
+        child_path.push_back(pos);
+        if (same_line) {
+            _record_node(LayoutChangeKind::Insert, child_path);
+            child_path.back()++;
         }
-
-        new_props["body"] = Value(body);
-        Dict new_node;
-        new_node[type] = Value(new_props);
-        return Value(new_node);
+        _record_node(LayoutChangeKind::Insert, child_path);
     }
 
-    // Check if can move down (has next sibling)
-    bool _can_move_down_check(const Value& node, const SelectionPath& path, size_t depth) const {
-        auto dict = get_as<Dict>(node);
-        if (!dict || dict->empty()) return false;
-
-        auto props = get_as<Dict>(dict->begin()->second);
-        if (!props) return false;
-
-        auto body_it = props->find("body");
-        if (body_it == props->end()) return false;
-
-        auto body = get_as<List>(body_it->second);
-        if (!body) return false;
-
-        if (depth == path.size() - 1) {
-            size_t idx = path[depth];
-            return idx + 1 < body->size();
-        } else if (depth < path.size() - 1) {
-            size_t idx = path[depth];
-            if (idx < body->size()) {
-                return _can_move_down_check((*body)[idx], path, depth + 1);
-            }
+    std::vector<std::string> _ancestor_uids(const SelectionPath& path) const {
+        std::vector<std::string> uids;
+        LayoutTreePtr current = _tree;
+        for (size_t i = 0; i < path.size() && current; ++i) {
+            uids.push_back(current->uid());
+            current = path[i] < current->body().size() ? current->body()[path[i]] : nullptr;
         }
-        return false;
+        return uids;
     }
 };
 
@@ -1159,8 +1159,8 @@ protected:
         }
 
         // Render hex editor
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::BeginHexEditor(imgui_id.c_str(), &_state, size, ImGuiChildFlags_Borders)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::BeginHexEditor(imgui_id, &_state, size, ImGuiChildFlags_Borders)) {
             ImGui::EndHexEditor();
         }
 
@@ -36,9 +36,9 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
+        const char* imgui_id = _imgui_label(label);
         if (ImGui::CoolBarItem()) {
-            if (ImGui::Button(imgui_id.c_str())) {
+            if (ImGui::Button(imgui_id)) {
                 // Button clicked - could dispatch event
             }
         }
@@ -53,8 +53,8 @@ protected:
             }
         }
 
-        std::string imgui_id = "coolbar###" + _uid;
-        _container_open = ImGui::BeginCoolBar(imgui_id.c_str(), flags, config);
+        const char* imgui_id = _imgui_label("coolbar");
+        _container_open = ImGui::BeginCoolBar(imgui_id, flags, config);
         return Ok();
     }
 
@@ -76,8 +76,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGuiKnobs::Knob(imgui_id.c_str(), &_value, _min, _max, 0.0f, "%.3f", knob_variant, size)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGuiKnobs::Knob(imgui_id, &_value, _min, _max, 0.0f, "%.3f", knob_variant, size)) {
             _data_bag->set("value", Value(static_cast<double>(_value)));
         }
         return Ok();
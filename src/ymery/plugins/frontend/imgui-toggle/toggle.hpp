@@ -42,8 +42,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::Toggle(imgui_id.c_str(), &_value)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::Toggle(imgui_id, &_value)) {
             _data_bag->set("value", Value(_value));
         }
 
@@ -28,14 +28,11 @@ public:
 
 protected:
     Result<void> _pre_render_head() override {
-        std::string label = "Button";
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+        if (!_data_bag->read("label", _label)) {
+            _label = "Button";
         }
 
-        bool clicked = ImGui::Button((label + "###" + _uid).c_str());
+        bool clicked = ImGui::Button(_imgui_label(_label));
         if (clicked) {
             _is_body_activated = true;
         }
@@ -52,6 +49,9 @@ protected:
         }
         return Ok();
     }
+
+private:
+    std::string _label;
 };
 
 } // namespace ymery::plugins::imgui
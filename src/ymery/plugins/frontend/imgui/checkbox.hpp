@@ -28,27 +28,20 @@ public:
 
 protected:
     Result<void> _pre_render_head() override {
-        std::string label;
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+        if (!_data_bag->read("label", _label)) {
+            _label.clear();
         }
+        _data_bag->read("value", _checked);
 
-        if (auto res = _data_bag->get("value"); res) {
-            if (auto v = get_as<bool>(*res)) {
-                _checked = *v;
-            }
-        }
-
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::Checkbox(imgui_id.c_str(), &_checked)) {
+        const char* imgui_id = _imgui_label(_label);
+        if (ImGui::Checkbox(imgui_id, &_checked)) {
             _data_bag->set("value", Value(_checked));
         }
         return Ok();
     }
 
 private:
+    std::string _label;
     bool _checked = false;
 };
 
@@ -34,8 +34,8 @@ protected:
                 label = *l;
             }
         }
-        std::string imgui_id = label + "###" + _uid;
-        _container_open = ImGui::CollapsingHeader(imgui_id.c_str());
+        const char* imgui_id = _imgui_label(label);
+        _container_open = ImGui::CollapsingHeader(imgui_id);
         return Ok();
     }
 
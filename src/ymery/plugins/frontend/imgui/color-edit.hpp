@@ -56,8 +56,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::ColorEdit4(imgui_id.c_str(), _color)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::ColorEdit4(imgui_id, _color)) {
             _data_bag->set("r", Value(static_cast<double>(_color[0])));
             _data_bag->set("g", Value(static_cast<double>(_color[1])));
             _data_bag->set("b", Value(static_cast<double>(_color[2])));
@@ -3,7 +3,7 @@
 #include "../../../frontend/widget.hpp"
 #include "../../../frontend/widget_factory.hpp"
 #include <imgui.h>
-#include <vector>
+#include <algorithm>
 
 namespace ymery::plugins::imgui {
 
@@ -29,47 +29,44 @@ public:
 
 protected:
     Result<void> _pre_render_head() override {
-        std::string label;
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+        if (!_data_bag->read("label", _label)) {
+            _label.clear();
         }
+        _data_bag->read("value", _selected);
 
-        if (auto res = _data_bag->get_static("items"); res) {
-            if (auto items_list = get_as<List>(*res)) {
-                _items.clear();
-                for (const auto& item : *items_list) {
-                    if (auto s = get_as<std::string>(item)) {
-                        _items.push_back(*s);
-                    }
-                }
-            }
+        // Items as ImGui's "a\0b\0\0" list, built in the frame arena
+        const List* items = nullptr;
+        if (const Value* items_val = _data_bag->find_static("items")) {
+            items = get_ptr<List>(*items_val);
         }
-
-        if (auto res = _data_bag->get("value"); res) {
-            if (auto v = get_as<int>(*res)) {
-                _selected = *v;
+        size_t size = 1;
+        if (items) {
+            for (const auto& item : *items) {
+                if (auto s = get_ptr<std::string>(item)) size += s->size() + 1;
             }
         }
-
-        std::string items_str;
-        for (const auto& item : _items) {
-            items_str += item;
-            items_str += '\0';
+        auto items_str = _arena().alloc_array<char>(size);
+        char* out = items_str.data();
+        if (items) {
+            for (const auto& item : *items) {
+                if (auto s = get_ptr<std::string>(item)) {
+                    out = std::copy(s->begin(), s->end(), out);
+                    *out++ = '\0';
+                }
+            }
         }
-        items_str += '\0';
+        *out = '\0';
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::Combo(imgui_id.c_str(), &_selected, items_str.c_str())) {
+        const char* imgui_id = _imgui_label(_label);
+        if (ImGui::Combo(imgui_id, &_selected, items_str.data())) {
             _data_bag->set("value", Value(_selected));
         }
         return Ok();
     }
 
 private:
+    std::string _label;
     int _selected = 0;
-    std::vector<std::string> _items;
 };
 
 } // namespace ymery::plugins::imgui
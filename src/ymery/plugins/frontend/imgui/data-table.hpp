@@ -0,0 +1,169 @@
+#pragma once
+#include "../../../frontend/widget.hpp"
+#include "../../../frontend/widget_factory.hpp"
+#include "../../../frontend/table_model.hpp"
+#include <imgui.h>
+#include <memory>
+
+namespace ymery::plugins::imgui {
+
+/**
+ * DataTable - table bound to a data path: one row per child node, one
+ * column per value key. Only visible rows are read (ImGuiListClipper);
+ * sorting and filtering run in the background (see TableModel).
+ *
+ *   imgui.data-table:
+ *     data-path: /items
+ *     columns: [name, {key: level, label: Level}]   # default: first row's keys
+ *     filter: true                                  # show a filter box
+ *     height: 300
+ *     refresh: 1.0                                  # seconds between row list reloads
+ */
+class DataTable : public Widget {
+public:
+    static Result<WidgetPtr> create(
+        std::shared_ptr<WidgetFactory> widget_factory,
+        std::shared_ptr<Dispatcher> dispatcher,
+        const std::string& ns,
+        std::shared_ptr<DataBag> data_bag
+    ) {
+        auto widget = std::make_shared<DataTable>();
+        widget->_widget_factory = widget_factory;
+        widget->_dispatcher = dispatcher;
+        widget->_namespace = ns;
+        widget->_data_bag = data_bag;
+        widget->_filter.resize(128);
+        widget->_filter_id = "Filter##filter" + widget->_uid;
+        if (auto res = widget->init(); !res) {
+            return Err<WidgetPtr>("DataTable::create failed", res);
+        }
+        return widget;
+    }
+
+protected:
+    Result<void> _pre_render_head() override {
+        if (!_model) {
+            if (auto res = _create_model(); !res) {
+                return Err<void>("DataTable: cannot bind data", res);
+            }
+        }
+        _model->update(ImGui::GetTime());
+
+        bool show_filter = false;
+        if (auto res = _data_bag->get_static("filter"); res && res->has_value()) {
+            if (auto f = get_as<bool>(*res)) show_filter = *f;
+        }
+        if (show_filter) {
+            if (ImGui::InputText(_filter_id.c_str(), _filter.data(), _filter.size())) {
+                _model->set_filter(_filter.c_str());
+            }
+        }
+
+        const auto& columns = _model->columns();
+        if (columns.empty()) {
+            ImGui::TextUnformatted(_model->busy() ? "Loading..." : "No rows");
+            return Ok();
+        }
+
+        float height = 300.0f;
+        if (auto res = _data_bag->get_static("height"); res && res->has_value()) {
+            if (auto h = get_as<double>(*res)) height = static_cast<float>(*h);
+            if (auto h = get_as<int>(*res)) height = static_cast<float>(*h);
+        }
+
+        ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable
+                              | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Sortable
+                              | ImGuiTableFlags_SortTristate;
+        std::string label = "##data-table";
+        if (auto res = _data_bag->get("label"); res && res->has_value()) {
+            if (auto l = get_ptr<std::string>(*res)) label = *l;
+        }
+
+        if (!ImGui::BeginTable(_imgui_label(label), static_cast<int>(columns.size()), flags, ImVec2(0.0f, height))) {
+            return Ok();
+        }
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        for (const auto& column : columns) {
+            ImGui::TableSetupColumn(column.label.c_str());
+        }
+        ImGui::TableHeadersRow();
+
+        if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs(); specs && specs->SpecsDirty) {
+            if (specs->SpecsCount > 0) {
+                const auto& spec = specs->Specs[0];
+                _model->set_sort(spec.ColumnIndex, spec.SortDirection == ImGuiSortDirection_Ascending);
+            } else {
+                _model->set_sort(-1, true);
+            }
+            specs->SpecsDirty = false;
+        }
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(_model->row_count()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const auto& cells = _model->row_cells(static_cast<size_t>(row));
+                ImGui::TableNextRow();
+                for (size_t c = 0; c < cells.size(); ++c) {
+                    ImGui::TableSetColumnIndex(static_cast<int>(c));
+                    ImGui::TextUnformatted(cells[c].data(), cells[c].data() + cells[c].size());
+                }
+            }
+        }
+        ImGui::EndTable();
+
+        if (_model->busy()) {
+            ImGui::TextDisabled("Sorting %zu rows...", _model->row_count());
+        }
+        return Ok();
+    }
+
+private:
+    Result<void> _create_model() {
+        auto tree = _data_bag->main_data_tree();
+        if (!tree) {
+            return Err<void>("DataTable: no data tree");
+        }
+        auto path = _data_bag->get_data_path();
+        if (!path) {
+            return Err<void>("DataTable: no data path", path);
+        }
+
+        std::vector<TableModelColumn> columns;
+        if (auto res = _data_bag->get_static("columns"); res && res->has_value()) {
+            if (auto list = get_as<List>(*res)) {
+                for (const auto& item : *list) {
+                    if (auto key = get_as<std::string>(item)) {
+                        columns.push_back({*key, *key});
+                    } else if (auto dict = get_as<Dict>(item)) {
+                        TableModelColumn column;
+                        if (auto it = dict->find("key"); it != dict->end()) {
+                            if (auto k = get_as<std::string>(it->second)) column.key = *k;
+                        }
+                        column.label = column.key;
+                        if (auto it = dict->find("label"); it != dict->end()) {
+                            if (auto l = get_as<std::string>(it->second)) column.label = *l;
+                        }
+                        if (!column.key.empty()) columns.push_back(std::move(column));
+                    }
+                }
+            }
+        }
+
+        double refresh = 1.0;
+        if (auto res = _data_bag->get_static("refresh"); res && res->has_value()) {
+            if (auto r = get_as<double>(*res)) refresh = *r;
+            if (auto r = get_as<int>(*res)) refresh = *r;
+        }
+
+        _model = std::make_unique<TableModel>(tree, *path, std::move(columns), refresh);
+        return Ok();
+    }
+
+    std::unique_ptr<TableModel> _model;
+    std::string _filter;
+    std::string _filter_id;
+};
+
+} // namespace ymery::plugins::imgui
@@ -47,6 +47,7 @@ public:
     }
 
     Result<void> render() override {
+        _rendered = true;
         // Ensure children are created
         if (auto res = _ensure_children(); !res) {
             return res;
@@ -44,6 +44,7 @@ public:
     }
 
     Result<void> render() override {
+        _rendered = true;
         // Ensure children are created
         if (auto res = _ensure_children(); !res) {
             return res;
@@ -165,6 +166,7 @@ private:
 
         for (auto& child : _children) {
             // Check if it's a docking-split by checking the widget type
+            if (!child) continue;
             auto child_bag = child->data_bag();
             if (!child_bag) continue;
 
@@ -60,8 +60,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::DragFloat(imgui_id.c_str(), &_value, speed, min, max)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::DragFloat(imgui_id, &_value, speed, min, max)) {
             _data_bag->set("value", Value(static_cast<double>(_value)));
         }
         return Ok();
@@ -29,6 +29,7 @@ public:
     }
 
     Result<void> render() override {
+        _rendered = true;
         if (auto res = _ensure_children(); !res) {
             return res;
         }
@@ -141,6 +142,7 @@ private:
         _menu_widgets.clear();
 
         for (auto& child : _children) {
+            if (!child) continue;
             auto child_bag = child->data_bag();
             if (!child_bag) continue;
 
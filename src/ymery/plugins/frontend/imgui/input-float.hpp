@@ -48,8 +48,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::InputFloat(imgui_id.c_str(), &_value, step)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::InputFloat(imgui_id, &_value, step)) {
             _data_bag->set("value", Value(static_cast<double>(_value)));
         }
         return Ok();
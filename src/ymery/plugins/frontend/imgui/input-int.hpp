@@ -48,8 +48,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::InputInt(imgui_id.c_str(), &_value, step)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::InputInt(imgui_id, &_value, step)) {
             _data_bag->set("value", Value(_value));
         }
         return Ok();
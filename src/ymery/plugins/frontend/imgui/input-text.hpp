@@ -29,31 +29,28 @@ public:
 
 protected:
     Result<void> _pre_render_head() override {
-        std::string label;
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+        if (!_data_bag->read("label", _label)) {
+            _label.clear();
         }
 
-        if (auto res = _data_bag->get("value"); res) {
-            if (auto v = get_as<std::string>(*res)) {
-                if (_buffer.size() < v->size() + 1) {
-                    _buffer.resize(v->size() + 128);
-                }
-                std::copy(v->begin(), v->end(), _buffer.begin());
-                _buffer[v->size()] = '\0';
+        if (_data_bag->read("value", _text)) {
+            if (_buffer.size() < _text.size() + 1) {
+                _buffer.resize(_text.size() + 128);
             }
+            std::copy(_text.begin(), _text.end(), _buffer.begin());
+            _buffer[_text.size()] = '\0';
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::InputText(imgui_id.c_str(), _buffer.data(), _buffer.size())) {
+        const char* imgui_id = _imgui_label(_label);
+        if (ImGui::InputText(imgui_id, _buffer.data(), _buffer.size())) {
             _data_bag->set("value", Value(std::string(_buffer.c_str())));
         }
         return Ok();
     }
 
 private:
+    std::string _label;
+    std::string _text;    // value as read, copied into the edit buffer
     std::string _buffer;
 };
 
@@ -46,6 +46,7 @@
 #include "table.hpp"
 #include "table-row.hpp"
 #include "table-column.hpp"
+#include "data-table.hpp"
 #include "next-column.hpp"
 #include "imgui-main-window.hpp"
 #include "hello-imgui-main-window.hpp"
@@ -75,7 +76,7 @@ public:
             "popup", "popup-modal", "tooltip", "menu-bar", "menu", "menu-item",
             "color-edit", "color-button", "progress-bar",
             "column", "next-column", "row", "indent", "bullet-text", "separator-text",
-            "main-menu-bar", "table", "table-row", "table-column",
+            "main-menu-bar", "table", "table-row", "table-column", "data-table",
             "imgui-main-window", "hello-imgui-main-window",
             "hello-imgui-menu", "hello-imgui-app-menu-items",
             "docking-main-window", "docking-split", "dockable-window"
@@ -218,6 +219,9 @@ public:
         if (widget_name == "table-column") {
             return imgui::TableColumn::create(widget_factory, dispatcher, ns, data_bag);
         }
+        if (widget_name == "data-table") {
+            return imgui::DataTable::create(widget_factory, dispatcher, ns, data_bag);
+        }
         if (widget_name == "imgui-main-window") {
             return imgui::ImguiMainWindow::create(widget_factory, dispatcher, ns, data_bag);
         }
@@ -51,8 +51,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::MenuItem(imgui_id.c_str(), shortcut_ptr, false, enabled)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::MenuItem(imgui_id, shortcut_ptr, false, enabled)) {
             _is_body_activated = true;
         }
         return Ok();
@@ -42,8 +42,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::RadioButton(imgui_id.c_str(), active)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::RadioButton(imgui_id, active)) {
             _data_bag->set("active", Value(true));
             _is_body_activated = true;
         }
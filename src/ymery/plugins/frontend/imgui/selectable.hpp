@@ -42,8 +42,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::Selectable(imgui_id.c_str(), &selected)) {
+        const char* imgui_id = _imgui_label(label);
+        if (ImGui::Selectable(imgui_id, &selected)) {
             _data_bag->set("selected", Value(selected));
             _is_body_activated = true;
         }
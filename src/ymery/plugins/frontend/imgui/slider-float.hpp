@@ -28,38 +28,32 @@ public:
 
 protected:
     Result<void> _pre_render_head() override {
-        std::string label;
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+        if (!_data_bag->read("label", _label)) {
+            _label.clear();
         }
-
-        if (auto res = _data_bag->get_static("min"); res) {
-            if (auto m = get_as<double>(*res)) {
+        if (const Value* min = _data_bag->find_static("min")) {
+            if (auto m = get_ptr<double>(*min)) {
                 _min = static_cast<float>(*m);
             }
         }
-        if (auto res = _data_bag->get_static("max"); res) {
-            if (auto m = get_as<double>(*res)) {
+        if (const Value* max = _data_bag->find_static("max")) {
+            if (auto m = get_ptr<double>(*max)) {
                 _max = static_cast<float>(*m);
             }
         }
-
-        if (auto res = _data_bag->get("value"); res) {
-            if (auto v = get_as<double>(*res)) {
-                _value = static_cast<float>(*v);
-            }
+        if (double value; _data_bag->read("value", value)) {
+            _value = static_cast<float>(value);
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::SliderFloat(imgui_id.c_str(), &_value, _min, _max)) {
+        const char* imgui_id = _imgui_label(_label);
+        if (ImGui::SliderFloat(imgui_id, &_value, _min, _max)) {
             _data_bag->set("value", Value(static_cast<double>(_value)));
         }
         return Ok();
     }
 
 private:
+    std::string _label;
     float _value = 0.0f;
     float _min = 0.0f;
     float _max = 1.0f;
@@ -28,38 +28,30 @@ public:
 
 protected:
     Result<void> _pre_render_head() override {
-        std::string label;
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+        if (!_data_bag->read("label", _label)) {
+            _label.clear();
         }
-
-        if (auto res = _data_bag->get_static("min"); res) {
-            if (auto m = get_as<int>(*res)) {
+        if (const Value* min = _data_bag->find_static("min")) {
+            if (auto m = get_ptr<int>(*min)) {
                 _min = *m;
             }
         }
-        if (auto res = _data_bag->get_static("max"); res) {
-            if (auto m = get_as<int>(*res)) {
+        if (const Value* max = _data_bag->find_static("max")) {
+            if (auto m = get_ptr<int>(*max)) {
                 _max = *m;
             }
         }
+        _data_bag->read("value", _value);
 
-        if (auto res = _data_bag->get("value"); res) {
-            if (auto v = get_as<int>(*res)) {
-                _value = *v;
-            }
-        }
-
-        std::string imgui_id = label + "###" + _uid;
-        if (ImGui::SliderInt(imgui_id.c_str(), &_value, _min, _max)) {
+        const char* imgui_id = _imgui_label(_label);
+        if (ImGui::SliderInt(imgui_id, &_value, _min, _max)) {
             _data_bag->set("value", Value(_value));
         }
         return Ok();
     }
 
 private:
+    std::string _label;
     int _value = 0;
     int _min = 0;
     int _max = 100;
@@ -27,16 +27,22 @@ public:
     }
 
 protected:
-    Result<void> _pre_render_head() override {
-        std::string label;
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
-            }
+    bool _prepares_data() const override { return true; }
+
+    Result<void> _prepare_head() override {
+        if (!_data_bag->read("label", _label)) {
+            _label.clear();
         }
-        ImGui::TextUnformatted(label.c_str());
         return Ok();
     }
+
+    Result<void> _pre_render_head() override {
+        ImGui::TextUnformatted(_label.data(), _label.data() + _label.size());
+        return Ok();
+    }
+
+private:
+    std::string _label;
 };
 
 } // namespace ymery::plugins::imgui
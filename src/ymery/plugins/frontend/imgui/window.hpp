@@ -28,21 +28,21 @@ public:
 
 protected:
     Result<void> _begin_container() override {
-        std::string title = "Window";
-        if (auto title_res = _data_bag->get_static("title"); title_res) {
-            if (auto t = get_as<std::string>(*title_res)) {
-                title = *t;
+        const char* title = "Window";
+        if (const Value* title_val = _data_bag->find_static("title")) {
+            if (auto t = get_ptr<std::string>(*title_val)) {
+                title = t->c_str();
             }
         }
 
         ImGuiWindowFlags flags = 0;
-        if (auto flags_res = _data_bag->get_static("flags"); flags_res) {
-            if (auto f = get_as<int>(*flags_res)) {
+        if (const Value* flags_val = _data_bag->find_static("flags")) {
+            if (auto f = get_ptr<int>(*flags_val)) {
                 flags = *f;
             }
         }
 
-        _container_open = ImGui::Begin(title.c_str(), &_is_open, flags);
+        _container_open = ImGui::Begin(title, &_is_open, flags);
         return Ok();
     }
 
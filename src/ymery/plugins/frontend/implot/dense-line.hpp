@@ -0,0 +1,204 @@
+#pragma once
+
+#include "../../../frontend/widget.hpp"
+#include "../../../frontend/widget_factory.hpp"
+#include "../../../backend/audio_buffer.hpp"
+#include "../../../backend/audio_envelope.hpp"
+#include <imgui.h>
+#include <implot.h>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace ymery::plugins::implot {
+
+/**
+ * DenseLine - realtime audio trace for many channels at full rate
+ *
+ * Instead of handing every sample to ImPlot::PlotLine, an AudioEnvelope tap
+ * reduces the stream to min/max buckets on the audio thread. Each frame only
+ * the new buckets are copied (EnvelopeHistory), reduced to one min/max bar
+ * per pixel column and written straight into the plot's draw list, so the
+ * vertex count follows the plot width, not the sample rate.
+ *
+ *   implot.dense-line:
+ *     label: ch1
+ *     data-path: /opened/sine/0   # channel node with a 'buffer'
+ *     bucket: 32        # samples per min/max bucket
+ *     history: 10.0     # seconds kept for zooming out
+ *
+ * x is in samples relative to the newest bucket (<= 0), as for implot.line.
+ */
+class DenseLine : public Widget {
+public:
+    static Result<WidgetPtr> create(
+        std::shared_ptr<WidgetFactory> widget_factory,
+        std::shared_ptr<Dispatcher> dispatcher,
+        const std::string& ns,
+        std::shared_ptr<DataBag> data_bag
+    ) {
+        auto widget = std::make_shared<DenseLine>();
+        widget->_widget_factory = widget_factory;
+        widget->_dispatcher = dispatcher;
+        widget->_namespace = ns;
+        widget->_data_bag = data_bag;
+
+        if (auto res = widget->init(); !res) {
+            return Err<WidgetPtr>("DenseLine::create failed", res);
+        }
+        return widget;
+    }
+
+    ~DenseLine() override {
+        _detach();
+    }
+
+protected:
+    Result<void> _pre_render_head() override {
+        auto label_res = _data_bag->get("label");
+        const std::string* label_str = label_res ? get_ptr<std::string>(*label_res) : nullptr;
+        const char* label = label_str ? label_str->c_str() : "Line";
+
+        MediatedAudioBufferPtr buffer;
+        if (auto res = _data_bag->get("buffer"); res) {
+            if (auto buf_ptr = get_as<MediatedAudioBufferPtr>(*res)) buffer = *buf_ptr;
+        }
+        if (!buffer) {
+            return Err("implot.dense-line '" + std::string(label) + "': no 'buffer' audio buffer found");
+        }
+        if (auto res = _attach(buffer); !res) {
+            return Err<void>("implot.dense-line '" + std::string(label) + "': cannot attach", res);
+        }
+
+        _history->pull(*_envelope);
+
+        // Legend entry and color; the bars are drawn by hand below
+        ImPlot::PlotDummy(label);
+        ImU32 color = ImGui::GetColorU32(ImPlot::GetLastItemColor());
+        if (_history->size() == 0) return Ok();
+
+        // Invisible two-point item so auto-fit sees the envelope extents
+        EnvelopeBucket range = _history->value_range();
+        if (range.min <= range.max) {
+            double fit_x[2] = {_history->x_min(), 0.0};
+            double fit_y[2] = {range.min, range.max};
+            ImPlot::SetNextLineStyle(ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
+            ImPlot::PlotLine("##dense-line-fit", fit_x, fit_y, 2);
+        }
+
+        _render(color);
+        return Ok();
+    }
+
+private:
+    // Bars per PrimReserve; keeps each reservation well inside 16-bit indices
+    static constexpr size_t BATCH = 4096;
+
+    void _render(ImU32 color) {
+        ImVec2 pos = ImPlot::GetPlotPos();
+        ImVec2 size = ImPlot::GetPlotSize();
+        auto width = static_cast<size_t>(std::max(0.0f, std::floor(size.x)));
+        if (width == 0) return;
+
+        auto limits = ImPlot::GetPlotLimits();
+        _history->columns(limits.X.Min, limits.X.Max, width, _columns);
+
+        // Join neighbouring columns so a steep edge stays one connected trace
+        _bars.clear();
+        const EnvelopeBucket* prev = nullptr;
+        for (size_t c = 0; c < width; ++c) {
+            const auto& column = _columns[c];
+            if (column.min > column.max) {
+                prev = nullptr;
+                continue;
+            }
+            float lo = column.min;
+            float hi = column.max;
+            if (prev) {
+                lo = std::min(lo, prev->max);
+                hi = std::max(hi, prev->min);
+            }
+            float top = ImPlot::PlotToPixels(0.0, hi).y;
+            float bottom = ImPlot::PlotToPixels(0.0, lo).y;
+            if (bottom - top < 1.0f) bottom = top + 1.0f;
+            float x = pos.x + static_cast<float>(c);
+            _bars.push_back({ImVec2(x, top), ImVec2(x + 1.0f, bottom)});
+            prev = &column;
+        }
+
+        ImDrawList* draw_list = ImPlot::GetPlotDrawList();
+        ImPlot::PushPlotClipRect();
+        for (size_t begin = 0; begin < _bars.size(); begin += BATCH) {
+            size_t count = std::min(BATCH, _bars.size() - begin);
+            draw_list->PrimReserve(static_cast<int>(count * 6), static_cast<int>(count * 4));
+            for (size_t i = begin; i < begin + count; ++i) {
+                draw_list->PrimRect(_bars[i].min, _bars[i].max, color);
+            }
+        }
+        ImPlot::PopPlotClipRect();
+    }
+
+    // (Re)attach the envelope tap when the buffer or settings change
+    Result<void> _attach(const MediatedAudioBufferPtr& buffer) {
+        size_t bucket = 32;
+        if (auto res = _data_bag->get("bucket"); res) {
+            if (auto v = _as_number(*res)) bucket = static_cast<size_t>(std::max(1.0, *v));
+        }
+        double history_seconds = 10.0;
+        if (auto res = _data_bag->get("history"); res) {
+            if (auto v = _as_number(*res)) history_seconds = std::max(0.0, *v);
+        }
+        size_t buckets = std::max<size_t>(
+            1, static_cast<size_t>(history_seconds * buffer->sample_rate() / static_cast<double>(bucket)));
+
+        if (_envelope && _buffer == buffer && _envelope->config().samples_per_bucket == bucket
+            && _history->capacity() == buckets) {
+            return Ok();
+        }
+
+        _detach();
+        // Producer keeps extra buckets so a slow frame does not lose any
+        EnvelopeConfig config;
+        config.samples_per_bucket = bucket;
+        config.buckets = buckets + buckets / 4 + 1;
+        auto res = AudioEnvelope::create(config);
+        if (!res) {
+            return Err<void>("DenseLine: failed to create envelope", res);
+        }
+        _envelope = *res;
+        _history.emplace(buckets, bucket);
+        _buffer = buffer;
+        _buffer->add_tap(_envelope);
+        return Ok();
+    }
+
+    void _detach() {
+        if (_buffer && _envelope) {
+            _buffer->remove_tap(_envelope);
+        }
+        _envelope.reset();
+        _buffer.reset();
+        _history.reset();
+    }
+
+    static std::optional<double> _as_number(const Value& v) {
+        if (auto d = get_as<double>(v)) return d;
+        if (auto i = get_as<int>(v)) return static_cast<double>(*i);
+        if (auto i = get_as<int64_t>(v)) return static_cast<double>(*i);
+        return std::nullopt;
+    }
+
+    struct Bar {
+        ImVec2 min;
+        ImVec2 max;
+    };
+
+    AudioEnvelopePtr _envelope;
+    MediatedAudioBufferPtr _buffer;
+    std::optional<EnvelopeHistory> _history;
+    std::vector<EnvelopeBucket> _columns;
+    std::vector<Bar> _bars;
+};
+
+} // namespace ymery::plugins::implot
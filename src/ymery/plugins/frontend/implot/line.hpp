@@ -3,8 +3,13 @@
 #include "../../../frontend/widget.hpp"
 #include "../../../frontend/widget_factory.hpp"
 #include "../../../backend/audio_buffer.hpp"
+#include "../../../backend/audio_trigger.hpp"
 #include <imgui.h>
 #include <implot.h>
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <vector>
 
 namespace ymery::plugins::implot {
 
@@ -28,60 +33,240 @@ public:
         return widget;
     }
 
+    ~Line() override {
+        _detach_trigger();
+    }
+
 protected:
-    Result<void> _pre_render_head() override {
-        std::string label = "Line";
-        if (auto res = _data_bag->get("label"); res) {
-            if (auto l = get_as<std::string>(*res)) {
-                label = *l;
+    bool _prepares_data() const override { return true; }
+
+    // Prepare phase - resolve the source and copy or convert its data;
+    // no ImGui calls (may run on a worker thread)
+    Result<void> _prepare_head() override {
+        _source = Source::None;
+        _array.reset();
+        _values.clear();
+        _buffer.reset();
+        _trigger_dict.reset();
+
+        auto label_res = _data_bag->get("label");
+        const std::string* label_str = label_res ? get_ptr<std::string>(*label_res) : nullptr;
+        _label = label_str ? *label_str : "Line";
+
+        // Time series column - query only the visible window, decimated to the plot width
+        if (auto res = _data_bag->get("category"); res) {
+            if (auto category = get_ptr<std::string>(*res); category && *category == "timeseries-column") {
+                if (_prepare_timeseries()) return Ok();
             }
         }
 
-        bool has_data = false;
-
-        // Try to get data from "data" property (as a list of values)
+        // Try to get data from "data" property (typed array or list of values)
         if (auto res = _data_bag->get("data"); res) {
-            if (auto list = get_as<List>(*res)) {
-                std::vector<double> values;
-                values.reserve(list->size());
+            if (auto array = get_ptr<NumericArrayPtr>(*res); array && *array) {
+                // Contiguous storage goes to ImPlot as is - no per-frame conversion
+                _array = *array;
+                _source = Source::Array;
+                return Ok();
+            }
+            if (auto list = get_ptr<List>(*res)) {
+                _values.reserve(list->size());
                 for (const auto& item : *list) {
-                    if (auto v = get_as<double>(item)) {
-                        values.push_back(*v);
+                    if (auto v = get_ptr<double>(item)) {
+                        _values.push_back(*v);
                     }
                 }
-                if (!values.empty()) {
-                    ImPlot::PlotLine(label.c_str(), values.data(), static_cast<int>(values.size()));
-                    has_data = true;
+                if (!_values.empty()) {
+                    _source = Source::Values;
+                    return Ok();
                 }
             }
         }
 
         // Try to get buffer from data bag (audio buffer)
-        if (!has_data) {
-            if (auto res = _data_bag->get("buffer"); res) {
-                if (auto buf_ptr = get_as<MediatedAudioBufferPtr>(*res)) {
-                    auto buffer = *buf_ptr;
-                    if (buffer && buffer->try_lock()) {
-                        auto buffer_data = buffer->data();
-                        if (!buffer_data.empty()) {
-                            double xstart = -static_cast<double>(buffer_data.size());
-                            ImPlot::PlotLine(label.c_str(), buffer_data.data(),
-                                             static_cast<int>(buffer_data.size()),
-                                             1.0, xstart);
-                            has_data = true;
-                        }
-                        buffer->unlock();
+        if (auto res = _data_bag->get("buffer"); res) {
+            if (auto buf_ptr = get_as<MediatedAudioBufferPtr>(*res); buf_ptr && *buf_ptr) {
+                auto buffer = *buf_ptr;
+                if (auto trig_res = _data_bag->get("trigger"); trig_res) {
+                    _trigger_dict = get_as<Dict>(*trig_res);
+                }
+                if (_trigger_dict) {
+                    // Oscilloscope mode - the tap is attached and read at submit
+                    _buffer = buffer;
+                    _source = Source::Trigger;
+                    return Ok();
+                }
+                if (buffer->try_lock()) {
+                    _samples = buffer->data();
+                    buffer->unlock();
+                    if (!_samples.empty()) {
+                        _source = Source::Samples;
+                        return Ok();
                     }
                 }
+                // Buffer busy or empty - keep the trigger state, draw nothing this frame
+                _source = Source::Pending;
+                return Ok();
+            }
+        }
+
+        return Err("implot.line '" + _label + "': no data found (expected 'data' array/list or 'buffer' audio buffer)");
+    }
+
+    // Submit phase - ImPlot calls from the prepared state only
+    Result<void> _pre_render_head() override {
+        const char* label = _label.c_str();
+        if (_source != Source::Trigger && _source != Source::Pending) {
+            _detach_trigger();
+        }
+
+        switch (_source) {
+            case Source::None:
+            case Source::Pending:
+                break;
+            case Source::Timeseries:
+                _submit_timeseries(label);
+                break;
+            case Source::Array:
+                _plot_array(label, *_array);
+                break;
+            case Source::Values:
+                ImPlot::PlotLine(label, _values.data(), static_cast<int>(_values.size()));
+                break;
+            case Source::Samples:
+                ImPlot::PlotLine(label, _samples.data(), static_cast<int>(_samples.size()),
+                                 1.0, -static_cast<double>(_samples.size()));
+                break;
+            case Source::Trigger:
+                // Plot the latest trigger frame in place
+                if (auto res = _attach_trigger(_buffer, *_trigger_dict); !res) {
+                    return Err<void>("implot.line '" + _label + "': invalid trigger", res);
+                }
+                if (auto frame = _trigger->latest()) {
+                    double xstart = -static_cast<double>(_trigger->config().pre_samples);
+                    ImPlot::PlotLine(label, frame->samples.data(),
+                                     static_cast<int>(frame->samples.size()),
+                                     1.0, xstart);
+                }
+                break;
+        }
+        return Ok();
+    }
+
+private:
+    enum class Source { None, Pending, Timeseries, Array, Values, Samples, Trigger };
+
+    // Rank 1: y values. Shape [2, n]: x row then y row.
+    static bool _plot_array(const char* label, const NumericArray& array) {
+        switch (array.type()) {
+            case NumericType::F32: return _plot_span(label, array.view<float>(), array.shape());
+            case NumericType::F64: return _plot_span(label, array.view<double>(), array.shape());
+            case NumericType::I32: return _plot_span(label, array.view<int32_t>(), array.shape());
+        }
+        return false;
+    }
+
+    template<typename T>
+    static bool _plot_span(const char* label, std::span<const T> values, const std::vector<size_t>& shape) {
+        if (values.empty()) return false;
+        if (shape.size() == 2 && shape[0] == 2) {
+            size_t n = shape[1];
+            ImPlot::PlotLine(label, values.data(), values.data() + n, static_cast<int>(n));
+        } else {
+            ImPlot::PlotLine(label, values.data(), static_cast<int>(values.size()));
+        }
+        return true;
+    }
+
+    // The first frame fetches the whole series so ImPlot can fit the axes;
+    // afterwards the window is the x-axis limits seen at the previous submit
+    bool _prepare_timeseries() {
+        double t0 = _window_t0;
+        double t1 = _window_t1;
+        if (!_timeseries_fitted) {
+            auto tmin = _data_bag->get("t-min");
+            auto tmax = _data_bag->get("t-max");
+            const double* lo = tmin ? get_ptr<double>(*tmin) : nullptr;
+            const double* hi = tmax ? get_ptr<double>(*tmax) : nullptr;
+            if (!lo || !hi) {
+                _source = Source::Timeseries;  // no rows yet
+                return true;
             }
+            t0 = *lo;
+            t1 = *hi;
         }
 
-        if (!has_data) {
-            return Err("implot.line '" + label + "': no data found (expected 'data' list or 'buffer' audio buffer)");
+        char key[96];
+        std::snprintf(key, sizeof(key), "decimated:%.17g:%.17g:%d", t0, t1, _window_points);
+
+        auto res = _data_bag->get(key);
+        if (!res) return false;
+        auto array = get_ptr<NumericArrayPtr>(*res);
+        if (!array || !*array) return false;
+        _array = *array;
+        _source = Source::Timeseries;
+        return true;
+    }
+
+    void _submit_timeseries(const char* label) {
+        if (_array) {
+            _timeseries_fitted = true;
+            if (_array->size() > 0) _plot_array(label, *_array);
+        }
+        // Window for the next prepare; two points (min and max) per pixel column
+        _window_points = std::max(2, static_cast<int>(ImPlot::GetPlotSize().x) * 2);
+        if (_timeseries_fitted) {
+            auto limits = ImPlot::GetPlotLimits();
+            _window_t0 = limits.X.Min;
+            _window_t1 = limits.X.Max;
+        }
+    }
+
+    // (Re)attach a trigger tap when the buffer or trigger settings change
+    Result<void> _attach_trigger(const MediatedAudioBufferPtr& buffer, const Dict& trigger_dict) {
+        auto config_res = TriggerConfig::from_dict(trigger_dict);
+        if (!config_res) {
+            return Err<void>("Line: bad trigger config", config_res);
+        }
+        if (_trigger && _trigger_buffer == buffer && _trigger->config() == *config_res) {
+            return Ok();
         }
 
+        _detach_trigger();
+        auto trigger_res = AudioTrigger::create(*config_res);
+        if (!trigger_res) {
+            return Err<void>("Line: failed to create trigger", trigger_res);
+        }
+        _trigger = *trigger_res;
+        _trigger_buffer = buffer;
+        _trigger_buffer->add_tap(_trigger);
         return Ok();
     }
+
+    void _detach_trigger() {
+        if (_trigger_buffer && _trigger) {
+            _trigger_buffer->remove_tap(_trigger);
+        }
+        _trigger.reset();
+        _trigger_buffer.reset();
+    }
+
+    AudioTriggerPtr _trigger;
+    MediatedAudioBufferPtr _trigger_buffer;
+
+    // Time series window, updated at submit
+    bool _timeseries_fitted = false;
+    double _window_t0 = 0.0;
+    double _window_t1 = 0.0;
+    int _window_points = 2048;  // until the plot width is known
+
+    // Prepared state
+    Source _source = Source::None;
+    std::string _label;
+    NumericArrayPtr _array;
+    std::vector<double> _values;
+    std::vector<float> _samples;
+    MediatedAudioBufferPtr _buffer;
+    std::optional<Dict> _trigger_dict;
 };
 
 } // namespace ymery::plugins::implot
@@ -7,6 +7,7 @@
 #include "plot.hpp"
 #include "subplots.hpp"
 #include "line.hpp"
+#include "dense-line.hpp"
 
 namespace ymery::plugins {
 
@@ -18,7 +19,8 @@ public:
         return {
             "plot",
             "subplots",
-            "line"
+            "line",
+            "dense-line"
         };
     }
 
@@ -38,6 +40,9 @@ public:
         if (widget_name == "line") {
             return implot::Line::create(widget_factory, dispatcher, ns, data_bag);
         }
+        if (widget_name == "dense-line") {
+            return implot::DenseLine::create(widget_factory, dispatcher, ns, data_bag);
+        }
         return Err<WidgetPtr>("Unknown widget: " + widget_name);
     }
 };
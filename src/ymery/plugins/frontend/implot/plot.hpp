@@ -48,8 +48,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        _container_open = ImPlot::BeginPlot(imgui_id.c_str(), size);
+        const char* imgui_id = _imgui_label(label);
+        _container_open = ImPlot::BeginPlot(imgui_id, size);
         return Ok();
     }
 
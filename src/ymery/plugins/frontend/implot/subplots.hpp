@@ -58,8 +58,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        _container_open = ImPlot::BeginSubplots(imgui_id.c_str(), rows, cols, size);
+        const char* imgui_id = _imgui_label(label);
+        _container_open = ImPlot::BeginSubplots(imgui_id, rows, cols, size);
         return Ok();
     }
 
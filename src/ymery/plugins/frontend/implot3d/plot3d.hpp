@@ -58,8 +58,8 @@ protected:
             }
         }
 
-        std::string imgui_id = label + "###" + _uid;
-        _container_open = ImPlot3D::BeginPlot(imgui_id.c_str(), size);
+        const char* imgui_id = _imgui_label(label);
+        _container_open = ImPlot3D::BeginPlot(imgui_id, size);
         return Ok();
     }
 
@@ -1,9 +1,97 @@
 #include "types.hpp"
 #include <sstream>
 #include <algorithm>
+#include <functional>
+#include <numeric>
 
 namespace ymery {
 
+Result<NumericArrayPtr> NumericArray::from_list(const List& list, NumericType type) {
+    std::vector<double> values;
+    values.reserve(list.size());
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (auto d = get_ptr<double>(list[i])) {
+            values.push_back(*d);
+        } else if (auto n = get_ptr<int>(list[i])) {
+            values.push_back(static_cast<double>(*n));
+        } else if (auto f = get_ptr<float>(list[i])) {
+            values.push_back(static_cast<double>(*f));
+        } else {
+            return Err<NumericArrayPtr>("NumericArray::from_list: element " + std::to_string(i) + " is not a number");
+        }
+    }
+
+    switch (type) {
+        case NumericType::F32:
+            return create(std::vector<float>(values.begin(), values.end()));
+        case NumericType::I32: {
+            std::vector<int32_t> ints(values.size());
+            std::transform(values.begin(), values.end(), ints.begin(),
+                           [](double v) { return static_cast<int32_t>(v); });
+            return create(std::move(ints));
+        }
+        case NumericType::F64:
+            break;
+    }
+    return create(std::move(values));
+}
+
+std::optional<NumericType> NumericArray::parse_type(std::string_view name) {
+    if (name == "f32") return NumericType::F32;
+    if (name == "f64") return NumericType::F64;
+    if (name == "i32") return NumericType::I32;
+    return std::nullopt;
+}
+
+const char* NumericArray::type_name(NumericType type) {
+    switch (type) {
+        case NumericType::F32: return "f32";
+        case NumericType::F64: return "f64";
+        case NumericType::I32: return "i32";
+    }
+    return "?";
+}
+
+size_t NumericArray::size() const {
+    return std::visit([](const auto& v) { return v.size(); }, _data);
+}
+
+double NumericArray::at(size_t index) const {
+    return std::visit([index](const auto& v) { return static_cast<double>(v[index]); }, _data);
+}
+
+List NumericArray::to_list() const {
+    List list;
+    list.reserve(size());
+    std::visit([&list](const auto& v) {
+        for (auto x : v) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int32_t>) {
+                list.push_back(Value(static_cast<int>(x)));
+            } else {
+                list.push_back(Value(static_cast<double>(x)));
+            }
+        }
+    }, _data);
+    return list;
+}
+
+Result<void> NumericArray::_check_shape() const {
+    size_t expected = std::accumulate(_shape.begin(), _shape.end(), size_t{1}, std::multiplies<size_t>());
+    if (expected != size()) {
+        return Err<void>("NumericArray: shape holds " + std::to_string(expected) +
+                         " elements, data has " + std::to_string(size()));
+    }
+    return Ok();
+}
+
+NumericArrayPtr as_numeric_array(const Value& v) {
+    if (auto array = get_ptr<NumericArrayPtr>(v)) return *array;
+    if (auto list = get_ptr<List>(v)) {
+        if (auto res = NumericArray::from_list(*list)) return *res;
+    }
+    return nullptr;
+}
+
 DataPath::DataPath(const std::string& path) {
     *this = parse(path);
 }
@@ -110,4 +198,40 @@ DataPath DataPath::parse(const std::string& path_str) {
     return result;
 }
 
+const std::vector<Value>* ChildrenMetadata::column(std::string_view key) const {
+    for (size_t k = 0; k < keys.size(); ++k) {
+        if (keys[k] == key) return &columns[k];
+    }
+    return nullptr;
+}
+
+void ChildrenMetadata::reserve(size_t count) {
+    names.reserve(count);
+    for (auto& column : columns) column.reserve(count);
+}
+
+void ChildrenMetadata::append(std::string name, const Dict& metadata) {
+    names.push_back(std::move(name));
+    for (size_t k = 0; k < keys.size(); ++k) {
+        auto it = metadata.find(keys[k]);
+        columns[k].push_back(it != metadata.end() ? it->second : Value{});
+    }
+}
+
+Result<ChildrenMetadata> TreeLike::get_children_metadata(const DataPath& path,
+                                                         const std::vector<std::string>& keys) {
+    auto names = get_children_names(path);
+    if (!names) {
+        return Err<ChildrenMetadata>("TreeLike::get_children_metadata: get_children_names failed", names);
+    }
+    ChildrenMetadata result(keys);
+    result.reserve(names->size());
+    for (auto& name : *names) {
+        // A child whose metadata fails still gets its row, with empty values
+        auto meta = get_metadata(path / name);
+        result.append(std::move(name), meta ? *meta : Dict{});
+    }
+    return Ok(std::move(result));
+}
+
 } // namespace ymery
@@ -7,6 +7,12 @@
 #include <any>
 #include <optional>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <cstdint>
 
 namespace ymery {
 
@@ -28,6 +34,77 @@ std::optional<T> get_as(const Value& v) {
     }
 }
 
+// Borrow the value held in std::any without copying it (nullptr on type mismatch)
+template<typename T>
+const T* get_ptr(const Value& v) {
+    return std::any_cast<T>(&v);
+}
+
+// Element type of a NumericArray
+enum class NumericType { F32, F64, I32 };
+
+/**
+ * NumericArray - contiguous typed numeric data with a shape
+ *
+ * Carried in a Value as NumericArrayPtr, so passing one through a data tree
+ * or DataBag::get copies a pointer, not the elements. Shared arrays are
+ * immutable; build a new one to change the data.
+ */
+class NumericArray {
+public:
+    // Shape defaults to one dimension of data.size(); otherwise its product must match
+    template<typename T>
+    static Result<std::shared_ptr<const NumericArray>> create(std::vector<T> data, std::vector<size_t> shape = {}) {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, int32_t>,
+                      "NumericArray holds f32, f64 or i32");
+        auto array = std::shared_ptr<NumericArray>(new NumericArray());
+        if (shape.empty()) shape.push_back(data.size());
+        array->_shape = std::move(shape);
+        array->_data = std::move(data);
+        if (auto res = array->_check_shape(); !res) {
+            return Err<std::shared_ptr<const NumericArray>>("NumericArray::create failed", res);
+        }
+        return std::shared_ptr<const NumericArray>(std::move(array));
+    }
+
+    // Convert a List of int/double/float values; fails on any other element
+    static Result<std::shared_ptr<const NumericArray>> from_list(const List& list, NumericType type = NumericType::F64);
+
+    // "f32" / "f64" / "i32"
+    static std::optional<NumericType> parse_type(std::string_view name);
+    static const char* type_name(NumericType type);
+
+    NumericType type() const { return static_cast<NumericType>(_data.index()); }
+    const std::vector<size_t>& shape() const { return _shape; }
+    size_t size() const;
+
+    // Elements as T; empty if the array holds another type
+    template<typename T>
+    std::span<const T> view() const {
+        if (auto v = std::get_if<std::vector<T>>(&_data)) return {v->data(), v->size()};
+        return {};
+    }
+
+    // Element converted to double, whatever the storage type
+    double at(size_t index) const;
+
+    List to_list() const;
+
+private:
+    NumericArray() = default;
+    Result<void> _check_shape() const;
+
+    // Alternative order matches NumericType
+    std::variant<std::vector<float>, std::vector<double>, std::vector<int32_t>> _data;
+    std::vector<size_t> _shape;
+};
+
+using NumericArrayPtr = std::shared_ptr<const NumericArray>;
+
+// Numeric array held by a Value, converting a numeric List if needed
+// (the conversion allocates - producers should store NumericArrayPtr)
+NumericArrayPtr as_numeric_array(const Value& v);
+
 // DataPath - hierarchical path for navigating data
 class DataPath {
 public:
@@ -68,6 +145,36 @@ private:
     bool is_absolute_ = false;
 };
 
+/**
+ * ChildrenMetadata - the children of a node with selected metadata keys,
+ * stored by column: columns[k][i] is keys[k] of child names[i], an empty
+ * Value when that child has no such key. A caller listing a node gets
+ * names and labels from one call instead of a get_metadata per child.
+ *
+ * API only so far: the built-in widgets still list with get_children_names.
+ * foreach-child children read their values through their own data bags,
+ * and the data table reads cells for the visible rows only, so neither
+ * would use a whole-listing fetch.
+ */
+struct ChildrenMetadata {
+    ChildrenMetadata() = default;
+    explicit ChildrenMetadata(std::vector<std::string> keys)
+        : keys(std::move(keys)), columns(this->keys.size()) {}
+
+    std::vector<std::string> names;
+    std::vector<std::string> keys;
+    std::vector<std::vector<Value>> columns;
+
+    size_t size() const { return names.size(); }
+    const Value& at(size_t child, size_t key) const { return columns[key][child]; }
+    // Column of `key`, or nullptr when it was not asked for
+    const std::vector<Value>* column(std::string_view key) const;
+
+    void reserve(size_t count);
+    // Append a child, picking the asked-for keys out of its metadata
+    void append(std::string name, const Dict& metadata);
+};
+
 // TreeLike - abstract interface for hierarchical data access
 class TreeLike {
 public:
@@ -80,6 +187,12 @@ public:
     virtual Result<Dict> get_metadata(const DataPath& path) = 0;
     virtual Result<std::vector<std::string>> get_metadata_keys(const DataPath& path) = 0;
 
+    // Children of path with the given metadata keys in one call. The default
+    // asks get_children_names, then get_metadata per child; providers that
+    // can answer from one pass over their storage override it.
+    virtual Result<ChildrenMetadata> get_children_metadata(const DataPath& path,
+                                                           const std::vector<std::string>& keys);
+
     // Value access (path's last component is the key)
     virtual Result<Value> get(const DataPath& path) = 0;
     virtual Result<void> set(const DataPath& path, const Value& value) = 0;
@@ -90,9 +203,23 @@ public:
     // Debug
     virtual Result<std::string> as_tree(const DataPath& path, int depth = -1) = 0;
 
+    // Tree that answers path when this one only passes it on (the kernel's
+    // provider branch), with the path inside it; nullptr when this tree
+    // answers path itself. Lets a long call lock the target instead of this.
+    virtual Result<std::pair<std::shared_ptr<TreeLike>, DataPath>> forwarding_target(const DataPath& path) {
+        return Ok(std::make_pair(std::shared_ptr<TreeLike>{}, path));
+    }
+
     // Lifecycle
     virtual Result<void> init() { return Ok(); }
     virtual Result<void> dispose() { return Ok(); }
+
+    // Implementations are not thread-safe; DataBag holds this around every
+    // call so widgets can be prepared on several threads (FramePreparer)
+    std::mutex& access_mutex() const { return _access_mutex; }
+
+private:
+    mutable std::mutex _access_mutex;
 };
 
 // Shared pointer for TreeLike
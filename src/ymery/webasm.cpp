@@ -161,6 +161,9 @@ Result<void> WebApp::frame() {
         return Err<void>("WebApp::frame: _begin_frame failed", begin_res);
     }
 
+    // Scratch memory handed out during the previous frame is no longer referenced
+    frame_arena().reset();
+
     // Render root widget
     if (_root_widget) {
         if (auto render_res = _root_widget->render(); !render_res) {
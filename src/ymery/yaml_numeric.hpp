@@ -0,0 +1,200 @@
+#pragma once
+
+#include "types.hpp"
+#include <yaml-cpp/yaml.h>
+#include <charconv>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace ymery {
+
+// Typed numeric arrays in YAML, tagged with the element type:
+//   samples: !f32 [0.1, 0.2, 0.3]
+//   ramp: !i32 "0 1 2 3 4"                          (bulk: one scalar, parsed with from_chars)
+//   image: !f64 {shape: [2, 3], data: [1, 2, 3, 4, 5, 6]}
+
+namespace yaml_numeric_detail {
+
+template<typename T>
+bool parse_number(std::string_view text, T& out) {
+    if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+template<typename T>
+bool parse_elements(const YAML::Node& data, std::vector<T>& out) {
+    T value{};
+    if (data.IsSequence()) {
+        out.reserve(data.size());
+        for (const auto& item : data) {
+            if (!item.IsScalar() || !parse_number(std::string_view(item.Scalar()), value)) return false;
+            out.push_back(value);
+        }
+        return true;
+    }
+    if (data.IsScalar()) {
+        std::string_view text(data.Scalar());
+        auto is_separator = [](char c) { return c == ' ' || c == ',' || c == '\n' || c == '\t' || c == '\r'; };
+        size_t pos = 0;
+        while (pos < text.size()) {
+            while (pos < text.size() && is_separator(text[pos])) ++pos;
+            size_t end = pos;
+            while (end < text.size() && !is_separator(text[end])) ++end;
+            if (end > pos) {
+                if (!parse_number(text.substr(pos, end - pos), value)) return false;
+                out.push_back(value);
+            }
+            pos = end;
+        }
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+NumericArrayPtr make_array(const YAML::Node& data, std::vector<size_t> shape) {
+    std::vector<T> values;
+    if (!parse_elements(data, values)) return nullptr;
+    auto res = NumericArray::create(std::move(values), std::move(shape));
+    return res ? *res : nullptr;
+}
+
+} // namespace yaml_numeric_detail
+
+// Array from a node tagged !f32 / !f64 / !i32; nullptr if untagged or malformed
+inline NumericArrayPtr yaml_to_numeric_array(const YAML::Node& node) {
+    const std::string& tag = node.Tag();
+    if (tag.size() != 4 || tag[0] != '!') return nullptr;
+    auto type = NumericArray::parse_type(std::string_view(tag).substr(1));
+    if (!type) return nullptr;
+
+    std::vector<size_t> shape;
+    if (node.IsMap()) {
+        const YAML::Node shape_node = node["shape"];
+        if (shape_node.IsSequence()) {
+            for (const auto& dim : shape_node) {
+                size_t n = 0;
+                if (!yaml_numeric_detail::parse_number(std::string_view(dim.Scalar()), n)) return nullptr;
+                shape.push_back(n);
+            }
+        }
+    }
+    // YAML::Node assignment writes through to the referenced node, so bind once
+    const YAML::Node data = node.IsMap() ? node["data"] : node;
+    if (!data.IsDefined()) return nullptr;
+
+    using namespace yaml_numeric_detail;
+    switch (*type) {
+        case NumericType::F32: return make_array<float>(data, std::move(shape));
+        case NumericType::F64: return make_array<double>(data, std::move(shape));
+        case NumericType::I32: return make_array<int32_t>(data, std::move(shape));
+    }
+    return nullptr;
+}
+
+// Inverse of yaml_to_numeric_array - tagged flow sequence, or {shape, data} map for rank > 1
+inline YAML::Node numeric_array_to_yaml(const NumericArray& array) {
+    YAML::Node data(YAML::NodeType::Sequence);
+    data.SetStyle(YAML::EmitterStyle::Flow);
+    for (size_t i = 0; i < array.size(); ++i) {
+        if (array.type() == NumericType::I32) {
+            data.push_back(static_cast<int32_t>(array.at(i)));
+        } else {
+            data.push_back(array.at(i));
+        }
+    }
+
+    std::string tag = std::string("!") + NumericArray::type_name(array.type());
+    if (array.shape().size() <= 1) {
+        data.SetTag(tag);
+        return data;
+    }
+    YAML::Node shaped(YAML::NodeType::Map);
+    YAML::Node shape(YAML::NodeType::Sequence);
+    shape.SetStyle(YAML::EmitterStyle::Flow);
+    for (size_t dim : array.shape()) shape.push_back(dim);
+    shaped["shape"] = shape;
+    shaped["data"] = data;
+    shaped.SetTag(tag);
+    return shaped;
+}
+
+/**
+ * NumericArrayCache - typed arrays of a YAML-backed tree, by full metadata
+ * path ("/node/key")
+ *
+ * Arrays read from tagged YAML are converted once and kept here. Arrays set
+ * from code are kept here only, so setting a large array every frame costs a
+ * pointer copy; they are written back to YAML with numeric_array_to_yaml
+ * when the tree is serialized (sync).
+ */
+class NumericArrayCache {
+public:
+    bool empty() const { return _arrays.empty(); }
+
+    NumericArrayPtr find(const std::string& path) const {
+        auto it = _arrays.find(path);
+        return it == _arrays.end() ? nullptr : it->second;
+    }
+
+    // Converted from YAML: the YAML already holds it
+    void cache(const std::string& path, NumericArrayPtr array) {
+        _arrays[path] = std::move(array);
+    }
+
+    // Set from code: written to YAML on the next sync
+    void store(const std::string& path, NumericArrayPtr array) {
+        _arrays[path] = std::move(array);
+        _unsynced.insert(path);
+    }
+
+    void erase(const std::string& path) {
+        _arrays.erase(path);
+        _unsynced.erase(path);
+    }
+
+    // Drop everything under a node ("/node"), e.g. when it is replaced
+    void erase_under(const std::string& node_path) {
+        std::string prefix = node_path + "/";
+        for (auto it = _arrays.lower_bound(prefix); it != _arrays.end() && it->first.starts_with(prefix);) {
+            _unsynced.erase(it->first);
+            it = _arrays.erase(it);
+        }
+    }
+
+    // Put the arrays held for a node's own keys into its metadata
+    void overlay(const std::string& node_path, Dict& metadata) const {
+        std::string prefix = node_path.empty() || node_path == "/" ? node_path : node_path + "/";
+        for (auto it = _arrays.lower_bound(prefix); it != _arrays.end() && it->first.starts_with(prefix); ++it) {
+            std::string_view key = std::string_view(it->first).substr(prefix.size());
+            if (!key.empty() && key.find('/') == std::string_view::npos) {
+                metadata[std::string(key)] = Value(it->second);
+            }
+        }
+    }
+
+    // Write the arrays set since the last sync into YAML. metadata_of(node_path)
+    // returns the node's metadata map, or an undefined node if it is gone.
+    template<typename F>
+    void sync(F&& metadata_of) {
+        for (const auto& path : _unsynced) {
+            auto slash = path.rfind('/');
+            std::string node_path = slash == std::string::npos ? std::string()
+                                  : slash == 0 ? std::string("/") : path.substr(0, slash);
+            YAML::Node metadata = metadata_of(node_path);
+            if (metadata.IsDefined() && metadata.IsMap()) {
+                metadata[path.substr(slash == std::string::npos ? 0 : slash + 1)] = numeric_array_to_yaml(*_arrays.at(path));
+            }
+        }
+        _unsynced.clear();
+    }
+
+private:
+    std::map<std::string, NumericArrayPtr> _arrays;
+    std::set<std::string> _unsynced;
+};
+
+} // namespace ymery
@@ -0,0 +1,338 @@
+// Async tree tests (cached reads, pending errors, stale flag, queued writes, concurrency limit, eviction, busy provider)
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/async_tree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace boost::ut;
+using namespace ymery;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Every call sleeps for `delay`, and waits while the gate is closed;
+// children of /items are "i<n>" with a "label"
+class SlowTree : public TreeLike {
+public:
+    explicit SlowTree(std::chrono::milliseconds delay, size_t items = 3) : _delay(delay), _items(items) {}
+
+    void close_gate() {
+        std::lock_guard lock(_gate_mutex);
+        _open = false;
+    }
+    void open_gate() {
+        std::lock_guard lock(_gate_mutex);
+        _open = true;
+        _gate.notify_all();
+    }
+    // Wait (bounded) until a call is held at the closed gate
+    bool wait_held() {
+        std::unique_lock lock(_gate_mutex);
+        return _gate.wait_for(lock, 5s, [this] { return _held > 0; });
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        _pass();
+        if (path.to_string() == "/broken") return Err<std::vector<std::string>>("SlowTree: broken");
+        std::vector<std::string> names;
+        if (path.to_string() == "/items") {
+            for (size_t i = 0; i < _items.load(); ++i) names.push_back("i" + std::to_string(i));
+        }
+        return names;
+    }
+    Result<Dict> get_metadata(const DataPath& path) override {
+        _pass();
+        return Dict{{"label", Value(_prefix + path.filename())}};
+    }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override {
+        return std::vector<std::string>{"label"};
+    }
+    Result<Value> get(const DataPath& path) override {
+        _pass();
+        if (path.filename() == "label") return Value(_prefix + path.dirname().filename());
+        return Value{};
+    }
+    Result<void> set(const DataPath& path, const Value& value) override {
+        _pass();
+        if (path.filename() != "prefix") return Err<void>("SlowTree: read-only");
+        _prefix = *get_as<std::string>(value);
+        return Ok();
+    }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override {
+        _pass();
+        ++_items;
+        return Ok();
+    }
+    Result<std::string> as_tree(const DataPath&, int) override { return std::string{}; }
+
+private:
+    void _pass() {
+        std::unique_lock lock(_gate_mutex);
+        ++_held;
+        _gate.notify_all();
+        _gate.wait(lock, [this] { return _open; });
+        --_held;
+        lock.unlock();
+        std::this_thread::sleep_for(_delay);
+    }
+
+    std::mutex _gate_mutex;
+    std::condition_variable _gate;
+    bool _open = true;
+    size_t _held = 0;
+    std::chrono::milliseconds _delay;
+    std::atomic<size_t> _items;
+    std::string _prefix = "Item ";
+};
+
+AsyncTreePtr wrap(std::chrono::milliseconds delay, double max_age, size_t max_in_flight = 1) {
+    return *AsyncTree::create(std::make_shared<SlowTree>(delay), "slow", max_age, max_in_flight);
+}
+
+SlowTree& provider(const AsyncTreePtr& tree) {
+    return static_cast<SlowTree&>(*tree->inner());
+}
+
+std::string label(const Dict& meta) {
+    auto it = meta.find("label");
+    return it == meta.end() ? std::string() : *get_as<std::string>(it->second);
+}
+
+bool stale(const Dict& meta) {
+    return *get_as<bool>(meta.at("stale"));
+}
+
+void configure(size_t threads) {
+    AsyncTreeConfig config;
+    config.threads = threads;
+    expect(AsyncTreeService::instance().configure(config).has_value());
+}
+
+} // namespace
+
+suite async_tree_tests = [] {
+    "reads_answer_at_once_then_from_the_cache"_test = [] {
+        configure(2);
+        auto tree = wrap(0ms, 60.0);
+
+        // The provider cannot answer, so a read waiting for it would hang
+        provider(tree).close_gate();
+        auto first = tree->get_children_names(DataPath("/items"));
+        auto pending = tree->get_metadata(DataPath("/items/i1"));
+        expect(provider(tree).wait_held());
+        expect(!first.has_value()) << "Nothing cached yet is an error, not an empty answer";
+        expect(error_msg(first).find("pending") != std::string::npos);
+        expect(!pending.has_value());
+        expect(*get_as<bool>(*tree->get(DataPath("/items/i1/stale"))));
+        expect(tree->pending() > 0_ul);
+        provider(tree).open_gate();
+
+        // Joins the refresh the first read queued
+        auto names = tree->get_children_names_async(DataPath("/items")).get();
+        expect(names->size() == 3_ul);
+        expect(tree->get_children_names(DataPath("/items"))->size() == 3_ul);
+
+        expect(label(*tree->get_metadata_async(DataPath("/items/i1")).get()) == "Item i1");
+        auto meta = *tree->get_metadata(DataPath("/items/i1"));
+        expect(label(meta) == "Item i1");
+        expect(!stale(meta));
+        expect(!*get_as<bool>(*tree->get(DataPath("/items/i1/stale"))));
+
+        // Fresh answers do not reach the provider again
+        auto calls = tree->provider_calls();
+        for (int i = 0; i < 100; ++i) tree->get_children_names(DataPath("/items"));
+        expect(tree->provider_calls() == calls);
+    };
+
+    "old_answers_are_served_while_refreshing"_test = [] {
+        configure(2);
+        auto tree = wrap(20ms, 0.05);
+        expect(tree->get_children_names_async(DataPath("/items")).get()->size() == 3_ul);
+
+        expect(tree->add_child_async(DataPath("/items"), "new", Dict{}).get().has_value());
+        // The write makes every answer due; the old one is served meanwhile
+        expect(tree->get_children_names(DataPath("/items"))->size() == 3_ul);
+        bool refreshed = false;
+        for (int i = 0; i < 100 && !refreshed; ++i) {
+            std::this_thread::sleep_for(5ms);
+            refreshed = tree->get_children_names(DataPath("/items"))->size() == 4;
+        }
+        expect(refreshed);
+    };
+
+    "writes_are_queued_and_failures_reported"_test = [] {
+        configure(2);
+        auto tree = wrap(30ms, 60.0);
+        expect(label(*tree->get_metadata_async(DataPath("/items/i0")).get()) == "Item i0");
+
+        provider(tree).close_gate();
+        expect(tree->set(DataPath("/prefix"), Value(std::string("Row "))).has_value())
+            << "set returns before the provider ran";
+        expect(provider(tree).wait_held());
+        expect(tree->pending() == 1_ul);
+        provider(tree).open_gate();
+
+        expect(!tree->set_async(DataPath("/items/i0/label"), Value(std::string("x"))).get().has_value());
+        expect(label(*tree->get_metadata_async(DataPath("/items/i0")).get()) == "Row i0");
+
+        auto broken = tree->get_children_names_async(DataPath("/broken")).get();
+        expect(!broken.has_value());
+        expect(!tree->get_children_names(DataPath("/broken")).has_value()) << "A failed fetch stays an error";
+        expect(*get_as<bool>(*tree->get(DataPath("/broken/stale"))));
+    };
+
+    "failed_write_is_reported_by_the_next_read"_test = [] {
+        configure(2);
+        auto tree = wrap(10ms, 60.0);
+        expect(tree->get_children_names_async(DataPath("/items")).get().has_value());
+
+        expect(tree->set(DataPath("/items/i0/label"), Value(std::string("x"))).has_value())
+            << "Acknowledged before the provider ran";
+        for (int i = 0; i < 100 && tree->pending() > 0; ++i) std::this_thread::sleep_for(1ms);
+
+        auto read = tree->get_children_names(DataPath("/items"));
+        expect(!read.has_value());
+        expect(error_msg(read).find("read-only") != std::string::npos);
+        expect(tree->get_children_names(DataPath("/items")).has_value()) << "Reported once";
+    };
+
+    "concurrency_limit_per_provider"_test = [] {
+        configure(4);
+        auto serial = wrap(20ms, 60.0, 1);
+        auto parallel = wrap(20ms, 60.0, 3);
+
+        std::vector<std::future<Result<Dict>>> futures;
+        for (int i = 0; i < 8; ++i) {
+            futures.push_back(serial->get_metadata_async(DataPath("/items/i" + std::to_string(i))));
+            futures.push_back(parallel->get_metadata_async(DataPath("/items/i" + std::to_string(i))));
+        }
+        for (auto& f : futures) expect(f.get().has_value());
+        expect(serial->peak_in_flight() == 1_ul);
+        expect(parallel->peak_in_flight() <= 3_ul);
+        expect(parallel->peak_in_flight() >= 2_ul);
+        // A job counts until its worker is back, just after its answer went out
+        for (int i = 0; i < 100 && serial->pending() > 0; ++i) std::this_thread::sleep_for(1ms);
+        expect(serial->pending() == 0_ul);
+    };
+
+    "slow_provider_leaves_workers_for_others"_test = [] {
+        configure(2);
+        auto slow = wrap(0ms, 60.0, 1);
+        auto fast = wrap(0ms, 60.0, 1);
+
+        // The slow provider holds its worker until the gate opens
+        provider(slow).close_gate();
+        std::vector<std::future<Result<Dict>>> backlog;
+        for (int i = 0; i < 4; ++i) {
+            backlog.push_back(slow->get_metadata_async(DataPath("/items/i" + std::to_string(i))));
+        }
+        expect(provider(slow).wait_held());
+        expect(fast->get_metadata_async(DataPath("/items/i0")).get().has_value())
+            << "The fast provider gets the second worker";
+        expect(slow->pending() == 4_ul);
+        expect(slow->provider_calls() == 1_ul);
+
+        // Dropping the tree fails what is still queued; it waits for the running call
+        std::thread disposing([&] { slow->dispose(); });
+        size_t failed = 0;
+        for (size_t i = 1; i < backlog.size(); ++i) failed += !backlog[i].get().has_value();
+        expect(failed == 3_ul);
+        provider(slow).open_gate();
+        disposing.join();
+        expect(slow->provider_calls() == 1_ul) << "Queued calls never reach the provider";
+    };
+
+    "children_metadata_is_cached_per_key_list"_test = [] {
+        configure(2);
+        auto tree = wrap(20ms, 60.0);
+        const std::vector<std::string> keys{"label", "stale"};
+
+        expect(!tree->get_children_metadata(DataPath("/items"), keys).has_value()) << "Nothing cached yet";
+
+        auto fetched = tree->get_children_metadata_async(DataPath("/items"), keys).get();
+        expect(fetched.has_value() && fetched->size() == 3_ul);
+
+        auto calls = tree->provider_calls();
+        auto listing = *tree->get_children_metadata(DataPath("/items"), keys);
+        expect(tree->provider_calls() == calls) << "Served from the cache";
+        expect(listing.size() == 3_ul);
+        expect(*get_as<std::string>(listing.at(2, 0)) == "Item i2");
+        expect(!*get_as<bool>(listing.at(0, 1))) << "The stale column reports the listing";
+
+        expect(!tree->get_children_metadata(DataPath("/items"), {"label"}).has_value())
+            << "Another key list is another entry";
+    };
+
+    "eviction_keeps_the_recently_read_entries"_test = [] {
+        configure(2);
+        auto tree = wrap(0ms, 60.0, 2);
+        auto path = [](size_t i) { return DataPath("/items/i" + std::to_string(i)); };
+
+        std::vector<std::future<Result<Dict>>> futures;
+        for (size_t i = 0; i < AsyncTree::MAX_CACHED; ++i) {
+            futures.push_back(tree->get_metadata_async(path(i)));
+        }
+        for (auto& f : futures) expect(f.get().has_value());
+        expect(tree->cached() == AsyncTree::MAX_CACHED);
+
+        // Read the newest half again, oldest first, so i0 is the least recent
+        for (size_t i = AsyncTree::MAX_CACHED / 2; i < AsyncTree::MAX_CACHED; ++i) {
+            expect(!stale(*tree->get_metadata(path(i))));
+        }
+        auto hot = path(AsyncTree::MAX_CACHED - 1);
+
+        // One more key goes over the limit
+        tree->get_metadata(DataPath("/items/new"));
+        size_t kept = tree->cached();
+        expect(kept <= AsyncTree::EVICT_TO + 1) << "Evicted down to the low-water mark";
+        expect(kept >= AsyncTree::EVICT_TO) << "Only the excess goes, not every settled entry";
+
+        auto calls = tree->provider_calls();
+        expect(!stale(*tree->get_metadata(hot))) << "The recently read entry stays";
+        expect(!stale(*tree->get_metadata(path(AsyncTree::MAX_CACHED / 2))));
+        expect(tree->provider_calls() == calls);
+        expect(!tree->get_metadata(path(0)).has_value()) << "The least recently read entry went first";
+    };
+
+    "frames_read_while_the_provider_is_busy"_test = [] {
+        configure(2);
+        constexpr int ROWS = 50;
+        auto tree = *AsyncTree::create(std::make_shared<SlowTree>(0ms, ROWS), "slow", 60.0, 1);
+
+        // A browser reading names and every label, each frame
+        auto frame = [&] {
+            size_t labelled = 0;
+            auto names = tree->get_children_names(DataPath("/items")).value_or(std::vector<std::string>{});
+            for (const auto& name : names) {
+                auto meta = tree->get_metadata(DataPath("/items/" + name));
+                labelled += meta && !label(*meta).empty();
+            }
+            return labelled;
+        };
+
+        // Frames go on while the provider is stuck in its first call
+        provider(tree).close_gate();
+        for (int i = 0; i < 10; ++i) expect(frame() == 0_ul);
+        expect(provider(tree).wait_held());
+        expect(tree->provider_calls() == 1_ul) << "Repeated reads of a pending path queue one fetch";
+        expect(tree->pending() == 1_ul);
+
+        provider(tree).open_gate();
+        size_t labelled = 0;
+        for (int i = 0; i < 1000 && labelled < ROWS; ++i) {
+            labelled = frame();
+            if (labelled < ROWS) std::this_thread::sleep_for(1ms);
+        }
+        expect(labelled == static_cast<size_t>(ROWS)) << "Everything arrives in the background";
+        expect(tree->provider_calls() == static_cast<uint64_t>(ROWS + 1)) << "One fetch per path";
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,255 @@
+// Multichannel block ring unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/audio_stats.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+// Frame f of channel c holds c * 1000 + f, so alignment is checkable
+float sample_at(size_t channel, size_t frame) {
+    return static_cast<float>(channel * 1000 + frame % 1000);
+}
+
+std::vector<float> make_interleaved(size_t channels, size_t frames, size_t offset = 0) {
+    std::vector<float> data(channels * frames);
+    for (size_t f = 0; f < frames; ++f) {
+        for (size_t c = 0; c < channels; ++c) data[f * channels + c] = sample_at(c, offset + f);
+    }
+    return data;
+}
+
+// Records what a tap sees, in order
+class CollectTap : public AudioTap {
+public:
+    void on_write(const float* data, size_t count) override {
+        samples.insert(samples.end(), data, data + count);
+    }
+    std::vector<float> samples;
+};
+
+// Records the ring frame index each call starts at
+class FrameTap : public AudioTap {
+public:
+    void on_write(const float*, size_t) override {}
+    void on_write_at(const float*, size_t count, uint64_t frame) override {
+        calls.emplace_back(frame, count);
+    }
+    std::vector<std::pair<uint64_t, size_t>> calls;
+};
+
+} // namespace
+
+suite audio_block_ring_tests = [] {
+    "interleaved_write_splits_channels_across_wrap"_test = [] {
+        auto res = AudioRingBuffer::create(48000, 10, 4, 3);
+        expect(res.has_value()) << "create failed: " << error_msg(res);
+        auto ring = *res;
+        expect(ring->channels() == 3_ul);
+
+        // 4 + 4 + 4 frames into a 10-frame ring: the last block wraps
+        for (size_t pos = 0; pos < 12; pos += 4) {
+            auto block = make_interleaved(3, 4, pos);
+            ring->write_interleaved(block.data(), 4);
+        }
+        expect(ring->frames_written() == 12_ul);
+        expect(ring->size() == 10_ul);
+
+        for (size_t c = 0; c < 3; ++c) {
+            auto data = ring->read_channel(c);
+            expect(data.size() == 10_ul);
+            for (size_t i = 0; i < data.size(); ++i) {
+                expect(data[i] == sample_at(c, i + 2)) << "channel" << c << "frame" << i;
+            }
+        }
+        expect(ring->read_all() == ring->read_channel(0));
+        expect(ring->read_channel(3).empty());
+        expect(ring->stats(1).blocks_written.load() == 3_ul) << "One block per period on every channel";
+        expect(ring->stats(1).samples_written.load() == 12_ul);
+    };
+
+    "planar_and_s16_writes"_test = [] {
+        auto ring = *AudioRingBuffer::create(48000, 8, 4, 2);
+        std::vector<float> left{1.0f, 2.0f, 3.0f};
+        std::vector<float> right{-1.0f, -2.0f, -3.0f};
+        const float* planes[2] = {left.data(), right.data()};
+        ring->write_planar(planes, 3);
+
+        std::vector<int16_t> pcm{16384, -16384, -32768, 0};
+        ring->write_interleaved(pcm.data(), 2);
+
+        auto l = ring->read_channel(0);
+        auto r = ring->read_channel(1);
+        expect(l == std::vector<float>{1.0f, 2.0f, 3.0f, 0.5f, -1.0f});
+        expect(r == std::vector<float>{-1.0f, -2.0f, -3.0f, -0.5f, 0.0f});
+
+        // A block longer than the ring keeps its newest frames
+        std::vector<float> mono(20);
+        for (size_t i = 0; i < mono.size(); ++i) mono[i] = static_cast<float>(i);
+        auto mono_ring = *AudioRingBuffer::create(48000, 8, 4);
+        mono_ring->write(mono);
+        auto kept = mono_ring->read_all();
+        expect(kept.size() == 8_ul);
+        expect(kept.front() == 12.0f && kept.back() == 19.0f);
+        expect(mono_ring->frames_written() == 20_ul);
+    };
+
+    "strided_writes_read_driver_areas"_test = [] {
+        // An interleaved DMA area seen as per-channel areas with step 3,
+        // the way ALSA mmap describes it; the third channel is unused
+        auto area = make_interleaved(3, 6);
+        auto ring = *AudioRingBuffer::create(48000, 4, 2, 2);
+        const float* channels[2] = {area.data(), area.data() + 1};
+        const size_t steps[2] = {3, 3};
+        ring->write_strided(channels, steps, 6);
+        expect(ring->frames_written() == 6_ul);
+        for (size_t c = 0; c < 2; ++c) {
+            auto data = ring->read_channel(c);
+            expect(data.size() == 4_ul);
+            for (size_t i = 0; i < data.size(); ++i) {
+                expect(data[i] == sample_at(c, i + 2)) << "channel" << c << "frame" << i;
+            }
+        }
+
+        // Non-interleaved S16 areas: step 1 per channel
+        std::vector<int16_t> left{16384, -16384};
+        std::vector<int16_t> right{-32768, 0};
+        const int16_t* planes[2] = {left.data(), right.data()};
+        const size_t unit[2] = {1, 1};
+        auto s16_ring = *AudioRingBuffer::create(48000, 4, 2, 2);
+        s16_ring->write_strided(planes, unit, 2);
+        expect(s16_ring->read_channel(0) == std::vector<float>{0.5f, -0.5f});
+        expect(s16_ring->read_channel(1) == std::vector<float>{-1.0f, 0.0f});
+    };
+
+    "mediated_views_and_per_channel_taps"_test = [] {
+        auto ring = *AudioRingBuffer::create(48000, 16, 4, 2);
+        auto left = *MediatedAudioBuffer::create(ring, 0);
+        auto right = *MediatedAudioBuffer::create(ring, 1);
+        expect(!MediatedAudioBuffer::create(ring, 2).has_value()) << "Channel out of range";
+        expect(right->channel() == 1_ul);
+        expect(right->ring() == ring);
+
+        auto left_tap = std::make_shared<CollectTap>();
+        auto right_tap = std::make_shared<CollectTap>();
+        left->add_tap(left_tap);
+        right->add_tap(right_tap);
+
+        // 6 + 6 frames into a 16-frame ring: the tap sees the wrapped block whole
+        for (size_t pos = 0; pos < 24; pos += 6) {
+            auto block = make_interleaved(2, 6, pos);
+            ring->write_interleaved(block.data(), 6);
+        }
+        expect(left_tap->samples.size() == 24_ul);
+        expect(right_tap->samples.size() == 24_ul);
+        for (size_t i = 0; i < 24; ++i) {
+            expect(left_tap->samples[i] == sample_at(0, i)) << "left" << i;
+            expect(right_tap->samples[i] == sample_at(1, i)) << "right" << i;
+        }
+
+        expect(right->data() == ring->read_channel(1));
+        expect(right->stats()->reads.load() == 1_ul);
+        expect(left->stats()->reads.load() == 0_ul) << "Reads are counted per channel";
+
+        // Views of different channels lock independently
+        expect(left->try_lock());
+        expect(right->try_lock());
+        expect(!left->try_lock());
+        left->unlock();
+        right->unlock();
+
+        ring->remove_tap(right_tap);
+        auto block = make_interleaved(2, 2);
+        ring->write_interleaved(block.data(), 2);
+        expect(left_tap->samples.size() == 26_ul);
+        expect(right_tap->samples.size() == 24_ul);
+    };
+
+    "taps_get_the_ring_frame_index"_test = [] {
+        auto ring = *AudioRingBuffer::create(48000, 16, 4, 2);
+        for (size_t pos = 0; pos < 10; pos += 5) {
+            auto block = make_interleaved(2, 5, pos);
+            ring->write_interleaved(block.data(), 5);
+        }
+
+        // Attached after 10 frames, on the second channel
+        auto tap = std::make_shared<FrameTap>();
+        ring->add_tap(tap, 1);
+        auto block = make_interleaved(2, 9, 10);
+        ring->write_interleaved(block.data(), 9);
+
+        // Frames 10-18 wrap at 16: two calls, stamped with the stream index
+        using Call = std::pair<uint64_t, size_t>;
+        expect(tap->calls == std::vector<Call>{{10, 6}, {16, 3}});
+
+        // A tap that only overrides on_write still sees every block
+        auto plain = std::make_shared<CollectTap>();
+        ring->add_tap(plain, 0);
+        ring->write_interleaved(block.data(), 2);
+        expect(plain->samples.size() == 2_ul);
+        expect(tap->calls.back() == Call{19, 2});
+    };
+
+    "stats_subtree_reports_each_channel"_test = [] {
+        auto ring = *AudioRingBuffer::create(48000, 16, 4, 2);
+        auto block = make_interleaved(2, 4);
+        ring->write_interleaved(block.data(), 4);
+
+        auto names = audio_stats_children_names({}, ring);
+        expect(names == std::vector<std::string>{"0", "1"});
+        auto meta = audio_stats_metadata({}, nullptr, ring);
+        expect(get_as<int64_t>(meta["samples-written"]) == int64_t(8));
+        auto channel = audio_stats_metadata({"1"}, nullptr, ring);
+        expect(get_as<std::string>(channel["type"]) == std::string("audio-channel-stats"));
+        expect(audio_stats_metadata({"2"}, nullptr, ring).empty());
+    };
+
+    "aligned_reads_while_writing"_test = [] {
+        constexpr size_t CHANNELS = 4;
+        constexpr size_t PERIOD = 64;
+        auto ring = *AudioRingBuffer::create(48000, 1024, PERIOD, CHANNELS);
+
+        std::atomic<bool> done{false};
+        std::thread producer([&] {
+            std::vector<float> block(CHANNELS * PERIOD);
+            for (size_t pos = 0; pos < PERIOD * 4000; pos += PERIOD) {
+                for (size_t f = 0; f < PERIOD; ++f) {
+                    for (size_t c = 0; c < CHANNELS; ++c) block[f * CHANNELS + c] = sample_at(c, pos + f);
+                }
+                ring->write_interleaved(block.data(), PERIOD);
+            }
+            done = true;
+        });
+
+        // Every read sees all channels at the same frames
+        std::vector<std::vector<float>> out;
+        std::vector<size_t> channels{0, 1, 2, 3};
+        bool aligned = true;
+        size_t reads = 0;
+        while (!done || reads == 0) {
+            uint64_t end = ring->read_frames(channels, 256, out);
+            ++reads;
+            if (out[0].empty()) continue;
+            for (size_t i = 0; i < out[0].size(); ++i) {
+                float frame = out[0][i];
+                for (size_t c = 1; c < CHANNELS; ++c) {
+                    if (out[c][i] != frame + static_cast<float>(c * 1000)) aligned = false;
+                }
+            }
+            if (out[0].back() != sample_at(0, static_cast<size_t>(end - 1))) aligned = false;
+        }
+        producer.join();
+        expect(aligned) << "Channels read from different periods";
+        expect(ring->frames_written() == 256000_ul);
+    };
+};
+
+int main() {
+    return 0;
+}
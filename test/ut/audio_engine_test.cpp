@@ -0,0 +1,328 @@
+// Playback engine unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/audio_engine.hpp"
+#include "ymery/backend/audio_recorder.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+// Endless constant signal
+class ConstSource : public AudioSource {
+public:
+    explicit ConstSource(float value) : _value(value) {}
+    size_t render(float* out, size_t frames) override {
+        std::fill(out, out + frames, _value);
+        return frames;
+    }
+private:
+    float _value;
+};
+
+// Constant signal that ends after `length` frames
+class ShortSource : public AudioSource {
+public:
+    explicit ShortSource(size_t length) : _left(length) {}
+    size_t render(float* out, size_t frames) override {
+        size_t n = std::min(frames, _left);
+        std::fill(out, out + n, 1.0f);
+        _left -= n;
+        return n;
+    }
+private:
+    size_t _left;
+};
+
+AudioEnginePtr make_engine(size_t channels = 2, size_t block = 64, size_t voices = 4, size_t queue = 16) {
+    AudioEngineConfig config;
+    config.channels = channels;
+    config.block_frames = block;
+    config.max_voices = voices;
+    config.queue_size = queue;
+    return *AudioEngine::create(config);
+}
+
+bool near(float a, float b, float eps = 1e-4f) {
+    return std::abs(a - b) < eps;
+}
+
+} // namespace
+
+suite audio_engine_tests = [] {
+    "create_rejects_bad_config"_test = [] {
+        AudioEngineConfig config;
+        config.block_frames = 0;
+        expect(!AudioEngine::create(config).has_value());
+        config = {};
+        config.max_voices = 0;
+        expect(!AudioEngine::create(config).has_value());
+    };
+
+    "mix_ramps_in_then_holds_gain_and_pan"_test = [] {
+        auto engine = make_engine(2, 64);
+        expect(engine->play(std::make_shared<ConstSource>(1.0f), 0.5f, -1.0f).has_value());
+        expect(engine->play(std::make_shared<ConstSource>(1.0f), 0.25f, 1.0f).has_value());
+
+        std::vector<float> out(64 * 2);
+        engine->render(out.data(), 64);
+        // First block ramps up from silence to the target
+        expect(out[0] < 0.05f);
+        expect(near(out[63 * 2], 0.5f)) << "left" << out[63 * 2];
+        expect(near(out[63 * 2 + 1], 0.25f)) << "right" << out[63 * 2 + 1];
+
+        engine->render(out.data(), 64);
+        for (size_t f = 0; f < 64; ++f) {
+            expect(near(out[f * 2], 0.5f) && near(out[f * 2 + 1], 0.25f)) << "frame" << f;
+        }
+        expect(engine->stats().active_voices.load() == 2_ul);
+        expect(engine->stats().blocks.load() == 2_ul);
+    };
+
+    "center_pan_is_equal_power_and_master_gain_ramps"_test = [] {
+        auto engine = make_engine(2, 32);
+        engine->play(std::make_shared<ConstSource>(1.0f));
+        std::vector<float> out(32 * 2);
+        engine->render(out.data(), 32);
+        engine->render(out.data(), 32);
+        const float half = std::sqrt(0.5f);
+        expect(near(out[0], half) && near(out[1], half));
+
+        engine->set_master_gain(0.0f);
+        engine->render(out.data(), 32);
+        expect(out[0] > 0.5f * half) << "Master gain ramps, no step";
+        expect(near(out[31 * 2], 0.0f));
+        engine->render(out.data(), 32);
+        expect(near(out[0], 0.0f));
+    };
+
+    "render_splits_long_requests_into_blocks"_test = [] {
+        auto engine = make_engine(1, 16);
+        engine->play(std::make_shared<ConstSource>(1.0f));
+        std::vector<float> out(100);
+        engine->render(out.data(), 100);
+        expect(engine->stats().blocks.load() == 7_ul);
+        expect(engine->stats().frames.load() == 100_ul);
+        expect(near(out[99], 1.0f));
+    };
+
+    "release_fades_and_slot_is_reused"_test = [] {
+        auto engine = make_engine(1, 32, 1);
+        auto source = std::make_shared<ConstSource>(1.0f);
+        auto first = *engine->play(source);
+        expect(!engine->play(std::make_shared<ConstSource>(1.0f)).has_value()) << "Only one slot";
+        expect(engine->stats().voices_dropped.load() == 1_ul);
+
+        std::vector<float> out(32);
+        engine->render(out.data(), 32);
+        expect(engine->release(first).has_value());
+        engine->render(out.data(), 32);
+        expect(out[0] > 0.9f) << "Fade starts from the playing gain";
+        expect(near(out[31], 0.0f));
+        expect(!engine->is_playing(first));
+        expect(source.use_count() == 1) << "Retired source released by collect()";
+
+        auto second = engine->play(std::make_shared<ConstSource>(1.0f));
+        expect(second.has_value());
+        expect(*second != first) << "Generation distinguishes reused slots";
+        expect(!engine->set_gain(first, 0.5f).has_value()) << "Stale handle";
+    };
+
+    "finished_sources_retire_themselves"_test = [] {
+        auto engine = make_engine(1, 16);
+        auto voice = *engine->play(std::make_shared<ShortSource>(20));
+        std::vector<float> out(16);
+        engine->render(out.data(), 16);
+        expect(engine->is_playing(voice));
+        engine->render(out.data(), 16);
+        expect(!engine->is_playing(voice));
+        expect(near(out[15], 0.0f));
+    };
+
+    "full_control_queue_drops_commands"_test = [] {
+        auto engine = make_engine(1, 16, 8, 2);
+        auto voice = *engine->play(std::make_shared<ConstSource>(1.0f));
+        expect(engine->set_gain(voice, 0.5f).has_value());
+        expect(!engine->set_gain(voice, 0.25f).has_value());
+        expect(engine->stats().commands_dropped.load() == 1_ul);
+        std::vector<float> out(16);
+        engine->render(out.data(), 16);
+        expect(engine->set_gain(voice, 0.25f).has_value()) << "Queue drained by render()";
+    };
+
+    "buffer_and_stream_sources"_test = [] {
+        StaticAudioBufferPtr buffer = *FileAudioBuffer::create("test.wav", std::vector<float>{1, 2, 3, 4, 5}, 48000);
+        BufferSource once(buffer);
+        std::vector<float> out(8, -1.0f);
+        expect(once.render(out.data(), 8) == 5_ul);
+        expect(out[4] == 5.0f);
+
+        BufferSource looped(buffer, true);
+        expect(looped.render(out.data(), 8) == 8_ul);
+        expect(out[5] == 1.0f && out[7] == 3.0f);
+
+        auto ring = *AudioRingBuffer::create(48000, 64, 8, 2);
+        std::vector<float> block(16);
+        for (size_t f = 0; f < 8; ++f) {
+            block[f * 2] = static_cast<float>(f);
+            block[f * 2 + 1] = 100.0f + f;
+        }
+        ring->write_interleaved(block.data(), 8);
+        StreamSource stream(ring, 1, 4);
+        expect(stream.render(out.data(), 4) == 4_ul);
+        expect(out[0] == 104.0f && out[3] == 107.0f) << "Starts latency frames behind";
+        expect(stream.render(out.data(), 4) == 4_ul);
+        expect(out[0] == 0.0f);
+        expect(stream.underruns() == 1_ul);
+    };
+
+    "stream_source_never_plays_torn_frames"_test = [] {
+        // A producer laps a small ring while the stream reads it without the
+        // ring's lock; every sample played must be the next frame or silence
+        constexpr size_t RING = 64;
+        constexpr size_t BLOCK = 16;
+        auto ring = *AudioRingBuffer::create(48000, RING, BLOCK, 1);
+        std::atomic<bool> done{false};
+        std::thread producer([&] {
+            std::vector<float> block(BLOCK);
+            for (size_t frame = 0; frame < 400000; frame += BLOCK) {
+                for (size_t i = 0; i < BLOCK; ++i) block[i] = static_cast<float>(frame + i + 1);
+                ring->write_interleaved(block.data(), BLOCK);
+            }
+            done = true;
+        });
+
+        StreamSource stream(ring, 0, BLOCK);
+        std::vector<float> out(24);
+        float last = 0.0f;
+        size_t played = 0;
+        bool in_order = true;
+        // Reads go on past the producer's end, so the newest frames play
+        for (int reads = 0; !done || reads < 16; ++reads) {
+            stream.render(out.data(), out.size());
+            float previous = 0.0f;
+            for (float v : out) {
+                if (v == 0.0f) continue;
+                // Frames of one read are contiguous, and reads move forward
+                in_order = in_order && v > last && (previous == 0.0f || v == previous + 1.0f);
+                previous = last = v;
+                ++played;
+            }
+        }
+        producer.join();
+        expect(in_order) << "No sample from a later lap of the ring";
+        expect(played > 0_ul);
+    };
+
+    "null_sink_free_runs_to_max_frames"_test = [] {
+        auto engine = make_engine(2, 128);
+        engine->play(std::make_shared<ConstSource>(0.5f), 1.0f, -1.0f);
+        auto sink = *NullAudioSink::create(0.0, 48000);
+        expect(engine->start(sink).has_value());
+
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (sink->is_running() && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        expect(!sink->is_running());
+        expect(sink->frames_played() == 48000_ul);
+        expect(engine->stats().frames.load() == 48000_ul);
+        auto* null_sink = static_cast<NullAudioSink*>(sink.get());
+        expect(near(null_sink->peak(), 0.5f));
+        expect(engine->stop().has_value());
+    };
+
+    "paced_sink_follows_virtual_clock"_test = [] {
+        auto engine = make_engine(2, 480);
+        auto sink = *NullAudioSink::create(4.0);  // 4x real time
+        auto start = std::chrono::steady_clock::now();
+        expect(engine->start(sink).has_value());
+        expect(!engine->start(*NullAudioSink::create()).has_value()) << "Already running";
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        expect(engine->stop().has_value());
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto* clocked = static_cast<ClockedAudioSink*>(sink.get());
+        double expected = elapsed * 4.0;
+        expect(clocked->virtual_time() > 0.2) << clocked->virtual_time();
+        expect(clocked->virtual_time() <= expected + 0.05) << "Ran ahead of the clock";
+    };
+
+    "file_sink_writes_wav"_test = [] {
+        auto path = (std::filesystem::temp_directory_path() / "ymery_audio_engine_test.wav").string();
+        auto engine = make_engine(2, 256);
+        engine->play(std::make_shared<ConstSource>(0.25f));
+        auto sink = *create_audio_sink("file", Dict{
+            {"file", Value(path)},
+            {"max-frames", Value(int64_t(4800))}
+        });
+        expect(sink->kind() == "file");
+        expect(engine->start(sink).has_value());
+        while (sink->is_running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        expect(engine->stop().has_value());
+
+        auto size = std::filesystem::file_size(path);
+        expect(size == WAV_FLOAT_HEADER_SIZE + 4800 * 2 * sizeof(float)) << size;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        char riff[4] = {};
+        std::fread(riff, 1, 4, file);
+        std::fclose(file);
+        expect(std::string(riff, 4) == "RIFF");
+        std::filesystem::remove(path);
+
+        expect(!create_audio_sink("file", Dict{}).has_value()) << "File path required";
+        expect(!create_audio_sink("no-such-sink").has_value());
+    };
+
+    "sink_registry_accepts_plugins"_test = [] {
+        register_audio_sink("test", [](const Dict&) { return NullAudioSink::create(); });
+        auto kinds = audio_sink_kinds();
+        expect(std::find(kinds.begin(), kinds.end(), "test") != kinds.end());
+        expect(create_audio_sink("test").has_value());
+        unregister_audio_sink("test");
+        expect(!create_audio_sink("test").has_value());
+    };
+
+    "control_thread_races_audio_thread"_test = [] {
+        auto engine = make_engine(2, 64, 8, 64);
+        auto sink = *NullAudioSink::create(0.0);
+        expect(engine->start(sink).has_value());
+
+        // play/release/gain from this thread while the sink renders
+        std::vector<VoiceId> voices;
+        size_t played = 0;
+        for (int i = 0; i < 2000; ++i) {
+            if (voices.size() < 6) {
+                if (auto id = engine->play(std::make_shared<ConstSource>(0.1f), 0.5f, 0.0f)) {
+                    voices.push_back(*id);
+                    ++played;
+                }
+            } else {
+                engine->set_pan(voices.front(), 0.5f);
+                engine->release(voices.front());
+                voices.erase(voices.begin());
+            }
+            engine->set_master_gain(i % 2 ? 1.0f : 0.5f);
+            if (i % 50 == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        expect(engine->stop().has_value());
+        expect(played > 100_ul);
+        expect(sink->frames_played() > 0_ul);
+        expect(near(static_cast<NullAudioSink*>(sink.get())->peak(), 0.0f) == false);
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Audio envelope unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/audio_envelope.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+// Ramp 0, 1, 2, ... so every bucket's min and max are known
+static std::vector<float> make_ramp(size_t count, size_t offset = 0) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; ++i) samples[i] = static_cast<float>(i + offset);
+    return samples;
+}
+
+suite audio_envelope_tests = [] {
+    "envelope_buckets_across_block_boundaries"_test = [] {
+        EnvelopeConfig config;
+        config.samples_per_bucket = 10;
+        config.buckets = 16;
+        auto res = AudioEnvelope::create(config);
+        expect(res.has_value()) << "create failed: " << error_msg(res);
+        auto envelope = *res;
+
+        auto samples = make_ramp(95);
+        for (size_t pos = 0; pos < samples.size(); pos += 7) {
+            envelope->on_write(samples.data() + pos, std::min<size_t>(7, samples.size() - pos));
+        }
+        expect(envelope->completed() == 9_ul) << "Partial bucket must not be published";
+
+        std::vector<EnvelopeBucket> out(9);
+        envelope->copy(0, out.size(), out.data());
+        for (size_t i = 0; i < out.size(); ++i) {
+            expect(out[i].min == static_cast<float>(i * 10)) << "bucket" << i;
+            expect(out[i].max == static_cast<float>(i * 10 + 9)) << "bucket" << i;
+        }
+    };
+
+    "envelope_overwritten_buckets_are_empty"_test = [] {
+        EnvelopeConfig config;
+        config.samples_per_bucket = 4;
+        config.buckets = 8;
+        auto envelope = *AudioEnvelope::create(config);
+        auto samples = make_ramp(4 * 20);
+        envelope->on_write(samples.data(), samples.size());
+
+        EnvelopeBucket out[2];
+        envelope->copy(0, 1, out);
+        expect(out[0].min > out[0].max) << "Bucket 0 was overwritten and must read empty";
+        envelope->copy(19, 1, out + 1);
+        expect(out[1].min == 76.0f && out[1].max == 79.0f);
+    };
+
+    "history_pulls_only_new_buckets"_test = [] {
+        EnvelopeConfig config;
+        config.samples_per_bucket = 8;
+        config.buckets = 64;
+        auto envelope = *AudioEnvelope::create(config);
+        EnvelopeHistory history(32, 8);
+
+        auto samples = make_ramp(8 * 10);
+        envelope->on_write(samples.data(), samples.size());
+        expect(history.pull(*envelope) == 10_ul);
+        expect(history.pull(*envelope) == 0_ul) << "Nothing new since the last pull";
+        expect(history.size() == 10_ul);
+        expect(history.at_age(0).max == 79.0f);
+        expect(history.x_min() == -80.0);
+
+        // Wrap the local ring: only the newest 32 buckets stay
+        auto more = make_ramp(8 * 40, 80);
+        envelope->on_write(more.data(), more.size());
+        expect(history.pull(*envelope) == 40_ul);
+        expect(history.size() == 32_ul);
+        expect(history.at_age(0).max == 399.0f);
+        expect(history.at_age(31).min == 144.0f);
+
+        auto range = history.value_range();
+        expect(range.min == 144.0f && range.max == 399.0f);
+    };
+
+    "history_columns_reduce_to_pixels"_test = [] {
+        EnvelopeConfig config;
+        config.samples_per_bucket = 4;
+        config.buckets = 256;
+        auto envelope = *AudioEnvelope::create(config);
+        EnvelopeHistory history(256, 4);
+        auto samples = make_ramp(4 * 100);
+        envelope->on_write(samples.data(), samples.size());
+        history.pull(*envelope);
+
+        // 100 buckets over the newest 400 samples into 10 columns of 40 samples
+        std::vector<EnvelopeBucket> columns;
+        history.columns(-400.0, 0.0, 10, columns);
+        expect(columns.size() == 10_ul);
+        for (size_t c = 0; c < 10; ++c) {
+            expect(columns[c].min == static_cast<float>(c * 40)) << "column" << c;
+            expect(columns[c].max == static_cast<float>(c * 40 + 39)) << "column" << c;
+        }
+
+        // Window reaching past the newest sample and before the oldest one
+        history.columns(-800.0, 400.0, 12, columns);
+        expect(columns[0].min > columns[0].max) << "No data before the history";
+        expect(columns[11].min > columns[11].max) << "No data after the newest bucket";
+        expect(columns[4].min == 0.0f && columns[7].max == 399.0f);
+
+        // Zoomed in: one bucket spans several columns, none left empty
+        history.columns(-8.0, 0.0, 8, columns);
+        for (size_t c = 0; c < 8; ++c) {
+            expect(columns[c].min <= columns[c].max) << "column" << c;
+        }
+        expect(columns[0].min == 392.0f && columns[7].max == 399.0f);
+    };
+
+    "envelope_as_ring_buffer_tap_concurrent"_test = [] {
+        auto ring = *AudioRingBuffer::create(48000, 4096, 256);
+        EnvelopeConfig config;
+        config.samples_per_bucket = 16;
+        config.buckets = 128;
+        auto envelope = *AudioEnvelope::create(config);
+        ring->add_tap(envelope);
+
+        constexpr size_t TOTAL = 16 * 20000;
+        std::thread producer([&] {
+            std::vector<float> block(256);
+            for (size_t pos = 0; pos < TOTAL; pos += block.size()) {
+                for (size_t i = 0; i < block.size(); ++i) block[i] = static_cast<float>((pos + i) % 1000);
+                ring->write(block.data(), block.size());
+            }
+        });
+
+        // Every bucket read is either empty (overwritten) or consistent with the ramp
+        EnvelopeHistory history(64, 16);
+        bool consistent = true;
+        while (envelope->completed() < TOTAL / 16) {
+            history.pull(*envelope);
+            for (size_t age = 0; age < history.size(); ++age) {
+                const auto& b = history.at_age(age);
+                if (b.min > b.max) continue;
+                if (b.min < 0.0f || b.max > 999.0f || b.max - b.min > 999.0f) consistent = false;
+            }
+        }
+        producer.join();
+        history.pull(*envelope);
+        expect(consistent) << "Torn or out of range bucket";
+        expect(history.size() == 64_ul);
+        ring->remove_tap(envelope);
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Audio trigger unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/audio_trigger.hpp"
+#include <cmath>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+// One period of a 1 kHz sine at 48 kHz is 48 samples
+static std::vector<float> make_sine(size_t count, size_t offset = 0) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = static_cast<float>(std::sin(2.0 * 3.14159265358979323846 * (i + offset) / 48.0));
+    }
+    return samples;
+}
+
+suite audio_trigger_tests = [] {
+    "trigger_rising_edge_aligns_frames"_test = [] {
+        TriggerConfig config;
+        config.pre_samples = 12;
+        config.post_samples = 24;
+        auto trigger_res = AudioTrigger::create(config);
+        expect(trigger_res.has_value()) << "create failed: " << error_msg(trigger_res);
+        auto trigger = *trigger_res;
+
+        expect(trigger->latest() == nullptr) << "Frame published before any data";
+
+        // Feed in odd-sized blocks with varying phase; every frame must still line up
+        auto samples = make_sine(4800, 7);
+        for (size_t pos = 0; pos < samples.size(); pos += 37) {
+            trigger->on_write(samples.data() + pos, std::min<size_t>(37, samples.size() - pos));
+        }
+
+        auto frame = trigger->latest();
+        expect(frame != nullptr) << "No frame published";
+        expect(frame->samples.size() == 36_ul);
+        expect(!frame->forced);
+        expect(frame->samples[11] < 0.0f) << "Sample before trigger should be below level";
+        expect(frame->samples[12] >= 0.0f) << "Trigger sample should be at or above level";
+        expect(frame->samples[24] > 0.9f) << "Quarter period after trigger should be near the peak";
+        expect(trigger->frames_published() > 50) << "Expected a frame for most periods";
+    };
+
+    "trigger_falling_edge"_test = [] {
+        auto config_res = TriggerConfig::from_dict(Dict{
+            {"edge", Value(std::string("falling"))},
+            {"level", Value(0)},
+            {"hysteresis", Value(0.1)},
+            {"pre", Value(8)},
+            {"post", Value(16)}
+        });
+        expect(config_res.has_value()) << "from_dict failed: " << error_msg(config_res);
+        expect(config_res->edge == TriggerEdge::Falling);
+
+        auto trigger = *AudioTrigger::create(*config_res);
+        auto samples = make_sine(480);
+        trigger->on_write(samples.data(), samples.size());
+
+        auto frame = trigger->latest();
+        expect(frame != nullptr) << "No frame published";
+        expect(frame->samples[7] > 0.0f) << "Sample before trigger should be above level";
+        expect(frame->samples[8] <= 0.0f) << "Trigger sample should be at or below level";
+    };
+
+    "trigger_auto_mode_publishes_without_edge"_test = [] {
+        TriggerConfig config;
+        config.pre_samples = 4;
+        config.post_samples = 16;
+        config.auto_samples = 100;
+        auto trigger = *AudioTrigger::create(config);
+
+        std::vector<float> flat(1000, 0.5f);
+        trigger->on_write(flat.data(), flat.size());
+
+        auto frame = trigger->latest();
+        expect(frame != nullptr) << "Auto mode should publish on a flat signal";
+        expect(frame->forced);
+    };
+
+    "trigger_latest_is_stable_between_publishes"_test = [] {
+        TriggerConfig config;
+        config.pre_samples = 4;
+        config.post_samples = 20;
+        auto trigger = *AudioTrigger::create(config);
+
+        auto samples = make_sine(96);
+        trigger->on_write(samples.data(), samples.size());
+        auto first = trigger->latest();
+        expect(first != nullptr);
+        auto sequence = first->sequence;
+
+        // No new data - consumer keeps reading the same frame
+        auto again = trigger->latest();
+        expect(again == first && again->sequence == sequence);
+
+        trigger->on_write(samples.data(), samples.size());
+        auto next = trigger->latest();
+        expect(next->sequence > sequence) << "Newer frame expected after more data";
+    };
+
+    "trigger_as_ring_buffer_tap"_test = [] {
+        auto ring = *AudioRingBuffer::create(48000, 4800, 480);
+        auto mediated = *MediatedAudioBuffer::create(ring);
+
+        TriggerConfig config;
+        config.pre_samples = 24;
+        config.post_samples = 24;
+        auto trigger = *AudioTrigger::create(config);
+        mediated->add_tap(trigger);
+
+        auto samples = make_sine(480);
+        ring->write(samples);
+        expect(trigger->latest() != nullptr) << "Tap did not see ring buffer writes";
+
+        mediated->remove_tap(trigger);
+        auto published = trigger->frames_published();
+        ring->write(samples);
+        expect(trigger->frames_published() == published) << "Removed tap still receiving data";
+    };
+
+    "trigger_config_rejects_bad_edge"_test = [] {
+        auto config_res = TriggerConfig::from_dict(Dict{{"edge", Value(std::string("sideways"))}});
+        expect(!config_res.has_value());
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Batched children-with-metadata tests (default fallback, data tree, filesystem, kernel)
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/embedded_plugins.hpp"
+#include "ymery/backend/io_thread.hpp"
+#include "ymery/plugins/backend/filesystem/common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+// Children "c<i>" under the root, counting the calls the fallback makes
+class CountingTree : public TreeLike {
+public:
+    explicit CountingTree(size_t children) {
+        for (size_t i = 0; i < children; ++i) _names.push_back("c" + std::to_string(i));
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        ++children_calls;
+        if (!path.as_list().empty()) return std::vector<std::string>{};
+        return _names;
+    }
+    Result<Dict> get_metadata(const DataPath& path) override {
+        ++metadata_calls;
+        const auto& parts = path.as_list();
+        if (parts.size() != 1) return Dict{};
+        if (parts[0] == "c1") return Err<Dict>("unreadable");
+        Dict meta{{"label", Value("Child " + parts[0])}};
+        if (parts[0] != "c2") meta["size"] = Value(static_cast<int64_t>(parts[0].size()));
+        return meta;
+    }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override {
+        return std::vector<std::string>{"label", "size"};
+    }
+    Result<Value> get(const DataPath&) override { return Value{}; }
+    Result<void> set(const DataPath&, const Value&) override { return Ok(); }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override { return Ok(); }
+    Result<std::string> as_tree(const DataPath&, int) override { return std::string{}; }
+
+    int children_calls = 0;
+    int metadata_calls = 0;
+
+private:
+    std::vector<std::string> _names;
+};
+
+std::string text(const Value& v) {
+    if (auto s = get_ptr<std::string>(v)) return *s;
+    if (auto s = get_ptr<const char*>(v)) return *s;
+    return {};
+}
+
+// Batched values of `key` equal what get_metadata reports per child
+void expect_matches_per_child(TreeLike& tree, const DataPath& path, const std::vector<std::string>& keys) {
+    auto batch = tree.get_children_metadata(path, keys);
+    expect(batch.has_value()) << error_msg(batch);
+    expect(*tree.get_children_names(path) == batch->names);
+    for (size_t i = 0; i < batch->size(); ++i) {
+        auto meta = *tree.get_metadata(path / batch->names[i]);
+        for (size_t k = 0; k < keys.size(); ++k) {
+            auto it = meta.find(keys[k]);
+            std::string expected = it != meta.end() ? text(it->second) : std::string();
+            expect(text(batch->at(i, k)) == expected) << batch->names[i] << keys[k];
+        }
+    }
+}
+
+} // namespace
+
+suite children_metadata_tests = [] {
+    "default_fallback_selects_keys_column_wise"_test = [] {
+        CountingTree tree(4);
+        auto batch = tree.get_children_metadata(DataPath("/"), {"label", "size", "missing"});
+        expect(batch.has_value());
+        expect(tree.children_calls == 1_i);
+        expect(tree.metadata_calls == 4_i);
+
+        expect(batch->size() == 4_ul);
+        expect(batch->columns.size() == 3_ul);
+        expect(batch->keys == std::vector<std::string>{"label", "size", "missing"});
+        expect(text(batch->at(0, 0)) == "Child c0");
+        expect(*get_as<int64_t>(batch->at(3, 1)) == 2_ll);
+        expect(!batch->at(1, 0).has_value()) << "Failed metadata leaves an empty row";
+        expect(!batch->at(2, 1).has_value()) << "Absent key";
+        expect(!batch->at(0, 2).has_value());
+
+        auto sizes = batch->column("size");
+        expect(sizes != nullptr);
+        expect(sizes->size() == 4_ul);
+        expect(batch->column("nope") == nullptr);
+    };
+
+    "data_tree_reads_keys_in_one_walk"_test = [] {
+        auto tree = *embedded::create_data_tree();
+        for (int i = 0; i < 5; ++i) {
+            std::string name = "item" + std::to_string(i);
+            expect(tree->add_child(DataPath("/items"), name,
+                                   Dict{{"label", Value(std::string("Item ") + std::to_string(i))},
+                                        {"count", Value(i)}}).has_value());
+        }
+        expect_matches_per_child(*tree, DataPath("/items"), {"label", "count", "absent"});
+
+        auto batch = *tree->get_children_metadata(DataPath("/items"), {"count"});
+        expect(*get_as<int>(batch.at(3, 0)) == 3_i);
+
+        // Typed arrays come back as stored, like get()
+        auto array = *NumericArray::create(std::vector<float>{1.0f, 2.0f, 3.0f});
+        expect(tree->set(DataPath("/items/item1/samples"), Value(array)).has_value());
+        batch = *tree->get_children_metadata(DataPath("/items"), {"samples"});
+        auto stored = get_as<NumericArrayPtr>(batch.at(1, 0));
+        expect(stored.has_value() && *stored == array);
+
+        expect(tree->get_children_metadata(DataPath("/nowhere"), {"label"})->size() == 0_ul);
+    };
+
+    "filesystem_lists_a_directory_once"_test = [] {
+        namespace fs = std::filesystem;
+        auto dir = fs::temp_directory_path() / ("ymery-children-" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir / "sub");
+        std::ofstream(dir / "b.txt") << "x";
+        std::ofstream(dir / "a.wav") << "x";
+        std::error_code ec;
+        fs::create_symlink(dir / "gone", dir / "dangling", ec);
+
+        auto manager = *plugins::FilesystemManager::create();
+        DataPath path(std::vector<std::string>{"available", "fs-root"});
+        for (const auto& part : dir.relative_path()) path = path / part.string();
+
+        expect_matches_per_child(*manager, path, {"name", "label", "type", "category", "description"});
+        auto batch = *manager->get_children_metadata(path, {"type", "details"});
+        auto names = batch.names;
+        expect(names.front() == "a.wav") << "Sorted like get_children_names";
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (batch.names[i] == "sub") {
+                expect(text(batch.at(i, 0)) == "folder");
+                auto details = *get_as<Dict>(batch.at(i, 1));
+                expect(fs::equivalent(text(details["fs-path"]), dir / "sub"));
+            }
+        }
+
+        // Virtual folders use the fallback
+        expect_matches_per_child(*manager, DataPath("/available"), {"label", "type"});
+        fs::remove_all(dir);
+    };
+
+    "kernel_hands_the_batch_to_the_branch"_test = [] {
+        auto kernel = *embedded::create_kernel(nullptr, nullptr);
+        expect_matches_per_child(*kernel, DataPath("/"), {"label", "type"});
+
+        std::atomic<bool> running{true};
+        IoThread thread;
+        thread.start("batch-query", 1000000, [&] {
+            while (running) {
+                thread.beat();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        while (!IoThreadService::instance().find("batch-query")) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto batch = *kernel->get_children_metadata(DataPath("/threads"), {"scheduling"});
+        expect(std::find(batch.names.begin(), batch.names.end(), "batch-query") != batch.names.end());
+        expect_matches_per_child(*kernel, DataPath("/threads"), {"name", "scheduling"});
+
+        running = false;
+        thread.join();
+    };
+
+    "large_batched_listing_matches_per_child_answers"_test = [] {
+        auto tree = *embedded::create_data_tree();
+        constexpr int CHILDREN = 2000;
+        for (int i = 0; i < CHILDREN; ++i) {
+            std::string name = "node" + std::to_string(i);
+            expect(tree->add_child(DataPath("/nodes"), name,
+                                   Dict{{"label", Value("Node " + std::to_string(i))},
+                                        {"type", Value(std::string("folder"))},
+                                        {"size", Value(i)},
+                                        {"description", Value(std::string("a node in a large tree"))}}).has_value());
+        }
+        const DataPath path("/nodes");
+
+        auto batch = tree->get_children_metadata(path, {"label", "type"});
+        expect(batch.has_value() && batch->size() == static_cast<size_t>(CHILDREN));
+        expect_matches_per_child(*tree, path, {"label", "type", "description"});
+    };
+};
+
+int main() {
+    return 0;
+}
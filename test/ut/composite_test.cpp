@@ -0,0 +1,124 @@
+// Composite unit tests (structural patching, hot reload of static-body children)
+#include <boost/ut.hpp>
+#include "ymery/plugin_manager.hpp"
+#include "ymery/dispatcher.hpp"
+#include "ymery/data_bag.hpp"
+#include "ymery/frontend/composite.hpp"
+#include "ymery/frontend/widget_factory.hpp"
+#include "ymery/lang.hpp"
+#include "ymery/types.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace boost::ut;
+using namespace ymery;
+namespace fs = std::filesystem;
+
+static const char* PLUGINS_PATH = "plugins";
+
+namespace {
+
+// Composite whose children are built by hand, since the tests run without
+// an ImGui context to render it
+class TestComposite : public Composite {
+public:
+    static std::shared_ptr<TestComposite> make(std::shared_ptr<WidgetFactory> factory,
+                                               std::shared_ptr<Dispatcher> dispatcher,
+                                               std::shared_ptr<DataBag> bag) {
+        auto composite = std::make_shared<TestComposite>();
+        composite->_widget_factory = std::move(factory);
+        composite->_dispatcher = std::move(dispatcher);
+        composite->_namespace = "app";
+        composite->_data_bag = std::move(bag);
+        expect(composite->init().has_value());
+        return composite;
+    }
+
+    Result<void> build() { return _ensure_children(); }
+};
+
+fs::path make_layout_dir(const std::string& name) {
+    auto dir = fs::temp_directory_path() / ("ymery_composite_" + name);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::ofstream(dir / "app.yaml") << R"(
+widgets:
+  title:
+    type: text
+    content: "Hello"
+  footer:
+    type: text
+    content: "Bye"
+  main:
+    type: column
+    body:
+      - app.title
+      - app.footer
+app:
+  root-widget: app.main
+)";
+    return dir;
+}
+
+std::vector<std::string> definitions(const Composite& composite) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < composite.child_count(); ++i) {
+        auto child = composite.child(i);
+        names.push_back(child ? child->definition() : std::string());
+    }
+    return names;
+}
+
+} // namespace
+
+suite composite_tests = [] {
+    "reload_rebuilds_children_from_their_own_spec_after_patching"_test = [] {
+        auto pm = *PluginManager::create(PLUGINS_PATH);
+        auto disp = *Dispatcher::create();
+        auto kernel_res = pm->create_tree("kernel", disp);
+        expect(kernel_res.has_value()) << "Kernel creation failed: " << error_msg(kernel_res);
+        auto kernel = *kernel_res;
+
+        auto lang = Lang::create({make_layout_dir("reload")});
+        expect(lang.has_value()) << "Lang creation failed: " << error_msg(lang);
+        auto factory = *WidgetFactory::create(*lang, disp, kernel, pm);
+
+        std::map<std::string, TreeLikePtr> trees;
+        trees["data"] = kernel;
+        Dict statics;
+        statics["body"] = List{Value(std::string("app.title")), Value(std::string("app.footer"))};
+        auto bag = *DataBag::create(disp, pm, trees, "data", DataPath("/"), statics);
+
+        auto composite = TestComposite::make(factory, disp, bag);
+        expect(!composite->insert_child(0, Value(std::string("app.footer"))).has_value())
+            << "Patching waits for the children to be built";
+        expect(composite->build().has_value());
+        expect(definitions(*composite) == std::vector<std::string>{"app.title", "app.footer"});
+
+        // The body statics stay [title, footer]: the children no longer line up with them
+        expect(composite->insert_child(0, Value(std::string("app.footer"))).has_value());
+        expect(definitions(*composite) == std::vector<std::string>{"app.footer", "app.title", "app.footer"});
+
+        auto title = composite->child(1);
+        auto footer = composite->child(2);
+        expect(composite->reload_definitions({"app.title"}) == 1_ul);
+        expect(definitions(*composite) == std::vector<std::string>{"app.footer", "app.title", "app.footer"})
+            << "The title is rebuilt as a title, not from the body entry at its index";
+        expect(composite->child(1) != title) << "The changed child is a new instance";
+        expect(composite->child(2) == footer) << "Unchanged children are kept";
+
+        // Removals and swaps carry the specs along as well
+        expect(composite->remove_child(0).has_value());
+        expect(composite->swap_children(0, 1).has_value());
+        expect(composite->reload_definitions({"app.footer"}) == 1_ul);
+        expect(definitions(*composite) == std::vector<std::string>{"app.footer", "app.title"});
+
+        expect(composite->replace_child(1, Value(std::string("app.footer"))).has_value());
+        expect(composite->reload_definitions({"app.title"}) == 0_ul);
+        expect(definitions(*composite) == std::vector<std::string>{"app.footer", "app.footer"});
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,394 @@
+// Event task tests (coroutine executor, awaitables, compiled widget event handlers)
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/data_bag.hpp"
+#include "ymery/dispatcher.hpp"
+#include "ymery/backend/async_tree.hpp"
+#include "ymery/frontend/event_task.hpp"
+#include "ymery/frontend/widget.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+using namespace std::chrono_literals;
+
+namespace {
+
+EventTask count_frames(int& steps, int frames) {
+    ++steps;
+    co_await next_frames(frames);
+    ++steps;
+    co_return Ok();
+}
+
+EventTask sleep_then(int& steps, double seconds) {
+    co_await sleep_for(seconds);
+    ++steps;
+    co_return Ok();
+}
+
+EventTask await_value(std::future<Result<int>> future, int& value) {
+    auto res = co_await wait_future(std::move(future));
+    if (!res) co_return Err<void>("await_value: failed", res);
+    value = *res;
+    co_return Ok();
+}
+
+EventTask await_event(std::shared_ptr<Dispatcher> dispatcher, std::string key, Dict& received) {
+    auto event = co_await wait_event(dispatcher, key);
+    if (!event) co_return Err<void>("await_event: failed", event);
+    received = *event;
+    co_return Ok();
+}
+
+// Provider whose listing waits until the test opens it, like a slow device
+class GatedTree : public TreeLike {
+public:
+    std::atomic<int> listings{0};
+    std::atomic<bool> listing{false};
+
+    void open_gate() { _gate.set_value(); }
+    // Wait (bounded) until a listing is under way
+    bool wait_listing() const {
+        for (int i = 0; i < 2000 && !listing; ++i) std::this_thread::sleep_for(1ms);
+        return listing;
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        listing = true;
+        _opened.wait();
+        ++listings;
+        if (path.to_string() == "/missing") return Err<std::vector<std::string>>("GatedTree: no such node");
+        return Ok(std::vector<std::string>{"a", "b"});
+    }
+    Result<Dict> get_metadata(const DataPath&) override { return Ok(Dict{}); }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override { return Ok(std::vector<std::string>{}); }
+    Result<Value> get(const DataPath&) override { return Ok(Value{}); }
+    Result<void> set(const DataPath&, const Value&) override { return Ok(); }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override { return Ok(); }
+    Result<std::string> as_tree(const DataPath& path, int) override { return Ok(path.to_string()); }
+
+private:
+    std::promise<void> _gate;
+    std::shared_future<void> _opened = _gate.get_future().share();
+};
+
+// Passes providers/<name> paths on to one provider, like the kernel
+class ForwardingTree : public TreeLike {
+public:
+    explicit ForwardingTree(TreeLikePtr provider) : _provider(std::move(provider)) {}
+
+    Result<std::pair<TreeLikePtr, DataPath>> forwarding_target(const DataPath& path) override {
+        auto parts = path.as_list();
+        if (parts.size() < 2 || parts[0] != "providers") return TreeLike::forwarding_target(path);
+        return Ok(std::make_pair(_provider, DataPath(std::vector<std::string>(parts.begin() + 2, parts.end()))));
+    }
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        auto parts = path.as_list();
+        if (parts.empty()) return Ok(std::vector<std::string>{"providers"});
+        if (parts.size() == 1) return Ok(std::vector<std::string>{"slow"});
+        return _provider->get_children_names(DataPath(std::vector<std::string>(parts.begin() + 2, parts.end())));
+    }
+    Result<Dict> get_metadata(const DataPath&) override { return Ok(Dict{}); }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override { return Ok(std::vector<std::string>{}); }
+    Result<Value> get(const DataPath&) override { return Ok(Value{}); }
+    Result<void> set(const DataPath&, const Value&) override { return Ok(); }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override { return Ok(); }
+    Result<std::string> as_tree(const DataPath& path, int) override { return Ok(path.to_string()); }
+
+private:
+    TreeLikePtr _provider;
+};
+
+// Widget driven by hand: events fire on request and a "frame" only
+// advances the event tasks, since the tests run without an ImGui context
+class EventWidget : public Widget {
+public:
+    static std::shared_ptr<EventWidget> make(std::shared_ptr<Dispatcher> dispatcher, std::shared_ptr<DataBag> bag) {
+        auto widget = std::make_shared<EventWidget>();
+        widget->_dispatcher = std::move(dispatcher);
+        widget->_data_bag = std::move(bag);
+        expect(widget->init().has_value());
+        return widget;
+    }
+
+    void fire(const std::string& event) { _execute_event_commands(event); }
+    void frame() {
+        _error_messages.clear();
+        _resume_event_tasks();
+    }
+    size_t waiting() const { return _event_tasks.size(); }
+    size_t steps(const std::string& event) const {
+        auto it = _event_handlers.find(event);
+        return it == _event_handlers.end() ? 0 : it->second.steps.size();
+    }
+    const std::vector<std::string>& errors() const { return _error_messages; }
+    void stop() { dispose(); }
+};
+
+std::shared_ptr<DataBag> make_bag(TreeLikePtr tree, std::shared_ptr<Dispatcher> dispatcher, const Dict& statics) {
+    std::map<std::string, TreeLikePtr> trees;
+    trees["data"] = tree;
+    return *DataBag::create(dispatcher, nullptr, trees, "data", DataPath::parse("/"), statics);
+}
+
+// Collects the names of dispatched events
+std::shared_ptr<std::vector<std::string>> record(Dispatcher& dispatcher, const std::string& key) {
+    auto seen = std::make_shared<std::vector<std::string>>();
+    dispatcher.register_event_handler(key, [seen](const Dict& event) -> Result<void> {
+        seen->push_back(*get_as<std::string>(event.at("name")));
+        return Ok();
+    });
+    return seen;
+}
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+suite event_task_tests = [] {
+    "tasks_run_until_they_wait"_test = [] {
+        EventExecutor executor;
+        int steps = 0;
+        expect(executor.spawn("instant", count_frames(steps, 0)).has_value());
+        expect(steps == 2_i) << "Nothing to wait for: finished inside spawn";
+        expect(executor.empty());
+
+        steps = 0;
+        expect(executor.spawn("frames", count_frames(steps, 2)).has_value());
+        expect(steps == 1_i);
+        expect(executor.running("frames"));
+        executor.tick();
+        expect(steps == 1_i);
+        executor.tick();
+        expect(steps == 2_i);
+        expect(executor.empty());
+        expect(executor.frames() == 2_ul);
+    };
+
+    "timers_and_futures_resume_on_a_later_tick"_test = [] {
+        EventExecutor executor;
+        int steps = 0;
+        auto start = std::chrono::steady_clock::now();
+        expect(executor.spawn("sleep", sleep_then(steps, 0.03)).has_value());
+        while (!executor.empty() && ms_since(start) < 1000.0) {
+            executor.tick();
+            std::this_thread::sleep_for(1ms);
+        }
+        expect(steps == 1_i);
+        expect(ms_since(start) >= 30.0);
+
+        std::promise<Result<int>> promise;
+        int value = 0;
+        expect(executor.spawn("future", await_value(promise.get_future(), value)).has_value());
+        executor.tick();
+        expect(value == 0_i);
+        promise.set_value(42);
+        executor.tick();
+        expect(value == 42_i);
+        expect(executor.empty());
+
+        std::promise<Result<int>> failing;
+        expect(executor.spawn("failing", await_value(failing.get_future(), value)).has_value());
+        failing.set_value(Err<int>("no value"));
+        auto failures = executor.tick();
+        expect(failures.size() == 1_ul) << "Failed tasks are reported by tick";
+    };
+
+    "wait_event_holds_a_subscription_only_while_waiting"_test = [] {
+        auto dispatcher = *Dispatcher::create();
+        EventExecutor executor;
+        Dict received;
+        expect(executor.spawn("wait", await_event(dispatcher, "*/ready", received)).has_value());
+
+        dispatcher->dispatch_event(Dict{{"name", Value(std::string("other"))}});
+        executor.tick();
+        expect(executor.running("wait"));
+
+        dispatcher->dispatch_event(Dict{{"source", Value(std::string("device"))},
+                                        {"name", Value(std::string("ready"))}});
+        executor.tick();
+        expect(executor.empty());
+        expect(*get_as<std::string>(received.at("source")) == "device");
+        expect(!dispatcher->unsubscribe_event(1).has_value()) << "Ended with the wait";
+
+        // A cancelled wait drops its subscription too
+        expect(executor.spawn("wait", await_event(dispatcher, "*/never", received)).has_value());
+        executor.cancel();
+        expect(!dispatcher->unsubscribe_event(2).has_value());
+    };
+
+    "widget_handlers_compile_and_wait_across_frames"_test = [] {
+        auto dispatcher = *Dispatcher::create();
+        auto seen = record(*dispatcher, "*/started");
+        auto done = record(*dispatcher, "test/done");
+        auto hovered = record(*dispatcher, "*/hovered");
+
+        Dict handlers{
+            {"on-click", Value(List{
+                Value(Dict{{"dispatch-event", Value(std::string("started"))}}),
+                Value(Dict{{"wait-frames", Value(2)}}),
+                Value(Dict{{"dispatch-event", Value(Dict{{"source", Value(std::string("test"))},
+                                                         {"name", Value(std::string("done"))}})}}),
+            })},
+            {"on-hover", Value(Dict{{"dispatch-event", Value(std::string("hovered"))}})},
+            {"on-bad", Value(List{Value(Dict{{"teleport", Value{}}}), Value(std::string("close"))})},
+        };
+        auto widget = EventWidget::make(dispatcher, make_bag(std::make_shared<GatedTree>(), dispatcher,
+                                                             Dict{{"event-handlers", Value(handlers)}}));
+        expect(widget->steps("on-click") == 3_ul);
+        expect(widget->steps("on-bad") == 1_ul) << "Unknown commands are skipped";
+
+        widget->fire("on-hover");
+        expect(hovered->size() == 1_ul) << "A handler that never waits runs inline";
+        expect(widget->waiting() == 0_ul);
+
+        widget->fire("on-click");
+        expect(seen->size() == 1_ul);
+        expect(widget->waiting() == 1_ul);
+        widget->fire("on-click");
+        expect(seen->size() == 1_ul) << "Not started again while waiting";
+
+        widget->frame();
+        expect(done->empty());
+        widget->frame();
+        expect(done->size() == 1_ul);
+        expect(widget->waiting() == 0_ul);
+
+        widget->fire("on-click");
+        expect(seen->size() == 2_ul);
+        widget->stop();
+        widget->frame();
+        expect(done->size() == 1_ul) << "Disposing the widget drops its tasks";
+    };
+
+    "open_resolves_in_the_background"_test = [] {
+        auto dispatcher = *Dispatcher::create();
+        auto opened = record(*dispatcher, "*/opened");
+        auto tree = std::make_shared<GatedTree>();
+
+        Dict handlers{
+            {"on-click", Value(List{
+                Value(Dict{{"open", Value(std::string("$data@/devices"))}}),
+                Value(Dict{{"dispatch-event", Value(std::string("opened"))}}),
+            })},
+            {"on-fail", Value(Dict{{"open", Value(std::string("@/missing"))}})},
+        };
+        auto widget = EventWidget::make(dispatcher, make_bag(tree, dispatcher, Dict{{"event-handlers", Value(handlers)}}));
+
+        // The provider cannot answer yet, so anything waiting on it would hang here
+        widget->fire("on-click");
+        expect(tree->wait_listing());
+        for (int frame = 0; frame < 3; ++frame) widget->frame();
+        expect(widget->waiting() == 1_ul) << "Frames go on while the open runs";
+        expect(opened->empty());
+
+        tree->open_gate();
+        for (int i = 0; i < 2000 && widget->waiting() > 0; ++i) {
+            std::this_thread::sleep_for(1ms);
+            widget->frame();
+        }
+        expect(opened->size() == 1_ul);
+        expect(tree->listings == 1_i);
+
+        widget->fire("on-fail");
+        for (int i = 0; i < 2000 && widget->waiting() > 0; ++i) {
+            std::this_thread::sleep_for(1ms);
+            widget->frame();
+        }
+        expect(widget->errors().size() == 1_ul) << "A failed open shows in the widget";
+    };
+
+    "open_lists_under_the_tree_lock"_test = [] {
+        auto tree = std::make_shared<GatedTree>();
+        tree->open_gate();
+        std::unique_lock held(tree->access_mutex());
+        auto future = open_data_path(tree, DataPath::parse("/devices"));
+        std::this_thread::sleep_for(20ms);
+        expect(tree->listings == 0_i) << "The worker waits for the tree lock";
+
+        held.unlock();
+        expect(future.get().has_value());
+        expect(tree->listings == 1_i);
+
+        expect(!open_data_path(nullptr, DataPath::parse("/")).get().has_value());
+    };
+
+    "open_through_the_kernel_locks_only_the_provider"_test = [] {
+        auto provider = std::make_shared<GatedTree>();
+        auto kernel = std::make_shared<ForwardingTree>(provider);
+
+        auto future = open_data_path(kernel, DataPath::parse("/providers/slow/devices"));
+        expect(provider->wait_listing());
+        {
+            std::unique_lock kernel_lock(kernel->access_mutex(), std::try_to_lock);
+            expect(kernel_lock.owns_lock()) << "The kernel stays readable while the provider opens";
+            std::unique_lock provider_lock(provider->access_mutex(), std::try_to_lock);
+            expect(!provider_lock.owns_lock()) << "The provider is listed under its own lock";
+        }
+
+        provider->open_gate();
+        auto names = future.get();
+        expect(names.has_value() && names->size() == 2_ul);
+    };
+
+    "open_through_an_async_provider_waits_for_its_answer"_test = [] {
+        auto dispatcher = *Dispatcher::create();
+        auto opened = record(*dispatcher, "*/opened");
+        auto provider = std::make_shared<GatedTree>();
+        auto async = *AsyncTree::create(provider, "slow", 1.0, 1);
+        auto kernel = std::make_shared<ForwardingTree>(async);
+
+        Dict handlers{{"on-click", Value(List{
+            Value(Dict{{"open", Value(std::string("@/providers/slow/devices"))}}),
+            Value(Dict{{"dispatch-event", Value(std::string("opened"))}}),
+        })}};
+        auto bag = make_bag(kernel, dispatcher, Dict{{"event-handlers", Value(handlers)}});
+        auto widget = EventWidget::make(dispatcher, bag);
+
+        widget->fire("on-click");
+        expect(provider->wait_listing());
+        widget->frame();
+        expect(widget->waiting() == 1_ul) << "A pending listing is waited for, not an error";
+        expect(widget->errors().empty());
+
+        // The UI reads the kernel, and the async provider from its cache
+        auto root = bag->get_children_names();
+        expect(root.has_value() && root->size() == 1_ul);
+        auto branch = bag->inherit("@/providers", Dict{});
+        expect(branch.has_value() && (*branch)->get_children_names().has_value());
+        auto devices = bag->inherit("@/providers/slow/devices", Dict{});
+        expect(devices.has_value() && !(*devices)->get_children_names().has_value()) << "Still pending";
+
+        provider->open_gate();
+        for (int i = 0; i < 2000 && widget->waiting() > 0; ++i) {
+            std::this_thread::sleep_for(1ms);
+            widget->frame();
+        }
+        expect(opened->size() == 1_ul);
+        expect(widget->errors().empty());
+        expect(provider->listings == 1_i) << "The open and the pending read share one fetch";
+        expect(async->dispose().has_value());
+    };
+
+    "open_of_an_unknown_tree_fails_before_posting"_test = [] {
+        auto dispatcher = *Dispatcher::create();
+        auto tree = std::make_shared<GatedTree>();
+        Dict handlers{{"on-click", Value(Dict{{"open", Value(std::string("$nope@/devices"))}})}};
+        auto widget = EventWidget::make(dispatcher, make_bag(tree, dispatcher, Dict{{"event-handlers", Value(handlers)}}));
+
+        widget->fire("on-click");
+        widget->frame();
+        expect(widget->waiting() == 0_ul) << "Nothing is left waiting on a worker";
+        expect(tree->listings == 0_i);
+    };
+};
+
+int main() {
+    return 0;
+}
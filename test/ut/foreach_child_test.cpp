@@ -49,7 +49,7 @@ suite foreach_child_tests = [] {
         expect(children_res.has_value()) << "get_children_names failed: " << error_msg(children_res);
 
         auto children = *children_res;
-        expect(children.size() == 3_ul) << "Expected 3 children at root, got " << children.size();
+        expect(children.size() == 4_ul) << "Expected 4 children at root, got " << children.size();
 
         bool has_providers = std::find(children.begin(), children.end(), "providers") != children.end();
         expect(has_providers) << "Missing 'providers' in children";
@@ -163,7 +163,7 @@ suite foreach_child_tests = [] {
         auto root_children_res = bag->get_children_names();
         expect(root_children_res.has_value());
         auto root_children = *root_children_res;
-        expect(root_children.size() == 3_ul) << "Root should have 3 children";
+        expect(root_children.size() == 4_ul) << "Root should have 4 children";
 
         // Navigate to each child and verify we can get their children
         for (const auto& child_name : root_children) {
@@ -209,7 +209,7 @@ suite foreach_child_tests = [] {
         auto children_res = root_bag->get_children_names();
         expect(children_res.has_value()) << "get_children_names at root failed: " << error_msg(children_res);
         auto children = *children_res;
-        expect(children.size() == 3_ul) << "Expected 3 children at root, got " << children.size();
+        expect(children.size() == 4_ul) << "Expected 4 children at root, got " << children.size();
 
         // Step 2: For each child, create a child DataBag via inherit (like foreach-child does)
         for (const auto& child_name : children) {
@@ -291,7 +291,7 @@ suite foreach_child_tests = [] {
         // Verify children exist to iterate
         auto children_res = bag->get_children_names();
         expect(children_res.has_value()) << "get_children_names failed";
-        expect(children_res->size() == 3_ul) << "Should have 3 children (providers, settings, windows)";
+        expect(children_res->size() == 4_ul) << "Should have 4 children (providers, settings, windows, threads)";
     };
 
     "composite_widget_with_foreach_child_has_correct_setup"_test = [] {
@@ -345,13 +345,13 @@ suite foreach_child_tests = [] {
         expect(first_opt.has_value()) << "First item is not a dict";
         expect(first_opt->count("foreach-child") > 0_ul) << "foreach-child key missing";
 
-        // Verify kernel provides 3 children at root
+        // Verify kernel provides 4 children at root
         auto children_names_res = bag->get_children_names();
         expect(children_names_res.has_value()) << "get_children_names failed";
         auto children_names = *children_names_res;
-        expect(children_names.size() == 3_ul) << "Kernel root should have 3 children, got " << children_names.size();
+        expect(children_names.size() == 4_ul) << "Kernel root should have 4 children, got " << children_names.size();
 
-        // Verify children are: providers, settings, windows
+        // Verify children are: providers, settings, windows, threads
         bool has_providers = std::find(children_names.begin(), children_names.end(), "providers") != children_names.end();
         bool has_settings = std::find(children_names.begin(), children_names.end(), "settings") != children_names.end();
         bool has_windows = std::find(children_names.begin(), children_names.end(), "windows") != children_names.end();
@@ -682,7 +682,7 @@ suite foreach_child_tests = [] {
         // Level 1: Root composite - foreach-child over root children
         auto root_bag = *DataBag::create(disp, pm, trees, "data", DataPath("/"), {});
         auto root_children = *root_bag->get_children_names();
-        expect(root_children.size() == 3_ul) << "root has providers, settings, windows";
+        expect(root_children.size() == 4_ul) << "root has providers, settings, windows, threads";
 
         // Level 2: For "providers" child, create child bag via inherit
         auto providers_bag = *root_bag->inherit("providers", {});
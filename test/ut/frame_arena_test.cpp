@@ -0,0 +1,296 @@
+// Frame arena unit tests - the arena itself, DataBag's non-copying reads,
+// and a rendered layout of the basic widgets that must not allocate once
+// it has reached steady state
+#include <boost/ut.hpp>
+#include "ymery/plugin_manager.hpp"
+#include "ymery/dispatcher.hpp"
+#include "ymery/data_bag.hpp"
+#include "ymery/frontend/frame_arena.hpp"
+#include "ymery/frontend/widget_factory.hpp"
+#include "ymery/lang.hpp"
+#include "ymery/types.hpp"
+#include <imgui.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+
+using namespace boost::ut;
+using namespace ymery;
+namespace fs = std::filesystem;
+
+static const char* PLUGINS_PATH = "plugins";
+
+// Count every heap allocation made through operator new. ImGui allocates
+// through its own allocator and keeps its buffers across frames.
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Data tree holding values by key, answering get() without allocating, so
+// the counts below cover the widgets and DataBag rather than a provider
+class ValuesTree : public TreeLike {
+public:
+    Dict values;
+    std::atomic<int> gets{0};
+
+    Result<Value> get(const DataPath& path) override {
+        ++gets;
+        if (path.is_root()) return Ok(Value{});
+        auto it = values.find(path.as_list().back());
+        return Ok(it != values.end() ? it->second : Value{});
+    }
+    Result<void> set(const DataPath& path, const Value& value) override {
+        if (path.is_root()) return Err<void>("ValuesTree: empty key");
+        values[path.as_list().back()] = value;
+        return Ok();
+    }
+    Result<std::vector<std::string>> get_children_names(const DataPath&) override {
+        return Ok(std::vector<std::string>{});
+    }
+    Result<Dict> get_metadata(const DataPath&) override { return Ok(Dict{}); }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override {
+        return Ok(std::vector<std::string>{});
+    }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override { return Ok(); }
+    Result<std::string> as_tree(const DataPath& path, int) override { return Ok(path.to_string()); }
+};
+
+// The basic-widgets test layout, with labels long enough to defeat the
+// small string optimization; the checkbox and combo read their value from
+// the data tree
+fs::path make_layout_dir() {
+    auto dir = fs::temp_directory_path() / "ymery_frame_arena";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::ofstream(dir / "app.yaml") << R"(
+widgets:
+  window:
+    type: imgui.window
+  text:
+    type: imgui.text
+  button:
+    type: imgui.button
+  checkbox:
+    type: imgui.checkbox
+  slider-int:
+    type: imgui.slider-int
+  slider-float:
+    type: imgui.slider-float
+  input-text:
+    type: imgui.input-text
+  combo:
+    type: imgui.combo
+
+  test-window:
+    type: imgui.window
+    title: Basic widgets allocation test
+    body:
+      - text:
+          label: "Basic widgets rendered every frame"
+      - button:
+          label: "A button with a long enough label"
+      - checkbox:
+          label: "A checkbox with a long enough label"
+      - slider-int:
+          label: "A slider-int with a long enough label"
+          min: 0
+          max: 100
+          value: 50
+      - slider-float:
+          label: "A slider-float with a long enough label"
+          min: 0.0
+          max: 1.0
+          value: 0.5
+      - input-text:
+          label: "An input-text with a long enough label"
+          value: "initial text, longer than a small string"
+      - combo:
+          label: "A combo with a long enough label"
+          items:
+            - First option of the combo box
+            - Second option of the combo box
+            - Third option of the combo box
+app:
+  root-widget: app.test-window
+)";
+    return dir;
+}
+
+} // namespace
+
+suite frame_arena_tests = [] {
+    "frame_arena_concat_builds_imgui_id"_test = [] {
+        FrameArena arena(256);
+        const char* id = arena.concat("Volume", "###42");
+        expect(std::strcmp(id, "Volume###42") == 0);
+        const char* empty = arena.concat("", "###42");
+        expect(std::strcmp(empty, "###42") == 0);
+        expect(std::strcmp(id, "Volume###42") == 0) << "Earlier strings stay valid within a frame";
+    };
+
+    "frame_arena_respects_alignment"_test = [] {
+        FrameArena arena(1024);
+        arena.allocate(1, 1);
+        auto doubles = arena.alloc_array<double>(4);
+        expect(reinterpret_cast<uintptr_t>(doubles.data()) % alignof(double) == 0_ul);
+        void* wide = arena.allocate(16, 64);
+        expect(reinterpret_cast<uintptr_t>(wide) % 64 == 0_ul);
+    };
+
+    "frame_arena_grows_after_overflow"_test = [] {
+        FrameArena arena(128);
+        auto big = arena.alloc_array<double>(1000);
+        expect(big.size() == 1000_ul);
+        big[999] = 1.0;  // overflow block must be usable
+        expect(arena.capacity() == 128_ul) << "Capacity only changes on reset";
+
+        arena.reset();
+        expect(arena.capacity() >= 8000_ul) << "Reset should fold the overflow into the main block";
+        expect(arena.used() == 0_ul);
+
+        arena.alloc_array<double>(1000);
+        size_t before = g_allocations.load();
+        arena.reset();
+        arena.alloc_array<double>(1000);
+        expect(g_allocations.load() - before == 0_ul) << "A frame that fits does not allocate";
+    };
+
+    "data_bag_read_matches_get_without_copying"_test = [] {
+        auto tree = std::make_shared<ValuesTree>();
+        tree->values["volume"] = Value(0.25);
+        tree->values["enabled"] = Value(true);
+        tree->values["name"] = Value(std::string("A name long enough to defeat the small string optimization"));
+
+        Dict statics;
+        statics["label"] = Value(std::string("A label long enough to defeat the small string optimization"));
+        statics["level"] = Value(std::string("@/volume"));
+        statics["count"] = Value(3);
+        std::map<std::string, TreeLikePtr> trees{{"data", tree}};
+        auto bag = *DataBag::create(nullptr, nullptr, trees, "data", DataPath::root(), statics);
+
+        std::string label, name;
+        double level = 0.0;
+        bool enabled = false;
+        int count = 0;
+        auto read_all = [&] {
+            return bag->read("label", label) && bag->read("level", level) && bag->read("enabled", enabled)
+                && bag->read("count", count);
+        };
+        expect(read_all());
+        // A string from the tree comes back in a copy made by TreeLike::get
+        expect(bag->read("name", name));
+        expect(label == *get_ptr<std::string>(*bag->get("label")));
+        expect(level == 0.25_d) << "References are read through the tree";
+        expect(enabled) << "Keys missing from the statics are read from the tree";
+        expect(count == 3_i);
+        expect(name == *get_ptr<std::string>(tree->values["name"]));
+
+        expect(!bag->read("count", label)) << "A value of another type is not read";
+        expect(!bag->read("missing", count));
+        expect(count == 3_i) << "A failed read leaves the output alone";
+        expect(bag->find_static("label") == bag->find_static("label"));
+        expect(bag->find_static("missing") == nullptr);
+
+        // Once the outputs hold their strings, reads reuse them
+        size_t before = g_allocations.load();
+        bool read = true;
+        for (int frame = 0; frame < 100; ++frame) {
+            read = read_all() && read;
+        }
+        size_t allocations = g_allocations.load() - before;
+        expect(read);
+        expect(allocations == 0_ul) << "Reads allocated " << allocations << " times";
+    };
+
+    "basic_widgets_layout_frames_do_not_allocate"_test = [] {
+        auto pm = *PluginManager::create(PLUGINS_PATH);
+        auto disp = *Dispatcher::create();
+        auto tree = std::make_shared<ValuesTree>();
+        tree->values["value"] = Value(true);
+
+        auto lang = Lang::create({make_layout_dir()});
+        expect(lang.has_value()) << "Lang creation failed: " << error_msg(lang);
+        auto factory = *WidgetFactory::create(*lang, disp, tree, pm);
+        auto root_res = factory->create_root_widget();
+        expect(root_res.has_value()) << "Root widget creation failed: " << error_msg(root_res);
+        auto root = *root_res;
+
+        // Headless ImGui, as in the GUI tests
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(1280, 720);
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        io.Fonts->SetTexID((ImTextureID)(intptr_t)1);  // Dummy texture ID
+
+        // One frame as EmbeddedApp::render_widgets runs it
+        auto frame = [&] {
+            io.DeltaTime = 1.0f / 60.0f;
+            ImGui::NewFrame();
+            frame_arena().reset();
+            auto res = root->render();
+            ImGui::Render();
+            return res.has_value();
+        };
+
+        // The first frames build the children, ImGui windows and read targets
+        for (int i = 0; i < 10; ++i) {
+            expect(frame());
+        }
+
+        size_t before = g_allocations.load();
+        int gets = tree->gets;
+        bool rendered = true;
+        for (int i = 0; i < 100; ++i) {
+            rendered = frame() && rendered;
+        }
+        size_t allocations = g_allocations.load() - before;
+
+        expect(rendered);
+        expect(allocations == 0_ul) << "Steady-state frames allocated " << allocations << " times";
+        expect(tree->gets > gets) << "Values were read from the data tree every frame";
+        expect(ImGui::GetDrawData()->TotalVtxCount > 0) << "The layout drew something";
+
+        root->dispose();
+        ImGui::DestroyContext();
+    };
+
+    "get_ptr_borrows_without_copy"_test = [] {
+        Value label(std::string("Another label long enough to defeat the small string optimization"));
+
+        size_t before = g_allocations.load();
+        const std::string* borrowed = get_ptr<std::string>(label);
+        size_t borrow_allocations = g_allocations.load() - before;
+        expect(borrowed != nullptr);
+        expect(borrow_allocations == 0_ul);
+        expect(get_ptr<double>(label) == nullptr) << "Type mismatch should yield nullptr";
+
+        before = g_allocations.load();
+        auto copied = get_as<std::string>(label);
+        expect(g_allocations.load() - before > 0_ul) << "get_as copies the string";
+        expect(*copied == *borrowed);
+    };
+};
+
+int main() {
+    return 0;
+}
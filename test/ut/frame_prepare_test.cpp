@@ -0,0 +1,170 @@
+// Frame prepare phase unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/data_bag.hpp"
+#include "ymery/frontend/widget.hpp"
+#include "ymery/frontend/frame_prepare.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+// Tree that records how many calls are inside it at once
+class CountingTree : public TreeLike {
+public:
+    std::atomic<int> inside{0};
+    std::atomic<int> max_inside{0};
+    std::atomic<int> calls{0};
+
+    Result<std::vector<std::string>> get_children_names(const DataPath&) override { return Ok(std::vector<std::string>{}); }
+    Result<Dict> get_metadata(const DataPath&) override { return Ok(Dict{}); }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override { return Ok(std::vector<std::string>{}); }
+    Result<Value> get(const DataPath& path) override {
+        int now = ++inside;
+        int seen = max_inside.load();
+        while (now > seen && !max_inside.compare_exchange_weak(seen, now)) {}
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        ++calls;
+        --inside;
+        return Ok(Value(path.filename()));
+    }
+    Result<void> set(const DataPath&, const Value&) override { return Ok(); }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override { return Ok(); }
+    Result<std::string> as_tree(const DataPath& path, int) override { return Ok(path.to_string()); }
+};
+
+// Widget that records its prepare calls; "rendering" only marks it, since
+// the tests run without an ImGui context
+class PrepWidget : public Widget {
+public:
+    static std::shared_ptr<PrepWidget> make(std::shared_ptr<DataBag> bag, bool prepares = true) {
+        auto widget = std::make_shared<PrepWidget>();
+        widget->_data_bag = bag;
+        widget->_prepares = prepares;
+        return widget;
+    }
+
+    void set_body(WidgetPtr body) { _body = std::move(body); }
+    void mark_rendered() { _rendered = true; }
+    Result<void> take() { return _take_prepared(); }
+
+    std::atomic<int> prepares{0};
+    std::thread::id thread;
+    std::string fetched;
+    bool fail = false;
+
+protected:
+    bool _prepares_data() const override { return _prepares; }
+
+    Result<void> _prepare_head() override {
+        ++prepares;
+        thread = std::this_thread::get_id();
+        if (fail) return Err<void>("PrepWidget: failed on purpose");
+        if (auto res = _data_bag->get("value"); res) {
+            if (auto s = get_ptr<std::string>(*res)) fetched = *s;
+        }
+        return Ok();
+    }
+
+private:
+    bool _prepares = true;
+};
+
+std::shared_ptr<DataBag> make_bag(TreeLikePtr tree) {
+    std::map<std::string, TreeLikePtr> trees;
+    if (tree) trees["data"] = tree;
+    return *DataBag::create(nullptr, nullptr, trees, tree ? "data" : "", DataPath::parse("/"), Dict{});
+}
+
+// Chain of widgets linked through their bodies, all marked rendered
+std::vector<std::shared_ptr<PrepWidget>> make_chain(size_t count, std::shared_ptr<DataBag> bag) {
+    std::vector<std::shared_ptr<PrepWidget>> chain;
+    for (size_t i = 0; i < count; ++i) {
+        chain.push_back(PrepWidget::make(bag));
+        chain.back()->mark_rendered();
+        if (i > 0) chain[i - 1]->set_body(chain[i]);
+    }
+    return chain;
+}
+
+} // namespace
+
+suite frame_prepare_tests = [] {
+    "prepare_collects_only_rendered_widgets"_test = [] {
+        auto bag = make_bag(nullptr);
+        auto root = PrepWidget::make(bag, false);
+        auto shown = PrepWidget::make(bag);
+        auto hidden = PrepWidget::make(bag);
+        root->set_body(shown);
+        shown->set_body(hidden);
+        root->mark_rendered();
+        shown->mark_rendered();
+
+        FramePreparer preparer(0);
+        expect(preparer.run(*root) == 1_ul) << "Only the rendered widget that prepares data";
+        expect(shown->prepares == 1_i);
+        expect(hidden->prepares == 0_i);
+
+        // Nothing was rendered since the last run
+        expect(preparer.run(*root) == 0_ul);
+    };
+
+    "prepare_runs_each_widget_once_on_workers"_test = [] {
+        // The tree's delay keeps the UI thread from draining the whole list alone
+        auto bag = make_bag(std::make_shared<CountingTree>());
+        auto chain = make_chain(200, bag);
+
+        FramePreparer preparer(3);
+        expect(preparer.threads() == 3_ul);
+        expect(preparer.run(*chain[0]) == 200_ul);
+
+        size_t off_ui_thread = 0;
+        for (const auto& widget : chain) {
+            expect(widget->prepares == 1_i);
+            if (widget->thread != std::this_thread::get_id()) ++off_ui_thread;
+        }
+        expect(off_ui_thread > 0_ul) << "Workers took no part";
+
+        // Submit uses the prepared result without fetching again
+        for (const auto& widget : chain) {
+            expect(widget->take().has_value());
+            expect(widget->prepares == 1_i);
+        }
+    };
+
+    "take_prepared_fetches_inline_and_reports_errors"_test = [] {
+        auto bag = make_bag(nullptr);
+        auto widget = PrepWidget::make(bag);
+        expect(widget->take().has_value()) << "First frame prepares inline";
+        expect(widget->prepares == 1_i);
+
+        widget->fail = true;
+        widget->prepare();
+        expect(!widget->take().has_value()) << "Prepare error reaches the submit phase";
+        expect(widget->prepares == 2_i);
+    };
+
+    "prepare_serializes_calls_into_one_tree"_test = [] {
+        auto tree = std::make_shared<CountingTree>();
+        auto bag = make_bag(tree);
+        auto chain = make_chain(64, bag);
+
+        FramePreparer preparer(4);
+        for (int frame = 0; frame < 3; ++frame) {
+            for (const auto& widget : chain) widget->mark_rendered();
+            expect(preparer.run(*chain[0]) == 64_ul);
+        }
+        expect(tree->calls == 192_i);
+        expect(tree->max_inside == 1_i) << "Tree entered by two threads at once";
+        expect(chain.back()->fetched == "value");
+    };
+};
+
+int main() {
+    return 0;
+}
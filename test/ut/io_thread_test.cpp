@@ -0,0 +1,178 @@
+// I/O thread service unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_stats.hpp"
+#include "ymery/backend/io_thread.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+
+// Watchdog off, so tests drive scan() themselves
+IoThreadConfig manual_config() {
+    IoThreadConfig config;
+    config.watchdog_ms = 0;
+    return config;
+}
+
+} // namespace
+
+suite io_thread_tests = [] {
+    "policy_names_round_trip"_test = [] {
+        for (auto policy : {IoSchedPolicy::Other, IoSchedPolicy::Fifo, IoSchedPolicy::RoundRobin}) {
+            auto parsed = io_sched_policy_from_string(io_sched_policy_name(policy));
+            expect(parsed.has_value());
+            expect(*parsed == policy);
+        }
+        expect(*io_sched_policy_from_string("default") == IoSchedPolicy::Other);
+        expect(!io_sched_policy_from_string("deadline").has_value());
+    };
+
+    "period_of_frames"_test = [] {
+        expect(io_period_ns(480, 48000) == 10 * MS);
+        expect(io_period_ns(1024, 0) == 0_ll);
+    };
+
+    "beats_count_missed_deadlines"_test = [] {
+        IoThreadMonitor monitor("test", 2 * MS, 1.5);
+        monitor.beat();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        monitor.beat();
+        expect(monitor.cycles() == 2_ull);
+        expect(monitor.missed_deadlines() == 0_ull);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        monitor.beat();
+        expect(monitor.missed_deadlines() == 1_ull);
+        expect(monitor.max_lateness_ns() >= 8 * MS) << monitor.max_lateness_ns();
+
+        // A driver that grows its buffer moves the deadline with it
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        monitor.beat(20 * MS);
+        expect(monitor.missed_deadlines() == 1_ull);
+        expect(monitor.period_ns() == 20 * MS);
+    };
+
+    "deferred_log_is_bounded"_test = [] {
+        IoThreadMonitor monitor("test", MS);
+        for (int i = 0; i < 200; ++i) {
+            monitor.defer_log(IoLogLevel::Warn, "overrun", i);
+        }
+        expect(monitor.dropped_logs() > 0_ull);
+        expect(monitor.dropped_logs() < 200_ull);
+    };
+
+    "registration_makes_names_unique"_test = [] {
+        auto& service = IoThreadService::instance();
+        expect(service.configure(manual_config()).has_value());
+        auto a = service.register_thread("alsa:hw:0", MS);
+        auto b = service.register_thread("alsa:hw:0", MS);
+        expect(a->name() == "alsa:hw:0");
+        expect(b->name() == "alsa:hw:0#2");
+        expect(service.find("alsa:hw:0#2") == b);
+
+        service.unregister_thread(a);
+        service.unregister_thread(b);
+        expect(service.find("alsa:hw:0") == nullptr);
+        expect(service.threads().empty());
+    };
+
+    "scan_flags_stalls_and_drains_logs"_test = [] {
+        auto& service = IoThreadService::instance();
+        expect(service.configure(manual_config()).has_value());
+        auto monitor = service.register_thread("stuck", MS);
+        monitor->beat();
+        monitor->defer_log(IoLogLevel::Info, "started");
+
+        const int64_t now = audio_now_ns();
+        service.scan(now);
+        expect(!monitor->stalled());
+
+        // Well past tolerance x stall deadlines: flagged once per episode
+        service.scan(now + 100 * MS);
+        service.scan(now + 200 * MS);
+        expect(monitor->stalled());
+        expect(monitor->stalls() == 1_ull);
+
+        monitor->beat();
+        expect(!monitor->stalled());
+        service.unregister_thread(monitor);
+    };
+
+    "io_thread_runs_registered_and_unregisters"_test = [] {
+        auto& service = IoThreadService::instance();
+        expect(service.configure(manual_config()).has_value());
+
+        std::atomic<bool> running{true};
+        std::atomic<int> cycles{0};
+        IoThread thread;
+        thread.start("loop", MS, [&] {
+            while (running) {
+                thread.beat();
+                cycles.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+        });
+        while (cycles.load() < 5) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto monitor = service.find("loop");
+        expect(monitor != nullptr);
+        expect(monitor->cycles() >= 5_ull);
+
+        auto info = monitor->to_dict();
+        expect(*get_as<std::string>(info["scheduling"]) == "other");
+        expect(*get_as<int64_t>(info["thread-id"]) != 0_ll);
+
+        running = false;
+        thread.join();
+        expect(service.find("loop") == nullptr);
+    };
+
+    "refused_real_time_keeps_running"_test = [] {
+        // Unprivileged test runs get EPERM for SCHED_FIFO: the thread still
+        // runs and reports why; privileged runs report fifo
+        auto& service = IoThreadService::instance();
+        auto config = manual_config();
+        config.policy = IoSchedPolicy::Fifo;
+        config.priority = 10;
+        expect(service.configure(config).has_value());
+
+        std::atomic<bool> ran{false};
+        IoThread thread;
+        thread.start("fifo", MS, [&] { ran = true; });
+        auto monitor = thread.monitor();
+        thread.join();
+        expect(ran.load());
+
+        auto scheduling = *get_as<std::string>(monitor->to_dict()["scheduling"]);
+        expect(scheduling == "fifo" || scheduling.starts_with("other (fifo refused")) << scheduling;
+        expect(service.configure(manual_config()).has_value());
+    };
+
+    "configure_rejects_tolerance_below_one"_test = [] {
+        auto config = manual_config();
+        config.deadline_tolerance = 0.5;
+        expect(!IoThreadService::instance().configure(config).has_value());
+    };
+
+    "service_dict_totals"_test = [] {
+        auto& service = IoThreadService::instance();
+        expect(service.configure(manual_config()).has_value());
+        auto a = service.register_thread("a", MS);
+        auto dict = service.to_dict();
+        expect(*get_as<int64_t>(dict["num-threads"]) == 1_ll);
+        expect(*get_as<std::string>(dict["policy"]) == "other");
+        service.unregister_thread(a);
+    };
+};
+
+int main() {
+    return 0;
+}
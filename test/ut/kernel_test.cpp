@@ -31,21 +31,23 @@ suite kernel_tests = [] {
         expect(kernel_res.has_value()) << "Kernel creation failed: " << error_msg(kernel_res);
         auto kernel = *kernel_res;
 
-        // Test: get_children_names at root should return ["providers", "settings", "windows"]
+        // Test: get_children_names at root should return ["providers", "settings", "windows", "threads"]
         auto children_res = kernel->get_children_names(DataPath("/"));
         expect(children_res.has_value()) << "get_children_names('/') failed";
 
         auto children = *children_res;
-        expect(children.size() == 3_ul) << "Expected 3 children at root, got " << children.size();
+        expect(children.size() == 4_ul) << "Expected 4 children at root, got " << children.size();
 
-        // Check that providers, settings, windows are present
+        // Check that providers, settings, windows, threads are present
         bool has_providers = std::find(children.begin(), children.end(), "providers") != children.end();
         bool has_settings = std::find(children.begin(), children.end(), "settings") != children.end();
         bool has_windows = std::find(children.begin(), children.end(), "windows") != children.end();
+        bool has_threads = std::find(children.begin(), children.end(), "threads") != children.end();
 
         expect(has_providers) << "Missing 'providers' in root children";
         expect(has_settings) << "Missing 'settings' in root children";
         expect(has_windows) << "Missing 'windows' in root children";
+        expect(has_threads) << "Missing 'threads' in root children";
     };
 
     "kernel_get_children_names_providers"_test = [] {
@@ -0,0 +1,145 @@
+// Lang hot reload unit tests
+#include <boost/ut.hpp>
+#include "ymery/lang.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace boost::ut;
+using namespace ymery;
+namespace fs = std::filesystem;
+
+// Write a module and move its mtime forward so the change is seen even on
+// filesystems with coarse timestamps
+static void write_module(const fs::path& path, const std::string& content) {
+    bool existed = fs::exists(path);
+    auto previous = existed ? fs::last_write_time(path) : fs::file_time_type{};
+    std::ofstream(path) << content;
+    if (existed) fs::last_write_time(path, previous + std::chrono::seconds(1));
+}
+
+static fs::path make_layout_dir(const std::string& name) {
+    auto dir = fs::temp_directory_path() / ("ymery_lang_reload_" + name);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    write_module(dir / "app.yaml", R"(
+import:
+  - shared
+widgets:
+  main:
+    type: column
+    body:
+      - shared.title
+app:
+  root-widget: app.main
+)");
+    write_module(dir / "shared.yaml", R"(
+widgets:
+  title:
+    type: text
+    content: "Hello"
+  footer:
+    type: text
+    content: "Bye"
+)");
+    return dir;
+}
+
+suite lang_reload_tests = [] {
+    "lang_reload_without_edits_is_empty"_test = [] {
+        auto dir = make_layout_dir("noop");
+        auto lang = Lang::create({dir});
+        expect(lang.has_value());
+        expect((*lang)->module_files().size() == 2_ul);
+
+        auto changes = (*lang)->reload_changed();
+        expect(changes.has_value());
+        expect(changes->empty());
+        expect(changes->modules.empty());
+    };
+
+    "lang_reload_reports_only_changed_definitions"_test = [] {
+        auto dir = make_layout_dir("changed");
+        auto lang = *Lang::create({dir});
+
+        // footer is re-saved unchanged, title is edited
+        write_module(dir / "shared.yaml", R"(
+widgets:
+  title:
+    type: text
+    content: "Hello again"
+  footer:
+    type: text
+    content: "Bye"
+)");
+        auto changes = lang->reload_changed();
+        expect(changes.has_value());
+        expect(changes->modules.size() == 1_ul);
+        expect(changes->widgets.size() == 1_ul);
+        expect(changes->widgets.count("shared.title") == 1_ul);
+        expect(!changes->app);
+
+        auto content = get_as<std::string>(lang->widget_definitions().at("shared.title").at("content"));
+        expect(content && *content == "Hello again");
+
+        expect(lang->reload_changed()->empty()) << "Nothing changed since the last reload";
+    };
+
+    "lang_reload_tracks_removed_and_imported_modules"_test = [] {
+        auto dir = make_layout_dir("imports");
+        auto lang = *Lang::create({dir});
+
+        write_module(dir / "extra.yaml", R"(
+widgets:
+  panel:
+    type: text
+)");
+        write_module(dir / "shared.yaml", R"(
+import:
+  - extra
+widgets:
+  title:
+    type: text
+    content: "Hello"
+)");
+        auto changes = lang->reload_changed();
+        expect(changes.has_value());
+        expect(changes->widgets.count("shared.footer") == 1_ul) << "Removed definition";
+        expect(changes->widgets.count("extra.panel") == 1_ul) << "Newly imported module";
+        expect(changes->widgets.count("shared.title") == 0_ul);
+        expect(lang->widget_definitions().count("shared.footer") == 0_ul);
+        expect(lang->module_files().size() == 3_ul);
+    };
+
+    "lang_reload_keeps_definitions_on_parse_error"_test = [] {
+        auto dir = make_layout_dir("broken");
+        auto lang = *Lang::create({dir});
+
+        write_module(dir / "shared.yaml", "widgets: [unclosed\n");
+        auto changes = lang->reload_changed();
+        expect(changes.has_value());
+        expect(changes->errors.size() == 1_ul);
+        expect(changes->widgets.empty());
+        expect(lang->widget_definitions().count("shared.title") == 1_ul);
+
+        write_module(dir / "app.yaml", R"(
+import:
+  - shared
+widgets:
+  main:
+    type: column
+app:
+  root-widget: app.main
+  data-tree: data-tree
+)");
+        changes = lang->reload_changed();
+        expect(changes->app);
+        expect(changes->widgets.count("app.main") == 1_ul);
+        expect(changes->errors.empty()) << "The broken module is only retried after another save";
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Editor layout model change-record and undo/redo tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/plugins/frontend/editor/shared_model.hpp"
+
+using namespace boost::ut;
+using namespace ymery;
+using namespace ymery::plugins;
+
+suite layout_model_tests = [] {
+    "layout_model_records_inserts"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        auto base = model.version();
+
+        model.add_child({}, "button");
+        model.add_child({}, "text", true);
+
+        auto changes = model.changes_since(base);
+        expect(changes.has_value());
+        expect(changes->size() == 3_ul) << "button, same-line marker, text";
+        expect((*changes)[0].kind == LayoutChangeKind::Insert);
+        expect((*changes)[0].path == SelectionPath{0});
+        expect((*changes)[1].path == SelectionPath{1});
+        expect((*changes)[1].node->type() == "same-line");
+        expect((*changes)[2].path == SelectionPath{2});
+        expect((*changes)[2].uid == (*changes)[2].node->uid());
+        expect((*changes)[2].ancestors.size() == 1_ul);
+        expect((*changes)[2].ancestors[0] == SharedLayoutModel::get_uid(model.root()));
+
+        expect(model.changes_since(model.version())->empty());
+    };
+
+    "layout_model_records_nested_edits"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        model.add_child({}, "row");
+        model.add_child({0}, "button");
+        model.add_child({0}, "checkbox");
+        auto base = model.version();
+
+        model.insert_before({0, 1}, "slider-float");
+        model.set_label_at({0, 0}, "Go");
+        model.move_down({0, 0});
+        model.remove({0, 2});
+
+        auto changes = model.changes_since(base);
+        expect(changes.has_value());
+        expect(changes->size() == 4_ul);
+
+        const auto& insert = (*changes)[0];
+        expect(insert.kind == LayoutChangeKind::Insert);
+        expect(insert.path == SelectionPath{0, 1});
+        expect(insert.node->type() == "slider-float");
+        expect(insert.ancestors.size() == 2_ul) << "root and row";
+
+        const auto& update = (*changes)[1];
+        expect(update.kind == LayoutChangeKind::Update);
+        expect(update.node->label() == "Go");
+
+        const auto& swap = (*changes)[2];
+        expect(swap.kind == LayoutChangeKind::Swap);
+        expect(swap.path == SelectionPath{0, 0});
+        expect(swap.other == SelectionPath{0, 1});
+
+        const auto& remove = (*changes)[3];
+        expect(remove.kind == LayoutChangeKind::Remove);
+        expect(remove.path == SelectionPath{0, 2});
+        expect(!remove.uid.empty());
+    };
+
+    "layout_model_reset_on_wrap_and_data"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("button");
+        auto base = model.version();
+
+        model.insert_after({}, "text");
+        model.add_data_entry("data-tree", "demo");
+
+        auto changes = model.changes_since(base);
+        expect(changes.has_value());
+        expect(changes->front().kind == LayoutChangeKind::Reset) << "Wrapping the root replaces the layout";
+        expect(changes->back().kind == LayoutChangeKind::Data);
+        model.remove_data_entry(0);
+    };
+
+    "layout_model_dropped_log_requires_rebuild"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        auto base = model.version();
+
+        for (int i = 0; i < 300; ++i) {
+            model.add_child({}, "text");
+        }
+        expect(!model.changes_since(base).has_value()) << "Old versions fell out of the log";
+        expect(model.changes_since(model.version() - 10).has_value());
+        expect(!model.changes_since(model.version() + 1).has_value());
+    };
+
+    "layout_model_edits_share_untouched_subtrees"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        model.add_child({}, "row");
+        model.add_child({}, "row");
+        model.add_child({0}, "button");
+        model.add_child({1}, "text");
+
+        auto before = model.snapshot();
+        model.set_label_at({0, 0}, "Go");
+        auto after = model.snapshot();
+
+        expect(before.tree != after.tree);
+        expect(before.tree->body()[1] == after.tree->body()[1]) << "Untouched row is shared";
+        expect(before.tree->body()[0]->body()[0]->props_ptr() != after.tree->body()[0]->body()[0]->props_ptr());
+        expect(before.tree->body()[0]->body()[0]->label() == "button") << "Old snapshot is unchanged";
+        expect(SharedLayoutModel::get_label(SharedLayoutModel::get_body(model.root())[0]) == "row");
+
+        auto changes = model.changes_since(before.version);
+        expect(changes->back().node == after.tree->body()[0]->body()[0]) << "Change records share the node";
+    };
+
+    "layout_model_root_value_follows_undo"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        model.add_child({}, "button");
+        expect(SharedLayoutModel::get_body(model.root()).size() == 1_ul);
+        model.add_child({}, "text");
+        expect(SharedLayoutModel::get_body(model.root()).size() == 2_ul);
+
+        model.undo();
+        expect(SharedLayoutModel::get_body(model.root()).size() == 1_ul) << "Built again for the restored tree";
+        model.redo();
+        auto body = SharedLayoutModel::get_body(model.root());
+        expect(body.size() == 2_ul);
+        expect(SharedLayoutModel::get_widget_type(body[1]) == "text");
+    };
+
+    "layout_model_undo_redo_restores_snapshots"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        model.add_child({}, "button");
+        auto one_child = model.tree();
+        model.add_child({}, "text");
+        auto two_children = model.tree();
+
+        expect(model.can_undo());
+        expect(!model.can_redo());
+
+        model.undo();
+        expect(model.tree() == one_child);
+        expect(model.can_redo());
+
+        model.redo();
+        expect(model.tree() == two_children);
+
+        model.undo();
+        model.add_child({}, "checkbox");
+        expect(!model.can_redo()) << "A new edit drops the redo history";
+        expect(model.tree()->body().size() == 2_ul);
+        expect(model.tree()->body()[1]->type() == "checkbox");
+    };
+
+    "layout_model_undo_records_minimal_changes"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        model.add_child({}, "row");
+        model.add_child({0}, "button");
+        model.add_child({}, "text");
+
+        auto base = model.version();
+        model.undo();  // remove text
+        model.undo();  // remove button from row
+        model.redo();  // put it back
+        model.set_label_at({0, 0}, "Go");
+        model.undo();  // label change
+
+        auto changes = model.changes_since(base);
+        expect(changes.has_value());
+        expect(changes->size() == 5_ul);
+        expect((*changes)[0].kind == LayoutChangeKind::Remove);
+        expect((*changes)[0].path == SelectionPath{1});
+        expect((*changes)[1].kind == LayoutChangeKind::Remove);
+        expect((*changes)[1].path == SelectionPath{0, 0});
+        expect((*changes)[2].kind == LayoutChangeKind::Insert);
+        expect((*changes)[2].node->type() == "button");
+        expect((*changes)[4].kind == LayoutChangeKind::Update);
+        expect((*changes)[4].path == SelectionPath{0, 0});
+        expect((*changes)[4].node->label() == "button");
+
+        model.undo();  // button
+        model.undo();  // row
+        model.undo();  // set_root: back to a different root
+        expect(model.changes_since(model.version() - 1)->front().kind == LayoutChangeKind::Reset);
+    };
+
+    "layout_model_data_edits_are_not_undone"_test = [] {
+        auto& model = SharedLayoutModel::instance();
+        model.set_root("column");
+        auto tree = model.tree();
+        auto data_version = model.data_version();
+
+        model.add_data_entry("data-tree", "demo");
+        expect(model.data_version() == data_version + 1);
+        expect(model.tree() == tree);
+        model.undo();
+        expect(model.data_entries().size() == 1_ul) << "Undo only covers the layout";
+        model.remove_data_entry(0);
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,250 @@
+// Log buffer unit tests
+#include <boost/ut.hpp>
+#include "ymery/log_buffer.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+static LogEntry make_entry(const std::string& message) {
+    LogEntry entry;
+    entry.message = message;
+    entry.level = spdlog::level::info;
+    entry.source_line = 0;
+    return entry;
+}
+
+suite log_buffer_tests = [] {
+    "log_buffer_read_since_is_incremental"_test = [] {
+        LogBuffer buffer(16);
+        buffer.add(make_entry("a"));
+        buffer.add(make_entry("b"));
+
+        std::vector<LogEntry> out;
+        uint64_t next = buffer.read_since(0, out);
+        expect(out.size() == 2_ul);
+        expect(next == 2_ul);
+
+        buffer.add(make_entry("c"));
+        out.clear();
+        next = buffer.read_since(next, out);
+        expect(out.size() == 1_ul) << "Only the new entry should be returned";
+        expect(out[0].message == "c");
+        expect(!out[0].timestamp.empty()) << "Timestamp formatted on read";
+    };
+
+    "log_buffer_keeps_newest_window"_test = [] {
+        LogBuffer buffer(8);
+        for (int i = 0; i < 100; ++i) {
+            buffer.add(make_entry(std::to_string(i)));
+        }
+        auto entries = buffer.entries();
+        expect(entries.size() == 8_ul);
+        expect(entries.back().message == "99");
+        expect(entries.front().message == "92");
+    };
+
+    "log_buffer_clear_bumps_generation_and_epoch"_test = [] {
+        LogBuffer buffer(16);
+        buffer.add(make_entry("a"));
+        auto generation = buffer.generation();
+        auto epoch = buffer.epoch();
+
+        buffer.clear();
+        expect(buffer.generation() != generation);
+        expect(buffer.epoch() != epoch);
+        expect(buffer.size() == 0_ul);
+        expect(buffer.entries().empty());
+    };
+
+    "log_buffer_concurrent_producers"_test = [] {
+        LogBuffer buffer(1024);
+        constexpr int producers = 4;
+        constexpr int per_producer = 5000;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; ++t) {
+            threads.emplace_back([&buffer, t] {
+                for (int i = 0; i < per_producer; ++i) {
+                    buffer.add(make_entry(std::to_string(t) + ":" + std::to_string(i)));
+                }
+            });
+        }
+
+        // Read while producers run; sequences must stay strictly increasing
+        std::vector<LogEntry> out;
+        uint64_t next = 0;
+        bool ordered = true;
+        for (int pass = 0; pass < 100; ++pass) {
+            size_t before = out.size();
+            next = buffer.read_since(next, out);
+            for (size_t i = std::max<size_t>(before, 1); i < out.size(); ++i) {
+                if (out[i].sequence <= out[i - 1].sequence) ordered = false;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        expect(ordered) << "Entries delivered out of order";
+        expect(buffer.head() == static_cast<uint64_t>(producers * per_producer));
+        expect(buffer.entries().size() == 1024_ul) << "Window should hold max_size entries";
+    };
+
+    "log_buffer_max_size_is_bounded_by_capacity"_test = [] {
+        LogBuffer buffer(16);
+        expect(buffer.capacity() == 16_ul);
+        expect(!buffer.set_max_size(17).has_value()) << "The slots cannot grow";
+        expect(buffer.max_size() == 16_ul);
+
+        expect(buffer.set_max_size(4).has_value());
+        for (int i = 0; i < 10; ++i) {
+            buffer.add(make_entry(std::to_string(i)));
+        }
+        auto entries = buffer.entries();
+        expect(entries.size() == 4_ul);
+        expect(entries.front().message == "6");
+    };
+
+    "log_buffer_keeps_source_of_prebuilt_entries"_test = [] {
+        LogBuffer buffer(16);
+        auto entry = make_entry("a");
+        entry.logger_name = "ymery";
+        entry.level = spdlog::level::warn;
+        entry.source_file = "src/ymery/app.cpp";
+        entry.source_line = 42;
+        buffer.add(entry);
+
+        std::string long_path(300, 'd');
+        entry.source_file = long_path + "/widget.cpp";
+        buffer.add(entry);
+
+        auto entries = buffer.entries();
+        expect(entries.size() == 2_ul);
+        expect(entries[0].source_file == "src/ymery/app.cpp");
+        expect(entries[0].source_line == 42_i);
+        expect(entries[0].logger_name == "ymery");
+        expect(entries[0].level == spdlog::level::warn);
+        expect(entries[1].source_file.size() == LogBuffer::SOURCE_CAPACITY);
+        expect(entries[1].source_file.ends_with("/widget.cpp")) << "Long paths keep the file name";
+    };
+
+    "log_buffer_reader_never_returns_torn_entries"_test = [] {
+        // A small ring that producers lap constantly; every message is one
+        // repeated character whose logger and line name the same character
+        LogBuffer buffer(8);
+        constexpr int producers = 4;
+        constexpr int per_producer = 20000;
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; ++t) {
+            threads.emplace_back([&buffer, t] {
+                for (int i = 0; i < per_producer; ++i) {
+                    char c = static_cast<char>('a' + (t * 7 + i) % 26);
+                    LogEntry entry = make_entry(std::string(static_cast<size_t>(1 + (i * 37) % 500), c));
+                    entry.logger_name = std::string(1 + i % 30, c);
+                    entry.source_file = std::string(1 + i % 100, c);
+                    entry.source_line = c;
+                    buffer.add(entry);
+                }
+            });
+        }
+
+        size_t read = 0;
+        size_t torn = 0;
+        uint64_t next = 0;
+        std::thread reader([&] {
+            std::vector<LogEntry> out;
+            while (!done.load()) {
+                out.clear();
+                next = buffer.read_since(next, out);
+                for (const auto& entry : out) {
+                    char c = static_cast<char>(entry.source_line);
+                    auto uniform = [c](const std::string& s) {
+                        return !s.empty() && s.find_first_not_of(c) == std::string::npos;
+                    };
+                    if (!uniform(entry.message) || !uniform(entry.logger_name) || !uniform(entry.source_file)) {
+                        ++torn;
+                    }
+                }
+                read += out.size();
+            }
+        });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        done = true;
+        reader.join();
+
+        expect(read > 0_ul);
+        expect(torn == 0_ul) << "An entry mixed two writes";
+    };
+
+    "log_buffer_writers_lapping_each_other_drop_instead_of_tearing"_test = [] {
+        // More writers than slots, so writers a full ring apart share a slot
+        LogBuffer buffer(2);
+        constexpr int producers = 8;
+        constexpr int per_producer = 20000;
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; ++t) {
+            threads.emplace_back([&buffer, t] {
+                for (int i = 0; i < per_producer; ++i) {
+                    char c = static_cast<char>('a' + (t * 5 + i) % 26);
+                    LogEntry entry = make_entry(std::string(static_cast<size_t>(1 + (i * 53) % 512), c));
+                    entry.logger_name = std::string(1 + i % 32, c);
+                    entry.source_file = std::string(1 + i % 128, c);
+                    entry.source_line = c;
+                    buffer.add(entry);
+                }
+            });
+        }
+
+        size_t read = 0;
+        size_t torn = 0;
+        uint64_t next = 0;
+        auto check = [&](const std::vector<LogEntry>& out) {
+            for (const auto& entry : out) {
+                char c = static_cast<char>(entry.source_line);
+                auto uniform = [c](const std::string& s) {
+                    return !s.empty() && s.find_first_not_of(c) == std::string::npos;
+                };
+                if (!uniform(entry.message) || !uniform(entry.logger_name) || !uniform(entry.source_file)) {
+                    ++torn;
+                }
+            }
+            read += out.size();
+        };
+        std::thread reader([&] {
+            std::vector<LogEntry> out;
+            while (!done.load()) {
+                out.clear();
+                next = buffer.read_since(next, out);
+                check(out);
+            }
+        });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        done = true;
+        reader.join();
+
+        // Dropped entries never hold the reader back once the writers are done
+        std::vector<LogEntry> out;
+        next = buffer.read_since(next, out);
+        check(out);
+        expect(next == buffer.head()) << "The reader stopped at a dropped entry";
+        expect(buffer.head() == static_cast<uint64_t>(producers * per_producer));
+        expect(read > 0_ul);
+        expect(torn == 0_ul) << "Two writers mixed their entries in one slot";
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Typed numeric array unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/yaml_numeric.hpp"
+#include "ymery/embedded_plugins.hpp"
+#include <numeric>
+
+using namespace boost::ut;
+using namespace ymery;
+
+suite numeric_array_tests = [] {
+    "numeric_array_checks_shape"_test = [] {
+        auto flat = NumericArray::create(std::vector<double>{1.0, 2.0, 3.0});
+        expect(flat.has_value());
+        expect((*flat)->shape() == std::vector<size_t>{3});
+        expect((*flat)->view<double>().size() == 3_ul);
+        expect((*flat)->view<float>().empty()) << "View of another element type is empty";
+
+        auto matrix = NumericArray::create(std::vector<int32_t>(6, 7), {2, 3});
+        expect(matrix.has_value());
+        expect((*matrix)->type() == NumericType::I32);
+        expect((*matrix)->at(5) == 7.0);
+
+        expect(!NumericArray::create(std::vector<float>(5), {2, 3}).has_value());
+    };
+
+    "numeric_array_from_list"_test = [] {
+        List list{Value(1), Value(2.5), Value(3.0f)};
+        auto array = NumericArray::from_list(list, NumericType::F32);
+        expect(array.has_value());
+        expect((*array)->view<float>()[1] == 2.5f);
+
+        list.push_back(Value(std::string("x")));
+        expect(!NumericArray::from_list(list).has_value());
+
+        expect(as_numeric_array(Value(*array)) == *array) << "Held arrays are returned as is";
+        expect(as_numeric_array(Value(std::string("x"))) == nullptr);
+    };
+
+    "numeric_array_yaml_tags"_test = [] {
+        auto node = YAML::Load(R"(
+samples: !f32 [0.5, 1, 2]
+bulk: !i32 "0 1 2 3 4 5"
+image: !f64 {shape: [2, 3], data: [1, 2, 3, 4, 5, 6]}
+plain: [1, 2, 3]
+bad: !i32 [1.5]
+)");
+        auto samples = yaml_to_numeric_array(node["samples"]);
+        expect(samples && samples->type() == NumericType::F32 && samples->size() == 3_ul);
+        auto bulk = yaml_to_numeric_array(node["bulk"]);
+        expect(bulk && bulk->size() == 6_ul && bulk->at(5) == 5.0);
+        auto image = yaml_to_numeric_array(node["image"]);
+        expect(image && image->shape() == std::vector<size_t>{2, 3});
+        expect(yaml_to_numeric_array(node["plain"]) == nullptr) << "Untagged lists stay lists";
+        expect(yaml_to_numeric_array(node["bad"]) == nullptr);
+
+        YAML::Emitter out;
+        out << numeric_array_to_yaml(*image);
+        auto back = yaml_to_numeric_array(YAML::Load(out.c_str()));
+        expect(back && back->shape() == image->shape() && back->at(4) == 5.0);
+    };
+
+    "data_tree_carries_arrays_by_pointer"_test = [] {
+        auto tree = *embedded::create_data_tree();
+        std::vector<double> values(1'000'000);
+        std::iota(values.begin(), values.end(), 0.0);
+        auto array = *NumericArray::create(std::move(values));
+
+        expect(tree->set(DataPath::parse("/plot/data"), Value(array)).has_value());
+        auto got = tree->get(DataPath::parse("/plot/data"));
+        expect(got.has_value());
+        auto held = get_ptr<NumericArrayPtr>(*got);
+        expect(held && *held == array) << "Same array, not a copy";
+
+        expect(tree->set(DataPath::parse("/plot/data"), Value(1.0)).has_value());
+        got = tree->get(DataPath::parse("/plot/data"));
+        expect(got.has_value() && get_ptr<NumericArrayPtr>(*got) == nullptr) << "A plain value replaces the array";
+    };
+
+    "data_tree_metadata_and_dump_carry_set_arrays"_test = [] {
+        auto tree = *embedded::create_data_tree();
+        auto array = *NumericArray::create(std::vector<float>{0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f}, {2, 3});
+        expect(tree->set(DataPath::parse("/plot/data"), Value(array)).has_value());
+        expect(tree->set(DataPath::parse("/plot/label"), Value(std::string("wave"))).has_value());
+
+        auto meta = *tree->get_metadata(DataPath::parse("/plot"));
+        auto held = get_ptr<NumericArrayPtr>(meta["data"]);
+        expect(held && *held == array) << "Metadata hands out the array, not a placeholder";
+        expect(*get_as<std::string>(meta["label"]) == "wave");
+
+        // Serialized as a tagged array that loads back with its shape and values
+        auto dumped = YAML::Load(*tree->as_tree(DataPath::root(), -1));
+        auto back = yaml_to_numeric_array(dumped["children"]["plot"]["metadata"]["data"]);
+        expect(back != nullptr) << "Round trip keeps the array";
+        if (back) {
+            expect(back->type() == NumericType::F32);
+            expect(back->shape() == std::vector<size_t>{2, 3});
+            expect(back->at(5) == 5.5);
+        }
+    };
+
+    "data_tree_converts_tagged_yaml_once"_test = [] {
+        auto tree = *embedded::create_data_tree();
+        tree->add_child(DataPath::root(), "wave", {});
+        auto node = YAML::Load("!f64 [1, 2, 3]");
+        auto array = yaml_to_numeric_array(node);
+        Dict metadata;
+        metadata["samples"] = Value(array);
+        tree->add_child(DataPath::root(), "wave", metadata);
+
+        auto first = tree->get(DataPath::parse("/wave/samples"));
+        auto second = tree->get(DataPath::parse("/wave/samples"));
+        auto a = get_ptr<NumericArrayPtr>(*first);
+        auto b = get_ptr<NumericArrayPtr>(*second);
+        expect(a && b && *a == *b) << "Converted on first read, then cached";
+        expect((*a)->size() == 3_ul);
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,289 @@
+// Recorder plugin unit tests
+#include <boost/ut.hpp>
+#include "ymery/plugin_manager.hpp"
+#include "ymery/dispatcher.hpp"
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_recorder.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <thread>
+
+using namespace boost::ut;
+using namespace ymery;
+
+// Tests run from build directory, plugins are in ./plugins
+static const char* PLUGINS_PATH = "plugins";
+
+suite recorder_tests = [] {
+    "recorder_get_children_names_root"_test = [] {
+        auto pm_res = PluginManager::create(PLUGINS_PATH);
+        expect(pm_res.has_value());
+        auto pm = *pm_res;
+
+        auto disp_res = Dispatcher::create();
+        expect(disp_res.has_value());
+        auto disp = *disp_res;
+
+        auto recorder_res = pm->create_tree("recorder", disp);
+        expect(recorder_res.has_value()) << "Recorder creation failed: " << error_msg(recorder_res);
+        auto recorder = *recorder_res;
+
+        auto children_res = recorder->get_children_names(DataPath("/"));
+        expect(children_res.has_value()) << "get_children_names('/') failed";
+        expect(children_res->size() == 2_ul) << "Expected 2 children, got " << children_res->size();
+
+        // Nothing is recorded until a recording is added
+        auto opened_res = recorder->get_children_names(DataPath("/opened"));
+        expect(opened_res.has_value());
+        expect(opened_res->empty()) << "Expected no recordings";
+    };
+
+    "recorder_records_waveform_via_kernel"_test = [] {
+        auto pm_res = PluginManager::create(PLUGINS_PATH);
+        expect(pm_res.has_value());
+        auto pm = *pm_res;
+
+        auto disp_res = Dispatcher::create();
+        expect(disp_res.has_value());
+        auto disp = *disp_res;
+
+        auto kernel_res = pm->create_tree("kernel", disp);
+        expect(kernel_res.has_value()) << "Kernel creation failed: " << error_msg(kernel_res);
+        auto kernel = *kernel_res;
+
+        auto file = (std::filesystem::temp_directory_path() / "ymery_recorder_test.wav").string();
+
+        // Kernel resolves the source path into the waveform channel buffer
+        auto add_res = kernel->add_child(DataPath("/providers/recorder/opened"), "sine", Dict{
+            {"source", Value(std::string("/providers/waveform/opened/sine/0"))},
+            {"file", Value(file)},
+            {"format", Value(std::string("wav"))},
+            {"recording", Value(true)}
+        });
+        expect(add_res.has_value()) << "add_child failed: " << error_msg(add_res);
+
+        auto status_res = kernel->get(DataPath("/providers/recorder/opened/sine/status"));
+        expect(status_res.has_value());
+        expect(get_as<std::string>(*status_res) == std::optional<std::string>("recording"));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        auto stop_res = kernel->set(DataPath("/providers/recorder/opened/sine/recording"), Value(false));
+        expect(stop_res.has_value()) << "stop failed: " << error_msg(stop_res);
+
+        auto meta_res = kernel->get_metadata(DataPath("/providers/recorder/opened/sine"));
+        expect(meta_res.has_value());
+        auto frames = get_as<int64_t>((*meta_res)["frames-written"]).value_or(0);
+        auto dropped = get_as<int64_t>((*meta_res)["dropped-blocks"]).value_or(-1);
+
+        expect(frames > 0_i) << "No frames recorded";
+        expect(dropped == 0_i) << "Dropped blocks: " << dropped;
+
+        // 80-byte WAV header followed by mono float32 samples
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file, ec);
+        expect(!ec);
+        expect(size == 80 + static_cast<uintmax_t>(frames) * sizeof(float)) << "Unexpected file size " << size;
+        std::filesystem::remove(file, ec);
+    };
+
+    "recorder_keeps_channels_aligned_when_one_queue_overflows"_test = [] {
+        constexpr size_t BLOCK = 64;
+        constexpr int SAMPLE_RATE = 48000;
+        // One ring per channel, so each channel can be written on its own
+        auto left = *AudioRingBuffer::create(SAMPLE_RATE, 4096, BLOCK);
+        auto right = *AudioRingBuffer::create(SAMPLE_RATE, 4096, BLOCK);
+        std::vector<MediatedAudioBufferPtr> sources{*MediatedAudioBuffer::create(left),
+                                                    *MediatedAudioBuffer::create(right)};
+
+        auto file = (std::filesystem::temp_directory_path() / "ymery_recorder_aligned.raw").string();
+        AudioRecorderConfig config;
+        config.file_path = file;
+        config.format = "raw";
+        config.block_frames = BLOCK;
+        config.queue_seconds = 0.0;  // smallest queue: 4 blocks per channel
+        auto recorder = *AudioRecorder::create(sources, config);
+        expect(recorder->start().has_value());
+
+        // Sample value = stream position, the same on both channels
+        auto ramp = [](size_t from, size_t frames) {
+            std::vector<float> v(frames);
+            std::iota(v.begin(), v.end(), static_cast<float>(from));
+            return v;
+        };
+        auto settle = [] { std::this_thread::sleep_for(std::chrono::milliseconds(30)); };
+
+        // Right runs 10 blocks ahead while left has nothing: its queue keeps
+        // blocks 0-3 and drops 4-9
+        for (size_t b = 0; b < 10; ++b) right->write(ramp(b * BLOCK, BLOCK));
+        settle();
+        // Left catches up slowly: the writer pairs what right kept, then left
+        // queues blocks right lost
+        for (size_t b = 0; b < 10; ++b) {
+            left->write(ramp(b * BLOCK, BLOCK));
+            settle();
+        }
+        // Then both in step again
+        for (size_t b = 10; b < 20; ++b) {
+            left->write(ramp(b * BLOCK, BLOCK));
+            right->write(ramp(b * BLOCK, BLOCK));
+            settle();
+        }
+        expect(recorder->stop().has_value());
+
+        std::vector<float> samples(static_cast<size_t>(recorder->frames_written()) * 2);
+        std::FILE* f = std::fopen(file.c_str(), "rb");
+        expect(f != nullptr);
+        if (f) {
+            expect(std::fread(samples.data(), sizeof(float), samples.size(), f) == samples.size());
+            std::fclose(f);
+        }
+
+        bool aligned = true;
+        bool increasing = true;
+        for (size_t i = 0; i < samples.size() / 2; ++i) {
+            aligned = aligned && samples[2 * i] == samples[2 * i + 1];
+            increasing = increasing && (i == 0 || samples[2 * i] > samples[2 * i - 2]);
+        }
+        expect(aligned) << "Every frame holds both channels' samples from the same period";
+        expect(increasing);
+        // Right's queue holds fewer than 10 blocks, so some periods were lost;
+        // each lost period counts once, not once per channel
+        expect(recorder->dropped_blocks() >= 6_ul);
+        expect(recorder->frames_written() == (20 - recorder->dropped_blocks()) * BLOCK) << recorder->frames_written();
+        expect(samples.size() >= 2 && samples.back() == static_cast<float>(20 * BLOCK - 1));
+
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+    };
+
+    "recorder_restart_drops_blocks_left_from_the_previous_take"_test = [] {
+        constexpr size_t BLOCK = 64;
+        constexpr int SAMPLE_RATE = 48000;
+        auto left = *AudioRingBuffer::create(SAMPLE_RATE, 4096, BLOCK);
+        auto right = *AudioRingBuffer::create(SAMPLE_RATE, 4096, BLOCK);
+        std::vector<MediatedAudioBufferPtr> sources{*MediatedAudioBuffer::create(left),
+                                                    *MediatedAudioBuffer::create(right)};
+
+        auto file = (std::filesystem::temp_directory_path() / "ymery_recorder_restart.raw").string();
+        AudioRecorderConfig config;
+        config.file_path = file;
+        config.format = "raw";
+        config.block_frames = BLOCK;
+        config.queue_seconds = 0.0;
+        auto recorder = *AudioRecorder::create(sources, config);
+
+        auto ramp = [](size_t from, size_t frames) {
+            std::vector<float> v(frames);
+            std::iota(v.begin(), v.end(), static_cast<float>(from));
+            return v;
+        };
+        auto settle = [] { std::this_thread::sleep_for(std::chrono::milliseconds(30)); };
+
+        // First take: right loses the last block, so left still queues it at stop
+        expect(recorder->start().has_value());
+        for (size_t b = 0; b < 3; ++b) {
+            left->write(ramp(b * BLOCK, BLOCK));
+            right->write(ramp(b * BLOCK, BLOCK));
+            settle();
+        }
+        left->write(ramp(3 * BLOCK, BLOCK));
+        settle();
+        expect(recorder->stop().has_value());
+        expect(recorder->frames_written() == 3 * BLOCK);
+        expect(recorder->dropped_blocks() == 1_ul);
+
+        // Second take starts from 10000 on both channels
+        expect(recorder->start().has_value());
+        for (size_t b = 0; b < 4; ++b) {
+            left->write(ramp(10000 + b * BLOCK, BLOCK));
+            right->write(ramp(10000 + b * BLOCK, BLOCK));
+            settle();
+        }
+        expect(recorder->stop().has_value());
+        expect(recorder->dropped_blocks() == 0_ul) << "No periods of the new take are lost";
+        expect(recorder->frames_written() == 4 * BLOCK) << recorder->frames_written();
+
+        std::vector<float> samples(static_cast<size_t>(recorder->frames_written()) * 2);
+        std::FILE* f = std::fopen(file.c_str(), "rb");
+        expect(f != nullptr);
+        if (f) {
+            expect(std::fread(samples.data(), sizeof(float), samples.size(), f) == samples.size());
+            std::fclose(f);
+        }
+        bool expected = true;
+        for (size_t i = 0; i < samples.size() / 2; ++i) {
+            expected = expected && samples[2 * i] == static_cast<float>(10000 + i) && samples[2 * i + 1] == samples[2 * i];
+        }
+        expect(expected) << "The second file holds only the second take, aligned";
+
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+    };
+
+    "recorder_aligns_channels_written_between_tap_attachments"_test = [] {
+        constexpr size_t BLOCK = 8;
+        constexpr size_t CHANNELS = 16;
+        // All channels on one ring, written without pause while the taps
+        // attach one by one, so blocks land between attachments
+        auto ring = *AudioRingBuffer::create(48000, 1 << 14, BLOCK, CHANNELS);
+        std::vector<MediatedAudioBufferPtr> sources;
+        for (size_t ch = 0; ch < CHANNELS; ++ch) sources.push_back(*MediatedAudioBuffer::create(ring, ch));
+
+        std::atomic<bool> writing{true};
+        std::thread writer([&] {
+            // Sample value = frame index on every channel
+            std::vector<float> block(BLOCK * CHANNELS);
+            for (uint64_t frame = 0; writing.load(); frame += BLOCK) {
+                for (size_t i = 0; i < BLOCK; ++i) {
+                    std::fill_n(block.data() + i * CHANNELS, CHANNELS, static_cast<float>((frame + i) % (1 << 20)));
+                }
+                ring->write_interleaved(block.data(), BLOCK);
+            }
+        });
+
+        auto file = (std::filesystem::temp_directory_path() / "ymery_recorder_attach.raw").string();
+        AudioRecorderConfig config;
+        config.file_path = file;
+        config.format = "raw";
+        config.block_frames = 64;
+        config.queue_seconds = 10.0;
+
+        size_t misaligned = 0;
+        uint64_t recorded = 0;
+        for (int run = 0; run < 20; ++run) {
+            auto recorder = *AudioRecorder::create(sources, config);
+            expect(recorder->start().has_value());
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            expect(recorder->stop().has_value());
+
+            std::vector<float> samples(static_cast<size_t>(recorder->frames_written()) * CHANNELS);
+            std::FILE* f = std::fopen(file.c_str(), "rb");
+            expect(f != nullptr);
+            if (f) {
+                expect(std::fread(samples.data(), sizeof(float), samples.size(), f) == samples.size());
+                std::fclose(f);
+            }
+            for (size_t i = 0; i < samples.size(); i += CHANNELS) {
+                misaligned += std::count(samples.begin() + i, samples.begin() + i + CHANNELS, samples[i]) != CHANNELS;
+            }
+            recorded += recorder->frames_written();
+        }
+        writing = false;
+        writer.join();
+
+        expect(recorded > 0_ul);
+        expect(misaligned == 0_ul) << misaligned << " frames hold samples of different periods";
+
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+    };
+};
+
+int main() {
+    return 0;
+}
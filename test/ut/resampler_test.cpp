@@ -0,0 +1,231 @@
+// Resampler unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/audio_resampler.hpp"
+#include <cmath>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+std::vector<float> sine(double frequency, int rate, size_t frames, double amplitude = 0.5) {
+    std::vector<float> out(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        out[i] = static_cast<float>(amplitude * std::sin(2.0 * PI * frequency * i / rate));
+    }
+    return out;
+}
+
+// THD+N in dB: least-squares fit of a sine at `frequency` (plus DC), then
+// residual power relative to the fitted tone
+double thd_n_db(const std::vector<float>& x, size_t skip, double frequency, int rate) {
+    double w = 2.0 * PI * frequency / rate;
+    double ss = 0, sc = 0, cc = 0, s1 = 0, c1 = 0, n = 0, xs = 0, xc = 0, x1 = 0;
+    for (size_t i = skip; i < x.size(); ++i) {
+        double s = std::sin(w * i), c = std::cos(w * i);
+        ss += s * s; sc += s * c; cc += c * c; s1 += s; c1 += c; n += 1;
+        xs += x[i] * s; xc += x[i] * c; x1 += x[i];
+    }
+    // Solve the 3x3 normal equations (Cramer)
+    double m[3][3] = {{ss, sc, s1}, {sc, cc, c1}, {s1, c1, n}};
+    double r[3] = {xs, xc, x1};
+    auto det = [](double a[3][3]) {
+        return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+             - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+             + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    };
+    double d = det(m);
+    double coef[3];
+    for (int k = 0; k < 3; ++k) {
+        double t[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) t[i][j] = j == k ? r[i] : m[i][j];
+        coef[k] = det(t) / d;
+    }
+    double signal = 0, noise = 0;
+    for (size_t i = skip; i < x.size(); ++i) {
+        double fit = coef[0] * std::sin(w * i) + coef[1] * std::cos(w * i) + coef[2];
+        signal += (fit - coef[2]) * (fit - coef[2]);
+        noise += (x[i] - fit) * (x[i] - fit);
+    }
+    return 10.0 * std::log10(noise / signal);
+}
+
+std::vector<float> convert(PolyphaseResampler& r, const std::vector<float>& in) {
+    std::vector<float> out(r.max_output(in.size()));
+    out.resize(r.process(in.data(), in.size(), out.data()));
+    return out;
+}
+
+struct RatePair {
+    int in;
+    int out;
+};
+
+constexpr RatePair RATE_PAIRS[] = {{44100, 48000}, {48000, 44100}, {48000, 96000}, {96000, 48000}, {32000, 48000}};
+
+} // namespace
+
+suite resampler_tests = [] {
+    "quality_names_round_trip"_test = [] {
+        for (const auto& name : resampler_quality_names()) {
+            auto q = resampler_quality_from_string(name);
+            expect(q.has_value());
+            expect(std::string(resampler_quality_name(*q)) == name);
+        }
+        expect(!resampler_quality_from_string("best").has_value());
+    };
+
+    "create_reduces_the_ratio"_test = [] {
+        auto r = *PolyphaseResampler::create(44100, 48000, ResamplerQuality::Low);
+        expect(r->phases() == 160_ul);
+        expect(r->step() == 147_ul);
+        expect(r->taps() % 8 == 0_ul);
+
+        auto down = *PolyphaseResampler::create(96000, 48000, ResamplerQuality::Low);
+        expect(down->phases() == 1_ul && down->step() == 2_ul);
+        expect(down->taps() >= 2 * r->taps()) << "Downsampling widens the filter";
+
+        expect(!PolyphaseResampler::create(0, 48000).has_value());
+        expect(!PolyphaseResampler::create(48000, 48000, ResamplerQuality::Low, 0).has_value());
+        expect(!PolyphaseResampler::create(44100, 48017).has_value()) << "Too many phases";
+    };
+
+    "output_count_follows_ratio"_test = [] {
+        auto r = *PolyphaseResampler::create(44100, 48000);
+        std::vector<float> in(44100, 0.0f);
+        auto out = convert(*r, in);
+        expect(out.size() == 48000_ul) << out.size();
+    };
+
+    "dc_passes_at_unity_gain"_test = [] {
+        for (auto [in_rate, out_rate] : RATE_PAIRS) {
+            auto r = *PolyphaseResampler::create(in_rate, out_rate, ResamplerQuality::Medium);
+            auto out = convert(*r, std::vector<float>(in_rate / 10, 1.0f));
+            float last = out.back();
+            expect(std::abs(last - 1.0f) < 1e-3f) << in_rate << "->" << out_rate << last;
+        }
+    };
+
+    "chunked_processing_matches_one_pass"_test = [] {
+        auto in = sine(997.0, 44100, 10000);
+        auto whole = *PolyphaseResampler::create(44100, 48000, ResamplerQuality::Medium, 8192);
+        auto expected = convert(*whole, in);
+
+        auto chunked = *PolyphaseResampler::create(44100, 48000, ResamplerQuality::Medium, 64);
+        std::vector<float> out;
+        std::vector<float> block(chunked->max_output(333));
+        for (size_t pos = 0; pos < in.size(); pos += 333) {
+            size_t n = std::min<size_t>(333, in.size() - pos);
+            size_t produced = chunked->process(in.data() + pos, n, block.data());
+            out.insert(out.end(), block.begin(), block.begin() + produced);
+        }
+        expect(out.size() == expected.size());
+        bool same = true;
+        for (size_t i = 0; i < std::min(out.size(), expected.size()); ++i) {
+            same = same && out[i] == expected[i];
+        }
+        expect(same);
+    };
+
+    "thd_n_by_quality"_test = [] {
+        const double limits[] = {-50.0, -85.0, -100.0};
+        for (auto [in_rate, out_rate] : RATE_PAIRS) {
+            for (auto quality : {ResamplerQuality::Low, ResamplerQuality::Medium, ResamplerQuality::High}) {
+                auto r = *PolyphaseResampler::create(in_rate, out_rate, quality);
+                auto out = convert(*r, sine(1000.0, in_rate, static_cast<size_t>(in_rate / 2)));
+                size_t skip = static_cast<size_t>(r->delay_frames() * 2) + 16;
+                double db = thd_n_db(out, skip, 1000.0, out_rate);
+                expect(db < limits[static_cast<int>(quality)])
+                    << in_rate << "->" << out_rate << resampler_quality_name(quality) << db;
+            }
+        }
+    };
+
+    "images_above_nyquist_are_rejected"_test = [] {
+        // 30 kHz at 96 kHz has no place at 48 kHz: it must not alias to 18 kHz
+        auto r = *PolyphaseResampler::create(96000, 48000, ResamplerQuality::High);
+        auto out = convert(*r, sine(30000.0, 96000, 48000));
+        double energy = 0;
+        for (size_t i = r->taps(); i < out.size(); ++i) energy += out[i] * out[i];
+        double rms = std::sqrt(energy / (out.size() - r->taps()));
+        expect(20.0 * std::log10(rms / (0.5 / std::sqrt(2.0))) < -100.0) << rms;
+    };
+
+    "resample_buffer_is_delay_compensated"_test = [] {
+        auto in = sine(440.0, 44100, 44100);
+        auto file = *FileAudioBuffer::create("tone.wav", in, 44100);
+        auto converted = resample_buffer(*file, 48000);
+        expect(converted.has_value());
+        auto& out = (*converted)->data();
+        expect(out.size() == 48000_ul);
+        expect((*converted)->sample_rate() == 48000);
+        expect((*converted)->file_path() == "tone.wav");
+        // Peak of the first cycle lands where the original put it
+        size_t peak = 0;
+        for (size_t i = 0; i < 48000 / 440; ++i) {
+            if (out[i] > out[peak]) peak = i;
+        }
+        expect(std::abs(static_cast<double>(peak) - 48000.0 / 440.0 / 4.0) <= 1.0) << peak;
+    };
+
+    "stream_converts_ring_blocks_aligned"_test = [] {
+        auto ring = *AudioRingBuffer::create(44100, 8192, 441, 2);
+        auto left = *MediatedAudioBuffer::create(ring, 0);
+        auto right = *MediatedAudioBuffer::create(ring, 1);
+        auto stream_res = ResampledStream::create({right, left}, 48000);
+        expect(stream_res.has_value());
+        auto stream = *stream_res;
+        expect(stream->num_channels() == 2_ul);
+        expect(stream->ring()->sample_rate() == 48000);
+
+        // 1 s of stereo: left a sine, right its negation
+        auto tone = sine(1000.0, 44100, 44100);
+        std::vector<float> block(441 * 2);
+        for (size_t pos = 0; pos < tone.size(); pos += 441) {
+            for (size_t i = 0; i < 441; ++i) {
+                block[i * 2] = tone[pos + i];
+                block[i * 2 + 1] = -tone[pos + i];
+            }
+            ring->write_interleaved(block.data(), 441);
+        }
+        expect(stream->frames_in() == 44100_ul);
+        expect(stream->frames_out() >= 47990_ul && stream->frames_out() <= 48000_ul) << stream->frames_out();
+
+        // Output channel 0 is the right source, channel 1 the left
+        std::vector<std::vector<float>> out;
+        stream->ring()->read_frames({0, 1}, 4096, out);
+        float max_sum = 0, max_abs = 0;
+        for (size_t i = 0; i < out[0].size(); ++i) {
+            max_sum = std::max(max_sum, std::abs(out[0][i] + out[1][i]));
+            max_abs = std::max(max_abs, std::abs(out[1][i]));
+        }
+        expect(max_abs > 0.45f);
+        expect(max_sum < 1e-6f) << "Channels stay sample-aligned";
+
+        uint64_t before = stream->frames_out();
+        stream->detach();
+        ring->write_interleaved(block.data(), 441);
+        expect(stream->frames_out() == before);
+        expect(!stream->is_attached());
+    };
+
+    "stream_rejects_mixed_devices"_test = [] {
+        auto a = *AudioRingBuffer::create(44100, 1024, 256);
+        auto b = *AudioRingBuffer::create(44100, 1024, 256);
+        auto va = *MediatedAudioBuffer::create(a);
+        auto vb = *MediatedAudioBuffer::create(b);
+        expect(!ResampledStream::create({va, vb}, 48000).has_value());
+        expect(!ResampledStream::create({va, va}, 48000).has_value());
+        expect(!ResampledStream::create({}, 48000).has_value());
+    };
+};
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,263 @@
+// Simulated device tests - determinism, fault injection, WAV replay and a
+// headless capture -> ring -> envelope -> plot-data benchmark
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/audio_envelope.hpp"
+#include "ymery/backend/audio_recorder.hpp"
+#include "ymery/backend/audio_simulator.hpp"
+#include "ymery/embedded_plugins.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+SimulatedDeviceConfig virtual_config(SimSignal signal, size_t channels, size_t period) {
+    SimulatedDeviceConfig config;
+    config.signal = signal;
+    config.num_channels = channels;
+    config.period_size = period;
+    config.speed = 0.0;
+    return config;
+}
+
+// Interleaved float32 WAV, written the way the recorder writes it
+bool write_wav(const std::string& path, const std::vector<float>& interleaved, int channels, int sample_rate) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = wav_write_float_header(file, channels, sample_rate).has_value();
+    ok = ok && std::fwrite(interleaved.data(), sizeof(float), interleaved.size(), file) == interleaved.size();
+    ok = ok && wav_finalize_float_header(file, channels, interleaved.size() / channels).has_value();
+    std::fclose(file);
+    return ok;
+}
+
+bool wait_finished(const SimulatedDevicePtr& device) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (device->is_running() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return device->is_finished();
+}
+
+} // namespace
+
+suite simulator_tests = [] {
+    "signal_names_round_trip"_test = [] {
+        for (const auto& name : sim_signal_names()) {
+            auto signal = sim_signal_from_string(name);
+            expect(signal.has_value());
+            expect(std::string(sim_signal_name(*signal)) == name);
+        }
+        expect(!sim_signal_from_string("chirp").has_value());
+    };
+
+    "same_seed_same_samples_and_faults"_test = [] {
+        auto config = virtual_config(SimSignal::Noise, 2, 64);
+        config.xrun_probability = 0.25;
+        config.seed = 7;
+        auto a = *SimulatedDevice::create(config);
+        auto b = *SimulatedDevice::create(config);
+        expect(a->step(400) == 400_ul);
+        expect(b->step(400) == 400_ul);
+
+        expect(a->ring_buffer()->read_channel(1) == b->ring_buffer()->read_channel(1));
+        expect(a->injected_xruns() == b->injected_xruns());
+        // ~100 of 400 periods lost; the device clock still covers all of them
+        expect(a->injected_xruns() > 60_ull && a->injected_xruns() < 140_ull) << a->injected_xruns();
+        expect(a->frames_dropped() == a->injected_xruns() * 64);
+        expect(a->frames_generated() + a->frames_dropped() == 400_ull * 64);
+        expect(a->stats().xruns() == a->injected_xruns());
+        expect(a->virtual_time() == 400.0 * 64 / 48000);
+
+        config.seed = 8;
+        auto c = *SimulatedDevice::create(config);
+        c->step(400);
+        expect(c->ring_buffer()->read_channel(1) != a->ring_buffer()->read_channel(1));
+    };
+
+    "generated_channels_and_max_frames"_test = [] {
+        auto config = virtual_config(SimSignal::Square, 3, 100);
+        config.frequency = 1000.0;
+        config.amplitude = 0.25f;
+        config.max_frames = 250;
+        auto device = *SimulatedDevice::create(config);
+        expect(device->step(10) == 3_ul) << "Two whole periods and a partial one";
+        expect(device->is_finished());
+        expect(device->frames_generated() == 250_ull);
+        expect(device->ring_buffer()->frames_written() == 250_ul);
+        expect(device->get_buffer(2) != nullptr);
+        expect(device->get_buffer(3) == nullptr);
+
+        for (size_t ch = 0; ch < 3; ++ch) {
+            for (float sample : device->ring_buffer()->read_channel(ch)) {
+                expect(std::abs(sample) <= 0.3f) << "channel" << ch;
+            }
+        }
+        expect(!device->start().has_value()) << "Finished devices do not restart";
+    };
+
+    "wav_replay_loops_and_ends"_test = [] {
+        auto path = (std::filesystem::temp_directory_path() / "ymery_simulator_test.wav").string();
+        // Frame f: left f, right -f
+        std::vector<float> samples;
+        for (int f = 0; f < 150; ++f) {
+            samples.push_back(static_cast<float>(f));
+            samples.push_back(static_cast<float>(-f));
+        }
+        expect(write_wav(path, samples, 2, 22050));
+
+        SimulatedDeviceConfig config = virtual_config(SimSignal::File, 0, 64);
+        config.file = path;
+        config.sample_rate = 0;
+        config.loop = false;
+        auto once_res = SimulatedDevice::create(config);
+        expect(once_res.has_value()) << error_msg(once_res);
+        if (!once_res) return;
+        auto once = *once_res;
+        expect(once->num_channels() == 2_ul);
+        expect(once->sample_rate() == 22050_i);
+        expect(once->step(10) == 3_ul);
+        expect(once->is_finished());
+        auto right = once->ring_buffer()->read_channel(1);
+        expect(right.size() == 150_ul);
+        expect(right.back() == -149.0f);
+
+        // Looping, and three device channels over two file channels
+        config.loop = true;
+        config.num_channels = 3;
+        auto looped = *SimulatedDevice::create(config);
+        looped->step(4);
+        auto third = looped->ring_buffer()->read_channel(2);
+        expect(third.size() == 256_ul);
+        expect(third[149] == 149.0f && third[150] == 0.0f && third[255] == 105.0f);
+        expect(!looped->is_finished());
+
+        config.sample_rate = 48000;
+        expect(!SimulatedDevice::create(config).has_value()) << "Rate mismatch would change the pitch";
+        std::filesystem::remove(path);
+        config.sample_rate = 0;
+        expect(!SimulatedDevice::create(config).has_value()) << "Missing file";
+    };
+
+    "paced_clock_follows_speed"_test = [] {
+        SimulatedDeviceConfig config;
+        config.period_size = 480;
+        config.speed = 10.0;
+        config.jitter_ms = 2.0;
+        auto device = *SimulatedDevice::create(config, "paced");
+        expect(device->start().has_value());
+        auto started = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        device->stop();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        // 10x real time for ~0.1 s is up to ~1 s of audio, never ahead of the clock
+        expect(device->virtual_time() > 0.0) << device->virtual_time();
+        expect(device->virtual_time() <= elapsed * 10.0 + 0.01) << "Ran ahead of the clock";
+        expect(device->max_lateness_us() > 0_ll) << "Jitter delays wakeups";
+        expect(device->monitor()->cycles() > 0_ull);
+        expect(!device->is_running());
+    };
+
+    "virtual_clock_runs_far_faster_than_real_time"_test = [] {
+        auto config = virtual_config(SimSignal::Sine, 2, 1024);
+        config.max_frames = 48000 * 60;
+        auto device = *SimulatedDevice::create(config, "virtual");
+        expect(device->start().has_value());
+        // A minute of audio finishes well inside the wait, which a paced clock could not
+        expect(wait_finished(device));
+        device->stop();
+
+        expect(device->frames_generated() == 48000_ull * 60);
+    };
+
+    "headless_pipeline_on_the_device_clock"_test = [] {
+        // capture -> ring -> envelope taps -> plot columns at 60 frames per
+        // device second, one minute of audio, all on the device clock
+        constexpr size_t CHANNELS = 4;
+        constexpr size_t PERIOD = 256;
+        constexpr size_t COLUMNS = 512;
+        constexpr double SECONDS = 60.0;
+        auto config = virtual_config(SimSignal::Noise, CHANNELS, PERIOD);
+        config.xrun_probability = 0.01;
+        auto device = *SimulatedDevice::create(config, "pipeline");
+
+        EnvelopeConfig env_config;
+        env_config.samples_per_bucket = 64;
+        env_config.buckets = 4096;
+        std::vector<AudioEnvelopePtr> envelopes;
+        std::vector<EnvelopeHistory> histories;
+        for (size_t ch = 0; ch < CHANNELS; ++ch) {
+            envelopes.push_back(*AudioEnvelope::create(env_config));
+            device->get_buffer(ch)->add_tap(envelopes.back());
+            histories.emplace_back(1024, env_config.samples_per_bucket);
+        }
+
+        const size_t periods = static_cast<size_t>(SECONDS * 48000 / PERIOD);
+        const double periods_per_frame = 48000.0 / 60.0 / PERIOD;
+        std::vector<EnvelopeBucket> columns;
+        size_t plot_frames = 0;
+        size_t nonempty = 0;
+        for (size_t p = 0; p < periods; ++p) {
+            device->step();
+            if (p < plot_frames * periods_per_frame) continue;
+            for (size_t ch = 0; ch < CHANNELS; ++ch) {
+                histories[ch].pull(*envelopes[ch]);
+                histories[ch].columns(histories[ch].x_min(), 0.0, COLUMNS, columns);
+                nonempty += columns.back().min <= columns.back().max;
+            }
+            ++plot_frames;
+        }
+        expect(device->virtual_time() == periods * PERIOD / 48000.0);
+        expect(plot_frames == 3600_ul);
+        expect(envelopes[3]->completed() == device->frames_generated() / env_config.samples_per_bucket);
+        expect(nonempty > 0_ul);
+    };
+
+    "simulator_provider_opens_devices"_test = [] {
+        auto manager = *embedded::create_simulator_manager();
+        auto signals = *manager->get_children_names(DataPath::parse("/available"));
+        expect(signals == sim_signal_names());
+
+        expect(manager->add_child(DataPath::parse("/opened"), "bench", Dict{
+            {"signal", Value(std::string("triangle"))},
+            {"num-channels", Value(int64_t(2))},
+            {"period-size", Value(int64_t(128))},
+            {"speed", Value(0.0)},
+            {"max-frames", Value(int64_t(48000))}
+        }).has_value());
+        expect(!manager->add_child(DataPath::parse("/opened"), "bench", Dict{}).has_value()) << "Duplicate name";
+        expect(!manager->add_child(DataPath::parse("/opened"), "bad", Dict{
+            {"signal", Value(std::string("file"))}
+        }).has_value()) << "File signal needs a file";
+
+        auto children = *manager->get_children_names(DataPath::parse("/opened/bench"));
+        expect(children == std::vector<std::string>{"0", "1", "stats"});
+        auto channel = *manager->get_metadata(DataPath::parse("/opened/bench/1"));
+        expect(get_as<MediatedAudioBufferPtr>(channel["buffer"]).has_value());
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (*get_as<std::string>(*manager->get(DataPath::parse("/opened/bench/status"))) != "finished" &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto meta = *manager->get_metadata(DataPath::parse("/opened/bench"));
+        expect(*get_as<std::string>(meta["status"]) == "finished");
+        expect(*get_as<int64_t>(meta["frames-generated"]) == 48000_ll);
+        expect(*get_as<double>(meta["virtual-time"]) == 1.0);
+        expect(!manager->set(DataPath::parse("/opened/bench/speed"), Value(1.0)).has_value());
+        expect(!manager->set(DataPath::parse("/opened/bench/running"), Value(true)).has_value())
+            << "Finished devices do not restart";
+    };
+};
+
+int main() {
+    return 0;
+}
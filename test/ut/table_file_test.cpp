@@ -0,0 +1,127 @@
+// Table file (CSV/TSV, columnar) and table-file provider tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/embedded_plugins.hpp"
+#include "ymery/backend/table_file.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+using namespace boost::ut;
+using namespace ymery;
+namespace fs = std::filesystem;
+
+static std::string temp_file(const std::string& name, const std::string& content) {
+    auto path = fs::temp_directory_path() / ("ymery_table_" + name);
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+    return path.string();
+}
+
+suite table_file_tests = [] {
+    "table_file_parses_csv_columns_in_parallel"_test = [] {
+        std::string csv = "time,level,message\n";
+        for (int i = 0; i < 10000; ++i) {
+            csv += std::to_string(i) + "," + std::to_string(i * 0.5) + ",\"event, number " + std::to_string(i) + "\"\r\n";
+        }
+        auto path = temp_file("log.csv", csv);
+
+        TableFileOptions options;
+        options.chunk_bytes = 4096;  // many chunks
+        options.threads = 4;
+        auto file = TableFile::open(path, options);
+        expect(file.has_value());
+        expect((*file)->num_rows() == 10000_ul);
+        expect((*file)->num_chunks() > 10_ul);
+        expect((*file)->columns().size() == 3_ul);
+        expect((*file)->columns()[0].name == "time");
+        expect((*file)->columns()[1].type.has_value());
+        expect(!(*file)->columns()[2].type.has_value()) << "Quoted text is a text column";
+
+        auto level = (*file)->column(1);
+        expect(level.has_value());
+        auto values = (*level)->view<double>();
+        expect(values.size() == 10000_ul);
+        bool all = true;
+        for (size_t i = 0; i < values.size(); ++i) all = all && values[i] == i * 0.5;
+        expect(all) << "Every row lands in place across chunk boundaries";
+        expect(*(*file)->column(1) == *level) << "Parsed columns are cached";
+        expect(!(*file)->column(2).has_value());
+
+        auto row = (*file)->row_text(5555);
+        expect(row.has_value());
+        expect((*row)[0] == "5555");
+        expect((*row)[2] == "event, number 5555") << "Delimiter inside quotes";
+
+        auto rows = (*file)->read_rows(9998, 10);
+        expect((*rows)->shape() == std::vector<size_t>{2, 3}) << "Clamped to the end";
+        expect((*rows)->at(0) == 9998.0);
+        expect((*rows)->at(4) == 4999.5);
+        expect(std::isnan((*rows)->at(2)));
+        fs::remove(path);
+    };
+
+    "table_file_handles_tsv_without_header"_test = [] {
+        auto path = temp_file("plain.tsv", "1\t2\n3\t\n5\t6");
+        auto file = TableFile::open(path);
+        expect(file.has_value());
+        expect((*file)->format_name() == "tsv");
+        expect((*file)->num_rows() == 3_ul) << "Unterminated last line counts";
+        expect((*file)->columns()[1].name == "column-1");
+        auto second = *(*file)->column(1);
+        expect(second->at(0) == 2.0);
+        expect(std::isnan(second->at(1))) << "Empty cells are NaN";
+        expect(second->at(2) == 6.0);
+        fs::remove(path);
+    };
+
+    "table_file_columnar_round_trip"_test = [] {
+        auto path = (fs::temp_directory_path() / "ymery_table_data.ycol").string();
+        auto t = *NumericArray::create(std::vector<double>{0.0, 0.5, 1.0});
+        auto v = *NumericArray::create(std::vector<float>{1.5f, 2.5f, 3.5f});
+        auto n = *NumericArray::create(std::vector<int32_t>{7, 8, 9});
+        expect(TableFile::write_columnar(path, {"t", "value", "count"}, {t, v, n}).has_value());
+
+        auto file = TableFile::open(path);
+        expect(file.has_value());
+        expect((*file)->format_name() == "ycol");
+        expect((*file)->num_rows() == 3_ul);
+        expect((*file)->columns()[1].type == NumericType::F32);
+        auto value = *(*file)->column(1);
+        expect(value->view<float>()[2] == 3.5f);
+        auto rows = *(*file)->read_rows(1, 2);
+        expect(rows->at(2) == 8.0);
+        expect((*(*file)->row_text(0))[1] == "1.5");
+
+        expect(!TableFile::write_columnar(path, {"a", "b"}, {t, *NumericArray::create(std::vector<double>{1.0})}).has_value());
+        fs::remove(path);
+    };
+
+    "table_file_provider_exposes_columns"_test = [] {
+        auto path = temp_file("provider.csv", "x,y\n1,10\n2,20\n3,30\n");
+        auto tree = *embedded::create_table_file_manager();
+        expect(tree->add_child(DataPath("/opened"), "", Dict{{"filepath", Value(path)}}).has_value());
+        expect(!tree->add_child(DataPath("/opened"), "", Dict{{"filepath", Value(std::string("/no/such.csv"))}}).has_value());
+
+        auto columns = *tree->get_children_names(DataPath("/opened/1"));
+        expect(columns == std::vector<std::string>{"x", "y"});
+        auto meta = *tree->get_metadata(DataPath("/opened/1/y"));
+        expect(*get_as<std::string>(meta["dtype"]) == "f64");
+        expect(*get_as<int64_t>(*tree->get(DataPath("/opened/1/rows"))) == 3);
+
+        auto data = as_numeric_array(*tree->get(DataPath("/opened/1/y/data")));
+        expect(data != nullptr);
+        expect(data->at(2) == 30.0);
+
+        auto rows = as_numeric_array(*tree->get(DataPath("/opened/1/rows:1:1")));
+        expect(rows->shape() == std::vector<size_t>{1, 2});
+        expect(rows->at(1) == 20.0);
+        auto row = get_as<List>(*tree->get(DataPath("/opened/1/row:0")));
+        expect(*get_as<std::string>((*row)[1]) == "10");
+        fs::remove(path);
+    };
+};
+
+int main() {
+    return 0;
+}
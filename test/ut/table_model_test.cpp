@@ -0,0 +1,158 @@
+// Table model tests - lazy row reads, version cache, background sort/filter
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/frontend/table_model.hpp"
+#include <chrono>
+#include <thread>
+
+using namespace boost::ut;
+using namespace ymery;
+
+// Rows "r<i>" under /rows with "name", "value" and an optional "version"
+class RowsTree : public TreeLike {
+public:
+    explicit RowsTree(size_t rows, bool versioned) : _versioned(versioned) {
+        for (size_t i = 0; i < rows; ++i) {
+            _names.push_back("r" + std::to_string(i));
+            _values.push_back(static_cast<double>((i * 7919) % rows));
+            _versions.push_back(0);
+        }
+    }
+
+    Result<std::vector<std::string>> get_children_names(const DataPath& path) override {
+        if (path.to_string() == "/rows") return _names;
+        return std::vector<std::string>{};
+    }
+    Result<Dict> get_metadata(const DataPath&) override { return Dict{}; }
+    Result<std::vector<std::string>> get_metadata_keys(const DataPath&) override {
+        return std::vector<std::string>{"name", "value", "version"};
+    }
+    Result<Value> get(const DataPath& path) override {
+        const auto& parts = path.as_list();
+        if (parts.size() != 3) return Value{};
+        size_t row = std::stoul(parts[1].substr(1));
+        if (parts[2] == "version") {
+            return _versioned ? Value(static_cast<int64_t>(_versions[row])) : Value{};
+        }
+        ++value_reads;
+        if (parts[2] == "name") return Value(std::string(row % 2 ? "Odd " : "even ") + parts[1]);
+        if (parts[2] == "value") return Value(_values[row]);
+        return Value{};
+    }
+    Result<void> set(const DataPath&, const Value&) override { return Ok(); }
+    Result<void> add_child(const DataPath&, const std::string&, const Dict&) override { return Ok(); }
+    Result<std::string> as_tree(const DataPath&, int) override { return std::string(); }
+
+    void touch(size_t row, double value) {
+        _values[row] = value;
+        ++_versions[row];
+    }
+
+    size_t value_reads = 0;
+
+private:
+    bool _versioned;
+    std::vector<std::string> _names;
+    std::vector<double> _values;
+    std::vector<int64_t> _versions;
+};
+
+static std::vector<TableModelColumn> columns() {
+    return {{"name", "Name"}, {"value", "Value"}};
+}
+
+// Pump updates until the background sort/filter has landed
+static void settle(TableModel& model, double& now) {
+    for (int i = 0; i < 10000 && model.busy(); ++i) {
+        model.update(now += 0.001);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+suite table_model_tests = [] {
+    "table_model_reads_only_requested_rows"_test = [] {
+        auto tree = std::make_shared<RowsTree>(100000, true);
+        TableModel model(tree, DataPath("/rows"), columns());
+        model.update(0.0);
+        expect(model.row_count() == 100000_ul);
+        expect(tree->value_reads == 0_ul) << "Listing rows reads no cells";
+
+        for (size_t row = 500; row < 540; ++row) model.row_cells(row);
+        expect(model.rows_fetched() == 40_ul);
+        expect(tree->value_reads == 80_ul);
+
+        model.update(0.1);
+        for (size_t row = 500; row < 540; ++row) model.row_cells(row);
+        expect(model.rows_fetched() == 40_ul) << "Unchanged versions hit the cache";
+
+        tree->touch(510, -1.0);
+        model.update(0.2);
+        expect(model.row_cells(510)[1] == "-1");
+        expect(model.rows_fetched() == 41_ul) << "Only the bumped row is read again";
+    };
+
+    "table_model_unversioned_rows_refresh_on_interval"_test = [] {
+        auto tree = std::make_shared<RowsTree>(10, false);
+        TableModel model(tree, DataPath("/rows"), columns(), 1.0);
+        model.update(0.0);
+        model.row_cells(3);
+        model.update(0.5);
+        model.row_cells(3);
+        expect(model.rows_fetched() == 1_ul);
+        model.update(1.5);
+        model.row_cells(3);
+        expect(model.rows_fetched() == 2_ul);
+    };
+
+    "table_model_sorts_in_background"_test = [] {
+        auto tree = std::make_shared<RowsTree>(50000, true);
+        TableModel model(tree, DataPath("/rows"), columns());
+        double now = 0.0;
+        model.update(now);
+
+        model.set_sort(1, false);
+        expect(model.busy());
+        expect(model.row_count() == 50000_ul) << "Old order stays visible while sorting";
+        model.update(now += 0.001);
+        expect(model.busy()) << "Keys are collected in batches across updates";
+        settle(model, now);
+        expect(!model.busy());
+
+        expect(model.row_count() == 50000_ul);
+        expect(model.row_cells(0)[1] == "49999");
+        expect(model.row_cells(49999)[1] == "0");
+
+        model.set_sort(-1, true);
+        expect(!model.busy());
+        expect(model.row_name(0) == "r0") << "Tree order restored without a job";
+    };
+
+    "table_model_filters_case_insensitively"_test = [] {
+        auto tree = std::make_shared<RowsTree>(1000, true);
+        TableModel model(tree, DataPath("/rows"), columns());
+        double now = 0.0;
+        model.update(now);
+
+        model.set_filter("ODD");
+        settle(model, now);
+        expect(model.row_count() == 500_ul);
+        expect(model.row_name(0) == "r1");
+
+        model.set_sort(0, true);
+        settle(model, now);
+        expect(model.row_count() == 500_ul) << "Sorting keeps the filter";
+        expect(model.row_cells(0)[0] == "Odd r1");
+    };
+
+    "table_model_derives_columns_from_first_row"_test = [] {
+        auto tree = std::make_shared<RowsTree>(3, true);
+        TableModel model(tree, DataPath("/rows"), {});
+        model.update(0.0);
+        expect(model.columns().size() == 2_ul) << "version is not a column";
+        expect(model.columns()[1].key == "value");
+    };
+};
+
+int main() {
+    return 0;
+}
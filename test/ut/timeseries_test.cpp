@@ -0,0 +1,215 @@
+// Time series store and provider tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/embedded_plugins.hpp"
+#include "ymery/backend/time_series.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+using namespace boost::ut;
+using namespace ymery;
+
+static TimeSeriesPtr make_series(size_t chunk_rows, size_t max_rows, std::vector<std::string> columns = {"value"}) {
+    TimeSeriesConfig config;
+    config.columns = std::move(columns);
+    config.chunk_rows = chunk_rows;
+    config.max_rows = max_rows;
+    return *TimeSeries::create(config);
+}
+
+suite timeseries_tests = [] {
+    "timeseries_concurrent_appends_publish_every_row"_test = [] {
+        auto series = make_series(256, 1 << 20, {"a", "b"});
+        constexpr int producers = 4;
+        constexpr int rows = 20000;
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (int i = 0; i < rows; ++i) {
+                    double values[2] = {static_cast<double>(p), static_cast<double>(i)};
+                    series->append(0.0, values);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        expect(series->size() == static_cast<size_t>(producers * rows));
+        expect(series->dropped() == 0_ul);
+
+        // Every producer's rows are all there
+        auto a = *series->range(0, 0.0, 0.0);
+        auto b = *series->range(1, 0.0, 0.0);
+        size_t n = a->shape()[1];
+        expect(n == static_cast<size_t>(producers * rows));
+        std::vector<double> sums(producers, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            sums[static_cast<size_t>(a->at(n + i))] += b->at(n + i);
+        }
+        for (double sum : sums) {
+            expect(sum == (rows - 1) * rows / 2.0);
+        }
+    };
+
+    "timeseries_decimated_never_exceeds_max_points_while_appending"_test = [] {
+        auto series = make_series(64, 1 << 20);
+        constexpr size_t max_points = 100;
+        std::atomic<bool> done{false};
+
+        std::thread producer([&] {
+            for (int i = 0; i < 20000; ++i) {
+                double values[1] = {static_cast<double>(i % 7)};
+                series->append(static_cast<double>(i), values);
+            }
+            done = true;
+        });
+
+        size_t oversized = 0;
+        size_t queries = 0;
+        while (!done.load() || queries == 0) {
+            if (auto points = series->decimated(0, 0.0, 1e9, max_points)) {
+                oversized += (*points)->shape()[1] > max_points;
+            }
+            ++queries;
+        }
+        producer.join();
+
+        expect(queries > 0_ul);
+        expect(oversized == 0_ul) << "Rows published during a query went past max_points";
+    };
+
+    "timeseries_stress_every_append_is_published"_test = [] {
+        // Small chunks and many rounds: a row whose publish is lost leaves
+        // size() short of the appends once the producers are done
+        constexpr int producers = 8;
+        constexpr int rows = 2000;
+        for (int round = 0; round < 25; ++round) {
+            auto series = make_series(16, 1 << 20);
+            std::atomic<bool> go{false};
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; ++p) {
+                threads.emplace_back([&] {
+                    while (!go.load()) std::this_thread::yield();
+                    double v = 1.0;
+                    for (int i = 0; i < rows; ++i) series->append(0.0, {&v, 1});
+                });
+            }
+            go = true;
+            for (auto& t : threads) t.join();
+            expect(series->size() == static_cast<size_t>(producers * rows)) << "round" << round;
+        }
+    };
+
+    "timeseries_drops_when_full"_test = [] {
+        auto series = make_series(4, 8);
+        double v = 1.0;
+        for (int i = 0; i < 10; ++i) series->append(i, {&v, 1});
+        expect(series->size() == 8_ul);
+        expect(series->dropped() == 2_ul);
+
+        double two[2] = {1.0, 2.0};
+        expect(!series->append(11.0, two)) << "Column count mismatch is rejected";
+        expect(series->dropped() == 3_ul);
+    };
+
+    "timeseries_range_query_selects_time_window"_test = [] {
+        auto series = make_series(100, 100000);
+        for (int i = 0; i < 10000; ++i) {
+            double v = i * 2.0;
+            series->append(i * 0.01, {&v, 1});
+        }
+
+        auto window = series->range(0, 10.0, 20.0);
+        expect(window.has_value());
+        expect((*window)->shape() == std::vector<size_t>{2, 1001});
+        expect(std::abs((*window)->at(0) - 10.0) < 1e-9);
+        expect((*window)->at(1001) == 2000.0) << "Value row follows the time row";
+
+        auto empty = series->range(0, 200.0, 300.0);
+        expect((*empty)->size() == 0_ul);
+
+        auto times = series->time_range();
+        expect(times->min == 0.0);
+        expect(std::abs(times->max - 99.99) < 1e-9);
+    };
+
+    "timeseries_decimation_keeps_peaks"_test = [] {
+        auto series = make_series(512, 1 << 20);
+        for (int i = 0; i < 200000; ++i) {
+            double v = std::sin(i * 0.001);
+            if (i == 123457) v = 50.0;
+            if (i == 7001) v = -50.0;
+            series->append(static_cast<double>(i), {&v, 1});
+        }
+
+        auto points = series->decimated(0, 0.0, 1e9, 400);
+        expect(points.has_value());
+        size_t n = (*points)->shape()[1];
+        expect(n <= 400_ul);
+        expect(n > 300_ul);
+
+        double vmax = -1e9, vmin = 1e9;
+        double tprev = -1.0;
+        bool ordered = true;
+        for (size_t i = 0; i < n; ++i) {
+            vmax = std::max(vmax, (*points)->at(n + i));
+            vmin = std::min(vmin, (*points)->at(n + i));
+            ordered = ordered && (*points)->at(i) > tprev;
+            tprev = (*points)->at(i);
+        }
+        expect(vmax == 50.0);
+        expect(vmin == -50.0);
+        expect(ordered) << "Points stay in time order";
+
+        expect((*series->decimated(0, 0.0, 1e9, 2))->shape()[1] <= 2_ul);
+        expect(!series->decimated(0, 0.0, 1e9, 1).has_value()) << "One point cannot hold a bucket";
+        expect(!series->decimated(0, 0.0, 1e9, 0).has_value());
+
+        auto bounds = series->value_range(0, 1000.0, 150000.0);
+        expect(bounds->max == 50.0);
+        expect(bounds->min == -50.0);
+        auto partial = series->value_range(0, 8000.0, 9000.0);
+        expect(partial->max < 50.0 && partial->min > -50.0);
+    };
+
+    "timeseries_provider_exposes_queries"_test = [] {
+        auto tree = *embedded::create_timeseries_manager();
+        Dict data{{"columns", Value(List{Value(std::string("x")), Value(std::string("y"))})},
+                  {"chunk-rows", Value(64)}};
+        expect(tree->add_child(DataPath("/opened"), "sensor", data).has_value());
+        expect(!tree->add_child(DataPath("/opened"), "sensor", data).has_value());
+
+        for (int i = 0; i < 1000; ++i) {
+            List row{Value(static_cast<double>(i)), Value(static_cast<double>(i)), Value(static_cast<double>(-i))};
+            expect(tree->set(DataPath("/opened/sensor/append"), Value(row)).has_value());
+        }
+
+        auto columns = *tree->get_children_names(DataPath("/opened/sensor"));
+        expect(columns == std::vector<std::string>{"x", "y"});
+
+        auto meta = *tree->get_metadata(DataPath("/opened/sensor/y"));
+        expect(*get_as<std::string>(meta["category"]) == "timeseries-column");
+        expect(*get_as<double>(meta["min"]) == -999.0);
+        expect(*get_as<double>(meta["t-max"]) == 999.0);
+        expect(*get_as<int64_t>(*tree->get(DataPath("/opened/sensor/rows"))) == 1000);
+
+        auto range = tree->get(DataPath("/opened/sensor/y/range:10:19"));
+        auto array = as_numeric_array(*range);
+        expect(array != nullptr);
+        expect(array->shape() == std::vector<size_t>{2, 10});
+        expect(array->at(10) == -10.0);
+
+        auto dec = tree->get(DataPath("/opened/sensor/x/decimated:0:1000:100"));
+        expect(as_numeric_array(*dec)->shape()[1] <= 100_ul);
+
+        expect(!tree->get(DataPath("/opened/sensor/x/range:abc:1")).has_value() ||
+               !tree->get(DataPath("/opened/sensor/x/range:abc:1"))->has_value());
+        expect(!tree->get(DataPath("/opened/sensor/x/decimated:0:1")).has_value());
+    };
+};
+
+int main() {
+    return 0;
+}
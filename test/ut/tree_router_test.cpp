@@ -0,0 +1,141 @@
+// Tree router unit tests
+#include <boost/ut.hpp>
+#include "ymery/types.hpp"
+#include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/tree_router.hpp"
+#include "ymery/embedded_plugins.hpp"
+#include <string>
+#include <vector>
+
+using namespace boost::ut;
+using namespace ymery;
+
+namespace {
+
+// Each route reports its pattern, so tests see which one matched
+TreeRouter::Route named(const std::string& pattern) {
+    return {
+        [](const RouteMatch& m) {
+            std::vector<std::string> captures;
+            for (size_t i = 0; i < m.size(); ++i) captures.push_back(m[i]);
+            for (const auto& part : m.rest()) captures.push_back("+" + part);
+            return Ok(captures);
+        },
+        [pattern](const RouteMatch&) { return Ok(Dict{{"pattern", Value(pattern)}}); }
+    };
+}
+
+std::string matched(const TreeRouter& router, const std::string& path) {
+    auto meta = *router.metadata(DataPath(path));
+    auto it = meta.find("pattern");
+    return it == meta.end() ? std::string() : *get_as<std::string>(it->second);
+}
+
+std::vector<std::string> captures(const TreeRouter& router, const std::string& path) {
+    return *router.children(DataPath(path));
+}
+
+} // namespace
+
+suite tree_router_tests = [] {
+    "literals_captures_and_root"_test = [] {
+        TreeRouter router;
+        for (const char* pattern : {"/", "/available", "/available/{card}", "/available/{card}/{device}"}) {
+            expect(router.add(pattern, named(pattern)).has_value()) << pattern;
+        }
+        expect(router.num_routes() == 4_ul);
+        expect(matched(router, "/") == "/");
+        expect(matched(router, "/available") == "/available");
+        expect(matched(router, "available") == "/available") << "Relative paths route the same";
+        expect(captures(router, "/available/1/0") == std::vector<std::string>{"1", "0"});
+        expect(matched(router, "/opened").empty());
+        expect(matched(router, "/available/1/0/7").empty());
+        expect(captures(router, "/nowhere").empty());
+    };
+
+    "literals_win_over_captures_and_indices_are_typed"_test = [] {
+        TreeRouter router;
+        for (const char* pattern : {"/opened/{device}", "/opened/{device}/{channel:index}",
+                                    "/opened/{device}/stats/{rest...}", "/opened/{device}/{setting}"}) {
+            expect(router.add(pattern, named(pattern)).has_value()) << pattern;
+        }
+        expect(matched(router, "/opened/hw:0/stats") == "/opened/{device}/stats/{rest...}");
+        expect(captures(router, "/opened/hw:0/stats/3") == std::vector<std::string>{"hw:0", "+3"});
+        expect(matched(router, "/opened/hw:0/12") == "/opened/{device}/{channel:index}");
+        expect(matched(router, "/opened/hw:0/gain") == "/opened/{device}/{setting}") << "Not an index";
+        expect(matched(router, "/opened/hw:0/-1") == "/opened/{device}/{setting}");
+
+        RouteMatch m;
+        auto route = router.match(DataPath("/opened/dev/12"), m);
+        expect(route != nullptr);
+        expect(m.size() == 2_ul);
+        expect(m[0] == "dev");
+        expect(m.index(1) == 12_ul);
+    };
+
+    "backtracks_when_a_literal_branch_fails"_test = [] {
+        TreeRouter router;
+        expect(router.add("/opened/stats", named("literal")).has_value());
+        expect(router.add("/opened/{device}/{channel}", named("capture")).has_value());
+        expect(matched(router, "/opened/stats") == "literal");
+        expect(matched(router, "/opened/stats/0") == "capture") << "A device named 'stats' still routes";
+    };
+
+    "bad_patterns_are_rejected"_test = [] {
+        TreeRouter router;
+        expect(!router.add("available", named("x")).has_value()) << "Must be absolute";
+        expect(!router.add("/a//b", named("x")).has_value()) << "Empty segment";
+        expect(!router.add("/a/{b", named("x")).has_value());
+        expect(!router.add("/a/{b:float}", named("x")).has_value()) << "Unknown capture type";
+        expect(!router.add("/a/{rest...}/b", named("x")).has_value()) << "Rest must be last";
+        expect(router.add("/a/{b}", named("x")).has_value());
+        expect(!router.add("/a/{c}", named("x")).has_value()) << "Same pattern under another name";
+    };
+
+    "waveform_provider_routes"_test = [] {
+        auto waveform = *embedded::create_waveform_manager();
+        expect(*waveform->get_children_names(DataPath("/")) == std::vector<std::string>{"available", "opened"});
+        expect(waveform->get_children_names(DataPath("/available"))->size() == 3_ul);
+        expect(*waveform->get_children_names(DataPath("/available/sine")) == std::vector<std::string>{"0"});
+        expect(waveform->get_children_names(DataPath("/available/noise"))->empty());
+
+        auto channel = *waveform->get_metadata(DataPath("/opened/sine/0"));
+        expect(get_as<MediatedAudioBufferPtr>(channel["buffer"]).has_value());
+        expect(waveform->get_metadata(DataPath("/opened/sine/1"))->empty());
+        auto stats = *waveform->get_metadata(DataPath("/opened/square/stats"));
+        expect(*get_as<std::string>(stats["type"]) == "audio-stats");
+        expect(*get_as<std::string>(*waveform->get(DataPath("/available/triangle/name"))) == "triangle");
+    };
+
+    "one_match_is_reused_across_lookups"_test = [] {
+        TreeRouter router;
+        for (const char* pattern : {"/", "/available", "/available/{card}", "/available/{card}/{device}",
+                                    "/available/{card}/{device}/{channel:index}", "/opened",
+                                    "/opened/{device}", "/opened/{device}/{channel:index}",
+                                    "/opened/{device}/stats/{rest...}"}) {
+            expect(router.add(pattern, named(pattern)).has_value());
+        }
+        const DataPath deep("/opened/hw:1,0/stats/3");
+        const DataPath channel("/available/card0/dev1/2");
+        const DataPath root("/opened");
+
+        // Matching into the same RouteMatch leaves nothing of the previous path behind
+        RouteMatch m;
+        for (int i = 0; i < 1000; ++i) {
+            expect(router.match(deep, m) != nullptr);
+            expect(m.size() == 1_ul && m[0] == "hw:1,0");
+            expect(m.rest_list() == std::vector<std::string>{"3"});
+
+            expect(router.match(channel, m) != nullptr);
+            expect(m.size() == 3_ul && m[1] == "dev1" && m.index(2) == 2_ul);
+            expect(m.rest().empty());
+
+            expect(router.match(root, m) != nullptr);
+            expect(m.size() == 0_ul && m.rest().empty());
+        }
+    };
+};
+
+int main() {
+    return 0;
+}
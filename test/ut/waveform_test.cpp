@@ -4,6 +4,12 @@
 #include "ymery/dispatcher.hpp"
 #include "ymery/types.hpp"
 #include "ymery/backend/audio_buffer.hpp"
+#include "ymery/backend/oscillator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
 
 using namespace boost::ut;
 using namespace ymery;
@@ -135,6 +141,78 @@ suite waveform_tests = [] {
         auto buffer_ptr = get_as<MediatedAudioBufferPtr>(buffer_val);
         expect(buffer_ptr.has_value()) << "Buffer is not MediatedAudioBufferPtr";
     };
+
+    "waveform_stats_subtree"_test = [] {
+        auto pm_res = PluginManager::create(PLUGINS_PATH);
+        expect(pm_res.has_value());
+        auto pm = *pm_res;
+
+        auto disp_res = Dispatcher::create();
+        expect(disp_res.has_value());
+        auto disp = *disp_res;
+
+        auto waveform_res = pm->create_tree("waveform", disp);
+        expect(waveform_res.has_value());
+        auto waveform = *waveform_res;
+
+        auto buffer = get_as<MediatedAudioBufferPtr>(*waveform->get(DataPath("/opened/sine/0/buffer")));
+        expect(buffer.has_value());
+        for (int i = 0; i < 5; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            (*buffer)->data();
+        }
+
+        // Stats are addressable but not listed among channels
+        auto channels_res = waveform->get_children_names(DataPath("/opened/sine"));
+        expect(channels_res.has_value() && channels_res->size() == 1_ul);
+
+        auto stats_children = waveform->get_children_names(DataPath("/opened/sine/stats"));
+        expect(stats_children.has_value() && stats_children->size() == 1_ul) << "Expected one channel under stats";
+
+        auto meta_res = waveform->get_metadata(DataPath("/opened/sine/stats"));
+        expect(meta_res.has_value()) << "get_metadata(stats) failed: " << error_msg(meta_res);
+        auto callbacks = get_as<int64_t>((*meta_res)["callbacks"]);
+        expect(callbacks.has_value() && *callbacks > 0) << "No producer callbacks recorded";
+
+        auto channel_res = waveform->get_metadata(DataPath("/opened/sine/stats/0"));
+        expect(channel_res.has_value());
+        auto reads = get_as<int64_t>((*channel_res)["reads"]);
+        expect(reads.has_value() && *reads == 5) << "Consumer reads not counted";
+
+        auto json_res = waveform->get(DataPath("/opened/sine/stats/json"));
+        expect(json_res.has_value());
+        auto json = get_as<std::string>(*json_res);
+        expect(json.has_value() && json->front() == '{' && json->find("\"callback-duration\"") != std::string::npos)
+            << "Stats JSON dump missing";
+    };
+
+    "oscillator_sine_matches_reference"_test = [] {
+        Oscillator osc(WaveformKind::Sine, 440.0, 48000);
+        std::vector<float> samples(48000);
+        osc.render(samples.data(), samples.size());
+
+        double max_err = 0.0;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            double ref = std::sin(2.0 * 3.14159265358979323846 * 440.0 * i / 48000.0);
+            max_err = std::max(max_err, std::abs(samples[i] - ref));
+        }
+        expect(max_err < 1e-5) << "Sine error too large: " << max_err;
+
+        // 440 whole cycles in one second - phase must land back on zero
+        expect(osc.phase() < 1e-9 || osc.phase() > 1.0 - 1e-9) << "Phase drifted: " << osc.phase();
+    };
+
+    "oscillator_band_limited_bounds"_test = [] {
+        for (auto kind : {WaveformKind::Square, WaveformKind::Triangle}) {
+            Oscillator osc(kind, 1000.0, 48000);
+            std::vector<float> samples(4800);
+            osc.render(samples.data(), samples.size());
+
+            auto [mn, mx] = std::minmax_element(samples.begin(), samples.end());
+            expect(*mn >= -1.0f && *mx <= 1.0f) << waveform_kind_name(kind) << " out of range";
+            expect(*mn < -0.9f && *mx > 0.9f) << waveform_kind_name(kind) << " amplitude too small";
+        }
+    };
 };
 
 int main() {